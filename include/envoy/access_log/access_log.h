@@ -21,6 +21,15 @@ public:
    */
   virtual void write(absl::string_view) PURE;
 
+  /**
+   * Add a header to the file, such as the schema of a binary log, unless a header with the same id
+   * was already added. Each header is written once, ahead of any data written after it, and again
+   * at the start of the file every time it is reopened.
+   * @param id supplies the id of the header, which is the same for identical headers.
+   * @param data supplies the header.
+   */
+  virtual void addHeader(uint64_t id, absl::string_view data) PURE;
+
   /**
    * Reopen the file.
    */
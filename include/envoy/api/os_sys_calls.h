@@ -151,6 +151,22 @@ public:
    */
   virtual SysCallIntResult socketpair(int domain, int type, int protocol, os_fd_t sv[2]) PURE;
 
+  /**
+   * @see man 2 pipe. Both ends of the pipe are non-blocking.
+   */
+  virtual SysCallIntResult pipe(os_fd_t fds[2]) PURE;
+
+  /**
+   * @see man 2 splice. Moves up to len bytes from fd_in to fd_out, one of which must be a pipe,
+   * without blocking.
+   */
+  virtual SysCallSizeResult splice(os_fd_t fd_in, os_fd_t fd_out, size_t len) PURE;
+
+  /**
+   * return true if the OS supports splice().
+   */
+  virtual bool supportsSplice() const PURE;
+
   /**
    * @see man 2 listen
    */
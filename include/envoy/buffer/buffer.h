@@ -20,6 +20,10 @@
 #include "absl/types/span.h"
 
 namespace Envoy {
+namespace Stats {
+class Scope;
+} // namespace Stats
+
 namespace Buffer {
 
 /**
@@ -72,6 +76,41 @@ public:
 
 using SliceDataPtr = std::unique_ptr<SliceData>;
 
+/**
+ * An account which the memory of buffer slices is charged to while they are held by a buffer bound
+ * to it, such as the buffers of a connection or of a stream.
+ * @see WatermarkFactory::createAccount().
+ */
+class BufferMemoryAccount {
+public:
+  virtual ~BufferMemoryAccount() = default;
+
+  /**
+   * Charges memory to the account.
+   * @param amount supplies the number of bytes to charge.
+   */
+  virtual void charge(uint64_t amount) PURE;
+
+  /**
+   * Credits memory which was charged to the account.
+   * @param amount supplies the number of bytes to credit.
+   */
+  virtual void credit(uint64_t amount) PURE;
+
+  /**
+   * @return uint64_t the number of bytes currently charged to the account.
+   */
+  virtual uint64_t balance() const PURE;
+
+  /**
+   * Called by the owner of the account once it is closed or reset, after which it is no longer
+   * reset to free memory.
+   */
+  virtual void clearResetCallback() PURE;
+};
+
+using BufferMemoryAccountSharedPtr = std::shared_ptr<BufferMemoryAccount>;
+
 /**
  * A basic buffer abstraction.
  */
@@ -88,6 +127,13 @@ public:
    */
   virtual void addDrainTracker(std::function<void()> drain_tracker) PURE;
 
+  /**
+   * Bind the buffer to an account, which the memory of the slices held by the buffer is charged
+   * to until they are drained or moved to another buffer.
+   * @param account supplies the account, or nullptr to stop charging the slices to any account.
+   */
+  virtual void bindAccount(BufferMemoryAccountSharedPtr account) PURE;
+
   /**
    * Copy data into the buffer (deprecated, use absl::string_view variant
    * instead).
@@ -426,6 +472,36 @@ public:
   virtual InstancePtr create(std::function<void()> below_low_watermark,
                              std::function<void()> above_high_watermark,
                              std::function<void()> above_overflow_watermark) PURE;
+
+  /**
+   * Creates an account for the buffers of a connection or stream. The account must only be used
+   * on the thread of the dispatcher which owns the factory.
+   * @param reset_cb supplies a function to call to reset the owner of the account, such as by
+   *   closing its connection, so that its buffers are freed when memory is tight.
+   * @return BufferMemoryAccountSharedPtr the account, or nullptr if memory isn't accounted for.
+   */
+  virtual BufferMemoryAccountSharedPtr createAccount(std::function<void()> reset_cb) PURE;
+
+  /**
+   * @return uint64_t the number of bytes charged to the accounts created by the factory.
+   */
+  virtual uint64_t bytesCharged() const PURE;
+
+  /**
+   * Resets the owners of the accounts with the most bytes charged, largest first, until the
+   * accounts reset were charged at least the given number of bytes or no account is left.
+   * @param bytes_to_free supplies the number of bytes to free.
+   * @return uint64_t the number of bytes charged to the accounts which were reset.
+   */
+  virtual uint64_t resetAccounts(uint64_t bytes_to_free) PURE;
+
+  /**
+   * Initializes the statistics of the accounts created by the factory. Must be called on the
+   * thread of the dispatcher which owns the factory.
+   * @param scope supplies the scope of the statistics.
+   * @param prefix supplies the prefix of the statistics.
+   */
+  virtual void initializeStats(Stats::Scope& scope, const std::string& prefix) PURE;
 };
 
 using WatermarkFactoryPtr = std::unique_ptr<WatermarkFactory>;
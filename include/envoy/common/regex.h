@@ -1,6 +1,8 @@
 #pragma once
 
+#include <cstdint>
 #include <memory>
+#include <vector>
 
 #include "envoy/common/matchers.h"
 
@@ -24,5 +26,26 @@ public:
 
 using CompiledMatcherPtr = std::unique_ptr<const CompiledMatcher>;
 
+/**
+ * A set of regex patterns compiled together, so that all of them are matched against a value in a
+ * single pass rather than one at a time.
+ */
+class CompiledMatcherSet {
+public:
+  virtual ~CompiledMatcherSet() = default;
+
+  /**
+   * Finds the patterns that match all of "value".
+   * @param value supplies the value to match.
+   * @param matches receives the indices of the matching patterns, in the order they were given
+   *        when building the set.
+   * @return false if the engine ran out of resources before finishing the match. "matches" is then
+   *         incomplete, and callers must fall back to matching the patterns individually.
+   */
+  virtual bool match(absl::string_view value, std::vector<uint32_t>& matches) const PURE;
+};
+
+using CompiledMatcherSetPtr = std::unique_ptr<const CompiledMatcherSet>;
+
 } // namespace Regex
 } // namespace Envoy
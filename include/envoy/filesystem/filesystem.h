@@ -10,6 +10,7 @@
 #include "envoy/common/pure.h"
 
 #include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 
 namespace Envoy {
 namespace Filesystem {
@@ -45,6 +46,15 @@ public:
    */
   virtual Api::IoCallSizeResult write(absl::string_view buffer) PURE;
 
+  /**
+   * Write the buffers to the file in order, using a single vectored write where the platform
+   * supports it. The file must be explicitly opened before writing.
+   *
+   * @return ssize_t number of bytes written, or -1 for failure. Fewer bytes than the buffers hold
+   *         are written if a write comes up short.
+   */
+  virtual Api::IoCallSizeResult writev(absl::Span<const absl::string_view> buffers) PURE;
+
   /**
    * Close the file.
    *
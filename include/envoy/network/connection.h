@@ -93,6 +93,16 @@ public:
     Stats::Counter* delayed_close_timeouts_;
   };
 
+  /**
+   * Stats of the reads made on the socket of a connection, e.g. by the listener which accepted it.
+   */
+  struct ReadStats {
+    // The number of reads, including those which returned no data.
+    Stats::Counter& reads_total_;
+    // The number of bytes returned by each read which returned data.
+    Stats::Histogram& read_size_;
+  };
+
   ~Connection() override = default;
 
   /**
@@ -218,6 +228,13 @@ public:
    */
   virtual void setConnectionStats(const ConnectionStats& stats) PURE;
 
+  /**
+   * Set the stats of the reads made on the connection's socket. Only the reads of transport sockets
+   * which read the socket directly, such as the raw buffer socket, are reported to them.
+   * @param stats supplies the stats to update.
+   */
+  virtual void setReadStats(const ReadStats& stats) PURE;
+
   /**
    * @return the const SSL connection data if this is an SSL connection, or nullptr if it is not.
    */
@@ -301,6 +318,24 @@ public:
    *         occurred an empty string is returned.
    */
   virtual absl::string_view transportFailureReason() const PURE;
+
+  /**
+   * @return IoHandle* the handle of the underlying socket if data may currently be moved in and
+   *         out of it directly, bypassing the connection, or nullptr otherwise. This is only the
+   *         case while the connection is open and connected, nothing is buffered in it and the
+   *         transport socket doesn't transform the data. The caller must read disable the
+   *         connection while it reads from the handle, and only write to the handle when this
+   *         returns it.
+   */
+  virtual IoHandle* spliceableIoHandle() PURE;
+
+  /**
+   * Accounts for data which was moved in and out of the handle returned by spliceableIoHandle()
+   * in the connection's stats and stream info.
+   * @param bytes_read supplies the number of bytes read from the handle.
+   * @param bytes_written supplies the number of bytes written to the handle.
+   */
+  virtual void recordSplicedBytes(uint64_t bytes_read, uint64_t bytes_written) PURE;
 };
 
 using ConnectionPtr = std::unique_ptr<Connection>;
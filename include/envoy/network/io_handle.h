@@ -5,6 +5,7 @@
 #include "envoy/api/io_error.h"
 #include "envoy/common/platform.h"
 #include "envoy/common/pure.h"
+#include "envoy/event/file_event.h"
 #include "envoy/network/address.h"
 
 #include "absl/container/fixed_array.h"
@@ -15,6 +16,10 @@ namespace Buffer {
 struct RawSlice;
 } // namespace Buffer
 
+namespace Event {
+class Dispatcher;
+} // namespace Event
+
 using RawSliceArrays = absl::FixedArray<absl::FixedArray<Buffer::RawSlice>>;
 
 namespace Network {
@@ -148,6 +153,12 @@ public:
    */
   virtual bool supportsUdpGro() const PURE;
 
+  /**
+   * return true if data may be moved in and out of the handle's fd with splice(), i.e. the fd is
+   * the only place it is read from and written to.
+   */
+  virtual bool supportsSplice() const PURE;
+
   /**
    * Bind to address. The handle should have been created with a call to socket()
    * @param address address to bind to.
@@ -223,6 +234,21 @@ public:
    * @return peer's address as @ref Address::InstanceConstSharedPtr
    */
   virtual Address::InstanceConstSharedPtr peerAddress() PURE;
+
+  /**
+   * Create a file event that notifies when the handle is ready for the given events. Handles which
+   * perform I/O asynchronously signal readiness once their operations complete rather than when
+   * fd() becomes ready.
+   * @param dispatcher supplies the dispatcher of the thread on which the handle is used.
+   * @param cb supplies the callback to fire when the handle is ready.
+   * @param trigger specifies whether to edge or level trigger.
+   * @param events supplies a logical OR of FileReadyType events that the file event should
+   *               initially listen on.
+   * @return Event::FileEventPtr the file event, which must be destroyed before the handle.
+   */
+  virtual Event::FileEventPtr createFileEvent(Event::Dispatcher& dispatcher, Event::FileReadyCb cb,
+                                              Event::FileTriggerType trigger,
+                                              uint32_t events) PURE;
 };
 
 using IoHandlePtr = std::unique_ptr<IoHandle>;
@@ -69,6 +69,12 @@ public:
    */
   virtual void setReadBufferReady() PURE;
 
+  /**
+   * Report a read made on the socket, for the read stats of the connection.
+   * @param bytes_read supplies the number of bytes the read returned, 0 if it returned none.
+   */
+  virtual void onSocketRead(uint64_t bytes_read) PURE;
+
   /**
    * Raise a connection event to the connection. This can be used by a secure socket (e.g. TLS)
    * to raise a connected event when handshake is done.
@@ -116,6 +122,13 @@ public:
    */
   virtual bool canFlushClose() PURE;
 
+  /**
+   * @return bool whether data may bypass doRead() and doWrite() and be moved directly between
+   *         the underlying socket and another one, i.e. the socket neither transforms nor observes
+   *         the bytes it reads and writes.
+   */
+  virtual bool canSplice() const PURE;
+
   /**
    * Closes the transport socket.
    * @param event supplies the connection event that is closing the socket.
@@ -41,6 +41,12 @@ public:
    */
   virtual std::chrono::milliseconds statsFlushInterval() const PURE;
 
+  /**
+   * @return bool whether stats flushes only deliver the stats which changed since the previous
+   *         flush.
+   */
+  virtual bool statsFlushChangedOnly() const PURE;
+
   /**
    * @return std::chrono::milliseconds the time interval after which we count a nonresponsive thread
    *         event as a "miss" statistic.
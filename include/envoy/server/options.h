@@ -239,6 +239,17 @@ public:
    */
   virtual bool fakeSymbolTableEnabled() const PURE;
 
+  /**
+   * @return the path of the file in which the values of counters and gauges are placed for
+   *         export, or an empty string to only keep them in process memory.
+   */
+  virtual const std::string& statsSharedMemoryPath() const PURE;
+
+  /**
+   * @return the number of stats which the file at statsSharedMemoryPath() has room for.
+   */
+  virtual uint32_t statsSharedMemoryMaxStats() const PURE;
+
   /**
    * @return bool indicating whether cpuset size should determine the number of worker threads.
    */
@@ -64,6 +64,10 @@ public:
 
   // Overload action to try to shrink the heap by releasing free memory.
   const std::string ShrinkHeap = "envoy.overload_actions.shrink_heap";
+
+  // Overload action to reset the connections and streams which buffer the most memory.
+  const std::string ResetLargestBufferConsumers =
+      "envoy.overload_actions.reset_largest_buffer_consumers";
 };
 
 using OverloadActionNames = ConstSingleton<OverloadActionNameValues>;
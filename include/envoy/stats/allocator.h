@@ -58,6 +58,16 @@ public:
   virtual const SymbolTable& constSymbolTable() const PURE;
   virtual SymbolTable& symbolTable() PURE;
 
+  /**
+   * Latches every counter, and calls counter_fn with the latched value of each counter for which it
+   * is non-zero, gauge_fn for each initialized gauge and text_readout_fn for each text readout
+   * written since the previous call. The functions are called with the allocator's lock held, so
+   * they must not allocate stats or release the last reference to one.
+   */
+  virtual void forEachChangedStat(const std::function<void(Counter&, uint64_t)>& counter_fn,
+                                  const std::function<void(Gauge&)>& gauge_fn,
+                                  const std::function<void(TextReadout&)>& text_readout_fn) PURE;
+
   // TODO(jmarantz): create a parallel mechanism to instantiate histograms. At
   // the moment, histograms don't fit the same pattern of counters and gauges
   // as they are not actually created in the context of a stats allocator.
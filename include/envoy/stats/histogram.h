@@ -24,6 +24,21 @@ public:
    * @return The buckets for the histogram. Each value is an upper bound of a bucket.
    */
   virtual ConstSupportedBuckets& buckets(absl::string_view stat_name) const PURE;
+
+  /**
+   * The representation of the histograms which are recorded per thread and merged at each flush.
+   */
+  enum class Engine {
+    // circllhist histograms, double buffered per thread.
+    Circllhist,
+    // Sparse log-linear histograms with atomic buckets, which are merged without swapping buffers.
+    LogLinear,
+  };
+
+  /**
+   * @return the representation to use for all histograms.
+   */
+  virtual Engine engine() const PURE;
 };
 
 using HistogramSettingsConstPtr = std::unique_ptr<const HistogramSettings>;
@@ -87,11 +87,14 @@ public:
    * Flags:
    * Used: used by all stats types to figure out whether they have been used.
    * Logic...: used by gauges to cache how they should be combined with a parent's value.
+   * Changed: used by gauges and text readouts to track whether they were written since the last
+   *          flush of changed stats.
    */
   struct Flags {
     static const uint8_t Used = 0x01;
     static const uint8_t LogicAccumulate = 0x02;
     static const uint8_t NeverImport = 0x04;
+    static const uint8_t Changed = 0x08;
   };
   virtual SymbolTable& symbolTable() PURE;
   virtual const SymbolTable& constSymbolTable() const PURE;
@@ -1,10 +1,14 @@
 #pragma once
 
+#include <chrono>
+#include <cstdint>
 #include <functional>
 #include <memory>
+#include <string>
 #include <vector>
 
 #include "envoy/common/pure.h"
+#include "envoy/common/time.h"
 #include "envoy/stats/histogram.h"
 #include "envoy/stats/scope.h"
 #include "envoy/stats/stats_matcher.h"
@@ -24,6 +28,27 @@ namespace Stats {
 
 class Sink;
 
+/**
+ * A profile of the caches a store looks stats up in, to diagnose the cost of creating stats, e.g.
+ * for the scope of each cluster added by CDS.
+ */
+struct CacheProfile {
+  struct ThreadCache {
+    std::string thread_name_;
+    // The number of lookups which missed the thread's cache and went to the central cache.
+    uint64_t misses_{};
+    // The number of stats copied into the thread's cache by warm-ups.
+    uint64_t warmed_{};
+  };
+
+  // Whether central cache lock hold times are being measured.
+  bool enabled_{};
+  uint64_t central_lock_acquisitions_{};
+  std::chrono::nanoseconds central_lock_hold_time_{};
+  std::chrono::nanoseconds max_central_lock_hold_time_{};
+  std::vector<ThreadCache> thread_caches_;
+};
+
 /**
  * A store for all known counters, gauges, and timers.
  */
@@ -48,6 +73,29 @@ public:
    * @return a list of all known histograms.
    */
   virtual std::vector<ParentHistogramSharedPtr> histograms() const PURE;
+
+  /**
+   * Latches every counter, and calls counter_fn with the latched value of each counter for which it
+   * is non-zero, gauge_fn for each gauge and text_readout_fn for each text readout written since
+   * the previous call. Unlike counters(), gauges() and textReadouts(), this visits each stat once
+   * regardless of how many scopes reference it, and only hands out the stats that changed. The
+   * functions must not create stats or release the last reference to one.
+   */
+  virtual void forEachChangedStat(const std::function<void(Counter&, uint64_t)>& counter_fn,
+                                  const std::function<void(Gauge&)>& gauge_fn,
+                                  const std::function<void(TextReadout&)>& text_readout_fn) PURE;
+
+  /**
+   * Enables or disables measuring how long the central cache lock is held to look up or create
+   * stats. Either resets the profile.
+   * @param time_source the source of the hold times, or nullptr to stop measuring them.
+   */
+  virtual void setCacheProfiling(TimeSource* time_source) PURE;
+
+  /**
+   * @return the profile of the store's caches. Stores without caches return an empty profile.
+   */
+  virtual CacheProfile cacheProfile() const PURE;
 };
 
 using StorePtr = std::unique_ptr<Store>;
@@ -85,6 +133,14 @@ public:
    */
   virtual void setHistogramSettings(HistogramSettingsConstPtr&& histogram_settings) PURE;
 
+  /**
+   * Enables or disables warming up the thread local caches of new scopes. When enabled, the stats
+   * created in a new scope by the time the main thread finishes its current event are copied into
+   * the cache of every thread in one posted batch, so that the first lookups on workers need not
+   * take the central cache lock.
+   */
+  virtual void setThreadLocalCacheWarmup(bool enabled) PURE;
+
   /**
    * Initialize the store for threading. This will be called once after all worker threads have
    * been initialized. At this point the store can initialize itself for multi-threaded operation.
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <chrono>
 #include <cstdint>
 #include <memory>
 
@@ -99,6 +100,15 @@ public:
    *        is missing and use sensible defaults.
    */
   virtual HostConstSharedPtr chooseHost(LoadBalancerContext* context) PURE;
+
+  /**
+   * Reports how long a host chosen by this load balancer took to serve a request. Called on the
+   * thread the load balancer belongs to. Load balancers which don't track host latency ignore it.
+   * @param host supplies the host which served the request.
+   * @param response_time supplies the time from sending the request to receiving the whole
+   *        response.
+   */
+  virtual void onHostResponseTime(const HostDescription&, std::chrono::nanoseconds) {}
 };
 
 using LoadBalancerPtr = std::unique_ptr<LoadBalancer>;
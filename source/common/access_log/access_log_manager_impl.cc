@@ -1,5 +1,6 @@
 #include "common/access_log/access_log_manager_impl.h"
 
+#include <algorithm>
 #include <string>
 
 #include "common/common/assert.h"
@@ -7,6 +8,7 @@
 #include "common/common/lock_guard.h"
 
 #include "absl/container/fixed_array.h"
+#include "absl/hash/hash.h"
 
 namespace Envoy {
 namespace AccessLog {
@@ -30,23 +32,136 @@ AccessLogFileSharedPtr AccessLogManagerImpl::createAccessLog(const std::string&
     return access_logs_[file_name];
   }
 
+  if (flusher_ == nullptr) {
+    flusher_ = std::make_shared<AccessLogFlusher>(api_.threadFactory(), file_stats_);
+  }
   access_logs_[file_name] = std::make_shared<AccessLogFileImpl>(
       api_.fileSystem().createFile(file_name), dispatcher_, lock_, file_stats_,
-      file_flush_interval_msec_, api_.threadFactory());
+      file_flush_interval_msec_, api_.threadFactory(), api_.timeSource(), flusher_);
   return access_logs_[file_name];
 }
 
+AccessLogFlusher::AccessLogFlusher(Thread::ThreadFactory& thread_factory,
+                                   AccessLogFileStats& stats)
+    : thread_factory_(thread_factory), stats_(stats) {}
+
+AccessLogFlusher::~AccessLogFlusher() {
+  std::vector<Thread::ThreadPtr> flush_threads;
+  {
+    Thread::LockGuard lock(lock_);
+    // Files hold a reference to the flusher, so all of them are gone by now.
+    ASSERT(queue_.empty());
+    exit_ = true;
+    flush_event_.notifyAll();
+    flush_threads.swap(flush_threads_);
+  }
+  for (Thread::ThreadPtr& flush_thread : flush_threads) {
+    flush_thread->join();
+  }
+}
+
+void AccessLogFlusher::requestFlush(AccessLogFileImpl& file) {
+  if (file.flush_requested_.exchange(true)) {
+    return;
+  }
+
+  Thread::LockGuard lock(lock_);
+  queue_.push_back(&file);
+  stats_.flush_queue_depth_.set(queue_.size());
+  if (idle_threads_ == 0 && flush_threads_.size() < MAX_FLUSH_THREADS &&
+      !flushing_.contains(&file)) {
+    // All threads are busy, possibly stuck on files that can't be written to. Add one, so that
+    // this file doesn't have to wait for them.
+    flush_threads_.push_back(thread_factory_.createThread(
+        [this]() -> void { flushThreadFunc(); }, Thread::Options{"AccessLogFlush"}));
+  }
+  // A thread may skip this file if it's being flushed, so wake them all.
+  flush_event_.notifyAll();
+}
+
+void AccessLogFlusher::remove(AccessLogFileImpl& file) {
+  Thread::LockGuard lock(lock_);
+  queue_.erase(std::remove(queue_.begin(), queue_.end(), &file), queue_.end());
+  stats_.flush_queue_depth_.set(queue_.size());
+  while (flushing_.contains(&file)) {
+    // CondVar::wait() does not throw, so it's safe to pass the mutex rather than the guard.
+    flushed_event_.wait(lock_);
+  }
+}
+
+void AccessLogFlusher::addWriteLatency(std::chrono::microseconds latency) {
+  Thread::LockGuard lock(lock_);
+  if (pending_latencies_.size() < MAX_PENDING_LATENCIES) {
+    pending_latencies_.push_back(latency.count());
+  }
+}
+
+void AccessLogFlusher::recordWriteLatencies() {
+  std::vector<uint64_t> latencies;
+  {
+    Thread::LockGuard lock(lock_);
+    latencies.swap(pending_latencies_);
+  }
+  for (const uint64_t latency : latencies) {
+    stats_.write_latency_us_.recordValue(latency);
+  }
+}
+
+std::deque<AccessLogFileImpl*>::iterator AccessLogFlusher::nextFlushable() {
+  return std::find_if(queue_.begin(), queue_.end(),
+                      [this](AccessLogFileImpl* file) { return !flushing_.contains(file); });
+}
+
+void AccessLogFlusher::flushThreadFunc() {
+  while (true) {
+    AccessLogFileImpl* file;
+    {
+      Thread::LockGuard lock(lock_);
+      // A file queued again while it is being flushed waits for that flush to finish, rather than
+      // holding up a second thread on its flush lock.
+      ++idle_threads_;
+      while (nextFlushable() == queue_.end() && !exit_) {
+        flush_event_.wait(lock_);
+      }
+      --idle_threads_;
+
+      if (exit_) {
+        return;
+      }
+
+      const auto next = nextFlushable();
+      file = *next;
+      queue_.erase(next);
+      stats_.flush_queue_depth_.set(queue_.size());
+      flushing_.insert(file);
+    }
+
+    file->flushPending();
+
+    {
+      Thread::LockGuard lock(lock_);
+      flushing_.erase(file);
+      flushed_event_.notifyAll();
+      // The file may have been queued again meanwhile.
+      flush_event_.notifyAll();
+    }
+  }
+}
+
 AccessLogFileImpl::AccessLogFileImpl(Filesystem::FilePtr&& file, Event::Dispatcher& dispatcher,
                                      Thread::BasicLockable& lock, AccessLogFileStats& stats,
                                      std::chrono::milliseconds flush_interval_msec,
-                                     Thread::ThreadFactory& thread_factory)
+                                     Thread::ThreadFactory& thread_factory,
+                                     TimeSource& time_source, AccessLogFlusherSharedPtr flusher)
     : file_(std::move(file)), file_lock_(lock),
       flush_timer_(dispatcher.createTimer([this]() -> void {
         stats_.flushed_by_timer_.inc();
-        flush_event_.notifyOne();
+        flusher_->requestFlush(*this);
+        flusher_->recordWriteLatencies();
         flush_timer_->enableTimer(flush_interval_msec_);
       })),
-      thread_factory_(thread_factory), flush_interval_msec_(flush_interval_msec), stats_(stats) {
+      thread_factory_(thread_factory), time_source_(time_source),
+      flush_interval_msec_(flush_interval_msec), stats_(stats), flusher_(std::move(flusher)) {
   open();
 }
 
@@ -69,21 +184,12 @@ void AccessLogFileImpl::open() {
 void AccessLogFileImpl::reopen() { reopen_file_ = true; }
 
 AccessLogFileImpl::~AccessLogFileImpl() {
-  {
-    Thread::LockGuard lock(write_lock_);
-    flush_thread_exit_ = true;
-    flush_event_.notifyOne();
-  }
-
-  if (flush_thread_ != nullptr) {
-    flush_thread_->join();
-  }
+  flusher_->remove(*this);
 
   // Flush any remaining data. If file was not opened for some reason, skip flushing part.
   if (file_->isOpen()) {
-    if (flush_buffer_.length() > 0) {
-      doWrite(flush_buffer_);
-    }
+    stageForWrite();
+    doWrite(about_to_write_buffer_);
 
     const Api::IoCallBoolResult result = file_->close();
     ASSERT(result.rc_, fmt::format("unable to close file '{}': {}", file_->path(),
@@ -92,121 +198,136 @@ AccessLogFileImpl::~AccessLogFileImpl() {
 }
 
 void AccessLogFileImpl::doWrite(Buffer::Instance& buffer) {
+  if (buffer.length() == 0) {
+    return;
+  }
+
   Buffer::RawSliceVector slices = buffer.getRawSlices();
+  absl::FixedArray<absl::string_view> data(slices.size());
+  for (size_t i = 0; i < slices.size(); i++) {
+    data[i] = absl::string_view(static_cast<char*>(slices[i].mem_), slices[i].len_);
+  }
 
+  writeToFile(data, buffer.length());
+  stats_.write_total_buffered_.sub(buffer.length());
+  buffer.drain(buffer.length());
+}
+
+void AccessLogFileImpl::writeToFile(absl::Span<const absl::string_view> data, uint64_t length) {
   // We must do the actual writes to disk under lock, so that we don't intermix chunks from
   // different AccessLogFileImpl pointing to the same underlying file. This can happen either via
   // hot restart or if calling code opens the same underlying file into a different
   // AccessLogFileImpl in the same process.
   // TODO PERF: Currently, we use a single cross process lock to serialize all disk writes. This
-  //            will never block network workers, but does mean that only a single flush thread can
+  //            will never block network workers, but does mean that only a single thread can
   //            actually flush to disk. In the future it would be nice if we did away with the cross
   //            process lock or had multiple locks.
   {
     Thread::LockGuard lock(file_lock_);
-    for (const Buffer::RawSlice& slice : slices) {
-      absl::string_view data(static_cast<char*>(slice.mem_), slice.len_);
-      const Api::IoCallSizeResult result = file_->write(data);
-      if (result.ok() && result.rc_ == static_cast<ssize_t>(slice.len_)) {
-        stats_.write_completed_.inc();
-      } else {
-        // Probably disk full.
-        stats_.write_failed_.inc();
-      }
+    const MonotonicTime start = time_source_.monotonicTime();
+    const Api::IoCallSizeResult result = file_->writev(data);
+    flusher_->addWriteLatency(std::chrono::duration_cast<std::chrono::microseconds>(
+        time_source_.monotonicTime() - start));
+    if (result.ok() && result.rc_ == static_cast<ssize_t>(length)) {
+      stats_.write_completed_.inc();
+    } else {
+      // Probably disk full.
+      stats_.write_failed_.inc();
     }
   }
-
-  stats_.write_total_buffered_.sub(buffer.length());
-  buffer.drain(buffer.length());
 }
 
-void AccessLogFileImpl::flushThreadFunc() {
-
-  while (true) {
-    std::unique_lock<Thread::BasicLockable> flush_lock;
+void AccessLogFileImpl::writeHeaders() {
+  if (headers_.empty()) {
+    return;
+  }
 
-    {
-      Thread::LockGuard write_lock(write_lock_);
+  absl::FixedArray<absl::string_view> data(headers_.size());
+  uint64_t length = 0;
+  for (size_t i = 0; i < headers_.size(); i++) {
+    data[i] = headers_[i];
+    length += headers_[i].size();
+  }
+  writeToFile(data, length);
+}
 
-      // flush_event_ can be woken up either by large enough flush_buffer or by timer.
-      // In case it was timer, flush_buffer_ can be empty.
-      while (flush_buffer_.length() == 0 && !flush_thread_exit_ && !reopen_file_) {
-        // CondVar::wait() does not throw, so it's safe to pass the mutex rather than the guard.
-        flush_event_.wait(write_lock_);
-      }
+void AccessLogFileImpl::stageForWrite() {
+  for (StagingBuffer& staging : staging_buffers_) {
+    Thread::LockGuard lock(staging.lock_);
+    staged_bytes_ -= staging.buffer_.length();
+    about_to_write_buffer_.move(staging.buffer_);
+  }
+}
 
-      if (flush_thread_exit_) {
-        return;
-      }
+void AccessLogFileImpl::flushPending() {
+  // Writes from here on need another flush.
+  flush_requested_ = false;
 
-      flush_lock = std::unique_lock<Thread::BasicLockable>(flush_lock_);
-      about_to_write_buffer_.move(flush_buffer_);
-      ASSERT(flush_buffer_.length() == 0);
-    }
+  Thread::LockGuard flush_lock(flush_lock_);
+  stageForWrite();
 
-    // if we failed to open file before, then simply ignore
-    if (file_->isOpen()) {
-      try {
-        if (reopen_file_) {
-          reopen_file_ = false;
-          const Api::IoCallBoolResult result = file_->close();
-          ASSERT(result.rc_, fmt::format("unable to close file '{}': {}", file_->path(),
-                                         result.err_->getErrorDetails()));
-          open();
-        }
-
-        doWrite(about_to_write_buffer_);
-      } catch (const EnvoyException&) {
-        stats_.reopen_failed_.inc();
+  // if we failed to open file before, then simply ignore
+  if (file_->isOpen()) {
+    try {
+      if (reopen_file_) {
+        reopen_file_ = false;
+        const Api::IoCallBoolResult result = file_->close();
+        ASSERT(result.rc_, fmt::format("unable to close file '{}': {}", file_->path(),
+                                       result.err_->getErrorDetails()));
+        open();
+        writeHeaders();
       }
+
+      doWrite(about_to_write_buffer_);
+    } catch (const EnvoyException&) {
+      stats_.reopen_failed_.inc();
     }
   }
 }
 
 void AccessLogFileImpl::flush() {
-  std::unique_lock<Thread::BasicLockable> flush_buffer_lock;
-
-  {
-    Thread::LockGuard write_lock(write_lock_);
-
-    // flush_lock_ must be held while checking this or else it is
-    // possible that flushThreadFunc() has already moved data from
-    // flush_buffer_ to about_to_write_buffer_, has unlocked write_lock_,
-    // but has not yet completed doWrite(). This would allow flush() to
-    // return before the pending data has actually been written to disk.
-    flush_buffer_lock = std::unique_lock<Thread::BasicLockable>(flush_lock_);
-
-    if (flush_buffer_.length() == 0) {
-      return;
-    }
+  // flush_lock_ makes this wait for a flush in progress on a flush thread, so that data it has
+  // already taken from the staging buffers is on disk when this returns.
+  Thread::LockGuard flush_lock(flush_lock_);
+  stageForWrite();
+  doWrite(about_to_write_buffer_);
+}
 
-    about_to_write_buffer_.move(flush_buffer_);
-    ASSERT(flush_buffer_.length() == 0);
+void AccessLogFileImpl::addHeader(uint64_t id, absl::string_view data) {
+  // The header bypasses the staging buffers, where it could end up behind data that other threads
+  // stage after it returns. flush_lock_ keeps it from being written twice by a concurrent reopen.
+  Thread::LockGuard flush_lock(flush_lock_);
+  if (!header_ids_.insert(id).second) {
+    // Already in the file, e.g. added by the logger this one replaces on a listener update.
+    return;
+  }
+  headers_.emplace_back(data);
+  if (file_->isOpen()) {
+    const absl::string_view header = headers_.back();
+    writeToFile(absl::MakeConstSpan(&header, 1), header.size());
   }
-
-  doWrite(about_to_write_buffer_);
 }
 
 void AccessLogFileImpl::write(absl::string_view data) {
-  Thread::LockGuard lock(write_lock_);
-
-  if (flush_thread_ == nullptr) {
-    createFlushStructures();
+  StagingBuffer& staging =
+      staging_buffers_[absl::Hash<Thread::ThreadId>()(thread_factory_.currentThreadId()) %
+                       NUM_STAGING_BUFFERS];
+  {
+    Thread::LockGuard lock(staging.lock_);
+    staging.buffer_.add(data.data(), data.size());
+    staged_bytes_ += data.size();
   }
 
   stats_.write_buffered_.inc();
   stats_.write_total_buffered_.add(data.length());
-  flush_buffer_.add(data.data(), data.size());
-  if (flush_buffer_.length() > MIN_FLUSH_SIZE) {
-    flush_event_.notifyOne();
+  if (!flush_timer_enabled_.exchange(true)) {
+    // Flush the first write right away, so that a new log shows up without waiting for the timer.
+    flush_timer_->enableTimer(flush_interval_msec_);
+    flusher_->requestFlush(*this);
+  } else if (staged_bytes_ > MIN_FLUSH_SIZE) {
+    flusher_->requestFlush(*this);
   }
 }
 
-void AccessLogFileImpl::createFlushStructures() {
-  flush_thread_ = thread_factory_.createThread([this]() -> void { flushThreadFunc(); },
-                                               Thread::Options{"AccessLogFlush"});
-  flush_timer_->enableTimer(flush_interval_msec_);
-}
-
 } // namespace AccessLog
 } // namespace Envoy
@@ -1,9 +1,16 @@
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <memory>
 #include <string>
+#include <vector>
 
 #include "envoy/access_log/access_log.h"
 #include "envoy/api/api.h"
+#include "envoy/common/time.h"
 #include "envoy/event/dispatcher.h"
 #include "envoy/filesystem/filesystem.h"
 #include "envoy/stats/stats_macros.h"
@@ -13,33 +20,41 @@
 #include "common/common/logger.h"
 #include "common/common/thread.h"
 
+#include "absl/container/flat_hash_set.h"
 #include "absl/container/node_hash_map.h"
 
 namespace Envoy {
 
-#define ACCESS_LOG_FILE_STATS(COUNTER, GAUGE)                                                      \
+#define ACCESS_LOG_FILE_STATS(COUNTER, GAUGE, HISTOGRAM)                                           \
   COUNTER(flushed_by_timer)                                                                        \
   COUNTER(reopen_failed)                                                                           \
   COUNTER(write_buffered)                                                                          \
   COUNTER(write_completed)                                                                         \
   COUNTER(write_failed)                                                                            \
-  GAUGE(write_total_buffered, Accumulate)
+  GAUGE(flush_queue_depth, NeverImport)                                                            \
+  GAUGE(write_total_buffered, Accumulate)                                                          \
+  HISTOGRAM(write_latency_us, Microseconds)
 
 struct AccessLogFileStats {
-  ACCESS_LOG_FILE_STATS(GENERATE_COUNTER_STRUCT, GENERATE_GAUGE_STRUCT)
+  ACCESS_LOG_FILE_STATS(GENERATE_COUNTER_STRUCT, GENERATE_GAUGE_STRUCT, GENERATE_HISTOGRAM_STRUCT)
 };
 
 namespace AccessLog {
 
+class AccessLogFileImpl;
+class AccessLogFlusher;
+using AccessLogFlusherSharedPtr = std::shared_ptr<AccessLogFlusher>;
+
 class AccessLogManagerImpl : public AccessLogManager, Logger::Loggable<Logger::Id::main> {
 public:
   AccessLogManagerImpl(std::chrono::milliseconds file_flush_interval_msec, Api::Api& api,
                        Event::Dispatcher& dispatcher, Thread::BasicLockable& lock,
                        Stats::Store& stats_store)
       : file_flush_interval_msec_(file_flush_interval_msec), api_(api), dispatcher_(dispatcher),
-        lock_(lock), file_stats_{
-                         ACCESS_LOG_FILE_STATS(POOL_COUNTER_PREFIX(stats_store, "filesystem."),
-                                               POOL_GAUGE_PREFIX(stats_store, "filesystem."))} {}
+        lock_(lock),
+        file_stats_{ACCESS_LOG_FILE_STATS(POOL_COUNTER_PREFIX(stats_store, "filesystem."),
+                                          POOL_GAUGE_PREFIX(stats_store, "filesystem."),
+                                          POOL_HISTOGRAM_PREFIX(stats_store, "filesystem."))} {}
   ~AccessLogManagerImpl() override;
 
   // AccessLog::AccessLogManager
@@ -52,26 +67,90 @@ private:
   Event::Dispatcher& dispatcher_;
   Thread::BasicLockable& lock_;
   AccessLogFileStats file_stats_;
+  // Shared by all files, and created with the first one.
+  AccessLogFlusherSharedPtr flusher_;
   absl::node_hash_map<std::string, AccessLogFileSharedPtr> access_logs_;
 };
 
+/**
+ * Writes the buffered data of access log files to disk, on a small pool of flush threads shared by
+ * all files. Files queue themselves for a flush when enough data is buffered or their flush timer
+ * fires, and are served in that order. A file is only flushed by one thread at a time, so a file
+ * whose writes stall (a hung network filesystem, a full pipe) only holds up the thread flushing it.
+ * Threads are added while all of them are busy, up to MAX_FLUSH_THREADS, so that the other files
+ * keep being flushed. The flusher lives as long as any of its files.
+ */
+class AccessLogFlusher {
+public:
+  AccessLogFlusher(Thread::ThreadFactory& thread_factory, AccessLogFileStats& stats);
+  ~AccessLogFlusher();
+
+  /**
+   * Queues file for a flush on a flush thread, unless it already is.
+   */
+  void requestFlush(AccessLogFileImpl& file);
+
+  /**
+   * Removes file from the queue, and waits for a flush thread to finish flushing it if one is.
+   * The flusher doesn't touch file once this returns.
+   */
+  void remove(AccessLogFileImpl& file);
+
+  /**
+   * Records the duration of a disk write, which may happen on any thread. Histograms can only be
+   * recorded on threads registered with thread local storage, so the durations are kept until
+   * the next call to recordWriteLatencies().
+   */
+  void addWriteLatency(std::chrono::microseconds latency);
+
+  /**
+   * Records the write durations kept since the last call. Must be called on the main thread.
+   */
+  void recordWriteLatencies();
+
+private:
+  void flushThreadFunc();
+  // Returns the position of the first queued file that no thread is flushing, or the end of the
+  // queue if there is none.
+  std::deque<AccessLogFileImpl*>::iterator nextFlushable() ABSL_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  // Write durations kept beyond this many are dropped until they are recorded.
+  static const size_t MAX_PENDING_LATENCIES = 1024;
+  static const size_t MAX_FLUSH_THREADS = 8;
+
+  Thread::ThreadFactory& thread_factory_;
+  AccessLogFileStats& stats_;
+  Thread::MutexBasicLockable lock_;
+  Thread::CondVar flush_event_;
+  Thread::CondVar flushed_event_;
+  std::deque<AccessLogFileImpl*> queue_ ABSL_GUARDED_BY(lock_);
+  // The files being flushed on the flush threads.
+  absl::flat_hash_set<AccessLogFileImpl*> flushing_ ABSL_GUARDED_BY(lock_);
+  // Flush threads waiting for a file to flush.
+  size_t idle_threads_ ABSL_GUARDED_BY(lock_){};
+  bool exit_ ABSL_GUARDED_BY(lock_){};
+  std::vector<uint64_t> pending_latencies_ ABSL_GUARDED_BY(lock_);
+  std::vector<Thread::ThreadPtr> flush_threads_ ABSL_GUARDED_BY(lock_);
+};
+
 /**
  * This is a file implementation geared for writing out access logs. It turn out that in certain
  * cases even if a standard file is opened with O_NONBLOCK, the kernel can still block when writing.
- * This implementation uses a flush thread per file, with the idea there aren't that many
- * files. If this turns out to be a good implementation we can potentially have a single flush
- * thread that flushes all files, but we will start with this.
+ * Writes are buffered in memory and then written to disk by a flush thread of an AccessLogFlusher
+ * shared with all other files, in a single vectored write per flush.
  */
 class AccessLogFileImpl : public AccessLogFile {
 public:
   AccessLogFileImpl(Filesystem::FilePtr&& file, Event::Dispatcher& dispatcher,
                     Thread::BasicLockable& lock, AccessLogFileStats& stats,
                     std::chrono::milliseconds flush_interval_msec,
-                    Thread::ThreadFactory& thread_factory);
+                    Thread::ThreadFactory& thread_factory, TimeSource& time_source,
+                    AccessLogFlusherSharedPtr flusher);
   ~AccessLogFileImpl() override;
 
   // AccessLog::AccessLogFile
   void write(absl::string_view data) override;
+  void addHeader(uint64_t id, absl::string_view data) override;
 
   /**
    * Reopen file asynchronously.
@@ -82,58 +161,73 @@ public:
   void flush() override;
 
 private:
+  friend class AccessLogFlusher;
+
+  // Buffers writes from the threads that hash to it. Sharding the buffer by thread keeps workers
+  // that log to the same file from contending on one lock. Each thread's writes stay in order.
+  struct StagingBuffer {
+    Thread::MutexBasicLockable lock_;
+    Buffer::OwnedImpl buffer_ ABSL_GUARDED_BY(lock_);
+  };
+
   void doWrite(Buffer::Instance& buffer);
-  void flushThreadFunc();
+  // Writes data, which is length bytes in total, to disk under file_lock_.
+  void writeToFile(absl::Span<const absl::string_view> data, uint64_t length);
+  // Writes all headers to disk, right after the file is opened.
+  void writeHeaders() ABSL_EXCLUSIVE_LOCKS_REQUIRED(flush_lock_);
+  // Called by the flusher on one of its flush threads.
+  void flushPending();
+  // Moves the contents of all staging buffers into about_to_write_buffer_.
+  void stageForWrite();
   void open();
-  void createFlushStructures();
 
   // return default flags set which used by open
   static Filesystem::FlagSet defaultFlags();
 
   // Minimum size before the flush thread will be told to flush.
   static const uint64_t MIN_FLUSH_SIZE = 1024 * 64;
+  static const size_t NUM_STAGING_BUFFERS = 16;
 
   Filesystem::FilePtr file_;
 
   // These locks are always acquired in the following order if multiple locks are held:
-  //    1) write_lock_
-  //    2) flush_lock_
+  //    1) flush_lock_
+  //    2) StagingBuffer::lock_
   //    3) file_lock_
-  Thread::BasicLockable& file_lock_;      // This lock is used only by the flush thread when writing
-                                          // to disk. This is used to make sure that file blocks do
-                                          // not get interleaved by multiple processes writing to
-                                          // the same file during hot-restart.
+  Thread::BasicLockable& file_lock_;      // This lock is used only when writing to disk. This is
+                                          // used to make sure that file blocks do not get
+                                          // interleaved by multiple processes writing to the same
+                                          // file during hot-restart.
   Thread::MutexBasicLockable flush_lock_; // This lock is used to prevent simultaneous flushes from
                                           // the flush thread and a synchronous flush. This protects
                                           // concurrent access to the about_to_write_buffer_, fd_,
                                           // and all other data used during flushing and file
                                           // re-opening.
-  Thread::MutexBasicLockable
-      write_lock_; // The lock is used when filling the flush buffer. It allows
-                   // multiple threads to write to the same file at relatively
-                   // high performance. It is always local to the process.
-  Thread::ThreadPtr flush_thread_;
-  Thread::CondVar flush_event_;
-  std::atomic<bool> flush_thread_exit_{};
+  std::array<StagingBuffer, NUM_STAGING_BUFFERS> staging_buffers_;
+  // Written straight to disk rather than staged, so that they precede any data staged after them.
+  std::vector<std::string> headers_ ABSL_GUARDED_BY(flush_lock_);
+  // The ids of headers_, so that each header is only added once however many loggers add it.
+  absl::flat_hash_set<uint64_t> header_ids_ ABSL_GUARDED_BY(flush_lock_);
+  // Bytes in the staging buffers.
+  std::atomic<uint64_t> staged_bytes_{};
   std::atomic<bool> reopen_file_{};
-  Buffer::OwnedImpl
-      flush_buffer_ ABSL_GUARDED_BY(write_lock_); // This buffer is used by multiple threads. It
-                                                  // gets filled and then flushed either when max
-                                                  // size is reached or when a timer fires.
+  std::atomic<bool> flush_requested_{};
+  std::atomic<bool> flush_timer_enabled_{};
   // TODO(jmarantz): this should be ABSL_GUARDED_BY(flush_lock_) but the analysis cannot poke
   // through the std::make_unique assignment. I do not believe it's possible to annotate this
   // properly now due to limitations in the clang thread annotation analysis.
-  Buffer::OwnedImpl about_to_write_buffer_; // This buffer is used only by the flush thread. Data
-                                            // is moved from flush_buffer_ under lock, and then
-                                            // the lock is released so that flush_buffer_ can
-                                            // continue to fill. This buffer is then used for the
-                                            // final write to disk.
+  Buffer::OwnedImpl about_to_write_buffer_; // Data is moved from the staging buffers under their
+                                            // locks, and then the locks are released so that they
+                                            // can continue to fill. This buffer is then used for
+                                            // the final write to disk.
   Event::TimerPtr flush_timer_;
   Thread::ThreadFactory& thread_factory_;
+  TimeSource& time_source_;
   const std::chrono::milliseconds flush_interval_msec_; // Time interval buffer gets flushed no
                                                         // matter if it reached the MIN_FLUSH_SIZE
                                                         // or not.
   AccessLogFileStats& stats_;
+  const AccessLogFlusherSharedPtr flusher_;
 };
 
 } // namespace AccessLog
@@ -192,6 +192,46 @@ SysCallIntResult OsSysCallsImpl::socketpair(int domain, int type, int protocol,
   return {rc, rc != -1 ? 0 : errno};
 }
 
+SysCallIntResult OsSysCallsImpl::pipe(os_fd_t fds[2]) {
+#if defined(__linux__)
+  const int rc = ::pipe2(fds, O_NONBLOCK | O_CLOEXEC);
+  return {rc, rc != -1 ? 0 : errno};
+#else
+  int rc = ::pipe(fds);
+  for (int i = 0; i < 2 && rc != -1; i++) {
+    rc = ::fcntl(fds[i], F_SETFL, ::fcntl(fds[i], F_GETFL, 0) | O_NONBLOCK);
+    if (rc == -1) {
+      const int error = errno;
+      ::close(fds[0]);
+      ::close(fds[1]);
+      return {rc, error};
+    }
+  }
+  return {rc, rc != -1 ? 0 : errno};
+#endif
+}
+
+SysCallSizeResult OsSysCallsImpl::splice(os_fd_t fd_in, os_fd_t fd_out, size_t len) {
+#if defined(__linux__)
+  const ssize_t rc =
+      ::splice(fd_in, nullptr, fd_out, nullptr, len, SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+  return {rc, rc != -1 ? 0 : errno};
+#else
+  UNREFERENCED_PARAMETER(fd_in);
+  UNREFERENCED_PARAMETER(fd_out);
+  UNREFERENCED_PARAMETER(len);
+  NOT_IMPLEMENTED_GCOVR_EXCL_LINE;
+#endif
+}
+
+bool OsSysCallsImpl::supportsSplice() const {
+#if defined(__linux__)
+  return true;
+#else
+  return false;
+#endif
+}
+
 SysCallIntResult OsSysCallsImpl::listen(os_fd_t sockfd, int backlog) {
   const int rc = ::listen(sockfd, backlog);
   return {rc, rc != -1 ? 0 : errno};
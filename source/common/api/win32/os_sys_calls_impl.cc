@@ -339,6 +339,14 @@ SysCallIntResult OsSysCallsImpl::socketpair(int domain, int type, int protocol,
   return {0, 0};
 }
 
+SysCallIntResult OsSysCallsImpl::pipe(os_fd_t[2]) { NOT_IMPLEMENTED_GCOVR_EXCL_LINE; }
+
+SysCallSizeResult OsSysCallsImpl::splice(os_fd_t, os_fd_t, size_t) {
+  NOT_IMPLEMENTED_GCOVR_EXCL_LINE;
+}
+
+bool OsSysCallsImpl::supportsSplice() const { return false; }
+
 SysCallIntResult OsSysCallsImpl::listen(os_fd_t sockfd, int backlog) {
   const int rc = ::listen(sockfd, backlog);
   return {rc, rc != -1 ? 0 : ::WSAGetLastError()};
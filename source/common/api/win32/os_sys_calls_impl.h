@@ -43,6 +43,9 @@ public:
   SysCallIntResult connect(os_fd_t sockfd, const sockaddr* addr, socklen_t addrlen) override;
   SysCallIntResult shutdown(os_fd_t sockfd, int how) override;
   SysCallIntResult socketpair(int domain, int type, int protocol, os_fd_t sv[2]) override;
+  SysCallIntResult pipe(os_fd_t fds[2]) override;
+  SysCallSizeResult splice(os_fd_t fd_in, os_fd_t fd_out, size_t len) override;
+  bool supportsSplice() const override;
   SysCallIntResult listen(os_fd_t sockfd, int backlog) override;
   SysCallSizeResult write(os_fd_t socket, const void* buffer, size_t length) override;
   SysCallSocketResult accept(os_fd_t socket, sockaddr* addr, socklen_t* addrlen) override;
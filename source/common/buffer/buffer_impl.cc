@@ -1,9 +1,15 @@
 #include "common/buffer/buffer_impl.h"
 
+#include <atomic>
 #include <cstdint>
 #include <string>
+#include <vector>
 
 #include "common/common/assert.h"
+#include "common/common/lock_guard.h"
+#include "common/common/macros.h"
+#include "common/common/thread.h"
+#include "common/common/thread_annotations.h"
 
 #include "absl/container/fixed_array.h"
 #include "event2/buffer.h"
@@ -16,14 +22,268 @@ namespace {
 // TODO(yanavlasov): This may not be optimal for all hardware configurations or traffic patterns and
 // may need to be configurable in the future.
 constexpr uint64_t CopyThreshold = 512;
+
+// A free slice, linked through its own memory.
+struct FreeSlice {
+  FreeSlice* next_;
+  uint64_t pages_;
+};
 } // namespace
 
+/**
+ * The slices cached for a thread, in a free list per size class. Only the thread which owns the
+ * cache uses its free lists. Other threads push the slices they free to its return queue. When the
+ * thread exits, its cache is orphaned: its free slices are deleted, and it is kept to be owned by
+ * the next thread which starts, so that slices which are still alive always have a cache to
+ * return to.
+ */
+class SliceCache {
+public:
+  /**
+   * @return SliceCache* an orphaned cache, or a new one, for the calling thread to own.
+   */
+  static SliceCache* acquire();
+
+  /**
+   * @return SliceCacheStats the statistics of all caches.
+   */
+  static SliceCacheStats stats();
+
+  /**
+   * Allocates a slice from the owner's cache.
+   * @param pages the size class of the slice.
+   * @return void* the slice, or nullptr if none is cached.
+   */
+  void* allocate(uint64_t pages);
+
+  /**
+   * Frees a slice to the owner's cache.
+   * @param slice the slice.
+   * @param pages the size class of the slice.
+   * @return bool whether the slice was cached. It must be deleted if not.
+   */
+  bool free(void* slice, uint64_t pages);
+
+  /**
+   * Frees a slice from a thread other than the owner, pushing it to the return queue.
+   * @param slice the slice.
+   * @param pages the size class of the slice.
+   */
+  void freeRemote(void* slice, uint64_t pages);
+
+  /**
+   * Deletes the cached slices when the owner exits, leaving the cache to the next thread.
+   */
+  void orphan();
+
+private:
+  struct Registry {
+    Thread::MutexBasicLockable mutex_;
+    std::vector<SliceCache*> caches_ ABSL_GUARDED_BY(mutex_);
+  };
+
+  static Registry& registry() { MUTABLE_CONSTRUCT_ON_FIRST_USE(Registry); }
+  static void deleteSlices(FreeSlice* slices);
+  // Moves the slices of the return queue to the free lists.
+  void takeReturned();
+  // Only the owner writes the statistics, but stats() reads them from any thread.
+  static void add(std::atomic<uint64_t>& value, int64_t amount) {
+    value.store(value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+  }
+
+  FreeSlice* heads_[OwnedSlice::MaxCachedPages + 1]{};
+  uint64_t size_class_bytes_[OwnedSlice::MaxCachedPages + 1]{};
+  std::atomic<uint64_t> bytes_{};
+  std::atomic<uint64_t> hits_{};
+  std::atomic<uint64_t> misses_{};
+  std::atomic<FreeSlice*> returned_{};
+  std::atomic<bool> orphaned_{};
+};
+
+SliceCache* SliceCache::acquire() {
+  Registry& registry = SliceCache::registry();
+  Thread::LockGuard lock(registry.mutex_);
+  for (SliceCache* cache : registry.caches_) {
+    if (cache->orphaned_) {
+      cache->orphaned_ = false;
+      return cache;
+    }
+  }
+  // Caches are never deleted, as slices of any thread which ever ran may still be alive.
+  registry.caches_.push_back(new SliceCache());
+  return registry.caches_.back();
+}
+
+SliceCacheStats SliceCache::stats() {
+  SliceCacheStats stats;
+  Registry& registry = SliceCache::registry();
+  Thread::LockGuard lock(registry.mutex_);
+  for (const SliceCache* cache : registry.caches_) {
+    stats.hits_ += cache->hits_.load(std::memory_order_relaxed);
+    stats.misses_ += cache->misses_.load(std::memory_order_relaxed);
+    stats.bytes_cached_ += cache->bytes_.load(std::memory_order_relaxed);
+  }
+  return stats;
+}
+
+void* SliceCache::allocate(uint64_t pages) {
+  if (heads_[pages] == nullptr && returned_.load(std::memory_order_relaxed) != nullptr) {
+    takeReturned();
+  }
+  FreeSlice* slice = heads_[pages];
+  if (slice == nullptr) {
+    add(misses_, 1);
+    return nullptr;
+  }
+  heads_[pages] = slice->next_;
+  size_class_bytes_[pages] -= pages * OwnedSlice::PageSize;
+  add(bytes_, -static_cast<int64_t>(pages * OwnedSlice::PageSize));
+  add(hits_, 1);
+  return slice;
+}
+
+bool SliceCache::free(void* address, uint64_t pages) {
+  const uint64_t size = pages * OwnedSlice::PageSize;
+  if (size_class_bytes_[pages] + size > OwnedSlice::MaxCachedBytesPerSizeClass ||
+      bytes_.load(std::memory_order_relaxed) + size > OwnedSlice::MaxCachedBytes) {
+    return false;
+  }
+  FreeSlice* slice = static_cast<FreeSlice*>(address);
+  slice->next_ = heads_[pages];
+  heads_[pages] = slice;
+  size_class_bytes_[pages] += size;
+  add(bytes_, size);
+  return true;
+}
+
+void SliceCache::freeRemote(void* address, uint64_t pages) {
+  FreeSlice* slice = static_cast<FreeSlice*>(address);
+  slice->pages_ = pages;
+  if (orphaned_) {
+    ::operator delete(slice);
+    return;
+  }
+  slice->next_ = returned_.load();
+  while (!returned_.compare_exchange_weak(slice->next_, slice)) {
+  }
+  // The cache may have been orphaned after it was checked, and its return queue emptied for the
+  // last time before the slice was pushed.
+  if (orphaned_) {
+    deleteSlices(returned_.exchange(nullptr));
+  }
+}
+
+void SliceCache::takeReturned() {
+  FreeSlice* slice = returned_.exchange(nullptr, std::memory_order_acquire);
+  while (slice != nullptr) {
+    FreeSlice* next = slice->next_;
+    if (!free(slice, slice->pages_)) {
+      ::operator delete(slice);
+    }
+    slice = next;
+  }
+}
+
+void SliceCache::orphan() {
+  for (uint64_t pages = 0; pages <= OwnedSlice::MaxCachedPages; pages++) {
+    deleteSlices(heads_[pages]);
+    heads_[pages] = nullptr;
+    size_class_bytes_[pages] = 0;
+  }
+  bytes_ = 0;
+  orphaned_ = true;
+  deleteSlices(returned_.exchange(nullptr));
+}
+
+void SliceCache::deleteSlices(FreeSlice* slice) {
+  while (slice != nullptr) {
+    FreeSlice* next = slice->next_;
+    ::operator delete(slice);
+    slice = next;
+  }
+}
+
+namespace {
+// The cache of the thread, acquired on first use.
+struct ThreadSliceCache {
+  ~ThreadSliceCache();
+
+  SliceCache* cache_{};
+};
+
+// Slices may be created and freed while the thread exits, after its cache is orphaned.
+thread_local bool thread_slice_cache_orphaned = false;
+thread_local ThreadSliceCache thread_slice_cache;
+// The number of pages and the cache of the slice being deleted, recorded by its destructor for
+// operator delete.
+thread_local uint64_t deleted_slice_pages = 0;
+thread_local SliceCache* deleted_slice_cache = nullptr;
+
+ThreadSliceCache::~ThreadSliceCache() {
+  thread_slice_cache_orphaned = true;
+  if (cache_ != nullptr) {
+    cache_->orphan();
+  }
+}
+} // namespace
+
+SliceCache* OwnedSlice::threadCache() {
+  if (thread_slice_cache_orphaned) {
+    return nullptr;
+  }
+  if (thread_slice_cache.cache_ == nullptr) {
+    thread_slice_cache.cache_ = SliceCache::acquire();
+  }
+  return thread_slice_cache.cache_;
+}
+
+SliceCacheStats OwnedSlice::cacheStats() { return SliceCache::stats(); }
+
+OwnedSlice::~OwnedSlice() {
+  chargeAccount(nullptr);
+  deleted_slice_pages = (sizeof(OwnedSlice) + capacity_) / PageSize;
+  deleted_slice_cache = cache_;
+}
+
+void* OwnedSlice::operator new(size_t object_size, size_t data_size) {
+  const uint64_t size = object_size + data_size;
+  // sliceSize() makes slices whole pages.
+  ASSERT(size % PageSize == 0);
+  const uint64_t pages = size / PageSize;
+  if (pages <= MaxCachedPages) {
+    SliceCache* cache = threadCache();
+    if (cache != nullptr) {
+      void* slice = cache->allocate(pages);
+      if (slice != nullptr) {
+        return slice;
+      }
+    }
+  }
+  return ::operator new(size);
+}
+
+void OwnedSlice::operator delete(void* address) {
+  const uint64_t pages = deleted_slice_pages;
+  SliceCache* cache = deleted_slice_cache;
+  if (pages <= MaxCachedPages && cache != nullptr) {
+    if (thread_slice_cache_orphaned || cache != thread_slice_cache.cache_) {
+      cache->freeRemote(address, pages);
+      return;
+    }
+    if (cache->free(address, pages)) {
+      return;
+    }
+  }
+  ::operator delete(address);
+}
+
 void OwnedImpl::addImpl(const void* data, uint64_t size) {
   const char* src = static_cast<const char*>(data);
   bool new_slice_needed = slices_.empty();
   while (size != 0) {
     if (new_slice_needed) {
       slices_.emplace_back(OwnedSlice::create(size));
+      slices_.back()->chargeAccount(account_.get());
     }
     uint64_t copy_size = slices_.back()->append(src, size);
     src += copy_size;
@@ -38,6 +298,13 @@ void OwnedImpl::addDrainTracker(std::function<void()> drain_tracker) {
   slices_.back()->addDrainTracker(std::move(drain_tracker));
 }
 
+void OwnedImpl::bindAccount(BufferMemoryAccountSharedPtr account) {
+  for (size_t i = 0; i < slices_.size(); i++) {
+    slices_[i]->chargeAccount(account.get());
+  }
+  account_ = std::move(account);
+}
+
 void OwnedImpl::add(const void* data, uint64_t size) { addImpl(data, size); }
 
 void OwnedImpl::addBufferFragment(BufferFragment& fragment) {
@@ -60,6 +327,7 @@ void OwnedImpl::prepend(absl::string_view data) {
   while (size != 0) {
     if (new_slice_needed) {
       slices_.emplace_front(OwnedSlice::create(size));
+      slices_.front()->chargeAccount(account_.get());
     }
     uint64_t copy_size = slices_.front()->prepend(data.data(), size);
     size -= copy_size;
@@ -75,6 +343,7 @@ void OwnedImpl::prepend(Instance& data) {
     uint64_t slice_size = other.slices_.back()->dataSize();
     length_ += slice_size;
     slices_.emplace_front(std::move(other.slices_.back()));
+    slices_.front()->chargeAccount(account_.get());
     other.slices_.pop_back();
     other.length_ -= slice_size;
   }
@@ -223,8 +492,9 @@ SliceDataPtr OwnedImpl::extractMutableFrontSlice() {
     return mutable_slice;
   } else {
     // Make sure drain trackers are called before ownership of the slice is transferred from
-    // the buffer to the caller.
+    // the buffer to the caller, and that the slice is no longer charged to the buffer's account.
     slice->callAndClearDrainTrackers();
+    slice->chargeAccount(nullptr);
     return slice;
   }
 }
@@ -250,6 +520,7 @@ void* OwnedImpl::linearize(uint32_t size) {
   }
   if (slices_[0]->dataSize() < size) {
     auto new_slice = OwnedSlice::create(size);
+    new_slice->chargeAccount(account_.get());
     Slice::Reservation reservation = new_slice->reserve(size);
     ASSERT(reservation.mem_ != nullptr);
     ASSERT(reservation.len_ == size);
@@ -282,6 +553,7 @@ void OwnedImpl::coalesceOrAddSlice(SlicePtr&& other_slice) {
     other_slice->transferDrainTrackersTo(*slices_.back());
   } else {
     // Take ownership of the slice.
+    other_slice->chargeAccount(account_.get());
     slices_.emplace_back(std::move(other_slice));
     length_ += slice_size;
   }
@@ -386,6 +658,7 @@ uint64_t OwnedImpl::reserve(uint64_t length, RawSlice* iovecs, uint64_t num_iove
   // If needed, allocate one more slice at the end to provide the remainder of the reservation.
   if (bytes_remaining != 0) {
     slices_.emplace_back(OwnedSlice::create(bytes_remaining));
+    slices_.back()->chargeAccount(account_.get());
     iovecs[num_slices_used] = slices_.back()->reserve(bytes_remaining);
     bytes_remaining -= iovecs[num_slices_used].len_;
     num_slices_used++;
@@ -548,6 +821,7 @@ void OwnedImpl::postProcess() {}
 
 void OwnedImpl::appendSliceForTest(const void* data, uint64_t size) {
   slices_.emplace_back(OwnedSlice::create(data, size));
+  slices_.back()->chargeAccount(account_.get());
   length_ += size;
 }
 
@@ -193,6 +193,14 @@ public:
    */
   virtual bool canCoalesce() const { return true; }
 
+  /**
+   * Charge the memory of the slice to an account, crediting the account it was charged to before.
+   * Only slices which own their memory are charged. The account must outlive the slice or the next
+   * call.
+   * @param account the account to charge, or nullptr to only credit the previous one.
+   */
+  virtual void chargeAccount(BufferMemoryAccount*) {}
+
   /**
    * Describe the in-memory representation of the slice. For use
    * in tests that want to make assertions about the specific arrangement of
@@ -254,9 +262,47 @@ protected:
 
 using SlicePtr = std::unique_ptr<Slice>;
 
+class SliceCache;
+
+/**
+ * Statistics of the OwnedSlice caches of all threads.
+ */
+struct SliceCacheStats {
+  // Slices of a cached size class which were allocated from a cache.
+  uint64_t hits_{};
+  // Slices of a cached size class which had to be allocated.
+  uint64_t misses_{};
+  // Bytes of free slices held by the caches.
+  uint64_t bytes_cached_{};
+};
+
 // OwnedSlice can not be derived from as it has variable sized array as member.
 class OwnedSlice final : public Slice, public InlineStorage {
 public:
+  ~OwnedSlice() override;
+
+  /**
+   * Slices are sized in whole pages, and each number of pages up to MaxCachedPages is a size
+   * class. Slices of a size class are allocated from, and freed to, a free list of the cache of
+   * the thread which created them, so that buffers which are drained and refilled at a steady
+   * rate, such as the read buffers of connections, don't allocate once warmed up. Slices freed on
+   * another thread are pushed to a return queue of their cache, which its thread takes back once
+   * its free list of a size class runs out. Each thread caches up to MaxCachedBytesPerSizeClass of
+   * slices of each size class, and up to MaxCachedBytes in total.
+   */
+  static void* operator new(size_t object_size, size_t data_size);
+  static void operator delete(void* address);
+
+  static constexpr uint64_t PageSize = 4096;
+  static constexpr uint64_t MaxCachedPages = 32;
+  static constexpr uint64_t MaxCachedBytesPerSizeClass = 512 * 1024;
+  static constexpr uint64_t MaxCachedBytes = 4 * 1024 * 1024;
+
+  /**
+   * @return SliceCacheStats the statistics of the slice caches of all threads.
+   */
+  static SliceCacheStats cacheStats();
+
   /**
    * Create an empty OwnedSlice.
    * @param capacity number of bytes of space the slice should have.
@@ -283,21 +329,42 @@ public:
   }
 
 private:
-  OwnedSlice(uint64_t size) : Slice(0, 0, size) { base_ = storage_; }
+  OwnedSlice(uint64_t size) : Slice(0, 0, size), cache_(threadCache()) { base_ = storage_; }
+
+  /**
+   * @return SliceCache* the slice cache of the calling thread, or nullptr if the thread is exiting.
+   */
+  static SliceCache* threadCache();
 
   bool isMutable() const override { return true; }
 
+  void chargeAccount(BufferMemoryAccount* account) override {
+    if (account == account_) {
+      return;
+    }
+    if (account_ != nullptr) {
+      account_->credit(sizeof(OwnedSlice) + capacity_);
+    }
+    account_ = account;
+    if (account_ != nullptr) {
+      account_->charge(sizeof(OwnedSlice) + capacity_);
+    }
+  }
+
   /**
    * Compute a slice size big enough to hold a specified amount of data.
    * @param data_size the minimum amount of data the slice must be able to store, in bytes.
    * @return a recommended slice size, in bytes.
    */
   static uint64_t sliceSize(uint64_t data_size) {
-    static constexpr uint64_t PageSize = 4096;
     const uint64_t num_pages = (sizeof(OwnedSlice) + data_size + PageSize - 1) / PageSize;
     return num_pages * PageSize - sizeof(OwnedSlice);
   }
 
+  // The cache of the thread which created the slice.
+  SliceCache* const cache_;
+  // The account of the buffer which holds the slice, if any.
+  BufferMemoryAccount* account_{};
   uint8_t storage_[];
 };
 
@@ -555,6 +622,7 @@ public:
 
   // Buffer::Instance
   void addDrainTracker(std::function<void()> drain_tracker) override;
+  void bindAccount(BufferMemoryAccountSharedPtr account) override;
   void add(const void* data, uint64_t size) override;
   void addBufferFragment(BufferFragment& fragment) override;
   void add(absl::string_view data) override;
@@ -618,6 +686,9 @@ private:
    */
   void coalesceOrAddSlice(SlicePtr&& other_slice);
 
+  /** The account which the slices are charged to. It must outlive them. */
+  BufferMemoryAccountSharedPtr account_;
+
   /** Ring buffer of slices. */
   SliceDeque slices_;
 
@@ -1,6 +1,13 @@
 #include "common/buffer/watermark_buffer.h"
 
+#include <algorithm>
+#include <vector>
+
 #include "common/common/assert.h"
+#include "common/common/lock_guard.h"
+#include "common/common/macros.h"
+#include "common/common/thread.h"
+#include "common/common/thread_annotations.h"
 #include "common/runtime/runtime_features.h"
 
 namespace Envoy {
@@ -131,5 +138,143 @@ void WatermarkBuffer::checkHighAndOverflowWatermarks() {
   }
 }
 
+namespace {
+
+// The factories of all threads, for totalBytesCharged().
+struct FactoryRegistry {
+  Thread::MutexBasicLockable mutex_;
+  absl::flat_hash_set<const WatermarkBufferFactory*> factories_ ABSL_GUARDED_BY(mutex_);
+};
+
+FactoryRegistry& factoryRegistry() { MUTABLE_CONSTRUCT_ON_FIRST_USE(FactoryRegistry); }
+
+} // namespace
+
+BufferMemoryAccountImpl::BufferMemoryAccountImpl(WatermarkBufferFactory& factory,
+                                                 std::function<void()> reset_cb)
+    : factory_(factory), reset_cb_(std::move(reset_cb)) {
+  factory_.onAccountCreated(*this);
+}
+
+BufferMemoryAccountImpl::~BufferMemoryAccountImpl() {
+  ASSERT(balance_ == 0);
+  factory_.onAccountDestroyed(*this);
+}
+
+void BufferMemoryAccountImpl::charge(uint64_t amount) {
+  balance_ += amount;
+  factory_.onCharge(amount);
+}
+
+void BufferMemoryAccountImpl::credit(uint64_t amount) {
+  ASSERT(balance_ >= amount);
+  balance_ -= amount;
+  factory_.onCredit(amount);
+}
+
+void BufferMemoryAccountImpl::reset() {
+  if (reset_cb_ == nullptr) {
+    return;
+  }
+  // The owner may clear the callback while it runs.
+  std::function<void()> reset_cb = std::move(reset_cb_);
+  reset_cb_ = nullptr;
+  reset_cb();
+}
+
+WatermarkBufferFactory::WatermarkBufferFactory() {
+  FactoryRegistry& registry = factoryRegistry();
+  Thread::LockGuard lock(registry.mutex_);
+  registry.factories_.insert(this);
+}
+
+WatermarkBufferFactory::~WatermarkBufferFactory() {
+  ASSERT(accounts_.empty());
+  FactoryRegistry& registry = factoryRegistry();
+  Thread::LockGuard lock(registry.mutex_);
+  registry.factories_.erase(this);
+}
+
+BufferMemoryAccountSharedPtr WatermarkBufferFactory::createAccount(std::function<void()> reset_cb) {
+  return std::make_shared<BufferMemoryAccountImpl>(*this, std::move(reset_cb));
+}
+
+uint64_t WatermarkBufferFactory::resetAccounts(uint64_t bytes_to_free) {
+  // Hold the accounts, as resetting an owner may destroy the accounts of others.
+  std::vector<std::shared_ptr<BufferMemoryAccountImpl>> accounts;
+  for (BufferMemoryAccountImpl* account : accounts_) {
+    if (account->resettable() && account->balance() > 0) {
+      accounts.push_back(account->shared_from_this());
+    }
+  }
+  std::sort(accounts.begin(), accounts.end(),
+            [](const std::shared_ptr<BufferMemoryAccountImpl>& lhs,
+               const std::shared_ptr<BufferMemoryAccountImpl>& rhs) {
+              return lhs->balance() > rhs->balance();
+            });
+
+  uint64_t bytes_freed = 0;
+  for (const auto& account : accounts) {
+    if (bytes_freed >= bytes_to_free) {
+      break;
+    }
+    if (!account->resettable()) {
+      continue;
+    }
+    bytes_freed += account->balance();
+    account->reset();
+    if (stats_ != nullptr) {
+      stats_->accounts_reset_.inc();
+    }
+  }
+  return bytes_freed;
+}
+
+void WatermarkBufferFactory::initializeStats(Stats::Scope& scope, const std::string& prefix) {
+  stats_ = std::make_unique<BufferMemoryStats>(
+      BufferMemoryStats{ALL_BUFFER_MEMORY_STATS(POOL_COUNTER_PREFIX(scope, prefix),
+                                                POOL_GAUGE_PREFIX(scope, prefix))});
+  stats_->accounts_active_.set(accounts_.size());
+  stats_->bytes_charged_.set(bytesCharged());
+}
+
+uint64_t WatermarkBufferFactory::totalBytesCharged() {
+  FactoryRegistry& registry = factoryRegistry();
+  Thread::LockGuard lock(registry.mutex_);
+  uint64_t bytes_charged = 0;
+  for (const WatermarkBufferFactory* factory : registry.factories_) {
+    bytes_charged += factory->bytesCharged();
+  }
+  return bytes_charged;
+}
+
+void WatermarkBufferFactory::onAccountCreated(BufferMemoryAccountImpl& account) {
+  accounts_.insert(&account);
+  if (stats_ != nullptr) {
+    stats_->accounts_active_.inc();
+  }
+}
+
+void WatermarkBufferFactory::onAccountDestroyed(BufferMemoryAccountImpl& account) {
+  accounts_.erase(&account);
+  if (stats_ != nullptr) {
+    stats_->accounts_active_.dec();
+  }
+}
+
+void WatermarkBufferFactory::onCharge(uint64_t amount) {
+  bytes_charged_.store(bytesCharged() + amount, std::memory_order_relaxed);
+  if (stats_ != nullptr) {
+    stats_->bytes_charged_.add(amount);
+  }
+}
+
+void WatermarkBufferFactory::onCredit(uint64_t amount) {
+  bytes_charged_.store(bytesCharged() - amount, std::memory_order_relaxed);
+  if (stats_ != nullptr) {
+    stats_->bytes_charged_.sub(amount);
+  }
+}
+
 } // namespace Buffer
 } // namespace Envoy
@@ -1,10 +1,17 @@
 #pragma once
 
+#include <atomic>
 #include <functional>
+#include <memory>
 #include <string>
 
+#include "envoy/stats/scope.h"
+#include "envoy/stats/stats_macros.h"
+
 #include "common/buffer/buffer_impl.h"
 
+#include "absl/container/flat_hash_set.h"
+
 namespace Envoy {
 namespace Buffer {
 
@@ -72,8 +79,63 @@ private:
 
 using WatermarkBufferPtr = std::unique_ptr<WatermarkBuffer>;
 
+/**
+ * All buffer memory account stats. @see stats_macros.h
+ */
+#define ALL_BUFFER_MEMORY_STATS(COUNTER, GAUGE)                                                    \
+  COUNTER(accounts_reset)                                                                          \
+  GAUGE(accounts_active, NeverImport)                                                              \
+  GAUGE(bytes_charged, NeverImport)
+
+/**
+ * Struct definition for all buffer memory account stats. @see stats_macros.h
+ */
+struct BufferMemoryStats {
+  ALL_BUFFER_MEMORY_STATS(GENERATE_COUNTER_STRUCT, GENERATE_GAUGE_STRUCT)
+};
+
+class WatermarkBufferFactory;
+
+/**
+ * An account created by a WatermarkBufferFactory, which its charges and credits are added up in.
+ */
+class BufferMemoryAccountImpl : public BufferMemoryAccount,
+                                public std::enable_shared_from_this<BufferMemoryAccountImpl> {
+public:
+  BufferMemoryAccountImpl(WatermarkBufferFactory& factory, std::function<void()> reset_cb);
+  ~BufferMemoryAccountImpl() override;
+
+  // Buffer::BufferMemoryAccount
+  void charge(uint64_t amount) override;
+  void credit(uint64_t amount) override;
+  uint64_t balance() const override { return balance_; }
+  void clearResetCallback() override { reset_cb_ = nullptr; }
+
+  /**
+   * @return bool whether the owner of the account can still be reset.
+   */
+  bool resettable() const { return reset_cb_ != nullptr; }
+
+  /**
+   * Resets the owner of the account, at most once.
+   */
+  void reset();
+
+private:
+  WatermarkBufferFactory& factory_;
+  std::function<void()> reset_cb_;
+  uint64_t balance_{};
+};
+
+/**
+ * The buffer factory of a dispatcher, which adds up the memory charged to the accounts of the
+ * connections and streams of its thread.
+ */
 class WatermarkBufferFactory : public WatermarkFactory {
 public:
+  WatermarkBufferFactory();
+  ~WatermarkBufferFactory() override;
+
   // Buffer::WatermarkFactory
   InstancePtr create(std::function<void()> below_low_watermark,
                      std::function<void()> above_high_watermark,
@@ -81,6 +143,28 @@ public:
     return std::make_unique<WatermarkBuffer>(below_low_watermark, above_high_watermark,
                                              above_overflow_watermark);
   }
+  BufferMemoryAccountSharedPtr createAccount(std::function<void()> reset_cb) override;
+  uint64_t bytesCharged() const override { return bytes_charged_.load(std::memory_order_relaxed); }
+  uint64_t resetAccounts(uint64_t bytes_to_free) override;
+  void initializeStats(Stats::Scope& scope, const std::string& prefix) override;
+
+  /**
+   * @return uint64_t the number of bytes charged to the accounts of the factories of all threads.
+   */
+  static uint64_t totalBytesCharged();
+
+private:
+  friend class BufferMemoryAccountImpl;
+
+  void onAccountCreated(BufferMemoryAccountImpl& account);
+  void onAccountDestroyed(BufferMemoryAccountImpl& account);
+  void onCharge(uint64_t amount);
+  void onCredit(uint64_t amount);
+
+  absl::flat_hash_set<BufferMemoryAccountImpl*> accounts_;
+  // Only written on the thread of the dispatcher, but read by totalBytesCharged() on any thread.
+  std::atomic<uint64_t> bytes_charged_{};
+  std::unique_ptr<BufferMemoryStats> stats_;
 };
 
 } // namespace Buffer
@@ -1,5 +1,7 @@
 #include "common/common/regex.h"
 
+#include <algorithm>
+
 #include "envoy/common/exception.h"
 #include "envoy/runtime/runtime.h"
 #include "envoy/type/matcher/v3/regex.pb.h"
@@ -10,6 +12,7 @@
 #include "common/stats/symbol_table_impl.h"
 
 #include "re2/re2.h"
+#include "re2/set.h"
 
 namespace Envoy {
 namespace Regex {
@@ -119,6 +122,44 @@ private:
   const re2::RE2 regex_;
 };
 
+class CompiledGoogleReMatcherSet : public CompiledMatcherSet {
+public:
+  CompiledGoogleReMatcherSet(
+      const std::vector<const envoy::type::matcher::v3::RegexMatcher*>& matchers)
+      : set_(re2::RE2::Quiet, re2::RE2::ANCHOR_BOTH) {
+    for (const auto* matcher : matchers) {
+      // Google Re is the only currently supported engine.
+      ASSERT(matcher->has_google_re2());
+      std::string error;
+      if (set_.Add(matcher->regex(), &error) < 0) {
+        throw EnvoyException(error);
+      }
+    }
+    if (!set_.Compile()) {
+      throw EnvoyException(
+          fmt::format("{} regexes exceed the RE2 memory budget of a set", matchers.size()));
+    }
+  }
+
+  // CompiledMatcherSet
+  bool match(absl::string_view value, std::vector<uint32_t>& matches) const override {
+    std::vector<int> indices;
+    re2::RE2::Set::ErrorInfo error_info;
+    matches.clear();
+    if (!set_.Match(re2::StringPiece(value.data(), value.size()), &indices, &error_info) &&
+        error_info.kind != re2::RE2::Set::kNoError) {
+      return false;
+    }
+    // RE2 reports matches in no particular order.
+    std::sort(indices.begin(), indices.end());
+    matches.assign(indices.begin(), indices.end());
+    return true;
+  }
+
+private:
+  re2::RE2::Set set_;
+};
+
 } // namespace
 
 CompiledMatcherPtr Utility::parseRegex(const envoy::type::matcher::v3::RegexMatcher& matcher) {
@@ -127,6 +168,11 @@ CompiledMatcherPtr Utility::parseRegex(const envoy::type::matcher::v3::RegexMatc
   return std::make_unique<CompiledGoogleReMatcher>(matcher);
 }
 
+CompiledMatcherSetPtr Utility::parseRegexSet(
+    const std::vector<const envoy::type::matcher::v3::RegexMatcher*>& matchers) {
+  return std::make_unique<CompiledGoogleReMatcherSet>(matchers);
+}
+
 CompiledMatcherPtr Utility::parseStdRegexAsCompiledMatcher(const std::string& regex,
                                                            std::regex::flag_type flags) {
   return std::make_unique<CompiledStdMatcher>(parseStdRegex(regex, flags));
@@ -2,6 +2,7 @@
 
 #include <memory>
 #include <regex>
+#include <vector>
 
 #include "envoy/common/regex.h"
 #include "envoy/type/matcher/v3/regex.pb.h"
@@ -38,6 +39,15 @@ public:
    * Construct a compiled regex matcher from a match config.
    */
   static CompiledMatcherPtr parseRegex(const envoy::type::matcher::v3::RegexMatcher& matcher);
+
+  /**
+   * Construct a compiled matcher set from match configs. Pattern i of the set is matchers[i]. The
+   * program size limits applied by parseRegex() are not checked again, so callers are expected to
+   * have built each matcher with parseRegex() already.
+   * @throw EnvoyException if a pattern is invalid or the patterns can't be compiled together.
+   */
+  static CompiledMatcherSetPtr
+  parseRegexSet(const std::vector<const envoy::type::matcher::v3::RegexMatcher*>& matchers);
 };
 
 } // namespace Regex
@@ -29,6 +29,11 @@ Api::IoCallSizeResult FileSharedImpl::write(absl::string_view buffer) {
   return rc != -1 ? resultSuccess<ssize_t>(rc) : resultFailure<ssize_t>(rc, errno);
 };
 
+Api::IoCallSizeResult FileSharedImpl::writev(absl::Span<const absl::string_view> buffers) {
+  const ssize_t rc = writevFile(buffers);
+  return rc != -1 ? resultSuccess<ssize_t>(rc) : resultFailure<ssize_t>(rc, errno);
+}
+
 Api::IoCallBoolResult FileSharedImpl::close() {
   ASSERT(isOpen());
 
@@ -44,6 +44,7 @@ public:
   // Filesystem::File
   Api::IoCallBoolResult open(FlagSet flag) override;
   Api::IoCallSizeResult write(absl::string_view buffer) override;
+  Api::IoCallSizeResult writev(absl::Span<const absl::string_view> buffers) override;
   Api::IoCallBoolResult close() override;
   bool isOpen() const override;
   std::string path() const override;
@@ -51,6 +52,7 @@ public:
 protected:
   virtual void openFile(FlagSet in) PURE;
   virtual ssize_t writeFile(absl::string_view buffer) PURE;
+  virtual ssize_t writevFile(absl::Span<const absl::string_view> buffers) PURE;
   virtual bool closeFile() PURE;
 
   int fd_;
@@ -1,8 +1,11 @@
 #include <dirent.h>
 #include <fcntl.h>
 #include <sys/stat.h>
+#include <sys/uio.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <climits>
 #include <cstdlib>
 #include <fstream>
 #include <iostream>
@@ -17,6 +20,7 @@
 #include "common/common/utility.h"
 #include "common/filesystem/filesystem_impl.h"
 
+#include "absl/container/fixed_array.h"
 #include "absl/strings/match.h"
 #include "absl/strings/str_cat.h"
 
@@ -39,6 +43,30 @@ ssize_t FileImplPosix::writeFile(absl::string_view buffer) {
   return ::write(fd_, buffer.data(), buffer.size());
 }
 
+ssize_t FileImplPosix::writevFile(absl::Span<const absl::string_view> buffers) {
+  ssize_t written = 0;
+  while (!buffers.empty()) {
+    const size_t num_iov = std::min<size_t>(buffers.size(), IOV_MAX);
+    absl::FixedArray<iovec> iov(num_iov);
+    size_t expected = 0;
+    for (size_t i = 0; i < num_iov; i++) {
+      iov[i].iov_base = const_cast<char*>(buffers[i].data());
+      iov[i].iov_len = buffers[i].size();
+      expected += buffers[i].size();
+    }
+    const ssize_t rc = ::writev(fd_, iov.begin(), num_iov);
+    if (rc == -1) {
+      return written > 0 ? written : -1;
+    }
+    written += rc;
+    if (static_cast<size_t>(rc) != expected) {
+      break;
+    }
+    buffers.remove_prefix(num_iov);
+  }
+  return written;
+}
+
 FileImplPosix::FlagsAndMode FileImplPosix::translateFlag(FlagSet in) {
   int out = 0;
   mode_t mode = 0;
@@ -35,6 +35,22 @@ ssize_t FileImplWin32::writeFile(absl::string_view buffer) {
   return ::_write(fd_, buffer.data(), buffer.size());
 }
 
+ssize_t FileImplWin32::writevFile(absl::Span<const absl::string_view> buffers) {
+  // There is no vectored write for CRT file descriptors, so write the buffers one at a time.
+  ssize_t written = 0;
+  for (const absl::string_view buffer : buffers) {
+    const ssize_t rc = writeFile(buffer);
+    if (rc == -1) {
+      return written > 0 ? written : -1;
+    }
+    written += rc;
+    if (static_cast<size_t>(rc) != buffer.size()) {
+      break;
+    }
+  }
+  return written;
+}
+
 FileImplWin32::FlagsAndMode FileImplWin32::translateFlag(FlagSet in) {
   int out = 0;
   int pmode = 0;
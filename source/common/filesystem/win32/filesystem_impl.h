@@ -23,6 +23,7 @@ protected:
   FlagsAndMode translateFlag(FlagSet in);
   void openFile(FlagSet in) override;
   ssize_t writeFile(absl::string_view buffer) override;
+  ssize_t writevFile(absl::Span<const absl::string_view> buffers) override;
   bool closeFile() override;
 
 private:
@@ -89,10 +89,39 @@ const std::string SubstitutionFormatUtils::getHostname() {
   return hostname;
 }
 
-FormatterImpl::FormatterImpl(const std::string& format) {
-  providers_ = SubstitutionFormatParser::parse(format);
+FormatProgram::FormatProgram(std::vector<FormatterProviderPtr>&& providers)
+    : providers_(std::move(providers)) {
+  for (const FormatterProviderPtr& provider : providers_) {
+    const auto* plain = dynamic_cast<const PlainStringFormatter*>(provider.get());
+    if (plain == nullptr) {
+      instructions_.push_back({provider.get(), ""});
+    } else if (!instructions_.empty() && instructions_.back().provider_ == nullptr) {
+      instructions_.back().literal_ += plain->literal();
+    } else {
+      instructions_.push_back({nullptr, ""});
+      instructions_.back().literal_ += plain->literal();
+    }
+  }
+}
+
+void FormatProgram::formatTo(const Http::RequestHeaderMap& request_headers,
+                             const Http::ResponseHeaderMap& response_headers,
+                             const Http::ResponseTrailerMap& response_trailers,
+                             const StreamInfo::StreamInfo& stream_info,
+                             absl::string_view local_reply_body, std::string& output) const {
+  for (const Instruction& instruction : instructions_) {
+    if (instruction.provider_ == nullptr) {
+      output += instruction.literal_;
+    } else {
+      instruction.provider_->formatTo(request_headers, response_headers, response_trailers,
+                                      stream_info, local_reply_body, output);
+    }
+  }
 }
 
+FormatterImpl::FormatterImpl(const std::string& format)
+    : program_(SubstitutionFormatParser::parse(format)) {}
+
 std::string FormatterImpl::format(const Http::RequestHeaderMap& request_headers,
                                   const Http::ResponseHeaderMap& response_headers,
                                   const Http::ResponseTrailerMap& response_trailers,
@@ -100,12 +129,8 @@ std::string FormatterImpl::format(const Http::RequestHeaderMap& request_headers,
                                   absl::string_view local_reply_body) const {
   std::string log_line;
   log_line.reserve(256);
-
-  for (const FormatterProviderPtr& provider : providers_) {
-    log_line += provider->format(request_headers, response_headers, response_trailers, stream_info,
-                                 local_reply_body);
-  }
-
+  program_.formatTo(request_headers, response_headers, response_trailers, stream_info,
+                    local_reply_body, log_line);
   return log_line;
 }
 
@@ -125,8 +150,9 @@ std::string JsonFormatterImpl::format(const Http::RequestHeaderMap& request_head
   const auto output_struct =
       toStruct(request_headers, response_headers, response_trailers, stream_info, local_reply_body);
 
-  const std::string log_line = MessageUtil::getJsonStringFromMessage(output_struct, false, true);
-  return absl::StrCat(log_line, "\n");
+  std::string log_line = MessageUtil::getJsonStringFromMessage(output_struct, false, true);
+  log_line += '\n';
+  return log_line;
 }
 
 ProtobufWkt::Struct JsonFormatterImpl::toStruct(const Http::RequestHeaderMap& request_headers,
@@ -137,26 +163,17 @@ ProtobufWkt::Struct JsonFormatterImpl::toStruct(const Http::RequestHeaderMap& re
   ProtobufWkt::Struct output;
   auto* fields = output.mutable_fields();
   for (const auto& pair : json_output_format_) {
-    const auto& providers = pair.second;
-    ASSERT(!providers.empty());
-
-    if (providers.size() == 1) {
-      const auto& provider = providers.front();
-      const auto val =
-          preserve_types_ ? provider->formatValue(request_headers, response_headers,
-                                                  response_trailers, stream_info, local_reply_body)
-                          : ValueUtil::stringValue(
-                                provider->format(request_headers, response_headers,
-                                                 response_trailers, stream_info, local_reply_body));
-      (*fields)[pair.first] = val;
+    const FormatProgram& program = pair.second;
+    const FormatterProvider* provider = program.singleProvider();
+
+    if (preserve_types_ && provider != nullptr) {
+      (*fields)[pair.first] = provider->formatValue(request_headers, response_headers,
+                                                    response_trailers, stream_info,
+                                                    local_reply_body);
     } else {
-      // Multiple providers forces string output.
-      std::string str;
-      for (const auto& provider : providers) {
-        str += provider->format(request_headers, response_headers, response_trailers, stream_info,
-                                local_reply_body);
-      }
-      (*fields)[pair.first] = ValueUtil::stringValue(str);
+      // Multiple providers forces string output, which is built in place in the field.
+      program.formatTo(request_headers, response_headers, response_trailers, stream_info,
+                       local_reply_body, *(*fields)[pair.first].mutable_string_value());
     }
   }
   return output;
@@ -360,6 +377,9 @@ public:
   std::string extract(const StreamInfo::StreamInfo& stream_info) const override {
     return field_extractor_(stream_info);
   }
+  void extractTo(const StreamInfo::StreamInfo& stream_info, std::string& output) const override {
+    output += field_extractor_(stream_info);
+  }
   ProtobufWkt::Value extractValue(const StreamInfo::StreamInfo& stream_info) const override {
     return ValueUtil::stringValue(field_extractor_(stream_info));
   }
@@ -384,6 +404,10 @@ public:
 
     return str.value();
   }
+  void extractTo(const StreamInfo::StreamInfo& stream_info, std::string& output) const override {
+    const auto str = field_extractor_(stream_info);
+    output += str ? str.value() : UnspecifiedValueString;
+  }
   ProtobufWkt::Value extractValue(const StreamInfo::StreamInfo& stream_info) const override {
     const auto str = field_extractor_(stream_info);
     if (!str) {
@@ -414,6 +438,16 @@ public:
 
     return fmt::format_int(millis.value()).str();
   }
+  void extractTo(const StreamInfo::StreamInfo& stream_info, std::string& output) const override {
+    const auto millis = extractMillis(stream_info);
+    if (!millis) {
+      output += UnspecifiedValueString;
+      return;
+    }
+
+    const fmt::format_int formatted(millis.value());
+    output.append(formatted.data(), formatted.size());
+  }
   ProtobufWkt::Value extractValue(const StreamInfo::StreamInfo& stream_info) const override {
     const auto millis = extractMillis(stream_info);
     if (!millis) {
@@ -446,6 +480,10 @@ public:
   std::string extract(const StreamInfo::StreamInfo& stream_info) const override {
     return fmt::format_int(field_extractor_(stream_info)).str();
   }
+  void extractTo(const StreamInfo::StreamInfo& stream_info, std::string& output) const override {
+    const fmt::format_int formatted(field_extractor_(stream_info));
+    output.append(formatted.data(), formatted.size());
+  }
   ProtobufWkt::Value extractValue(const StreamInfo::StreamInfo& stream_info) const override {
     return ValueUtil::numberValue(field_extractor_(stream_info));
   }
@@ -488,6 +526,20 @@ public:
 
     return toString(*address);
   }
+  void extractTo(const StreamInfo::StreamInfo& stream_info, std::string& output) const override {
+    Network::Address::InstanceConstSharedPtr address = field_extractor_(stream_info);
+    if (!address) {
+      output += UnspecifiedValueString;
+      return;
+    }
+
+    if (extraction_type_ == StreamInfoFormatter::StreamInfoAddressFieldExtractionType::WithPort) {
+      // The address already holds its string form.
+      output += address->asStringView();
+    } else {
+      output += toString(*address);
+    }
+  }
   ProtobufWkt::Value extractValue(const StreamInfo::StreamInfo& stream_info) const override {
     Network::Address::InstanceConstSharedPtr address = field_extractor_(stream_info);
     if (!address) {
@@ -534,6 +586,10 @@ public:
     return value;
   }
 
+  void extractTo(const StreamInfo::StreamInfo& stream_info, std::string& output) const override {
+    output += extract(stream_info);
+  }
+
   ProtobufWkt::Value extractValue(const StreamInfo::StreamInfo& stream_info) const override {
     if (stream_info.downstreamSslConnection() == nullptr) {
       return unspecifiedValue();
@@ -780,6 +836,13 @@ std::string StreamInfoFormatter::format(const Http::RequestHeaderMap&,
   return field_extractor_->extract(stream_info);
 }
 
+void StreamInfoFormatter::formatTo(const Http::RequestHeaderMap&, const Http::ResponseHeaderMap&,
+                                   const Http::ResponseTrailerMap&,
+                                   const StreamInfo::StreamInfo& stream_info, absl::string_view,
+                                   std::string& output) const {
+  field_extractor_->extractTo(stream_info, output);
+}
+
 ProtobufWkt::Value StreamInfoFormatter::formatValue(const Http::RequestHeaderMap&,
                                                     const Http::ResponseHeaderMap&,
                                                     const Http::ResponseTrailerMap&,
@@ -797,6 +860,12 @@ std::string PlainStringFormatter::format(const Http::RequestHeaderMap&,
   return str_.string_value();
 }
 
+void PlainStringFormatter::formatTo(const Http::RequestHeaderMap&, const Http::ResponseHeaderMap&,
+                                    const Http::ResponseTrailerMap&, const StreamInfo::StreamInfo&,
+                                    absl::string_view, std::string& output) const {
+  output += str_.string_value();
+}
+
 ProtobufWkt::Value PlainStringFormatter::formatValue(const Http::RequestHeaderMap&,
                                                      const Http::ResponseHeaderMap&,
                                                      const Http::ResponseTrailerMap&,
@@ -813,6 +882,15 @@ std::string LocalReplyBodyFormatter::format(const Http::RequestHeaderMap&,
   return std::string(local_reply_body);
 }
 
+void LocalReplyBodyFormatter::formatTo(const Http::RequestHeaderMap&,
+                                       const Http::ResponseHeaderMap&,
+                                       const Http::ResponseTrailerMap&,
+                                       const StreamInfo::StreamInfo&,
+                                       absl::string_view local_reply_body,
+                                       std::string& output) const {
+  output.append(local_reply_body.data(), local_reply_body.size());
+}
+
 ProtobufWkt::Value LocalReplyBodyFormatter::formatValue(const Http::RequestHeaderMap&,
                                                         const Http::ResponseHeaderMap&,
                                                         const Http::ResponseTrailerMap&,
@@ -847,6 +925,20 @@ std::string HeaderFormatter::format(const Http::HeaderMap& headers) const {
   return val;
 }
 
+void HeaderFormatter::formatTo(const Http::HeaderMap& headers, std::string& output) const {
+  const Http::HeaderEntry* header = findHeader(headers);
+  if (!header) {
+    output += UnspecifiedValueString;
+    return;
+  }
+
+  absl::string_view val = header->value().getStringView();
+  if (max_length_) {
+    val = val.substr(0, max_length_.value());
+  }
+  output.append(val.data(), val.size());
+}
+
 ProtobufWkt::Value HeaderFormatter::formatValue(const Http::HeaderMap& headers) const {
   const Http::HeaderEntry* header = findHeader(headers);
   if (!header) {
@@ -871,6 +963,14 @@ std::string ResponseHeaderFormatter::format(const Http::RequestHeaderMap&,
   return HeaderFormatter::format(response_headers);
 }
 
+void ResponseHeaderFormatter::formatTo(const Http::RequestHeaderMap&,
+                                       const Http::ResponseHeaderMap& response_headers,
+                                       const Http::ResponseTrailerMap&,
+                                       const StreamInfo::StreamInfo&, absl::string_view,
+                                       std::string& output) const {
+  HeaderFormatter::formatTo(response_headers, output);
+}
+
 ProtobufWkt::Value ResponseHeaderFormatter::formatValue(
     const Http::RequestHeaderMap&, const Http::ResponseHeaderMap& response_headers,
     const Http::ResponseTrailerMap&, const StreamInfo::StreamInfo&, absl::string_view) const {
@@ -889,6 +989,14 @@ std::string RequestHeaderFormatter::format(const Http::RequestHeaderMap& request
   return HeaderFormatter::format(request_headers);
 }
 
+void RequestHeaderFormatter::formatTo(const Http::RequestHeaderMap& request_headers,
+                                      const Http::ResponseHeaderMap&,
+                                      const Http::ResponseTrailerMap&,
+                                      const StreamInfo::StreamInfo&, absl::string_view,
+                                      std::string& output) const {
+  HeaderFormatter::formatTo(request_headers, output);
+}
+
 ProtobufWkt::Value
 RequestHeaderFormatter::formatValue(const Http::RequestHeaderMap& request_headers,
                                     const Http::ResponseHeaderMap&, const Http::ResponseTrailerMap&,
@@ -909,6 +1017,14 @@ std::string ResponseTrailerFormatter::format(const Http::RequestHeaderMap&,
   return HeaderFormatter::format(response_trailers);
 }
 
+void ResponseTrailerFormatter::formatTo(const Http::RequestHeaderMap&,
+                                        const Http::ResponseHeaderMap&,
+                                        const Http::ResponseTrailerMap& response_trailers,
+                                        const StreamInfo::StreamInfo&, absl::string_view,
+                                        std::string& output) const {
+  HeaderFormatter::formatTo(response_trailers, output);
+}
+
 ProtobufWkt::Value
 ResponseTrailerFormatter::formatValue(const Http::RequestHeaderMap&, const Http::ResponseHeaderMap&,
                                       const Http::ResponseTrailerMap& response_trailers,
@@ -938,6 +1054,15 @@ std::string GrpcStatusFormatter::format(const Http::RequestHeaderMap&,
   return grpc_status_message;
 }
 
+void GrpcStatusFormatter::formatTo(const Http::RequestHeaderMap& request_headers,
+                                   const Http::ResponseHeaderMap& response_headers,
+                                   const Http::ResponseTrailerMap& response_trailers,
+                                   const StreamInfo::StreamInfo& stream_info,
+                                   absl::string_view local_reply_body, std::string& output) const {
+  output += format(request_headers, response_headers, response_trailers, stream_info,
+                   local_reply_body);
+}
+
 ProtobufWkt::Value
 GrpcStatusFormatter::formatValue(const Http::RequestHeaderMap&,
                                  const Http::ResponseHeaderMap& response_headers,
@@ -1007,6 +1132,14 @@ std::string DynamicMetadataFormatter::format(const Http::RequestHeaderMap&,
   return MetadataFormatter::formatMetadata(stream_info.dynamicMetadata());
 }
 
+void DynamicMetadataFormatter::formatTo(const Http::RequestHeaderMap&,
+                                        const Http::ResponseHeaderMap&,
+                                        const Http::ResponseTrailerMap&,
+                                        const StreamInfo::StreamInfo& stream_info,
+                                        absl::string_view, std::string& output) const {
+  output += MetadataFormatter::formatMetadata(stream_info.dynamicMetadata());
+}
+
 ProtobufWkt::Value DynamicMetadataFormatter::formatValue(const Http::RequestHeaderMap&,
                                                          const Http::ResponseHeaderMap&,
                                                          const Http::ResponseTrailerMap&,
@@ -1065,6 +1198,15 @@ std::string FilterStateFormatter::format(const Http::RequestHeaderMap&,
   return value;
 }
 
+void FilterStateFormatter::formatTo(const Http::RequestHeaderMap& request_headers,
+                                    const Http::ResponseHeaderMap& response_headers,
+                                    const Http::ResponseTrailerMap& response_trailers,
+                                    const StreamInfo::StreamInfo& stream_info,
+                                    absl::string_view local_reply_body, std::string& output) const {
+  output += format(request_headers, response_headers, response_trailers, stream_info,
+                   local_reply_body);
+}
+
 ProtobufWkt::Value FilterStateFormatter::formatValue(const Http::RequestHeaderMap&,
                                                      const Http::ResponseHeaderMap&,
                                                      const Http::ResponseTrailerMap&,
@@ -1112,6 +1254,15 @@ std::string StartTimeFormatter::format(const Http::RequestHeaderMap&,
   }
 }
 
+void StartTimeFormatter::formatTo(const Http::RequestHeaderMap& request_headers,
+                                  const Http::ResponseHeaderMap& response_headers,
+                                  const Http::ResponseTrailerMap& response_trailers,
+                                  const StreamInfo::StreamInfo& stream_info,
+                                  absl::string_view local_reply_body, std::string& output) const {
+  output += format(request_headers, response_headers, response_trailers, stream_info,
+                   local_reply_body);
+}
+
 ProtobufWkt::Value StartTimeFormatter::formatValue(
     const Http::RequestHeaderMap& request_headers, const Http::ResponseHeaderMap& response_headers,
     const Http::ResponseTrailerMap& response_trailers, const StreamInfo::StreamInfo& stream_info,
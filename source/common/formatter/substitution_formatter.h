@@ -82,6 +82,41 @@ private:
   static const std::string DEFAULT_FORMAT;
 };
 
+/**
+ * A parsed format string, compiled into a flat list of instructions that each append either
+ * literal text or the output of one provider to a caller supplied string. Literal text is appended
+ * directly rather than through its provider, and adjacent literals are merged, so formatting a line
+ * costs one virtual call per command and no intermediate strings for providers with a fast path.
+ */
+class FormatProgram {
+public:
+  explicit FormatProgram(std::vector<FormatterProviderPtr>&& providers);
+
+  void formatTo(const Http::RequestHeaderMap& request_headers,
+                const Http::ResponseHeaderMap& response_headers,
+                const Http::ResponseTrailerMap& response_trailers,
+                const StreamInfo::StreamInfo& stream_info, absl::string_view local_reply_body,
+                std::string& output) const;
+
+  /**
+   * @return the only provider of the format, or nullptr if it has more or less than one. A lone
+   *         provider's value may be kept typed rather than formatted as a string.
+   */
+  const FormatterProvider* singleProvider() const {
+    return providers_.size() == 1 ? providers_.front().get() : nullptr;
+  }
+
+private:
+  struct Instruction {
+    // Provider to format, or nullptr to append literal_.
+    const FormatterProvider* provider_;
+    std::string literal_;
+  };
+
+  std::vector<FormatterProviderPtr> providers_;
+  std::vector<Instruction> instructions_;
+};
+
 /**
  * Composite formatter implementation.
  */
@@ -97,7 +132,7 @@ public:
                      absl::string_view local_reply_body) const override;
 
 private:
-  std::vector<FormatterProviderPtr> providers_;
+  const FormatProgram program_;
 };
 
 class JsonFormatterImpl : public Formatter {
@@ -114,7 +149,7 @@ public:
 
 private:
   const bool preserve_types_;
-  std::map<const std::string, const std::vector<FormatterProviderPtr>> json_output_format_;
+  std::map<const std::string, const FormatProgram> json_output_format_;
 
   ProtobufWkt::Struct toStruct(const Http::RequestHeaderMap& request_headers,
                                const Http::ResponseHeaderMap& response_headers,
@@ -135,10 +170,15 @@ public:
   std::string format(const Http::RequestHeaderMap&, const Http::ResponseHeaderMap&,
                      const Http::ResponseTrailerMap&, const StreamInfo::StreamInfo&,
                      absl::string_view) const override;
+  void formatTo(const Http::RequestHeaderMap&, const Http::ResponseHeaderMap&,
+                const Http::ResponseTrailerMap&, const StreamInfo::StreamInfo&, absl::string_view,
+                std::string& output) const override;
   ProtobufWkt::Value formatValue(const Http::RequestHeaderMap&, const Http::ResponseHeaderMap&,
                                  const Http::ResponseTrailerMap&, const StreamInfo::StreamInfo&,
                                  absl::string_view) const override;
 
+  const std::string& literal() const { return str_.string_value(); }
+
 private:
   ProtobufWkt::Value str_;
 };
@@ -154,6 +194,9 @@ public:
   std::string format(const Http::RequestHeaderMap&, const Http::ResponseHeaderMap&,
                      const Http::ResponseTrailerMap&, const StreamInfo::StreamInfo&,
                      absl::string_view local_reply_body) const override;
+  void formatTo(const Http::RequestHeaderMap&, const Http::ResponseHeaderMap&,
+                const Http::ResponseTrailerMap&, const StreamInfo::StreamInfo&, absl::string_view,
+                std::string& output) const override;
   ProtobufWkt::Value formatValue(const Http::RequestHeaderMap&, const Http::ResponseHeaderMap&,
                                  const Http::ResponseTrailerMap&, const StreamInfo::StreamInfo&,
                                  absl::string_view local_reply_body) const override;
@@ -166,6 +209,7 @@ public:
 
 protected:
   std::string format(const Http::HeaderMap& headers) const;
+  void formatTo(const Http::HeaderMap& headers, std::string& output) const;
   ProtobufWkt::Value formatValue(const Http::HeaderMap& headers) const;
 
 private:
@@ -188,6 +232,9 @@ public:
   std::string format(const Http::RequestHeaderMap& request_headers, const Http::ResponseHeaderMap&,
                      const Http::ResponseTrailerMap&, const StreamInfo::StreamInfo&,
                      absl::string_view) const override;
+  void formatTo(const Http::RequestHeaderMap&, const Http::ResponseHeaderMap&,
+                const Http::ResponseTrailerMap&, const StreamInfo::StreamInfo&, absl::string_view,
+                std::string& output) const override;
   ProtobufWkt::Value formatValue(const Http::RequestHeaderMap&, const Http::ResponseHeaderMap&,
                                  const Http::ResponseTrailerMap&, const StreamInfo::StreamInfo&,
                                  absl::string_view) const override;
@@ -205,6 +252,9 @@ public:
   std::string format(const Http::RequestHeaderMap&, const Http::ResponseHeaderMap& response_headers,
                      const Http::ResponseTrailerMap&, const StreamInfo::StreamInfo&,
                      absl::string_view) const override;
+  void formatTo(const Http::RequestHeaderMap&, const Http::ResponseHeaderMap&,
+                const Http::ResponseTrailerMap&, const StreamInfo::StreamInfo&, absl::string_view,
+                std::string& output) const override;
   ProtobufWkt::Value formatValue(const Http::RequestHeaderMap&, const Http::ResponseHeaderMap&,
                                  const Http::ResponseTrailerMap&, const StreamInfo::StreamInfo&,
                                  absl::string_view) const override;
@@ -222,6 +272,9 @@ public:
   std::string format(const Http::RequestHeaderMap&, const Http::ResponseHeaderMap&,
                      const Http::ResponseTrailerMap& response_trailers,
                      const StreamInfo::StreamInfo&, absl::string_view) const override;
+  void formatTo(const Http::RequestHeaderMap&, const Http::ResponseHeaderMap&,
+                const Http::ResponseTrailerMap&, const StreamInfo::StreamInfo&, absl::string_view,
+                std::string& output) const override;
   ProtobufWkt::Value formatValue(const Http::RequestHeaderMap&, const Http::ResponseHeaderMap&,
                                  const Http::ResponseTrailerMap&, const StreamInfo::StreamInfo&,
                                  absl::string_view) const override;
@@ -239,6 +292,9 @@ public:
   std::string format(const Http::RequestHeaderMap&, const Http::ResponseHeaderMap& response_headers,
                      const Http::ResponseTrailerMap& response_trailers,
                      const StreamInfo::StreamInfo&, absl::string_view) const override;
+  void formatTo(const Http::RequestHeaderMap&, const Http::ResponseHeaderMap&,
+                const Http::ResponseTrailerMap&, const StreamInfo::StreamInfo&, absl::string_view,
+                std::string& output) const override;
   ProtobufWkt::Value formatValue(const Http::RequestHeaderMap&, const Http::ResponseHeaderMap&,
                                  const Http::ResponseTrailerMap&, const StreamInfo::StreamInfo&,
                                  absl::string_view) const override;
@@ -255,6 +311,9 @@ public:
   std::string format(const Http::RequestHeaderMap&, const Http::ResponseHeaderMap&,
                      const Http::ResponseTrailerMap&, const StreamInfo::StreamInfo&,
                      absl::string_view) const override;
+  void formatTo(const Http::RequestHeaderMap&, const Http::ResponseHeaderMap&,
+                const Http::ResponseTrailerMap&, const StreamInfo::StreamInfo&, absl::string_view,
+                std::string& output) const override;
   ProtobufWkt::Value formatValue(const Http::RequestHeaderMap&, const Http::ResponseHeaderMap&,
                                  const Http::ResponseTrailerMap&, const StreamInfo::StreamInfo&,
                                  absl::string_view) const override;
@@ -264,6 +323,7 @@ public:
     virtual ~FieldExtractor() = default;
 
     virtual std::string extract(const StreamInfo::StreamInfo&) const PURE;
+    virtual void extractTo(const StreamInfo::StreamInfo&, std::string& output) const PURE;
     virtual ProtobufWkt::Value extractValue(const StreamInfo::StreamInfo&) const PURE;
   };
   using FieldExtractorPtr = std::unique_ptr<FieldExtractor>;
@@ -304,6 +364,9 @@ public:
   std::string format(const Http::RequestHeaderMap&, const Http::ResponseHeaderMap&,
                      const Http::ResponseTrailerMap&, const StreamInfo::StreamInfo&,
                      absl::string_view) const override;
+  void formatTo(const Http::RequestHeaderMap&, const Http::ResponseHeaderMap&,
+                const Http::ResponseTrailerMap&, const StreamInfo::StreamInfo&, absl::string_view,
+                std::string& output) const override;
   ProtobufWkt::Value formatValue(const Http::RequestHeaderMap&, const Http::ResponseHeaderMap&,
                                  const Http::ResponseTrailerMap&, const StreamInfo::StreamInfo&,
                                  absl::string_view) const override;
@@ -321,6 +384,9 @@ public:
   std::string format(const Http::RequestHeaderMap&, const Http::ResponseHeaderMap&,
                      const Http::ResponseTrailerMap&, const StreamInfo::StreamInfo&,
                      absl::string_view) const override;
+  void formatTo(const Http::RequestHeaderMap&, const Http::ResponseHeaderMap&,
+                const Http::ResponseTrailerMap&, const StreamInfo::StreamInfo&, absl::string_view,
+                std::string& output) const override;
   ProtobufWkt::Value formatValue(const Http::RequestHeaderMap&, const Http::ResponseHeaderMap&,
                                  const Http::ResponseTrailerMap&, const StreamInfo::StreamInfo&,
                                  absl::string_view) const override;
@@ -346,6 +412,9 @@ public:
   std::string format(const Http::RequestHeaderMap&, const Http::ResponseHeaderMap&,
                      const Http::ResponseTrailerMap&, const StreamInfo::StreamInfo&,
                      absl::string_view) const override;
+  void formatTo(const Http::RequestHeaderMap&, const Http::ResponseHeaderMap&,
+                const Http::ResponseTrailerMap&, const StreamInfo::StreamInfo&, absl::string_view,
+                std::string& output) const override;
   ProtobufWkt::Value formatValue(const Http::RequestHeaderMap&, const Http::ResponseHeaderMap&,
                                  const Http::ResponseTrailerMap&, const StreamInfo::StreamInfo&,
                                  absl::string_view) const override;
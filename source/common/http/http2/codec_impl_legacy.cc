@@ -111,12 +111,21 @@ ConnectionImpl::StreamImpl::StreamImpl(ConnectionImpl& parent, uint32_t buffer_l
   if (buffer_limit > 0) {
     setWriteBufferWatermarks(buffer_limit / 2, buffer_limit);
   }
+  // Charge the pending data to the stream, which is reset if it buffers the most when memory is
+  // tight.
+  account_ = parent_.connection_.dispatcher().getWatermarkFactory().createAccount(
+      [this]() { resetStream(StreamResetReason::Overflow); });
+  pending_recv_data_.bindAccount(account_);
+  pending_send_data_.bindAccount(account_);
 }
 
 ConnectionImpl::StreamImpl::~StreamImpl() { ASSERT(stream_idle_timer_ == nullptr); }
 
 void ConnectionImpl::StreamImpl::destroy() {
   disarmStreamIdleTimer();
+  if (account_ != nullptr) {
+    account_->clearResetCallback();
+  }
   parent_.stats_.streams_active_.dec();
   parent_.stats_.pending_send_bytes_.sub(pending_send_data_.length());
 }
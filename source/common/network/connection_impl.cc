@@ -61,6 +61,13 @@ ConnectionImpl::ConnectionImpl(Event::Dispatcher& dispatcher, ConnectionSocketPt
   // condition and just crash.
   RELEASE_ASSERT(SOCKET_VALID(ConnectionImpl::ioHandle().fd()), "");
 
+  // Charge the buffered data to the connection, which is closed if it buffers the most when
+  // memory is tight.
+  account_ = dispatcher.getWatermarkFactory().createAccount(
+      [this]() { close(ConnectionCloseType::NoFlush); });
+  read_buffer_.bindAccount(account_);
+  write_buffer_->bindAccount(account_);
+
   if (!connected) {
     connecting_ = true;
   }
@@ -69,9 +76,9 @@ ConnectionImpl::ConnectionImpl(Event::Dispatcher& dispatcher, ConnectionSocketPt
 
   // We never ask for both early close and read at the same time. If we are reading, we want to
   // consume all available data.
-  file_event_ = dispatcher_.createFileEvent(
-      ConnectionImpl::ioHandle().fd(), [this](uint32_t events) -> void { onFileEvent(events); },
-      trigger, Event::FileReadyType::Read | Event::FileReadyType::Write);
+  file_event_ = ConnectionImpl::ioHandle().createFileEvent(
+      dispatcher_, [this](uint32_t events) -> void { onFileEvent(events); }, trigger,
+      Event::FileReadyType::Read | Event::FileReadyType::Write);
 
   transport_socket_->setTransportSocketCallbacks(*this);
 }
@@ -218,6 +225,10 @@ void ConnectionImpl::closeSocket(ConnectionEvent close_type) {
 
   file_event_.reset();
 
+  if (account_ != nullptr) {
+    account_->clearResetCallback();
+  }
+
   socket_->close();
 
   // Call the base class directly as close() is called in the destructor.
@@ -697,6 +708,39 @@ absl::string_view ConnectionImpl::transportFailureReason() const {
   return transport_socket_->failureReason();
 }
 
+IoHandle* ConnectionImpl::spliceableIoHandle() {
+  if (state() != State::Open || connecting_ || !transport_socket_->canSplice() ||
+      !ioHandle().supportsSplice() || read_buffer_.length() > 0 || write_buffer_->length() > 0 ||
+      read_end_stream_ || write_end_stream_) {
+    return nullptr;
+  }
+  return &ioHandle();
+}
+
+void ConnectionImpl::recordSplicedBytes(uint64_t bytes_read, uint64_t bytes_written) {
+  // As the filter manager does for data which goes through the connection.
+  stream_info_.addBytesReceived(bytes_read);
+  stream_info_.addBytesSent(bytes_written);
+  if (!connection_stats_) {
+    return;
+  }
+  if (bytes_read > 0) {
+    connection_stats_->read_total_.add(bytes_read);
+  }
+  if (bytes_written > 0) {
+    connection_stats_->write_total_.add(bytes_written);
+  }
+}
+
+void ConnectionImpl::onSocketRead(uint64_t bytes_read) {
+  if (read_stats_ != nullptr) {
+    read_stats_->reads_total_.inc();
+    if (bytes_read > 0) {
+      read_stats_->read_size_.recordValue(bytes_read);
+    }
+  }
+}
+
 void ConnectionImpl::flushWriteBuffer() {
   if (state() == State::Open && write_buffer_->length() > 0) {
     onWriteReady();
@@ -90,6 +90,8 @@ public:
   StreamInfo::StreamInfo& streamInfo() override { return stream_info_; }
   const StreamInfo::StreamInfo& streamInfo() const override { return stream_info_; }
   absl::string_view transportFailureReason() const override;
+  IoHandle* spliceableIoHandle() override;
+  void recordSplicedBytes(uint64_t bytes_read, uint64_t bytes_written) override;
 
   // Network::FilterManagerConnection
   void rawWrite(Buffer::Instance& data, bool end_stream) override;
@@ -116,6 +118,7 @@ public:
   // fair sharing of CPU resources, the underlying event loop does not make any fairness guarantees.
   // Reconsider how to make fairness happen.
   void setReadBufferReady() override { file_event_->activate(Event::FileReadyType::Read); }
+  void onSocketRead(uint64_t bytes_read) override;
   void flushWriteBuffer() override;
 
   // Obtain global next connection ID. This should only be used in tests.
@@ -146,6 +149,8 @@ protected:
   StreamInfo::StreamInfo& stream_info_;
   FilterManagerImpl filter_manager_;
 
+  // The account which the read and write buffers are charged to.
+  Buffer::BufferMemoryAccountSharedPtr account_;
   // Ensure that if the consumer of the data from this connection isn't
   // consuming, that the connection eventually stops reading from the wire.
   Buffer::WatermarkBuffer read_buffer_;
@@ -17,6 +17,11 @@ void ConnectionImplBase::setConnectionStats(const ConnectionStats& stats) {
   connection_stats_ = std::make_unique<ConnectionStats>(stats);
 }
 
+void ConnectionImplBase::setReadStats(const ReadStats& stats) {
+  ASSERT(!read_stats_);
+  read_stats_ = std::make_unique<ReadStats>(stats);
+}
+
 void ConnectionImplBase::setDelayedCloseTimeout(std::chrono::milliseconds timeout) {
   // Validate that this is only called prior to issuing a close() or closeSocket().
   ASSERT(delayed_close_timer_ == nullptr && state() == State::Open);
@@ -18,6 +18,7 @@ public:
   Event::Dispatcher& dispatcher() override { return dispatcher_; }
   uint64_t id() const override { return id_; }
   void setConnectionStats(const ConnectionStats& stats) override;
+  void setReadStats(const ReadStats& stats) override;
   void setDelayedCloseTimeout(std::chrono::milliseconds timeout) override;
 
 protected:
@@ -50,6 +51,7 @@ protected:
   const uint64_t id_;
   std::list<ConnectionCallbacks*> callbacks_;
   std::unique_ptr<ConnectionStats> connection_stats_;
+  std::unique_ptr<ReadStats> read_stats_;
 
 private:
   // Callback issued when a delayed close timeout triggers.
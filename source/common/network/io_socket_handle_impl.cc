@@ -1,6 +1,7 @@
 #include "common/network/io_socket_handle_impl.h"
 
 #include "envoy/buffer/buffer.h"
+#include "envoy/event/dispatcher.h"
 
 #include "common/api/os_sys_calls_impl.h"
 #include "common/common/utility.h"
@@ -379,6 +380,10 @@ bool IoSocketHandleImpl::supportsUdpGro() const {
   return Api::OsSysCallsSingleton::get().supportsUdpGro();
 }
 
+bool IoSocketHandleImpl::supportsSplice() const {
+  return Api::OsSysCallsSingleton::get().supportsSplice();
+}
+
 Api::SysCallIntResult IoSocketHandleImpl::bind(Address::InstanceConstSharedPtr address) {
   return Api::OsSysCallsSingleton::get().bind(fd_, address->sockAddr(), address->sockAddrLen());
 }
@@ -471,5 +476,12 @@ Address::InstanceConstSharedPtr IoSocketHandleImpl::peerAddress() {
   return Address::addressFromSockAddr(ss, ss_len);
 }
 
+Event::FileEventPtr IoSocketHandleImpl::createFileEvent(Event::Dispatcher& dispatcher,
+                                                        Event::FileReadyCb cb,
+                                                        Event::FileTriggerType trigger,
+                                                        uint32_t events) {
+  return dispatcher.createFileEvent(fd_, cb, trigger, events);
+}
+
 } // namespace Network
 } // namespace Envoy
@@ -1,13 +1,40 @@
 #include "common/network/raw_buffer_socket.h"
 
+#include <algorithm>
+
+#include "envoy/common/platform.h"
+
 #include "common/api/os_sys_calls_impl.h"
 #include "common/common/assert.h"
 #include "common/common/empty_string.h"
 #include "common/http/headers.h"
 
+#include "absl/container/fixed_array.h"
+
+#if defined(__linux__) && defined(MSG_ZEROCOPY) && defined(SO_ZEROCOPY)
+#include <linux/errqueue.h>
+#define ENVOY_RAW_BUFFER_ZERO_COPY
+#endif
+
 namespace Envoy {
 namespace Network {
 
+namespace {
+// The most slices written at once, as in OwnedImpl::write().
+constexpr uint64_t MaxSlicesPerWrite = 16;
+} // namespace
+
+RawBufferZeroCopyConfig::RawBufferZeroCopyConfig(uint32_t threshold, Stats::Scope& scope)
+    : threshold_(threshold), stats_{ALL_RAW_BUFFER_ZERO_COPY_STATS(
+                                 POOL_COUNTER_PREFIX(scope, "raw_buffer."))} {}
+
+RawBufferSocket::RawBufferSocket(RawBufferZeroCopyConfigSharedPtr zero_copy_config)
+    : zero_copy_config_(std::move(zero_copy_config)) {
+#ifdef ENVOY_RAW_BUFFER_ZERO_COPY
+  zero_copy_enabled_ = zero_copy_config_ != nullptr;
+#endif
+}
+
 void RawBufferSocket::setTransportSocketCallbacks(TransportSocketCallbacks& callbacks) {
   ASSERT(!callbacks_);
   callbacks_ = &callbacks;
@@ -18,8 +45,8 @@ IoResult RawBufferSocket::doRead(Buffer::Instance& buffer) {
   uint64_t bytes_read = 0;
   bool end_stream = false;
   do {
-    // 16K read is arbitrary. TODO(mattklein123) PERF: Tune the read size.
-    Api::IoCallUint64Result result = buffer.read(callbacks_->ioHandle(), 16384);
+    Api::IoCallUint64Result result = buffer.read(callbacks_->ioHandle(), read_size_);
+    callbacks_->onSocketRead(result.ok() ? result.rc_ : 0);
 
     if (result.ok()) {
       ENVOY_CONN_LOG(trace, "read returns: {}", callbacks_->connection(), result.rc_);
@@ -29,6 +56,7 @@ IoResult RawBufferSocket::doRead(Buffer::Instance& buffer) {
         break;
       }
       bytes_read += result.rc_;
+      adaptReadSize(result.rc_);
       if (callbacks_->shouldDrainReadBuffer()) {
         callbacks_->setReadBufferReady();
         break;
@@ -47,7 +75,30 @@ IoResult RawBufferSocket::doRead(Buffer::Instance& buffer) {
   return {action, bytes_read, end_stream};
 }
 
+void RawBufferSocket::adaptReadSize(uint64_t bytes_read) {
+  if (bytes_read == read_size_) {
+    num_short_reads_ = 0;
+    // Reading more than the connection buffers at once would only have it stop reading sooner.
+    const uint32_t buffer_limit = callbacks_->connection().bufferLimit();
+    const uint64_t max_read_size =
+        buffer_limit > 0 ? std::max(DefaultReadSize, std::min<uint64_t>(MaxReadSize, buffer_limit))
+                         : MaxReadSize;
+    read_size_ = std::max(read_size_, std::min(read_size_ * 2, max_read_size));
+  } else if (bytes_read <= read_size_ / 4 && read_size_ > MinReadSize) {
+    if (++num_short_reads_ == ShortReadsToShrink) {
+      num_short_reads_ = 0;
+      read_size_ /= 2;
+    }
+  } else {
+    num_short_reads_ = 0;
+  }
+}
+
 IoResult RawBufferSocket::doWrite(Buffer::Instance& buffer, bool end_stream) {
+  if (zero_copy_config_ != nullptr) {
+    return doZeroCopyWrite(buffer, end_stream);
+  }
+
   PostIoAction action;
   uint64_t bytes_written = 0;
   ASSERT(!shutdown_ || buffer.length() == 0);
@@ -82,14 +133,217 @@ IoResult RawBufferSocket::doWrite(Buffer::Instance& buffer, bool end_stream) {
   return {action, bytes_written, false};
 }
 
+IoResult RawBufferSocket::doZeroCopyWrite(Buffer::Instance& buffer, bool end_stream) {
+  readZeroCopyCompletions();
+  releaseCompletedSends(buffer);
+
+  PostIoAction action = PostIoAction::KeepOpen;
+  uint64_t bytes_written = 0;
+  ASSERT(!shutdown_ || buffer.length() == zero_copy_held_bytes_);
+  while (buffer.length() > zero_copy_held_bytes_) {
+    // Only what follows the held bytes is left to send.
+    Buffer::RawSliceVector slices = buffer.getRawSlices();
+    uint64_t first_slice = 0;
+    uint64_t skip = zero_copy_held_bytes_;
+    while (skip >= slices[first_slice].len_) {
+      skip -= slices[first_slice].len_;
+      first_slice++;
+    }
+    slices[first_slice].mem_ = static_cast<uint8_t*>(slices[first_slice].mem_) + skip;
+    slices[first_slice].len_ -= skip;
+    const uint64_t num_slices = std::min(slices.size() - first_slice, MaxSlicesPerWrite);
+    uint64_t length = 0;
+    for (uint64_t i = first_slice; i < first_slice + num_slices; i++) {
+      length += slices[i].len_;
+    }
+
+    if (zero_copy_enabled_ && length >= zero_copy_config_->threshold_) {
+      enableZeroCopy();
+    }
+    if (zero_copy_enabled_ && length >= zero_copy_config_->threshold_) {
+      const Api::SysCallSizeResult result = sendZeroCopy(&slices[first_slice], num_slices);
+      if (result.rc_ != -1) {
+        ENVOY_CONN_LOG(trace, "zero copy write returns: {}", callbacks_->connection(), result.rc_);
+        held_sends_.push_back({static_cast<uint64_t>(result.rc_), next_zero_copy_id_++, false});
+        zero_copy_held_bytes_ += result.rc_;
+        bytes_written += result.rc_;
+        zero_copy_config_->stats_.zero_copy_sends_.inc();
+        zero_copy_config_->stats_.zero_copy_bytes_.add(result.rc_);
+        continue;
+      }
+      if (result.errno_ == SOCKET_ERROR_AGAIN) {
+        break;
+      }
+      ENVOY_CONN_LOG(trace, "zero copy write error: {}", callbacks_->connection(), result.errno_);
+      if (result.errno_ != ENOBUFS) {
+        action = PostIoAction::Close;
+        break;
+      }
+      // The socket is out of memory for completion notifications, so this write is copied.
+      zero_copy_config_->stats_.zero_copy_fallback_.inc();
+    }
+
+    Api::IoCallUint64Result result =
+        callbacks_->ioHandle().writev(&slices[first_slice], num_slices);
+    if (!result.ok()) {
+      ENVOY_CONN_LOG(trace, "write error: {}", callbacks_->connection(),
+                     result.err_->getErrorDetails());
+      if (result.err_->getErrorCode() != Api::IoError::IoErrorCode::Again) {
+        action = PostIoAction::Close;
+      }
+      break;
+    }
+    ENVOY_CONN_LOG(trace, "write returns: {}", callbacks_->connection(), result.rc_);
+    bytes_written += result.rc_;
+    if (held_sends_.empty()) {
+      buffer.drain(result.rc_);
+    } else {
+      // Copied bytes are released along with the zero copy sends before them.
+      held_sends_.push_back({result.rc_, 0, true});
+      zero_copy_held_bytes_ += result.rc_;
+    }
+  }
+
+  if (action == PostIoAction::KeepOpen && buffer.length() == zero_copy_held_bytes_ && end_stream &&
+      !shutdown_) {
+    // Held bytes were already sent. As in doWrite(), the result is ignored.
+    Api::OsSysCallsSingleton::get().shutdown(callbacks_->ioHandle().fd(), ENVOY_SHUT_WR);
+    shutdown_ = true;
+  }
+  return {action, bytes_written, false};
+}
+
+Api::SysCallSizeResult RawBufferSocket::sendZeroCopy(const Buffer::RawSlice* slices,
+                                                     uint64_t num_slices) {
+#ifdef ENVOY_RAW_BUFFER_ZERO_COPY
+  absl::FixedArray<iovec> iov(num_slices);
+  for (uint64_t i = 0; i < num_slices; i++) {
+    iov[i].iov_base = slices[i].mem_;
+    iov[i].iov_len = slices[i].len_;
+  }
+  msghdr message{};
+  message.msg_iov = iov.begin();
+  message.msg_iovlen = num_slices;
+  return Api::OsSysCallsSingleton::get().sendmsg(callbacks_->ioHandle().fd(), &message,
+                                                 MSG_ZEROCOPY);
+#else
+  UNREFERENCED_PARAMETER(slices);
+  UNREFERENCED_PARAMETER(num_slices);
+  NOT_REACHED_GCOVR_EXCL_LINE;
+#endif
+}
+
+void RawBufferSocket::enableZeroCopy() {
+#ifdef ENVOY_RAW_BUFFER_ZERO_COPY
+  if (zero_copy_socket_option_set_) {
+    return;
+  }
+  const int enable = 1;
+  const Api::SysCallIntResult result =
+      callbacks_->ioHandle().setOption(SOL_SOCKET, SO_ZEROCOPY, &enable, sizeof(enable));
+  if (result.rc_ != 0) {
+    ENVOY_CONN_LOG(debug, "zero copy sends are not supported: {}", callbacks_->connection(),
+                   result.errno_);
+    zero_copy_enabled_ = false;
+    zero_copy_config_->stats_.zero_copy_fallback_.inc();
+    return;
+  }
+  zero_copy_socket_option_set_ = true;
+#endif
+}
+
+void RawBufferSocket::readZeroCopyCompletions() {
+#ifdef ENVOY_RAW_BUFFER_ZERO_COPY
+  if (held_sends_.empty()) {
+    return;
+  }
+  while (true) {
+    char control[CMSG_SPACE(sizeof(sock_extended_err)) + CMSG_SPACE(sizeof(sockaddr_in6))];
+    msghdr message{};
+    message.msg_control = control;
+    message.msg_controllen = sizeof(control);
+    if (Api::OsSysCallsSingleton::get()
+            .recvmsg(callbacks_->ioHandle().fd(), &message, MSG_ERRQUEUE)
+            .rc_ == -1) {
+      // Nothing else is queued.
+      return;
+    }
+    for (cmsghdr* cmsg = CMSG_FIRSTHDR(&message); cmsg != nullptr;
+         cmsg = CMSG_NXTHDR(&message, cmsg)) {
+      if (!(cmsg->cmsg_level == SOL_IP && cmsg->cmsg_type == IP_RECVERR) &&
+          !(cmsg->cmsg_level == SOL_IPV6 && cmsg->cmsg_type == IPV6_RECVERR)) {
+        continue;
+      }
+      const auto* error = reinterpret_cast<const sock_extended_err*>(CMSG_DATA(cmsg));
+      if (error->ee_errno == 0 && error->ee_origin == SO_EE_ORIGIN_ZEROCOPY) {
+        // The ids of the completed sends range from ee_info to ee_data.
+        onZeroCopyCompleted(error->ee_info, error->ee_data,
+                            error->ee_code & SO_EE_CODE_ZEROCOPY_COPIED);
+      }
+    }
+  }
+#endif
+}
+
+void RawBufferSocket::onZeroCopyCompleted(uint32_t first_id, uint32_t last_id, bool copied) {
+  for (HeldSend& send : held_sends_) {
+    // Ids wrap around.
+    if (!send.completed_ && send.id_ - first_id <= last_id - first_id) {
+      send.completed_ = true;
+    }
+  }
+  if (copied) {
+    // The kernel copied the data anyway, e.g. to deliver it locally, so it is cheaper to copy it
+    // right away from now on.
+    zero_copy_config_->stats_.zero_copy_copied_.add(last_id - first_id + 1);
+    if (zero_copy_enabled_) {
+      ENVOY_CONN_LOG(debug, "zero copy sends were copied, disabling them",
+                     callbacks_->connection());
+      zero_copy_enabled_ = false;
+    }
+  }
+}
+
+void RawBufferSocket::releaseCompletedSends(Buffer::Instance& buffer) {
+  uint64_t completed_bytes = 0;
+  while (!held_sends_.empty() && held_sends_.front().completed_) {
+    completed_bytes += held_sends_.front().length_;
+    held_sends_.pop_front();
+  }
+  if (completed_bytes > 0) {
+    zero_copy_held_bytes_ -= completed_bytes;
+    buffer.drain(completed_bytes);
+  }
+}
+
+void RawBufferSocket::closeSocket(Network::ConnectionEvent) {
+  if (held_sends_.empty()) {
+    return;
+  }
+  readZeroCopyCompletions();
+  if (std::any_of(held_sends_.begin(), held_sends_.end(),
+                  [](const HeldSend& send) { return !send.completed_; })) {
+    // The write buffer is freed along with the connection while the kernel may still be reading
+    // from it, so reset the connection on close rather than let it transmit whatever is there by
+    // then.
+    const linger reset{1, 0};
+    callbacks_->ioHandle().setOption(SOL_SOCKET, SO_LINGER, &reset, sizeof(reset));
+  }
+  held_sends_.clear();
+  zero_copy_held_bytes_ = 0;
+}
+
 std::string RawBufferSocket::protocol() const { return EMPTY_STRING; }
 absl::string_view RawBufferSocket::failureReason() const { return EMPTY_STRING; }
 
 void RawBufferSocket::onConnected() { callbacks_->raiseEvent(ConnectionEvent::Connected); }
 
+RawBufferSocketFactory::RawBufferSocketFactory(uint32_t zero_copy_threshold, Stats::Scope& scope)
+    : zero_copy_config_(std::make_shared<RawBufferZeroCopyConfig>(zero_copy_threshold, scope)) {}
+
 TransportSocketPtr
 RawBufferSocketFactory::createTransportSocket(TransportSocketOptionsSharedPtr) const {
-  return std::make_unique<RawBufferSocket>();
+  return std::make_unique<RawBufferSocket>(zero_copy_config_);
 }
 
 bool RawBufferSocketFactory::implementsSecureTransport() const { return false; }
@@ -1,37 +1,132 @@
 #pragma once
 
+#include <deque>
+
+#include "envoy/api/os_sys_calls_common.h"
 #include "envoy/buffer/buffer.h"
 #include "envoy/network/connection.h"
 #include "envoy/network/transport_socket.h"
+#include "envoy/stats/scope.h"
+#include "envoy/stats/stats_macros.h"
 
 #include "common/common/logger.h"
 
 namespace Envoy {
 namespace Network {
 
+/**
+ * All raw buffer zero copy stats. @see stats_macros.h
+ */
+#define ALL_RAW_BUFFER_ZERO_COPY_STATS(COUNTER)                                                    \
+  COUNTER(zero_copy_bytes)                                                                         \
+  COUNTER(zero_copy_copied)                                                                        \
+  COUNTER(zero_copy_fallback)                                                                      \
+  COUNTER(zero_copy_sends)
+
+/**
+ * Struct definition for all raw buffer zero copy stats. @see stats_macros.h
+ */
+struct RawBufferZeroCopyStats {
+  ALL_RAW_BUFFER_ZERO_COPY_STATS(GENERATE_COUNTER_STRUCT)
+};
+
+/**
+ * Zero copy settings shared by the sockets of a RawBufferSocketFactory.
+ */
+struct RawBufferZeroCopyConfig {
+  RawBufferZeroCopyConfig(uint32_t threshold, Stats::Scope& scope);
+
+  // Writes of at least this many bytes are sent with MSG_ZEROCOPY.
+  const uint32_t threshold_;
+  RawBufferZeroCopyStats stats_;
+};
+
+using RawBufferZeroCopyConfigSharedPtr = std::shared_ptr<RawBufferZeroCopyConfig>;
+
 class RawBufferSocket : public TransportSocket, protected Logger::Loggable<Logger::Id::connection> {
 public:
+  RawBufferSocket() = default;
+  /**
+   * @param zero_copy_config supplies the zero copy settings, or nullptr if data is always copied.
+   */
+  explicit RawBufferSocket(RawBufferZeroCopyConfigSharedPtr zero_copy_config);
+
   // Network::TransportSocket
   void setTransportSocketCallbacks(TransportSocketCallbacks& callbacks) override;
   std::string protocol() const override;
   absl::string_view failureReason() const override;
   bool canFlushClose() override { return true; }
-  void closeSocket(Network::ConnectionEvent) override {}
+  bool canSplice() const override { return true; }
+  void closeSocket(Network::ConnectionEvent) override;
   void onConnected() override;
   IoResult doRead(Buffer::Instance& buffer) override;
   IoResult doWrite(Buffer::Instance& buffer, bool end_stream) override;
   Ssl::ConnectionInfoConstSharedPtr ssl() const override { return nullptr; }
 
+  // Reads start at DefaultReadSize. The read size doubles after each read which fills it, up to
+  // MaxReadSize, so that bulk transfers need fewer reads, and halves down to MinReadSize after
+  // ShortReadsToShrink reads in a row return at most a quarter of it, so that the read buffers of
+  // connections carrying small messages hold on to smaller slices.
+  static constexpr uint64_t MinReadSize = 2048;
+  static constexpr uint64_t DefaultReadSize = 16384;
+  static constexpr uint64_t MaxReadSize = 65536;
+  static constexpr uint32_t ShortReadsToShrink = 2;
+
+  uint64_t readSize() const { return read_size_; }
+  // The bytes at the start of the write buffer which were sent but are held until the kernel is
+  // done with the zero copy sends among them.
+  uint64_t zeroCopyHeldBytes() const { return zero_copy_held_bytes_; }
+
 private:
+  // A send whose bytes are held at the start of the write buffer.
+  struct HeldSend {
+    uint64_t length_;
+    // The notification id of a zero copy send.
+    uint32_t id_;
+    bool completed_;
+  };
+
+  void adaptReadSize(uint64_t bytes_read);
+  IoResult doZeroCopyWrite(Buffer::Instance& buffer, bool end_stream);
+  Api::SysCallSizeResult sendZeroCopy(const Buffer::RawSlice* slices, uint64_t num_slices);
+  // Sets SO_ZEROCOPY on the socket before its first zero copy send.
+  void enableZeroCopy();
+  // Marks the sends reported by the zero copy completions queued on the socket as completed.
+  void readZeroCopyCompletions();
+  void onZeroCopyCompleted(uint32_t first_id, uint32_t last_id, bool copied);
+  // Drains the bytes of the completed sends at the start of the write buffer.
+  void releaseCompletedSends(Buffer::Instance& buffer);
+
   TransportSocketCallbacks* callbacks_{};
   bool shutdown_{};
+  uint64_t read_size_{DefaultReadSize};
+  uint32_t num_short_reads_{};
+
+  const RawBufferZeroCopyConfigSharedPtr zero_copy_config_;
+  // Whether zero copy sends are used. They stop being used once the kernel reports that it
+  // copied the data anyway, e.g. for loopback connections, or if the socket doesn't support them.
+  bool zero_copy_enabled_{};
+  bool zero_copy_socket_option_set_{};
+  std::deque<HeldSend> held_sends_;
+  uint64_t zero_copy_held_bytes_{};
+  uint32_t next_zero_copy_id_{};
 };
 
 class RawBufferSocketFactory : public TransportSocketFactory {
 public:
+  RawBufferSocketFactory() = default;
+  /**
+   * @param zero_copy_threshold supplies the size from which writes are sent with MSG_ZEROCOPY.
+   * @param scope supplies the scope of the zero copy stats.
+   */
+  RawBufferSocketFactory(uint32_t zero_copy_threshold, Stats::Scope& scope);
+
   // Network::TransportSocketFactory
   TransportSocketPtr createTransportSocket(TransportSocketOptionsSharedPtr options) const override;
   bool implementsSecureTransport() const override;
+
+private:
+  RawBufferZeroCopyConfigSharedPtr zero_copy_config_;
 };
 
 } // namespace Network
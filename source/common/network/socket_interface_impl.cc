@@ -42,7 +42,7 @@ IoHandlePtr SocketInterfaceImpl::socket(Socket::Type socket_type, Address::Type
   const Api::SysCallSocketResult result = Api::OsSysCallsSingleton::get().socket(domain, flags, 0);
   RELEASE_ASSERT(SOCKET_VALID(result.rc_),
                  fmt::format("socket(2) failed, got error: {}", errorDetails(result.errno_)));
-  IoHandlePtr io_handle = std::make_unique<IoSocketHandleImpl>(result.rc_, socket_v6only);
+  IoHandlePtr io_handle = makeSocket(result.rc_, socket_v6only);
 
 #if defined(__APPLE__) || defined(WIN32)
   // Cannot set SOCK_NONBLOCK as a ::socket flag.
@@ -73,6 +73,10 @@ IoHandlePtr SocketInterfaceImpl::socket(Socket::Type socket_type,
   return io_handle;
 }
 
+IoHandlePtr SocketInterfaceImpl::makeSocket(os_fd_t socket_fd, bool socket_v6only) const {
+  return std::make_unique<IoSocketHandleImpl>(socket_fd, socket_v6only);
+}
+
 IoHandlePtr SocketInterfaceImpl::socket(os_fd_t fd) {
   return std::make_unique<IoSocketHandleImpl>(fd);
 }
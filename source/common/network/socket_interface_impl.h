@@ -26,6 +26,15 @@ public:
   std::string name() const override {
     return "envoy.extensions.network.socket_interface.default_socket_interface";
   };
+
+protected:
+  /**
+   * Wraps a socket created by this interface.
+   * @param socket_fd supplies the file descriptor of the socket.
+   * @param socket_v6only supplies whether the socket is an IPv6 only socket.
+   * @return IoHandlePtr the handle through which the socket is used.
+   */
+  virtual IoHandlePtr makeSocket(os_fd_t socket_fd, bool socket_v6only) const;
 };
 
 DECLARE_FACTORY(SocketInterfaceImpl);
@@ -1109,22 +1109,33 @@ VirtualHostImpl::VirtualHostImpl(const envoy::config::route::v3::VirtualHost& vi
   }
 
   for (const auto& route : virtual_host.routes()) {
+    const uint32_t position = routes_.size();
+    const bool case_sensitive =
+        PROTOBUF_GET_WRAPPED_OR_DEFAULT(route.match(), case_sensitive, true);
     switch (route.match().path_specifier_case()) {
     case envoy::config::route::v3::RouteMatch::PathSpecifierCase::kPrefix: {
       routes_.emplace_back(new PrefixRouteEntryImpl(*this, route, factory_context, validator));
+      path_index_.addPrefix(position, route.match().prefix(), case_sensitive);
       break;
     }
     case envoy::config::route::v3::RouteMatch::PathSpecifierCase::kPath: {
       routes_.emplace_back(new PathRouteEntryImpl(*this, route, factory_context, validator));
+      path_index_.addExact(position, route.match().path(), case_sensitive);
+      break;
+    }
+    case envoy::config::route::v3::RouteMatch::PathSpecifierCase::kHiddenEnvoyDeprecatedRegex: {
+      routes_.emplace_back(new RegexRouteEntryImpl(*this, route, factory_context, validator));
+      path_index_.addUnindexed(position);
       break;
     }
-    case envoy::config::route::v3::RouteMatch::PathSpecifierCase::kHiddenEnvoyDeprecatedRegex:
     case envoy::config::route::v3::RouteMatch::PathSpecifierCase::kSafeRegex: {
       routes_.emplace_back(new RegexRouteEntryImpl(*this, route, factory_context, validator));
+      path_index_.addRegex(position, route.match().safe_regex());
       break;
     }
     case envoy::config::route::v3::RouteMatch::PathSpecifierCase::kConnectMatcher: {
       routes_.emplace_back(new ConnectRouteEntryImpl(*this, route, factory_context, validator));
+      path_index_.addUnindexed(position);
       break;
     }
     case envoy::config::route::v3::RouteMatch::PathSpecifierCase::PATH_SPECIFIER_NOT_SET:
@@ -1143,6 +1154,8 @@ VirtualHostImpl::VirtualHostImpl(const envoy::config::route::v3::VirtualHost& vi
     }
   }
 
+  path_index_.compile();
+
   for (const auto& virtual_cluster : virtual_host.virtual_clusters()) {
     virtual_clusters_.push_back(
         VirtualClusterEntry(virtual_cluster, stat_name_pool_, *vcluster_scope_));
@@ -1270,7 +1283,24 @@ RouteConstSharedPtr VirtualHostImpl::getRouteFromEntries(const RouteCallback& cb
     return SSL_REDIRECT_ROUTE;
   }
 
-  // Check for a route that matches the request.
+  if (!cb && headers.Path()) {
+    // Only the indexed candidates can match, and they are evaluated in route order, so the first
+    // one that matches is the route the walk below would select.
+    RoutePathIndex::Candidates candidates;
+    path_index_.candidates(Http::PathUtil::removeQueryAndFragment(headers.getPathValue()),
+                           candidates);
+    for (const uint32_t position : candidates) {
+      RouteConstSharedPtr route_entry =
+          routes_[position]->matches(headers, stream_info, random_value);
+      if (route_entry != nullptr) {
+        return route_entry;
+      }
+    }
+    return nullptr;
+  }
+
+  // Check for a route that matches the request. Callbacks may reject matches and ask for the
+  // following ones, so they see every route in order.
   for (auto route = routes_.begin(); route != routes_.end(); ++route) {
     if (!headers.Path() && !(*route)->supportsPathlessHeaders()) {
       continue;
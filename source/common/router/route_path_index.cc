@@ -0,0 +1,152 @@
+#include "common/router/route_path_index.h"
+
+#include <algorithm>
+
+#include "envoy/common/exception.h"
+
+#include "common/common/assert.h"
+#include "common/common/logger.h"
+#include "common/common/regex.h"
+
+#include "absl/strings/ascii.h"
+
+namespace Envoy {
+namespace Router {
+
+namespace {
+constexpr uint32_t NoChild = 0;
+
+void addToList(std::vector<uint32_t>& list, uint32_t position) {
+  ASSERT(list.empty() || list.back() < position);
+  list.push_back(position);
+}
+
+void appendList(const std::vector<uint32_t>& list, RoutePathIndex::Candidates& candidates) {
+  candidates.insert(candidates.end(), list.begin(), list.end());
+}
+} // namespace
+
+uint32_t RoutePathIndex::Trie::findChild(uint32_t node, char c) const {
+  const auto& children = nodes_[node].children_;
+  auto it = std::lower_bound(
+      children.begin(), children.end(), c,
+      [](const std::pair<char, uint32_t>& child, char value) { return child.first < value; });
+  return it != children.end() && it->first == c ? it->second : NoChild;
+}
+
+void RoutePathIndex::Trie::add(absl::string_view prefix, uint32_t position) {
+  uint32_t node = 0;
+  for (const char c : prefix) {
+    uint32_t child = findChild(node, c);
+    if (child == NoChild) {
+      // The root is never a child, so index 0 can mark a missing child.
+      child = nodes_.size();
+      nodes_.emplace_back();
+      auto& children = nodes_[node].children_;
+      children.insert(std::upper_bound(children.begin(), children.end(), c,
+                                       [](char value, const std::pair<char, uint32_t>& child) {
+                                         return value < child.first;
+                                       }),
+                      {c, child});
+    }
+    node = child;
+  }
+  addToList(nodes_[node].routes_, position);
+}
+
+template <class CharTransform>
+void RoutePathIndex::Trie::collect(absl::string_view path, CharTransform transform,
+                                   Candidates& candidates) const {
+  uint32_t node = 0;
+  appendList(nodes_[node].routes_, candidates);
+  for (const char c : path) {
+    node = findChild(node, transform(c));
+    if (node == NoChild) {
+      return;
+    }
+    appendList(nodes_[node].routes_, candidates);
+  }
+}
+
+void RoutePathIndex::addExact(uint32_t position, absl::string_view path, bool case_sensitive) {
+  if (case_sensitive) {
+    addToList(exact_[std::string(path)], position);
+  } else {
+    addToList(exact_ignore_case_[absl::AsciiStrToLower(path)], position);
+  }
+}
+
+void RoutePathIndex::addPrefix(uint32_t position, absl::string_view prefix, bool case_sensitive) {
+  if (case_sensitive) {
+    prefixes_.add(prefix, position);
+  } else {
+    prefixes_ignore_case_.add(absl::AsciiStrToLower(prefix), position);
+  }
+}
+
+void RoutePathIndex::addRegex(uint32_t position,
+                              const envoy::type::matcher::v3::RegexMatcher& regex) {
+  ASSERT(regex_set_ == nullptr);
+  addToList(regex_positions_, position);
+  regexes_.push_back(regex);
+}
+
+void RoutePathIndex::addUnindexed(uint32_t position) { addToList(unindexed_, position); }
+
+void RoutePathIndex::compile() {
+  ASSERT(regex_set_ == nullptr);
+  if (regexes_.empty()) {
+    return;
+  }
+  std::vector<const envoy::type::matcher::v3::RegexMatcher*> regexes;
+  regexes.reserve(regexes_.size());
+  for (const auto& regex : regexes_) {
+    regexes.push_back(&regex);
+  }
+  try {
+    regex_set_ = Regex::Utility::parseRegexSet(regexes);
+  } catch (const EnvoyException& e) {
+    ENVOY_LOG_MISC(warn, "matching {} route regexes one at a time: {}", regexes.size(), e.what());
+  }
+  regexes_.clear();
+  regexes_.shrink_to_fit();
+}
+
+void RoutePathIndex::candidates(absl::string_view path, Candidates& candidates) const {
+  candidates.clear();
+  appendList(unindexed_, candidates);
+
+  auto exact = exact_.find(path);
+  if (exact != exact_.end()) {
+    appendList(exact->second, candidates);
+  }
+  if (!exact_ignore_case_.empty()) {
+    exact = exact_ignore_case_.find(absl::AsciiStrToLower(path));
+    if (exact != exact_ignore_case_.end()) {
+      appendList(exact->second, candidates);
+    }
+  }
+
+  prefixes_.collect(
+      path, [](char c) { return c; }, candidates);
+  if (!prefixes_ignore_case_.empty()) {
+    prefixes_ignore_case_.collect(path, absl::ascii_tolower, candidates);
+  }
+
+  std::vector<uint32_t> matches;
+  if (regex_set_ != nullptr && regex_set_->match(path, matches)) {
+    for (const uint32_t match : matches) {
+      candidates.push_back(regex_positions_[match]);
+    }
+  } else {
+    // Let each regex route evaluate its own regex instead.
+    appendList(regex_positions_, candidates);
+  }
+
+  // Each list is in route order and every route is in exactly one list, so sorting restores the
+  // route order without duplicates.
+  std::sort(candidates.begin(), candidates.end());
+}
+
+} // namespace Router
+} // namespace Envoy
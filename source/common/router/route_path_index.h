@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "envoy/common/regex.h"
+#include "envoy/type/matcher/v3/regex.pb.h"
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/inlined_vector.h"
+#include "absl/strings/string_view.h"
+
+namespace Envoy {
+namespace Router {
+
+/**
+ * Index over the path match criteria of an ordered list of routes. Given a request path, it
+ * returns, in route order, the positions of the routes whose path criterion may match it: exact
+ * routes for that path, prefix routes for any prefix of it, regex routes whose regex matches it,
+ * and every route whose criterion isn't indexed (CONNECT and std::regex routes). No other route
+ * can match the path. So evaluating only the candidates, in order, selects the same first matching
+ * route as walking the whole list, while skipping most routes in large tables.
+ */
+class RoutePathIndex {
+public:
+  using Candidates = absl::InlinedVector<uint32_t, 16>;
+
+  /**
+   * Routes must be added in ascending position order.
+   */
+  void addExact(uint32_t position, absl::string_view path, bool case_sensitive);
+  void addPrefix(uint32_t position, absl::string_view prefix, bool case_sensitive);
+  void addRegex(uint32_t position, const envoy::type::matcher::v3::RegexMatcher& regex);
+  void addUnindexed(uint32_t position);
+
+  /**
+   * Compiles the regexes of all added regex routes into one set, so that a single pass over the
+   * path finds every candidate among them. Must be called once all routes have been added. If the
+   * regexes can't be compiled together, every regex route stays a candidate for every path.
+   */
+  void compile();
+
+  /**
+   * Sets candidates to the positions of the routes that may match path, in ascending order.
+   * @param path the request path, without query and fragment.
+   */
+  void candidates(absl::string_view path, Candidates& candidates) const;
+
+private:
+  // Prefix trie node. Children are kept sorted by character; sparse nodes dominate route tables,
+  // so this is much smaller than a fixed fan-out and just as fast to search.
+  struct TrieNode {
+    std::vector<std::pair<char, uint32_t>> children_;
+    // Routes whose prefix ends at this node.
+    std::vector<uint32_t> routes_;
+  };
+
+  class Trie {
+  public:
+    Trie() : nodes_(1) {}
+    void add(absl::string_view prefix, uint32_t position);
+    // Appends the routes of every prefix of path.
+    template <class CharTransform>
+    void collect(absl::string_view path, CharTransform transform, Candidates& candidates) const;
+    bool empty() const { return nodes_.size() == 1 && nodes_[0].routes_.empty(); }
+
+  private:
+    uint32_t findChild(uint32_t node, char c) const;
+
+    std::vector<TrieNode> nodes_;
+  };
+
+  using ExactIndex = absl::flat_hash_map<std::string, std::vector<uint32_t>>;
+
+  ExactIndex exact_;
+  // Keyed by lower cased path.
+  ExactIndex exact_ignore_case_;
+  Trie prefixes_;
+  // Keyed by lower cased prefix.
+  Trie prefixes_ignore_case_;
+  // Regexes of regex routes, until compile() moves them into regex_set_.
+  std::vector<envoy::type::matcher::v3::RegexMatcher> regexes_;
+  Regex::CompiledMatcherSetPtr regex_set_;
+  // Route position of each pattern in regex_set_.
+  std::vector<uint32_t> regex_positions_;
+  std::vector<uint32_t> unindexed_;
+};
+
+} // namespace Router
+} // namespace Envoy
@@ -824,6 +824,7 @@ void Filter::onResponseTimeout() {
         updateOutlierDetection(Upstream::Outlier::Result::LocalOriginTimeout, *upstream_request,
                                absl::optional<uint64_t>(enumToInt(timeout_response_code_)));
       }
+      updateLoadBalancerResponseTime(*upstream_request);
 
       chargeUpstreamAbort(timeout_response_code_, false, *upstream_request);
     }
@@ -880,6 +881,7 @@ void Filter::onPerTryTimeout(UpstreamRequest& upstream_request) {
 
   updateOutlierDetection(Upstream::Outlier::Result::LocalOriginTimeout, upstream_request,
                          absl::optional<uint64_t>(enumToInt(timeout_response_code_)));
+  updateLoadBalancerResponseTime(upstream_request);
 
   if (maybeRetryReset(Http::StreamResetReason::LocalReset, upstream_request)) {
     return;
@@ -926,6 +928,39 @@ void Filter::updateOutlierDetection(Upstream::Outlier::Result result,
   }
 }
 
+void Filter::updateLoadBalancerResponseTime(UpstreamRequest& upstream_request) {
+  if (cluster_->lbType() != Upstream::LoadBalancerType::PeakEwma ||
+      upstream_request.upstreamHost() == nullptr) {
+    return;
+  }
+
+  // Latency aware load balancers learn from the time the host took to respond, which unlike
+  // response_time excludes the time spent sending the request body. A timed out or reset request
+  // counts until now, so that a host which stops responding gets more expensive rather than
+  // keeping its last good estimate.
+  const StreamInfo::UpstreamTiming& upstream_timing = upstream_request.upstreamTiming();
+  const absl::optional<MonotonicTime>& request_sent =
+      upstream_timing.last_upstream_tx_byte_sent_.has_value()
+          ? upstream_timing.last_upstream_tx_byte_sent_
+          : upstream_timing.first_upstream_tx_byte_sent_;
+  if (!request_sent.has_value()) {
+    // The request never reached the host.
+    return;
+  }
+  const MonotonicTime response_received = upstream_timing.last_upstream_rx_byte_received_.value_or(
+      callbacks_->dispatcher().timeSource().monotonicTime());
+
+  // The thread local cluster, which owns the load balancer, is looked up again rather than kept
+  // from decodeHeaders(), as it is destroyed if the cluster is removed while the request is in
+  // flight. The samples are only for the load balancer of the cluster that cluster_ was routed
+  // to, and not for one that has replaced it since.
+  Upstream::ThreadLocalCluster* cluster = config_.cm_.get(cluster_->name());
+  if (cluster != nullptr && cluster->info() == cluster_) {
+    cluster->loadBalancer().onHostResponseTime(*upstream_request.upstreamHost(),
+                                               response_received - request_sent.value());
+  }
+}
+
 void Filter::chargeUpstreamAbort(Http::Code code, bool dropped, UpstreamRequest& upstream_request) {
   if (downstream_response_started_) {
     if (upstream_request.grpcRqSuccessDeferred()) {
@@ -1035,6 +1070,7 @@ void Filter::onUpstreamReset(Http::StreamResetReason reset_reason,
   // config param set to true.
   updateOutlierDetection(Upstream::Outlier::Result::LocalOriginConnectFailed, upstream_request,
                          absl::nullopt);
+  updateLoadBalancerResponseTime(upstream_request);
 
   if (maybeRetryReset(reset_reason, upstream_request)) {
     return;
@@ -1364,6 +1400,8 @@ void Filter::onUpstreamComplete(UpstreamRequest& upstream_request) {
         FilterUtility::percentageOfTimeout(response_time, timeout_.global_timeout_));
   }
 
+  updateLoadBalancerResponseTime(upstream_request);
+
   if (config_.emit_dynamic_stats_ && !callbacks_->streamInfo().healthCheck() &&
       DateUtil::timePointValid(downstream_request_complete_time_)) {
     upstream_request.upstreamHost()->outlierDetector().putResponseTime(response_time);
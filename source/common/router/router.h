@@ -512,6 +512,9 @@ private:
                                                 const Http::HeaderEntry& internal_redirect);
   void updateOutlierDetection(Upstream::Outlier::Result result, UpstreamRequest& upstream_request,
                               absl::optional<uint64_t> code);
+  // Tells a latency aware load balancer how long the host of upstream_request took to respond, or
+  // to fail to, up to now.
+  void updateLoadBalancerResponseTime(UpstreamRequest& upstream_request);
   void doRetry();
   // Called immediately after a non-5xx header is received from upstream, performs stats accounting
   // and handle difference between gRPC and non-gRPC requests.
@@ -91,6 +91,24 @@ public:
   }
   uint32_t use_count() const override { return ref_count_; }
 
+  /**
+   * Marks the stat as written since the last flush of changed stats. The flag is only stored when
+   * it isn't already set, so stats written many times per flush interval don't keep writing it.
+   */
+  void markChanged() {
+    if (!(flags_.load(std::memory_order_relaxed) & Metric::Flags::Changed)) {
+      flags_ |= Metric::Flags::Changed;
+    }
+  }
+
+  /**
+   * @return whether the stat was written since the previous call, clearing the mark.
+   */
+  bool latchChanged() {
+    return flags_.fetch_and(static_cast<uint16_t>(~Metric::Flags::Changed)) &
+           Metric::Flags::Changed;
+  }
+
   /**
    * We must atomically remove the counter/gauges from the allocator's sets when
    * our ref-count decrement hits zero. The counters and gauges are held in
@@ -144,10 +162,42 @@ private:
   std::atomic<uint64_t> pending_increment_{0};
 };
 
-class GaugeImpl : public StatsSharedImpl<Gauge> {
+// Counter whose value is placed in a SharedMemoryStatsRegion, for export to other processes.
+class SharedMemoryCounterImpl : public StatsSharedImpl<Counter> {
 public:
-  GaugeImpl(StatName name, AllocatorImpl& alloc, StatName tag_extracted_name,
-            const StatNameTagVector& stat_name_tags, ImportMode import_mode)
+  SharedMemoryCounterImpl(StatName name, AllocatorImpl& alloc, StatName tag_extracted_name,
+                          const StatNameTagVector& stat_name_tags, uint32_t slot)
+      : StatsSharedImpl(name, alloc, tag_extracted_name, stat_name_tags), slot_(slot),
+        value_(alloc.shared_memory_region_->value(slot)) {}
+  ~SharedMemoryCounterImpl() override { alloc_.shared_memory_region_->free(slot_); }
+
+  void removeFromSetLockHeld() ABSL_EXCLUSIVE_LOCKS_REQUIRED(alloc_.mutex_) override {
+    const size_t count = alloc_.counters_.erase(statName());
+    ASSERT(count == 1);
+  }
+
+  // Stats::Counter
+  void add(uint64_t amount) override {
+    value_ += amount;
+    pending_increment_ += amount;
+    flags_ |= Flags::Used;
+  }
+  void inc() override { add(1); }
+  uint64_t latch() override { return pending_increment_.exchange(0); }
+  void reset() override { value_ = 0; }
+  uint64_t value() const override { return value_; }
+
+private:
+  const uint32_t slot_;
+  std::atomic<uint64_t>& value_;
+  std::atomic<uint64_t> pending_increment_{0};
+};
+
+// The import mode handling shared by gauges, whichever way they store their value.
+class GaugeImplBase : public StatsSharedImpl<Gauge> {
+public:
+  GaugeImplBase(StatName name, AllocatorImpl& alloc, StatName tag_extracted_name,
+                const StatNameTagVector& stat_name_tags, ImportMode import_mode)
       : StatsSharedImpl(name, alloc, tag_extracted_name, stat_name_tags) {
     switch (import_mode) {
     case ImportMode::Accumulate:
@@ -171,23 +221,6 @@ public:
   }
 
   // Stats::Gauge
-  void add(uint64_t amount) override {
-    child_value_ += amount;
-    flags_ |= Flags::Used;
-  }
-  void dec() override { sub(1); }
-  void inc() override { add(1); }
-  void set(uint64_t value) override {
-    child_value_ = value;
-    flags_ |= Flags::Used;
-  }
-  void sub(uint64_t amount) override {
-    ASSERT(child_value_ >= amount);
-    ASSERT(used() || amount == 0);
-    child_value_ -= amount;
-  }
-  uint64_t value() const override { return child_value_ + parent_value_; }
-
   ImportMode importMode() const override {
     if (flags_ & Flags::NeverImport) {
       return ImportMode::NeverImport;
@@ -210,27 +243,100 @@ public:
       break;
     case ImportMode::Accumulate:
       ASSERT(current == ImportMode::Uninitialized);
-      flags_ |= Flags::LogicAccumulate;
+      // The gauge is now flushed, so report its value even if it was written before this.
+      flags_ |= Flags::LogicAccumulate | Flags::Changed;
       break;
     case ImportMode::NeverImport:
       ASSERT(current == ImportMode::Uninitialized);
       // A previous revision of Envoy may have transferred a gauge that it
       // thought was Accumulate. But the new version thinks it's NeverImport, so
       // we clear the accumulated value.
-      parent_value_ = 0;
+      setParentValue(0);
       flags_ &= ~Flags::Used;
-      flags_ |= Flags::NeverImport;
+      flags_ |= Flags::NeverImport | Flags::Changed;
       break;
     }
   }
+};
 
-  void setParentValue(uint64_t value) override { parent_value_ = value; }
+class GaugeImpl : public GaugeImplBase {
+public:
+  GaugeImpl(StatName name, AllocatorImpl& alloc, StatName tag_extracted_name,
+            const StatNameTagVector& stat_name_tags, ImportMode import_mode)
+      : GaugeImplBase(name, alloc, tag_extracted_name, stat_name_tags, import_mode) {}
+
+  // Stats::Gauge
+  void add(uint64_t amount) override {
+    child_value_ += amount;
+    flags_ |= Flags::Used | Flags::Changed;
+  }
+  void dec() override { sub(1); }
+  void inc() override { add(1); }
+  void set(uint64_t value) override {
+    child_value_ = value;
+    flags_ |= Flags::Used | Flags::Changed;
+  }
+  void sub(uint64_t amount) override {
+    ASSERT(child_value_ >= amount);
+    ASSERT(used() || amount == 0);
+    child_value_ -= amount;
+    markChanged();
+  }
+  uint64_t value() const override { return child_value_ + parent_value_; }
+
+  void setParentValue(uint64_t value) override {
+    parent_value_ = value;
+    markChanged();
+  }
 
 private:
   std::atomic<uint64_t> parent_value_{0};
   std::atomic<uint64_t> child_value_{0};
 };
 
+// Gauge whose value is placed in a SharedMemoryStatsRegion, for export to other processes. The
+// region holds the sum of the values of this process and of the hot restart parent, so that
+// readers see the same value as value().
+class SharedMemoryGaugeImpl : public GaugeImplBase {
+public:
+  SharedMemoryGaugeImpl(StatName name, AllocatorImpl& alloc, StatName tag_extracted_name,
+                        const StatNameTagVector& stat_name_tags, ImportMode import_mode,
+                        uint32_t slot)
+      : GaugeImplBase(name, alloc, tag_extracted_name, stat_name_tags, import_mode), slot_(slot),
+        value_(alloc.shared_memory_region_->value(slot)) {}
+  ~SharedMemoryGaugeImpl() override { alloc_.shared_memory_region_->free(slot_); }
+
+  // Stats::Gauge
+  void add(uint64_t amount) override {
+    value_ += amount;
+    flags_ |= Flags::Used | Flags::Changed;
+  }
+  void dec() override { sub(1); }
+  void inc() override { add(1); }
+  void set(uint64_t value) override {
+    value_ = value + parent_value_;
+    flags_ |= Flags::Used | Flags::Changed;
+  }
+  void sub(uint64_t amount) override {
+    ASSERT(value_ - parent_value_ >= amount);
+    ASSERT(used() || amount == 0);
+    value_ -= amount;
+    markChanged();
+  }
+  uint64_t value() const override { return value_; }
+
+  void setParentValue(uint64_t value) override {
+    // Unsigned arithmetic wraps around, so this also lowers the value.
+    value_ += value - parent_value_.exchange(value);
+    markChanged();
+  }
+
+private:
+  const uint32_t slot_;
+  std::atomic<uint64_t>& value_;
+  std::atomic<uint64_t> parent_value_{0};
+};
+
 class TextReadoutImpl : public StatsSharedImpl<TextReadout> {
 public:
   TextReadoutImpl(StatName name, AllocatorImpl& alloc, StatName tag_extracted_name,
@@ -245,8 +351,11 @@ public:
   // Stats::TextReadout
   void set(absl::string_view value) override {
     std::string value_copy(value);
-    absl::MutexLock lock(&mutex_);
-    value_ = std::move(value_copy);
+    {
+      absl::MutexLock lock(&mutex_);
+      value_ = std::move(value_copy);
+    }
+    markChanged();
   }
   std::string value() const override {
     absl::MutexLock lock(&mutex_);
@@ -282,8 +391,16 @@ GaugeSharedPtr AllocatorImpl::makeGauge(StatName name, StatName tag_extracted_na
   if (iter != gauges_.end()) {
     return GaugeSharedPtr(*iter);
   }
-  auto gauge =
-      GaugeSharedPtr(new GaugeImpl(name, *this, tag_extracted_name, stat_name_tags, import_mode));
+  GaugeSharedPtr gauge;
+  const absl::optional<uint32_t> slot =
+      allocateSharedMemorySlot(name, SharedMemoryStatsEntry::Type::Gauge);
+  if (slot) {
+    gauge = GaugeSharedPtr(new SharedMemoryGaugeImpl(name, *this, tag_extracted_name,
+                                                     stat_name_tags, import_mode, *slot));
+  } else {
+    gauge =
+        GaugeSharedPtr(new GaugeImpl(name, *this, tag_extracted_name, stat_name_tags, import_mode));
+  }
   gauges_.insert(gauge.get());
   return gauge;
 }
@@ -303,6 +420,33 @@ TextReadoutSharedPtr AllocatorImpl::makeTextReadout(StatName name, StatName tag_
   return text_readout;
 }
 
+void AllocatorImpl::forEachChangedStat(
+    const std::function<void(Counter&, uint64_t)>& counter_fn,
+    const std::function<void(Gauge&)>& gauge_fn,
+    const std::function<void(TextReadout&)>& text_readout_fn) {
+  Thread::LockGuard lock(mutex_);
+  // Every counter is latched, even if unchanged, as the hot restart code relies on the periodic
+  // flush latching all counters.
+  for (Counter* counter : counters_) {
+    const uint64_t delta = counter->latch();
+    if (delta != 0) {
+      counter_fn(*counter, delta);
+    }
+  }
+  // Gauges and text readouts are only ever created by this allocator, so the casts are safe.
+  for (Gauge* gauge : gauges_) {
+    if (static_cast<GaugeImplBase*>(gauge)->latchChanged() &&
+        gauge->importMode() != Gauge::ImportMode::Uninitialized) {
+      gauge_fn(*gauge);
+    }
+  }
+  for (TextReadout* text_readout : text_readouts_) {
+    if (static_cast<TextReadoutImpl*>(text_readout)->latchChanged()) {
+      text_readout_fn(*text_readout);
+    }
+  }
+}
+
 bool AllocatorImpl::isMutexLockedForTest() {
   bool locked = mutex_.tryLock();
   if (locked) {
@@ -311,8 +455,21 @@ bool AllocatorImpl::isMutexLockedForTest() {
   return !locked;
 }
 
+absl::optional<uint32_t>
+AllocatorImpl::allocateSharedMemorySlot(StatName name, SharedMemoryStatsEntry::Type type) {
+  if (shared_memory_region_ == nullptr) {
+    return absl::nullopt;
+  }
+  return shared_memory_region_->allocate(symbol_table_.toString(name), type);
+}
+
 Counter* AllocatorImpl::makeCounterInternal(StatName name, StatName tag_extracted_name,
                                             const StatNameTagVector& stat_name_tags) {
+  const absl::optional<uint32_t> slot =
+      allocateSharedMemorySlot(name, SharedMemoryStatsEntry::Type::Counter);
+  if (slot) {
+    return new SharedMemoryCounterImpl(name, *this, tag_extracted_name, stat_name_tags, *slot);
+  }
   return new CounterImpl(name, *this, tag_extracted_name, stat_name_tags);
 }
 
@@ -8,9 +8,11 @@
 
 #include "common/common/thread_synchronizer.h"
 #include "common/stats/metric_impl.h"
+#include "common/stats/shared_memory_stats.h"
 
 #include "absl/container/flat_hash_set.h"
 #include "absl/strings/string_view.h"
+#include "absl/types/optional.h"
 
 namespace Envoy {
 namespace Stats {
@@ -20,6 +22,14 @@ public:
   static const char DecrementToZeroSyncPoint[];
 
   AllocatorImpl(SymbolTable& symbol_table) : symbol_table_(symbol_table) {}
+
+  /**
+   * @param symbol_table the symbol table of the stats.
+   * @param shared_memory_region if not null, the region in which the values of counters and
+   *        gauges are placed while it has room for them. It must outlive the allocator.
+   */
+  AllocatorImpl(SymbolTable& symbol_table, SharedMemoryStatsRegion* shared_memory_region)
+      : symbol_table_(symbol_table), shared_memory_region_(shared_memory_region) {}
   ~AllocatorImpl() override;
 
   // Allocator
@@ -32,6 +42,9 @@ public:
                                        const StatNameTagVector& stat_name_tags) override;
   SymbolTable& symbolTable() override { return symbol_table_; }
   const SymbolTable& constSymbolTable() const override { return symbol_table_; }
+  void forEachChangedStat(const std::function<void(Counter&, uint64_t)>& counter_fn,
+                          const std::function<void(Gauge&)>& gauge_fn,
+                          const std::function<void(TextReadout&)>& text_readout_fn) override;
 
 #ifndef ENVOY_CONFIG_COVERAGE
   void debugPrint();
@@ -54,10 +67,17 @@ protected:
 private:
   template <class BaseClass> friend class StatsSharedImpl;
   friend class CounterImpl;
-  friend class GaugeImpl;
+  friend class GaugeImplBase;
+  friend class SharedMemoryCounterImpl;
+  friend class SharedMemoryGaugeImpl;
   friend class TextReadoutImpl;
   friend class NotifyingAllocatorImpl;
 
+  // Claims a slot of the shared memory region for a stat, if there is a region with room for it.
+  // Called with mutex_ held.
+  absl::optional<uint32_t> allocateSharedMemorySlot(StatName name,
+                                                    SharedMemoryStatsEntry::Type type);
+
   void removeCounterFromSetLockHeld(Counter* counter) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
   void removeGaugeFromSetLockHeld(Gauge* gauge) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
   void removeTextReadoutFromSetLockHeld(Counter* counter) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
@@ -67,6 +87,7 @@ private:
   StatSet<TextReadout> text_readouts_ ABSL_GUARDED_BY(mutex_);
 
   SymbolTable& symbol_table_;
+  SharedMemoryStatsRegion* const shared_memory_region_{};
 
   // A mutex is needed here to protect both the stats_ object from both
   // alloc() and free() operations. Although alloc() operations are called under existing locking,
@@ -34,6 +34,12 @@ HistogramStatisticsImpl::HistogramStatisticsImpl(const histogram_t* histogram_pt
   }
 }
 
+HistogramStatisticsImpl::HistogramStatisticsImpl(const LogLinearHistogram& histogram,
+                                                 ConstSupportedBuckets& supported_buckets)
+    : supported_buckets_(supported_buckets) {
+  refresh(histogram);
+}
+
 const std::vector<double>& HistogramStatisticsImpl::supportedQuantiles() const {
   CONSTRUCT_ON_FIRST_USE(std::vector<double>,
                          {0, 0.25, 0.5, 0.75, 0.90, 0.95, 0.99, 0.995, 0.999, 1});
@@ -81,6 +87,23 @@ void HistogramStatisticsImpl::refresh(const histogram_t* new_histogram_ptr) {
   }
 }
 
+/**
+ * Clears the old computed values and refreshes it with values computed from passed histogram.
+ */
+void HistogramStatisticsImpl::refresh(const LogLinearHistogram& new_histogram) {
+  new_histogram.computeQuantiles(supportedQuantiles(), computed_quantiles_);
+
+  sample_count_ = new_histogram.sampleCount();
+  sample_sum_ = new_histogram.sampleSum();
+
+  computed_buckets_.clear();
+  ConstSupportedBuckets& supported_buckets = supportedBuckets();
+  computed_buckets_.reserve(supported_buckets.size());
+  for (const auto bucket : supported_buckets) {
+    computed_buckets_.emplace_back(new_histogram.approxCountBelow(bucket));
+  }
+}
+
 HistogramSettingsImpl::HistogramSettingsImpl(const envoy::config::metrics::v3::StatsConfig& config)
     : configs_([&config]() {
         std::vector<Config> configs;
@@ -91,7 +114,10 @@ HistogramSettingsImpl::HistogramSettingsImpl(const envoy::config::metrics::v3::S
         }
 
         return configs;
-      }()) {}
+      }()),
+      engine_(config.histogram_engine() == envoy::config::metrics::v3::StatsConfig::LOG_LINEAR
+                  ? Engine::LogLinear
+                  : Engine::Circllhist) {}
 
 const ConstSupportedBuckets& HistogramSettingsImpl::buckets(absl::string_view stat_name) const {
   for (const auto& config : configs_) {
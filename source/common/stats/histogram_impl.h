@@ -10,6 +10,7 @@
 
 #include "common/common/matchers.h"
 #include "common/common/non_copyable.h"
+#include "common/stats/log_linear_histogram.h"
 #include "common/stats/metric_impl.h"
 
 #include "circllhist.h"
@@ -24,16 +25,18 @@ public:
 
   // HistogramSettings
   const ConstSupportedBuckets& buckets(absl::string_view stat_name) const override;
+  Engine engine() const override { return engine_; }
 
   static ConstSupportedBuckets& defaultBuckets();
 
 private:
   using Config = std::pair<Matchers::StringMatcherImpl, ConstSupportedBuckets>;
   const std::vector<Config> configs_{};
+  const Engine engine_{Engine::Circllhist};
 };
 
 /**
- * Implementation of HistogramStatistics for circllhist.
+ * Implementation of HistogramStatistics for circllhist and log-linear histograms.
  */
 class HistogramStatisticsImpl : public HistogramStatistics, NonCopyable {
 public:
@@ -48,9 +51,17 @@ public:
       const histogram_t* histogram_ptr,
       ConstSupportedBuckets& supported_buckets = HistogramSettingsImpl::defaultBuckets());
 
+  /**
+   * HistogramStatisticsImpl object is constructed using the passed in log-linear histogram, which
+   * will not be retained.
+   */
+  HistogramStatisticsImpl(const LogLinearHistogram& histogram,
+                          ConstSupportedBuckets& supported_buckets);
+
   static ConstSupportedBuckets& defaultSupportedBuckets();
 
   void refresh(const histogram_t* new_histogram_ptr);
+  void refresh(const LogLinearHistogram& new_histogram);
 
   // HistogramStatistics
   std::string quantileSummary() const override;
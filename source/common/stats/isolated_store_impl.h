@@ -186,6 +186,13 @@ public:
   std::vector<TextReadoutSharedPtr> textReadouts() const override {
     return text_readouts_.toVector();
   }
+  void forEachChangedStat(const std::function<void(Counter&, uint64_t)>& counter_fn,
+                          const std::function<void(Gauge&)>& gauge_fn,
+                          const std::function<void(TextReadout&)>& text_readout_fn) override {
+    alloc_.forEachChangedStat(counter_fn, gauge_fn, text_readout_fn);
+  }
+  void setCacheProfiling(TimeSource*) override {}
+  CacheProfile cacheProfile() const override { return CacheProfile{}; }
 
   Counter& counterFromString(const std::string& name) override {
     StatNameManagedStorage storage(name, symbolTable());
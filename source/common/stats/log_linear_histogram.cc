@@ -0,0 +1,190 @@
+#include "common/stats/log_linear_histogram.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "common/common/assert.h"
+
+namespace Envoy {
+namespace Stats {
+
+LogLinearHistogram::~LogLinearHistogram() {
+  for (std::atomic<Page*>& page : pages_) {
+    delete page.load(std::memory_order_relaxed);
+  }
+}
+
+uint32_t LogLinearHistogram::pageIndex(uint64_t value) {
+  if (value < SubBuckets) {
+    return 0;
+  }
+  return 64 - __builtin_clzll(value) - SubBucketBits;
+}
+
+uint32_t LogLinearHistogram::subBucketIndex(uint64_t value, uint32_t page_index) {
+  if (page_index == 0) {
+    return value;
+  }
+  // The top bit of the value selects the page, and the next SubBucketBits bits the bucket in it.
+  return (value >> (page_index - 1)) - SubBuckets;
+}
+
+uint64_t LogLinearHistogram::lowerBound(uint32_t page_index, uint32_t sub_bucket_index) {
+  if (page_index == 0) {
+    return sub_bucket_index;
+  }
+  return (uint64_t(SubBuckets) + sub_bucket_index) << (page_index - 1);
+}
+
+uint64_t LogLinearHistogram::bucketLowerBound(uint64_t value) {
+  const uint32_t page_index = pageIndex(value);
+  return lowerBound(page_index, subBucketIndex(value, page_index));
+}
+
+uint64_t LogLinearHistogram::bucketWidth(uint64_t value) { return width(pageIndex(value)); }
+
+LogLinearHistogram::Page& LogLinearHistogram::getOrCreatePage(uint32_t page_index) {
+  ASSERT(page_index < NumPages);
+  Page* page = pages_[page_index].load(std::memory_order_relaxed);
+  if (page == nullptr) {
+    page = new Page();
+    pages_[page_index].store(page, std::memory_order_release);
+  }
+  return *page;
+}
+
+void LogLinearHistogram::recordValue(uint64_t value) {
+  const uint32_t page_index = pageIndex(value);
+  getOrCreatePage(page_index)
+      .counts_[subBucketIndex(value, page_index)]
+      .fetch_add(1, std::memory_order_relaxed);
+  sample_sum_.fetch_add(value, std::memory_order_relaxed);
+}
+
+void LogLinearHistogram::moveTo(LogLinearHistogram& target) {
+  for (uint32_t i = 0; i < NumPages; ++i) {
+    Page* page = pages_[i].load(std::memory_order_acquire);
+    if (page == nullptr) {
+      continue;
+    }
+    for (uint32_t j = 0; j < SubBuckets; ++j) {
+      // Exchanging rather than loading and clearing ensures that a concurrently recorded value is
+      // either moved now or left for the next call.
+      const uint64_t count = page->counts_[j].exchange(0, std::memory_order_relaxed);
+      if (count != 0) {
+        target.getOrCreatePage(i).counts_[j].fetch_add(count, std::memory_order_relaxed);
+      }
+    }
+  }
+  target.sample_sum_.fetch_add(sample_sum_.exchange(0, std::memory_order_relaxed),
+                               std::memory_order_relaxed);
+}
+
+void LogLinearHistogram::add(const LogLinearHistogram& other) {
+  for (uint32_t i = 0; i < NumPages; ++i) {
+    const Page* page = other.pages_[i].load(std::memory_order_acquire);
+    if (page == nullptr) {
+      continue;
+    }
+    for (uint32_t j = 0; j < SubBuckets; ++j) {
+      const uint64_t count = page->counts_[j].load(std::memory_order_relaxed);
+      if (count != 0) {
+        getOrCreatePage(i).counts_[j].fetch_add(count, std::memory_order_relaxed);
+      }
+    }
+  }
+  sample_sum_.fetch_add(other.sampleSum(), std::memory_order_relaxed);
+}
+
+void LogLinearHistogram::clear() {
+  for (std::atomic<Page*>& page_ptr : pages_) {
+    Page* page = page_ptr.load(std::memory_order_relaxed);
+    if (page != nullptr) {
+      for (std::atomic<uint64_t>& count : page->counts_) {
+        count.store(0, std::memory_order_relaxed);
+      }
+    }
+  }
+  sample_sum_.store(0, std::memory_order_relaxed);
+}
+
+uint64_t LogLinearHistogram::sampleCount() const {
+  uint64_t sample_count = 0;
+  for (const std::atomic<Page*>& page_ptr : pages_) {
+    const Page* page = page_ptr.load(std::memory_order_acquire);
+    if (page != nullptr) {
+      for (const std::atomic<uint64_t>& count : page->counts_) {
+        sample_count += count.load(std::memory_order_relaxed);
+      }
+    }
+  }
+  return sample_count;
+}
+
+void LogLinearHistogram::computeQuantiles(const std::vector<double>& quantiles,
+                                          std::vector<double>& computed) const {
+  computed.assign(quantiles.size(), std::numeric_limits<double>::quiet_NaN());
+  const uint64_t sample_count = sampleCount();
+  if (sample_count == 0) {
+    return;
+  }
+
+  size_t next = 0;
+  uint64_t below = 0;
+  double upper_bound = 0;
+  for (uint32_t i = 0; i < NumPages && next < quantiles.size(); ++i) {
+    const Page* page = pages_[i].load(std::memory_order_acquire);
+    if (page == nullptr) {
+      continue;
+    }
+    for (uint32_t j = 0; j < SubBuckets && next < quantiles.size(); ++j) {
+      const uint64_t count = page->counts_[j].load(std::memory_order_relaxed);
+      if (count == 0) {
+        continue;
+      }
+      const double lower_bound = lowerBound(i, j);
+      for (; next < quantiles.size() && quantiles[next] * sample_count <= below + count; ++next) {
+        const double fraction = std::max(0.0, (quantiles[next] * sample_count - below) / count);
+        computed[next] = lower_bound + fraction * width(i);
+      }
+      below += count;
+      upper_bound = lower_bound + width(i);
+    }
+  }
+  // Quantiles which are past the last value due to rounding are at its upper bound.
+  for (; next < quantiles.size(); ++next) {
+    computed[next] = upper_bound;
+  }
+}
+
+uint64_t LogLinearHistogram::approxCountBelow(double value) const {
+  double count_below = 0;
+  for (uint32_t i = 0; i < NumPages; ++i) {
+    const Page* page = pages_[i].load(std::memory_order_acquire);
+    if (page == nullptr) {
+      continue;
+    }
+    for (uint32_t j = 0; j < SubBuckets; ++j) {
+      const double lower_bound = lowerBound(i, j);
+      if (lower_bound >= value) {
+        return count_below + 0.5;
+      }
+      const double fraction = std::min(1.0, (value - lower_bound) / width(i));
+      count_below += fraction * page->counts_[j].load(std::memory_order_relaxed);
+    }
+  }
+  return count_below + 0.5;
+}
+
+uint64_t LogLinearHistogram::allocatedBytes() const {
+  uint64_t bytes = 0;
+  for (const std::atomic<Page*>& page : pages_) {
+    if (page.load(std::memory_order_relaxed) != nullptr) {
+      bytes += sizeof(Page);
+    }
+  }
+  return bytes;
+}
+
+} // namespace Stats
+} // namespace Envoy
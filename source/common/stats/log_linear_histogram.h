@@ -0,0 +1,115 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include "common/common/non_copyable.h"
+
+namespace Envoy {
+namespace Stats {
+
+/**
+ * A sparse log-linear histogram of integer values. Values below 16 are counted exactly, and each
+ * power of two above that is split into 16 equal buckets, bounding the error of any value to
+ * 1/16 of it. The 16 buckets of each power of two form a page, which is allocated the first time
+ * a value falls in it, so a histogram only takes memory for the range of values it actually sees.
+ *
+ * One thread records values while any other thread may concurrently move the counts out with
+ * moveTo(), which is lock free and costs O(buckets in the allocated pages). All the other methods
+ * require that the histogram is not being modified.
+ */
+class LogLinearHistogram : NonCopyable {
+public:
+  LogLinearHistogram() = default;
+  ~LogLinearHistogram();
+
+  /**
+   * Records a value. Only one thread may record values into a histogram.
+   */
+  void recordValue(uint64_t value);
+
+  /**
+   * Adds the counts of this histogram into target and clears them from this histogram. Values
+   * recorded concurrently are either moved or left for the next call, but never lost.
+   */
+  void moveTo(LogLinearHistogram& target);
+
+  /**
+   * Adds the counts of other into this histogram.
+   */
+  void add(const LogLinearHistogram& other);
+
+  /**
+   * Clears all counts, keeping the allocated pages.
+   */
+  void clear();
+
+  /**
+   * @return the number of recorded values.
+   */
+  uint64_t sampleCount() const;
+
+  /**
+   * @return the exact sum of the recorded values.
+   */
+  uint64_t sampleSum() const { return sample_sum_.load(std::memory_order_relaxed); }
+
+  /**
+   * Computes quantiles, interpolating linearly within buckets. Quantile 0 is the lower bound of the
+   * lowest bucket and quantile 1 the upper bound of the highest bucket with values.
+   * @param quantiles the quantiles to compute, in ascending order.
+   * @param computed receives the value of each quantile, or NaN for each if there are no values.
+   */
+  void computeQuantiles(const std::vector<double>& quantiles, std::vector<double>& computed) const;
+
+  /**
+   * @return the approximate number of recorded values below value, interpolating linearly within
+   *         the bucket containing value.
+   */
+  uint64_t approxCountBelow(double value) const;
+
+  /**
+   * @return the number of bytes allocated for pages.
+   */
+  uint64_t allocatedBytes() const;
+
+  static constexpr uint32_t SubBucketBits = 4;
+  static constexpr uint32_t SubBuckets = 1 << SubBucketBits;
+  // Page 0 counts the values below SubBuckets exactly, and page i > 0 counts the values in
+  // [2^(i+SubBucketBits-1), 2^(i+SubBucketBits)).
+  static constexpr uint32_t NumPages = 64 - SubBucketBits + 1;
+
+  /**
+   * @return the lower bound of the bucket counting value.
+   */
+  static uint64_t bucketLowerBound(uint64_t value);
+
+  /**
+   * @return the width of the bucket counting value.
+   */
+  static uint64_t bucketWidth(uint64_t value);
+
+private:
+  struct Page {
+    std::atomic<uint64_t> counts_[SubBuckets]{};
+  };
+
+  static uint32_t pageIndex(uint64_t value);
+  static uint32_t subBucketIndex(uint64_t value, uint32_t page_index);
+  static uint64_t lowerBound(uint32_t page_index, uint32_t sub_bucket_index);
+  static uint64_t width(uint32_t page_index) {
+    return page_index == 0 ? 1 : uint64_t(1) << (page_index - 1);
+  }
+
+  // Returns the page, allocating it if needed. Must only be called by the recording thread.
+  Page& getOrCreatePage(uint32_t page_index);
+
+  // Pages are published with release stores so that moveTo() on another thread sees them
+  // initialized. They are only freed by the destructor.
+  std::atomic<Page*> pages_[NumPages]{};
+  std::atomic<uint64_t> sample_sum_{0};
+};
+
+} // namespace Stats
+} // namespace Envoy
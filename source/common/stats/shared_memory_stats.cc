@@ -0,0 +1,251 @@
+#include "common/stats/shared_memory_stats.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "envoy/common/exception.h"
+#include "envoy/common/platform.h"
+
+#include "common/common/assert.h"
+#include "common/common/fmt.h"
+#include "common/common/lock_guard.h"
+#include "common/common/utility.h"
+
+#include "absl/strings/str_cat.h"
+
+namespace Envoy {
+namespace Stats {
+
+namespace {
+
+// The name table starts on its own cache line.
+constexpr uint32_t EntriesOffset = 64;
+static_assert(sizeof(SharedMemoryStatsHeader) <= EntriesOffset, "header overlaps the name table");
+static_assert(sizeof(SharedMemoryStatsEntry) == 256, "entries are not 256 bytes");
+
+#ifdef WIN32
+void* createMapping(const std::string&, uint64_t, uint64_t&) {
+  throw EnvoyException("shared memory stats are not supported on Windows");
+}
+void publishFile(const std::string&, const std::string&) {}
+void removeFileIfSame(const std::string&, uint64_t) {}
+void* openMapping(const std::string&, uint64_t&) {
+  throw EnvoyException("shared memory stats are not supported on Windows");
+}
+void removeMapping(void*, uint64_t) {}
+uint64_t currentPid() { return 0; }
+#else
+void throwError(absl::string_view operation, const std::string& path, int error) {
+  throw EnvoyException(
+      fmt::format("unable to {} shared memory stats file {}: {}", operation, path,
+                  errorDetails(error)));
+}
+
+// Maps the file at path after closing fd, which is open on it.
+void* mapAndClose(int fd, const std::string& path, uint64_t size, int prot) {
+  void* memory = ::mmap(nullptr, size, prot, MAP_SHARED, fd, 0);
+  const int error = errno;
+  ::close(fd);
+  if (memory == MAP_FAILED) {
+    throwError("map", path, error);
+  }
+  return memory;
+}
+
+// Creates a new file at path, which must not be visible to readers yet, and maps it. The inode of
+// the file is returned in inode.
+void* createMapping(const std::string& path, uint64_t size, uint64_t& inode) {
+  // A file left at this path by a crashed process with the same pid is never mapped by anyone.
+  ::unlink(path.c_str());
+  // Readers may be run as another user, so the file is readable by all.
+  const int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+  if (fd == -1) {
+    throwError("create", path, errno);
+  }
+  struct stat stat_buf;
+  if (::fstat(fd, &stat_buf) != 0 || ::ftruncate(fd, size) != 0) {
+    const int error = errno;
+    ::close(fd);
+    ::unlink(path.c_str());
+    throwError("size", path, error);
+  }
+  inode = stat_buf.st_ino;
+  return mapAndClose(fd, path, size, PROT_READ | PROT_WRITE);
+}
+
+// Atomically replaces the file at path, if any, with the one at tmp_path. A process still mapping
+// the replaced file, such as the parent of a hot restart, keeps updating it unaffected.
+void publishFile(const std::string& tmp_path, const std::string& path) {
+  if (::rename(tmp_path.c_str(), path.c_str()) != 0) {
+    const int error = errno;
+    ::unlink(tmp_path.c_str());
+    throwError("rename", path, error);
+  }
+}
+
+// Removes the file at path only if it is still the one with the given inode, and not one which
+// has since replaced it.
+void removeFileIfSame(const std::string& path, uint64_t inode) {
+  struct stat stat_buf;
+  if (::stat(path.c_str(), &stat_buf) == 0 && static_cast<uint64_t>(stat_buf.st_ino) == inode) {
+    ::unlink(path.c_str());
+  }
+}
+
+void* openMapping(const std::string& path, uint64_t& size) {
+  const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd == -1) {
+    throwError("open", path, errno);
+  }
+  struct stat stat_buf;
+  if (::fstat(fd, &stat_buf) != 0) {
+    const int error = errno;
+    ::close(fd);
+    throwError("stat", path, error);
+  }
+  size = stat_buf.st_size;
+  if (size < sizeof(SharedMemoryStatsHeader)) {
+    ::close(fd);
+    throw EnvoyException(fmt::format("{} is not a shared memory stats file", path));
+  }
+  return mapAndClose(fd, path, size, PROT_READ);
+}
+
+void removeMapping(void* memory, uint64_t size) { ::munmap(memory, size); }
+
+uint64_t currentPid() { return ::getpid(); }
+#endif
+
+} // namespace
+
+uint64_t SharedMemoryStatsRegion::fileSize(uint32_t max_stats) {
+  return EntriesOffset + uint64_t(max_stats) * (sizeof(SharedMemoryStatsEntry) + sizeof(uint64_t));
+}
+
+SharedMemoryStatsRegion::SharedMemoryStatsRegion(const std::string& path, uint32_t max_stats)
+    : path_(path), size_(fileSize(max_stats)),
+      memory_(createMapping(tmpPath(path), size_, inode_)),
+      header_(static_cast<SharedMemoryStatsHeader*>(memory_)),
+      entries_(reinterpret_cast<SharedMemoryStatsEntry*>(static_cast<char*>(memory_) +
+                                                         EntriesOffset)),
+      values_(reinterpret_cast<std::atomic<uint64_t>*>(entries_ + max_stats)) {
+  // The file was just created, so everything else is zero.
+  header_->version_ = SharedMemoryStatsHeader::Version;
+  header_->max_stats_ = max_stats;
+  header_->entry_size_ = sizeof(SharedMemoryStatsEntry);
+  header_->entries_offset_ = EntriesOffset;
+  header_->values_offset_ = reinterpret_cast<char*>(values_) - static_cast<char*>(memory_);
+  header_->pid_ = currentPid();
+  header_->magic_.store(SharedMemoryStatsHeader::Magic, std::memory_order_release);
+  try {
+    publishFile(tmpPath(path), path_);
+  } catch (const EnvoyException&) {
+    removeMapping(memory_, size_);
+    throw;
+  }
+}
+
+SharedMemoryStatsRegion::~SharedMemoryStatsRegion() {
+  removeMapping(memory_, size_);
+  removeFileIfSame(path_, inode_);
+}
+
+std::string SharedMemoryStatsRegion::tmpPath(const std::string& path) {
+  return absl::StrCat(path, ".tmp.", currentPid());
+}
+
+absl::optional<uint32_t> SharedMemoryStatsRegion::allocate(absl::string_view name,
+                                                           SharedMemoryStatsEntry::Type type) {
+  ASSERT(type != SharedMemoryStatsEntry::Type::Free);
+  Thread::LockGuard lock(mutex_);
+  const uint32_t num_slots = header_->num_slots_.load(std::memory_order_relaxed);
+  if (name.size() > SharedMemoryStatsEntry::MaxNameLength ||
+      (free_slots_.empty() && num_slots == header_->max_stats_)) {
+    header_->num_overflowed_.fetch_add(1, std::memory_order_relaxed);
+    return absl::nullopt;
+  }
+
+  uint32_t slot = num_slots;
+  if (!free_slots_.empty()) {
+    slot = free_slots_.back();
+    free_slots_.pop_back();
+  }
+  writeEntry(slot, name, type);
+  if (slot == num_slots) {
+    header_->num_slots_.store(num_slots + 1, std::memory_order_release);
+  }
+  return slot;
+}
+
+void SharedMemoryStatsRegion::free(uint32_t slot) {
+  Thread::LockGuard lock(mutex_);
+  writeEntry(slot, "", SharedMemoryStatsEntry::Type::Free);
+  free_slots_.push_back(slot);
+}
+
+void SharedMemoryStatsRegion::writeEntry(uint32_t slot, absl::string_view name,
+                                         SharedMemoryStatsEntry::Type type) {
+  SharedMemoryStatsEntry& entry = entries_[slot];
+  const uint32_t sequence = entry.sequence_.load(std::memory_order_relaxed);
+  entry.sequence_.store(sequence + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  entry.type_ = type;
+  entry.name_length_ = name.size();
+  memcpy(entry.name_, name.data(), name.size());
+  values_[slot].store(0, std::memory_order_relaxed);
+  entry.sequence_.store(sequence + 2, std::memory_order_release);
+}
+
+SharedMemoryStatsReader::SharedMemoryStatsReader(const std::string& path)
+    : memory_(openMapping(path, size_)),
+      header_(static_cast<const SharedMemoryStatsHeader*>(memory_)) {
+  const bool valid =
+      header_->magic_.load(std::memory_order_acquire) == SharedMemoryStatsHeader::Magic &&
+      header_->version_ == SharedMemoryStatsHeader::Version &&
+      header_->entry_size_ == sizeof(SharedMemoryStatsEntry) &&
+      header_->entries_offset_ >= sizeof(SharedMemoryStatsHeader) &&
+      header_->entries_offset_ + uint64_t(header_->max_stats_) * header_->entry_size_ <=
+          header_->values_offset_ &&
+      header_->values_offset_ % sizeof(uint64_t) == 0 &&
+      header_->values_offset_ + uint64_t(header_->max_stats_) * sizeof(uint64_t) <= size_;
+  if (!valid) {
+    removeMapping(memory_, size_);
+    throw EnvoyException(
+        fmt::format("{} is not a version {} shared memory stats file", path,
+                    SharedMemoryStatsHeader::Version));
+  }
+  entries_ = reinterpret_cast<const SharedMemoryStatsEntry*>(static_cast<const char*>(memory_) +
+                                                             header_->entries_offset_);
+  values_ = reinterpret_cast<const std::atomic<uint64_t>*>(static_cast<const char*>(memory_) +
+                                                           header_->values_offset_);
+}
+
+SharedMemoryStatsReader::~SharedMemoryStatsReader() { removeMapping(memory_, size_); }
+
+void SharedMemoryStatsReader::forEachStat(const StatFn& fn) const {
+  const uint32_t num_slots =
+      std::min(header_->num_slots_.load(std::memory_order_acquire), header_->max_stats_);
+  char name[SharedMemoryStatsEntry::MaxNameLength];
+  for (uint32_t slot = 0; slot < num_slots; ++slot) {
+    const SharedMemoryStatsEntry& entry = entries_[slot];
+    const uint32_t sequence = entry.sequence_.load(std::memory_order_acquire);
+    if (sequence & 1) {
+      continue;
+    }
+    const SharedMemoryStatsEntry::Type type = entry.type_;
+    const uint16_t name_length =
+        std::min<uint16_t>(entry.name_length_, SharedMemoryStatsEntry::MaxNameLength);
+    memcpy(name, entry.name_, name_length);
+    const uint64_t value = values_[slot].load(std::memory_order_relaxed);
+    // The entry was consistent if it was not rewritten while it was copied.
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (entry.sequence_.load(std::memory_order_relaxed) != sequence ||
+        type == SharedMemoryStatsEntry::Type::Free) {
+      continue;
+    }
+    fn(absl::string_view(name, name_length), type, value);
+  }
+}
+
+} // namespace Stats
+} // namespace Envoy
@@ -0,0 +1,177 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "common/common/non_copyable.h"
+#include "common/common/thread.h"
+#include "common/common/thread_annotations.h"
+
+#include "absl/strings/string_view.h"
+#include "absl/types/optional.h"
+
+namespace Envoy {
+namespace Stats {
+
+/**
+ * Header of a shared memory stats file. The file holds, in this order and in host byte order:
+ *
+ *   SharedMemoryStatsHeader, padded to entries_offset_ bytes.
+ *   max_stats_ SharedMemoryStatsEntry, the name table.
+ *   max_stats_ 64-bit values, at values_offset_, the value of each stat in the name table.
+ *
+ * The layout only changes along with Version, so external readers can sample the values of the
+ * stats of a running Envoy without any call into it.
+ */
+struct SharedMemoryStatsHeader {
+  // "ENVSTATS" on little endian machines.
+  static constexpr uint64_t Magic = 0x5354415453564e45;
+  static constexpr uint32_t Version = 1;
+
+  // Written last when the file is created, so readers don't see a partially initialized header.
+  std::atomic<uint64_t> magic_;
+  uint32_t version_;
+  uint32_t max_stats_;
+  uint32_t entry_size_;
+  uint32_t entries_offset_;
+  uint64_t values_offset_;
+  uint64_t pid_;
+  // One past the highest slot ever used, so readers only need to scan that many entries.
+  std::atomic<uint32_t> num_slots_;
+  // The number of stats which were not placed in the file as it was full or their name was longer
+  // than SharedMemoryStatsEntry::MaxNameLength.
+  std::atomic<uint32_t> num_overflowed_;
+};
+
+/**
+ * An entry of the name table of a shared memory stats file.
+ */
+struct SharedMemoryStatsEntry {
+  static constexpr uint32_t MaxNameLength = 248;
+
+  enum class Type : uint8_t { Free = 0, Counter = 1, Gauge = 2 };
+
+  // Odd while the entry is being written. A reader discards an entry if this was odd or changed
+  // while it read the entry, which makes entries that are reused for another stat safe to read.
+  std::atomic<uint32_t> sequence_;
+  Type type_;
+  uint8_t reserved_;
+  uint16_t name_length_;
+  char name_[MaxNameLength];
+};
+
+/**
+ * Memory-mapped file in which AllocatorImpl places the values of counters and gauges, so that they
+ * can be exported by another process. Slots are claimed as stats are created and reused after
+ * they are destroyed. Stats which don't fit are allocated on the heap and are not exported.
+ */
+class SharedMemoryStatsRegion : NonCopyable {
+public:
+  /**
+   * Creates the file and maps it. The file is fully written under a temporary name and then
+   * renamed to path, so an existing file at path, such as the one of the parent of a hot restart,
+   * is replaced without being truncated under the process which maps it.
+   * @param path the path of the file.
+   * @param max_stats the number of stats the file has room for.
+   * @throw EnvoyException if the file can't be created or mapped.
+   */
+  SharedMemoryStatsRegion(const std::string& path, uint32_t max_stats);
+
+  /**
+   * Unmaps the file and removes it, as its values are no longer updated, unless it was replaced by
+   * the file of another process.
+   */
+  ~SharedMemoryStatsRegion();
+
+  /**
+   * Claims a slot for a stat, with a value of 0.
+   * @param name the name of the stat.
+   * @param type the type of the stat.
+   * @return the slot, or absl::nullopt if the file is full or the name is too long.
+   */
+  absl::optional<uint32_t> allocate(absl::string_view name, SharedMemoryStatsEntry::Type type);
+
+  /**
+   * Releases a slot claimed by allocate() for reuse.
+   */
+  void free(uint32_t slot);
+
+  /**
+   * @return the value of the stat in a slot claimed by allocate().
+   */
+  std::atomic<uint64_t>& value(uint32_t slot) { return values_[slot]; }
+
+  /**
+   * @return the size of a file with room for max_stats stats.
+   */
+  static uint64_t fileSize(uint32_t max_stats);
+
+private:
+  // The name the file is created under before it is renamed to its path.
+  static std::string tmpPath(const std::string& path);
+
+  void writeEntry(uint32_t slot, absl::string_view name, SharedMemoryStatsEntry::Type type)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  const std::string path_;
+  const uint64_t size_;
+  // The inode of the file, which is only removed on destruction if it is still at path_.
+  uint64_t inode_{};
+  void* memory_;
+  SharedMemoryStatsHeader* header_;
+  SharedMemoryStatsEntry* entries_;
+  std::atomic<uint64_t>* values_;
+
+  Thread::MutexBasicLockable mutex_;
+  std::vector<uint32_t> free_slots_ ABSL_GUARDED_BY(mutex_);
+};
+
+using SharedMemoryStatsRegionPtr = std::unique_ptr<SharedMemoryStatsRegion>;
+
+/**
+ * Reads the stats of a file written by SharedMemoryStatsRegion, possibly in another process. The
+ * writer is never blocked by the reader.
+ */
+class SharedMemoryStatsReader : NonCopyable {
+public:
+  /**
+   * Maps the file read-only.
+   * @param path the path of the file.
+   * @throw EnvoyException if the file can't be mapped or isn't a stats file of this version.
+   */
+  explicit SharedMemoryStatsReader(const std::string& path);
+  ~SharedMemoryStatsReader();
+
+  using StatFn = std::function<void(absl::string_view name, SharedMemoryStatsEntry::Type type,
+                                    uint64_t value)>;
+
+  /**
+   * Calls fn for each stat in the file. Stats which are created or destroyed while they are read
+   * may be skipped.
+   */
+  void forEachStat(const StatFn& fn) const;
+
+  /**
+   * @return the process id of the writer.
+   */
+  uint64_t pid() const { return header_->pid_; }
+
+  /**
+   * @return the number of stats which the writer could not place in the file.
+   */
+  uint32_t numOverflowed() const { return header_->num_overflowed_.load(); }
+
+private:
+  uint64_t size_;
+  void* memory_;
+  const SharedMemoryStatsHeader* header_;
+  const SharedMemoryStatsEntry* entries_;
+  const std::atomic<uint64_t>* values_;
+};
+
+} // namespace Stats
+} // namespace Envoy
@@ -3,6 +3,7 @@
 #include <algorithm>
 #include <iostream>
 #include <memory>
+#include <tuple>
 #include <vector>
 
 #include "common/common/assert.h"
@@ -157,7 +158,7 @@ void SymbolTableImpl::Encoding::decodeTokens(
 std::vector<absl::string_view> SymbolTableImpl::decodeStrings(const SymbolTable::Storage array,
                                                               size_t size) const {
   std::vector<absl::string_view> strings;
-  Thread::LockGuard lock(lock_);
+  absl::ReaderMutexLock lock(&decode_lock_);
   Encoding::decodeTokens(
       array, size,
       [this, &strings](Symbol symbol)
@@ -202,24 +203,24 @@ void SymbolTableImpl::addTokensToEncoding(const absl::string_view name, Encoding
     return;
   }
 
-  // We want to hold the lock for the minimum amount of time, so we do the
-  // string-splitting and prepare a temp vector of Symbol first.
   const std::vector<absl::string_view> tokens = absl::StrSplit(name, '.');
   std::vector<Symbol> symbols;
   symbols.reserve(tokens.size());
 
-  // Now take the lock and populate the Symbol objects, which involves bumping
-  // ref-counts in this.
-  {
-    Thread::LockGuard lock(lock_);
+  lookup_count_.fetch_add(1, std::memory_order_relaxed);
+  if (remember_recent_lookups_.load(std::memory_order_relaxed)) {
+    absl::MutexLock lock(&recent_lookups_lock_);
     recent_lookups_.lookup(name);
-    for (auto& token : tokens) {
-      // TODO(jmarantz): consider using StatNameDynamicStorage for tokens with
-      // length below some threshold, say 4 bytes. It might be preferable not to
-      // reserve Symbols for every 3 digit number found (for example) in ipv4
-      // addresses.
-      symbols.push_back(toSymbol(token));
-    }
+  }
+
+  // Populate the Symbol objects, which involves bumping ref-counts in this. Each token only locks
+  // its own shard, and only shares the lock if the token already has a symbol.
+  for (auto& token : tokens) {
+    // TODO(jmarantz): consider using StatNameDynamicStorage for tokens with
+    // length below some threshold, say 4 bytes. It might be preferable not to
+    // reserve Symbols for every 3 digit number found (for example) in ipv4
+    // addresses.
+    symbols.push_back(toSymbol(token));
   }
 
   // Now efficiently encode the array of 32-bit symbols into a uint8_t array.
@@ -227,9 +228,12 @@ void SymbolTableImpl::addTokensToEncoding(const absl::string_view name, Encoding
 }
 
 uint64_t SymbolTableImpl::numSymbols() const {
-  Thread::LockGuard lock(lock_);
-  ASSERT(encode_map_.size() == decode_map_.size());
-  return encode_map_.size();
+  uint64_t num_symbols = 0;
+  for (const EncodeShard& encode_shard : shards_) {
+    absl::ReaderMutexLock lock(&encode_shard.lock_);
+    num_symbols += encode_shard.encode_map_.size();
+  }
+  return num_symbols;
 }
 
 std::string SymbolTableImpl::toString(const StatName& stat_name) const {
@@ -241,45 +245,78 @@ void SymbolTableImpl::callWithStringView(StatName stat_name,
   fn(toString(stat_name));
 }
 
-void SymbolTableImpl::incRefCount(const StatName& stat_name) {
+std::vector<absl::string_view>
+SymbolTableImpl::decodeSymbolStrings(const StatName& stat_name) const {
   // Before taking the lock, decode the array of symbols from the SymbolTable::Storage.
   const SymbolVec symbols = Encoding::decodeSymbols(stat_name.data(), stat_name.dataSize());
 
-  Thread::LockGuard lock(lock_);
+  std::vector<absl::string_view> strings;
+  strings.reserve(symbols.size());
+  absl::ReaderMutexLock lock(&decode_lock_);
   for (Symbol symbol : symbols) {
-    auto decode_search = decode_map_.find(symbol);
-    ASSERT(decode_search != decode_map_.end());
-
-    auto encode_search = encode_map_.find(decode_search->second->toStringView());
-    ASSERT(encode_search != encode_map_.end());
+    strings.push_back(fromSymbol(symbol));
+  }
+  return strings;
+}
 
-    ++encode_search->second.ref_count_;
+void SymbolTableImpl::incRefCount(const StatName& stat_name) {
+  // The decode lock is released before locking the shards, to respect the lock order.
+  for (absl::string_view str : decodeSymbolStrings(stat_name)) {
+    EncodeShard& encode_shard = shard(str);
+    absl::ReaderMutexLock lock(&encode_shard.lock_);
+    auto encode_search = encode_shard.encode_map_.find(str);
+    ASSERT(encode_search != encode_shard.encode_map_.end());
+
+    encode_search->second.ref_count_.fetch_add(1, std::memory_order_relaxed);
   }
 }
 
 void SymbolTableImpl::free(const StatName& stat_name) {
-  // Before taking the lock, decode the array of symbols from the SymbolTable::Storage.
-  const SymbolVec symbols = Encoding::decodeSymbols(stat_name.data(), stat_name.dataSize());
+  for (absl::string_view str : decodeSymbolStrings(stat_name)) {
+    releaseSymbol(str);
+  }
+}
 
-  Thread::LockGuard lock(lock_);
-  for (Symbol symbol : symbols) {
-    auto decode_search = decode_map_.find(symbol);
-    ASSERT(decode_search != decode_map_.end());
-
-    auto encode_search = encode_map_.find(decode_search->second->toStringView());
-    ASSERT(encode_search != encode_map_.end());
-
-    // If that was the last remaining client usage of the symbol, erase the
-    // current mappings and add the now-unused symbol to the reuse pool.
-    //
-    // The "if (--EXPR.ref_count_)" pattern speeds up BM_CreateRace by 20% in
-    // symbol_table_speed_test.cc, relative to breaking out the decrement into a
-    // separate step, likely due to the non-trivial dereferences in EXPR.
-    if (--encode_search->second.ref_count_ == 0) {
-      decode_map_.erase(decode_search);
-      encode_map_.erase(encode_search);
-      pool_.push(symbol);
+void SymbolTableImpl::releaseSymbol(absl::string_view sv) {
+  EncodeShard& encode_shard = shard(sv);
+  {
+    absl::ReaderMutexLock lock(&encode_shard.lock_);
+    auto encode_search = encode_shard.encode_map_.find(sv);
+    ASSERT(encode_search != encode_shard.encode_map_.end());
+
+    // Drop a reference unless it is the last one, which must be dropped with the shard locked
+    // exclusively, so the symbol is never visible to encoders without references.
+    std::atomic<uint32_t>& ref_count = encode_search->second.ref_count_;
+    uint32_t count = ref_count.load(std::memory_order_relaxed);
+    while (count > 1) {
+      if (ref_count.compare_exchange_weak(count, count - 1, std::memory_order_relaxed)) {
+        return;
+      }
+    }
+  }
+
+  // sv remains valid here, since only this thread can drop the last reference to its symbol.
+  absl::MutexLock lock(&encode_shard.lock_);
+  auto encode_search = encode_shard.encode_map_.find(sv);
+  ASSERT(encode_search != encode_shard.encode_map_.end());
+
+  // If that was the last remaining client usage of the symbol, erase the
+  // current mappings and add the now-unused symbol to the reuse pool.
+  //
+  // The "if (--EXPR.ref_count_)" pattern speeds up BM_CreateRace by 20% in
+  // symbol_table_speed_test.cc, relative to breaking out the decrement into a
+  // separate step, likely due to the non-trivial dereferences in EXPR.
+  if (--encode_search->second.ref_count_ == 0) {
+    const Symbol symbol = encode_search->second.symbol_;
+    // The key of the encode map is a view of the string owned by the decode map, so it is erased
+    // first.
+    encode_shard.encode_map_.erase(encode_search);
+    {
+      absl::MutexLock decode_lock(&decode_lock_);
+      decode_map_.erase(symbol);
     }
+    absl::MutexLock symbol_lock(&symbol_lock_);
+    pool_.push(symbol);
   }
 }
 
@@ -287,15 +324,15 @@ uint64_t SymbolTableImpl::getRecentLookups(const RecentLookupsFn& iter) const {
   uint64_t total = 0;
   absl::flat_hash_map<std::string, uint64_t> name_count_map;
 
-  // We don't want to hold lock_ while calling the iterator, but we need it to
-  // access recent_lookups_, so we buffer in name_count_map.
+  // We don't want to hold recent_lookups_lock_ while calling the iterator, but
+  // we need it to access recent_lookups_, so we buffer in name_count_map.
   {
-    Thread::LockGuard lock(lock_);
+    absl::MutexLock lock(&recent_lookups_lock_);
     recent_lookups_.forEach(
         [&name_count_map](absl::string_view str, uint64_t count)
             ABSL_NO_THREAD_SAFETY_ANALYSIS { name_count_map[std::string(str)] += count; });
-    total += recent_lookups_.total();
   }
+  total += lookup_count_.load(std::memory_order_relaxed);
 
   // Now we have the collated name-count map data: we need to vectorize and
   // sort. We define the pair with the count first as std::pair::operator<
@@ -340,17 +377,19 @@ DynamicSpans SymbolTableImpl::getDynamicSpans(StatName stat_name) const {
 }
 
 void SymbolTableImpl::setRecentLookupCapacity(uint64_t capacity) {
-  Thread::LockGuard lock(lock_);
+  absl::MutexLock lock(&recent_lookups_lock_);
   recent_lookups_.setCapacity(capacity);
+  remember_recent_lookups_.store(capacity > 0, std::memory_order_relaxed);
 }
 
 void SymbolTableImpl::clearRecentLookups() {
-  Thread::LockGuard lock(lock_);
+  absl::MutexLock lock(&recent_lookups_lock_);
   recent_lookups_.clear();
+  lookup_count_.store(0, std::memory_order_relaxed);
 }
 
 uint64_t SymbolTableImpl::recentLookupCapacity() const {
-  Thread::LockGuard lock(lock_);
+  absl::MutexLock lock(&recent_lookups_lock_);
   return recent_lookups_.capacity();
 }
 
@@ -361,39 +400,57 @@ StatNameSetPtr SymbolTableImpl::makeSet(absl::string_view name) {
 }
 
 Symbol SymbolTableImpl::toSymbol(absl::string_view sv) {
-  Symbol result;
-  auto encode_find = encode_map_.find(sv);
-  // If the string segment doesn't already exist,
-  if (encode_find == encode_map_.end()) {
-    // We create the actual string, place it in the decode_map_, and then insert
-    // a string_view pointing to it in the encode_map_. This allows us to only
-    // store the string once. We use unique_ptr so copies are not made as
-    // flat_hash_map moves values around.
-    InlineStringPtr str = InlineString::create(sv);
-    auto encode_insert = encode_map_.insert({str->toStringView(), SharedSymbol(next_symbol_)});
-    ASSERT(encode_insert.second);
-    auto decode_insert = decode_map_.insert({next_symbol_, std::move(str)});
-    ASSERT(decode_insert.second);
+  EncodeShard& encode_shard = shard(sv);
+  {
+    // Most tokens already have a symbol, which only needs a shared lock to add a reference to.
+    absl::ReaderMutexLock lock(&encode_shard.lock_);
+    auto encode_find = encode_shard.encode_map_.find(sv);
+    if (encode_find != encode_shard.encode_map_.end()) {
+      encode_find->second.ref_count_.fetch_add(1, std::memory_order_relaxed);
+      return encode_find->second.symbol_;
+    }
+  }
+
+  absl::MutexLock lock(&encode_shard.lock_);
+  return insertSymbol(sv, encode_shard);
+}
+
+Symbol SymbolTableImpl::insertSymbol(absl::string_view sv, EncodeShard& encode_shard) {
+  auto encode_find = encode_shard.encode_map_.find(sv);
+  // If the string segment was inserted since the caller looked, return the
+  // actual value at that location and up the refcount at that location.
+  if (encode_find != encode_shard.encode_map_.end()) {
+    ++(encode_find->second.ref_count_);
+    return encode_find->second.symbol_;
+  }
 
+  Symbol result;
+  {
+    absl::MutexLock lock(&symbol_lock_);
     result = next_symbol_;
     newSymbol();
-  } else {
-    // If the insertion didn't take place, return the actual value at that location and up the
-    // refcount at that location
-    result = encode_find->second.symbol_;
-    ++(encode_find->second.ref_count_);
   }
+
+  // We create the actual string, place it in the decode_map_, and then insert
+  // a string_view pointing to it in the encode_map_. This allows us to only
+  // store the string once. We use unique_ptr so copies are not made as
+  // flat_hash_map moves values around.
+  InlineStringPtr str = InlineString::create(sv);
+  auto encode_insert = encode_shard.encode_map_.emplace(str->toStringView(), result);
+  ASSERT(encode_insert.second);
+  absl::MutexLock lock(&decode_lock_);
+  auto decode_insert = decode_map_.insert({result, std::move(str)});
+  ASSERT(decode_insert.second);
   return result;
 }
 
-absl::string_view SymbolTableImpl::fromSymbol(const Symbol symbol) const
-    ABSL_EXCLUSIVE_LOCKS_REQUIRED(lock_) {
+absl::string_view SymbolTableImpl::fromSymbol(const Symbol symbol) const {
   auto search = decode_map_.find(symbol);
   RELEASE_ASSERT(search != decode_map_.end(), "no such symbol");
   return search->second->toStringView();
 }
 
-void SymbolTableImpl::newSymbol() ABSL_EXCLUSIVE_LOCKS_REQUIRED(lock_) {
+void SymbolTableImpl::newSymbol() {
   if (pool_.empty()) {
     next_symbol_ = ++monotonic_counter_;
   } else {
@@ -423,16 +480,18 @@ bool SymbolTableImpl::lessThan(const StatName& a, const StatName& b) const {
 
 #ifndef ENVOY_CONFIG_COVERAGE
 void SymbolTableImpl::debugPrint() const {
-  Thread::LockGuard lock(lock_);
-  std::vector<Symbol> symbols;
-  for (const auto& p : decode_map_) {
-    symbols.push_back(p.first);
+  // The shards are locked in turn, as they can't be locked while holding the decode lock.
+  std::vector<std::tuple<Symbol, std::string, uint32_t>> symbols;
+  for (const EncodeShard& encode_shard : shards_) {
+    absl::ReaderMutexLock lock(&encode_shard.lock_);
+    for (const auto& p : encode_shard.encode_map_) {
+      symbols.emplace_back(p.second.symbol_, std::string(p.first), p.second.ref_count_.load());
+    }
   }
   std::sort(symbols.begin(), symbols.end());
-  for (Symbol symbol : symbols) {
-    const InlineString& token = *decode_map_.find(symbol)->second;
-    const SharedSymbol& shared_symbol = encode_map_.find(token.toStringView())->second;
-    ENVOY_LOG_MISC(info, "{}: '{}' ({})", symbol, token.toStringView(), shared_symbol.ref_count_);
+  for (const auto& symbol : symbols) {
+    ENVOY_LOG_MISC(info, "{}: '{}' ({})", std::get<0>(symbol), std::get<1>(symbol),
+                   std::get<2>(symbol));
   }
 }
 #endif
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <algorithm>
+#include <atomic>
 #include <cstring>
 #include <memory>
 #include <stack>
@@ -21,8 +22,11 @@
 
 #include "absl/container/fixed_array.h"
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/node_hash_map.h"
+#include "absl/hash/hash.h"
 #include "absl/strings/str_join.h"
 #include "absl/strings/str_split.h"
+#include "absl/synchronization/mutex.h"
 
 namespace Envoy {
 namespace Stats {
@@ -205,15 +209,29 @@ private:
   friend class StatNameTest;
   friend class StatNameDeathTest;
 
+  // The reference count is atomic so that encoding an existing symbol only needs a shared lock
+  // on its shard. It only drops to zero while the shard is locked exclusively, at which point the
+  // symbol is erased, so a shared lock holder never sees a symbol with no references.
   struct SharedSymbol {
     SharedSymbol(Symbol symbol) : symbol_(symbol), ref_count_(1) {}
 
-    Symbol symbol_;
-    uint32_t ref_count_;
+    const Symbol symbol_;
+    std::atomic<uint32_t> ref_count_;
   };
 
-  // This must be held during both encode() and free().
-  mutable Thread::MutexBasicLockable lock_;
+  // The encode map is split into shards by the hash of the token, each with its own lock, so that
+  // workers encoding different tokens don't contend. Existing tokens are looked up with a shared
+  // lock, and only inserting or erasing a token takes its shard's lock exclusively. A node map is
+  // used so that the atomic reference counts never move.
+  //
+  // Locks are always acquired in the order: shard, decode_lock_, symbol_lock_.
+  static constexpr uint32_t EncodeShardBits = 4;
+  static constexpr uint32_t NumEncodeShards = 1 << EncodeShardBits;
+  using EncodeMap = absl::node_hash_map<absl::string_view, SharedSymbol>;
+  struct EncodeShard {
+    mutable absl::Mutex lock_;
+    EncodeMap encode_map_ ABSL_GUARDED_BY(lock_);
+  };
 
   /**
    * Decodes a uint8_t array into an array of period-delimited strings. Note
@@ -230,13 +248,31 @@ private:
    */
   std::vector<absl::string_view> decodeStrings(const Storage array, size_t size) const;
 
+  /**
+   * @return the shard holding the symbol of a token.
+   */
+  EncodeShard& shard(absl::string_view sv) const {
+    return shards_[absl::Hash<absl::string_view>()(sv) >> (64 - EncodeShardBits)];
+  }
+
   /**
    * Convenience function for encode(), symbolizing one string segment at a time.
    *
    * @param sv the individual string to be encoded as a symbol.
    * @return Symbol the encoded string.
    */
-  Symbol toSymbol(absl::string_view sv) ABSL_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+  Symbol toSymbol(absl::string_view sv);
+
+  /**
+   * Inserts a new symbol for a string segment, or adds a reference to it if another thread
+   * inserted it since the caller looked.
+   *
+   * @param sv the individual string to be encoded as a symbol.
+   * @param encode_shard the shard of sv, locked exclusively by the caller.
+   * @return Symbol the encoded string.
+   */
+  Symbol insertSymbol(absl::string_view sv, EncodeShard& encode_shard)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(encode_shard.lock_);
 
   /**
    * Convenience function for decode(), decoding one symbol at a time.
@@ -244,12 +280,25 @@ private:
    * @param symbol the individual symbol to be decoded.
    * @return absl::string_view the decoded string.
    */
-  absl::string_view fromSymbol(Symbol symbol) const ABSL_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+  absl::string_view fromSymbol(Symbol symbol) const ABSL_SHARED_LOCKS_REQUIRED(decode_lock_);
+
+  /**
+   * Decodes the symbols of a StatName to the strings they encode. As the caller holds a reference
+   * to the StatName, the strings stay valid after the decode lock is released.
+   */
+  std::vector<absl::string_view> decodeSymbolStrings(const StatName& stat_name) const;
+
+  /**
+   * Removes a reference to the symbol of a string segment, erasing the symbol if it was the last.
+   *
+   * @param sv the individual string whose symbol is released.
+   */
+  void releaseSymbol(absl::string_view sv);
 
   /**
    * Stages a new symbol for use. To be called after a successful insertion.
    */
-  void newSymbol();
+  void newSymbol() ABSL_EXCLUSIVE_LOCKS_REQUIRED(symbol_lock_);
 
   /**
    * Tokenizes name, finds or allocates symbols for each token, and adds them
@@ -261,30 +310,38 @@ private:
   void addTokensToEncoding(absl::string_view name, Encoding& encoding);
 
   Symbol monotonicCounter() {
-    Thread::LockGuard lock(lock_);
+    absl::MutexLock lock(&symbol_lock_);
     return monotonic_counter_;
   }
 
+  mutable EncodeShard shards_[NumEncodeShards];
+
+  // Guards the decode map, which is only written when a symbol is inserted or erased.
+  mutable absl::Mutex decode_lock_;
+  using DecodeMap = absl::flat_hash_map<Symbol, InlineStringPtr>;
+  DecodeMap decode_map_ ABSL_GUARDED_BY(decode_lock_);
+
+  // Guards the allocation of symbols.
+  absl::Mutex symbol_lock_;
+
   // Stores the symbol to be used at next insertion. This should exist ahead of insertion time so
   // that if insertion succeeds, the value written is the correct one.
-  Symbol next_symbol_ ABSL_GUARDED_BY(lock_);
+  Symbol next_symbol_ ABSL_GUARDED_BY(symbol_lock_);
 
   // If the free pool is exhausted, we monotonically increase this counter.
-  Symbol monotonic_counter_;
-
-  // Bitmap implementation.
-  // The encode map stores both the symbol and the ref count of that symbol.
-  // Using absl::string_view lets us only store the complete string once, in the decode map.
-  using EncodeMap = absl::flat_hash_map<absl::string_view, SharedSymbol>;
-  using DecodeMap = absl::flat_hash_map<Symbol, InlineStringPtr>;
-  EncodeMap encode_map_ ABSL_GUARDED_BY(lock_);
-  DecodeMap decode_map_ ABSL_GUARDED_BY(lock_);
+  Symbol monotonic_counter_ ABSL_GUARDED_BY(symbol_lock_);
 
   // Free pool of symbols for re-use.
   // TODO(ambuc): There might be an optimization here relating to storing ranges of freed symbols
   // using an Envoy::IntervalSet.
-  std::stack<Symbol> pool_ ABSL_GUARDED_BY(lock_);
-  RecentLookups recent_lookups_ ABSL_GUARDED_BY(lock_);
+  std::stack<Symbol> pool_ ABSL_GUARDED_BY(symbol_lock_);
+
+  // The number of encoded names is counted outside of recent_lookups_, so that its lock is only
+  // taken when recent lookups are being remembered.
+  std::atomic<uint64_t> lookup_count_{0};
+  std::atomic<bool> remember_recent_lookups_{false};
+  mutable absl::Mutex recent_lookups_lock_;
+  RecentLookups recent_lookups_ ABSL_GUARDED_BY(recent_lookups_lock_);
 };
 
 // Base class for holding the backing-storing for a StatName. The two derived
@@ -1,5 +1,6 @@
 #include "common/stats/thread_local_store.h"
 
+#include <algorithm>
 #include <chrono>
 #include <cstdint>
 #include <list>
@@ -129,8 +130,20 @@ std::vector<CounterSharedPtr> ThreadLocalStoreImpl::counters() const {
 
 ScopePtr ThreadLocalStoreImpl::createScope(const std::string& name) {
   auto new_scope = std::make_unique<ScopeImpl>(*this, name);
-  Thread::LockGuard lock(lock_);
+  Thread::ReleasableLockGuard lock(lock_);
   scopes_.emplace(new_scope.get());
+
+  // The TLS caches of all the scopes created during the current main thread event are warmed up in
+  // one batch, posted so that it runs after the creators of the scopes have made their stats. The
+  // dispatcher is checked first as the default scope is created before the other members.
+  if (main_thread_dispatcher_ != nullptr && cache_warmup_enabled_ && !shutting_down_) {
+    const bool post_warmup = scopes_to_warm_.empty();
+    scopes_to_warm_.push_back(new_scope->scope_id_);
+    lock.release();
+    if (post_warmup) {
+      main_thread_dispatcher_->post([this]() { warmThreadLocalCaches(); });
+    }
+  }
   return new_scope;
 }
 
@@ -186,11 +199,60 @@ void ThreadLocalStoreImpl::initializeThreading(Event::Dispatcher& main_thread_di
   threading_ever_initialized_ = true;
   main_thread_dispatcher_ = &main_thread_dispatcher;
   tls_ = tls.allocateSlot();
-  tls_->set([](Event::Dispatcher&) -> ThreadLocal::ThreadLocalObjectSharedPtr {
-    return std::make_shared<TlsCache>();
+  tls_->set([this](Event::Dispatcher& dispatcher) -> ThreadLocal::ThreadLocalObjectSharedPtr {
+    auto profile = std::make_shared<TlsCacheProfile>(dispatcher.name());
+    {
+      Thread::LockGuard lock(lock_);
+      tls_cache_profiles_.push_back(profile);
+    }
+    return std::make_shared<TlsCache>(std::move(profile));
   });
 }
 
+void ThreadLocalStoreImpl::setCacheProfiling(TimeSource* time_source) {
+  Thread::LockGuard lock(lock_);
+  cache_profile_time_source_ = time_source;
+  central_lock_acquisitions_ = 0;
+  central_lock_hold_time_ = std::chrono::nanoseconds::zero();
+  max_central_lock_hold_time_ = std::chrono::nanoseconds::zero();
+  for (const TlsCacheProfileSharedPtr& profile : tls_cache_profiles_) {
+    profile->misses_ = 0;
+    profile->warmed_ = 0;
+  }
+}
+
+CacheProfile ThreadLocalStoreImpl::cacheProfile() const {
+  CacheProfile cache_profile;
+  Thread::LockGuard lock(lock_);
+  cache_profile.enabled_ = cache_profile_time_source_ != nullptr;
+  cache_profile.central_lock_acquisitions_ = central_lock_acquisitions_;
+  cache_profile.central_lock_hold_time_ = central_lock_hold_time_;
+  cache_profile.max_central_lock_hold_time_ = max_central_lock_hold_time_;
+  for (const TlsCacheProfileSharedPtr& profile : tls_cache_profiles_) {
+    cache_profile.thread_caches_.push_back(
+        {profile->thread_name_, profile->misses_.load(), profile->warmed_.load()});
+  }
+  return cache_profile;
+}
+
+ThreadLocalStoreImpl::CentralCacheLockGuard::CentralCacheLockGuard(ThreadLocalStoreImpl& parent)
+    : parent_(parent), lock_(parent.lock_) {
+  if (parent_.cache_profile_time_source_ != nullptr) {
+    start_ = parent_.cache_profile_time_source_->monotonicTime();
+  }
+}
+
+ThreadLocalStoreImpl::CentralCacheLockGuard::~CentralCacheLockGuard() {
+  // Profiling cannot have been enabled or disabled in the meantime, as that takes the lock.
+  if (start_.has_value()) {
+    const std::chrono::nanoseconds hold_time = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        parent_.cache_profile_time_source_->monotonicTime() - start_.value());
+    ++parent_.central_lock_acquisitions_;
+    parent_.central_lock_hold_time_ += hold_time;
+    parent_.max_central_lock_hold_time_ = std::max(parent_.max_central_lock_hold_time_, hold_time);
+  }
+}
+
 void ThreadLocalStoreImpl::shutdownThreading() {
   // This will block both future cache fills as well as cache flushes.
   shutting_down_ = true;
@@ -205,6 +267,12 @@ void ThreadLocalStoreImpl::mergeHistograms(PostMergeCb merge_complete_cb) {
   if (!shutting_down_) {
     ASSERT(!merge_in_progress_);
     merge_in_progress_ = true;
+    if (histogram_settings_->engine() == HistogramSettings::Engine::LogLinear) {
+      // Log-linear TLS histograms are merged while the workers keep recording, so there is no need
+      // to wait for every worker to swap its histograms first.
+      mergeInternal(merge_complete_cb);
+      return;
+    }
     tls_->runOnAllThreads(
         [this]() -> void {
           for (const auto& id_hist : tls_->getTyped<TlsCache>().tls_histogram_cache_) {
@@ -290,6 +358,21 @@ ThreadLocalStoreImpl::TlsCache::insertScope(uint64_t scope_id) {
 }
 
 void ThreadLocalStoreImpl::TlsCache::eraseScope(uint64_t scope_id) { scope_cache_.erase(scope_id); }
+void ThreadLocalStoreImpl::TlsCache::warmScope(uint64_t scope_id, const TlsCacheEntry& warm_entry) {
+  TlsCacheEntry& entry = scope_cache_[scope_id];
+  const auto num_stats = [&entry]() -> uint64_t {
+    return entry.counters_.size() + entry.gauges_.size() + entry.text_readouts_.size() +
+           entry.parent_histograms_.size();
+  };
+  const uint64_t num_cached = num_stats();
+  // insert() leaves alone the stats this thread has already cached.
+  entry.counters_.insert(warm_entry.counters_.begin(), warm_entry.counters_.end());
+  entry.gauges_.insert(warm_entry.gauges_.begin(), warm_entry.gauges_.end());
+  entry.text_readouts_.insert(warm_entry.text_readouts_.begin(), warm_entry.text_readouts_.end());
+  entry.parent_histograms_.insert(warm_entry.parent_histograms_.begin(),
+                                  warm_entry.parent_histograms_.end());
+  profile_->warmed_ += num_stats() - num_cached;
+}
 void ThreadLocalStoreImpl::TlsCache::eraseHistogram(uint64_t histogram_id) {
   // This is called for every histogram in every thread, even though the
   // histogram may not have been cached in each thread yet. So we don't
@@ -309,6 +392,51 @@ void ThreadLocalStoreImpl::clearScopeFromCaches(uint64_t scope_id,
   }
 }
 
+void ThreadLocalStoreImpl::warmThreadLocalCaches() {
+  auto batch = std::make_shared<CacheWarmupBatch>();
+  std::vector<CentralCacheEntrySharedPtr> central_caches;
+  {
+    Thread::LockGuard lock(lock_);
+    const absl::flat_hash_set<uint64_t> scope_ids(scopes_to_warm_.begin(), scopes_to_warm_.end());
+    scopes_to_warm_.clear();
+    // Scopes destroyed since they were created are no longer in scopes_, so they are skipped.
+    for (ScopeImpl* scope : scopes_) {
+      if (!scope_ids.contains(scope->scope_id_)) {
+        continue;
+      }
+      const CentralCacheEntry& central_cache = *scope->central_cache_;
+      TlsCacheEntry& entry = batch->emplace_back(scope->scope_id_, TlsCacheEntry()).second;
+      for (const auto& counter : central_cache.counters_) {
+        entry.counters_.emplace(counter.first, *counter.second);
+      }
+      for (const auto& gauge : central_cache.gauges_) {
+        entry.gauges_.emplace(gauge.first, *gauge.second);
+      }
+      for (const auto& text_readout : central_cache.text_readouts_) {
+        entry.text_readouts_.emplace(text_readout.first, *text_readout.second);
+      }
+      for (const auto& histogram : central_cache.histograms_) {
+        entry.parent_histograms_.emplace(histogram.first, histogram.second);
+      }
+      central_caches.push_back(scope->central_cache_);
+    }
+  }
+
+  if (!batch->empty() && !shutting_down_) {
+    // The batch references stats owned by the central caches, so as in clearScopeFromCaches(), the
+    // central caches are held until every thread has copied the batch into its cache. Each thread
+    // copies it before it runs the cache flush of any of these scopes, which is posted later.
+    tls_->runOnAllThreads(
+        [this, batch]() {
+          TlsCache& tls_cache = tls_->getTyped<TlsCache>();
+          for (const auto& scope_entry : *batch) {
+            tls_cache.warmScope(scope_entry.first, scope_entry.second);
+          }
+        },
+        [central_caches]() { /* Holds onto central_caches until all tls caches are warm */ });
+  }
+}
+
 void ThreadLocalStoreImpl::clearHistogramFromCaches(uint64_t histogram_id) {
   // If we are shutting down we no longer perform cache flushes as workers may be shutting down
   // at the same time.
@@ -408,7 +536,8 @@ StatType& ThreadLocalStoreImpl::ScopeImpl::safeMakeStat(
     const absl::optional<StatNameTagVector>& stat_name_tags,
     StatNameHashMap<RefcountPtr<StatType>>& central_cache_map,
     StatNameStorageSet& central_rejected_stats, MakeStatFn<StatType> make_stat,
-    StatRefMap<StatType>* tls_cache, StatNameHashSet* tls_rejected_stats, StatType& null_stat) {
+    StatRefMap<StatType>* tls_cache, StatNameHashSet* tls_rejected_stats,
+    std::atomic<uint64_t>* tls_misses, StatType& null_stat) {
 
   if (tls_rejected_stats != nullptr &&
       tls_rejected_stats->find(full_stat_name) != tls_rejected_stats->end()) {
@@ -422,10 +551,13 @@ StatType& ThreadLocalStoreImpl::ScopeImpl::safeMakeStat(
       return pos->second;
     }
   }
+  if (tls_misses != nullptr) {
+    ++*tls_misses;
+  }
 
   // We must now look in the central store so we must be locked. We grab a reference to the
   // central store location. It might contain nothing. In this case, we allocate a new stat.
-  Thread::LockGuard lock(parent_.lock_);
+  CentralCacheLockGuard lock(parent_);
   auto iter = central_cache_map.find(full_stat_name);
   RefcountPtr<StatType>* central_ref = nullptr;
   if (iter != central_cache_map.end()) {
@@ -489,10 +621,13 @@ Counter& ThreadLocalStoreImpl::ScopeImpl::counterFromStatNameWithTags(
   // initialized currently.
   StatRefMap<Counter>* tls_cache = nullptr;
   StatNameHashSet* tls_rejected_stats = nullptr;
+  std::atomic<uint64_t>* tls_misses = nullptr;
   if (!parent_.shutting_down_ && parent_.tls_) {
-    TlsCacheEntry& entry = parent_.tls_->getTyped<TlsCache>().insertScope(this->scope_id_);
+    TlsCache& tls = parent_.tls_->getTyped<TlsCache>();
+    TlsCacheEntry& entry = tls.insertScope(this->scope_id_);
     tls_cache = &entry.counters_;
     tls_rejected_stats = &entry.rejected_stats_;
+    tls_misses = &tls.profile_->misses_;
   }
 
   return safeMakeStat<Counter>(
@@ -502,7 +637,7 @@ Counter& ThreadLocalStoreImpl::ScopeImpl::counterFromStatNameWithTags(
          const StatNameTagVector& tags) -> CounterSharedPtr {
         return allocator.makeCounter(name, tag_extracted_name, tags);
       },
-      tls_cache, tls_rejected_stats, parent_.null_counter_);
+      tls_cache, tls_rejected_stats, tls_misses, parent_.null_counter_);
 }
 
 void ThreadLocalStoreImpl::ScopeImpl::deliverHistogramToSinks(const Histogram& histogram,
@@ -541,10 +676,13 @@ Gauge& ThreadLocalStoreImpl::ScopeImpl::gaugeFromStatNameWithTags(
 
   StatRefMap<Gauge>* tls_cache = nullptr;
   StatNameHashSet* tls_rejected_stats = nullptr;
+  std::atomic<uint64_t>* tls_misses = nullptr;
   if (!parent_.shutting_down_ && parent_.tls_) {
-    TlsCacheEntry& entry = parent_.tls_->getTyped<TlsCache>().scope_cache_[this->scope_id_];
+    TlsCache& tls = parent_.tls_->getTyped<TlsCache>();
+    TlsCacheEntry& entry = tls.scope_cache_[this->scope_id_];
     tls_cache = &entry.gauges_;
     tls_rejected_stats = &entry.rejected_stats_;
+    tls_misses = &tls.profile_->misses_;
   }
 
   Gauge& gauge = safeMakeStat<Gauge>(
@@ -554,7 +692,7 @@ Gauge& ThreadLocalStoreImpl::ScopeImpl::gaugeFromStatNameWithTags(
                     const StatNameTagVector& tags) -> GaugeSharedPtr {
         return allocator.makeGauge(name, tag_extracted_name, tags, import_mode);
       },
-      tls_cache, tls_rejected_stats, parent_.null_gauge_);
+      tls_cache, tls_rejected_stats, tls_misses, parent_.null_gauge_);
   gauge.mergeImportMode(import_mode);
   return gauge;
 }
@@ -580,7 +718,8 @@ Histogram& ThreadLocalStoreImpl::ScopeImpl::histogramFromStatNameWithTags(
   StatNameHashMap<ParentHistogramSharedPtr>* tls_cache = nullptr;
   StatNameHashSet* tls_rejected_stats = nullptr;
   if (!parent_.shutting_down_ && parent_.tls_) {
-    TlsCacheEntry& entry = parent_.tls_->getTyped<TlsCache>().scope_cache_[this->scope_id_];
+    TlsCache& tls = parent_.tls_->getTyped<TlsCache>();
+    TlsCacheEntry& entry = tls.scope_cache_[this->scope_id_];
     tls_cache = &entry.parent_histograms_;
     auto iter = tls_cache->find(final_stat_name);
     if (iter != tls_cache->end()) {
@@ -590,9 +729,10 @@ Histogram& ThreadLocalStoreImpl::ScopeImpl::histogramFromStatNameWithTags(
     if (tls_rejected_stats->find(final_stat_name) != tls_rejected_stats->end()) {
       return parent_.null_histogram_;
     }
+    ++tls.profile_->misses_;
   }
 
-  Thread::LockGuard lock(parent_.lock_);
+  CentralCacheLockGuard lock(parent_);
   auto iter = central_cache_->histograms_.find(final_stat_name);
   ParentHistogramImplSharedPtr* central_ref = nullptr;
   if (iter != central_cache_->histograms_.end()) {
@@ -618,7 +758,8 @@ Histogram& ThreadLocalStoreImpl::ScopeImpl::histogramFromStatNameWithTags(
       } else {
         stat = new ParentHistogramImpl(final_stat_name, unit, parent_,
                                        tag_helper.tagExtractedName(), tag_helper.statNameTags(),
-                                       *buckets, parent_.next_histogram_id_++);
+                                       *buckets, parent_.histogram_settings_->engine(),
+                                       parent_.next_histogram_id_++);
         if (!parent_.shutting_down_) {
           parent_.histogram_set_.insert(stat.get());
         }
@@ -657,10 +798,13 @@ TextReadout& ThreadLocalStoreImpl::ScopeImpl::textReadoutFromStatNameWithTags(
   // initialized currently.
   StatRefMap<TextReadout>* tls_cache = nullptr;
   StatNameHashSet* tls_rejected_stats = nullptr;
+  std::atomic<uint64_t>* tls_misses = nullptr;
   if (!parent_.shutting_down_ && parent_.tls_) {
-    TlsCacheEntry& entry = parent_.tls_->getTyped<TlsCache>().insertScope(this->scope_id_);
+    TlsCache& tls = parent_.tls_->getTyped<TlsCache>();
+    TlsCacheEntry& entry = tls.insertScope(this->scope_id_);
     tls_cache = &entry.text_readouts_;
     tls_rejected_stats = &entry.rejected_stats_;
+    tls_misses = &tls.profile_->misses_;
   }
 
   return safeMakeStat<TextReadout>(
@@ -670,7 +814,7 @@ TextReadout& ThreadLocalStoreImpl::ScopeImpl::textReadoutFromStatNameWithTags(
          const StatNameTagVector& tags) -> TextReadoutSharedPtr {
         return allocator.makeTextReadout(name, tag_extracted_name, tags);
       },
-      tls_cache, tls_rejected_stats, parent_.null_text_readout_);
+      tls_cache, tls_rejected_stats, tls_misses, parent_.null_text_readout_);
 }
 
 CounterOptConstRef ThreadLocalStoreImpl::ScopeImpl::findCounter(StatName name) const {
@@ -715,7 +859,7 @@ Histogram& ThreadLocalStoreImpl::tlsHistogram(ParentHistogramImpl& parent, uint6
 
   TlsHistogramSharedPtr hist_tls_ptr(
       new ThreadLocalHistogramImpl(parent.statName(), parent.unit(), tag_helper.tagExtractedName(),
-                                   tag_helper.statNameTags(), symbolTable()));
+                                   tag_helper.statNameTags(), symbolTable(), parent.engine()));
 
   parent.addTlsHistogram(hist_tls_ptr);
 
@@ -729,49 +873,86 @@ Histogram& ThreadLocalStoreImpl::tlsHistogram(ParentHistogramImpl& parent, uint6
 ThreadLocalHistogramImpl::ThreadLocalHistogramImpl(StatName name, Histogram::Unit unit,
                                                    StatName tag_extracted_name,
                                                    const StatNameTagVector& stat_name_tags,
-                                                   SymbolTable& symbol_table)
+                                                   SymbolTable& symbol_table,
+                                                   HistogramSettings::Engine engine)
     : HistogramImplHelper(name, tag_extracted_name, stat_name_tags, symbol_table), unit_(unit),
       current_active_(0), used_(false), created_thread_id_(std::this_thread::get_id()),
       symbol_table_(symbol_table) {
-  histograms_[0] = hist_alloc();
-  histograms_[1] = hist_alloc();
+  if (engine == HistogramSettings::Engine::LogLinear) {
+    log_linear_histogram_ = std::make_unique<LogLinearHistogram>();
+  } else {
+    histograms_[0] = hist_alloc();
+    histograms_[1] = hist_alloc();
+  }
 }
 
 ThreadLocalHistogramImpl::~ThreadLocalHistogramImpl() {
   MetricImpl::clear(symbol_table_);
-  hist_free(histograms_[0]);
-  hist_free(histograms_[1]);
+  if (log_linear_histogram_ == nullptr) {
+    hist_free(histograms_[0]);
+    hist_free(histograms_[1]);
+  }
 }
 
 void ThreadLocalHistogramImpl::recordValue(uint64_t value) {
   ASSERT(std::this_thread::get_id() == created_thread_id_);
-  hist_insert_intscale(histograms_[current_active_], value, 0, 1);
-  used_ = true;
+  if (log_linear_histogram_ != nullptr) {
+    log_linear_histogram_->recordValue(value);
+  } else {
+    hist_insert_intscale(histograms_[current_active_], value, 0, 1);
+  }
+  if (!used_.load(std::memory_order_relaxed)) {
+    used_ = true;
+  }
 }
 
 void ThreadLocalHistogramImpl::merge(histogram_t* target) {
+  ASSERT(log_linear_histogram_ == nullptr);
   histogram_t** other_histogram = &histograms_[otherHistogramIndex()];
   hist_accumulate(target, other_histogram, 1);
   hist_clear(*other_histogram);
 }
 
+void ThreadLocalHistogramImpl::merge(LogLinearHistogram& target) {
+  ASSERT(log_linear_histogram_ != nullptr);
+  log_linear_histogram_->moveTo(target);
+}
+
 ParentHistogramImpl::ParentHistogramImpl(StatName name, Histogram::Unit unit,
                                          ThreadLocalStoreImpl& thread_local_store,
                                          StatName tag_extracted_name,
                                          const StatNameTagVector& stat_name_tags,
-                                         ConstSupportedBuckets& supported_buckets, uint64_t id)
+                                         ConstSupportedBuckets& supported_buckets,
+                                         HistogramSettings::Engine engine, uint64_t id)
     : MetricImpl(name, tag_extracted_name, stat_name_tags, thread_local_store.symbolTable()),
-      unit_(unit), thread_local_store_(thread_local_store), interval_histogram_(hist_alloc()),
-      cumulative_histogram_(hist_alloc()),
-      interval_statistics_(interval_histogram_, supported_buckets),
-      cumulative_statistics_(cumulative_histogram_, supported_buckets), merged_(false), id_(id) {}
+      unit_(unit), thread_local_store_(thread_local_store),
+      interval_histogram_(engine == HistogramSettings::Engine::Circllhist ? hist_alloc() : nullptr),
+      cumulative_histogram_(engine == HistogramSettings::Engine::Circllhist ? hist_alloc()
+                                                                            : nullptr),
+      interval_log_linear_histogram_(engine == HistogramSettings::Engine::LogLinear
+                                         ? std::make_unique<LogLinearHistogram>()
+                                         : nullptr),
+      cumulative_log_linear_histogram_(engine == HistogramSettings::Engine::LogLinear
+                                           ? std::make_unique<LogLinearHistogram>()
+                                           : nullptr),
+      interval_statistics_(
+          interval_histogram_ != nullptr
+              ? HistogramStatisticsImpl(interval_histogram_, supported_buckets)
+              : HistogramStatisticsImpl(*interval_log_linear_histogram_, supported_buckets)),
+      cumulative_statistics_(
+          cumulative_histogram_ != nullptr
+              ? HistogramStatisticsImpl(cumulative_histogram_, supported_buckets)
+              : HistogramStatisticsImpl(*cumulative_log_linear_histogram_, supported_buckets)),
+      merged_(false), id_(id) {}
 
 ParentHistogramImpl::~ParentHistogramImpl() {
   thread_local_store_.releaseHistogramCrossThread(id_);
   ASSERT(ref_count_ == 0);
   MetricImpl::clear(thread_local_store_.symbolTable());
-  hist_free(interval_histogram_);
-  hist_free(cumulative_histogram_);
+  if (interval_histogram_ != nullptr) {
+    hist_free(interval_histogram_);
+    hist_free(cumulative_histogram_);
+  }
 }
 
 void ParentHistogramImpl::incRefCount() { ++ref_count_; }
@@ -836,7 +1017,21 @@ bool ParentHistogramImpl::used() const {
 
 void ParentHistogramImpl::merge() {
   Thread::ReleasableLockGuard lock(merge_lock_);
-  if (merged_ || usedLockHeld()) {
+  if (interval_log_linear_histogram_ != nullptr) {
+    if (merged_ || usedLockHeld()) {
+      interval_log_linear_histogram_->clear();
+      // The TLS histograms are merged while their workers keep recording, and each merge only
+      // visits the buckets of the ranges of values the TLS histogram has seen.
+      for (const TlsHistogramSharedPtr& tls_histogram : tls_histograms_) {
+        tls_histogram->merge(*interval_log_linear_histogram_);
+      }
+      lock.release();
+      cumulative_log_linear_histogram_->add(*interval_log_linear_histogram_);
+      cumulative_statistics_.refresh(*cumulative_log_linear_histogram_);
+      interval_statistics_.refresh(*interval_log_linear_histogram_);
+      merged_ = true;
+    }
+  } else if (merged_ || usedLockHeld()) {
     hist_clear(interval_histogram_);
     // Here we could copy all the pointers to TLS histograms in the tls_histogram_ list,
     // then release the lock before we do the actual merge. However it is not a big deal
@@ -6,11 +6,15 @@
 #include <list>
 #include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 
+#include "envoy/common/time.h"
 #include "envoy/stats/tag.h"
 #include "envoy/thread_local/thread_local.h"
 
 #include "common/common/hash.h"
+#include "common/common/lock_guard.h"
 #include "common/common/thread_synchronizer.h"
 #include "common/stats/allocator_impl.h"
 #include "common/stats/histogram_impl.h"
@@ -22,24 +26,33 @@
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/types/optional.h"
 #include "circllhist.h"
 
 namespace Envoy {
 namespace Stats {
 
 /**
- * A histogram that is stored in TLS and used to record values per thread. This holds two
- * histograms, one to collect the values and other as backup that is used for merge process. The
- * swap happens during the merge process.
+ * A histogram that is stored in TLS and used to record values per thread. With the circllhist
+ * engine, this holds two histograms, one to collect the values and other as backup that is used for
+ * merge process. The swap happens during the merge process. With the log-linear engine, this holds
+ * a single histogram whose counts are moved out by the merge process while values are recorded.
  */
 class ThreadLocalHistogramImpl : public HistogramImplHelper {
 public:
   ThreadLocalHistogramImpl(StatName name, Histogram::Unit unit, StatName tag_extracted_name,
-                           const StatNameTagVector& stat_name_tags, SymbolTable& symbol_table);
+                           const StatNameTagVector& stat_name_tags, SymbolTable& symbol_table,
+                           HistogramSettings::Engine engine);
   ~ThreadLocalHistogramImpl() override;
 
   void merge(histogram_t* target);
 
+  /**
+   * Moves the recorded values into target. Unlike the circllhist merge, this needs no beginMerge()
+   * and may run concurrently with recordValue().
+   */
+  void merge(LogLinearHistogram& target);
+
   /**
    * Called in the beginning of merge process. Swaps the histogram used for collection so that we do
    * not have to lock the histogram in high throughput TLS writes.
@@ -66,7 +79,8 @@ private:
   Histogram::Unit unit_;
   uint64_t otherHistogramIndex() const { return 1 - current_active_; }
   uint64_t current_active_;
-  histogram_t* histograms_[2];
+  histogram_t* histograms_[2]{};
+  std::unique_ptr<LogLinearHistogram> log_linear_histogram_;
   std::atomic<bool> used_;
   std::thread::id created_thread_id_;
   SymbolTable& symbol_table_;
@@ -83,7 +97,8 @@ class ParentHistogramImpl : public MetricImpl<ParentHistogram> {
 public:
   ParentHistogramImpl(StatName name, Histogram::Unit unit, ThreadLocalStoreImpl& parent,
                       StatName tag_extracted_name, const StatNameTagVector& stat_name_tags,
-                      ConstSupportedBuckets& supported_buckets, uint64_t id);
+                      ConstSupportedBuckets& supported_buckets, HistogramSettings::Engine engine,
+                      uint64_t id);
   ~ParentHistogramImpl() override;
 
   void addTlsHistogram(const TlsHistogramSharedPtr& hist_ptr);
@@ -120,13 +135,22 @@ public:
   void setShuttingDown(bool shutting_down) { shutting_down_ = shutting_down; }
   bool shuttingDown() const { return shutting_down_; }
 
+  HistogramSettings::Engine engine() const {
+    return interval_log_linear_histogram_ != nullptr ? HistogramSettings::Engine::LogLinear
+                                                     : HistogramSettings::Engine::Circllhist;
+  }
+
 private:
   bool usedLockHeld() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(merge_lock_);
 
   Histogram::Unit unit_;
   ThreadLocalStoreImpl& thread_local_store_;
-  histogram_t* interval_histogram_;
-  histogram_t* cumulative_histogram_;
+  // Exactly one of the circllhist and log-linear pairs of histograms is allocated, depending on the
+  // engine.
+  histogram_t* interval_histogram_{};
+  histogram_t* cumulative_histogram_{};
+  std::unique_ptr<LogLinearHistogram> interval_log_linear_histogram_;
+  std::unique_ptr<LogLinearHistogram> cumulative_log_linear_histogram_;
   HistogramStatisticsImpl interval_statistics_;
   HistogramStatisticsImpl cumulative_statistics_;
   mutable Thread::MutexBasicLockable merge_lock_;
@@ -242,6 +266,13 @@ public:
   std::vector<GaugeSharedPtr> gauges() const override;
   std::vector<TextReadoutSharedPtr> textReadouts() const override;
   std::vector<ParentHistogramSharedPtr> histograms() const override;
+  void forEachChangedStat(const std::function<void(Counter&, uint64_t)>& counter_fn,
+                          const std::function<void(Gauge&)>& gauge_fn,
+                          const std::function<void(TextReadout&)>& text_readout_fn) override {
+    alloc_.forEachChangedStat(counter_fn, gauge_fn, text_readout_fn);
+  }
+  void setCacheProfiling(TimeSource* time_source) override;
+  CacheProfile cacheProfile() const override;
 
   // Stats::StoreRoot
   void addSink(Sink& sink) override { timer_sinks_.push_back(sink); }
@@ -250,6 +281,7 @@ public:
   }
   void setStatsMatcher(StatsMatcherPtr&& stats_matcher) override;
   void setHistogramSettings(HistogramSettingsConstPtr&& histogram_settings) override;
+  void setThreadLocalCacheWarmup(bool enabled) override { cache_warmup_enabled_ = enabled; }
   void initializeThreading(Event::Dispatcher& main_thread_dispatcher,
                            ThreadLocal::Instance& tls) override;
   void shutdownThreading() override;
@@ -307,6 +339,9 @@ private:
     StatNameHashSet rejected_stats_;
   };
 
+  // The stats of new scopes to copy into the TLS caches, keyed by scope ID.
+  using CacheWarmupBatch = std::vector<std::pair<uint64_t, TlsCacheEntry>>;
+
   struct CentralCacheEntry : public RefcountHelper {
     explicit CentralCacheEntry(SymbolTable& symbol_table) : symbol_table_(symbol_table) {}
     ~CentralCacheEntry();
@@ -406,6 +441,7 @@ private:
      * @param make_stat a function to generate the stat object, called if it's not in cache.
      * @param tls_ref possibly null reference to a cache entry for this stat, which will be
      *     used if non-empty, or filled in if empty (and non-null).
+     * @param tls_misses possibly null count of the lookups which miss the TLS cache.
      */
     template <class StatType>
     StatType& safeMakeStat(StatName full_stat_name, StatName name_no_tags,
@@ -413,7 +449,8 @@ private:
                            StatNameHashMap<RefcountPtr<StatType>>& central_cache_map,
                            StatNameStorageSet& central_rejected_stats,
                            MakeStatFn<StatType> make_stat, StatRefMap<StatType>* tls_cache,
-                           StatNameHashSet* tls_rejected_stats, StatType& null_stat);
+                           StatNameHashSet* tls_rejected_stats, std::atomic<uint64_t>* tls_misses,
+                           StatType& null_stat);
 
     template <class StatType>
     using StatTypeOptConstRef = absl::optional<std::reference_wrapper<const StatType>>;
@@ -438,10 +475,24 @@ private:
     mutable CentralCacheEntrySharedPtr central_cache_;
   };
 
+  // The profile of a TLS cache. It is written by the cache's thread, and read and reset by
+  // cacheProfile() and setCacheProfiling() on any thread.
+  struct TlsCacheProfile {
+    explicit TlsCacheProfile(const std::string& thread_name) : thread_name_(thread_name) {}
+
+    const std::string thread_name_;
+    std::atomic<uint64_t> misses_{};
+    std::atomic<uint64_t> warmed_{};
+  };
+  using TlsCacheProfileSharedPtr = std::shared_ptr<TlsCacheProfile>;
+
   struct TlsCache : public ThreadLocal::ThreadLocalObject {
+    explicit TlsCache(TlsCacheProfileSharedPtr profile) : profile_(std::move(profile)) {}
+
     TlsCacheEntry& insertScope(uint64_t scope_id);
     void eraseScope(uint64_t scope_id);
     void eraseHistogram(uint64_t histogram);
+    void warmScope(uint64_t scope_id, const TlsCacheEntry& warm_entry);
 
     // The TLS scope cache is keyed by scope ID. This is used to avoid complex circular references
     // during scope destruction. An ID is required vs. using the address of the scope pointer
@@ -454,6 +505,21 @@ private:
 
     // Maps from histogram ID (monotonically increasing) to a TLS histogram.
     absl::flat_hash_map<uint64_t, TlsHistogramSharedPtr> tls_histogram_cache_;
+
+    const TlsCacheProfileSharedPtr profile_;
+  };
+
+  // Locks lock_ to look up or create a stat in a central cache, measuring how long the lock is
+  // held while cache profiling is enabled.
+  class CentralCacheLockGuard {
+  public:
+    explicit CentralCacheLockGuard(ThreadLocalStoreImpl& parent);
+    ~CentralCacheLockGuard();
+
+  private:
+    ThreadLocalStoreImpl& parent_;
+    Thread::LockGuard lock_;
+    absl::optional<MonotonicTime> start_;
   };
 
   template <class StatFn> bool iterHelper(StatFn fn) const {
@@ -469,6 +535,7 @@ private:
   std::string getTagsForName(const std::string& name, TagVector& tags) const;
   void clearScopeFromCaches(uint64_t scope_id, CentralCacheEntrySharedPtr central_cache);
   void clearHistogramFromCaches(uint64_t histogram_id);
+  void warmThreadLocalCaches();
   void releaseScopeCrossThread(ScopeImpl* scope);
   void mergeInternal(PostMergeCb merge_cb);
   bool rejects(StatName name) const;
@@ -511,6 +578,16 @@ private:
   std::vector<HistogramSharedPtr> deleted_histograms_ ABSL_GUARDED_BY(lock_);
   std::vector<TextReadoutSharedPtr> deleted_text_readouts_ ABSL_GUARDED_BY(lock_);
 
+  // Cache profiling and warm-up. The central lock figures are only updated by
+  // CentralCacheLockGuard while it holds lock_.
+  TimeSource* cache_profile_time_source_ ABSL_GUARDED_BY(lock_){};
+  uint64_t central_lock_acquisitions_ ABSL_GUARDED_BY(lock_){};
+  std::chrono::nanoseconds central_lock_hold_time_ ABSL_GUARDED_BY(lock_){};
+  std::chrono::nanoseconds max_central_lock_hold_time_ ABSL_GUARDED_BY(lock_){};
+  std::vector<TlsCacheProfileSharedPtr> tls_cache_profiles_ ABSL_GUARDED_BY(lock_);
+  std::atomic<bool> cache_warmup_enabled_{};
+  std::vector<uint64_t> scopes_to_warm_ ABSL_GUARDED_BY(lock_);
+
   Thread::ThreadSynchronizer sync_;
   std::atomic<uint64_t> next_scope_id_{};
   uint64_t next_histogram_id_ ABSL_GUARDED_BY(hist_mutex_) = 0;
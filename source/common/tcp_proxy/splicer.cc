@@ -0,0 +1,142 @@
+#include "common/tcp_proxy/splicer.h"
+
+#include "common/api/os_sys_calls_impl.h"
+#include "common/common/assert.h"
+#include "common/tcp_proxy/tcp_proxy.h"
+
+namespace Envoy {
+namespace TcpProxy {
+
+Splicer::Splicer(Network::Connection& from, Network::Connection& to, const TcpProxyStats& stats,
+                 SplicedCb spliced_cb)
+    : from_(from), to_(to), stats_(stats), spliced_cb_(std::move(spliced_cb)) {}
+
+Splicer::~Splicer() {
+  if (active()) {
+    stop();
+  }
+  for (os_fd_t fd : pipe_) {
+    if (fd != INVALID_SOCKET) {
+      Api::OsSysCallsSingleton::get().close(fd);
+    }
+  }
+}
+
+bool Splicer::maybeSplice() {
+  if (active() || done_) {
+    return active();
+  }
+  if (!from_.readEnabled()) {
+    return false;
+  }
+  Network::IoHandle* from_handle = from_.spliceableIoHandle();
+  Network::IoHandle* to_handle = to_.spliceableIoHandle();
+  if (from_handle == nullptr || to_handle == nullptr) {
+    return false;
+  }
+  if (pipe_[0] == INVALID_SOCKET) {
+    const Api::SysCallIntResult result = Api::OsSysCallsSingleton::get().pipe(pipe_);
+    if (result.rc_ != 0) {
+      ENVOY_CONN_LOG(debug, "failed to create a pipe to splice with: {}", from_, result.errno_);
+      done_ = true;
+      return false;
+    }
+  }
+
+  ENVOY_CONN_LOG(debug, "splicing into connection {}", from_, to_.id());
+  stats_.splice_total_.inc();
+  stats_.splice_active_.inc();
+  from_fd_ = from_handle->fd();
+  to_fd_ = to_handle->fd();
+  // The connections keep their own file events, so these must be edge triggered as well.
+  from_.readDisable(true);
+  read_event_ = from_.dispatcher().createFileEvent(
+      from_fd_, [this](uint32_t) { onFileEvent(); }, Event::FileTriggerType::Edge,
+      Event::FileReadyType::Read);
+  write_event_ = to_.dispatcher().createFileEvent(
+      to_fd_, [this](uint32_t) { onFileEvent(); }, Event::FileTriggerType::Edge,
+      Event::FileReadyType::Write);
+  // Data may already be waiting to be read.
+  read_event_->activate(Event::FileReadyType::Read);
+  return true;
+}
+
+void Splicer::onFileEvent() {
+  Api::OsSysCalls& os_sys_calls = Api::OsSysCallsSingleton::get();
+  const uint64_t bytes_per_event =
+      from_.bufferLimit() > 0 ? from_.bufferLimit() : DefaultBytesPerEvent;
+  uint64_t bytes_read = 0;
+  uint64_t bytes_written = 0;
+  bool stop_splicing = false;
+  while (true) {
+    // The pipe is emptied before more is read, so that a read which would block means that
+    // nothing is left to read.
+    if (bytes_in_pipe_ > 0) {
+      const Api::SysCallSizeResult result = os_sys_calls.splice(pipe_[0], to_fd_, bytes_in_pipe_);
+      if (result.rc_ == -1) {
+        if (result.errno_ != SOCKET_ERROR_AGAIN) {
+          // The destination connection runs into the error on its next write.
+          ENVOY_CONN_LOG(debug, "splice write error: {}", to_, result.errno_);
+          stop_splicing = true;
+        }
+        // Otherwise the write event resumes splicing.
+        break;
+      }
+      bytes_in_pipe_ -= result.rc_;
+      bytes_written += result.rc_;
+      continue;
+    }
+    if (end_of_stream_) {
+      stop_splicing = true;
+      break;
+    }
+    if (bytes_read >= bytes_per_event) {
+      // Let other events run before splicing more.
+      read_event_->activate(Event::FileReadyType::Read);
+      break;
+    }
+    const Api::SysCallSizeResult result = os_sys_calls.splice(from_fd_, pipe_[1], MaxSpliceSize);
+    if (result.rc_ == -1 && result.errno_ == SOCKET_ERROR_AGAIN) {
+      break;
+    }
+    if (result.rc_ <= 0) {
+      // Once what was read is flushed, the source connection is read enabled again to read the end
+      // of the stream. A read error shuts the socket down, so it reads an end of stream as well.
+      ENVOY_CONN_LOG(trace, "splice read returns: {}, errno: {}", from_, result.rc_,
+                     result.errno_);
+      end_of_stream_ = true;
+      continue;
+    }
+    bytes_in_pipe_ += result.rc_;
+    bytes_read += result.rc_;
+  }
+
+  ENVOY_CONN_LOG(trace, "spliced {} bytes in, {} bytes out", from_, bytes_read, bytes_written);
+  if (bytes_read > 0) {
+    from_.recordSplicedBytes(bytes_read, 0);
+  }
+  if (bytes_written > 0) {
+    to_.recordSplicedBytes(0, bytes_written);
+    stats_.splice_bytes_total_.add(bytes_written);
+    spliced_cb_(bytes_written);
+  }
+  if (stop_splicing) {
+    stop();
+  }
+}
+
+void Splicer::stop() {
+  ENVOY_CONN_LOG(debug, "stopped splicing with {} bytes left in the pipe", from_, bytes_in_pipe_);
+  ASSERT(active());
+  stats_.splice_active_.dec();
+  read_event_.reset();
+  write_event_.reset();
+  done_ = true;
+  // A closing connection isn't read again.
+  if (from_.state() == Network::Connection::State::Open) {
+    from_.readDisable(false);
+  }
+}
+
+} // namespace TcpProxy
+} // namespace Envoy
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+
+#include "envoy/common/platform.h"
+#include "envoy/event/file_event.h"
+#include "envoy/network/connection.h"
+
+#include "common/common/logger.h"
+
+namespace Envoy {
+namespace TcpProxy {
+
+struct TcpProxyStats;
+
+/**
+ * Moves the data read from one connection to another with splice(), through a pipe, so that it is
+ * never copied to user space. Splicing only starts while both connections are spliceable (@see
+ * Network::Connection::spliceableIoHandle()) and the source connection is read enabled. The
+ * source connection is read disabled while data is spliced, and read enabled again once the end of
+ * its stream or an error is reached, so that it goes on to read them as usual.
+ */
+class Splicer : protected Logger::Loggable<Logger::Id::filter> {
+public:
+  /**
+   * Called with the number of bytes which were spliced into the destination connection.
+   */
+  using SplicedCb = std::function<void(uint64_t bytes)>;
+
+  Splicer(Network::Connection& from, Network::Connection& to, const TcpProxyStats& stats,
+          SplicedCb spliced_cb);
+  ~Splicer();
+
+  /**
+   * Starts splicing if the connections allow it and it didn't already stop.
+   * @return bool whether data is being spliced.
+   */
+  bool maybeSplice();
+
+  /**
+   * @return bool whether data is being spliced.
+   */
+  bool active() const { return read_event_ != nullptr; }
+
+  // The most bytes spliced into the pipe at once, which is the default size of a pipe on Linux.
+  static constexpr uint64_t MaxSpliceSize = 65536;
+  // The most bytes spliced on a single event when the source connection has no buffer limit.
+  static constexpr uint64_t DefaultBytesPerEvent = 1024 * 1024;
+
+private:
+  void onFileEvent();
+  void stop();
+
+  Network::Connection& from_;
+  Network::Connection& to_;
+  const TcpProxyStats& stats_;
+  const SplicedCb spliced_cb_;
+  os_fd_t pipe_[2]{INVALID_SOCKET, INVALID_SOCKET};
+  os_fd_t from_fd_{INVALID_SOCKET};
+  os_fd_t to_fd_{INVALID_SOCKET};
+  Event::FileEventPtr read_event_;
+  Event::FileEventPtr write_event_;
+  uint64_t bytes_in_pipe_{};
+  bool end_of_stream_{};
+  // Whether splicing ended and can't start again.
+  bool done_{};
+};
+
+using SplicerPtr = std::unique_ptr<Splicer>;
+
+} // namespace TcpProxy
+} // namespace Envoy
@@ -170,6 +170,10 @@ Config::Config(const envoy::extensions::filters::network::tcp_proxy::v3::TcpProx
   if (!config.hash_policy().empty()) {
     hash_policy_ = std::make_unique<Network::HashPolicyImpl>(config.hash_policy());
   }
+
+  if (config.has_splice_threshold()) {
+    splice_threshold_ = config.splice_threshold().value();
+  }
 }
 
 RouteConstSharedPtr Config::getRegularRouteFromEntries(Network::Connection& connection) {
@@ -221,6 +225,7 @@ Filter::~Filter() {
 
   ASSERT(upstream_handle_ == nullptr);
   ASSERT(upstream_ == nullptr);
+  ASSERT(downstream_splicer_ == nullptr && upstream_splicer_ == nullptr);
 }
 
 TcpProxyStats Config::SharedConfig::generateStats(Stats::Scope& scope) {
@@ -346,7 +351,7 @@ void Filter::UpstreamCallbacks::onUpstreamData(Buffer::Instance& data, bool end_
 
 void Filter::UpstreamCallbacks::onBytesSent() {
   if (drainer_ == nullptr) {
-    parent_->resetIdleTimer();
+    parent_->onUpstreamBytesSent();
   } else {
     drainer_->onBytesSent();
   }
@@ -563,6 +568,9 @@ Network::FilterStatus Filter::onData(Buffer::Instance& data, bool end_stream) {
 }
 
 void Filter::onDownstreamEvent(Network::ConnectionEvent event) {
+  if (event != Network::ConnectionEvent::Connected) {
+    resetSplicers();
+  }
   if (upstream_) {
     Tcp::ConnectionPool::ConnectionDataPtr conn_data(upstream_->onDownstreamEvent(event));
     if (conn_data != nullptr &&
@@ -602,6 +610,7 @@ void Filter::onUpstreamEvent(Network::ConnectionEvent event) {
 
   if (event == Network::ConnectionEvent::RemoteClose ||
       event == Network::ConnectionEvent::LocalClose) {
+    resetSplicers();
     upstream_.reset();
     disableIdleTimer();
 
@@ -637,13 +646,34 @@ void Filter::onUpstreamEvent(Network::ConnectionEvent event) {
       idle_timer_ = read_callbacks_->connection().dispatcher().createTimer(
           [upstream_callbacks = upstream_callbacks_]() { upstream_callbacks->onIdleTimeout(); });
       resetIdleTimer();
-      read_callbacks_->connection().addBytesSentCallback([this](uint64_t) { resetIdleTimer(); });
+    }
+
+    Network::Connection* upstream_connection = upstream_ ? upstream_->connection() : nullptr;
+    if (config_->spliceThreshold() && upstream_connection != nullptr) {
+      Network::Connection& downstream_connection = read_callbacks_->connection();
+      downstream_splicer_ = std::make_unique<Splicer>(
+          downstream_connection, *upstream_connection, config_->stats(),
+          [this](uint64_t) { resetIdleTimer(); });
+      upstream_splicer_ = std::make_unique<Splicer>(*upstream_connection, downstream_connection,
+                                                    config_->stats(),
+                                                    [this](uint64_t) { resetIdleTimer(); });
+    }
+
+    // Sent bytes reset the idle timer, and may let a direction be spliced once its buffers are
+    // flushed.
+    if (config_->idleTimeout() || downstream_splicer_ != nullptr) {
+      read_callbacks_->connection().addBytesSentCallback(
+          [this](uint64_t) { onDownstreamBytesSent(); });
       if (upstream_) {
         upstream_->addBytesSentCallback([upstream_callbacks = upstream_callbacks_](uint64_t) {
           upstream_callbacks->onBytesSent();
         });
       }
     }
+
+    // With a threshold of 0, splicing starts right away.
+    maybeSplice(downstream_splicer_.get(), getStreamInfo().bytesReceived());
+    maybeSplice(upstream_splicer_.get(), getStreamInfo().bytesSent());
   }
 }
 
@@ -669,6 +699,28 @@ void Filter::disableIdleTimer() {
   }
 }
 
+void Filter::onDownstreamBytesSent() {
+  resetIdleTimer();
+  maybeSplice(upstream_splicer_.get(), getStreamInfo().bytesSent());
+}
+
+void Filter::onUpstreamBytesSent() {
+  resetIdleTimer();
+  maybeSplice(downstream_splicer_.get(), getStreamInfo().bytesReceived());
+}
+
+void Filter::maybeSplice(Splicer* splicer, uint64_t bytes_proxied) {
+  if (splicer != nullptr && bytes_proxied >= config_->spliceThreshold().value()) {
+    splicer->maybeSplice();
+  }
+}
+
+void Filter::resetSplicers() {
+  // The splicers refer to both connections, so they go before either of them does.
+  downstream_splicer_.reset();
+  upstream_splicer_.reset();
+}
+
 UpstreamDrainManager::~UpstreamDrainManager() {
   // If connections aren't closed before they are destructed an ASSERT fires,
   // so cancel all pending drains, which causes the connections to be closed.
@@ -36,6 +36,10 @@ void TcpUpstream::addBytesSentCallback(Network::Connection::BytesSentCb cb) {
   upstream_conn_data_->connection().addBytesSentCallback(cb);
 }
 
+Network::Connection* TcpUpstream::connection() {
+  return upstream_conn_data_ != nullptr ? &upstream_conn_data_->connection() : nullptr;
+}
+
 Tcp::ConnectionPool::ConnectionData*
 TcpUpstream::onDownstreamEvent(Network::ConnectionEvent event) {
   if (event == Network::ConnectionEvent::RemoteClose) {
@@ -57,6 +57,8 @@ public:
   // upstream to do any cleanup.
   virtual Tcp::ConnectionPool::ConnectionData*
   onDownstreamEvent(Network::ConnectionEvent event) PURE;
+  // Returns the upstream connection if the data is written to it as is, or nullptr otherwise.
+  virtual Network::Connection* connection() PURE;
 };
 
 class TcpUpstream : public GenericUpstream {
@@ -69,6 +71,7 @@ public:
   void encodeData(Buffer::Instance& data, bool end_stream) override;
   void addBytesSentCallback(Network::Connection::BytesSentCb cb) override;
   Tcp::ConnectionPool::ConnectionData* onDownstreamEvent(Network::ConnectionEvent event) override;
+  Network::Connection* connection() override;
 
 private:
   Tcp::ConnectionPool::ConnectionDataPtr upstream_conn_data_;
@@ -89,6 +92,8 @@ public:
   void encodeData(Buffer::Instance& data, bool end_stream) override;
   void addBytesSentCallback(Network::Connection::BytesSentCb cb) override;
   Tcp::ConnectionPool::ConnectionData* onDownstreamEvent(Network::ConnectionEvent event) override;
+  // The data is sent in the body of a request.
+  Network::Connection* connection() override { return nullptr; }
 
   // Http::StreamCallbacks
   void onResetStream(Http::StreamResetReason reason,
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "common/common/assert.h"
+
+namespace Envoy {
+namespace Upstream {
+
+// Weighted random scheduler using Vose's alias method
+// (https://www.keithschwarz.com/darts-dice-coins/). Building the table is O(n), after which each
+// pick is O(1): a single random number selects a column uniformly and then flips that column's
+// biased coin between the column's own entry and its alias. The table is two 32-bit integers per
+// entry in one contiguous array, so a pick touches at most two cache lines and never allocates.
+//
+// Unlike EdfScheduler, picks don't follow a round robin order, and weights are fixed when the
+// table is built, so the table must be rebuilt for weight changes to take effect.
+template <class C> class AliasScheduler {
+public:
+  /**
+   * Builds the table.
+   * @param entries the entries to pick from, with their weights, which must be positive.
+   */
+  explicit AliasScheduler(std::vector<std::pair<double, std::shared_ptr<C>>>&& entries) {
+    ASSERT(entries.size() < std::numeric_limits<uint32_t>::max());
+    const uint32_t size = entries.size();
+    double total_weight = 0;
+    for (const auto& entry : entries) {
+      ASSERT(entry.first > 0);
+      total_weight += entry.first;
+    }
+
+    // Scale the weights so that they average 1. Each column is then filled up to 1 with a small
+    // entry and topped up by the alias of a large one, which moves the excess of the large entry.
+    std::vector<double> scaled_weights;
+    scaled_weights.reserve(size);
+    std::vector<uint32_t> small;
+    std::vector<uint32_t> large;
+    entries_.reserve(size);
+    columns_.resize(size);
+    for (uint32_t i = 0; i < size; ++i) {
+      scaled_weights.push_back(entries[i].first * size / total_weight);
+      (scaled_weights.back() < 1.0 ? small : large).push_back(i);
+      entries_.push_back(std::move(entries[i].second));
+    }
+
+    while (!small.empty() && !large.empty()) {
+      const uint32_t less = small.back();
+      small.pop_back();
+      const uint32_t more = large.back();
+      large.pop_back();
+
+      columns_[less] = {threshold(scaled_weights[less]), more};
+      scaled_weights[more] = (scaled_weights[more] + scaled_weights[less]) - 1.0;
+      (scaled_weights[more] < 1.0 ? small : large).push_back(more);
+    }
+    // Whatever remains is full, up to floating point error, so it always picks its own entry.
+    for (const uint32_t i : large) {
+      columns_[i] = {std::numeric_limits<uint32_t>::max(), i};
+    }
+    for (const uint32_t i : small) {
+      columns_[i] = {std::numeric_limits<uint32_t>::max(), i};
+    }
+  }
+
+  /**
+   * Picks an entry at random, in proportion to its weight.
+   * @param random a uniformly distributed random number.
+   * @return the picked entry. The scheduler must not be empty.
+   */
+  const std::shared_ptr<C>& pick(uint64_t random) const {
+    ASSERT(!empty());
+    // The high bits select the column, by multiplying rather than taking a modulo, and the low
+    // bits flip the column's coin.
+    const uint32_t column = ((random >> 32) * columns_.size()) >> 32;
+    const Column& entry = columns_[column];
+    return entries_[static_cast<uint32_t>(random) < entry.threshold_ ? column : entry.alias_];
+  }
+
+  bool empty() const { return entries_.empty(); }
+
+private:
+  struct Column {
+    // The column picks its own entry if the low 32 bits of the random number are below this, and
+    // its alias otherwise.
+    uint32_t threshold_;
+    uint32_t alias_;
+  };
+
+  static uint32_t threshold(double probability) {
+    return static_cast<uint32_t>(std::min(
+        probability * 4294967296.0, static_cast<double>(std::numeric_limits<uint32_t>::max())));
+  }
+
+  std::vector<Column> columns_;
+  std::vector<std::shared_ptr<C>> entries_;
+};
+
+} // namespace Upstream
+} // namespace Envoy
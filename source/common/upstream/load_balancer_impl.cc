@@ -1,6 +1,9 @@
 #include "common/upstream/load_balancer_impl.h"
 
+#include <algorithm>
+#include <chrono>
 #include <cstdint>
+#include <limits>
 #include <memory>
 #include <string>
 #include <vector>
@@ -698,7 +701,7 @@ EdfLoadBalancerBase::EdfLoadBalancerBase(
     const envoy::config::cluster::v3::Cluster::CommonLbConfig& common_config)
     : ZoneAwareLoadBalancerBase(priority_set, local_priority_set, stats, runtime, random,
                                 common_config),
-      seed_(random_.random()) {
+      seed_(random_.random()), weighted_host_scheduler_(common_config.weighted_host_scheduler()) {
   // We fully recompute the schedulers for a given host set here on membership change, which is
   // consistent with what other LB implementations do (e.g. thread aware).
   // The downside of a full recompute is that time complexity is O(n * log n),
@@ -728,6 +731,19 @@ void EdfLoadBalancerBase::refresh(uint32_t priority) {
       return;
     }
 
+    if (weighted_host_scheduler_ == envoy::config::cluster::v3::Cluster::CommonLbConfig::ALIAS) {
+      // The table is built from the configured host weights. Clusters update their host sets when
+      // a weight changes with this scheduler, which rebuilds the table. The least request load
+      // balancer accounts for active requests when it picks from the table instead.
+      std::vector<std::pair<double, HostConstSharedPtr>> weighted_hosts;
+      weighted_hosts.reserve(hosts.size());
+      for (const auto& host : hosts) {
+        weighted_hosts.emplace_back(host->weight(), host);
+      }
+      scheduler.alias_ = std::make_unique<AliasScheduler<const Host>>(std::move(weighted_hosts));
+      return;
+    }
+
     scheduler.edf_ = std::make_unique<EdfScheduler<const Host>>();
 
     // Populate scheduler with host list.
@@ -796,6 +812,8 @@ HostConstSharedPtr EdfLoadBalancerBase::chooseHostOnce(LoadBalancerContext* cont
       scheduler.edf_->add(hostWeight(*host), host);
     }
     return host;
+  } else if (scheduler.alias_ != nullptr) {
+    return aliasHostPick(*scheduler.alias_);
   } else {
     const HostVector& hosts_to_use = hostSourceToHosts(*hosts_source);
     if (hosts_to_use.empty()) {
@@ -828,6 +846,23 @@ HostConstSharedPtr LeastRequestLoadBalancer::unweightedHostPick(const HostVector
   return candidate_host;
 }
 
+HostConstSharedPtr
+LeastRequestLoadBalancer::aliasHostPick(const AliasScheduler<const Host>& alias) {
+  // The table already accounts for host weights, so the sampled hosts compete on active requests
+  // alone. Without an active request bias, requests are spread by weight only, as with EDF.
+  const uint32_t choice_count = active_request_bias_ == 0.0 ? 1 : choice_count_;
+  const HostConstSharedPtr* candidate_host = nullptr;
+  for (uint32_t choice_idx = 0; choice_idx < choice_count; ++choice_idx) {
+    const HostConstSharedPtr& sampled_host = alias.pick(random_.random());
+    if (candidate_host == nullptr || sampled_host->stats().rq_active_.value() <
+                                         (*candidate_host)->stats().rq_active_.value()) {
+      candidate_host = &sampled_host;
+    }
+  }
+
+  return *candidate_host;
+}
+
 HostConstSharedPtr RandomLoadBalancer::chooseHostOnce(LoadBalancerContext* context) {
   const absl::optional<HostsSource> hosts_source = hostSourceToUse(context);
   if (!hosts_source) {
@@ -842,6 +877,102 @@ HostConstSharedPtr RandomLoadBalancer::chooseHostOnce(LoadBalancerContext* conte
   return hosts_to_use[random_.random() % hosts_to_use.size()];
 }
 
+PeakEwmaLoadBalancer::PeakEwmaLoadBalancer(
+    const PrioritySet& priority_set, const PrioritySet* local_priority_set, ClusterStats& stats,
+    Runtime::Loader& runtime, Random::RandomGenerator& random, TimeSource& time_source,
+    const envoy::config::cluster::v3::Cluster::CommonLbConfig& common_config,
+    const absl::optional<envoy::config::cluster::v3::Cluster::PeakEwmaLbConfig>& peak_ewma_config)
+    : ZoneAwareLoadBalancerBase(priority_set, local_priority_set, stats, runtime, random,
+                                common_config),
+      time_source_(time_source),
+      choice_count_(peak_ewma_config.has_value()
+                        ? PROTOBUF_GET_WRAPPED_OR_DEFAULT(peak_ewma_config.value(), choice_count, 2)
+                        : 2),
+      decay_time_ns_(
+          1e6 * (peak_ewma_config.has_value()
+                     ? PROTOBUF_GET_MS_OR_DEFAULT(peak_ewma_config.value(), decay_time, 10000)
+                     : 10000)) {
+  priority_set.addPriorityUpdateCb(
+      [this](uint32_t, const HostVector&, const HostVector& hosts_removed) {
+        for (const auto& host : hosts_removed) {
+          latencies_.erase(host.get());
+        }
+      });
+}
+
+double PeakEwmaLoadBalancer::decayFactor(MonotonicTime now, MonotonicTime last_update) const {
+  const double elapsed_ns = std::chrono::duration<double, std::nano>(now - last_update).count();
+  return std::exp(-std::max(elapsed_ns, 0.0) / decay_time_ns_);
+}
+
+double PeakEwmaLoadBalancer::cost(const Host& host, MonotonicTime now) const {
+  // Matches Finagle: large enough to exceed any real latency, and small enough to add active
+  // requests to.
+  static constexpr double UnknownLatencyPenalty =
+      static_cast<double>(std::numeric_limits<int64_t>::max() >> 16);
+
+  double average = 0;
+  auto it = latencies_.find(&host);
+  if (it != latencies_.end()) {
+    average = it->second.average_ * decayFactor(now, it->second.last_update_);
+  }
+  const uint64_t active_requests = host.stats().rq_active_.value();
+  if (average == 0 && active_requests != 0) {
+    // Until a host's first response, its active requests might be arbitrarily slow, so prefer any
+    // host with a known latency.
+    return UnknownLatencyPenalty + active_requests;
+  }
+  return average * (active_requests + 1) / host.weight();
+}
+
+HostConstSharedPtr PeakEwmaLoadBalancer::chooseHostOnce(LoadBalancerContext* context) {
+  const absl::optional<HostsSource> hosts_source = hostSourceToUse(context);
+  if (!hosts_source) {
+    return nullptr;
+  }
+
+  const HostVector& hosts_to_use = hostSourceToHosts(*hosts_source);
+  if (hosts_to_use.empty()) {
+    return nullptr;
+  }
+
+  const MonotonicTime now = time_source_.monotonicTime();
+  const HostSharedPtr* candidate_host = nullptr;
+  double candidate_cost = 0;
+  for (uint32_t choice_idx = 0; choice_idx < choice_count_; ++choice_idx) {
+    const HostSharedPtr& sampled_host = hosts_to_use[random_.random() % hosts_to_use.size()];
+    const double sampled_cost = cost(*sampled_host, now);
+    if (candidate_host == nullptr || sampled_cost < candidate_cost) {
+      candidate_host = &sampled_host;
+      candidate_cost = sampled_cost;
+    }
+  }
+
+  // Response times are only recorded for tracked hosts, which are dropped when they are removed.
+  latencies_.try_emplace(candidate_host->get(), HostLatency{0, now});
+  return *candidate_host;
+}
+
+void PeakEwmaLoadBalancer::onHostResponseTime(const HostDescription& host,
+                                              std::chrono::nanoseconds response_time) {
+  auto it = latencies_.find(&host);
+  if (it == latencies_.end()) {
+    // The host was removed after it was picked.
+    return;
+  }
+
+  HostLatency& latency = it->second;
+  const MonotonicTime now = time_source_.monotonicTime();
+  const double sample = std::max<double>(response_time.count(), 0);
+  if (sample > latency.average_) {
+    latency.average_ = sample;
+  } else {
+    const double weight = decayFactor(now, latency.last_update_);
+    latency.average_ = latency.average_ * weight + sample * (1 - weight);
+  }
+  latency.last_update_ = now;
+}
+
 SubsetSelectorImpl::SubsetSelectorImpl(
     const Protobuf::RepeatedPtrField<std::string>& selector_keys,
     envoy::config::cluster::v3::Cluster::LbSubsetConfig::LbSubsetSelector::
@@ -8,6 +8,7 @@
 #include <vector>
 
 #include "envoy/common/random_generator.h"
+#include "envoy/common/time.h"
 #include "envoy/config/cluster/v3/cluster.pb.h"
 #include "envoy/runtime/runtime.h"
 #include "envoy/upstream/load_balancer.h"
@@ -15,8 +16,11 @@
 
 #include "common/protobuf/utility.h"
 #include "common/runtime/runtime_protos.h"
+#include "common/upstream/alias_scheduler.h"
 #include "common/upstream/edf_scheduler.h"
 
+#include "absl/container/flat_hash_map.h"
+
 namespace Envoy {
 namespace Upstream {
 
@@ -348,6 +352,9 @@ private:
  * could also be done on a thread aware LB, avoiding creating multiple EDF
  * instances.
  *
+ * When the ALIAS weighted host scheduler is configured, an AliasScheduler built from the host
+ * weights replaces EDF, for O(1) weighted random picks at the expense of the round robin order.
+ *
  * This base class also supports unweighted selection which derived classes can use to customize
  * behavior. Derived classes can also override how host weight is determined when in weighted mode.
  */
@@ -367,6 +374,9 @@ protected:
     // host weights of 2 or more hosts differ. When not present, the
     // implementation of chooseHostOnce falls back to unweightedHostPick.
     std::unique_ptr<EdfScheduler<const Host>> edf_;
+    // AliasScheduler for weighted LB, created instead of edf_ with the ALIAS weighted host
+    // scheduler.
+    std::unique_ptr<AliasScheduler<const Host>> alias_;
   };
 
   void initialize();
@@ -385,6 +395,14 @@ private:
   virtual double hostWeight(const Host& host) PURE;
   virtual HostConstSharedPtr unweightedHostPick(const HostVector& hosts_to_use,
                                                 const HostsSource& source) PURE;
+  // Picks a host from the alias table of a host source. By default, this is a single weighted
+  // random pick.
+  virtual HostConstSharedPtr aliasHostPick(const AliasScheduler<const Host>& alias) {
+    return alias.pick(random_.random());
+  }
+
+  const envoy::config::cluster::v3::Cluster::CommonLbConfig::WeightedHostScheduler
+      weighted_host_scheduler_;
 
   // Scheduler for each valid HostsSource.
   absl::node_hash_map<HostsSource, Scheduler, HostsSourceHash> scheduler_;
@@ -441,6 +459,9 @@ private:
  * 2) Use a weighted Maglev table, and perform P2C on two random hosts selected from the table.
  *    The benefit of the Maglev table is at the expense of resolution, memory usage is capped.
  *    Additionally, the Maglev table can be shared amongst all threads.
+ *
+ * With the ALIAS weighted host scheduler, a variant of 2) is used: N hosts are picked from an
+ * alias table of the host weights, and the one with the fewest active requests wins.
  */
 class LeastRequestLoadBalancer : public EdfLoadBalancerBase,
                                  Logger::Loggable<Logger::Id::upstream> {
@@ -512,6 +533,7 @@ private:
   }
   HostConstSharedPtr unweightedHostPick(const HostVector& hosts_to_use,
                                         const HostsSource& source) override;
+  HostConstSharedPtr aliasHostPick(const AliasScheduler<const Host>& alias) override;
 
   const uint32_t choice_count_;
 
@@ -538,6 +560,53 @@ public:
   HostConstSharedPtr chooseHostOnce(LoadBalancerContext* context) override;
 };
 
+/**
+ * Peak EWMA load balancer. Like the least request load balancer, it picks the best of N random
+ * hosts, but it compares their expected latency instead of their active requests. The expected
+ * latency of a host is a peak sensitive exponentially weighted moving average (EWMA) of its
+ * response times, multiplied by its active requests plus one, and divided by its weight. The
+ * average jumps to any response time above it and otherwise decays with time, so that a host which
+ * slows down is avoided right away and tried again gradually. This is the algorithm of Finagle's
+ * P2CPeakEwma load balancer.
+ *
+ * Response times come from the router through onHostResponseTime(). As each worker has its own
+ * load balancer, each worker keeps its own latency averages, without any synchronization.
+ */
+class PeakEwmaLoadBalancer : public ZoneAwareLoadBalancerBase {
+public:
+  PeakEwmaLoadBalancer(
+      const PrioritySet& priority_set, const PrioritySet* local_priority_set, ClusterStats& stats,
+      Runtime::Loader& runtime, Random::RandomGenerator& random, TimeSource& time_source,
+      const envoy::config::cluster::v3::Cluster::CommonLbConfig& common_config,
+      const absl::optional<envoy::config::cluster::v3::Cluster::PeakEwmaLbConfig>&
+          peak_ewma_config);
+
+  // Upstream::LoadBalancerBase
+  HostConstSharedPtr chooseHostOnce(LoadBalancerContext* context) override;
+
+  // Upstream::LoadBalancer
+  void onHostResponseTime(const HostDescription& host,
+                          std::chrono::nanoseconds response_time) override;
+
+private:
+  struct HostLatency {
+    // Moving average of the response times of the host in nanoseconds, or 0 before the first one.
+    double average_;
+    MonotonicTime last_update_;
+  };
+
+  // Returns the share of a moving average last updated at last_update which remains at now.
+  double decayFactor(MonotonicTime now, MonotonicTime last_update) const;
+  // Returns the expected latency of a request sent to host now, divided by its weight.
+  double cost(const Host& host, MonotonicTime now) const;
+
+  TimeSource& time_source_;
+  const uint32_t choice_count_;
+  const double decay_time_ns_;
+  // Latency of each host picked by this load balancer, until it is removed from the cluster.
+  absl::flat_hash_map<const HostDescription*, HostLatency> latencies_;
+};
+
 /**
  * Implementation of SubsetSelector
  */
@@ -2,6 +2,8 @@
 
 #include "envoy/config/cluster/v3/cluster.pb.h"
 
+#include "common/stats/timespan_impl.h"
+
 namespace Envoy {
 namespace Upstream {
 
@@ -24,17 +26,19 @@ MaglevTable::MaglevTable(const NormalizedHostWeightVector& normalized_host_weigh
   // Implementation of pseudocode listing 1 in the paper (see header file for more info).
   std::vector<TableBuildEntry> table_build_entries;
   table_build_entries.reserve(normalized_host_weights.size());
+  hosts_.reserve(normalized_host_weights.size());
   for (const auto& host_weight : normalized_host_weights) {
     const auto& host = host_weight.first;
     const std::string& address =
         use_hostname_for_hashing ? host->hostname() : host->address()->asString();
     ASSERT(!address.empty());
-    table_build_entries.emplace_back(host, HashUtil::xxHash64(address) % table_size_,
+    table_build_entries.emplace_back(hosts_.size(), HashUtil::xxHash64(address) % table_size_,
                                      (HashUtil::xxHash64(address, 1) % (table_size_ - 1)) + 1,
                                      host_weight.second);
+    hosts_.push_back(host);
   }
 
-  table_.resize(table_size_);
+  table_.resize(table_size_, EmptyEntry);
 
   // Iterate through the table build entries as many times as it takes to fill up the table.
   uint64_t table_index = 0;
@@ -50,12 +54,12 @@ MaglevTable::MaglevTable(const NormalizedHostWeightVector& normalized_host_weigh
       }
       entry.target_weight_ += max_normalized_weight;
       uint64_t c = permutation(entry);
-      while (table_[c] != nullptr) {
+      while (table_[c] != EmptyEntry) {
         entry.next_++;
         c = permutation(entry);
       }
 
-      table_[c] = entry.host_;
+      table_[c] = entry.host_index_;
       entry.next_++;
       entry.count_++;
       table_index++;
@@ -73,9 +77,9 @@ MaglevTable::MaglevTable(const NormalizedHostWeightVector& normalized_host_weigh
 
   if (ENVOY_LOG_CHECK_LEVEL(trace)) {
     for (uint64_t i = 0; i < table_.size(); i++) {
+      const auto& host = hosts_[table_[i]];
       ENVOY_LOG(trace, "maglev: i={} host={}", i,
-                use_hostname_for_hashing ? table_[i]->hostname()
-                                         : table_[i]->address()->asString());
+                use_hostname_for_hashing ? host->hostname() : host->address()->asString());
     }
   }
 }
@@ -92,7 +96,7 @@ HostConstSharedPtr MaglevTable::chooseHost(uint64_t hash, uint32_t attempt) cons
     hash ^= ~0ULL - attempt + 1;
   }
 
-  return table_[hash % table_size_];
+  return hosts_[table_[hash % table_size_]];
 }
 
 uint64_t MaglevTable::permutation(const TableBuildEntry& entry) {
@@ -101,7 +105,7 @@ uint64_t MaglevTable::permutation(const TableBuildEntry& entry) {
 
 MaglevLoadBalancer::MaglevLoadBalancer(
     const PrioritySet& priority_set, ClusterStats& stats, Stats::Scope& scope,
-    Runtime::Loader& runtime, Random::RandomGenerator& random,
+    Runtime::Loader& runtime, Random::RandomGenerator& random, TimeSource& time_source,
     const envoy::config::cluster::v3::Cluster::CommonLbConfig& common_config, uint64_t table_size)
     : ThreadAwareLoadBalancerBase(priority_set, stats, runtime, random, common_config),
       scope_(scope.createScope("maglev_lb.")), stats_(generateStats(*scope_)),
@@ -109,10 +113,22 @@ MaglevLoadBalancer::MaglevLoadBalancer(
       use_hostname_for_hashing_(
           common_config.has_consistent_hashing_lb_config()
               ? common_config.consistent_hashing_lb_config().use_hostname_for_hashing()
-              : false) {}
+              : false),
+      time_source_(time_source) {}
 
 MaglevLoadBalancerStats MaglevLoadBalancer::generateStats(Stats::Scope& scope) {
-  return {ALL_MAGLEV_LOAD_BALANCER_STATS(POOL_GAUGE(scope))};
+  return {ALL_MAGLEV_LOAD_BALANCER_STATS(POOL_GAUGE(scope), POOL_HISTOGRAM(scope))};
+}
+
+ThreadAwareLoadBalancerBase::HashingLoadBalancerSharedPtr
+MaglevLoadBalancer::createLoadBalancer(uint32_t,
+                                       const NormalizedHostWeightVector& normalized_host_weights,
+                                       double, double max_normalized_weight) {
+  Stats::HistogramCompletableTimespanImpl build_time(stats_.build_time_us_, time_source_);
+  auto table = std::make_shared<MaglevTable>(normalized_host_weights, max_normalized_weight,
+                                             table_size_, use_hostname_for_hashing_, stats_);
+  build_time.complete();
+  return table;
 }
 
 } // namespace Upstream
@@ -1,6 +1,9 @@
 #pragma once
 
+#include <limits>
+
 #include "envoy/common/random_generator.h"
+#include "envoy/common/time.h"
 #include "envoy/config/cluster/v3/cluster.pb.h"
 #include "envoy/stats/scope.h"
 #include "envoy/stats/stats_macros.h"
@@ -14,15 +17,16 @@ namespace Upstream {
 /**
  * All Maglev load balancer stats. @see stats_macros.h
  */
-#define ALL_MAGLEV_LOAD_BALANCER_STATS(GAUGE)                                                      \
+#define ALL_MAGLEV_LOAD_BALANCER_STATS(GAUGE, HISTOGRAM)                                           \
   GAUGE(max_entries_per_host, Accumulate)                                                          \
-  GAUGE(min_entries_per_host, Accumulate)
+  GAUGE(min_entries_per_host, Accumulate)                                                          \
+  HISTOGRAM(build_time_us, Microseconds)
 
 /**
  * Struct definition for all Maglev load balancer stats. @see stats_macros.h
  */
 struct MaglevLoadBalancerStats {
-  ALL_MAGLEV_LOAD_BALANCER_STATS(GENERATE_GAUGE_STRUCT)
+  ALL_MAGLEV_LOAD_BALANCER_STATS(GENERATE_GAUGE_STRUCT, GENERATE_HISTOGRAM_STRUCT)
 };
 
 /**
@@ -30,6 +34,8 @@ struct MaglevLoadBalancerStats {
  * https://static.googleusercontent.com/media/research.google.com/en//pubs/archive/44824.pdf
  * section 3.4. Specifically, the algorithm shown in pseudocode listing 1 is implemented with a
  * fixed table size of 65537. This is the recommended table size in section 5.3.
+ * The table holds host indices rather than hosts, which makes it a quarter of the size and avoids a
+ * reference count update per entry when tables are built and destroyed.
  */
 class MaglevTable : public ThreadAwareLoadBalancerBase::HashingLoadBalancer,
                     Logger::Loggable<Logger::Id::upstream> {
@@ -46,10 +52,10 @@ public:
 
 private:
   struct TableBuildEntry {
-    TableBuildEntry(const HostConstSharedPtr& host, uint64_t offset, uint64_t skip, double weight)
-        : host_(host), offset_(offset), skip_(skip), weight_(weight) {}
+    TableBuildEntry(uint32_t host_index, uint64_t offset, uint64_t skip, double weight)
+        : host_index_(host_index), offset_(offset), skip_(skip), weight_(weight) {}
 
-    HostConstSharedPtr host_;
+    const uint32_t host_index_;
     const uint64_t offset_;
     const uint64_t skip_;
     const double weight_;
@@ -60,8 +66,13 @@ private:
 
   uint64_t permutation(const TableBuildEntry& entry);
 
+  // Marks table entries which aren't filled yet.
+  static constexpr uint32_t EmptyEntry = std::numeric_limits<uint32_t>::max();
+
   const uint64_t table_size_;
-  std::vector<HostConstSharedPtr> table_;
+  std::vector<HostConstSharedPtr> hosts_;
+  // Index in hosts_ of the host of each entry.
+  std::vector<uint32_t> table_;
   MaglevLoadBalancerStats& stats_;
 };
 
@@ -72,6 +83,7 @@ class MaglevLoadBalancer : public ThreadAwareLoadBalancerBase {
 public:
   MaglevLoadBalancer(const PrioritySet& priority_set, ClusterStats& stats, Stats::Scope& scope,
                      Runtime::Loader& runtime, Random::RandomGenerator& random,
+                     TimeSource& time_source,
                      const envoy::config::cluster::v3::Cluster::CommonLbConfig& common_config,
                      uint64_t table_size = MaglevTable::DefaultTableSize);
 
@@ -80,11 +92,8 @@ public:
 private:
   // ThreadAwareLoadBalancerBase
   HashingLoadBalancerSharedPtr
-  createLoadBalancer(const NormalizedHostWeightVector& normalized_host_weights,
-                     double /* min_normalized_weight */, double max_normalized_weight) override {
-    return std::make_shared<MaglevTable>(normalized_host_weights, max_normalized_weight,
-                                         table_size_, use_hostname_for_hashing_, stats_);
-  }
+  createLoadBalancer(uint32_t priority, const NormalizedHostWeightVector& normalized_host_weights,
+                     double /* min_normalized_weight */, double max_normalized_weight) override;
 
   static MaglevLoadBalancerStats generateStats(Stats::Scope& scope);
 
@@ -92,6 +101,7 @@ private:
   MaglevLoadBalancerStats stats_;
   const uint64_t table_size_;
   const bool use_hostname_for_hashing_;
+  TimeSource& time_source_;
 };
 
 } // namespace Upstream
@@ -8,6 +8,7 @@
 #include "envoy/config/cluster/v3/cluster.pb.h"
 
 #include "common/common/assert.h"
+#include "common/stats/timespan_impl.h"
 #include "common/upstream/load_balancer_impl.h"
 
 #include "absl/container/inlined_vector.h"
@@ -18,7 +19,7 @@ namespace Upstream {
 
 RingHashLoadBalancer::RingHashLoadBalancer(
     const PrioritySet& priority_set, ClusterStats& stats, Stats::Scope& scope,
-    Runtime::Loader& runtime, Random::RandomGenerator& random,
+    Runtime::Loader& runtime, Random::RandomGenerator& random, TimeSource& time_source,
     const absl::optional<envoy::config::cluster::v3::Cluster::RingHashLbConfig>& config,
     const envoy::config::cluster::v3::Cluster::CommonLbConfig& common_config)
     : ThreadAwareLoadBalancerBase(priority_set, stats, runtime, random, common_config),
@@ -34,7 +35,8 @@ RingHashLoadBalancer::RingHashLoadBalancer(
       use_hostname_for_hashing_(
           common_config.has_consistent_hashing_lb_config()
               ? common_config.consistent_hashing_lb_config().use_hostname_for_hashing()
-              : false) {
+              : false),
+      time_source_(time_source) {
   // It's important to do any config validation here, rather than deferring to Ring's ctor,
   // because any exceptions thrown here will be caught and handled properly.
   if (min_ring_size_ > max_ring_size_) {
@@ -44,7 +46,22 @@ RingHashLoadBalancer::RingHashLoadBalancer(
 }
 
 RingHashLoadBalancerStats RingHashLoadBalancer::generateStats(Stats::Scope& scope) {
-  return {ALL_RING_HASH_LOAD_BALANCER_STATS(POOL_GAUGE(scope))};
+  return {ALL_RING_HASH_LOAD_BALANCER_STATS(POOL_GAUGE(scope), POOL_HISTOGRAM(scope))};
+}
+
+ThreadAwareLoadBalancerBase::HashingLoadBalancerSharedPtr
+RingHashLoadBalancer::createLoadBalancer(uint32_t priority,
+                                         const NormalizedHostWeightVector& normalized_host_weights,
+                                         double min_normalized_weight, double) {
+  if (priority >= hash_caches_.size()) {
+    hash_caches_.resize(priority + 1);
+  }
+  Stats::HistogramCompletableTimespanImpl build_time(stats_.build_time_us_, time_source_);
+  auto ring = std::make_shared<Ring>(normalized_host_weights, min_normalized_weight,
+                                     min_ring_size_, max_ring_size_, hash_function_,
+                                     use_hostname_for_hashing_, hash_caches_[priority], stats_);
+  build_time.complete();
+  return ring;
 }
 
 HostConstSharedPtr RingHashLoadBalancer::Ring::chooseHost(uint64_t h, uint32_t attempt) const {
@@ -93,19 +110,21 @@ HostConstSharedPtr RingHashLoadBalancer::Ring::chooseHost(uint64_t h, uint32_t a
     midp = (midp + attempt) % ring_.size();
   }
 
-  return ring_[midp].host_;
+  return hosts_[ring_[midp].host_index_];
 }
 
 using HashFunction = envoy::config::cluster::v3::Cluster::RingHashLbConfig::HashFunction;
 RingHashLoadBalancer::Ring::Ring(const NormalizedHostWeightVector& normalized_host_weights,
                                  double min_normalized_weight, uint64_t min_ring_size,
                                  uint64_t max_ring_size, HashFunction hash_function,
-                                 bool use_hostname_for_hashing, RingHashLoadBalancerStats& stats)
+                                 bool use_hostname_for_hashing, HashCache& hash_cache,
+                                 RingHashLoadBalancerStats& stats)
     : stats_(stats) {
   ENVOY_LOG(trace, "ring hash: building ring");
 
   // We can't do anything sensible with no hosts.
   if (normalized_host_weights.empty()) {
+    hash_cache.clear();
     return;
   }
 
@@ -140,7 +159,14 @@ RingHashLoadBalancer::Ring::Ring(const NormalizedHostWeightVector& normalized_ho
   // Users should hopefully pay attention to these numbers and alert if min_hashes_per_host is too
   // low, since that implies an inaccurate request distribution.
 
+  //
+  // The hashes of each host only depend on its address (or hostname) and index, so they are kept in
+  // hash_cache across builds, and only the hashes missing from it are computed.
+
   absl::InlinedVector<char, 196> hash_key_buffer;
+  HashCache next_hash_cache;
+  next_hash_cache.reserve(normalized_host_weights.size());
+  hosts_.reserve(normalized_host_weights.size());
   double current_hashes = 0.0;
   double target_hashes = 0.0;
   uint64_t min_hashes_per_host = ring_size;
@@ -150,45 +176,61 @@ RingHashLoadBalancer::Ring::Ring(const NormalizedHostWeightVector& normalized_ho
     const std::string& address_string =
         use_hostname_for_hashing ? host->hostname() : host->address()->asString();
     ASSERT(!address_string.empty());
+    const uint32_t host_index = hosts_.size();
+    hosts_.push_back(host);
+
+    // Hosts may share an address, in which case they share hashes too.
+    std::vector<uint64_t>& hashes = next_hash_cache[address_string];
+    if (hashes.empty()) {
+      const auto cached = hash_cache.find(address_string);
+      if (cached != hash_cache.end()) {
+        hashes = std::move(cached->second);
+      }
+    }
 
     hash_key_buffer.assign(address_string.begin(), address_string.end());
     hash_key_buffer.emplace_back('_');
-    auto offset_start = hash_key_buffer.end();
+    const size_t offset_start = hash_key_buffer.size();
 
     // As noted above: maintain current_hashes and target_hashes as running sums across the entire
     // host set. `i` is needed only to construct the hash key, and tally min/max hashes per host.
     target_hashes += scale * entry.second;
     uint64_t i = 0;
     while (current_hashes < target_hashes) {
-      const std::string i_str = absl::StrCat("", i);
-      hash_key_buffer.insert(offset_start, i_str.begin(), i_str.end());
-
-      absl::string_view hash_key(static_cast<char*>(hash_key_buffer.data()),
-                                 hash_key_buffer.size());
-
-      const uint64_t hash =
-          (hash_function == HashFunction::Cluster_RingHashLbConfig_HashFunction_MURMUR_HASH_2)
-              ? MurmurHash::murmurHash2(hash_key, MurmurHash::STD_HASH_SEED)
-              : HashUtil::xxHash64(hash_key);
-
-      ENVOY_LOG(trace, "ring hash: hash_key={} hash={}", hash_key.data(), hash);
-      ring_.push_back({hash, host});
+      if (i == hashes.size()) {
+        const std::string i_str = absl::StrCat("", i);
+        hash_key_buffer.insert(hash_key_buffer.end(), i_str.begin(), i_str.end());
+
+        absl::string_view hash_key(static_cast<char*>(hash_key_buffer.data()),
+                                   hash_key_buffer.size());
+
+        const uint64_t hash =
+            (hash_function == HashFunction::Cluster_RingHashLbConfig_HashFunction_MURMUR_HASH_2)
+                ? MurmurHash::murmurHash2(hash_key, MurmurHash::STD_HASH_SEED)
+                : HashUtil::xxHash64(hash_key);
+
+        ENVOY_LOG(trace, "ring hash: hash_key={} hash={}", hash_key, hash);
+        hashes.push_back(hash);
+        hash_key_buffer.resize(offset_start);
+      }
+      ring_.push_back({hashes[i], host_index});
       ++i;
       ++current_hashes;
-      hash_key_buffer.erase(offset_start, hash_key_buffer.end());
     }
     min_hashes_per_host = std::min(i, min_hashes_per_host);
     max_hashes_per_host = std::max(i, max_hashes_per_host);
   }
+  // Drop the hashes of hosts which are gone.
+  hash_cache.swap(next_hash_cache);
 
   std::sort(ring_.begin(), ring_.end(), [](const RingEntry& lhs, const RingEntry& rhs) -> bool {
     return lhs.hash_ < rhs.hash_;
   });
   if (ENVOY_LOG_CHECK_LEVEL(trace)) {
     for (const auto& entry : ring_) {
+      const auto& host = hosts_[entry.host_index_];
       ENVOY_LOG(trace, "ring hash: host={} hash={}",
-                use_hostname_for_hashing ? entry.host_->hostname()
-                                         : entry.host_->address()->asString(),
+                use_hostname_for_hashing ? host->hostname() : host->address()->asString(),
                 entry.hash_);
     }
   }
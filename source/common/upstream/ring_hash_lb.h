@@ -2,6 +2,7 @@
 
 #include <vector>
 
+#include "envoy/common/time.h"
 #include "envoy/config/cluster/v3/cluster.pb.h"
 #include "envoy/runtime/runtime.h"
 #include "envoy/stats/scope.h"
@@ -10,22 +11,25 @@
 #include "common/common/logger.h"
 #include "common/upstream/thread_aware_lb_impl.h"
 
+#include "absl/container/flat_hash_map.h"
+
 namespace Envoy {
 namespace Upstream {
 
 /**
  * All ring hash load balancer stats. @see stats_macros.h
  */
-#define ALL_RING_HASH_LOAD_BALANCER_STATS(GAUGE)                                                   \
+#define ALL_RING_HASH_LOAD_BALANCER_STATS(GAUGE, HISTOGRAM)                                        \
   GAUGE(max_hashes_per_host, Accumulate)                                                           \
   GAUGE(min_hashes_per_host, Accumulate)                                                           \
-  GAUGE(size, Accumulate)
+  GAUGE(size, Accumulate)                                                                          \
+  HISTOGRAM(build_time_us, Microseconds)
 
 /**
  * Struct definition for all ring hash load balancer stats. @see stats_macros.h
  */
 struct RingHashLoadBalancerStats {
-  ALL_RING_HASH_LOAD_BALANCER_STATS(GENERATE_GAUGE_STRUCT)
+  ALL_RING_HASH_LOAD_BALANCER_STATS(GENERATE_GAUGE_STRUCT, GENERATE_HISTOGRAM_STRUCT)
 };
 
 /**
@@ -42,7 +46,7 @@ class RingHashLoadBalancer : public ThreadAwareLoadBalancerBase,
 public:
   RingHashLoadBalancer(
       const PrioritySet& priority_set, ClusterStats& stats, Stats::Scope& scope,
-      Runtime::Loader& runtime, Random::RandomGenerator& random,
+      Runtime::Loader& runtime, Random::RandomGenerator& random, TimeSource& time_source,
       const absl::optional<envoy::config::cluster::v3::Cluster::RingHashLbConfig>& config,
       const envoy::config::cluster::v3::Cluster::CommonLbConfig& common_config);
 
@@ -51,19 +55,26 @@ public:
 private:
   using HashFunction = envoy::config::cluster::v3::Cluster::RingHashLbConfig::HashFunction;
 
+  // Ring hashes of each host, in the order they are generated, by the key hosts are hashed by. Kept
+  // across ring builds, so that a rebuild only hashes added hosts and hosts given more hashes.
+  using HashCache = absl::flat_hash_map<std::string, std::vector<uint64_t>>;
+
   struct RingEntry {
     uint64_t hash_;
-    HostConstSharedPtr host_;
+    // Index in Ring::hosts_. Storing it rather than the host keeps entries small and avoids a
+    // reference count update per entry when rings are built and destroyed.
+    uint32_t host_index_;
   };
 
   struct Ring : public HashingLoadBalancer {
     Ring(const NormalizedHostWeightVector& normalized_host_weights, double min_normalized_weight,
          uint64_t min_ring_size, uint64_t max_ring_size, HashFunction hash_function,
-         bool use_hostname_for_hashing, RingHashLoadBalancerStats& stats);
+         bool use_hostname_for_hashing, HashCache& hash_cache, RingHashLoadBalancerStats& stats);
 
     // ThreadAwareLoadBalancerBase::HashingLoadBalancer
     HostConstSharedPtr chooseHost(uint64_t hash, uint32_t attempt) const override;
 
+    std::vector<HostConstSharedPtr> hosts_;
     std::vector<RingEntry> ring_;
 
     RingHashLoadBalancerStats& stats_;
@@ -72,12 +83,8 @@ private:
 
   // ThreadAwareLoadBalancerBase
   HashingLoadBalancerSharedPtr
-  createLoadBalancer(const NormalizedHostWeightVector& normalized_host_weights,
-                     double min_normalized_weight, double /* max_normalized_weight */) override {
-    return std::make_shared<Ring>(normalized_host_weights, min_normalized_weight, min_ring_size_,
-                                  max_ring_size_, hash_function_, use_hostname_for_hashing_,
-                                  stats_);
-  }
+  createLoadBalancer(uint32_t priority, const NormalizedHostWeightVector& normalized_host_weights,
+                     double min_normalized_weight, double /* max_normalized_weight */) override;
 
   static RingHashLoadBalancerStats generateStats(Stats::Scope& scope);
 
@@ -90,6 +97,9 @@ private:
   const uint64_t max_ring_size_;
   const HashFunction hash_function_;
   const bool use_hostname_for_hashing_;
+  TimeSource& time_source_;
+  // Hash cache of each priority. Only used on the main thread, where rings are built.
+  std::vector<HashCache> hash_caches_;
 };
 
 } // namespace Upstream
@@ -1,6 +1,8 @@
 #include "common/upstream/thread_aware_lb_impl.h"
 
+#include <cmath>
 #include <memory>
+#include <numeric>
 
 namespace Envoy {
 namespace Upstream {
@@ -122,7 +124,12 @@ void ThreadAwareLoadBalancerBase::refresh() {
     normalizeWeights(*host_set, per_priority_state->global_panic_, normalized_host_weights,
                      min_normalized_weight, max_normalized_weight);
     per_priority_state->current_lb_ =
-        createLoadBalancer(normalized_host_weights, min_normalized_weight, max_normalized_weight);
+        createLoadBalancer(priority, normalized_host_weights, min_normalized_weight,
+                           max_normalized_weight);
+    if (hash_balance_factor_ != 0) {
+      per_priority_state->current_lb_ = std::make_shared<BoundedLoadHashingLoadBalancer>(
+          per_priority_state->current_lb_, normalized_host_weights, hash_balance_factor_);
+    }
   }
 
   {
@@ -185,5 +192,69 @@ LoadBalancerPtr ThreadAwareLoadBalancerBase::LoadBalancerFactoryImpl::create() {
   return lb;
 }
 
+BoundedLoadHashingLoadBalancer::BoundedLoadHashingLoadBalancer(
+    ThreadAwareLoadBalancerBase::HashingLoadBalancerSharedPtr hashing_lb,
+    const NormalizedHostWeightVector& normalized_host_weights, uint32_t hash_balance_factor)
+    : hashing_lb_(std::move(hashing_lb)), normalized_host_weights_(normalized_host_weights),
+      balance_factor_(hash_balance_factor / 100.0) {
+  ASSERT(hash_balance_factor >= 100);
+  host_weights_.reserve(normalized_host_weights_.size());
+  for (const auto& entry : normalized_host_weights_) {
+    host_weights_.emplace(entry.first.get(), entry.second);
+  }
+}
+
+double BoundedLoadHashingLoadBalancer::loadRatio(const Host& host, double weight,
+                                                 uint64_t cluster_active) const {
+  // Count the request being placed, so that an idle cluster still has room on every host.
+  const double bound = std::max(std::ceil(balance_factor_ * (cluster_active + 1) * weight), 1.0);
+  return host.stats().rq_active_.value() / bound;
+}
+
+HostConstSharedPtr BoundedLoadHashingLoadBalancer::chooseHost(uint64_t hash,
+                                                              uint32_t attempt) const {
+  HostConstSharedPtr host = hashing_lb_->chooseHost(hash, attempt);
+  if (host == nullptr) {
+    return nullptr;
+  }
+  const auto weight = host_weights_.find(host.get());
+  ASSERT(weight != host_weights_.end());
+  const uint64_t cluster_active = host->cluster().stats().upstream_rq_active_.value();
+  double least_ratio = loadRatio(*host, weight->second, cluster_active);
+  if (least_ratio < 1.0) {
+    return host;
+  }
+
+  // Probe every other host once, starting at an offset and stepping by a stride coprime with the
+  // number of hosts, both taken from the hash. This visits the hosts in a different order for
+  // different keys, without allocating a permutation for each request.
+  const uint64_t num_hosts = normalized_host_weights_.size();
+  const uint64_t probe_hash = hash * 0x9e3779b97f4a7c15;
+  uint64_t index = (probe_hash >> 32) % num_hosts;
+  uint64_t stride = num_hosts > 1 ? 1 + (probe_hash & 0xffffffff) % (num_hosts - 1) : 1;
+  while (std::gcd(stride, num_hosts) != 1) {
+    ++stride;
+  }
+
+  HostConstSharedPtr least_loaded = host;
+  for (uint64_t i = 0; i < num_hosts; ++i, index = (index + stride) % num_hosts) {
+    const auto& candidate = normalized_host_weights_[index];
+    if (candidate.first == host) {
+      continue;
+    }
+    const double ratio = loadRatio(*candidate.first, candidate.second, cluster_active);
+    if (ratio < 1.0) {
+      return candidate.first;
+    }
+    if (ratio < least_ratio) {
+      least_ratio = ratio;
+      least_loaded = candidate.first;
+    }
+  }
+
+  // Every host is at its bound, which can only happen briefly as requests complete.
+  return least_loaded;
+}
+
 } // namespace Upstream
 } // namespace Envoy
@@ -4,6 +4,7 @@
 
 #include "common/upstream/load_balancer_impl.h"
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/synchronization/mutex.h"
 
 namespace Envoy {
@@ -43,7 +44,9 @@ protected:
       Random::RandomGenerator& random,
       const envoy::config::cluster::v3::Cluster::CommonLbConfig& common_config)
       : LoadBalancerBase(priority_set, stats, runtime, random, common_config),
-        factory_(new LoadBalancerFactoryImpl(stats, random)) {}
+        factory_(new LoadBalancerFactoryImpl(stats, random)),
+        hash_balance_factor_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(
+            common_config.consistent_hashing_lb_config(), hash_balance_factor, 0)) {}
 
 private:
   struct PerPriorityState {
@@ -83,11 +86,41 @@ private:
   };
 
   virtual HashingLoadBalancerSharedPtr
-  createLoadBalancer(const NormalizedHostWeightVector& normalized_host_weights,
+  createLoadBalancer(uint32_t priority, const NormalizedHostWeightVector& normalized_host_weights,
                      double min_normalized_weight, double max_normalized_weight) PURE;
   void refresh();
 
   std::shared_ptr<LoadBalancerFactoryImpl> factory_;
+  // Zero if host loads aren't bounded.
+  const uint32_t hash_balance_factor_;
+};
+
+/**
+ * Consistent hashing with bounded loads, as described in https://arxiv.org/abs/1608.01350. Wraps a
+ * hashing load balancer, and only returns the host it chooses if that host's active requests are
+ * below hash_balance_factor percent of its weighted share of the cluster's active requests.
+ * Otherwise the other hosts are probed, in an order derived from the hash, for one below its bound.
+ * Deriving the order from the hash keeps the overflow of a hot key on the same few hosts, and
+ * spreads the overflow of different keys over different hosts rather than cascading it onto the
+ * overloaded host's neighbors.
+ */
+class BoundedLoadHashingLoadBalancer : public ThreadAwareLoadBalancerBase::HashingLoadBalancer {
+public:
+  BoundedLoadHashingLoadBalancer(
+      ThreadAwareLoadBalancerBase::HashingLoadBalancerSharedPtr hashing_lb,
+      const NormalizedHostWeightVector& normalized_host_weights, uint32_t hash_balance_factor);
+
+  // ThreadAwareLoadBalancerBase::HashingLoadBalancer
+  HostConstSharedPtr chooseHost(uint64_t hash, uint32_t attempt) const override;
+
+private:
+  // @return the host's active requests relative to its bound. Hosts below 1.0 can take a request.
+  double loadRatio(const Host& host, double weight, uint64_t cluster_active) const;
+
+  const ThreadAwareLoadBalancerBase::HashingLoadBalancerSharedPtr hashing_lb_;
+  const NormalizedHostWeightVector normalized_host_weights_;
+  absl::flat_hash_map<const Host*, double> host_weights_;
+  const double balance_factor_;
 };
 
 } // namespace Upstream
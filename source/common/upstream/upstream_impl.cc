@@ -706,6 +706,7 @@ ClusterInfoImpl::ClusterInfoImpl(
       maintenance_mode_runtime_key_(absl::StrCat("upstream.maintenance_mode.", name_)),
       source_address_(getSourceAddress(config, bind_config)),
       lb_least_request_config_(config.least_request_lb_config()),
+      lb_peak_ewma_config_(config.peak_ewma_lb_config()),
       lb_ring_hash_config_(config.ring_hash_lb_config()),
       lb_original_dst_config_(config.original_dst_lb_config()),
       upstream_config_(config.has_upstream_config()
@@ -773,6 +774,17 @@ ClusterInfoImpl::ClusterInfoImpl(
 
     lb_type_ = LoadBalancerType::ClusterProvided;
     break;
+  case envoy::config::cluster::v3::Cluster::PEAK_EWMA:
+    // Response times are reported to the cluster's load balancer, which doesn't know which subset
+    // load balancer picked the host.
+    if (config.has_lb_subset_config()) {
+      throw EnvoyException(
+          fmt::format("cluster: LB policy {} cannot be combined with lb_subset_config",
+                      envoy::config::cluster::v3::Cluster::LbPolicy_Name(config.lb_policy())));
+    }
+
+    lb_type_ = LoadBalancerType::PeakEwma;
+    break;
   default:
     NOT_REACHED_GCOVR_EXCL_LINE;
   }
@@ -1345,7 +1357,8 @@ bool BaseDynamicClusterImpl::updateDynamicHostList(const HostVector& new_hosts,
   // endpoint has materially changed (e.g. if previously failing active health
   // checks, we just note it's now failing EDS health status but don't rebuild).
   //
-  // Likewise, if metadata for an endpoint changed we rebuild the hosts vectors.
+  // Likewise, if metadata for an endpoint changed we rebuild the hosts vectors, as we do if its
+  // weight changed and the load balancer builds alias tables from the weights.
   //
   // TODO(htuch): We can be smarter about this potentially, and not force a full
   // host set update on health status change. The way this would work is to
@@ -1431,7 +1444,16 @@ bool BaseDynamicClusterImpl::updateDynamicHostList(const HostVector& new_hosts,
         hosts_added_to_current_priority.emplace_back(existing_host->second);
       }
 
-      existing_host->second->weight(host->weight());
+      // Did the weight change? Alias tables are built from the host weights when the host set
+      // changes, so the load balancers must rebuild them to pick up the new weight.
+      if (host->weight() != existing_host->second->weight()) {
+        existing_host->second->weight(host->weight());
+        if (info_->lbConfig().weighted_host_scheduler() ==
+            envoy::config::cluster::v3::Cluster::CommonLbConfig::ALIAS) {
+          hosts_changed = true;
+        }
+      }
+
       final_hosts.push_back(existing_host->second);
       updated_hosts[existing_host->second->address()->asString()] = existing_host->second;
     } else {
@@ -1521,10 +1543,10 @@ bool BaseDynamicClusterImpl::updateDynamicHostList(const HostVector& new_hosts,
   // During the update we populated final_hosts with all the hosts that should remain
   // in the current priority, so move them back into current_priority_hosts.
   current_priority_hosts = std::move(final_hosts);
-  // We return false here in the absence of EDS health status or metadata changes, because we
-  // have no changes to host vector status (modulo weights). When we have EDS
-  // health status or metadata changed, we return true, causing updateHosts() to fire in the
-  // caller.
+  // We return false here in the absence of EDS health status, metadata or alias table weight
+  // changes, because we have no changes to host vector status (modulo weights). When we have EDS
+  // health status, metadata or such weights changed, we return true, causing updateHosts() to fire
+  // in the caller.
   return hosts_changed;
 }
 
@@ -43,6 +43,19 @@ Runtime::LoaderPtr ProdComponentFactory::createRuntime(Server::Instance& server,
   return Server::InstanceUtil::createRuntime(server, config);
 }
 
+namespace {
+
+Stats::SharedMemoryStatsRegionPtr makeStatsSharedMemoryRegion(const Server::Options& options) {
+  // Validation doesn't run the server, so it has no stats to export.
+  if (options.statsSharedMemoryPath().empty() || options.mode() == Server::Mode::Validate) {
+    return nullptr;
+  }
+  return std::make_unique<Stats::SharedMemoryStatsRegion>(options.statsSharedMemoryPath(),
+                                                          options.statsSharedMemoryMaxStats());
+}
+
+} // namespace
+
 MainCommonBase::MainCommonBase(const OptionsImpl& options, Event::TimeSystem& time_system,
                                ListenerHooks& listener_hooks,
                                Server::ComponentFactory& component_factory,
@@ -53,7 +66,8 @@ MainCommonBase::MainCommonBase(const OptionsImpl& options, Event::TimeSystem& ti
     : options_(options), component_factory_(component_factory), thread_factory_(thread_factory),
       file_system_(file_system), symbol_table_(Stats::SymbolTableCreator::initAndMakeSymbolTable(
                                      options_.fakeSymbolTableEnabled())),
-      stats_allocator_(*symbol_table_) {
+      stats_shared_memory_region_(makeStatsSharedMemoryRegion(options_)),
+      stats_allocator_(*symbol_table_, stats_shared_memory_region_.get()) {
   // Process the option to disable extensions as early as possible,
   // before we do any configuration loading.
   OptionsImpl::disableExtensions(options.disabledExtensions());
@@ -7,6 +7,7 @@
 #include "common/event/real_time_system.h"
 #include "common/grpc/google_grpc_context.h"
 #include "common/stats/fake_symbol_table_impl.h"
+#include "common/stats/shared_memory_stats.h"
 #include "common/stats/thread_local_store.h"
 #include "common/thread_local/thread_local_impl.h"
 
@@ -76,6 +77,8 @@ protected:
   Thread::ThreadFactory& thread_factory_;
   Filesystem::Instance& file_system_;
   Stats::SymbolTablePtr symbol_table_;
+  // Outlives the allocator, as the values of stats may be placed in it.
+  Stats::SharedMemoryStatsRegionPtr stats_shared_memory_region_;
   Stats::AllocatorImpl stats_allocator_;
 
   ThreadLocal::InstanceImplPtr tls_;
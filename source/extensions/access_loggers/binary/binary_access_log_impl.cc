@@ -0,0 +1,54 @@
+#include "extensions/access_loggers/binary/binary_access_log_impl.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace AccessLoggers {
+namespace Binary {
+
+using ConfigProto = envoy::extensions::access_loggers::binary::v3::BinaryAccessLog;
+
+static_assert(static_cast<int>(FieldType::StartTime) == ConfigProto::START_TIME,
+              "FieldType must match the Field enum of the config");
+static_assert(static_cast<int>(FieldType::RouteName) == ConfigProto::ROUTE_NAME,
+              "FieldType must match the Field enum of the config");
+static_assert(static_cast<int>(FieldType::RequestHeader) > ConfigProto::Field_MAX,
+              "Header field types must not collide with the Field enum of the config");
+
+BinaryAccessLog::BinaryAccessLog(
+    const envoy::extensions::access_loggers::binary::v3::BinaryAccessLog& config,
+    AccessLog::FilterPtr&& filter, AccessLog::AccessLogManager& log_manager)
+    : ImplBase(std::move(filter)), encoder_(schemaFromConfig(config)),
+      log_file_(log_manager.createAccessLog(config.path())) {
+  // Every logger adds its schema, as loggers with different schemas may share the file. As a
+  // header it is written once ahead of the entries, and again whenever the file is reopened.
+  log_file_->addHeader(encoder_.schemaId(), encoder_.schemaRecord());
+}
+
+Schema BinaryAccessLog::schemaFromConfig(
+    const envoy::extensions::access_loggers::binary::v3::BinaryAccessLog& config) {
+  Schema schema;
+  for (const int field : config.fields()) {
+    schema.push_back({static_cast<FieldType>(field)});
+  }
+  for (const std::string& header : config.request_headers()) {
+    schema.push_back({FieldType::RequestHeader, Http::LowerCaseString(header)});
+  }
+  for (const std::string& header : config.response_headers()) {
+    schema.push_back({FieldType::ResponseHeader, Http::LowerCaseString(header)});
+  }
+  return schema;
+}
+
+void BinaryAccessLog::emitLog(const Http::RequestHeaderMap& request_headers,
+                              const Http::ResponseHeaderMap& response_headers,
+                              const Http::ResponseTrailerMap&,
+                              const StreamInfo::StreamInfo& stream_info) {
+  RecordEncoder::Buffer record;
+  encoder_.encodeEntry(request_headers, response_headers, stream_info, record);
+  log_file_->write(absl::string_view(record.data(), record.size()));
+}
+
+} // namespace Binary
+} // namespace AccessLoggers
+} // namespace Extensions
+} // namespace Envoy
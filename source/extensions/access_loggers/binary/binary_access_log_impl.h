@@ -0,0 +1,44 @@
+#pragma once
+
+#include <string>
+
+#include "envoy/access_log/access_log.h"
+#include "envoy/extensions/access_loggers/binary/v3/binary.pb.h"
+
+#include "extensions/access_loggers/binary/binary_log_format.h"
+#include "extensions/access_loggers/common/access_log_base.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace AccessLoggers {
+namespace Binary {
+
+/**
+ * Access log Instance that writes binary records to a file.
+ */
+class BinaryAccessLog : public Common::ImplBase {
+public:
+  BinaryAccessLog(const envoy::extensions::access_loggers::binary::v3::BinaryAccessLog& config,
+                  AccessLog::FilterPtr&& filter, AccessLog::AccessLogManager& log_manager);
+
+  /**
+   * @return the schema of the records logged for config.
+   */
+  static Schema
+  schemaFromConfig(const envoy::extensions::access_loggers::binary::v3::BinaryAccessLog& config);
+
+private:
+  // Common::ImplBase
+  void emitLog(const Http::RequestHeaderMap& request_headers,
+               const Http::ResponseHeaderMap& response_headers,
+               const Http::ResponseTrailerMap& response_trailers,
+               const StreamInfo::StreamInfo& stream_info) override;
+
+  const RecordEncoder encoder_;
+  AccessLog::AccessLogFileSharedPtr log_file_;
+};
+
+} // namespace Binary
+} // namespace AccessLoggers
+} // namespace Extensions
+} // namespace Envoy
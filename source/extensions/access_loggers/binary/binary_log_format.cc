@@ -0,0 +1,419 @@
+#include "extensions/access_loggers/binary/binary_log_format.h"
+
+#include <chrono>
+#include <cstring>
+
+#include "envoy/common/exception.h"
+#include "envoy/common/platform.h"
+#include "envoy/upstream/host_description.h"
+#include "envoy/upstream/upstream.h"
+
+#include "common/common/assert.h"
+#include "common/common/fmt.h"
+#include "common/common/hash.h"
+#include "common/http/utility.h"
+#include "common/network/address_impl.h"
+#include "common/protobuf/utility.h"
+
+#include "absl/strings/str_cat.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace AccessLoggers {
+namespace Binary {
+
+namespace {
+
+constexpr size_t LengthSize = sizeof(uint32_t);
+
+template <class Output> void putByte(Output& output, uint8_t value) {
+  output.push_back(static_cast<char>(value));
+}
+
+template <class Output> void putVarint(Output& output, uint64_t value) {
+  while (value >= 0x80) {
+    putByte(output, static_cast<uint8_t>(value) | 0x80);
+    value >>= 7;
+  }
+  putByte(output, static_cast<uint8_t>(value));
+}
+
+template <class Output> void putRaw(Output& output, const void* data, size_t size) {
+  const char* bytes = static_cast<const char*>(data);
+  output.insert(output.end(), bytes, bytes + size);
+}
+
+template <class Output> void putBytes(Output& output, absl::string_view value) {
+  putVarint(output, value.size());
+  putRaw(output, value.data(), value.size());
+}
+
+template <class Output> void beginRecord(Output& output, RecordType type) {
+  output.clear();
+  output.resize(LengthSize);
+  putByte(output, static_cast<uint8_t>(type));
+}
+
+template <class Output> void endRecord(Output& output) {
+  const uint32_t length = output.size() - LengthSize;
+  for (size_t i = 0; i < LengthSize; i++) {
+    output[i] = static_cast<char>(length >> (8 * i));
+  }
+}
+
+void putAddress(RecordEncoder::Buffer& output, const Network::Address::Instance& address) {
+  const Network::Address::Ip* ip = address.ip();
+  if (ip != nullptr && ip->ipv4() != nullptr) {
+    putByte(output, static_cast<uint8_t>(AddressType::Ipv4));
+    const uint32_t raw = ip->ipv4()->address();
+    putRaw(output, &raw, sizeof(raw));
+    putVarint(output, ip->port());
+  } else if (ip != nullptr && ip->ipv6() != nullptr) {
+    putByte(output, static_cast<uint8_t>(AddressType::Ipv6));
+    const absl::uint128 raw = ip->ipv6()->address();
+    putRaw(output, &raw, sizeof(raw));
+    putVarint(output, ip->port());
+  } else {
+    putByte(output, static_cast<uint8_t>(AddressType::Other));
+    putBytes(output, address.asStringView());
+  }
+}
+
+bool putDuration(RecordEncoder::Buffer& output,
+                 const absl::optional<std::chrono::nanoseconds>& duration) {
+  if (!duration) {
+    return false;
+  }
+  putVarint(output,
+            std::chrono::duration_cast<std::chrono::microseconds>(duration.value()).count());
+  return true;
+}
+
+bool putHeader(RecordEncoder::Buffer& output, const Http::HeaderMap& headers,
+               const Http::LowerCaseString& name) {
+  const Http::HeaderEntry* header = headers.get(name);
+  if (header == nullptr) {
+    return false;
+  }
+  putBytes(output, header->value().getStringView());
+  return true;
+}
+
+bool putField(const SchemaField& field, const Http::RequestHeaderMap& request_headers,
+              const Http::ResponseHeaderMap& response_headers,
+              const StreamInfo::StreamInfo& stream_info, RecordEncoder::Buffer& output) {
+  switch (field.type_) {
+  case FieldType::StartTime:
+    putVarint(output, std::chrono::duration_cast<std::chrono::microseconds>(
+                          stream_info.startTime().time_since_epoch())
+                          .count());
+    return true;
+  case FieldType::Duration:
+    return putDuration(output, stream_info.requestComplete());
+  case FieldType::ResponseDuration:
+    return putDuration(output, stream_info.firstUpstreamRxByteReceived());
+  case FieldType::ResponseCode: {
+    const absl::optional<uint32_t> code = stream_info.responseCode();
+    if (!code) {
+      return false;
+    }
+    putVarint(output, code.value());
+    return true;
+  }
+  case FieldType::ResponseFlags:
+    putVarint(output, stream_info.responseFlags());
+    return true;
+  case FieldType::BytesReceived:
+    putVarint(output, stream_info.bytesReceived());
+    return true;
+  case FieldType::BytesSent:
+    putVarint(output, stream_info.bytesSent());
+    return true;
+  case FieldType::Protocol: {
+    const absl::optional<Http::Protocol> protocol = stream_info.protocol();
+    if (!protocol) {
+      return false;
+    }
+    putVarint(output, static_cast<uint64_t>(protocol.value()));
+    return true;
+  }
+  case FieldType::DownstreamRemoteAddress:
+    if (stream_info.downstreamRemoteAddress() == nullptr) {
+      return false;
+    }
+    putAddress(output, *stream_info.downstreamRemoteAddress());
+    return true;
+  case FieldType::DownstreamLocalAddress:
+    if (stream_info.downstreamLocalAddress() == nullptr) {
+      return false;
+    }
+    putAddress(output, *stream_info.downstreamLocalAddress());
+    return true;
+  case FieldType::UpstreamHost: {
+    const Upstream::HostDescriptionConstSharedPtr host = stream_info.upstreamHost();
+    if (host == nullptr || host->address() == nullptr) {
+      return false;
+    }
+    putAddress(output, *host->address());
+    return true;
+  }
+  case FieldType::UpstreamCluster: {
+    const absl::optional<Upstream::ClusterInfoConstSharedPtr> cluster =
+        stream_info.upstreamClusterInfo();
+    if (!cluster || cluster.value() == nullptr) {
+      return false;
+    }
+    putBytes(output, cluster.value()->name());
+    return true;
+  }
+  case FieldType::RouteName:
+    if (stream_info.getRouteName().empty()) {
+      return false;
+    }
+    putBytes(output, stream_info.getRouteName());
+    return true;
+  case FieldType::RequestHeader:
+    return putHeader(output, request_headers, field.header_name_);
+  case FieldType::ResponseHeader:
+    return putHeader(output, response_headers, field.header_name_);
+  }
+  NOT_REACHED_GCOVR_EXCL_LINE;
+}
+
+bool isHeaderField(FieldType type) {
+  return type == FieldType::RequestHeader || type == FieldType::ResponseHeader;
+}
+
+bool isKnownField(uint8_t type) {
+  return type <= static_cast<uint8_t>(FieldType::RouteName) ||
+         isHeaderField(static_cast<FieldType>(type));
+}
+
+// Reads the values of a record, throwing if it is cut short.
+class Reader {
+public:
+  explicit Reader(absl::string_view data) : data_(data) {}
+
+  uint8_t byte() { return static_cast<uint8_t>(raw(1)[0]); }
+
+  uint64_t varint() {
+    uint64_t value = 0;
+    for (uint32_t shift = 0; shift < 64; shift += 7) {
+      const uint8_t b = byte();
+      value |= static_cast<uint64_t>(b & 0x7f) << shift;
+      if ((b & 0x80) == 0) {
+        return value;
+      }
+    }
+    throw EnvoyException("malformed binary access log record: varint too long");
+  }
+
+  absl::string_view raw(size_t size) {
+    if (data_.size() < size) {
+      throw EnvoyException("malformed binary access log record: truncated");
+    }
+    const absl::string_view value = data_.substr(0, size);
+    data_.remove_prefix(size);
+    return value;
+  }
+
+  absl::string_view bytes() { return raw(varint()); }
+
+private:
+  absl::string_view data_;
+};
+
+std::string readAddress(Reader& reader) {
+  switch (static_cast<AddressType>(reader.byte())) {
+  case AddressType::Ipv4: {
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    memcpy(&address.sin_addr, reader.raw(sizeof(address.sin_addr)).data(),
+           sizeof(address.sin_addr));
+    address.sin_port = htons(static_cast<uint16_t>(reader.varint()));
+    return Network::Address::Ipv4Instance(&address).asString();
+  }
+  case AddressType::Ipv6: {
+    sockaddr_in6 address{};
+    address.sin6_family = AF_INET6;
+    memcpy(&address.sin6_addr, reader.raw(sizeof(address.sin6_addr)).data(),
+           sizeof(address.sin6_addr));
+    address.sin6_port = htons(static_cast<uint16_t>(reader.varint()));
+    return Network::Address::Ipv6Instance(address).asString();
+  }
+  case AddressType::Other:
+    return std::string(reader.bytes());
+  }
+  throw EnvoyException("malformed binary access log record: unknown address type");
+}
+
+ProtobufWkt::Value readValue(FieldType type, Reader& reader) {
+  switch (type) {
+  case FieldType::Protocol: {
+    const uint64_t protocol = reader.varint();
+    if (protocol >= Http::NumProtocols) {
+      throw EnvoyException(
+          fmt::format("malformed binary access log record: unknown protocol {}", protocol));
+    }
+    return ValueUtil::stringValue(
+        Http::Utility::getProtocolString(static_cast<Http::Protocol>(protocol)));
+  }
+  case FieldType::DownstreamRemoteAddress:
+  case FieldType::DownstreamLocalAddress:
+  case FieldType::UpstreamHost:
+    return ValueUtil::stringValue(readAddress(reader));
+  case FieldType::UpstreamCluster:
+  case FieldType::RouteName:
+  case FieldType::RequestHeader:
+  case FieldType::ResponseHeader:
+    return ValueUtil::stringValue(std::string(reader.bytes()));
+  default:
+    return ValueUtil::numberValue(reader.varint());
+  }
+}
+
+} // namespace
+
+RecordEncoder::RecordEncoder(Schema&& schema) : schema_(std::move(schema)) {
+  std::string fields;
+  putVarint(fields, schema_.size());
+  for (const SchemaField& field : schema_) {
+    putByte(fields, static_cast<uint8_t>(field.type_));
+    if (isHeaderField(field.type_)) {
+      putBytes(fields, field.header_name_.get());
+    }
+  }
+  // The id has to tell apart the schemas of the loggers sharing a file, so it keeps the whole hash
+  // to make collisions between different schemas unlikely.
+  schema_id_ = HashUtil::xxHash64(fields);
+
+  beginRecord(schema_record_, RecordType::Schema);
+  putVarint(schema_record_, schema_id_);
+  schema_record_ += fields;
+  endRecord(schema_record_);
+}
+
+void RecordEncoder::encodeEntry(const Http::RequestHeaderMap& request_headers,
+                                const Http::ResponseHeaderMap& response_headers,
+                                const StreamInfo::StreamInfo& stream_info, Buffer& buffer) const {
+  beginRecord(buffer, RecordType::Entry);
+  putVarint(buffer, schema_id_);
+  const size_t presence = buffer.size();
+  buffer.resize(presence + (schema_.size() + 7) / 8, 0);
+  for (size_t i = 0; i < schema_.size(); i++) {
+    if (putField(schema_[i], request_headers, response_headers, stream_info, buffer)) {
+      buffer[presence + i / 8] |= static_cast<char>(1 << (i % 8));
+    }
+  }
+  endRecord(buffer);
+}
+
+void RecordDecoder::decode(absl::string_view& data, const EntryCallback& callback) {
+  while (data.size() >= LengthSize) {
+    uint32_t length = 0;
+    for (size_t i = 0; i < LengthSize; i++) {
+      length |= static_cast<uint32_t>(static_cast<uint8_t>(data[i])) << (8 * i);
+    }
+    if (data.size() - LengthSize < length) {
+      return;
+    }
+    const absl::string_view record = data.substr(LengthSize, length);
+    data.remove_prefix(LengthSize + length);
+    if (record.empty()) {
+      throw EnvoyException("malformed binary access log record: empty");
+    }
+
+    const uint8_t type = static_cast<uint8_t>(record[0]);
+    switch (static_cast<RecordType>(type)) {
+    case RecordType::Schema:
+      decodeSchema(record.substr(1));
+      break;
+    case RecordType::Entry:
+      decodeEntry(record.substr(1), callback);
+      break;
+    default:
+      throw EnvoyException(fmt::format("unknown binary access log record type {}", type));
+    }
+  }
+}
+
+void RecordDecoder::decodeSchema(absl::string_view body) {
+  Reader record(body);
+  const uint64_t id = record.varint();
+  const uint64_t count = record.varint();
+  Schema schema;
+  for (uint64_t i = 0; i < count; i++) {
+    const uint8_t type = record.byte();
+    if (!isKnownField(type)) {
+      throw EnvoyException(fmt::format("unknown binary access log field type {}", type));
+    }
+    const FieldType field_type = static_cast<FieldType>(type);
+    if (isHeaderField(field_type)) {
+      schema.push_back({field_type, Http::LowerCaseString(std::string(record.bytes()))});
+    } else {
+      schema.push_back({field_type});
+    }
+  }
+  schemas_[id] = std::move(schema);
+}
+
+void RecordDecoder::decodeEntry(absl::string_view body, const EntryCallback& callback) {
+  Reader record(body);
+  const auto it = schemas_.find(record.varint());
+  if (it == schemas_.end()) {
+    unknown_schema_entries_++;
+    return;
+  }
+  const Schema& schema = it->second;
+  const absl::string_view presence = record.raw((schema.size() + 7) / 8);
+
+  ProtobufWkt::Struct entry;
+  auto& fields = *entry.mutable_fields();
+  for (size_t i = 0; i < schema.size(); i++) {
+    const bool present = (static_cast<uint8_t>(presence[i / 8]) >> (i % 8)) & 1;
+    fields[fieldName(schema[i])] =
+        present ? readValue(schema[i].type_, record) : ValueUtil::nullValue();
+  }
+  callback(std::move(entry));
+}
+
+std::string RecordDecoder::fieldName(const SchemaField& field) {
+  switch (field.type_) {
+  case FieldType::StartTime:
+    return "start_time";
+  case FieldType::Duration:
+    return "duration";
+  case FieldType::ResponseDuration:
+    return "response_duration";
+  case FieldType::ResponseCode:
+    return "response_code";
+  case FieldType::ResponseFlags:
+    return "response_flags";
+  case FieldType::BytesReceived:
+    return "bytes_received";
+  case FieldType::BytesSent:
+    return "bytes_sent";
+  case FieldType::Protocol:
+    return "protocol";
+  case FieldType::DownstreamRemoteAddress:
+    return "downstream_remote_address";
+  case FieldType::DownstreamLocalAddress:
+    return "downstream_local_address";
+  case FieldType::UpstreamHost:
+    return "upstream_host";
+  case FieldType::UpstreamCluster:
+    return "upstream_cluster";
+  case FieldType::RouteName:
+    return "route_name";
+  case FieldType::RequestHeader:
+    return absl::StrCat("request_header.", field.header_name_.get());
+  case FieldType::ResponseHeader:
+    return absl::StrCat("response_header.", field.header_name_.get());
+  }
+  NOT_REACHED_GCOVR_EXCL_LINE;
+}
+
+} // namespace Binary
+} // namespace AccessLoggers
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,140 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "envoy/http/header_map.h"
+#include "envoy/network/address.h"
+#include "envoy/stream_info/stream_info.h"
+
+#include "common/protobuf/protobuf.h"
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/inlined_vector.h"
+#include "absl/strings/string_view.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace AccessLoggers {
+namespace Binary {
+
+/**
+ * Binary access log files are a sequence of records, each of which is:
+ *   - the length of the rest of the record, as a little endian uint32.
+ *   - a RecordType byte.
+ *   - the record body.
+ *
+ * A schema record body is a varint schema id, a varint field count, and for each field its
+ * FieldType byte, followed by the varint length and bytes of the header name for header fields.
+ *
+ * An entry record body is the varint id of the schema it follows, a bitmap of the fields that are
+ * present (bit i of byte i / 8 for field i), and then the value of each present field in schema
+ * order:
+ *   - integers, times and durations: a varint.
+ *   - protocols: a varint Http::Protocol.
+ *   - addresses: an AddressType byte, followed by the 4 or 16 address bytes in network order and a
+ *     varint port for IP addresses, or the varint length and bytes of the address string otherwise.
+ *   - strings and header values: a varint length and the bytes.
+ */
+enum class RecordType : uint8_t { Schema = 1, Entry = 2 };
+
+// Values below 64 match envoy.extensions.access_loggers.binary.v3.BinaryAccessLog.Field.
+enum class FieldType : uint8_t {
+  StartTime = 0,
+  Duration = 1,
+  ResponseDuration = 2,
+  ResponseCode = 3,
+  ResponseFlags = 4,
+  BytesReceived = 5,
+  BytesSent = 6,
+  Protocol = 7,
+  DownstreamRemoteAddress = 8,
+  DownstreamLocalAddress = 9,
+  UpstreamHost = 10,
+  UpstreamCluster = 11,
+  RouteName = 12,
+  RequestHeader = 64,
+  ResponseHeader = 65,
+};
+
+enum class AddressType : uint8_t { Ipv4 = 0, Ipv6 = 1, Other = 2 };
+
+struct SchemaField {
+  FieldType type_;
+  // Lower case header name, for header fields.
+  Http::LowerCaseString header_name_{""};
+};
+
+using Schema = std::vector<SchemaField>;
+
+/**
+ * Encodes the records of one schema. Entries are encoded straight from the stream info and header
+ * values, without formatting any of them as text.
+ */
+class RecordEncoder {
+public:
+  // Records are encoded into an inline buffer, so typical entries need no allocation at all.
+  using Buffer = absl::InlinedVector<char, 512>;
+
+  explicit RecordEncoder(Schema&& schema);
+
+  /**
+   * @return the schema record, which must precede the entries of this schema in a file.
+   */
+  absl::string_view schemaRecord() const { return schema_record_; }
+
+  /**
+   * Encodes an entry record into buffer, replacing its contents.
+   */
+  void encodeEntry(const Http::RequestHeaderMap& request_headers,
+                   const Http::ResponseHeaderMap& response_headers,
+                   const StreamInfo::StreamInfo& stream_info, Buffer& buffer) const;
+
+  uint64_t schemaId() const { return schema_id_; }
+
+private:
+  const Schema schema_;
+  std::string schema_record_;
+  uint64_t schema_id_;
+};
+
+/**
+ * Decodes records back into one Struct per entry, keyed by field name. Schemas are remembered
+ * across calls, so the files of a rotated log can be decoded one after another.
+ */
+class RecordDecoder {
+public:
+  using EntryCallback = std::function<void(ProtobufWkt::Struct&& entry)>;
+
+  /**
+   * Decodes the complete records at the start of data, and advances data past them. A trailing
+   * partial record is left in data.
+   * @throw EnvoyException if a record is malformed.
+   */
+  void decode(absl::string_view& data, const EntryCallback& callback);
+
+  /**
+   * @return the number of entries skipped because their schema record wasn't seen. This happens
+   *         for the entries of a file which was truncated in place rather than reopened.
+   */
+  uint64_t unknownSchemaEntries() const { return unknown_schema_entries_; }
+
+  /**
+   * @return the name of a field in decoded entries.
+   */
+  static std::string fieldName(const SchemaField& field);
+
+private:
+  void decodeSchema(absl::string_view body);
+  void decodeEntry(absl::string_view body, const EntryCallback& callback);
+
+  absl::flat_hash_map<uint64_t, Schema> schemas_;
+  uint64_t unknown_schema_entries_{};
+};
+
+} // namespace Binary
+} // namespace AccessLoggers
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,45 @@
+#include "extensions/access_loggers/binary/config.h"
+
+#include <memory>
+
+#include "envoy/extensions/access_loggers/binary/v3/binary.pb.h"
+#include "envoy/extensions/access_loggers/binary/v3/binary.pb.validate.h"
+#include "envoy/registry/registry.h"
+#include "envoy/server/filter_config.h"
+
+#include "common/protobuf/protobuf.h"
+
+#include "extensions/access_loggers/binary/binary_access_log_impl.h"
+#include "extensions/access_loggers/well_known_names.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace AccessLoggers {
+namespace Binary {
+
+AccessLog::InstanceSharedPtr
+BinaryAccessLogFactory::createAccessLogInstance(const Protobuf::Message& config,
+                                                AccessLog::FilterPtr&& filter,
+                                                Server::Configuration::FactoryContext& context) {
+  const auto& bal_config = MessageUtil::downcastAndValidate<
+      const envoy::extensions::access_loggers::binary::v3::BinaryAccessLog&>(
+      config, context.messageValidationVisitor());
+  return std::make_shared<BinaryAccessLog>(bal_config, std::move(filter),
+                                           context.accessLogManager());
+}
+
+ProtobufTypes::MessagePtr BinaryAccessLogFactory::createEmptyConfigProto() {
+  return std::make_unique<envoy::extensions::access_loggers::binary::v3::BinaryAccessLog>();
+}
+
+std::string BinaryAccessLogFactory::name() const { return AccessLogNames::get().Binary; }
+
+/**
+ * Static registration for the binary access log. @see RegisterFactory.
+ */
+REGISTER_FACTORY(BinaryAccessLogFactory, Server::Configuration::AccessLogInstanceFactory);
+
+} // namespace Binary
+} // namespace AccessLoggers
+} // namespace Extensions
+} // namespace Envoy
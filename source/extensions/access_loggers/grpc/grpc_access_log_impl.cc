@@ -28,17 +28,20 @@ void GrpcAccessLoggerImpl::LocalStream::onRemoteClose(Grpc::Status::GrpcStatus,
 GrpcAccessLoggerImpl::GrpcAccessLoggerImpl(
     Grpc::RawAsyncClientPtr&& client, std::string log_name,
     std::chrono::milliseconds buffer_flush_interval_msec, uint64_t max_buffer_size_bytes,
-    Event::Dispatcher& dispatcher, const LocalInfo::LocalInfo& local_info, Stats::Scope& scope,
+    uint64_t max_buffered_bytes, uint32_t backpressure_sample_rate, Event::Dispatcher& dispatcher,
+    const LocalInfo::LocalInfo& local_info, Stats::Scope& scope,
     envoy::config::core::v3::ApiVersion transport_api_version)
     : stats_({ALL_GRPC_ACCESS_LOGGER_STATS(
-          POOL_COUNTER_PREFIX(scope, "access_logs.grpc_access_log."))}),
+          POOL_COUNTER_PREFIX(scope, "access_logs.grpc_access_log."),
+          POOL_HISTOGRAM_PREFIX(scope, "access_logs.grpc_access_log."))}),
       client_(std::move(client)), log_name_(log_name),
       buffer_flush_interval_msec_(buffer_flush_interval_msec),
       flush_timer_(dispatcher.createTimer([this]() {
         flush();
         flush_timer_->enableTimer(buffer_flush_interval_msec_);
       })),
-      max_buffer_size_bytes_(max_buffer_size_bytes), local_info_(local_info),
+      max_buffer_size_bytes_(max_buffer_size_bytes), max_buffered_bytes_(max_buffered_bytes),
+      backpressure_sample_rate_(backpressure_sample_rate), local_info_(local_info),
       service_method_(
           Grpc::VersionedMethods("envoy.service.accesslog.v3.AccessLogService.StreamAccessLogs",
                                  "envoy.service.accesslog.v2.AccessLogService.StreamAccessLogs")
@@ -48,18 +51,26 @@ GrpcAccessLoggerImpl::GrpcAccessLoggerImpl(
 }
 
 bool GrpcAccessLoggerImpl::canLogMore() {
-  if (max_buffer_size_bytes_ == 0 || approximate_message_size_bytes_ < max_buffer_size_bytes_) {
+  if (approximate_message_size_bytes_ < max_buffer_size_bytes_ || max_buffered_bytes_ == 0) {
     stats_.logs_written_.inc();
     return true;
   }
   flush();
-  if (approximate_message_size_bytes_ < max_buffer_size_bytes_) {
+  if (approximate_message_size_bytes_ == 0 ||
+      approximate_message_size_bytes_ < max_buffer_size_bytes_) {
     stats_.logs_written_.inc();
     return true;
   }
+  // The batch is still held, as the stream is backed up.
   if (Runtime::runtimeFeatureEnabled("envoy.reloadable_features.disallow_unbounded_access_logs")) {
-    stats_.logs_dropped_.inc();
-    return false;
+    if (approximate_message_size_bytes_ >= max_buffered_bytes_) {
+      stats_.logs_dropped_.inc();
+      return false;
+    }
+    if (backpressure_entries_++ % backpressure_sample_rate_ != 0) {
+      stats_.logs_sampled_out_.inc();
+      return false;
+    }
   }
   stats_.logs_written_.inc();
   return true;
@@ -77,6 +88,9 @@ void GrpcAccessLoggerImpl::log(envoy::data::accesslog::v3::HTTPAccessLogEntry&&
 }
 
 void GrpcAccessLoggerImpl::log(envoy::data::accesslog::v3::TCPAccessLogEntry&& entry) {
+  if (!canLogMore()) {
+    return;
+  }
   approximate_message_size_bytes_ += entry.ByteSizeLong();
   message_.mutable_tcp_logs()->mutable_log_entry()->Add(std::move(entry));
   if (approximate_message_size_bytes_ >= max_buffer_size_bytes_) {
@@ -108,6 +122,8 @@ void GrpcAccessLoggerImpl::flush() {
       return;
     }
     stream_->stream_->sendMessage(message_, transport_api_version_, false);
+    stats_.batches_sent_.inc();
+    stats_.batch_size_bytes_.recordValue(approximate_message_size_bytes_);
   } else {
     // Clear out the stream data due to stream creation failure.
     stream_.reset();
@@ -140,10 +156,14 @@ GrpcAccessLoggerSharedPtr GrpcAccessLoggerCacheImpl::getOrCreateLogger(
   }
   const Grpc::AsyncClientFactoryPtr factory =
       async_client_manager_.factoryForGrpcService(config.grpc_service(), scope_, false);
+  const uint64_t buffer_size_bytes =
+      PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, buffer_size_bytes, 16384);
   const GrpcAccessLoggerSharedPtr logger = std::make_shared<GrpcAccessLoggerImpl>(
       factory->create(), config.log_name(),
       std::chrono::milliseconds(PROTOBUF_GET_MS_OR_DEFAULT(config, buffer_flush_interval, 1000)),
-      PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, buffer_size_bytes, 16384), cache.dispatcher_,
+      buffer_size_bytes,
+      PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, max_buffered_bytes, buffer_size_bytes),
+      PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, backpressure_sample_rate, 1), cache.dispatcher_,
       local_info_, scope, config.transport_api_version());
   cache.access_loggers_.emplace(cache_key, logger);
   return logger;
@@ -24,15 +24,18 @@ namespace GrpcCommon {
 /**
  * All stats for the grpc access logger. @see stats_macros.h
  */
-#define ALL_GRPC_ACCESS_LOGGER_STATS(COUNTER)                                                      \
+#define ALL_GRPC_ACCESS_LOGGER_STATS(COUNTER, HISTOGRAM)                                           \
+  COUNTER(batches_sent)                                                                            \
+  COUNTER(logs_dropped)                                                                            \
+  COUNTER(logs_sampled_out)                                                                        \
   COUNTER(logs_written)                                                                            \
-  COUNTER(logs_dropped)
+  HISTOGRAM(batch_size_bytes, Bytes)
 
 /**
  * Wrapper struct for the access log stats. @see stats_macros.h
  */
 struct GrpcAccessLoggerStats {
-  ALL_GRPC_ACCESS_LOGGER_STATS(GENERATE_COUNTER_STRUCT)
+  ALL_GRPC_ACCESS_LOGGER_STATS(GENERATE_COUNTER_STRUCT, GENERATE_HISTOGRAM_STRUCT)
 };
 
 /**
@@ -84,7 +87,8 @@ class GrpcAccessLoggerImpl : public GrpcAccessLogger {
 public:
   GrpcAccessLoggerImpl(Grpc::RawAsyncClientPtr&& client, std::string log_name,
                        std::chrono::milliseconds buffer_flush_interval_msec,
-                       uint64_t max_buffer_size_bytes, Event::Dispatcher& dispatcher,
+                       uint64_t max_buffer_size_bytes, uint64_t max_buffered_bytes,
+                       uint32_t backpressure_sample_rate, Event::Dispatcher& dispatcher,
                        const LocalInfo::LocalInfo& local_info, Stats::Scope& scope,
                        envoy::config::core::v3::ApiVersion transport_api_version);
 
@@ -121,7 +125,12 @@ private:
   const std::chrono::milliseconds buffer_flush_interval_msec_;
   const Event::TimerPtr flush_timer_;
   const uint64_t max_buffer_size_bytes_;
+  // Limit on the entries held while the stream is backed up. Zero disables it.
+  const uint64_t max_buffered_bytes_;
+  const uint32_t backpressure_sample_rate_;
   uint64_t approximate_message_size_bytes_ = 0;
+  // Entries considered for sampling while the stream is backed up.
+  uint64_t backpressure_entries_ = 0;
   envoy::service::accesslog::v3::StreamAccessLogsMessage message_;
   absl::optional<LocalStream> stream_;
   const LocalInfo::LocalInfo& local_info_;
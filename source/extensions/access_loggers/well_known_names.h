@@ -14,6 +14,8 @@ namespace AccessLoggers {
  */
 class AccessLogNameValues {
 public:
+  // Binary access log
+  const std::string Binary = "envoy.access_loggers.binary";
   // File access log
   const std::string File = "envoy.access_loggers.file";
   // HTTP gRPC access log
@@ -4,6 +4,7 @@ EXTENSIONS = {
     # Access loggers
     #
 
+    "envoy.access_loggers.binary":                      "//source/extensions/access_loggers/binary:config",
     "envoy.access_loggers.file":                        "//source/extensions/access_loggers/file:config",
     "envoy.access_loggers.http_grpc":                   "//source/extensions/access_loggers/grpc:http_config",
     "envoy.access_loggers.tcp_grpc":                    "//source/extensions/access_loggers/grpc:tcp_config",
@@ -124,6 +125,7 @@ EXTENSIONS = {
     # Resource monitors
     #
 
+    "envoy.resource_monitors.buffer_memory":            "//source/extensions/resource_monitors/buffer_memory:config",
     "envoy.resource_monitors.fixed_heap":               "//source/extensions/resource_monitors/fixed_heap:config",
     "envoy.resource_monitors.injected_resource":        "//source/extensions/resource_monitors/injected_resource:config",
 
@@ -184,6 +186,8 @@ EXTENSIONS = {
     #
 
     "envoy.filters.http.cache.simple_http_cache":       "//source/extensions/filters/http/cache/simple_http_cache:simple_http_cache_lib",
+    "envoy.filters.http.cache.lru_http_cache":          "//source/extensions/filters/http/cache/lru_http_cache:lru_http_cache_lib",
+    "envoy.filters.http.cache.disk_http_cache":         "//source/extensions/filters/http/cache/disk_http_cache:disk_http_cache_lib",
 
     #
     # Internal redirect predicates
@@ -192,6 +196,12 @@ EXTENSIONS = {
     "envoy.internal_redirect_predicates.previous_routes":     "//source/extensions/internal_redirect/previous_routes:config",
     "envoy.internal_redirect_predicates.safe_cross_scheme":   "//source/extensions/internal_redirect/safe_cross_scheme:config",
 
+    #
+    # Socket interfaces
+    #
+
+    "envoy.extensions.network.socket_interface.io_uring": "//source/extensions/network/socket_interface/io_uring:config",
+
     # Http Upstreams (excepting envoy.upstreams.http.generic which is hard-coded into the build so not registered here)
     "envoy.upstreams.http.http":                     "//source/extensions/upstreams/http/http:config",
     "envoy.upstreams.http.tcp":                     "//source/extensions/upstreams/http/tcp:config",
@@ -0,0 +1,186 @@
+#include "extensions/filters/http/cache/background_revalidator.h"
+
+#include "envoy/http/codes.h"
+
+#include "common/common/enum_to_int.h"
+#include "common/http/codes.h"
+#include "common/http/header_map_impl.h"
+#include "common/http/headers.h"
+#include "common/http/message_impl.h"
+#include "common/http/utility.h"
+
+#include "extensions/filters/http/cache/cache_headers_utils.h"
+#include "extensions/filters/http/cache/cacheability_utils.h"
+#include "extensions/filters/http/cache/inline_headers_handles.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Cache {
+
+namespace {
+CacheRevalidationStats generateStats(const std::string& prefix, Stats::Scope& scope) {
+  const std::string final_prefix = prefix + "cache.revalidation.";
+  return CacheRevalidationStats{
+      ALL_CACHE_REVALIDATION_STATS(POOL_COUNTER_PREFIX(scope, final_prefix))};
+}
+} // namespace
+
+// A single in-flight revalidation. It owns itself, and is deleted once the conditional request
+// completes or fails.
+class BackgroundRevalidator::Revalidation : public Http::AsyncClient::Callbacks {
+public:
+  Revalidation(BackgroundRevalidatorSharedPtr parent, const Key& key, LookupContextPtr&& lookup,
+               const std::string& cluster, std::chrono::milliseconds timeout,
+               Http::RequestHeaderMapPtr&& request_headers)
+      : parent_(std::move(parent)), key_(key), lookup_(std::move(lookup)), cluster_(cluster),
+        timeout_(timeout), request_headers_(std::move(request_headers)) {}
+
+  void start() {
+    lookup_->getHeaders([this](LookupResult&& result) { onLookup(std::move(result)); });
+  }
+
+  // Http::AsyncClient::Callbacks
+  void onSuccess(const Http::AsyncClient::Request&, Http::ResponseMessagePtr&& response) override {
+    Http::ResponseHeaderMap& response_headers = response->headers();
+    const uint64_t status = Http::Utility::getResponseStatus(response_headers);
+    if (status == enumToInt(Http::Code::NotModified)) {
+      parent_->stats_.not_modified_.inc();
+      updateCachedHeaders(response_headers);
+    } else if (Http::CodeUtility::is5xx(status)) {
+      parent_->stats_.failed_.inc();
+    } else {
+      parent_->stats_.modified_.inc();
+      if (CacheabilityUtils::isCacheableResponse(response_headers)) {
+        insertResponse(*response);
+      }
+    }
+    finish();
+  }
+  void onFailure(const Http::AsyncClient::Request&, Http::AsyncClient::FailureReason) override {
+    parent_->stats_.failed_.inc();
+    finish();
+  }
+  void onBeforeFinalizeUpstreamSpan(Tracing::Span&, const Http::ResponseHeaderMap*) override {}
+
+private:
+  void onLookup(LookupResult&& result) {
+    if (result.cache_entry_status_ != CacheEntryStatus::RequiresValidation &&
+        result.cache_entry_status_ != CacheEntryStatus::StaleWhileRevalidate) {
+      // The entry has been evicted or refreshed since it was served.
+      finish();
+      return;
+    }
+    // It's possible that the cluster no longer exists due to a CDS removal.
+    if (parent_->cm_.get(cluster_) == nullptr) {
+      ENVOY_LOG(debug, "cache revalidation cluster '{}' does not exist", cluster_);
+      parent_->stats_.failed_.inc();
+      finish();
+      return;
+    }
+    cached_headers_ = std::move(result.headers_);
+    CacheHeadersUtils::injectValidationHeaders(*cached_headers_, *request_headers_);
+    Http::AsyncClient& client = parent_->cm_.httpAsyncClientForCluster(cluster_);
+    dispatcher_ = &client.dispatcher();
+    // If the request fails inline, onFailure has already deleted this object by the time send()
+    // returns, so the returned handle must not be stored. The request is never cancelled anyway.
+    client.send(
+        std::make_unique<Http::RequestMessageImpl>(std::move(request_headers_)), *this,
+        Http::AsyncClient::RequestOptions().setTimeout(timeout_));
+  }
+
+  // Freshens the cached entry with a 304 response, in the same way as CacheFilter does for
+  // validations on the request path.
+  void updateCachedHeaders(Http::ResponseHeaderMap& response_headers) {
+    // If the 304 response carries a strong validator that does not match the cached response, it
+    // does not describe the cached response, according to:
+    // https://httpwg.org/specs/rfc7234.html#freshening.responses
+    const Http::HeaderEntry* response_etag = response_headers.getInline(etag_handle.handle());
+    const Http::HeaderEntry* cached_etag = cached_headers_->getInline(etag_handle.handle());
+    if (response_etag && (!cached_etag || cached_etag->value().getStringView() !=
+                                              response_etag->value().getStringView())) {
+      return;
+    }
+
+    response_headers.setStatus(cached_headers_->getStatusValue());
+    response_headers.setContentLength(cached_headers_->getContentLengthValue());
+    cached_headers_->iterate([&response_headers](const Http::HeaderEntry& cached_header) {
+      Http::LowerCaseString key(std::string(cached_header.key().getStringView()));
+      if (!response_headers.get(key)) {
+        response_headers.setCopy(key, cached_header.value().getStringView());
+      }
+      return Http::HeaderMap::Iterate::Continue;
+    });
+    parent_->cache_.updateHeaders(*lookup_, response_headers);
+  }
+
+  void insertResponse(Http::ResponseMessage& response) {
+    InsertContextPtr insert = parent_->cache_.makeInsertContext(std::move(lookup_), *dispatcher_);
+    const bool has_body = response.body() != nullptr && response.body()->length() > 0;
+    insert->insertHeaders(response.headers(), !has_body);
+    if (has_body) {
+      insert->insertBody(
+          *response.body(), [](bool) {}, true);
+    }
+  }
+
+  void finish() {
+    parent_->onComplete(key_);
+    delete this;
+  }
+
+  const BackgroundRevalidatorSharedPtr parent_;
+  const Key key_;
+  LookupContextPtr lookup_;
+  const std::string cluster_;
+  const std::chrono::milliseconds timeout_;
+  Http::RequestHeaderMapPtr request_headers_;
+  Http::ResponseHeaderMapPtr cached_headers_;
+  // The dispatcher of the worker the revalidation runs on.
+  Event::Dispatcher* dispatcher_{};
+};
+
+BackgroundRevalidator::BackgroundRevalidator(Upstream::ClusterManager& cm, HttpCache& cache,
+                                             TimeSource& time_source,
+                                             const std::string& stats_prefix, Stats::Scope& scope)
+    : cm_(cm), cache_(cache), time_source_(time_source),
+      stats_(generateStats(stats_prefix, scope)) {}
+
+void BackgroundRevalidator::revalidate(const Router::RouteEntry& route_entry,
+                                       const StreamInfo::StreamInfo& stream_info,
+                                       const Http::RequestHeaderMap& request_headers) {
+  // Revalidate the whole entry, whatever part of it the triggering request asked for.
+  Http::RequestHeaderMapPtr headers =
+      Http::createHeaderMap<Http::RequestHeaderMapImpl>(request_headers);
+  headers->remove(Http::Headers::get().Range);
+  headers->removeInline(if_range_handle.handle());
+
+  LookupRequest lookup_request(*headers, time_source_.systemTime());
+  const Key key = lookup_request.key();
+  {
+    absl::MutexLock lock(&mutex_);
+    if (!in_flight_.insert(key).second) {
+      return;
+    }
+  }
+  // The entry is keyed on the downstream request, but the origin has to be asked for the resource
+  // the router would have forwarded the request for.
+  route_entry.finalizeRequestHeaders(*headers, stream_info, /*insert_envoy_original_path=*/false);
+  ENVOY_LOG(debug, "revalidating stale cache entry in the background with cluster '{}'",
+            route_entry.clusterName());
+  stats_.started_.inc();
+  auto* revalidation =
+      new Revalidation(shared_from_this(), key, cache_.makeLookupContext(std::move(lookup_request)),
+                       route_entry.clusterName(), route_entry.timeout(), std::move(headers));
+  revalidation->start();
+}
+
+void BackgroundRevalidator::onComplete(const Key& key) {
+  absl::MutexLock lock(&mutex_);
+  in_flight_.erase(key);
+}
+
+} // namespace Cache
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <chrono>
+#include <memory>
+#include <string>
+
+#include "envoy/common/time.h"
+#include "envoy/http/header_map.h"
+#include "envoy/router/router.h"
+#include "envoy/stats/scope.h"
+#include "envoy/stats/stats_macros.h"
+#include "envoy/stream_info/stream_info.h"
+#include "envoy/upstream/cluster_manager.h"
+
+#include "common/common/logger.h"
+
+#include "extensions/filters/http/cache/http_cache.h"
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/synchronization/mutex.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Cache {
+
+/**
+ * All cache revalidation stats. @see stats_macros.h
+ */
+#define ALL_CACHE_REVALIDATION_STATS(COUNTER)                                                      \
+  COUNTER(failed)                                                                                  \
+  COUNTER(modified)                                                                                \
+  COUNTER(not_modified)                                                                            \
+  COUNTER(served_stale_on_error)                                                                   \
+  COUNTER(started)
+
+/**
+ * Struct definition for cache revalidation stats. @see stats_macros.h
+ */
+struct CacheRevalidationStats {
+  ALL_CACHE_REVALIDATION_STATS(GENERATE_COUNTER_STRUCT)
+};
+
+/**
+ * Validates stale cache entries with the origin off the request path, so that responses served
+ * under stale-while-revalidate become fresh again for later requests. Each revalidation sends a
+ * conditional request through the cluster's async client; a 304 response updates the cached
+ * headers, and a new cacheable response replaces the entry. Shared by all CacheFilters created
+ * from the same configuration.
+ */
+class BackgroundRevalidator : public std::enable_shared_from_this<BackgroundRevalidator>,
+                              Logger::Loggable<Logger::Id::cache_filter> {
+public:
+  BackgroundRevalidator(Upstream::ClusterManager& cm, HttpCache& cache, TimeSource& time_source,
+                        const std::string& stats_prefix, Stats::Scope& scope);
+
+  /**
+   * Starts revalidating the entry cached for request_headers with the cluster of route_entry,
+   * unless a revalidation of the same entry is already in flight. The conditional request has the
+   * route's header mutations and host and path rewrites applied, as the router would, and the
+   * route's timeout. Must be called on a worker thread, which the revalidation then runs on.
+   * @param route_entry the route of the request that was served the stale entry.
+   * @param stream_info the stream info of that request, used to evaluate header mutations.
+   * @param request_headers the headers of that request, as received from downstream.
+   */
+  void revalidate(const Router::RouteEntry& route_entry, const StreamInfo::StreamInfo& stream_info,
+                  const Http::RequestHeaderMap& request_headers);
+
+  CacheRevalidationStats& stats() { return stats_; }
+
+private:
+  class Revalidation;
+
+  void onComplete(const Key& key);
+
+  Upstream::ClusterManager& cm_;
+  HttpCache& cache_;
+  TimeSource& time_source_;
+  CacheRevalidationStats stats_;
+  absl::Mutex mutex_;
+  absl::flat_hash_set<Key, KeyHash, KeyEq> in_flight_ ABSL_GUARDED_BY(mutex_);
+};
+using BackgroundRevalidatorSharedPtr = std::shared_ptr<BackgroundRevalidator>;
+
+} // namespace Cache
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
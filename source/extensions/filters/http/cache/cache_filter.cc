@@ -1,6 +1,7 @@
 #include "extensions/filters/http/cache/cache_filter.h"
 
 #include "common/common/enum_to_int.h"
+#include "common/http/codes.h"
 #include "common/http/headers.h"
 #include "common/http/utility.h"
 
@@ -18,6 +19,10 @@ namespace {
 inline bool isResponseNotModified(const Http::ResponseHeaderMap& response_headers) {
   return Http::Utility::getResponseStatus(response_headers) == enumToInt(Http::Code::NotModified);
 }
+
+inline bool isServerError(const Http::ResponseHeaderMap& response_headers) {
+  return Http::CodeUtility::is5xx(Http::Utility::getResponseStatus(response_headers));
+}
 } // namespace
 
 struct CacheResponseCodeDetailValues {
@@ -28,12 +33,19 @@ using CacheResponseCodeDetails = ConstSingleton<CacheResponseCodeDetailValues>;
 
 CacheFilter::CacheFilter(const envoy::extensions::filters::http::cache::v3alpha::CacheConfig&,
                          const std::string&, Stats::Scope&, TimeSource& time_source,
-                         HttpCache& http_cache)
-    : time_source_(time_source), cache_(http_cache) {}
+                         HttpCache& http_cache, RequestCollapserSharedPtr request_collapser,
+                         BackgroundRevalidatorSharedPtr revalidator)
+    : time_source_(time_source), cache_(http_cache),
+      request_collapser_(std::move(request_collapser)), revalidator_(std::move(revalidator)) {}
 
 void CacheFilter::onDestroy() {
   lookup_ = nullptr;
   insert_ = nullptr;
+  if (collapsed_fill_timer_) {
+    collapsed_fill_timer_->disableTimer();
+  }
+  // If this request was filling the cache for others, they stop waiting and go upstream.
+  collapsed_fill_ = nullptr;
 }
 
 Http::FilterHeadersStatus CacheFilter::decodeHeaders(Http::RequestHeaderMap& headers,
@@ -55,6 +67,10 @@ Http::FilterHeadersStatus CacheFilter::decodeHeaders(Http::RequestHeaderMap& hea
 
   LookupRequest lookup_request(headers, time_source_.systemTime());
   request_allows_inserts_ = !lookup_request.requestCacheControl().no_store_;
+  if (request_collapser_) {
+    key_ = lookup_request.key();
+    request_headers_ = &headers;
+  }
   lookup_ = cache_.makeLookupContext(std::move(lookup_request));
 
   ASSERT(lookup_);
@@ -73,6 +89,9 @@ Http::FilterHeadersStatus CacheFilter::decodeHeaders(Http::RequestHeaderMap& hea
   case FilterState::ResponseServedFromCache:
     // A fresh cached response was found -- no need to continue the decoding stream.
     return Http::FilterHeadersStatus::StopAllIterationAndWatermark;
+  case FilterState::WaitingForCollapsedFill:
+    // Another request is filling the cache for this key -- wait until it is done.
+    return Http::FilterHeadersStatus::StopAllIterationAndWatermark;
   default:
     return Http::FilterHeadersStatus::Continue;
   }
@@ -100,14 +119,28 @@ Http::FilterHeadersStatus CacheFilter::encodeHeaders(Http::ResponseHeaderMap& he
     return Http::FilterHeadersStatus::Continue;
   }
 
+  if (filter_state_ == FilterState::ValidatingCachedResponse &&
+      lookup_result_->serve_stale_on_error_ && isServerError(headers)) {
+    serveStaleOnError(headers);
+    if (filter_state_ != FilterState::ResponseServedFromCache) {
+      // Response is still being fetched from cache -- wait until it is fetched & encoded.
+      filter_state_ = FilterState::WaitingForCacheBody;
+      return Http::FilterHeadersStatus::StopIteration;
+    }
+    return Http::FilterHeadersStatus::Continue;
+  }
+
   // Either a cache miss or a cache entry that is no longer valid.
   // Check if the new response can be cached.
   if (request_allows_inserts_ && CacheabilityUtils::isCacheableResponse(headers)) {
     // TODO(#12140): Add date internal header or metadata to cached responses.
     ENVOY_STREAM_LOG(debug, "CacheFilter::encodeHeaders inserting headers", *encoder_callbacks_);
-    insert_ = cache_.makeInsertContext(std::move(lookup_));
+    insert_ = cache_.makeInsertContext(std::move(lookup_), encoder_callbacks_->dispatcher());
     insert_->insertHeaders(headers, end_stream);
   }
+  if (!insert_ || end_stream) {
+    releaseCollapsedFill();
+  }
   return Http::FilterHeadersStatus::Continue;
 }
 
@@ -116,6 +149,13 @@ Http::FilterDataStatus CacheFilter::encodeData(Buffer::Instance& data, bool end_
     // This call was invoked by decoder_callbacks_->encodeData -- ignore it.
     return Http::FilterDataStatus::Continue;
   }
+  if (served_stale_on_error_) {
+    // The error response's body was replaced by the cached body.
+    data.drain(data.length());
+    return filter_state_ == FilterState::WaitingForCacheBody
+               ? Http::FilterDataStatus::StopIterationNoBuffer
+               : Http::FilterDataStatus::Continue;
+  }
   if (filter_state_ == FilterState::WaitingForCacheBody) {
     // Encoding stream stopped waiting for cached body (and trailers) to be encoded.
     return Http::FilterDataStatus::StopIterationAndBuffer;
@@ -125,6 +165,9 @@ Http::FilterDataStatus CacheFilter::encodeData(Buffer::Instance& data, bool end_
     // TODO(toddmgreer): Wait for the cache if necessary.
     insert_->insertBody(
         data, [](bool) {}, end_stream);
+    if (end_stream) {
+      releaseCollapsedFill();
+    }
   }
   return Http::FilterDataStatus::Continue;
 }
@@ -145,11 +188,19 @@ void CacheFilter::getTrailers() {
 
 void CacheFilter::onHeaders(LookupResult&& result, Http::RequestHeaderMap& request_headers) {
   // TODO(yosrym93): Handle request only-if-cached directive.
+  if (result.cache_entry_status_ == CacheEntryStatus::StaleWhileRevalidate) {
+    result.cache_entry_status_ = revalidateInBackground(request_headers)
+                                     ? CacheEntryStatus::Ok
+                                     : CacheEntryStatus::RequiresValidation;
+  }
   bool should_continue_decoding = false;
   switch (result.cache_entry_status_) {
   case CacheEntryStatus::FoundNotModified:
   case CacheEntryStatus::NotSatisfiableRange: // TODO(#10132): create 416 response.
     NOT_IMPLEMENTED_GCOVR_EXCL_LINE;          // We don't yet return or support these codes.
+  case CacheEntryStatus::StaleWhileRevalidate:
+    // Resolved to Ok or RequiresValidation above.
+    NOT_REACHED_GCOVR_EXCL_LINE;
   case CacheEntryStatus::RequiresValidation:
     // If a cache entry requires validation, inject validation headers in the request and let it
     // pass through as if no cache entry was found.
@@ -161,6 +212,11 @@ void CacheFilter::onHeaders(LookupResult&& result, Http::RequestHeaderMap& reque
     injectValidationHeaders(request_headers);
     break;
   case CacheEntryStatus::Unusable:
+    if (waitForCollapsedFill()) {
+      // Decoding stays stopped until the fill completes or the wait times out.
+      filter_state_ = FilterState::WaitingForCollapsedFill;
+      return;
+    }
     should_continue_decoding = filter_state_ == FilterState::WaitingForCacheLookup;
     filter_state_ = FilterState::NoCachedResponseFound;
     break;
@@ -225,6 +281,83 @@ void CacheFilter::onTrailers(Http::ResponseTrailerMapPtr&& trailers) {
   finalizeEncodingCachedResponse();
 }
 
+bool CacheFilter::waitForCollapsedFill() {
+  if (!request_collapser_ || waited_for_collapsed_fill_) {
+    return false;
+  }
+  collapsed_fill_ = request_collapser_->join(key_, decoder_callbacks_->dispatcher(),
+                                             [this]() { onCollapsedFillComplete(); });
+  if (collapsed_fill_->isLeader()) {
+    return false;
+  }
+  ENVOY_STREAM_LOG(debug, "CacheFilter waiting for in-progress cache fill", *decoder_callbacks_);
+  waited_for_collapsed_fill_ = true;
+  collapsed_fill_timer_ =
+      decoder_callbacks_->dispatcher().createTimer([this]() { onCollapsedFillTimeout(); });
+  collapsed_fill_timer_->enableTimer(request_collapser_->waitTimeout());
+  return true;
+}
+
+void CacheFilter::onCollapsedFillComplete() {
+  ASSERT(filter_state_ == FilterState::WaitingForCollapsedFill);
+  collapsed_fill_timer_->disableTimer();
+  collapsed_fill_ = nullptr;
+
+  // Look up the cache again; if the fill succeeded this is served from the cache, otherwise the
+  // request is sent upstream.
+  filter_state_ = FilterState::WaitingForCacheLookup;
+  lookup_ = cache_.makeLookupContext(LookupRequest(*request_headers_, time_source_.systemTime()));
+  lookup_->getHeaders([this](LookupResult&& result) {
+    if (result.cache_entry_status_ == CacheEntryStatus::Ok ||
+        result.cache_entry_status_ == CacheEntryStatus::SatisfiableRange) {
+      request_collapser_->stats().collapsed_.inc();
+    } else {
+      request_collapser_->stats().forwarded_.inc();
+    }
+    onHeaders(std::move(result), *request_headers_);
+  });
+}
+
+void CacheFilter::onCollapsedFillTimeout() {
+  ASSERT(filter_state_ == FilterState::WaitingForCollapsedFill);
+  ENVOY_STREAM_LOG(debug, "CacheFilter timed out waiting for in-progress cache fill",
+                   *decoder_callbacks_);
+  collapsed_fill_ = nullptr;
+  request_collapser_->stats().wait_timeout_.inc();
+  request_collapser_->stats().forwarded_.inc();
+  filter_state_ = FilterState::NoCachedResponseFound;
+  decoder_callbacks_->continueDecoding();
+}
+
+void CacheFilter::releaseCollapsedFill() {
+  if (insert_ && collapsed_fill_) {
+    // Caches may commit the insertion after the last insert call returns, and followers woken
+    // before then would miss, so the cache holds this request's handle until the commit completes.
+    insert_->onInsertComplete(
+        [collapsed_fill = std::shared_ptr<CollapsedFill>(std::move(collapsed_fill_))]() mutable {
+          collapsed_fill.reset();
+        });
+  }
+  collapsed_fill_ = nullptr;
+}
+
+bool CacheFilter::revalidateInBackground(const Http::RequestHeaderMap& request_headers) {
+  if (!revalidator_ || !decoder_callbacks_->route() ||
+      !decoder_callbacks_->route()->routeEntry()) {
+    return false;
+  }
+  const Router::RouteEntry* route_entry = decoder_callbacks_->route()->routeEntry();
+  if (route_entry->autoHostRewrite()) {
+    // The router rewrites the host to that of the upstream host it picks, which an async client
+    // request can't reproduce, so the entry is validated on the request path instead.
+    return false;
+  }
+  ENVOY_STREAM_LOG(debug, "CacheFilter serving stale response while revalidating it",
+                   *decoder_callbacks_);
+  revalidator_->revalidate(*route_entry, decoder_callbacks_->streamInfo(), request_headers);
+  return true;
+}
+
 void CacheFilter::processSuccessfulValidation(Http::ResponseHeaderMap& response_headers) {
   ASSERT(lookup_result_, "CacheFilter trying to validate a non-existent lookup result");
   ASSERT(
@@ -262,6 +395,31 @@ void CacheFilter::processSuccessfulValidation(Http::ResponseHeaderMap& response_
   }
 }
 
+void CacheFilter::serveStaleOnError(Http::ResponseHeaderMap& response_headers) {
+  ASSERT(lookup_result_, "CacheFilter trying to serve a non-existent lookup result");
+  ASSERT(filter_state_ == FilterState::ValidatingCachedResponse,
+         "serveStaleOnError must only be called when a cached response is being validated");
+  ENVOY_STREAM_LOG(debug, "CacheFilter serving stale response after validation failed: {}",
+                   *encoder_callbacks_, response_headers);
+  if (revalidator_) {
+    revalidator_->stats().served_stale_on_error_.inc();
+  }
+  served_stale_on_error_ = true;
+
+  // encodeCachedResponse adds the age header to lookup_result_, so it is called before the
+  // headers are copied.
+  encodeCachedResponse();
+
+  response_headers.clear();
+  lookup_result_->headers_->iterate([&response_headers](const Http::HeaderEntry& cached_header) {
+    // TODO(yosrym93): Try to avoid copying the header key twice.
+    Http::LowerCaseString key(std::string(cached_header.key().getStringView()));
+    response_headers.addCopy(key, cached_header.value().getStringView());
+    return Http::HeaderMap::Iterate::Continue;
+  });
+  response_headers.setContentLength(lookup_result_->content_length_);
+}
+
 // TODO(yosrym93): Write a test that exercises this when SimpleHttpCache implements updateHeaders
 bool CacheFilter::shouldUpdateCachedEntry(const Http::ResponseHeaderMap& response_headers) const {
   ASSERT(isResponseNotModified(response_headers),
@@ -289,25 +447,7 @@ void CacheFilter::injectValidationHeaders(Http::RequestHeaderMap& request_header
          "injectValidationHeaders precondition unsatisfied: the "
          "CacheFilter is not validating a cache lookup result");
 
-  const Http::HeaderEntry* etag_header = lookup_result_->headers_->getInline(etag_handle.handle());
-  const Http::HeaderEntry* last_modified_header =
-      lookup_result_->headers_->getInline(last_modified_handle.handle());
-
-  if (etag_header) {
-    absl::string_view etag = etag_header->value().getStringView();
-    request_headers.setInline(if_none_match_handle.handle(), etag);
-  }
-  if (CacheHeadersUtils::httpTime(last_modified_header) != SystemTime()) {
-    // Valid Last-Modified header exists.
-    absl::string_view last_modified = last_modified_header->value().getStringView();
-    request_headers.setInline(if_modified_since_handle.handle(), last_modified);
-  } else {
-    // Either Last-Modified is missing or invalid, fallback to Date.
-    // A correct behaviour according to:
-    // https://httpwg.org/specs/rfc7232.html#header.if-modified-since
-    absl::string_view date = lookup_result_->headers_->getDateValue();
-    request_headers.setInline(if_modified_since_handle.handle(), date);
-  }
+  CacheHeadersUtils::injectValidationHeaders(*lookup_result_->headers_, request_headers);
 }
 
 void CacheFilter::encodeCachedResponse() {
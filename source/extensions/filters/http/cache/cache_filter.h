@@ -9,8 +9,10 @@
 
 #include "common/common/logger.h"
 
+#include "extensions/filters/http/cache/background_revalidator.h"
 #include "extensions/filters/http/cache/cache_headers_utils.h"
 #include "extensions/filters/http/cache/http_cache.h"
+#include "extensions/filters/http/cache/request_collapser.h"
 #include "extensions/filters/http/common/pass_through_filter.h"
 
 namespace Envoy {
@@ -26,7 +28,8 @@ class CacheFilter : public Http::PassThroughFilter,
 public:
   CacheFilter(const envoy::extensions::filters::http::cache::v3alpha::CacheConfig& config,
               const std::string& stats_prefix, Stats::Scope& scope, TimeSource& time_source,
-              HttpCache& http_cache);
+              HttpCache& http_cache, RequestCollapserSharedPtr request_collapser,
+              BackgroundRevalidatorSharedPtr revalidator);
   // Http::StreamFilterBase
   void onDestroy() override;
   // Http::StreamDecoderFilter
@@ -47,11 +50,34 @@ private:
   void onBody(Buffer::InstancePtr&& body);
   void onTrailers(Http::ResponseTrailerMapPtr&& trailers);
 
+  // Called after a cache miss when request collapsing is enabled. Returns true if another request
+  // is already filling the cache for this key, in which case this request waits for that fill
+  // instead of going upstream.
+  bool waitForCollapsedFill();
+  // Called when the fill this request was waiting for completes, or the wait times out.
+  void onCollapsedFillComplete();
+  void onCollapsedFillTimeout();
+  // Called once nothing more will be inserted for this request. Wakes up the requests waiting for
+  // this request's fill once its response, if any, is visible in the cache.
+  void releaseCollapsedFill();
+
+  // Called for a cache entry that may be served stale while it is revalidated. Returns true if a
+  // background revalidation was started, in which case the entry is served as is; otherwise it is
+  // validated on the request path.
+  bool revalidateInBackground(const Http::RequestHeaderMap& request_headers);
+
   // Precondition: lookup_result_ points to a cache lookup result that requires validation.
   //               filter_state_ is ValidatingCachedResponse.
   // Serves a validated cached response after updating it with a 304 response.
   void processSuccessfulValidation(Http::ResponseHeaderMap& response_headers);
 
+  // Precondition: lookup_result_ points to a cache lookup result that requires validation, and
+  //               may be served stale if validation fails.
+  //               filter_state_ is ValidatingCachedResponse.
+  // Replaces a server error response to a validation request with the cached response, as allowed
+  // by its stale-if-error directive.
+  void serveStaleOnError(Http::ResponseHeaderMap& response_headers);
+
   // Precondition: lookup_result_ points to a cache lookup result that requires validation.
   //               filter_state_ is ValidatingCachedResponse.
   // Checks if a cached entry should be updated with a 304 response.
@@ -80,6 +106,25 @@ private:
   InsertContextPtr insert_;
   LookupResultPtr lookup_result_;
 
+  // Set when request collapsing is enabled.
+  const RequestCollapserSharedPtr request_collapser_;
+  // The cache key of the current request, kept for request collapsing.
+  Key key_;
+  // This request's part in an in-progress fill of key_, if any.
+  CollapsedFillPtr collapsed_fill_;
+  Event::TimerPtr collapsed_fill_timer_;
+  // The request headers, kept to look up the cache again once a collapsed fill completes.
+  Http::RequestHeaderMap* request_headers_ = nullptr;
+  // True once this request has waited for a collapsed fill; it won't wait again.
+  bool waited_for_collapsed_fill_ = false;
+
+  // Revalidates entries served under stale-while-revalidate. May be null, in which case such
+  // entries are validated on the request path.
+  const BackgroundRevalidatorSharedPtr revalidator_;
+  // True if the upstream response was replaced with a stale cached response, so its body must be
+  // dropped.
+  bool served_stale_on_error_ = false;
+
   // Tracks what body bytes still need to be read from the cache. This is currently only one Range,
   // but will expand when full range support is added. Initialized by encodeCachedResponse.
   std::vector<AdjustedByteRange> remaining_body_;
@@ -107,6 +152,10 @@ private:
     // Cache lookup did not find a cached response for this request.
     NoCachedResponseFound,
 
+    // Cache lookup did not find a cached response, but another request is filling the cache for
+    // the same key -- the decoding stream should be stopped until that fill completes.
+    WaitingForCollapsedFill,
+
     // Cache lookup found a cached response that requires validation.
     ValidatingCachedResponse,
 
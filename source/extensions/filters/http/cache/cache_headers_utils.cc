@@ -5,6 +5,8 @@
 
 #include "envoy/common/time.h"
 
+#include "extensions/filters/http/cache/inline_headers_handles.h"
+
 #include "absl/algorithm/container.h"
 #include "absl/strings/ascii.h"
 #include "absl/strings/numbers.h"
@@ -102,6 +104,10 @@ ResponseCacheControl::ResponseCacheControl(absl::string_view cache_control_heade
       max_age_ = parseDuration(argument);
     } else if (!max_age_.has_value() && directive == "max-age") {
       max_age_ = parseDuration(argument);
+    } else if (directive == "stale-while-revalidate") {
+      stale_while_revalidate_ = parseDuration(argument);
+    } else if (directive == "stale-if-error") {
+      stale_if_error_ = parseDuration(argument);
     }
   }
 }
@@ -116,7 +122,9 @@ bool operator==(const RequestCacheControl& lhs, const RequestCacheControl& rhs)
 bool operator==(const ResponseCacheControl& lhs, const ResponseCacheControl& rhs) {
   return (lhs.must_validate_ == rhs.must_validate_) && (lhs.no_store_ == rhs.no_store_) &&
          (lhs.no_transform_ == rhs.no_transform_) && (lhs.no_stale_ == rhs.no_stale_) &&
-         (lhs.is_public_ == rhs.is_public_) && (lhs.max_age_ == rhs.max_age_);
+         (lhs.is_public_ == rhs.is_public_) && (lhs.max_age_ == rhs.max_age_) &&
+         (lhs.stale_while_revalidate_ == rhs.stale_while_revalidate_) &&
+         (lhs.stale_if_error_ == rhs.stale_if_error_);
 }
 
 SystemTime CacheHeadersUtils::httpTime(const Http::HeaderEntry* header_entry) {
@@ -168,6 +176,29 @@ absl::optional<uint64_t> CacheHeadersUtils::readAndRemoveLeadingDigits(absl::str
   return absl::nullopt;
 }
 
+void CacheHeadersUtils::injectValidationHeaders(const Http::ResponseHeaderMap& cached_headers,
+                                                Http::RequestHeaderMap& request_headers) {
+  const Http::HeaderEntry* etag_header = cached_headers.getInline(etag_handle.handle());
+  const Http::HeaderEntry* last_modified_header =
+      cached_headers.getInline(last_modified_handle.handle());
+
+  if (etag_header) {
+    absl::string_view etag = etag_header->value().getStringView();
+    request_headers.setInline(if_none_match_handle.handle(), etag);
+  }
+  if (httpTime(last_modified_header) != SystemTime()) {
+    // Valid Last-Modified header exists.
+    absl::string_view last_modified = last_modified_header->value().getStringView();
+    request_headers.setInline(if_modified_since_handle.handle(), last_modified);
+  } else {
+    // Either Last-Modified is missing or invalid, fallback to Date.
+    // A correct behaviour according to:
+    // https://httpwg.org/specs/rfc7232.html#header.if-modified-since
+    absl::string_view date = cached_headers.getDateValue();
+    request_headers.setInline(if_modified_since_handle.handle(), date);
+  }
+}
+
 } // namespace Cache
 } // namespace HttpFilters
 } // namespace Extensions
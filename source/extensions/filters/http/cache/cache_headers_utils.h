@@ -80,6 +80,16 @@ struct ResponseCacheControl {
   // max_age is set if to 's-maxage' if present, if not it is set to 'max-age' if present.
   // Indicates the maximum time after which this response will be considered stale
   OptionalDuration max_age_;
+
+  // This response may be served stale for up to stale-while-revalidate after it becomes stale,
+  // while it is validated in the background, as defined by:
+  // https://tools.ietf.org/html/rfc5861#section-3
+  OptionalDuration stale_while_revalidate_;
+
+  // This response may be served stale for up to stale-if-error after it becomes stale, if
+  // validating it fails with an error, as defined by:
+  // https://tools.ietf.org/html/rfc5861#section-4
+  OptionalDuration stale_if_error_;
 };
 
 bool operator==(const RequestCacheControl& lhs, const RequestCacheControl& rhs);
@@ -97,6 +107,11 @@ public:
    * absl::nullopt without advancing "*str".
    */
   static absl::optional<uint64_t> readAndRemoveLeadingDigits(absl::string_view& str);
+
+  // Adds the conditional headers needed to validate cached_headers with the origin to
+  // request_headers, as defined by: https://httpwg.org/specs/rfc7234.html#validation.sent
+  static void injectValidationHeaders(const Http::ResponseHeaderMap& cached_headers,
+                                      Http::RequestHeaderMap& request_headers);
 };
 } // namespace Cache
 } // namespace HttpFilters
@@ -18,11 +18,20 @@ Http::FilterFactoryCb CacheFilterFactory::createFilterFactoryFromProtoTyped(
         fmt::format("Didn't find a registered implementation for type: '{}'", type));
   }
 
-  return [config, stats_prefix, &context,
-          http_cache_factory](Http::FilterChainFactoryCallbacks& callbacks) -> void {
+  // The cache remains valid indefinitely, so resolve it once here rather than on every stream.
+  HttpCache& http_cache = http_cache_factory->getCache(config, context);
+  RequestCollapserSharedPtr request_collapser;
+  if (config.has_request_collapsing()) {
+    request_collapser = std::make_shared<RequestCollapser>(config.request_collapsing(),
+                                                           stats_prefix, context.scope());
+  }
+  auto revalidator = std::make_shared<BackgroundRevalidator>(
+      context.clusterManager(), http_cache, context.timeSource(), stats_prefix, context.scope());
+  return [config, stats_prefix, &context, &http_cache, request_collapser,
+          revalidator](Http::FilterChainFactoryCallbacks& callbacks) -> void {
     callbacks.addStreamFilter(std::make_shared<CacheFilter>(config, stats_prefix, context.scope(),
-                                                            context.timeSource(),
-                                                            http_cache_factory->getCache(config)));
+                                                            context.timeSource(), http_cache,
+                                                            request_collapser, revalidator));
   };
 }
 
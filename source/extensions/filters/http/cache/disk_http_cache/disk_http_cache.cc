@@ -0,0 +1,728 @@
+#include "extensions/filters/http/cache/disk_http_cache/disk_http_cache.h"
+
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstring>
+
+#include "envoy/registry/registry.h"
+
+#include "common/buffer/buffer_impl.h"
+#include "common/common/hash.h"
+#include "common/common/lock_guard.h"
+#include "common/common/utility.h"
+#include "common/filesystem/directory.h"
+#include "common/http/header_map_impl.h"
+#include "common/protobuf/utility.h"
+
+#include "source/extensions/filters/http/cache/disk_http_cache/config.pb.h"
+#include "source/extensions/filters/http/cache/disk_http_cache/config.pb.validate.h"
+
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/strip.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Cache {
+namespace {
+
+constexpr char EntryMagic[8] = {'E', 'N', 'V', 'C', 'A', 'C', 'H', '2'};
+constexpr absl::string_view EntrySuffix = ".cache";
+constexpr absl::string_view TempInfix = ".tmp.";
+// Room left in the headers region for headers to grow when they are replaced in place.
+constexpr uint64_t HeadersSlackBytes = 512;
+// The body starts on a page boundary, so that mapping a range of it touches as few pages as
+// possible.
+constexpr uint64_t BodyAlignment = 4096;
+
+// Returns the size of the headers region for an entry with the given key and encoded headers.
+uint32_t headersCapacity(size_t key_size, size_t headers_size) {
+  const uint64_t start = sizeof(DiskEntryPrefix) + key_size;
+  const uint64_t end = start + sizeof(DiskHeadersRecord) + headers_size + HeadersSlackBytes;
+  return (end + BodyAlignment - 1) / BodyAlignment * BodyAlignment - start;
+}
+
+// Returns the contents of a headers region holding encoded_headers, without the unused space.
+std::string headersRecord(const std::string& encoded_headers) {
+  DiskHeadersRecord record;
+  record.size_ = encoded_headers.size();
+  record.reserved_ = 0;
+  record.checksum_ = HashUtil::xxHash64(encoded_headers);
+  std::string result(reinterpret_cast<const char*>(&record), sizeof(record));
+  result.append(encoded_headers);
+  return result;
+}
+
+// Encodes headers as a sequence of (key length, value length, key, value) records.
+std::string encodeHeaders(const Http::ResponseHeaderMap& headers) {
+  std::string encoded;
+  headers.iterate([&encoded](const Http::HeaderEntry& header) {
+    const absl::string_view key = header.key().getStringView();
+    const absl::string_view value = header.value().getStringView();
+    const uint32_t sizes[2] = {static_cast<uint32_t>(key.size()),
+                               static_cast<uint32_t>(value.size())};
+    encoded.append(reinterpret_cast<const char*>(sizes), sizeof(sizes));
+    absl::StrAppend(&encoded, key, value);
+    return Http::HeaderMap::Iterate::Continue;
+  });
+  return encoded;
+}
+
+// Writes all of data to fd, retrying on short writes. Returns false on error.
+bool writeAll(int fd, const void* data, size_t size) {
+  const char* pos = static_cast<const char*>(data);
+  while (size > 0) {
+    const ssize_t written = ::write(fd, pos, size);
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return false;
+    }
+    pos += written;
+    size -= written;
+  }
+  return true;
+}
+
+// Writes an entry file prefix, key and headers region to fd; the caller appends the body.
+bool writeEntryStart(int fd, const std::string& key, const std::string& encoded_headers,
+                     uint64_t body_size) {
+  DiskEntryPrefix prefix;
+  memcpy(prefix.magic_, EntryMagic, sizeof(EntryMagic));
+  prefix.key_size_ = key.size();
+  prefix.headers_capacity_ = headersCapacity(key.size(), encoded_headers.size());
+  prefix.body_size_ = body_size;
+  std::string headers_region = headersRecord(encoded_headers);
+  headers_region.resize(prefix.headers_capacity_, '\0');
+  return writeAll(fd, &prefix, sizeof(prefix)) && writeAll(fd, key.data(), key.size()) &&
+         writeAll(fd, headers_region.data(), headers_region.size());
+}
+
+// Returns whether the process that wrote the temporary file named file_name may still be writing
+// it. A pid that has been reused by an unrelated process keeps the file until a later restart.
+bool tempFileWriterAlive(absl::string_view file_name) {
+  const size_t pid_start = file_name.find(TempInfix);
+  ASSERT(pid_start != absl::string_view::npos);
+  absl::string_view pid_str = file_name.substr(pid_start + TempInfix.size());
+  pid_str = pid_str.substr(0, pid_str.find('.'));
+  uint64_t pid;
+  if (!absl::SimpleAtoi(pid_str, &pid) || pid == 0 || pid > INT32_MAX) {
+    return false;
+  }
+  // Files named with this process's pid were left by an earlier process that had the same pid,
+  // which is common for a restarted container.
+  if (static_cast<pid_t>(pid) == ::getpid()) {
+    return false;
+  }
+  return ::kill(static_cast<pid_t>(pid), 0) == 0 || errno == EPERM;
+}
+
+class DiskLookupContext : public LookupContext {
+public:
+  DiskLookupContext(DiskHttpCache& cache, LookupRequest&& request)
+      : cache_(cache), request_(std::move(request)) {}
+
+  void getHeaders(LookupHeadersCallback&& cb) override {
+    entry_ = cache_.lookup(request_.key());
+    Http::ResponseHeaderMapPtr headers = entry_ ? entry_->headers() : nullptr;
+    if (headers == nullptr) {
+      entry_ = nullptr;
+      cb(LookupResult{});
+      return;
+    }
+    cb(request_.makeLookupResult(std::move(headers), entry_->body().size()));
+  }
+
+  void getBody(const AdjustedByteRange& range, LookupBodyCallback&& cb) override {
+    ASSERT(entry_ != nullptr);
+    ASSERT(range.end() <= entry_->body().size(), "Attempt to read past end of body.");
+    // Reference the mapped range rather than copying it, so pages are only faulted in as the
+    // response is written out. The fragment keeps the mapping alive until it is released.
+    auto buffer = std::make_unique<Buffer::OwnedImpl>();
+    auto* fragment = new Buffer::BufferFragmentImpl(
+        entry_->body().data() + range.begin(), range.length(),
+        [entry = entry_](const void*, size_t, const Buffer::BufferFragmentImpl* fragment) {
+          delete fragment;
+        });
+    buffer->addBufferFragment(*fragment);
+    cb(std::move(buffer));
+  }
+
+  void getTrailers(LookupTrailersCallback&&) override {
+    // Trailers are not stored, so lookups never report any.
+    NOT_IMPLEMENTED_GCOVR_EXCL_LINE;
+  }
+
+  const LookupRequest& request() const { return request_; }
+  const MappedDiskEntrySharedPtr& entry() const { return entry_; }
+
+private:
+  DiskHttpCache& cache_;
+  const LookupRequest request_;
+  MappedDiskEntrySharedPtr entry_;
+};
+
+// The temporary file an insertion is written to, shared with the operations queued for the
+// insertion on the I/O threads.
+struct PendingEntryFile : public std::enable_shared_from_this<PendingEntryFile> {
+  // Only touched by the insertion's operations, which run one at a time.
+  std::string temp_path_;
+  int fd_ = -1;
+  bool failed_ = false;
+
+  // Set on the worker thread when the insertion is dropped, after which readiness callbacks must
+  // not be posted to it or run.
+  absl::Mutex mutex_;
+  bool abandoned_ ABSL_GUARDED_BY(mutex_) = false;
+};
+using PendingEntryFileSharedPtr = std::shared_ptr<PendingEntryFile>;
+
+// Streams the response into a temporary file as it arrives, so large bodies are never held in
+// memory, and renames the file into place once the response is complete. The file is written on
+// the cache's I/O threads; each chunk is copied, and ready_for_next_chunk is posted back to the
+// worker once the chunk is on disk.
+class DiskInsertContext : public InsertContext {
+public:
+  DiskInsertContext(LookupContext& lookup_context, DiskHttpCache& cache,
+                    Event::Dispatcher& dispatcher)
+      : key_(dynamic_cast<DiskLookupContext&>(lookup_context).request().key()), cache_(cache),
+        dispatcher_(dispatcher), strand_(std::make_shared<DiskIoThreadPool::Strand>()),
+        file_(std::make_shared<PendingEntryFile>()) {}
+
+  ~DiskInsertContext() override {
+    {
+      absl::MutexLock lock(&file_->mutex_);
+      file_->abandoned_ = true;
+    }
+    if (started_ && !committed_) {
+      // The insertion was abandoned before the end of the response.
+      post([](DiskHttpCache&, PendingEntryFile& file) { abortFile(file); });
+    }
+  }
+
+  void insertHeaders(const Http::ResponseHeaderMap& response_headers, bool end_stream) override {
+    ASSERT(!committed_);
+    ASSERT(!started_);
+    started_ = true;
+    post([temp_path = cache_.tempFilePath(key_), key = key_.SerializeAsString(),
+          headers = encodeHeaders(response_headers)](DiskHttpCache&, PendingEntryFile& file) {
+      file.temp_path_ = temp_path;
+      file.fd_ = ::open(file.temp_path_.c_str(), O_CREAT | O_EXCL | O_WRONLY | O_CLOEXEC, 0600);
+      if (file.fd_ < 0) {
+        file.failed_ = true;
+        return;
+      }
+      // The body size isn't known yet; it is patched in by commit().
+      if (!writeEntryStart(file.fd_, key, headers, 0)) {
+        abortFile(file);
+      }
+    });
+    if (end_stream) {
+      commit();
+    }
+  }
+
+  void insertBody(const Buffer::Instance& chunk, InsertCallback ready_for_next_chunk,
+                  bool end_stream) override {
+    ASSERT(!committed_);
+    ASSERT(ready_for_next_chunk || end_stream);
+    auto data = std::make_shared<Buffer::OwnedImpl>();
+    data->add(chunk);
+    body_size_ += chunk.length();
+    post([&dispatcher = dispatcher_, data, ready_for_next_chunk = std::move(ready_for_next_chunk),
+          end_stream](DiskHttpCache&, PendingEntryFile& file) {
+      bool ok = !file.failed_;
+      for (const Buffer::RawSlice& slice : data->getRawSlices()) {
+        if (ok && !writeAll(file.fd_, slice.mem_, slice.len_)) {
+          abortFile(file);
+          ok = false;
+        }
+      }
+      if (!end_stream) {
+        postReady(dispatcher, file, ready_for_next_chunk, ok);
+      } else if (!ok && ready_for_next_chunk) {
+        postReady(dispatcher, file, ready_for_next_chunk, false);
+      }
+    });
+    if (end_stream) {
+      commit();
+    }
+  }
+
+  void insertTrailers(const Http::ResponseTrailerMap&) override {
+    // Trailers are not stored.
+    NOT_IMPLEMENTED_GCOVR_EXCL_LINE;
+  }
+
+  void onInsertComplete(InsertCompleteCallback on_complete) override {
+    ASSERT(committed_);
+    // Queued behind commit() on the insertion's strand, so the entry is in the index by the time
+    // on_complete runs.
+    post([on_complete = std::move(on_complete)](DiskHttpCache&, PendingEntryFile&) {
+      on_complete();
+    });
+  }
+
+private:
+  using Operation = std::function<void(DiskHttpCache&, PendingEntryFile&)>;
+
+  // Queues operation on the insertion's strand. Operations keep the file alive, and may outlive
+  // the insertion.
+  void post(Operation operation) {
+    cache_.ioThreads().post(strand_,
+                            [&cache = cache_, file = file_, operation = std::move(operation)]() {
+                              operation(cache, *file);
+                            });
+  }
+
+  // Runs ready_for_next_chunk(ok) on the worker thread, unless the insertion has been dropped by
+  // then. Called on an I/O thread.
+  static void postReady(Event::Dispatcher& dispatcher, PendingEntryFile& file,
+                        const InsertCallback& ready_for_next_chunk, bool ok) {
+    absl::MutexLock lock(&file.mutex_);
+    if (file.abandoned_) {
+      // The insertion, and possibly the worker's dispatcher, are gone.
+      return;
+    }
+    // The insertion may still be dropped before the callback runs.
+    dispatcher.post([file = file.shared_from_this(), ready_for_next_chunk, ok]() {
+      {
+        absl::MutexLock lock(&file->mutex_);
+        if (file->abandoned_) {
+          return;
+        }
+      }
+      ready_for_next_chunk(ok);
+    });
+  }
+
+  void commit() {
+    committed_ = true;
+    post([key = key_, body_size = body_size_](DiskHttpCache& cache, PendingEntryFile& file) {
+      if (file.failed_) {
+        return;
+      }
+      const off_t body_size_offset = offsetof(DiskEntryPrefix, body_size_);
+      const bool ok = ::pwrite(file.fd_, &body_size, sizeof(body_size), body_size_offset) ==
+                      static_cast<ssize_t>(sizeof(body_size));
+      struct stat file_stat;
+      if (!ok || ::fstat(file.fd_, &file_stat) != 0) {
+        abortFile(file);
+        return;
+      }
+      ::close(file.fd_);
+      file.fd_ = -1;
+      cache.commit(key, file.temp_path_, file_stat.st_size);
+    });
+  }
+
+  static void abortFile(PendingEntryFile& file) {
+    file.failed_ = true;
+    if (file.fd_ >= 0) {
+      ::close(file.fd_);
+      file.fd_ = -1;
+      ::unlink(file.temp_path_.c_str());
+    }
+  }
+
+  const Key key_;
+  DiskHttpCache& cache_;
+  Event::Dispatcher& dispatcher_;
+  const DiskIoThreadPool::StrandSharedPtr strand_;
+  const PendingEntryFileSharedPtr file_;
+  uint64_t body_size_ = 0;
+  bool started_ = false;
+  bool committed_ = false;
+};
+} // namespace
+
+MappedDiskEntrySharedPtr MappedDiskEntry::open(const std::string& path) {
+  const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return nullptr;
+  }
+  struct stat file_stat;
+  if (::fstat(fd, &file_stat) != 0 ||
+      static_cast<size_t>(file_stat.st_size) < sizeof(DiskEntryPrefix)) {
+    ::close(fd);
+    return nullptr;
+  }
+  const size_t size = file_stat.st_size;
+  void* data = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+  // The mapping remains valid after the descriptor is closed, and after the file is unlinked or
+  // replaced.
+  ::close(fd);
+  if (data == MAP_FAILED) {
+    return nullptr;
+  }
+  std::shared_ptr<MappedDiskEntry> entry(
+      new MappedDiskEntry(static_cast<const char*>(data), size, file_stat.st_ino));
+  if (!entry->parse()) {
+    return nullptr;
+  }
+  return entry;
+}
+
+MappedDiskEntry::~MappedDiskEntry() { ::munmap(const_cast<char*>(data_), size_); }
+
+bool MappedDiskEntry::parse() {
+  DiskEntryPrefix prefix;
+  memcpy(&prefix, data_, sizeof(prefix));
+  if (memcmp(prefix.magic_, EntryMagic, sizeof(EntryMagic)) != 0 ||
+      prefix.headers_capacity_ < sizeof(DiskHeadersRecord) ||
+      sizeof(prefix) + uint64_t(prefix.key_size_) + prefix.headers_capacity_ + prefix.body_size_ !=
+          size_) {
+    return false;
+  }
+  const char* pos = data_ + sizeof(prefix);
+  key_ = absl::string_view(pos, prefix.key_size_);
+  pos += prefix.key_size_;
+  headers_region_ = absl::string_view(pos, prefix.headers_capacity_);
+  pos += prefix.headers_capacity_;
+  body_ = absl::string_view(pos, prefix.body_size_);
+  return true;
+}
+
+Http::ResponseHeaderMapPtr MappedDiskEntry::headers() const {
+  // Work on a copy, so that a concurrent rewrite can't change the headers while they're checked
+  // and decoded.
+  DiskHeadersRecord record;
+  memcpy(&record, headers_region_.data(), sizeof(record));
+  if (record.size_ > headers_region_.size() - sizeof(record)) {
+    return nullptr;
+  }
+  const std::string encoded(headers_region_.substr(sizeof(record), record.size_));
+  if (HashUtil::xxHash64(encoded) != record.checksum_) {
+    return nullptr;
+  }
+
+  auto headers = Http::ResponseHeaderMapImpl::create();
+  absl::string_view remaining = encoded;
+  uint32_t sizes[2];
+  while (!remaining.empty()) {
+    if (remaining.size() < sizeof(sizes)) {
+      return nullptr;
+    }
+    memcpy(sizes, remaining.data(), sizeof(sizes));
+    remaining.remove_prefix(sizeof(sizes));
+    if (remaining.size() < uint64_t(sizes[0]) + sizes[1]) {
+      return nullptr;
+    }
+    headers->addCopy(Http::LowerCaseString(std::string(remaining.substr(0, sizes[0]))),
+                     remaining.substr(sizes[0], sizes[1]));
+    remaining.remove_prefix(sizes[0] + sizes[1]);
+  }
+  return headers;
+}
+
+DiskIoThreadPool::DiskIoThreadPool(Thread::ThreadFactory& thread_factory, uint32_t thread_count) {
+  ASSERT(thread_count > 0);
+  for (uint32_t i = 0; i < thread_count; ++i) {
+    threads_.push_back(thread_factory.createThread([this]() -> void { threadFunc(); },
+                                                   Thread::Options{"DiskCacheIo"}));
+  }
+}
+
+DiskIoThreadPool::~DiskIoThreadPool() {
+  {
+    Thread::LockGuard lock(lock_);
+    exit_ = true;
+    work_event_.notifyAll();
+  }
+  for (Thread::ThreadPtr& thread : threads_) {
+    thread->join();
+  }
+}
+
+void DiskIoThreadPool::post(const StrandSharedPtr& strand, std::function<void()> operation) {
+  Thread::LockGuard lock(lock_);
+  strand->operations_.push_back(std::move(operation));
+  if (!strand->scheduled_) {
+    strand->scheduled_ = true;
+    ready_.push_back(strand);
+    work_event_.notifyOne();
+  }
+}
+
+void DiskIoThreadPool::drain() {
+  Thread::LockGuard lock(lock_);
+  while (!ready_.empty() || running_ > 0) {
+    // CondVar::wait() does not throw, so it's safe to pass the mutex rather than the guard.
+    idle_event_.wait(lock_);
+  }
+}
+
+void DiskIoThreadPool::threadFunc() {
+  while (true) {
+    StrandSharedPtr strand;
+    std::function<void()> operation;
+    {
+      Thread::LockGuard lock(lock_);
+      while (ready_.empty() && !exit_) {
+        work_event_.wait(lock_);
+      }
+      // Queued operations still run after exit_ is set, so that no insertion is left half written.
+      if (ready_.empty()) {
+        return;
+      }
+      strand = std::move(ready_.front());
+      ready_.pop_front();
+      operation = std::move(strand->operations_.front());
+      strand->operations_.pop_front();
+      ++running_;
+    }
+
+    operation();
+
+    {
+      Thread::LockGuard lock(lock_);
+      --running_;
+      // The strand stays scheduled while its operation runs, so that post() doesn't hand its next
+      // operation to another thread.
+      if (strand->operations_.empty()) {
+        strand->scheduled_ = false;
+      } else {
+        ready_.push_back(std::move(strand));
+        work_event_.notifyOne();
+      }
+      if (ready_.empty() && running_ == 0) {
+        idle_event_.notifyAll();
+      }
+    }
+  }
+}
+
+DiskHttpCache::DiskHttpCache(const std::string& cache_path, uint64_t max_size_bytes,
+                             uint32_t io_threads, Thread::ThreadFactory& thread_factory)
+    : cache_path_(cache_path), max_size_bytes_(max_size_bytes),
+      io_threads_(thread_factory, io_threads) {
+  loadIndex();
+}
+
+std::string DiskHttpCache::entryPath(uint64_t hash) const {
+  return absl::StrCat(cache_path_, "/", absl::Hex(hash, absl::kZeroPad16), EntrySuffix);
+}
+
+void DiskHttpCache::loadIndex() {
+  absl::MutexLock lock(&mutex_);
+  for (const Filesystem::DirectoryEntry& dir_entry : Filesystem::Directory(cache_path_)) {
+    if (dir_entry.type_ != Filesystem::FileType::Regular) {
+      continue;
+    }
+    const std::string path = absl::StrCat(cache_path_, "/", dir_entry.name_);
+    if (absl::StrContains(dir_entry.name_, TempInfix)) {
+      // Either left behind by an insertion that never completed, or being written by another
+      // process sharing the directory, such as the other side of a hot restart.
+      if (!tempFileWriterAlive(dir_entry.name_)) {
+        ::unlink(path.c_str());
+      }
+      continue;
+    }
+    absl::string_view name = dir_entry.name_;
+    uint64_t hash;
+    if (!absl::ConsumeSuffix(&name, EntrySuffix) ||
+        !StringUtil::atoull(std::string(name).c_str(), hash, 16)) {
+      continue;
+    }
+    struct stat file_stat;
+    if (::stat(path.c_str(), &file_stat) != 0) {
+      continue;
+    }
+    lru_.push_front(hash);
+    index_[hash] = IndexEntry{static_cast<uint64_t>(file_stat.st_size), lru_.begin()};
+    size_bytes_ += file_stat.st_size;
+  }
+  evict();
+}
+
+MappedDiskEntrySharedPtr DiskHttpCache::lookup(const Key& key) {
+  const uint64_t hash = stableHashKey(key);
+  {
+    absl::MutexLock lock(&mutex_);
+    if (!index_.contains(hash)) {
+      return nullptr;
+    }
+    touch(hash);
+  }
+  MappedDiskEntrySharedPtr entry = MappedDiskEntry::open(entryPath(hash));
+  if (entry == nullptr || entry->key() != key.SerializeAsString()) {
+    // Either removed since the index was checked, corrupt, or a hash collision.
+    return nullptr;
+  }
+  return entry;
+}
+
+std::string DiskHttpCache::tempFilePath(const Key& key) {
+  absl::MutexLock lock(&mutex_);
+  return absl::StrCat(entryPath(stableHashKey(key)), TempInfix, getpid(), ".", next_temp_id_++);
+}
+
+void DiskHttpCache::commit(const Key& key, const std::string& temp_path, uint64_t size) {
+  const uint64_t hash = stableHashKey(key);
+  absl::MutexLock lock(&mutex_);
+  if (::rename(temp_path.c_str(), entryPath(hash).c_str()) != 0) {
+    ::unlink(temp_path.c_str());
+    return;
+  }
+  auto iter = index_.find(hash);
+  if (iter != index_.end()) {
+    size_bytes_ -= iter->second.size_;
+    iter->second.size_ = size;
+    touch(hash);
+  } else {
+    lru_.push_front(hash);
+    index_[hash] = IndexEntry{size, lru_.begin()};
+  }
+  size_bytes_ += size;
+  evict();
+}
+
+void DiskHttpCache::touch(uint64_t hash) {
+  auto& position = index_.at(hash).lru_position_;
+  lru_.splice(lru_.begin(), lru_, position);
+}
+
+void DiskHttpCache::evict() {
+  // Always keep the most recently used entry, even if it alone exceeds the budget.
+  while (size_bytes_ > max_size_bytes_ && lru_.size() > 1) {
+    const uint64_t hash = lru_.back();
+    lru_.pop_back();
+    size_bytes_ -= index_.at(hash).size_;
+    index_.erase(hash);
+    // Readers that have already mapped the file are unaffected.
+    ::unlink(entryPath(hash).c_str());
+  }
+}
+
+LookupContextPtr DiskHttpCache::makeLookupContext(LookupRequest&& request) {
+  return std::make_unique<DiskLookupContext>(*this, std::move(request));
+}
+
+InsertContextPtr DiskHttpCache::makeInsertContext(LookupContextPtr&& lookup_context,
+                                                 Event::Dispatcher& dispatcher) {
+  ASSERT(lookup_context != nullptr);
+  return std::make_unique<DiskInsertContext>(*lookup_context, *this, dispatcher);
+}
+
+void DiskHttpCache::updateHeaders(const LookupContext& lookup_context,
+                                  const Http::ResponseHeaderMap& response_headers) {
+  const auto& disk_lookup_context = dynamic_cast<const DiskLookupContext&>(lookup_context);
+  const MappedDiskEntrySharedPtr& entry = disk_lookup_context.entry();
+  if (entry == nullptr) {
+    return;
+  }
+  io_threads_.post(std::make_shared<DiskIoThreadPool::Strand>(),
+                   [this, key = disk_lookup_context.request().key(), entry,
+                    encoded_headers = encodeHeaders(response_headers)]() {
+                     rewriteHeaders(key, entry, encoded_headers);
+                   });
+}
+
+void DiskHttpCache::rewriteHeaders(const Key& key, const MappedDiskEntrySharedPtr& entry,
+                                   const std::string& encoded_headers) {
+  const std::string record = headersRecord(encoded_headers);
+  if (record.size() <= entry->headersCapacity()) {
+    const std::string path = entryPath(stableHashKey(key));
+    const int fd = ::open(path.c_str(), O_WRONLY | O_CLOEXEC);
+    if (fd < 0) {
+      return;
+    }
+    // Only update the file the lookup found; if it has been replaced since, the new entry has
+    // headers of its own.
+    struct stat file_stat;
+    if (::fstat(fd, &file_stat) == 0 && file_stat.st_ino == entry->inode()) {
+      // Readers that see a partly written region fail its checksum, and treat it as a miss.
+      const ssize_t rc = ::pwrite(fd, record.data(), record.size(), entry->headersOffset());
+      UNREFERENCED_PARAMETER(rc);
+    }
+    ::close(fd);
+    return;
+  }
+
+  // The headers have outgrown their region, so write a new file with the updated headers and the
+  // existing body, and swap it in.
+  const std::string temp_path = tempFilePath(key);
+  const int fd = ::open(temp_path.c_str(), O_CREAT | O_EXCL | O_WRONLY | O_CLOEXEC, 0600);
+  if (fd < 0) {
+    return;
+  }
+  const bool ok = writeEntryStart(fd, std::string(entry->key()), encoded_headers,
+                                  entry->body().size()) &&
+                  writeAll(fd, entry->body().data(), entry->body().size());
+  struct stat file_stat;
+  if (!ok || ::fstat(fd, &file_stat) != 0) {
+    ::close(fd);
+    ::unlink(temp_path.c_str());
+    return;
+  }
+  ::close(fd);
+  commit(key, temp_path, file_stat.st_size);
+}
+
+constexpr absl::string_view Name = "envoy.extensions.http.cache.disk";
+
+CacheInfo DiskHttpCache::cacheInfo() const {
+  CacheInfo cache_info;
+  cache_info.name_ = Name;
+  cache_info.supports_range_requests_ = true;
+  return cache_info;
+}
+
+uint64_t DiskHttpCache::sizeBytes() const {
+  absl::MutexLock lock(&mutex_);
+  return size_bytes_;
+}
+
+uint64_t DiskHttpCache::entryCount() const {
+  absl::MutexLock lock(&mutex_);
+  return index_.size();
+}
+
+class DiskHttpCacheFactory : public HttpCacheFactory {
+public:
+  // From UntypedFactory
+  std::string name() const override { return std::string(Name); }
+  // From TypedFactory
+  ProtobufTypes::MessagePtr createEmptyConfigProto() override {
+    return std::make_unique<envoy::source::extensions::filters::http::cache::DiskHttpCacheConfig>();
+  }
+  // From HttpCacheFactory
+  HttpCache&
+  getCache(const envoy::extensions::filters::http::cache::v3alpha::CacheConfig& config,
+           Server::Configuration::FactoryContext& context) override {
+    const auto disk_config = MessageUtil::anyConvertAndValidate<
+        envoy::source::extensions::filters::http::cache::DiskHttpCacheConfig>(
+        config.typed_config(), context.messageValidationVisitor());
+    // Filters configured with the same directory must share a cache, so that they agree on the
+    // index and the size budget.
+    absl::MutexLock lock(&mutex_);
+    auto& cache = caches_[disk_config.cache_path()];
+    if (cache == nullptr) {
+      cache = std::make_unique<DiskHttpCache>(
+          disk_config.cache_path(),
+          disk_config.max_size_bytes() > 0 ? disk_config.max_size_bytes()
+                                           : DiskHttpCache::DefaultMaxSizeBytes,
+          disk_config.io_threads() > 0 ? disk_config.io_threads()
+                                       : DiskHttpCache::DefaultIoThreads,
+          context.api().threadFactory());
+    }
+    return *cache;
+  }
+
+private:
+  absl::Mutex mutex_;
+  absl::flat_hash_map<std::string, std::unique_ptr<DiskHttpCache>> caches_ ABSL_GUARDED_BY(mutex_);
+};
+
+static Registry::RegisterFactory<DiskHttpCacheFactory, HttpCacheFactory> register_;
+
+} // namespace Cache
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,189 @@
+#pragma once
+
+#include <deque>
+#include <functional>
+#include <list>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "envoy/event/dispatcher.h"
+#include "envoy/thread/thread.h"
+
+#include "common/common/thread.h"
+
+#include "extensions/filters/http/cache/http_cache.h"
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Cache {
+
+// Fixed-size prefix of every entry file. It is followed by key_size bytes of serialized Key,
+// a headers region of headers_capacity bytes, and body_size bytes of body. Fields are in host
+// byte order; entry files are not meant to be moved between machines.
+struct DiskEntryPrefix {
+  char magic_[8];
+  uint32_t key_size_;
+  uint32_t headers_capacity_;
+  uint64_t body_size_;
+};
+static_assert(sizeof(DiskEntryPrefix) == 24, "DiskEntryPrefix must not be padded");
+
+// Start of the headers region. It is followed by size bytes of encoded response headers, and then
+// by unused space, so that the headers of a committed entry can be replaced in place. The checksum
+// lets readers detect a region that was being rewritten while they read it.
+struct DiskHeadersRecord {
+  uint32_t size_;
+  uint32_t reserved_;
+  uint64_t checksum_;
+};
+static_assert(sizeof(DiskHeadersRecord) == 16, "DiskHeadersRecord must not be padded");
+
+// Runs the blocking file operations of a DiskHttpCache on a pool of threads, so that they never
+// stall a worker thread. Operations queued on the same strand run one at a time, in the order they
+// were queued; operations on different strands may run concurrently.
+class DiskIoThreadPool {
+public:
+  class Strand {
+  private:
+    friend class DiskIoThreadPool;
+    // Guarded by the lock of the pool.
+    std::deque<std::function<void()>> operations_;
+    // Whether the strand is queued to run, or running, on a pool thread.
+    bool scheduled_{};
+  };
+  using StrandSharedPtr = std::shared_ptr<Strand>;
+
+  DiskIoThreadPool(Thread::ThreadFactory& thread_factory, uint32_t thread_count);
+  // Runs the operations still queued, and joins the threads.
+  ~DiskIoThreadPool();
+
+  // Queues operation to run on a pool thread, after the operations queued earlier on strand.
+  void post(const StrandSharedPtr& strand, std::function<void()> operation);
+  // Blocks until all operations queued so far have run.
+  void drain();
+
+private:
+  void threadFunc();
+
+  Thread::MutexBasicLockable lock_;
+  Thread::CondVar work_event_;
+  Thread::CondVar idle_event_;
+  // Strands with operations to run, none of which is running.
+  std::deque<StrandSharedPtr> ready_ ABSL_GUARDED_BY(lock_);
+  uint32_t running_ ABSL_GUARDED_BY(lock_){};
+  bool exit_ ABSL_GUARDED_BY(lock_){};
+  std::vector<Thread::ThreadPtr> threads_;
+};
+
+// A read-only memory mapping of a complete entry file. Body fragments handed out by lookups keep
+// the mapping alive, so only the pages covering the requested ranges are ever read from disk.
+class MappedDiskEntry {
+public:
+  // Maps the file at path, returning nullptr if it can't be mapped or isn't a valid entry file.
+  static std::shared_ptr<const MappedDiskEntry> open(const std::string& path);
+  ~MappedDiskEntry();
+
+  absl::string_view key() const { return key_; }
+  absl::string_view body() const { return body_; }
+  // Identifies the file the entry was mapped from.
+  uint64_t inode() const { return inode_; }
+  // Offset and size of the headers region within the file.
+  uint64_t headersOffset() const { return headers_region_.data() - data_; }
+  uint64_t headersCapacity() const { return headers_region_.size(); }
+  // Decodes the stored response headers into a new header map. The headers region may be
+  // rewritten while it is mapped, so this returns nullptr if it doesn't hold a complete record.
+  Http::ResponseHeaderMapPtr headers() const;
+
+private:
+  MappedDiskEntry(const char* data, size_t size, uint64_t inode)
+      : data_(data), size_(size), inode_(inode) {}
+  bool parse();
+
+  const char* const data_;
+  const size_t size_;
+  const uint64_t inode_;
+  absl::string_view key_;
+  absl::string_view headers_region_;
+  absl::string_view body_;
+};
+using MappedDiskEntrySharedPtr = std::shared_ptr<const MappedDiskEntry>;
+
+// Cache backend for objects too large to keep in memory. Each entry is stored in its own file,
+// named by the stable hash of its key, and read back through a memory mapping. Entries are written
+// to a temporary file as the response streams in, and renamed into place once complete, so readers
+// (including a later Envoy process after a restart) only ever see whole entries. An in-memory index
+// of entry sizes, rebuilt by scanning the directory at startup, bounds total disk usage. Writes
+// happen on a DiskIoThreadPool, and insertions learn that a chunk was written through a callback
+// posted to the dispatcher they were created with.
+class DiskHttpCache : public HttpCache {
+public:
+  static constexpr uint64_t DefaultMaxSizeBytes = 1024 * 1024 * 1024;
+  static constexpr uint32_t DefaultIoThreads = 2;
+
+  DiskHttpCache(const std::string& cache_path, uint64_t max_size_bytes, uint32_t io_threads,
+                Thread::ThreadFactory& thread_factory);
+
+  // HttpCache
+  LookupContextPtr makeLookupContext(LookupRequest&& request) override;
+  InsertContextPtr makeInsertContext(LookupContextPtr&& lookup_context,
+                                     Event::Dispatcher& dispatcher) override;
+  void updateHeaders(const LookupContext& lookup_context,
+                     const Http::ResponseHeaderMap& response_headers) override;
+  CacheInfo cacheInfo() const override;
+
+  // Maps the entry for key, or returns nullptr if there is none.
+  MappedDiskEntrySharedPtr lookup(const Key& key);
+  // Returns the name of a fresh temporary file for building an entry for key.
+  std::string tempFilePath(const Key& key);
+  // Atomically replaces the entry for key with the complete entry file at temp_path.
+  void commit(const Key& key, const std::string& temp_path, uint64_t size);
+
+  // Total size of the entry files currently indexed.
+  uint64_t sizeBytes() const;
+  // Number of entries currently indexed.
+  uint64_t entryCount() const;
+
+  DiskIoThreadPool& ioThreads() { return io_threads_; }
+
+private:
+  std::string entryPath(uint64_t hash) const;
+  // Indexes the complete entries left by a previous process, and removes the partial ones whose
+  // writer is no longer running.
+  void loadIndex();
+  // Replaces the headers of entry, in place if they fit in its headers region. Runs on an I/O
+  // thread.
+  void rewriteHeaders(const Key& key, const MappedDiskEntrySharedPtr& entry,
+                      const std::string& encoded_headers);
+  void touch(uint64_t hash) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  void evict() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  struct IndexEntry {
+    uint64_t size_;
+    // Position in lru_.
+    std::list<uint64_t>::iterator lru_position_;
+  };
+
+  const std::string cache_path_;
+  const uint64_t max_size_bytes_;
+  mutable absl::Mutex mutex_;
+  // Entries are indexed by stableHashKey(); lookups verify the full key stored in the file.
+  absl::flat_hash_map<uint64_t, IndexEntry> index_ ABSL_GUARDED_BY(mutex_);
+  // Entry hashes, ordered from most to least recently used.
+  std::list<uint64_t> lru_ ABSL_GUARDED_BY(mutex_);
+  uint64_t size_bytes_ ABSL_GUARDED_BY(mutex_) = 0;
+  uint64_t next_temp_id_ ABSL_GUARDED_BY(mutex_) = 0;
+  // Last, so that queued operations finish before the rest of the cache is destroyed.
+  DiskIoThreadPool io_threads_;
+};
+
+} // namespace Cache
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -13,6 +13,7 @@
 
 #include "extensions/filters/http/cache/inline_headers_handles.h"
 
+#include "absl/hash/hash.h"
 #include "absl/strings/str_split.h"
 #include "absl/strings/string_view.h"
 #include "absl/time/time.h"
@@ -60,6 +61,30 @@ LookupRequest::LookupRequest(const Http::RequestHeaderMap& request_headers, Syst
 size_t stableHashKey(const Key& key) { return MessageUtil::hash(key); }
 size_t localHashKey(const Key& key) { return stableHashKey(key); }
 
+size_t KeyHash::operator()(const Key& key) const {
+  size_t hash = absl::Hash<std::tuple<absl::string_view, absl::string_view, absl::string_view,
+                                      absl::string_view, bool>>()(
+      std::make_tuple(absl::string_view(key.cluster_name()), absl::string_view(key.host()),
+                      absl::string_view(key.path()), absl::string_view(key.query()),
+                      key.clear_http()));
+  for (const std::string& field : key.custom_fields()) {
+    hash = absl::Hash<std::pair<size_t, absl::string_view>>()({hash, field});
+  }
+  for (const int64_t field : key.custom_ints()) {
+    hash = absl::Hash<std::pair<size_t, int64_t>>()({hash, field});
+  }
+  return hash;
+}
+
+bool KeyEq::operator()(const Key& lhs, const Key& rhs) const {
+  return lhs.path() == rhs.path() && lhs.host() == rhs.host() && lhs.query() == rhs.query() &&
+         lhs.clear_http() == rhs.clear_http() && lhs.cluster_name() == rhs.cluster_name() &&
+         std::equal(lhs.custom_fields().begin(), lhs.custom_fields().end(),
+                    rhs.custom_fields().begin(), rhs.custom_fields().end()) &&
+         std::equal(lhs.custom_ints().begin(), lhs.custom_ints().end(), rhs.custom_ints().begin(),
+                    rhs.custom_ints().end());
+}
+
 void LookupRequest::initializeRequestCacheControl(const Http::RequestHeaderMap& request_headers) {
   const absl::string_view cache_control =
       request_headers.getInlineValue(request_cache_control_handle.handle());
@@ -75,7 +100,9 @@ void LookupRequest::initializeRequestCacheControl(const Http::RequestHeaderMap&
   }
 }
 
-bool LookupRequest::requiresValidation(const Http::ResponseHeaderMap& response_headers) const {
+CacheEntryStatus LookupRequest::freshnessStatus(const Http::ResponseHeaderMap& response_headers,
+                                                bool& serve_stale_on_error) const {
+  serve_stale_on_error = false;
   // TODO(yosrym93): Store parsed response cache-control in cache instead of parsing it on every
   // lookup.
   const absl::string_view cache_control =
@@ -86,7 +113,7 @@ bool LookupRequest::requiresValidation(const Http::ResponseHeaderMap& response_h
 
   if (timestamp_ < response_time) {
     // Response time is in the future, validate response.
-    return true;
+    return CacheEntryStatus::RequiresValidation;
   }
 
   const SystemTime::duration response_age = timestamp_ - response_time;
@@ -96,7 +123,7 @@ bool LookupRequest::requiresValidation(const Http::ResponseHeaderMap& response_h
       request_max_age_exceeded) {
     // Either the request or response explicitly require validation, or a request max-age
     // requirement is not satisfied.
-    return true;
+    return CacheEntryStatus::RequiresValidation;
   }
 
   // CacheabilityUtils::isCacheableResponse(..) guarantees that any cached response satisfies this.
@@ -112,19 +139,32 @@ bool LookupRequest::requiresValidation(const Http::ResponseHeaderMap& response_h
           : CacheHeadersUtils::httpTime(response_headers.get(Http::Headers::get().Expires));
 
   if (timestamp_ > expiration_time) {
-    // Response is stale, requires validation if
-    // the response does not allow being served stale,
-    // or the request max-stale directive does not allow it.
-    const bool allowed_by_max_stale =
-        request_cache_control_.max_stale_.has_value() &&
-        request_cache_control_.max_stale_.value() > timestamp_ - expiration_time;
-    return response_cache_control.no_stale_ || !allowed_by_max_stale;
+    // Response is stale. It may be served without validation only if the response does not
+    // forbid being served stale, and the request max-stale directive allows it.
+    if (response_cache_control.no_stale_) {
+      return CacheEntryStatus::RequiresValidation;
+    }
+    const SystemTime::duration staleness = timestamp_ - expiration_time;
+    const bool allowed_by_max_stale = request_cache_control_.max_stale_.has_value() &&
+                                      request_cache_control_.max_stale_.value() > staleness;
+    if (allowed_by_max_stale) {
+      return CacheEntryStatus::Ok;
+    }
+    // Otherwise, the response's stale-while-revalidate and stale-if-error directives may still
+    // allow serving it, according to: https://tools.ietf.org/html/rfc5861
+    serve_stale_on_error = response_cache_control.stale_if_error_.has_value() &&
+                           response_cache_control.stale_if_error_.value() >= staleness;
+    const bool allowed_by_stale_while_revalidate =
+        response_cache_control.stale_while_revalidate_.has_value() &&
+        response_cache_control.stale_while_revalidate_.value() >= staleness;
+    return allowed_by_stale_while_revalidate ? CacheEntryStatus::StaleWhileRevalidate
+                                             : CacheEntryStatus::RequiresValidation;
   } else {
     // Response is fresh, requires validation only if there is an unsatisfied min-fresh requirement.
     const bool min_fresh_unsatisfied =
         request_cache_control_.min_fresh_.has_value() &&
         request_cache_control_.min_fresh_.value() > expiration_time - timestamp_;
-    return min_fresh_unsatisfied;
+    return min_fresh_unsatisfied ? CacheEntryStatus::RequiresValidation : CacheEntryStatus::Ok;
   }
 }
 
@@ -133,9 +173,7 @@ LookupResult LookupRequest::makeLookupResult(Http::ResponseHeaderMapPtr&& respon
   // TODO(toddmgreer): Implement all HTTP caching semantics.
   ASSERT(response_headers);
   LookupResult result;
-  result.cache_entry_status_ = requiresValidation(*response_headers)
-                                   ? CacheEntryStatus::RequiresValidation
-                                   : CacheEntryStatus::Ok;
+  result.cache_entry_status_ = freshnessStatus(*response_headers, result.serve_stale_on_error_);
   result.headers_ = std::move(response_headers);
   result.content_length_ = content_length;
   if (!adjustByteRangeSet(result.response_ranges_, request_range_spec_, content_length)) {
@@ -7,8 +7,10 @@
 #include "envoy/buffer/buffer.h"
 #include "envoy/common/time.h"
 #include "envoy/config/typed_config.h"
+#include "envoy/event/dispatcher.h"
 #include "envoy/extensions/filters/http/cache/v3alpha/cache.pb.h"
 #include "envoy/http/header_map.h"
+#include "envoy/server/filter_config.h"
 
 #include "common/common/assert.h"
 #include "common/common/logger.h"
@@ -32,6 +34,9 @@ enum class CacheEntryStatus {
   Unusable,
   // This entry is stale, but appropriate for validating
   RequiresValidation,
+  // This entry is stale, but its stale-while-revalidate directive allows serving it while it is
+  // validated in the background.
+  StaleWhileRevalidate,
   // This entry is fresh, and an appropriate basis for a 304 Not Modified
   // response.
   FoundNotModified,
@@ -146,6 +151,10 @@ struct LookupResult {
   // TODO(toddmgreer): Implement trailer support.
   // True if the cached response has trailers.
   bool has_trailers_ = false;
+
+  // True if this entry requires validation, but its stale-if-error directive allows serving it
+  // anyway if the validation request fails with a server error.
+  bool serve_stale_on_error_ = false;
 };
 using LookupResultPtr = std::unique_ptr<LookupResult>;
 
@@ -164,6 +173,15 @@ using LookupResultPtr = std::unique_ptr<LookupResult>;
 // TODO(toddmgreer): Ensure that stability guarantees above are accurate.
 size_t stableHashKey(const Key& key);
 
+// Hash and equality functors for Key, for in-memory containers that are consulted on every request.
+// Unlike MessageUtil, they don't serialize the key. Not stable across restarts.
+struct KeyHash {
+  size_t operator()(const Key& key) const;
+};
+struct KeyEq {
+  bool operator()(const Key& lhs, const Key& rhs) const;
+};
+
 // LookupRequest holds everything about a request that's needed to look for a
 // response in a cache, to evaluate whether an entry from a cache is usable, and
 // to determine what ranges are needed.
@@ -194,7 +212,10 @@ public:
 
 private:
   void initializeRequestCacheControl(const Http::RequestHeaderMap& request_headers);
-  bool requiresValidation(const Http::ResponseHeaderMap& response_headers) const;
+  // Returns Ok, RequiresValidation or StaleWhileRevalidate, and sets serve_stale_on_error
+  // according to the response's stale-if-error directive.
+  CacheEntryStatus freshnessStatus(const Http::ResponseHeaderMap& response_headers,
+                                   bool& serve_stale_on_error) const;
 
   Key key_;
   std::vector<RawByteRange> request_range_spec_;
@@ -220,6 +241,7 @@ using LookupBodyCallback = std::function<void(Buffer::InstancePtr&&)>;
 using LookupHeadersCallback = std::function<void(LookupResult&&)>;
 using LookupTrailersCallback = std::function<void(Http::ResponseTrailerMapPtr&&)>;
 using InsertCallback = std::function<void(bool success_ready_for_more)>;
+using InsertCompleteCallback = std::function<void()>;
 
 // Manages the lifetime of an insertion.
 class InsertContext {
@@ -241,6 +263,13 @@ public:
   // Inserts trailers into the cache.
   virtual void insertTrailers(const Http::ResponseTrailerMap& trailers) PURE;
 
+  // Called after the final insert call. Runs on_complete once the insertion has
+  // finished, successfully or not, and its entry (if any) is visible to
+  // lookups. on_complete may run on any thread, and may run after the
+  // InsertContextPtr has been dropped. The default runs it right away, which
+  // suits caches whose entries are visible once the final insert call returns.
+  virtual void onInsertComplete(InsertCompleteCallback on_complete) { on_complete(); }
+
   virtual ~InsertContext() = default;
 };
 using InsertContextPtr = std::unique_ptr<InsertContext>;
@@ -291,8 +320,10 @@ public:
 
   // Returns an InsertContextPtr to manage the state of a cache insertion.
   // Responses with a chunked transfer-encoding must be dechunked before
-  // insertion.
-  virtual InsertContextPtr makeInsertContext(LookupContextPtr&& lookup_context) PURE;
+  // insertion. dispatcher is that of the calling thread; caches that complete
+  // insertions asynchronously run the InsertContext's callbacks on it.
+  virtual InsertContextPtr makeInsertContext(LookupContextPtr&& lookup_context,
+                                             Event::Dispatcher& dispatcher) PURE;
 
   // Precondition: lookup_context represents a prior cache lookup that required
   // validation.
@@ -320,7 +351,8 @@ public:
   // Returns an HttpCache that will remain valid indefinitely (at least as long
   // as the calling CacheFilter).
   virtual HttpCache&
-  getCache(const envoy::extensions::filters::http::cache::v3alpha::CacheConfig& config) PURE;
+  getCache(const envoy::extensions::filters::http::cache::v3alpha::CacheConfig& config,
+           Server::Configuration::FactoryContext& context) PURE;
   ~HttpCacheFactory() override = default;
 
 private:
@@ -0,0 +1,332 @@
+#include "extensions/filters/http/cache/lru_http_cache/lru_http_cache.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "envoy/registry/registry.h"
+
+#include "common/buffer/buffer_impl.h"
+#include "common/http/header_map_impl.h"
+#include "common/protobuf/utility.h"
+
+#include "source/extensions/filters/http/cache/lru_http_cache/config.pb.h"
+#include "source/extensions/filters/http/cache/lru_http_cache/config.pb.validate.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Cache {
+namespace {
+
+class LruLookupContext : public LookupContext {
+public:
+  LruLookupContext(LruHttpCache& cache, LookupRequest&& request)
+      : cache_(cache), request_(std::move(request)) {}
+
+  void getHeaders(LookupHeadersCallback&& cb) override {
+    auto entry = cache_.lookup(request_);
+    body_ = std::move(entry.body_);
+    cb(entry.response_headers_
+           ? request_.makeLookupResult(std::move(entry.response_headers_), body_->length())
+           : LookupResult{});
+  }
+
+  void getBody(const AdjustedByteRange& range, LookupBodyCallback&& cb) override {
+    ASSERT(body_ != nullptr);
+    ASSERT(range.end() <= body_->length(), "Attempt to read past end of body.");
+    // Hand out fragments referencing the stored body's slices instead of copying the range. Each
+    // fragment holds a reference to the body, which is dropped when the buffer releases it.
+    auto buffer = std::make_unique<Buffer::OwnedImpl>();
+    uint64_t slice_begin = 0;
+    for (const Buffer::RawSlice& slice : body_->getRawSlices()) {
+      const uint64_t slice_end = slice_begin + slice.len_;
+      const uint64_t begin = std::max(slice_begin, range.begin());
+      const uint64_t end = std::min(slice_end, range.end());
+      if (begin < end) {
+        auto* fragment = new Buffer::BufferFragmentImpl(
+            static_cast<const char*>(slice.mem_) + (begin - slice_begin), end - begin,
+            [body = body_](const void*, size_t, const Buffer::BufferFragmentImpl* fragment) {
+              delete fragment;
+            });
+        buffer->addBufferFragment(*fragment);
+      }
+      if (slice_end >= range.end()) {
+        break;
+      }
+      slice_begin = slice_end;
+    }
+    cb(std::move(buffer));
+  }
+
+  void getTrailers(LookupTrailersCallback&&) override {
+    // TODO(toddmgreer): Support trailers.
+    NOT_IMPLEMENTED_GCOVR_EXCL_LINE;
+  }
+
+  const LookupRequest& request() const { return request_; }
+
+private:
+  LruHttpCache& cache_;
+  const LookupRequest request_;
+  std::shared_ptr<const Buffer::Instance> body_;
+};
+
+class LruInsertContext : public InsertContext {
+public:
+  LruInsertContext(LookupContext& lookup_context, LruHttpCache& cache)
+      : key_(dynamic_cast<LruLookupContext&>(lookup_context).request().key()), cache_(cache) {}
+
+  void insertHeaders(const Http::ResponseHeaderMap& response_headers, bool end_stream) override {
+    ASSERT(!committed_);
+    response_headers_ = Http::createHeaderMap<Http::ResponseHeaderMapImpl>(response_headers);
+    if (end_stream) {
+      commit();
+    }
+  }
+
+  void insertBody(const Buffer::Instance& chunk, InsertCallback ready_for_next_chunk,
+                  bool end_stream) override {
+    ASSERT(!committed_);
+    ASSERT(ready_for_next_chunk || end_stream);
+
+    body_.add(chunk);
+    if (end_stream) {
+      commit();
+    } else {
+      ready_for_next_chunk(true);
+    }
+  }
+
+  void insertTrailers(const Http::ResponseTrailerMap&) override {
+    NOT_IMPLEMENTED_GCOVR_EXCL_LINE; // TODO(toddmgreer): support trailers
+  }
+
+private:
+  void commit() {
+    committed_ = true;
+    cache_.insert(key_, std::move(response_headers_), body_);
+  }
+
+  Key key_;
+  Http::ResponseHeaderMapPtr response_headers_;
+  LruHttpCache& cache_;
+  Buffer::OwnedImpl body_;
+  bool committed_ = false;
+};
+
+uint64_t entryCharge(const Key& key, const Http::ResponseHeaderMap& response_headers,
+                     const Buffer::Instance& body) {
+  return key.ByteSizeLong() + response_headers.byteSize() + body.length();
+}
+} // namespace
+
+bool LruHttpCache::Shard::lookup(const Key& key, SharedHeaders& response_headers,
+                                 std::shared_ptr<const Buffer::Instance>& body) {
+  absl::MutexLock lock(&mutex_);
+  auto iter = index_.find(key);
+  if (iter == index_.end()) {
+    return false;
+  }
+  promote(iter->second);
+  response_headers = iter->second->response_headers_;
+  body = iter->second->body_;
+  return true;
+}
+
+void LruHttpCache::Shard::insert(const Key& key, SharedHeaders&& response_headers,
+                                 std::shared_ptr<const Buffer::Instance>&& body) {
+  const uint64_t charge = entryCharge(key, *response_headers, *body);
+  absl::MutexLock lock(&mutex_);
+  auto iter = index_.find(key);
+  if (iter != index_.end()) {
+    erase(iter->second);
+    index_.erase(iter);
+  }
+  if (charge > max_size_bytes_) {
+    // Would evict the whole shard and still not fit.
+    return;
+  }
+  probation_.push_front(StoredEntry{key, std::move(response_headers), std::move(body), charge});
+  probation_bytes_ += charge;
+  index_.emplace(probation_.front().key_, probation_.begin());
+  evict();
+}
+
+void LruHttpCache::Shard::updateHeaders(const Key& key, SharedHeaders&& response_headers) {
+  absl::MutexLock lock(&mutex_);
+  auto iter = index_.find(key);
+  if (iter == index_.end()) {
+    return;
+  }
+  StoredEntry& entry = *iter->second;
+  uint64_t& segment_bytes = entry.protected_ ? protected_bytes_ : probation_bytes_;
+  segment_bytes -= entry.charge_;
+  entry.charge_ = entryCharge(key, *response_headers, *entry.body_);
+  entry.response_headers_ = std::move(response_headers);
+  segment_bytes += entry.charge_;
+  evict();
+}
+
+uint64_t LruHttpCache::Shard::sizeBytes() const {
+  absl::MutexLock lock(&mutex_);
+  return probation_bytes_ + protected_bytes_;
+}
+
+uint64_t LruHttpCache::Shard::entryCount() const {
+  absl::MutexLock lock(&mutex_);
+  return index_.size();
+}
+
+void LruHttpCache::Shard::erase(EntryList::iterator it) {
+  if (it->protected_) {
+    protected_bytes_ -= it->charge_;
+    protected_.erase(it);
+  } else {
+    probation_bytes_ -= it->charge_;
+    probation_.erase(it);
+  }
+}
+
+void LruHttpCache::Shard::promote(EntryList::iterator it) {
+  if (it->protected_) {
+    protected_.splice(protected_.begin(), protected_, it);
+    return;
+  }
+  probation_bytes_ -= it->charge_;
+  protected_bytes_ += it->charge_;
+  it->protected_ = true;
+  protected_.splice(protected_.begin(), probation_, it);
+  // Demote the least recently used protected entries back to probation, where they get one more
+  // chance to be hit before being evicted.
+  while (protected_bytes_ > max_protected_bytes_) {
+    auto demoted = std::prev(protected_.end());
+    protected_bytes_ -= demoted->charge_;
+    probation_bytes_ += demoted->charge_;
+    demoted->protected_ = false;
+    probation_.splice(probation_.begin(), protected_, demoted);
+  }
+}
+
+void LruHttpCache::Shard::evict() {
+  while (probation_bytes_ + protected_bytes_ > max_size_bytes_) {
+    // Prefer evicting from probation, but never evict an entry that was just admitted in favour
+    // of ones that have proven themselves by being hit.
+    EntryList& victims = probation_.size() > 1 || protected_.empty() ? probation_ : protected_;
+    ASSERT(!victims.empty());
+    auto victim = std::prev(victims.end());
+    index_.erase(victim->key_);
+    erase(victim);
+  }
+}
+
+LruHttpCache::LruHttpCache(uint64_t max_size_bytes, uint32_t shard_count) {
+  ASSERT(shard_count > 0);
+  shards_.reserve(shard_count);
+  for (uint32_t i = 0; i < shard_count; ++i) {
+    shards_.push_back(std::make_unique<Shard>(max_size_bytes / shard_count));
+  }
+}
+
+LookupContextPtr LruHttpCache::makeLookupContext(LookupRequest&& request) {
+  return std::make_unique<LruLookupContext>(*this, std::move(request));
+}
+
+InsertContextPtr LruHttpCache::makeInsertContext(LookupContextPtr&& lookup_context,
+                                                Event::Dispatcher&) {
+  ASSERT(lookup_context != nullptr);
+  return std::make_unique<LruInsertContext>(*lookup_context, *this);
+}
+
+void LruHttpCache::updateHeaders(const LookupContext& lookup_context,
+                                 const Http::ResponseHeaderMap& response_headers) {
+  const Key& key = dynamic_cast<const LruLookupContext&>(lookup_context).request().key();
+  shardFor(key).updateHeaders(
+      key, Http::createHeaderMap<Http::ResponseHeaderMapImpl>(response_headers));
+}
+
+LruHttpCache::Entry LruHttpCache::lookup(const LookupRequest& request) {
+  SharedHeaders response_headers;
+  std::shared_ptr<const Buffer::Instance> body;
+  if (!shardFor(request.key()).lookup(request.key(), response_headers, body)) {
+    return Entry{};
+  }
+  // Copy the headers outside of the shard lock.
+  return Entry{Http::createHeaderMap<Http::ResponseHeaderMapImpl>(*response_headers),
+               std::move(body)};
+}
+
+void LruHttpCache::insert(const Key& key, Http::ResponseHeaderMapPtr&& response_headers,
+                          Buffer::Instance& body) {
+  // Move the body's slices into a buffer of its own, outside of the shard lock.
+  auto stored_body = std::make_shared<Buffer::OwnedImpl>();
+  stored_body->move(body);
+  shardFor(key).insert(key, std::move(response_headers), std::move(stored_body));
+}
+
+uint64_t LruHttpCache::sizeBytes() const {
+  uint64_t size = 0;
+  for (const auto& shard : shards_) {
+    size += shard->sizeBytes();
+  }
+  return size;
+}
+
+uint64_t LruHttpCache::entryCount() const {
+  uint64_t count = 0;
+  for (const auto& shard : shards_) {
+    count += shard->entryCount();
+  }
+  return count;
+}
+
+constexpr absl::string_view Name = "envoy.extensions.http.cache.lru";
+
+CacheInfo LruHttpCache::cacheInfo() const {
+  CacheInfo cache_info;
+  cache_info.name_ = Name;
+  cache_info.supports_range_requests_ = true;
+  return cache_info;
+}
+
+class LruHttpCacheFactory : public HttpCacheFactory {
+public:
+  // From UntypedFactory
+  std::string name() const override { return std::string(Name); }
+  // From TypedFactory
+  ProtobufTypes::MessagePtr createEmptyConfigProto() override {
+    return std::make_unique<envoy::source::extensions::filters::http::cache::LruHttpCacheConfig>();
+  }
+  // From HttpCacheFactory
+  HttpCache&
+  getCache(const envoy::extensions::filters::http::cache::v3alpha::CacheConfig& config,
+           Server::Configuration::FactoryContext& context) override {
+    const auto lru_config = MessageUtil::anyConvertAndValidate<
+        envoy::source::extensions::filters::http::cache::LruHttpCacheConfig>(
+        config.typed_config(), context.messageValidationVisitor());
+    const uint64_t max_size_bytes = lru_config.max_size_bytes() > 0
+                                        ? lru_config.max_size_bytes()
+                                        : LruHttpCache::DefaultMaxSizeBytes;
+    const uint32_t shard_count =
+        lru_config.shard_count() > 0 ? lru_config.shard_count() : LruHttpCache::DefaultShardCount;
+    // Filters configured with the same limits share a cache, so that they share its budget. Filters
+    // with different limits each get a cache of their own.
+    absl::MutexLock lock(&mutex_);
+    auto& cache = caches_[std::make_pair(max_size_bytes, shard_count)];
+    if (cache == nullptr) {
+      cache = std::make_unique<LruHttpCache>(max_size_bytes, shard_count);
+    }
+    return *cache;
+  }
+
+private:
+  absl::Mutex mutex_;
+  absl::flat_hash_map<std::pair<uint64_t, uint32_t>, std::unique_ptr<LruHttpCache>>
+      caches_ ABSL_GUARDED_BY(mutex_);
+};
+
+static Registry::RegisterFactory<LruHttpCacheFactory, HttpCacheFactory> register_;
+
+} // namespace Cache
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <list>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "envoy/buffer/buffer.h"
+
+#include "extensions/filters/http/cache/http_cache.h"
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Cache {
+
+// In-memory cache backend with a byte budget. Entries are spread over independently locked shards
+// by key hash, so concurrent lookups from different workers rarely contend. Each shard evicts using
+// a segmented LRU: new entries are admitted to a probationary segment and are only promoted to the
+// protected segment when hit again, so a burst of one-hit wonders can't flush the working set.
+//
+// Bodies are stored as immutable refcounted buffers whose slices are moved in from the insert
+// context, and getBody() hands out buffer fragments that reference those slices; a body stays
+// alive while any response is still streaming it, even if the entry has since been evicted or
+// replaced.
+class LruHttpCache : public HttpCache {
+public:
+  static constexpr uint64_t DefaultMaxSizeBytes = 64 * 1024 * 1024;
+  static constexpr uint32_t DefaultShardCount = 16;
+  // Percentage of each shard's budget that may be used by the protected segment.
+  static constexpr uint64_t ProtectedPercent = 80;
+
+  struct Entry {
+    Http::ResponseHeaderMapPtr response_headers_;
+    std::shared_ptr<const Buffer::Instance> body_;
+  };
+
+  LruHttpCache(uint64_t max_size_bytes, uint32_t shard_count);
+
+  // HttpCache
+  LookupContextPtr makeLookupContext(LookupRequest&& request) override;
+  InsertContextPtr makeInsertContext(LookupContextPtr&& lookup_context,
+                                     Event::Dispatcher& dispatcher) override;
+  void updateHeaders(const LookupContext& lookup_context,
+                     const Http::ResponseHeaderMap& response_headers) override;
+  CacheInfo cacheInfo() const override;
+
+  // Returns a copy of the headers and a reference to the body of the entry for the request's key,
+  // or an Entry with null headers if there is none. Counts as a hit for eviction purposes.
+  Entry lookup(const LookupRequest& request);
+  // Moves the contents of body into the cache.
+  void insert(const Key& key, Http::ResponseHeaderMapPtr&& response_headers,
+              Buffer::Instance& body);
+
+  // Total bytes charged to entries currently held by the cache.
+  uint64_t sizeBytes() const;
+  // Number of entries currently held by the cache.
+  uint64_t entryCount() const;
+
+private:
+  // Cached headers are shared so that lookups can copy them after releasing the shard lock.
+  using SharedHeaders = std::shared_ptr<const Http::ResponseHeaderMap>;
+
+  struct StoredEntry {
+    Key key_;
+    SharedHeaders response_headers_;
+    std::shared_ptr<const Buffer::Instance> body_;
+    // Bytes charged against the shard's budget for this entry.
+    uint64_t charge_;
+    bool protected_ = false;
+  };
+  using EntryList = std::list<StoredEntry>;
+
+  class Shard {
+  public:
+    explicit Shard(uint64_t max_size_bytes)
+        : max_size_bytes_(max_size_bytes),
+          max_protected_bytes_(max_size_bytes * ProtectedPercent / 100) {}
+
+    bool lookup(const Key& key, SharedHeaders& response_headers,
+                std::shared_ptr<const Buffer::Instance>& body);
+    void insert(const Key& key, SharedHeaders&& response_headers,
+                std::shared_ptr<const Buffer::Instance>&& body);
+    void updateHeaders(const Key& key, SharedHeaders&& response_headers);
+    uint64_t sizeBytes() const;
+    uint64_t entryCount() const;
+
+  private:
+    void erase(EntryList::iterator it) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+    void promote(EntryList::iterator it) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+    void evict() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+    const uint64_t max_size_bytes_;
+    const uint64_t max_protected_bytes_;
+    mutable absl::Mutex mutex_;
+    absl::flat_hash_map<Key, EntryList::iterator, KeyHash, KeyEq> index_ ABSL_GUARDED_BY(mutex_);
+    // Both lists are ordered from most to least recently used.
+    EntryList probation_ ABSL_GUARDED_BY(mutex_);
+    EntryList protected_ ABSL_GUARDED_BY(mutex_);
+    uint64_t probation_bytes_ ABSL_GUARDED_BY(mutex_) = 0;
+    uint64_t protected_bytes_ ABSL_GUARDED_BY(mutex_) = 0;
+  };
+
+  // Uses the high bits of the hash so that the low bits, which the shard's own hash map relies on,
+  // still vary within a shard.
+  Shard& shardFor(const Key& key) { return *shards_[(KeyHash()(key) >> 32) % shards_.size()]; }
+
+  std::vector<std::unique_ptr<Shard>> shards_;
+};
+
+} // namespace Cache
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,91 @@
+#include "extensions/filters/http/cache/request_collapser.h"
+
+#include "common/protobuf/utility.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Cache {
+
+namespace {
+constexpr uint64_t DefaultWaitTimeoutMs = 5000;
+
+RequestCollapsingStats generateStats(const std::string& prefix, Stats::Scope& scope) {
+  const std::string final_prefix = prefix + "cache.request_collapsing.";
+  return RequestCollapsingStats{
+      ALL_REQUEST_COLLAPSING_STATS(POOL_COUNTER_PREFIX(scope, final_prefix))};
+}
+} // namespace
+
+class RequestCollapser::LeaderImpl : public CollapsedFill {
+public:
+  LeaderImpl(std::shared_ptr<RequestCollapser> parent, const Key& key)
+      : parent_(std::move(parent)), key_(key) {}
+  ~LeaderImpl() override { parent_->complete(key_); }
+
+  // CollapsedFill
+  bool isLeader() const override { return true; }
+
+private:
+  // Shared, as the handle may outlive the filter configuration while the cache commits the fill.
+  const std::shared_ptr<RequestCollapser> parent_;
+  const Key key_;
+};
+
+class RequestCollapser::FollowerImpl : public CollapsedFill {
+public:
+  explicit FollowerImpl(std::shared_ptr<std::function<void()>> on_fill_complete)
+      : on_fill_complete_(std::move(on_fill_complete)) {}
+
+  // CollapsedFill
+  bool isLeader() const override { return false; }
+
+private:
+  // The collapser only holds a weak reference, so dropping this cancels the callback.
+  const std::shared_ptr<std::function<void()>> on_fill_complete_;
+};
+
+RequestCollapser::RequestCollapser(
+    const envoy::extensions::filters::http::cache::v3alpha::CacheConfig::RequestCollapsing& config,
+    const std::string& stats_prefix, Stats::Scope& scope)
+    : wait_timeout_(PROTOBUF_GET_MS_OR_DEFAULT(config, wait_timeout, DefaultWaitTimeoutMs)),
+      stats_(generateStats(stats_prefix, scope)) {}
+
+CollapsedFillPtr RequestCollapser::join(const Key& key, Event::Dispatcher& dispatcher,
+                                        std::function<void()> on_fill_complete) {
+  absl::MutexLock lock(&mutex_);
+  auto iter = fills_.find(key);
+  if (iter == fills_.end()) {
+    fills_.emplace(key, std::vector<Follower>());
+    return std::make_unique<LeaderImpl>(shared_from_this(), key);
+  }
+  auto callback = std::make_shared<std::function<void()>>(std::move(on_fill_complete));
+  iter->second.push_back(Follower{&dispatcher, callback});
+  return std::make_unique<FollowerImpl>(std::move(callback));
+}
+
+void RequestCollapser::complete(const Key& key) {
+  std::vector<Follower> followers;
+  {
+    absl::MutexLock lock(&mutex_);
+    auto iter = fills_.find(key);
+    ASSERT(iter != fills_.end());
+    followers = std::move(iter->second);
+    fills_.erase(iter);
+  }
+  ENVOY_LOG(debug, "cache fill complete, waking {} collapsed requests", followers.size());
+  for (Follower& follower : followers) {
+    // The callback runs on the follower's worker, which is also the only thread that can drop the
+    // follower's handle, so checking the weak reference there is race free.
+    follower.dispatcher_->post([on_fill_complete = std::move(follower.on_fill_complete_)]() {
+      if (auto callback = on_fill_complete.lock()) {
+        (*callback)();
+      }
+    });
+  }
+}
+
+} // namespace Cache
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
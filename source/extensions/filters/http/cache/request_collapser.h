@@ -0,0 +1,105 @@
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "envoy/event/dispatcher.h"
+#include "envoy/stats/scope.h"
+#include "envoy/stats/stats_macros.h"
+
+#include "common/common/logger.h"
+
+#include "extensions/filters/http/cache/http_cache.h"
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Cache {
+
+/**
+ * All request collapsing stats. @see stats_macros.h
+ */
+#define ALL_REQUEST_COLLAPSING_STATS(COUNTER)                                                      \
+  COUNTER(collapsed)                                                                               \
+  COUNTER(forwarded)                                                                               \
+  COUNTER(wait_timeout)
+
+/**
+ * Struct definition for request collapsing stats. @see stats_macros.h
+ */
+struct RequestCollapsingStats {
+  ALL_REQUEST_COLLAPSING_STATS(GENERATE_COUNTER_STRUCT)
+};
+
+/**
+ * Handle on a request's part in an in-progress cache fill; see RequestCollapser::join.
+ */
+class CollapsedFill {
+public:
+  virtual ~CollapsedFill() = default;
+
+  /**
+   * @return true if the request holding this handle is the one sent upstream to fill the cache.
+   * Dropping a leader handle completes the fill and wakes up its followers; it may be dropped on
+   * any thread, so that it can be held until the cache has committed the response. Dropping a
+   * follower handle stops waiting for the fill.
+   */
+  virtual bool isLeader() const PURE;
+};
+using CollapsedFillPtr = std::unique_ptr<CollapsedFill>;
+
+/**
+ * Tracks in-progress cache fills, so that concurrent misses for the same key on any worker wait
+ * for a single upstream request to fill the cache instead of each being sent upstream. Shared by
+ * all CacheFilters created from the same configuration.
+ */
+class RequestCollapser : public std::enable_shared_from_this<RequestCollapser>,
+                         Logger::Loggable<Logger::Id::cache_filter> {
+public:
+  RequestCollapser(
+      const envoy::extensions::filters::http::cache::v3alpha::CacheConfig::RequestCollapsing&
+          config,
+      const std::string& stats_prefix, Stats::Scope& scope);
+
+  /**
+   * Joins the fill for key after a cache miss. If no fill for key is in progress, the caller
+   * becomes its leader. Otherwise the caller is a follower, and on_fill_complete is posted to
+   * dispatcher when the leader drops its handle.
+   */
+  CollapsedFillPtr join(const Key& key, Event::Dispatcher& dispatcher,
+                        std::function<void()> on_fill_complete);
+
+  std::chrono::milliseconds waitTimeout() const { return wait_timeout_; }
+  RequestCollapsingStats& stats() { return stats_; }
+
+private:
+  class LeaderImpl;
+  class FollowerImpl;
+
+  struct Follower {
+    Event::Dispatcher* dispatcher_;
+    // Expires when the follower stops waiting.
+    std::weak_ptr<std::function<void()>> on_fill_complete_;
+  };
+
+  void complete(const Key& key);
+
+  const std::chrono::milliseconds wait_timeout_;
+  RequestCollapsingStats stats_;
+  absl::Mutex mutex_;
+  // Followers waiting for each in-progress fill.
+  absl::flat_hash_map<Key, std::vector<Follower>, KeyHash, KeyEq> fills_ ABSL_GUARDED_BY(mutex_);
+};
+using RequestCollapserSharedPtr = std::shared_ptr<RequestCollapser>;
+
+} // namespace Cache
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
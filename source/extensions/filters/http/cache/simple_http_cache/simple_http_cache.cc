@@ -116,7 +116,8 @@ void SimpleHttpCache::insert(const Key& key, Http::ResponseHeaderMapPtr&& respon
   map_[key] = SimpleHttpCache::Entry{std::move(response_headers), std::move(body)};
 }
 
-InsertContextPtr SimpleHttpCache::makeInsertContext(LookupContextPtr&& lookup_context) {
+InsertContextPtr SimpleHttpCache::makeInsertContext(LookupContextPtr&& lookup_context,
+                                                   Event::Dispatcher&) {
   ASSERT(lookup_context != nullptr);
   return std::make_unique<SimpleInsertContext>(*lookup_context, *this);
 }
@@ -140,7 +141,8 @@ public:
   }
   // From HttpCacheFactory
   HttpCache&
-  getCache(const envoy::extensions::filters::http::cache::v3alpha::CacheConfig&) override {
+  getCache(const envoy::extensions::filters::http::cache::v3alpha::CacheConfig&,
+           Server::Configuration::FactoryContext&) override {
     return cache_;
   }
 
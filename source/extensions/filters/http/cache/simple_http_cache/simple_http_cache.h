@@ -24,7 +24,8 @@ private:
 public:
   // HttpCache
   LookupContextPtr makeLookupContext(LookupRequest&& request) override;
-  InsertContextPtr makeInsertContext(LookupContextPtr&& lookup_context) override;
+  InsertContextPtr makeInsertContext(LookupContextPtr&& lookup_context,
+                                     Event::Dispatcher& dispatcher) override;
   void updateHeaders(const LookupContext& lookup_context,
                      const Http::ResponseHeaderMap& response_headers) override;
   CacheInfo cacheInfo() const override;
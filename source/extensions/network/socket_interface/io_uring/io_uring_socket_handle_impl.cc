@@ -0,0 +1,296 @@
+#include "extensions/network/socket_interface/io_uring/io_uring_socket_handle_impl.h"
+
+#include <poll.h>
+
+#include <algorithm>
+#include <cstring>
+
+#include "common/api/os_sys_calls_impl.h"
+#include "common/common/assert.h"
+
+#include "extensions/network/socket_interface/io_uring/io_uring_socket_interface.h"
+
+#ifndef POLLRDHUP
+// io_uring is Linux only, so this is never polled for elsewhere.
+#define POLLRDHUP 0
+#endif
+
+namespace Envoy {
+namespace Extensions {
+namespace SocketInterfaces {
+namespace IoUring {
+
+IoUringFileEvent::IoUringFileEvent(IoUringSocketHandleImpl& handle, Event::Dispatcher& dispatcher,
+                                   Event::FileReadyCb cb, uint32_t events)
+    : handle_(&handle), cb_(cb), activation_cb_(dispatcher.createSchedulableCallback([this]() {
+        if (pending_events_ != 0) {
+          runCb(0);
+        }
+      })),
+      write_event_(dispatcher.createFileEvent(
+          handle.fd(), [this](uint32_t events) { runCb(events); }, Event::FileTriggerType::Edge,
+          events & Event::FileReadyType::Write)),
+      enabled_(events) {}
+
+IoUringFileEvent::~IoUringFileEvent() {
+  if (destroyed_ != nullptr) {
+    *destroyed_ = true;
+  }
+  if (handle_ != nullptr) {
+    handle_->onFileEventDestroyed();
+  }
+}
+
+void IoUringFileEvent::activate(uint32_t events) {
+  ASSERT(events != 0);
+  // As for other file events, injected events are delivered in the next loop iteration.
+  if (pending_events_ == 0) {
+    activation_cb_->scheduleCallbackNextIteration();
+  }
+  pending_events_ |= events;
+}
+
+void IoUringFileEvent::notify(uint32_t events) {
+  ASSERT(events != 0);
+  pending_events_ |= events;
+  activation_cb_->scheduleCallbackCurrentIteration();
+}
+
+void IoUringFileEvent::setEnabled(uint32_t events) {
+  // Pending events may no longer be relevant, and the handle reports again what is ready.
+  pending_events_ = 0;
+  activation_cb_->cancel();
+  enabled_ = events;
+  write_event_->setEnabled(events & Event::FileReadyType::Write);
+  if (handle_ != nullptr) {
+    handle_->onFileEventEnabled(events);
+  }
+}
+
+void IoUringFileEvent::runCb(uint32_t events) {
+  events |= pending_events_;
+  pending_events_ = 0;
+  activation_cb_->cancel();
+
+  bool destroyed = false;
+  destroyed_ = &destroyed;
+  cb_(events);
+  if (destroyed) {
+    return;
+  }
+  destroyed_ = nullptr;
+  // Readiness is reported once, so wait for more of it.
+  if (handle_ != nullptr) {
+    handle_->postRead();
+  }
+}
+
+IoUringSocketHandleImpl::IoUringSocketHandleImpl(const IoUringSocketInterface& socket_interface,
+                                                 os_fd_t fd, bool socket_v6only)
+    : IoSocketHandleImpl(fd, socket_v6only), socket_interface_(socket_interface) {}
+
+IoUringSocketHandleImpl::~IoUringSocketHandleImpl() {
+  if (file_event_ != nullptr) {
+    file_event_->onHandleDestroyed();
+  }
+  // The destructor of the base class doesn't reach this close().
+  if (SOCKET_VALID(fd_)) {
+    IoUringSocketHandleImpl::close();
+  }
+}
+
+Api::IoCallUint64Result IoUringSocketHandleImpl::close() {
+  if (worker_ != nullptr) {
+    if (read_request_ != nullptr) {
+      // The kernel holds on to the socket until the request is cancelled.
+      worker_->cancel(*read_request_);
+      read_request_ = nullptr;
+    }
+    releaseReadBuffer();
+  }
+  return IoSocketHandleImpl::close();
+}
+
+Api::IoCallUint64Result IoUringSocketHandleImpl::readv(uint64_t max_length,
+                                                       Buffer::RawSlice* slices,
+                                                       uint64_t num_slice) {
+  if (worker_ == nullptr) {
+    return IoSocketHandleImpl::readv(max_length, slices, num_slice);
+  }
+  read_ahead_ = true;
+
+  if (read_buffer_.has_value()) {
+    const uint8_t* data = worker_->readBuffer(*read_buffer_);
+    uint64_t num_bytes_read = 0;
+    for (uint64_t i = 0;
+         i < num_slice && num_bytes_read < max_length && read_offset_ < read_length_; i++) {
+      const uint64_t length =
+          std::min({static_cast<uint64_t>(slices[i].len_), max_length - num_bytes_read,
+                    static_cast<uint64_t>(read_length_ - read_offset_)});
+      memcpy(slices[i].mem_, data + read_offset_, length);
+      read_offset_ += length;
+      num_bytes_read += length;
+    }
+    if (read_offset_ == read_length_) {
+      releaseReadBuffer();
+      postRead();
+    }
+    return Api::IoCallUint64Result(
+        num_bytes_read, Api::IoErrorPtr(nullptr, Network::IoSocketError::deleteIoError));
+  }
+  if (read_errno_ != 0) {
+    return sysCallResultToIoCallResult(Api::SysCallSizeResult{-1, read_errno_});
+  }
+  if (eof_) {
+    return Api::ioCallUint64ResultNoError();
+  }
+  if (read_request_ != nullptr && read_request_->type_ == IoUringRequest::Type::Read) {
+    return sysCallResultToIoCallResult(Api::SysCallSizeResult{-1, SOCKET_ERROR_AGAIN});
+  }
+
+  // Nothing was read ahead, e.g. as readv() wasn't called before, so read in place and have the
+  // following reads done ahead.
+  Api::IoCallUint64Result result = IoSocketHandleImpl::readv(max_length, slices, num_slice);
+  if (result.ok() && result.rc_ == 0) {
+    eof_ = true;
+  } else if (result.ok() || result.err_->getErrorCode() == Api::IoError::IoErrorCode::Again) {
+    postRead();
+  }
+  return result;
+}
+
+Network::IoHandlePtr IoUringSocketHandleImpl::accept(struct sockaddr* addr, socklen_t* addrlen) {
+  auto result = Api::OsSysCallsSingleton::get().accept(fd_, addr, addrlen);
+  if (SOCKET_INVALID(result.rc_)) {
+    return nullptr;
+  }
+
+  return std::make_unique<IoUringSocketHandleImpl>(socket_interface_, result.rc_, socket_v6only_);
+}
+
+Event::FileEventPtr IoUringSocketHandleImpl::createFileEvent(Event::Dispatcher& dispatcher,
+                                                             Event::FileReadyCb cb,
+                                                             Event::FileTriggerType trigger,
+                                                             uint32_t events) {
+  // Completions report readiness once, as edge triggered events do.
+  if (trigger == Event::FileTriggerType::Edge && file_event_ == nullptr) {
+    IoUringWorkerSharedPtr worker = socket_interface_.workerForDispatcher(dispatcher);
+    if (worker != nullptr && (worker_ == nullptr || worker_ == worker)) {
+      worker_ = std::move(worker);
+      auto file_event = std::make_unique<IoUringFileEvent>(*this, dispatcher, cb, events);
+      file_event_ = file_event.get();
+      onFileEventEnabled(events);
+      return file_event;
+    }
+  }
+  return IoSocketHandleImpl::createFileEvent(dispatcher, cb, trigger, events);
+}
+
+void IoUringSocketHandleImpl::onRequestCompleted(IoUringRequest& request, int32_t result) {
+  ASSERT(&request == read_request_);
+  read_request_ = nullptr;
+
+  if (request.type_ == IoUringRequest::Type::Read) {
+    if (result > 0) {
+      read_buffer_ = request.buffer_index_;
+      read_offset_ = 0;
+      read_length_ = result;
+      onReadable(false);
+      return;
+    }
+    worker_->releaseReadBuffer(request.buffer_index_);
+    if (result == -EAGAIN) {
+      // Kernels without IORING_FEAT_FAST_POLL complete reads of drained sockets right away.
+      read_request_ = &worker_->submitPoll(*this, fd_, IoUringRequest::Type::PollIn,
+                                           POLLIN | POLLRDHUP);
+      return;
+    }
+    if (result == 0) {
+      eof_ = true;
+    } else {
+      read_errno_ = -result;
+    }
+    onReadable(true);
+    return;
+  }
+
+  ASSERT(request.type_ == IoUringRequest::Type::PollIn);
+  // A failed poll is left for the next read to report.
+  const uint32_t poll_events = result < 0 ? POLLIN : result;
+  peer_closed_ = peer_closed_ || (poll_events & (POLLRDHUP | POLLHUP | POLLERR)) != 0;
+  onReadable(peer_closed_);
+}
+
+void IoUringSocketHandleImpl::onFileEventEnabled(uint32_t events) {
+  uint32_t ready = 0;
+  if (events & Event::FileReadyType::Read) {
+    if (read_buffer_.has_value() || eof_ || read_errno_ != 0 || read_ready_) {
+      ready |= Event::FileReadyType::Read;
+    }
+    read_ready_ = false;
+    // A poll for the peer closing doesn't notice data.
+    if (read_request_ != nullptr && read_request_->type_ == IoUringRequest::Type::PollIn &&
+        !(read_request_->poll_mask_ & POLLIN)) {
+      worker_->cancel(*read_request_);
+      read_request_ = nullptr;
+    }
+  } else if ((events & Event::FileReadyType::Closed) &&
+             (peer_closed_ || eof_ || read_errno_ != 0)) {
+    ready |= Event::FileReadyType::Closed;
+  }
+  if (ready != 0) {
+    file_event_->activate(ready);
+  }
+  postRead();
+}
+
+void IoUringSocketHandleImpl::postRead() {
+  if (file_event_ == nullptr || read_request_ != nullptr || !SOCKET_VALID(fd_) || eof_ ||
+      read_errno_ != 0) {
+    return;
+  }
+  const uint32_t enabled = file_event_->enabled();
+  if (enabled & Event::FileReadyType::Read) {
+    // Without reads ahead, a closed peer was already reported once and would be reported forever.
+    if (read_buffer_.has_value() || (peer_closed_ && !read_ahead_)) {
+      return;
+    }
+    if (read_ahead_) {
+      const absl::optional<uint32_t> buffer_index = worker_->acquireReadBuffer();
+      if (buffer_index.has_value()) {
+        read_request_ = &worker_->submitRead(*this, fd_, *buffer_index);
+        return;
+      }
+    }
+    read_request_ =
+        &worker_->submitPoll(*this, fd_, IoUringRequest::Type::PollIn, POLLIN | POLLRDHUP);
+  } else if ((enabled & Event::FileReadyType::Closed) && !peer_closed_) {
+    read_request_ = &worker_->submitPoll(*this, fd_, IoUringRequest::Type::PollIn, POLLRDHUP);
+  }
+}
+
+void IoUringSocketHandleImpl::onReadable(bool peer_closed) {
+  const uint32_t enabled = file_event_ != nullptr ? file_event_->enabled() : 0;
+  if (enabled & Event::FileReadyType::Read) {
+    file_event_->notify(Event::FileReadyType::Read);
+    return;
+  }
+  read_ready_ = true;
+  if ((enabled & Event::FileReadyType::Closed) && peer_closed) {
+    file_event_->notify(Event::FileReadyType::Closed);
+  }
+  // Keep watching for the peer closing.
+  postRead();
+}
+
+void IoUringSocketHandleImpl::releaseReadBuffer() {
+  if (read_buffer_.has_value()) {
+    worker_->releaseReadBuffer(*read_buffer_);
+    read_buffer_.reset();
+  }
+}
+
+} // namespace IoUring
+} // namespace SocketInterfaces
+} // namespace Extensions
+} // namespace Envoy
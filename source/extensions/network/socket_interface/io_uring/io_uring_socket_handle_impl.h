@@ -0,0 +1,127 @@
+#pragma once
+
+#include <cstdint>
+
+#include "envoy/event/dispatcher.h"
+#include "envoy/event/file_event.h"
+#include "envoy/event/schedulable_cb.h"
+
+#include "common/network/io_socket_handle_impl.h"
+
+#include "extensions/network/socket_interface/io_uring/io_uring_worker.h"
+
+#include "absl/types/optional.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace SocketInterfaces {
+namespace IoUring {
+
+class IoUringSocketInterface;
+class IoUringSocketHandleImpl;
+
+/**
+ * File event of an IoUringSocketHandleImpl. Read and Closed readiness is reported by the
+ * completions of the io_uring requests of the handle. Write readiness is left to an edge triggered
+ * event of the dispatcher, which only fires once a full socket drains, so that writes made
+ * straight to the fd, e.g. by TLS, are covered as well.
+ */
+class IoUringFileEvent : public Event::FileEvent {
+public:
+  IoUringFileEvent(IoUringSocketHandleImpl& handle, Event::Dispatcher& dispatcher,
+                   Event::FileReadyCb cb, uint32_t events);
+  ~IoUringFileEvent() override;
+
+  // Event::FileEvent
+  void activate(uint32_t events) override;
+  void setEnabled(uint32_t events) override;
+
+  uint32_t enabled() const { return enabled_; }
+
+  /**
+   * Reports readiness found by a completion, which is delivered in the current loop iteration as
+   * readiness of the fd would be.
+   */
+  void notify(uint32_t events);
+
+  /**
+   * Called when the handle goes away before its file event.
+   */
+  void onHandleDestroyed() { handle_ = nullptr; }
+
+private:
+  void runCb(uint32_t events);
+
+  IoUringSocketHandleImpl* handle_;
+  const Event::FileReadyCb cb_;
+  Event::SchedulableCallbackPtr activation_cb_;
+  Event::FileEventPtr write_event_;
+  uint32_t enabled_;
+  uint32_t pending_events_{};
+  // Set by the destructor, when it is called from within cb_.
+  bool* destroyed_{};
+};
+
+/**
+ * IoHandle of the sockets of IoUringSocketInterface. Data is read ahead into the read buffers of
+ * the IoUringWorker of the thread, so that readv() copies it out without a system call. Writes
+ * are left to writev(), which doesn't block the loop for non blocking sockets and lets callers
+ * shut down a socket right after writing to it. Consumers which read the fd directly, e.g. TLS,
+ * never call readv() and are only told of readability through io_uring polls.
+ */
+class IoUringSocketHandleImpl : public Network::IoSocketHandleImpl {
+public:
+  IoUringSocketHandleImpl(const IoUringSocketInterface& socket_interface, os_fd_t fd,
+                          bool socket_v6only);
+  ~IoUringSocketHandleImpl() override;
+
+  // Network::IoHandle
+  Api::IoCallUint64Result close() override;
+  Api::IoCallUint64Result readv(uint64_t max_length, Buffer::RawSlice* slices,
+                                uint64_t num_slice) override;
+  Network::IoHandlePtr accept(struct sockaddr* addr, socklen_t* addrlen) override;
+  Event::FileEventPtr createFileEvent(Event::Dispatcher& dispatcher, Event::FileReadyCb cb,
+                                      Event::FileTriggerType trigger, uint32_t events) override;
+  // Data read ahead would be skipped by splice(), and the fd can only have one file event.
+  bool supportsSplice() const override { return false; }
+
+  /**
+   * Called by the IoUringWorker when a request of this handle completes.
+   * @param request supplies the request, which is deleted after the call.
+   * @param result supplies the result of the request, or -errno.
+   */
+  void onRequestCompleted(IoUringRequest& request, int32_t result);
+
+private:
+  friend class IoUringFileEvent;
+
+  void onFileEventEnabled(uint32_t events);
+  void onFileEventDestroyed() { file_event_ = nullptr; }
+  // Queues a read or a poll for what the file event is enabled for, unless one is in flight or
+  // readiness is already known.
+  void postRead();
+  void onReadable(bool peer_closed);
+  void releaseReadBuffer();
+
+  const IoUringSocketInterface& socket_interface_;
+  IoUringWorkerSharedPtr worker_;
+  IoUringFileEvent* file_event_{};
+  // The read or poll in flight, if any.
+  IoUringRequest* read_request_{};
+  // The data read ahead and not yet copied out by readv().
+  absl::optional<uint32_t> read_buffer_;
+  uint32_t read_offset_{};
+  uint32_t read_length_{};
+  int read_errno_{};
+  bool eof_{};
+  bool peer_closed_{};
+  // Whether readiness was found while Read wasn't enabled.
+  bool read_ready_{};
+  // Whether the consumer reads through readv(), so data may be read ahead for it.
+  bool read_ahead_{};
+};
+
+} // namespace IoUring
+} // namespace SocketInterfaces
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,88 @@
+#include "extensions/network/socket_interface/io_uring/io_uring_socket_interface.h"
+
+#include "envoy/common/exception.h"
+#include "envoy/registry/registry.h"
+
+#include "common/protobuf/utility.h"
+
+#include "extensions/network/socket_interface/io_uring/io_uring_socket_handle_impl.h"
+#include "extensions/network/socket_interface/io_uring/ring.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace SocketInterfaces {
+namespace IoUring {
+
+Network::IoHandlePtr IoUringSocketInterface::socket(os_fd_t fd) {
+  return std::make_unique<IoUringSocketHandleImpl>(*this, fd, false);
+}
+
+Network::IoHandlePtr IoUringSocketInterface::makeSocket(os_fd_t socket_fd,
+                                                        bool socket_v6only) const {
+  return std::make_unique<IoUringSocketHandleImpl>(*this, socket_fd, socket_v6only);
+}
+
+IoUringWorkerSharedPtr
+IoUringSocketInterface::workerForDispatcher(Event::Dispatcher& dispatcher) const {
+  if (tls_ == nullptr || !tls_->currentThreadRegistered()) {
+    return nullptr;
+  }
+  auto worker = std::static_pointer_cast<IoUringWorker>(tls_->get());
+  // Connections may be handed to the dispatcher of another thread before they are used.
+  if (worker == nullptr || &worker->dispatcher() != &dispatcher) {
+    return nullptr;
+  }
+  return worker;
+}
+
+Server::BootstrapExtensionPtr IoUringSocketInterface::createBootstrapExtension(
+    const Protobuf::Message& config, Server::Configuration::ServerFactoryContext& context) {
+  const auto& io_uring_config = MessageUtil::downcastAndValidate<
+      const envoy::extensions::network::socket_interface::io_uring::v3::IoUringSocketInterface&>(
+      config, context.messageValidationContext().staticValidationVisitor());
+  return std::make_unique<IoUringSocketInterfaceExtension>(*this, io_uring_config, context);
+}
+
+ProtobufTypes::MessagePtr IoUringSocketInterface::createEmptyConfigProto() {
+  return std::make_unique<
+      envoy::extensions::network::socket_interface::io_uring::v3::IoUringSocketInterface>();
+}
+
+IoUringSocketInterfaceExtension::IoUringSocketInterfaceExtension(
+    IoUringSocketInterface& socket_interface,
+    const envoy::extensions::network::socket_interface::io_uring::v3::IoUringSocketInterface&
+        config,
+    Server::Configuration::ServerFactoryContext& context)
+    : Network::SocketInterfaceExtension(socket_interface), socket_interface_(socket_interface),
+      ring_size_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, ring_size, 512)),
+      read_buffer_size_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, read_buffer_size, 16384)),
+      read_buffer_count_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, read_buffer_count, 256)),
+      tls_(context.threadLocal().allocateSlot()) {
+  socket_interface_.tls_ = tls_.get();
+  // Workers can only be set up once the main thread and the worker threads are registered.
+  startup_handle_ = context.lifecycleNotifier().registerCallback(
+      Server::ServerLifecycleNotifier::Stage::Startup, [this]() {
+        tls_->set([ring_size = ring_size_, read_buffer_size = read_buffer_size_,
+                   read_buffer_count = read_buffer_count_](
+                      Event::Dispatcher& dispatcher) -> ThreadLocal::ThreadLocalObjectSharedPtr {
+          try {
+            return std::make_shared<IoUringWorker>(dispatcher, std::make_unique<Ring>(ring_size),
+                                                   read_buffer_size, read_buffer_count);
+          } catch (const EnvoyException& e) {
+            ENVOY_LOG(warn, "io_uring is not used on this thread: {}", e.what());
+            return nullptr;
+          }
+        });
+      });
+}
+
+IoUringSocketInterfaceExtension::~IoUringSocketInterfaceExtension() {
+  socket_interface_.tls_ = nullptr;
+}
+
+REGISTER_FACTORY(IoUringSocketInterface, Server::Configuration::BootstrapExtensionFactory);
+
+} // namespace IoUring
+} // namespace SocketInterfaces
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "envoy/extensions/network/socket_interface/io_uring/v3/io_uring_socket_interface.pb.h"
+#include "envoy/server/lifecycle_notifier.h"
+#include "envoy/thread_local/thread_local.h"
+
+#include "common/common/logger.h"
+#include "common/network/socket_interface.h"
+#include "common/network/socket_interface_impl.h"
+
+#include "extensions/network/socket_interface/io_uring/io_uring_worker.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace SocketInterfaces {
+namespace IoUring {
+
+/**
+ * Socket interface which creates IoUringSocketHandleImpl handles. It only takes effect once its
+ * bootstrap extension has set up the io_uring worker of each thread.
+ */
+class IoUringSocketInterface : public Network::SocketInterfaceImpl {
+public:
+  // Network::SocketInterface
+  using Network::SocketInterfaceImpl::socket;
+  Network::IoHandlePtr socket(os_fd_t fd) override;
+
+  // Server::Configuration::BootstrapExtensionFactory
+  Server::BootstrapExtensionPtr
+  createBootstrapExtension(const Protobuf::Message& config,
+                           Server::Configuration::ServerFactoryContext& context) override;
+  ProtobufTypes::MessagePtr createEmptyConfigProto() override;
+  std::string name() const override { return "envoy.extensions.network.socket_interface.io_uring"; }
+
+  /**
+   * @return the io_uring worker of the thread running dispatcher, or nullptr if the thread has
+   *         none, in which case handles behave as the ones of the default socket interface.
+   */
+  IoUringWorkerSharedPtr workerForDispatcher(Event::Dispatcher& dispatcher) const;
+
+protected:
+  // Network::SocketInterfaceImpl
+  Network::IoHandlePtr makeSocket(os_fd_t socket_fd, bool socket_v6only) const override;
+
+private:
+  friend class IoUringSocketInterfaceExtension;
+
+  // The slot of the workers, owned by the bootstrap extension.
+  ThreadLocal::Slot* tls_{};
+};
+
+/**
+ * Bootstrap extension of IoUringSocketInterface, which sets up an io_uring worker on each thread
+ * once the threads are registered.
+ */
+class IoUringSocketInterfaceExtension : public Network::SocketInterfaceExtension,
+                                        Logger::Loggable<Logger::Id::io> {
+public:
+  IoUringSocketInterfaceExtension(
+      IoUringSocketInterface& socket_interface,
+      const envoy::extensions::network::socket_interface::io_uring::v3::IoUringSocketInterface&
+          config,
+      Server::Configuration::ServerFactoryContext& context);
+  ~IoUringSocketInterfaceExtension() override;
+
+private:
+  IoUringSocketInterface& socket_interface_;
+  const uint32_t ring_size_;
+  const uint32_t read_buffer_size_;
+  const uint32_t read_buffer_count_;
+  ThreadLocal::SlotPtr tls_;
+  Server::ServerLifecycleNotifier::HandlePtr startup_handle_;
+};
+
+DECLARE_FACTORY(IoUringSocketInterface);
+
+} // namespace IoUring
+} // namespace SocketInterfaces
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,193 @@
+#include "extensions/network/socket_interface/io_uring/io_uring_worker.h"
+
+#include "envoy/common/exception.h"
+
+#include "common/common/assert.h"
+#include "common/common/fmt.h"
+#include "common/common/utility.h"
+
+#include "extensions/network/socket_interface/io_uring/io_uring_socket_handle_impl.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace SocketInterfaces {
+namespace IoUring {
+
+IoUringWorker::IoUringWorker(Event::Dispatcher& dispatcher, std::unique_ptr<Ring> ring,
+                             uint32_t read_buffer_size, uint32_t read_buffer_count)
+    : dispatcher_(dispatcher), ring_(std::move(ring)), read_buffer_size_(read_buffer_size),
+      read_buffers_size_(static_cast<uint64_t>(read_buffer_size) * read_buffer_count) {
+  void* read_buffers = ::mmap(nullptr, read_buffers_size_, PROT_READ | PROT_WRITE,
+                              MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (read_buffers == MAP_FAILED) {
+    throw EnvoyException(
+        fmt::format("unable to allocate io_uring read buffers: {}", errorDetails(errno)));
+  }
+  read_buffers_ = static_cast<uint8_t*>(read_buffers);
+
+  // Registered buffers are pinned once rather than on each read. Registration counts against
+  // RLIMIT_MEMLOCK, so plain receives into the same buffers are used when it fails.
+  std::vector<iovec> iovecs(read_buffer_count);
+  free_read_buffers_.reserve(read_buffer_count);
+  for (uint32_t i = 0; i < read_buffer_count; ++i) {
+    iovecs[i].iov_base = readBuffer(i);
+    iovecs[i].iov_len = read_buffer_size_;
+    // Hand out the lowest indexes first.
+    free_read_buffers_.push_back(read_buffer_count - 1 - i);
+  }
+  const int error = ring_->registerBuffers(iovecs);
+  if (error != 0) {
+    ENVOY_LOG(debug, "unable to register io_uring read buffers, using recv: {}",
+              errorDetails(error));
+  }
+  read_buffers_registered_ = error == 0;
+
+  submit_cb_ = dispatcher_.createSchedulableCallback([this]() { submit(); });
+  // The ring fd stays readable while completions are waiting.
+  ring_event_ = dispatcher_.createFileEvent(
+      ring_->fd(),
+      [this](uint32_t) {
+        ring_->forEachCompletion(
+            [this](uint64_t user_data, int32_t result) { onCompletion(user_data, result); });
+        // Reaping may have made room for the requests which are waiting.
+        if ((!backlog_.empty() || ring_->numPrepared() > 0) && !submit_cb_->enabled()) {
+          submit_cb_->scheduleCallbackCurrentIteration();
+        }
+      },
+      Event::FileTriggerType::Level, Event::FileReadyType::Read);
+}
+
+IoUringWorker::~IoUringWorker() {
+  ring_event_.reset();
+  submit_cb_.reset();
+  // Closing the ring cancels the requests in flight, after which their buffers may be released.
+  ring_.reset();
+  for (IoUringRequest* request : requests_) {
+    // Handles keep their worker alive, so none is left waiting.
+    ASSERT(request->handle_ == nullptr);
+    delete request;
+  }
+  ::munmap(read_buffers_, read_buffers_size_);
+}
+
+absl::optional<uint32_t> IoUringWorker::acquireReadBuffer() {
+  if (free_read_buffers_.empty()) {
+    return absl::nullopt;
+  }
+  const uint32_t index = free_read_buffers_.back();
+  free_read_buffers_.pop_back();
+  return index;
+}
+
+void IoUringWorker::releaseReadBuffer(uint32_t index) { free_read_buffers_.push_back(index); }
+
+IoUringRequest& IoUringWorker::submitRead(IoUringSocketHandleImpl& handle, os_fd_t fd,
+                                          uint32_t buffer_index) {
+  auto request = std::make_unique<IoUringRequest>(IoUringRequest::Type::Read, &handle, fd);
+  request->buffer_index_ = buffer_index;
+  return queue(std::move(request));
+}
+
+IoUringRequest& IoUringWorker::submitPoll(IoUringSocketHandleImpl& handle, os_fd_t fd,
+                                          IoUringRequest::Type type, uint32_t poll_mask) {
+  ASSERT(type == IoUringRequest::Type::PollIn || type == IoUringRequest::Type::PollOut);
+  auto request = std::make_unique<IoUringRequest>(type, &handle, fd);
+  request->poll_mask_ = poll_mask;
+  return queue(std::move(request));
+}
+
+void IoUringWorker::cancel(IoUringRequest& request) {
+  ASSERT(request.type_ != IoUringRequest::Type::Cancel);
+  request.handle_ = nullptr;
+  if (!request.prepared_) {
+    // The kernel never saw the request.
+    backlog_.remove(&request);
+    requests_.erase(&request);
+    if (request.type_ == IoUringRequest::Type::Read) {
+      releaseReadBuffer(request.buffer_index_);
+    }
+    delete &request;
+    return;
+  }
+  // Until it is submitted, the request only carries the fd number, which the handle is about to
+  // close and which may be handed out again right away, e.g. by an accept() in the same loop
+  // iteration. It is turned into a no-op so it never reaches a socket it wasn't meant for.
+  if (ring_->discardUnsubmitted(reinterpret_cast<uint64_t>(&request))) {
+    return;
+  }
+  // Submitted requests hold on to their socket until they complete, so the kernel keeps it open
+  // until the cancellation is processed. The request may complete before the cancellation is
+  // processed, which then completes with -ENOENT. Either way the request is deleted when its own
+  // completion arrives. Requests are only deleted while reaping, and are prepared in queueing
+  // order, so the target address can't be reused by another request before the kernel processes the
+  // cancellation.
+  auto cancel = std::make_unique<IoUringRequest>(IoUringRequest::Type::Cancel, nullptr,
+                                                 INVALID_SOCKET);
+  cancel->target_ = reinterpret_cast<uint64_t>(&request);
+  queue(std::move(cancel));
+}
+
+IoUringRequest& IoUringWorker::queue(std::unique_ptr<IoUringRequest> request) {
+  IoUringRequest& queued = *request;
+  requests_.insert(request.release());
+  // Requests which are waiting for room go first, to keep the order.
+  if (!backlog_.empty() || !prepare(queued)) {
+    backlog_.push_back(&queued);
+  }
+  if (!submit_cb_->enabled()) {
+    submit_cb_->scheduleCallbackCurrentIteration();
+  }
+  return queued;
+}
+
+bool IoUringWorker::prepare(IoUringRequest& request) {
+  const uint64_t user_data = reinterpret_cast<uint64_t>(&request);
+  switch (request.type_) {
+  case IoUringRequest::Type::Read: {
+    uint8_t* buffer = readBuffer(request.buffer_index_);
+    request.prepared_ =
+        read_buffers_registered_
+            ? ring_->prepareReadFixed(request.fd_, buffer, read_buffer_size_,
+                                      request.buffer_index_, user_data)
+            : ring_->prepareRecv(request.fd_, buffer, read_buffer_size_, user_data);
+    break;
+  }
+  case IoUringRequest::Type::PollIn:
+  case IoUringRequest::Type::PollOut:
+    request.prepared_ = ring_->preparePoll(request.fd_, request.poll_mask_, user_data);
+    break;
+  case IoUringRequest::Type::Cancel:
+    request.prepared_ = ring_->prepareCancel(request.target_, user_data);
+    break;
+  }
+  return request.prepared_;
+}
+
+void IoUringWorker::submit() {
+  while (!backlog_.empty() && prepare(*backlog_.front())) {
+    backlog_.pop_front();
+  }
+  const int result = ring_->submit();
+  // On -EBUSY the completion queue is full, and submitting is retried once it has been reaped.
+  if (result < 0 && result != -EBUSY) {
+    ENVOY_LOG(error, "unable to submit io_uring requests: {}", errorDetails(-result));
+  }
+}
+
+void IoUringWorker::onCompletion(uint64_t user_data, int32_t result) {
+  auto* request = reinterpret_cast<IoUringRequest*>(user_data);
+  ASSERT(requests_.contains(request));
+  requests_.erase(request);
+  std::unique_ptr<IoUringRequest> completed(request);
+  if (completed->handle_ != nullptr) {
+    completed->handle_->onRequestCompleted(*completed, result);
+  } else if (completed->type_ == IoUringRequest::Type::Read) {
+    // The handle was closed while the read was in flight.
+    releaseReadBuffer(completed->buffer_index_);
+  }
+}
+
+} // namespace IoUring
+} // namespace SocketInterfaces
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <vector>
+
+#include "envoy/event/dispatcher.h"
+#include "envoy/event/file_event.h"
+#include "envoy/event/schedulable_cb.h"
+#include "envoy/thread_local/thread_local.h"
+
+#include "common/common/logger.h"
+
+#include "extensions/network/socket_interface/io_uring/ring.h"
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/types/optional.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace SocketInterfaces {
+namespace IoUring {
+
+class IoUringSocketHandleImpl;
+
+/**
+ * A request on the ring of an IoUringWorker. Its address is its user data.
+ */
+struct IoUringRequest {
+  enum class Type : uint8_t { Read, PollIn, PollOut, Cancel };
+
+  IoUringRequest(Type type, IoUringSocketHandleImpl* handle, os_fd_t fd)
+      : type_(type), handle_(handle), fd_(fd) {}
+
+  const Type type_;
+  // The handle notified of the completion, or nullptr once the handle no longer waits for it.
+  IoUringSocketHandleImpl* handle_;
+  const os_fd_t fd_;
+  // The read buffer a Read request reads into.
+  uint32_t buffer_index_{};
+  // The poll events a PollIn or PollOut request waits for.
+  uint32_t poll_mask_{};
+  // The user data of the request a Cancel request cancels.
+  uint64_t target_{};
+  // Whether the request was prepared into the submission queue, rather than waiting for room.
+  bool prepared_{};
+};
+
+/**
+ * The io_uring of a thread, and the buffers its reads complete into. Requests queued while the
+ * event loop runs are submitted together at the end of the current loop iteration, and their
+ * completions are delivered to their handles when the ring fd becomes readable.
+ */
+class IoUringWorker : public ThreadLocal::ThreadLocalObject, Logger::Loggable<Logger::Id::io> {
+public:
+  /**
+   * @param dispatcher supplies the dispatcher of the thread.
+   * @param ring supplies the ring.
+   * @param read_buffer_size supplies the size of each read buffer.
+   * @param read_buffer_count supplies the number of read buffers.
+   */
+  IoUringWorker(Event::Dispatcher& dispatcher, std::unique_ptr<Ring> ring,
+                uint32_t read_buffer_size, uint32_t read_buffer_count);
+  ~IoUringWorker() override;
+
+  Event::Dispatcher& dispatcher() { return dispatcher_; }
+  const Ring& ring() const { return *ring_; }
+
+  /**
+   * @return the index of a free read buffer, or absl::nullopt if all are in use.
+   */
+  absl::optional<uint32_t> acquireReadBuffer();
+
+  /**
+   * Returns a read buffer claimed by acquireReadBuffer().
+   */
+  void releaseReadBuffer(uint32_t index);
+
+  uint8_t* readBuffer(uint32_t index) {
+    return read_buffers_ + static_cast<uint64_t>(index) * read_buffer_size_;
+  }
+
+  /**
+   * Queues a read of fd into a read buffer claimed by acquireReadBuffer(). The read completes
+   * when data, the end of the stream or an error is received.
+   */
+  IoUringRequest& submitRead(IoUringSocketHandleImpl& handle, os_fd_t fd, uint32_t buffer_index);
+
+  /**
+   * Queues a one shot poll of fd for the events of poll_mask.
+   * @param type supplies IoUringRequest::Type::PollIn or IoUringRequest::Type::PollOut.
+   */
+  IoUringRequest& submitPoll(IoUringSocketHandleImpl& handle, os_fd_t fd,
+                             IoUringRequest::Type type, uint32_t poll_mask);
+
+  /**
+   * Cancels a request whose handle is going away, possibly about to close its fd. Its completion
+   * is then discarded, and its read buffer released.
+   */
+  void cancel(IoUringRequest& request);
+
+private:
+  IoUringRequest& queue(std::unique_ptr<IoUringRequest> request);
+  bool prepare(IoUringRequest& request);
+  void submit();
+  void onCompletion(uint64_t user_data, int32_t result);
+
+  Event::Dispatcher& dispatcher_;
+  std::unique_ptr<Ring> ring_;
+  const uint32_t read_buffer_size_;
+  const uint64_t read_buffers_size_;
+  uint8_t* read_buffers_;
+  bool read_buffers_registered_{};
+  std::vector<uint32_t> free_read_buffers_;
+  // The requests which were queued and did not complete yet, owned by the worker.
+  absl::flat_hash_set<IoUringRequest*> requests_;
+  // Requests which did not fit in the submission queue, prepared in order once it has room.
+  std::list<IoUringRequest*> backlog_;
+  Event::FileEventPtr ring_event_;
+  Event::SchedulableCallbackPtr submit_cb_;
+};
+
+using IoUringWorkerSharedPtr = std::shared_ptr<IoUringWorker>;
+
+} // namespace IoUring
+} // namespace SocketInterfaces
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,292 @@
+#include "extensions/network/socket_interface/io_uring/ring.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "envoy/common/exception.h"
+
+#include "common/common/assert.h"
+#include "common/common/fmt.h"
+#include "common/common/utility.h"
+
+#ifdef __linux__
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#endif
+
+namespace Envoy {
+namespace Extensions {
+namespace SocketInterfaces {
+namespace IoUring {
+
+#ifdef __linux__
+namespace {
+
+int ioUringSetup(uint32_t entries, io_uring_params* params) {
+  return ::syscall(__NR_io_uring_setup, entries, params);
+}
+
+int ioUringEnter(os_fd_t fd, uint32_t to_submit, uint32_t min_complete, uint32_t flags) {
+  return ::syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, 0);
+}
+
+int ioUringRegister(os_fd_t fd, uint32_t opcode, const void* arg, uint32_t nr_args) {
+  return ::syscall(__NR_io_uring_register, fd, opcode, arg, nr_args);
+}
+
+void* mapRing(os_fd_t fd, size_t size, off_t offset) {
+  return ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, offset);
+}
+
+// The operations prepared by Ring. IORING_OP_RECV, the most recent of them, requires Linux 5.6.
+constexpr uint8_t RequiredOps[] = {IORING_OP_READ_FIXED, IORING_OP_POLL_ADD,
+                                   IORING_OP_ASYNC_CANCEL, IORING_OP_RECV};
+
+// Returns the name of the first required operation the kernel does not support, or nullptr.
+const char* unsupportedOp(os_fd_t fd) {
+  constexpr uint32_t MaxOps = 256;
+  std::vector<uint8_t> storage(sizeof(io_uring_probe) + MaxOps * sizeof(io_uring_probe_op));
+  auto* probe = reinterpret_cast<io_uring_probe*>(storage.data());
+  if (ioUringRegister(fd, IORING_REGISTER_PROBE, probe, MaxOps) != 0) {
+    // Probing was added in Linux 5.6 along with IORING_OP_RECV.
+    return "IORING_REGISTER_PROBE";
+  }
+  for (const uint8_t op : RequiredOps) {
+    if (op > probe->last_op || !(probe->ops[op].flags & IO_URING_OP_SUPPORTED)) {
+      return op == IORING_OP_RECV ? "IORING_OP_RECV" : "a required operation";
+    }
+  }
+  return nullptr;
+}
+
+} // namespace
+
+Ring::Ring(uint32_t entries) {
+  io_uring_params params{};
+  fd_ = ioUringSetup(entries, &params);
+  if (fd_ < 0) {
+    throw EnvoyException(fmt::format("unable to set up io_uring: {}", errorDetails(errno)));
+  }
+  // Requests are sized to what is in flight rather than to the completion queue, so completions
+  // must be kept by the kernel when the queue overflows.
+  std::string error;
+  if (!(params.features & IORING_FEAT_NODROP)) {
+    error = "io_uring lacks IORING_FEAT_NODROP";
+  } else if (const char* op = unsupportedOp(fd_); op != nullptr) {
+    error = fmt::format("io_uring lacks {}", op);
+  }
+
+  if (error.empty()) {
+    sq_entries_ = params.sq_entries;
+    sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+    cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+      sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+    }
+    sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+
+    sq_ring_ = mapRing(fd_, sq_ring_size_, IORING_OFF_SQ_RING);
+    if (sq_ring_ != MAP_FAILED) {
+      cq_ring_ = (params.features & IORING_FEAT_SINGLE_MMAP)
+                     ? sq_ring_
+                     : mapRing(fd_, cq_ring_size_, IORING_OFF_CQ_RING);
+    }
+    if (sq_ring_ != MAP_FAILED && cq_ring_ != MAP_FAILED) {
+      sqes_ = mapRing(fd_, sqes_size_, IORING_OFF_SQES);
+    }
+    if (sq_ring_ == MAP_FAILED || cq_ring_ == MAP_FAILED || sqes_ == MAP_FAILED) {
+      error = fmt::format("unable to map io_uring: {}", errorDetails(errno));
+    }
+  }
+
+  if (!error.empty()) {
+    if (sqes_ != nullptr && sqes_ != MAP_FAILED) {
+      ::munmap(sqes_, sqes_size_);
+    }
+    if (cq_ring_ != nullptr && cq_ring_ != MAP_FAILED && cq_ring_ != sq_ring_) {
+      ::munmap(cq_ring_, cq_ring_size_);
+    }
+    if (sq_ring_ != nullptr && sq_ring_ != MAP_FAILED) {
+      ::munmap(sq_ring_, sq_ring_size_);
+    }
+    ::close(fd_);
+    throw EnvoyException(error);
+  }
+
+  char* sq_ring = static_cast<char*>(sq_ring_);
+  sq_head_ = reinterpret_cast<uint32_t*>(sq_ring + params.sq_off.head);
+  sq_tail_ = reinterpret_cast<uint32_t*>(sq_ring + params.sq_off.tail);
+  sq_mask_ = *reinterpret_cast<uint32_t*>(sq_ring + params.sq_off.ring_mask);
+  sq_flags_ = reinterpret_cast<uint32_t*>(sq_ring + params.sq_off.flags);
+  sq_array_ = reinterpret_cast<uint32_t*>(sq_ring + params.sq_off.array);
+  char* cq_ring = static_cast<char*>(cq_ring_);
+  cq_head_ = reinterpret_cast<uint32_t*>(cq_ring + params.cq_off.head);
+  cq_tail_ = reinterpret_cast<uint32_t*>(cq_ring + params.cq_off.tail);
+  cq_mask_ = *reinterpret_cast<uint32_t*>(cq_ring + params.cq_off.ring_mask);
+  cqes_ = cq_ring + params.cq_off.cqes;
+  sqe_tail_ = *sq_tail_;
+}
+
+Ring::~Ring() {
+  // Closing the ring cancels the requests in flight.
+  ::munmap(sqes_, sqes_size_);
+  if (cq_ring_ != sq_ring_) {
+    ::munmap(cq_ring_, cq_ring_size_);
+  }
+  ::munmap(sq_ring_, sq_ring_size_);
+  ::close(fd_);
+}
+
+int Ring::registerBuffers(const std::vector<iovec>& buffers) {
+  if (ioUringRegister(fd_, IORING_REGISTER_BUFFERS, buffers.data(), buffers.size()) != 0) {
+    return errno;
+  }
+  return 0;
+}
+
+void* Ring::nextSqe() {
+  if (sqe_tail_ - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE) >= sq_entries_) {
+    // The queue is full of prepared requests, so hand them to the kernel to make room.
+    submit();
+    if (sqe_tail_ - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE) >= sq_entries_) {
+      return nullptr;
+    }
+  }
+  const uint32_t index = sqe_tail_ & sq_mask_;
+  io_uring_sqe* sqe = static_cast<io_uring_sqe*>(sqes_) + index;
+  memset(sqe, 0, sizeof(*sqe));
+  sq_array_[index] = index;
+  ++sqe_tail_;
+  return sqe;
+}
+
+bool Ring::prepareReadFixed(os_fd_t fd, uint8_t* buffer, uint32_t length, uint16_t buffer_index,
+                            uint64_t user_data) {
+  auto* sqe = static_cast<io_uring_sqe*>(nextSqe());
+  if (sqe == nullptr) {
+    return false;
+  }
+  sqe->opcode = IORING_OP_READ_FIXED;
+  sqe->fd = fd;
+  sqe->addr = reinterpret_cast<uint64_t>(buffer);
+  sqe->len = length;
+  sqe->buf_index = buffer_index;
+  sqe->user_data = user_data;
+  return true;
+}
+
+bool Ring::prepareRecv(os_fd_t fd, uint8_t* buffer, uint32_t length, uint64_t user_data) {
+  auto* sqe = static_cast<io_uring_sqe*>(nextSqe());
+  if (sqe == nullptr) {
+    return false;
+  }
+  sqe->opcode = IORING_OP_RECV;
+  sqe->fd = fd;
+  sqe->addr = reinterpret_cast<uint64_t>(buffer);
+  sqe->len = length;
+  sqe->user_data = user_data;
+  return true;
+}
+
+bool Ring::preparePoll(os_fd_t fd, uint32_t poll_mask, uint64_t user_data) {
+  auto* sqe = static_cast<io_uring_sqe*>(nextSqe());
+  if (sqe == nullptr) {
+    return false;
+  }
+  sqe->opcode = IORING_OP_POLL_ADD;
+  sqe->fd = fd;
+  sqe->poll_events = poll_mask;
+  sqe->user_data = user_data;
+  return true;
+}
+
+bool Ring::prepareCancel(uint64_t target_user_data, uint64_t user_data) {
+  auto* sqe = static_cast<io_uring_sqe*>(nextSqe());
+  if (sqe == nullptr) {
+    return false;
+  }
+  sqe->opcode = IORING_OP_ASYNC_CANCEL;
+  sqe->fd = -1;
+  sqe->addr = target_user_data;
+  sqe->user_data = user_data;
+  return true;
+}
+
+bool Ring::discardUnsubmitted(uint64_t user_data) {
+  // The kernel only consumes entries from the head while io_uring_enter(2) runs.
+  for (uint32_t tail = __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE); tail != sqe_tail_; ++tail) {
+    io_uring_sqe* sqe = static_cast<io_uring_sqe*>(sqes_) + sq_array_[tail & sq_mask_];
+    if (sqe->user_data == user_data) {
+      memset(sqe, 0, sizeof(*sqe));
+      sqe->opcode = IORING_OP_NOP;
+      sqe->user_data = user_data;
+      return true;
+    }
+  }
+  return false;
+}
+
+int Ring::submit() {
+  __atomic_store_n(sq_tail_, sqe_tail_, __ATOMIC_RELEASE);
+  const uint32_t to_submit = numPrepared();
+  if (to_submit == 0) {
+    return 0;
+  }
+  int result;
+  do {
+    ++num_submit_calls_;
+    result = ioUringEnter(fd_, to_submit, 0, 0);
+  } while (result < 0 && errno == EINTR);
+  return result < 0 ? -errno : result;
+}
+
+uint32_t Ring::numPrepared() const {
+  return sqe_tail_ - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE);
+}
+
+void Ring::forEachCompletion(const CompletionCb& cb) {
+  uint32_t head = *cq_head_;
+  while (true) {
+    if (head == __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE)) {
+#ifdef IORING_SQ_CQ_OVERFLOW
+      // Completions which did not fit in the queue are only moved into it by io_uring_enter(2).
+      if (__atomic_load_n(sq_flags_, __ATOMIC_ACQUIRE) & IORING_SQ_CQ_OVERFLOW) {
+        ++num_submit_calls_;
+        ioUringEnter(fd_, 0, 0, IORING_ENTER_GETEVENTS);
+        if (head != __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE)) {
+          continue;
+        }
+      }
+#endif
+      return;
+    }
+    const io_uring_cqe& cqe = static_cast<io_uring_cqe*>(cqes_)[head & cq_mask_];
+    const uint64_t user_data = cqe.user_data;
+    const int32_t result = cqe.res;
+    // Release the entry before calling back, so that requests completing while cb submits have
+    // room in the queue.
+    __atomic_store_n(cq_head_, ++head, __ATOMIC_RELEASE);
+    cb(user_data, result);
+  }
+}
+#else
+Ring::Ring(uint32_t) { throw EnvoyException("io_uring is only supported on Linux"); }
+Ring::~Ring() = default;
+int Ring::registerBuffers(const std::vector<iovec>&) { NOT_REACHED_GCOVR_EXCL_LINE; }
+void* Ring::nextSqe() { NOT_REACHED_GCOVR_EXCL_LINE; }
+bool Ring::prepareReadFixed(os_fd_t, uint8_t*, uint32_t, uint16_t, uint64_t) {
+  NOT_REACHED_GCOVR_EXCL_LINE;
+}
+bool Ring::prepareRecv(os_fd_t, uint8_t*, uint32_t, uint64_t) { NOT_REACHED_GCOVR_EXCL_LINE; }
+bool Ring::preparePoll(os_fd_t, uint32_t, uint64_t) { NOT_REACHED_GCOVR_EXCL_LINE; }
+bool Ring::prepareCancel(uint64_t, uint64_t) { NOT_REACHED_GCOVR_EXCL_LINE; }
+bool Ring::discardUnsubmitted(uint64_t) { NOT_REACHED_GCOVR_EXCL_LINE; }
+int Ring::submit() { NOT_REACHED_GCOVR_EXCL_LINE; }
+uint32_t Ring::numPrepared() const { NOT_REACHED_GCOVR_EXCL_LINE; }
+void Ring::forEachCompletion(const CompletionCb&) { NOT_REACHED_GCOVR_EXCL_LINE; }
+#endif
+
+} // namespace IoUring
+} // namespace SocketInterfaces
+} // namespace Extensions
+} // namespace Envoy
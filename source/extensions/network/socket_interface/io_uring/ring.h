@@ -0,0 +1,133 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "envoy/common/platform.h"
+
+#include "common/common/non_copyable.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace SocketInterfaces {
+namespace IoUring {
+
+/**
+ * An io_uring, set up and driven through the raw system calls. Requests are prepared into the
+ * submission queue by the prepare*() functions and handed to the kernel together by submit().
+ * Completions are consumed by forEachCompletion(). The ring fd is readable while completions are
+ * waiting to be consumed. Not thread safe.
+ */
+class Ring : NonCopyable {
+public:
+  /**
+   * Sets up a ring.
+   * @param entries supplies the number of entries of the submission queue.
+   * @throw EnvoyException if the ring can't be set up or the kernel lacks a feature or an
+   *        operation that is prepared by this class.
+   */
+  explicit Ring(uint32_t entries);
+  ~Ring();
+
+  /**
+   * @return the fd of the ring, which may be polled for completions.
+   */
+  os_fd_t fd() const { return fd_; }
+
+  /**
+   * Registers the buffers which prepareReadFixed() reads into.
+   * @return 0 on success, or the errno of the failure.
+   */
+  int registerBuffers(const std::vector<iovec>& buffers);
+
+  /**
+   * Prepares a read into a registered buffer. These and the other prepare*() functions submit the
+   * prepared requests if the submission queue is full.
+   * @return false if there is no room for the request in the submission queue.
+   */
+  bool prepareReadFixed(os_fd_t fd, uint8_t* buffer, uint32_t length, uint16_t buffer_index,
+                        uint64_t user_data);
+
+  /**
+   * Prepares a recv(2) into any buffer.
+   */
+  bool prepareRecv(os_fd_t fd, uint8_t* buffer, uint32_t length, uint64_t user_data);
+
+  /**
+   * Prepares a one shot poll for the events of poll_mask, which completes with the events that
+   * are ready.
+   */
+  bool preparePoll(os_fd_t fd, uint32_t poll_mask, uint64_t user_data);
+
+  /**
+   * Prepares the cancellation of the request identified by target_user_data, which then
+   * completes with -ECANCELED unless it completed first.
+   */
+  bool prepareCancel(uint64_t target_user_data, uint64_t user_data);
+
+  /**
+   * Turns a prepared request which was not submitted yet into a no-op, which completes with 0
+   * without the kernel ever looking at its fd. Requests hold on to their file once submitted, but
+   * until then only carry an fd number, which may be reused as soon as the fd is closed.
+   * @return false if the request identified by user_data was already submitted.
+   */
+  bool discardUnsubmitted(uint64_t user_data);
+
+  /**
+   * Submits the prepared requests with one io_uring_enter(2).
+   * @return the number of requests submitted, or -errno on failure. -EBUSY means completions
+   *         must be consumed before more requests can be submitted.
+   */
+  int submit();
+
+  /**
+   * @return the number of prepared requests which were not submitted yet.
+   */
+  uint32_t numPrepared() const;
+
+  /**
+   * @return the number of io_uring_enter(2) calls made by submit().
+   */
+  uint64_t numSubmitCalls() const { return num_submit_calls_; }
+
+  using CompletionCb = std::function<void(uint64_t user_data, int32_t result)>;
+
+  /**
+   * Calls cb for each waiting completion, in order.
+   */
+  void forEachCompletion(const CompletionCb& cb);
+
+private:
+  // Returns the next free submission queue entry, zeroed, submitting the prepared requests first
+  // if the queue is full. Returns nullptr if the queue stays full.
+  void* nextSqe();
+
+  os_fd_t fd_{INVALID_SOCKET};
+  uint32_t sq_entries_{};
+  void* sq_ring_{};
+  size_t sq_ring_size_{};
+  void* cq_ring_{};
+  size_t cq_ring_size_{};
+  void* sqes_{};
+  size_t sqes_size_{};
+
+  uint32_t* sq_head_{};
+  uint32_t* sq_tail_{};
+  uint32_t sq_mask_{};
+  uint32_t* sq_flags_{};
+  uint32_t* sq_array_{};
+  uint32_t* cq_head_{};
+  uint32_t* cq_tail_{};
+  uint32_t cq_mask_{};
+  void* cqes_{};
+
+  // The tail of the submission queue including the requests which were not submitted yet.
+  uint32_t sqe_tail_{};
+  uint64_t num_submit_calls_{};
+};
+
+} // namespace IoUring
+} // namespace SocketInterfaces
+} // namespace Extensions
+} // namespace Envoy
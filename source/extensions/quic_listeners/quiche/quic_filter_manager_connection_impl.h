@@ -82,6 +82,8 @@ public:
   StreamInfo::StreamInfo& streamInfo() override { return stream_info_; }
   const StreamInfo::StreamInfo& streamInfo() const override { return stream_info_; }
   absl::string_view transportFailureReason() const override { return transport_failure_reason_; }
+  Network::IoHandle* spliceableIoHandle() override { return nullptr; }
+  void recordSplicedBytes(uint64_t, uint64_t) override {}
 
   // Network::FilterManagerConnection
   void rawWrite(Buffer::Instance& data, bool end_stream) override;
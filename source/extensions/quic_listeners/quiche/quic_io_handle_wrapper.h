@@ -64,6 +64,7 @@ public:
   }
   bool supportsMmsg() const override { return io_handle_.supportsMmsg(); }
   bool supportsUdpGro() const override { return io_handle_.supportsUdpGro(); }
+  bool supportsSplice() const override { return false; }
   Api::SysCallIntResult bind(Network::Address::InstanceConstSharedPtr address) override {
     return io_handle_.bind(address);
   }
@@ -92,6 +93,10 @@ public:
   Network::Address::InstanceConstSharedPtr peerAddress() override {
     return io_handle_.peerAddress();
   }
+  Event::FileEventPtr createFileEvent(Event::Dispatcher& dispatcher, Event::FileReadyCb cb,
+                                      Event::FileTriggerType trigger, uint32_t events) override {
+    return io_handle_.createFileEvent(dispatcher, cb, trigger, events);
+  }
 
 private:
   Network::IoHandle& io_handle_;
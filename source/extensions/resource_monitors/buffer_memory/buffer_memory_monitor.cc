@@ -0,0 +1,30 @@
+#include "extensions/resource_monitors/buffer_memory/buffer_memory_monitor.h"
+
+#include "envoy/extensions/resource_monitors/buffer_memory/v3/buffer_memory.pb.h"
+
+#include "common/buffer/watermark_buffer.h"
+#include "common/common/assert.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace ResourceMonitors {
+namespace BufferMemoryMonitor {
+
+BufferMemoryMonitor::BufferMemoryMonitor(
+    const envoy::extensions::resource_monitors::buffer_memory::v3::BufferMemoryConfig& config)
+    : max_buffer_memory_(config.max_buffer_memory_bytes()) {
+  ASSERT(max_buffer_memory_ > 0);
+}
+
+void BufferMemoryMonitor::updateResourceUsage(Server::ResourceMonitor::Callbacks& callbacks) {
+  Server::ResourceUsage usage;
+  usage.resource_pressure_ =
+      Buffer::WatermarkBufferFactory::totalBytesCharged() / static_cast<double>(max_buffer_memory_);
+
+  callbacks.onSuccess(usage);
+}
+
+} // namespace BufferMemoryMonitor
+} // namespace ResourceMonitors
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,30 @@
+#pragma once
+
+#include "envoy/extensions/resource_monitors/buffer_memory/v3/buffer_memory.pb.h"
+#include "envoy/extensions/resource_monitors/buffer_memory/v3/buffer_memory.pb.validate.h"
+#include "envoy/server/resource_monitor_config.h"
+
+#include "extensions/resource_monitors/common/factory_base.h"
+#include "extensions/resource_monitors/well_known_names.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace ResourceMonitors {
+namespace BufferMemoryMonitor {
+
+class BufferMemoryMonitorFactory
+    : public Common::FactoryBase<
+          envoy::extensions::resource_monitors::buffer_memory::v3::BufferMemoryConfig> {
+public:
+  BufferMemoryMonitorFactory() : FactoryBase(ResourceMonitorNames::get().BufferMemory) {}
+
+private:
+  Server::ResourceMonitorPtr createResourceMonitorFromProtoTyped(
+      const envoy::extensions::resource_monitors::buffer_memory::v3::BufferMemoryConfig& config,
+      Server::Configuration::ResourceMonitorFactoryContext& context) override;
+};
+
+} // namespace BufferMemoryMonitor
+} // namespace ResourceMonitors
+} // namespace Extensions
+} // namespace Envoy
@@ -13,6 +13,9 @@ namespace ResourceMonitors {
  */
 class ResourceMonitorNameValues {
 public:
+  // Buffer memory monitor with statically configured max.
+  const std::string BufferMemory = "envoy.resource_monitors.buffer_memory";
+
   // Heap monitor with statically configured max.
   const std::string FixedHeap = "envoy.resource_monitors.fixed_heap";
 
@@ -22,6 +22,7 @@ public:
   const Network::IoHandle& ioHandle() const override { return parent_.ioHandle(); }
   Network::Connection& connection() override { return parent_.connection(); }
   bool shouldDrainReadBuffer() override { return false; }
+  void onSocketRead(uint64_t bytes_read) override { parent_.onSocketRead(bytes_read); }
   /*
    * No-op for these two methods to hold back the callbacks.
    */
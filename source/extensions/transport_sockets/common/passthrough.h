@@ -17,6 +17,8 @@ public:
   std::string protocol() const override;
   absl::string_view failureReason() const override;
   bool canFlushClose() override;
+  // Wrapping sockets may observe or add to the data, so it is never spliced around them.
+  bool canSplice() const override { return false; }
   void closeSocket(Network::ConnectionEvent event) override;
   Network::IoResult doRead(Buffer::Instance& buffer) override;
   Network::IoResult doWrite(Buffer::Instance& buffer, bool end_stream) override;
@@ -1,30 +1,43 @@
 #include "extensions/transport_sockets/raw_buffer/config.h"
 
-#include <iostream>
-
-#include "envoy/config/transport_socket/raw_buffer/v2/raw_buffer.pb.h"
-#include "envoy/config/transport_socket/raw_buffer/v2/raw_buffer.pb.validate.h"
+#include "envoy/extensions/transport_sockets/raw_buffer/v3/raw_buffer.pb.h"
+#include "envoy/extensions/transport_sockets/raw_buffer/v3/raw_buffer.pb.validate.h"
 
 #include "common/network/raw_buffer_socket.h"
+#include "common/protobuf/utility.h"
 
 namespace Envoy {
 namespace Extensions {
 namespace TransportSockets {
 namespace RawBuffer {
 
+Network::TransportSocketFactoryPtr RawBufferSocketFactory::createRawBufferSocketFactory(
+    const Protobuf::Message& config,
+    Server::Configuration::TransportSocketFactoryContext& context) {
+  const auto& raw_buffer_config = MessageUtil::downcastAndValidate<
+      const envoy::extensions::transport_sockets::raw_buffer::v3::RawBuffer&>(
+      config, context.messageValidationVisitor());
+  if (!raw_buffer_config.has_zero_copy_threshold()) {
+    return std::make_unique<Network::RawBufferSocketFactory>();
+  }
+  return std::make_unique<Network::RawBufferSocketFactory>(
+      raw_buffer_config.zero_copy_threshold().value(), context.scope());
+}
+
 Network::TransportSocketFactoryPtr UpstreamRawBufferSocketFactory::createTransportSocketFactory(
-    const Protobuf::Message&, Server::Configuration::TransportSocketFactoryContext&) {
-  return std::make_unique<Network::RawBufferSocketFactory>();
+    const Protobuf::Message& config,
+    Server::Configuration::TransportSocketFactoryContext& context) {
+  return createRawBufferSocketFactory(config, context);
 }
 
 Network::TransportSocketFactoryPtr DownstreamRawBufferSocketFactory::createTransportSocketFactory(
-    const Protobuf::Message&, Server::Configuration::TransportSocketFactoryContext&,
+    const Protobuf::Message& config, Server::Configuration::TransportSocketFactoryContext& context,
     const std::vector<std::string>&) {
-  return std::make_unique<Network::RawBufferSocketFactory>();
+  return createRawBufferSocketFactory(config, context);
 }
 
 ProtobufTypes::MessagePtr RawBufferSocketFactory::createEmptyConfigProto() {
-  return std::make_unique<envoy::config::transport_socket::raw_buffer::v2::RawBuffer>();
+  return std::make_unique<envoy::extensions::transport_sockets::raw_buffer::v3::RawBuffer>();
 }
 
 REGISTER_FACTORY(UpstreamRawBufferSocketFactory,
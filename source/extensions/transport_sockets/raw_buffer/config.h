@@ -18,6 +18,11 @@ class RawBufferSocketFactory : public virtual Server::Configuration::TransportSo
 public:
   std::string name() const override { return TransportSocketNames::get().RawBuffer; }
   ProtobufTypes::MessagePtr createEmptyConfigProto() override;
+
+protected:
+  Network::TransportSocketFactoryPtr
+  createRawBufferSocketFactory(const Protobuf::Message& config,
+                               Server::Configuration::TransportSocketFactoryContext& context);
 };
 
 class UpstreamRawBufferSocketFactory
@@ -32,6 +32,7 @@ public:
   std::string protocol() const override { return EMPTY_STRING; }
   absl::string_view failureReason() const override { return NotReadyReason; }
   bool canFlushClose() override { return true; }
+  bool canSplice() const override { return false; }
   void closeSocket(Network::ConnectionEvent) override {}
   Network::IoResult doRead(Buffer::Instance&) override { return {PostIoAction::Close, 0, false}; }
   Network::IoResult doWrite(Buffer::Instance&, bool) override {
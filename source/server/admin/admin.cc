@@ -724,6 +724,12 @@ AdminImpl::AdminImpl(const std::string& profile_path, Server::Instance& server)
            false},
           {"/stats/prometheus", "print server stats in prometheus format",
            MAKE_ADMIN_HANDLER(stats_handler_.handlerPrometheusStats), false, false},
+          {"/stats/cacheprofile", "show stat cache lock hold times and thread cache misses",
+           MAKE_ADMIN_HANDLER(stats_handler_.handlerStatsCacheProfile), false, false},
+          {"/stats/cacheprofile/disable", "disable measuring stat cache lock hold times",
+           MAKE_ADMIN_HANDLER(stats_handler_.handlerStatsCacheProfileDisable), false, true},
+          {"/stats/cacheprofile/enable", "enable measuring stat cache lock hold times",
+           MAKE_ADMIN_HANDLER(stats_handler_.handlerStatsCacheProfileEnable), false, true},
           {"/stats/recentlookups", "Show recent stat-name lookups",
            MAKE_ADMIN_HANDLER(stats_handler_.handlerStatsRecentLookups), false, false},
           {"/stats/recentlookups/clear", "clear list of stat-name lookups and counter",
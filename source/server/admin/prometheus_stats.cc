@@ -1,8 +1,12 @@
 #include "server/admin/prometheus_stats.h"
 
+#include <algorithm>
+#include <iterator>
+
 #include "common/common/empty_string.h"
 #include "common/common/macros.h"
 #include "common/stats/histogram_impl.h"
+#include "common/stats/symbol_table_impl.h"
 
 #include "absl/strings/str_cat.h"
 
@@ -37,36 +41,54 @@ static bool shouldShowMetric(const StatType& metric, const bool used_only,
           (!regex.has_value() || std::regex_search(metric.name(), regex.value())));
 }
 
+// Output lines are rendered into a reused string, which is added to the response whenever it
+// reaches this size.
+constexpr uint64_t OutputChunkSize = 64 * 1024;
+
 /*
- * Comparator for Stats::Metric that does not require a string representation
- * to make the comparison, for memory efficiency.
+ * Comparator for Stats::Metric that orders metrics by tag-extracted name, and then by name, without
+ * requiring a string representation to make the comparison, for memory efficiency. This groups the
+ * metrics of each Prometheus metric family together. Metrics in the same family, the most common
+ * comparison, usually share an encoded tag-extracted name; names encoded differently are compared
+ * by content, as equal names may have different encodings.
  */
 struct MetricLessThan {
   bool operator()(const Stats::Metric* a, const Stats::Metric* b) const {
     ASSERT(&a->constSymbolTable() == &b->constSymbolTable());
-    return a->constSymbolTable().lessThan(a->statName(), b->statName());
+    const Stats::StatNameLessThan less_than(a->constSymbolTable());
+    const Stats::StatName a_group = a->tagExtractedStatName();
+    const Stats::StatName b_group = b->tagExtractedStatName();
+    if (a_group != b_group) {
+      if (less_than(a_group, b_group)) {
+        return true;
+      }
+      if (less_than(b_group, a_group)) {
+        return false;
+      }
+    }
+    return less_than(a->statName(), b->statName());
   }
 };
 
 /**
- * Processes a stat type (counter, gauge, histogram) by generating all output lines, sorting
- * them by tag-extracted metric name, and then outputting them in the correct sorted order into
- * response.
+ * Processes a stat type (counter, gauge, histogram) by sorting the metrics by tag-extracted metric
+ * name, and then adding their output lines to response in that order.
  *
  * @param response The buffer to put the output into.
  * @param used_only Whether to only output stats that are used.
  * @param regex A filter on which stats to output.
  * @param metrics The metrics to output stats for. This must contain all stats of the given type
  *        to be included in the same output.
- * @param generate_output A function which returns the output text for this metric.
+ * @param generate_output A function which appends the output text for this metric to its output
+ *        argument.
  * @param type The name of the prometheus metric type for used in TYPE annotations.
  */
 template <class StatType>
 uint64_t outputStatType(
     Buffer::Instance& response, const bool used_only, const absl::optional<std::regex>& regex,
     const std::vector<Stats::RefcountPtr<StatType>>& metrics,
-    const std::function<std::string(
-        const StatType& metric, const std::string& prefixed_tag_extracted_name)>& generate_output,
+    const std::function<void(const StatType& metric, const std::string& prefixed_tag_extracted_name,
+                             std::string& output)>& generate_output,
     absl::string_view type) {
 
   /*
@@ -79,13 +101,6 @@ uint64_t outputStatType(
    * prohibitive.
    */
 
-  // This is an unsorted collection of dumb-pointers (no need to increment then decrement every
-  // refcount; ownership is held throughout by `metrics`). It is unsorted for efficiency, but will
-  // be sorted before producing the final output to satisfy the "preferred" ordering from the
-  // prometheus spec: metrics will be sorted by their tags' textual representation, which will be
-  // consistent across calls.
-  using StatTypeUnsortedCollection = std::vector<const StatType*>;
-
   // Return early to avoid crashing when getting the symbol table from the first metric.
   if (metrics.empty()) {
     return 0;
@@ -97,11 +112,13 @@ uint64_t outputStatType(
   // comparison.
   const Stats::SymbolTable& global_symbol_table = metrics.front()->constSymbolTable();
 
-  // Sorted collection of metrics sorted by their tagExtractedName, to satisfy the requirements
-  // of the exposition format.
-  std::map<Stats::StatName, StatTypeUnsortedCollection, Stats::StatNameLessThan> groups(
-      global_symbol_table);
-
+  // This is a collection of dumb-pointers (no need to increment then decrement every refcount;
+  // ownership is held throughout by `metrics`). Sorting it by tag-extracted name and then by name
+  // groups each metric family, as required by the exposition format, and satisfies the "preferred"
+  // ordering from the prometheus spec: metrics are sorted by their tags' textual representation,
+  // which is consistent across calls. Unlike a map of groups, this takes a single allocation.
+  std::vector<const StatType*> sorted_metrics;
+  sorted_metrics.reserve(metrics.size());
   for (const auto& metric : metrics) {
     ASSERT(&global_symbol_table == &metric->constSymbolTable());
 
@@ -109,51 +126,73 @@ uint64_t outputStatType(
       continue;
     }
 
-    groups[metric->tagExtractedStatName()].push_back(metric.get());
+    sorted_metrics.push_back(metric.get());
   }
+  std::sort(sorted_metrics.begin(), sorted_metrics.end(), MetricLessThan());
 
-  for (auto& group : groups) {
-    const std::string prefixed_tag_extracted_name =
-        PrometheusStatsFormatter::metricName(global_symbol_table.toString(group.first));
-    response.add(fmt::format("# TYPE {0} {1}\n", prefixed_tag_extracted_name, type));
-
-    // Sort before producing the final output to satisfy the "preferred" ordering from the
-    // prometheus spec: metrics will be sorted by their tags' textual representation, which will
-    // be consistent across calls.
-    std::sort(group.second.begin(), group.second.end(), MetricLessThan());
+  uint64_t num_groups = 0;
+  std::string output;
+  output.reserve(OutputChunkSize);
+  const Stats::StatNameLessThan less_than(global_symbol_table);
+  std::string prefixed_tag_extracted_name;
+  for (auto it = sorted_metrics.begin(); it != sorted_metrics.end(); ++it) {
+    const Stats::StatName group = (*it)->tagExtractedStatName();
+    const bool new_group = it == sorted_metrics.begin() ||
+                           (group != (*(it - 1))->tagExtractedStatName() &&
+                            less_than((*(it - 1))->tagExtractedStatName(), group));
+    if (new_group) {
+      // The family name is rendered once per tag-extracted name. Adjacent names which render to
+      // the same family name, such as names differing only in sanitized characters, share a
+      // family.
+      std::string family_name =
+          PrometheusStatsFormatter::metricName(global_symbol_table.toString(group));
+      if (family_name != prefixed_tag_extracted_name) {
+        if (num_groups++ > 0) {
+          output.append("\n");
+        }
+        prefixed_tag_extracted_name = std::move(family_name);
+        fmt::format_to(std::back_inserter(output), "# TYPE {0} {1}\n", prefixed_tag_extracted_name,
+                       type);
+      }
+    }
 
-    for (const auto& metric : group.second) {
-      response.add(generate_output(*metric, prefixed_tag_extracted_name));
+    generate_output(**it, prefixed_tag_extracted_name, output);
+    if (output.size() >= OutputChunkSize) {
+      response.add(output);
+      output.clear();
     }
-    response.add("\n");
   }
-  return groups.size();
+  if (num_groups > 0) {
+    output.append("\n");
+  }
+  response.add(output);
+  return num_groups;
 }
 
 /*
- * Return the prometheus output for a numeric Stat (Counter or Gauge).
+ * Appends the prometheus output for a numeric Stat (Counter or Gauge).
  */
 template <class StatType>
-std::string generateNumericOutput(const StatType& metric,
-                                  const std::string& prefixed_tag_extracted_name) {
+void generateNumericOutput(const StatType& metric, const std::string& prefixed_tag_extracted_name,
+                           std::string& output) {
   const std::string tags = PrometheusStatsFormatter::formattedTags(metric.tags());
-  return fmt::format("{0}{{{1}}} {2}\n", prefixed_tag_extracted_name, tags, metric.value());
+  fmt::format_to(std::back_inserter(output), "{0}{{{1}}} {2}\n", prefixed_tag_extracted_name, tags,
+                 metric.value());
 }
 
 /*
- * Returns the prometheus output for a histogram. The output is a multi-line string (with embedded
- * newlines) that contains all the individual bucket counts and sum/count for a single histogram
- * (metric_name plus all tags).
+ * Appends the prometheus output for a histogram. The output is multiple lines that contain all the
+ * individual bucket counts and sum/count for a single histogram (metric_name plus all tags).
  */
-std::string generateHistogramOutput(const Stats::ParentHistogram& histogram,
-                                    const std::string& prefixed_tag_extracted_name) {
+void generateHistogramOutput(const Stats::ParentHistogram& histogram,
+                             const std::string& prefixed_tag_extracted_name, std::string& output) {
   const std::string tags = PrometheusStatsFormatter::formattedTags(histogram.tags());
   const std::string hist_tags = histogram.tags().empty() ? EMPTY_STRING : (tags + ",");
 
   const Stats::HistogramStatistics& stats = histogram.cumulativeStatistics();
   Stats::ConstSupportedBuckets& supported_buckets = stats.supportedBuckets();
   const std::vector<uint64_t>& computed_buckets = stats.computedBuckets();
-  std::string output;
+  auto out = std::back_inserter(output);
   for (size_t i = 0; i < supported_buckets.size(); ++i) {
     double bucket = supported_buckets[i];
     uint64_t value = computed_buckets[i];
@@ -162,19 +201,17 @@ std::string generateHistogramOutput(const Stats::ParentHistogram& histogram,
     // 'g' operator which prints the number in general fixed point format or scientific format
     // with precision 50 to round the number up to 32 significant digits in fixed point format
     // which should cover pretty much all cases
-    output.append(fmt::format("{0}_bucket{{{1}le=\"{2:.32g}\"}} {3}\n", prefixed_tag_extracted_name,
-                              hist_tags, bucket, value));
+    fmt::format_to(out, "{0}_bucket{{{1}le=\"{2:.32g}\"}} {3}\n", prefixed_tag_extracted_name,
+                   hist_tags, bucket, value);
   }
 
-  output.append(fmt::format("{0}_bucket{{{1}le=\"+Inf\"}} {2}\n", prefixed_tag_extracted_name,
-                            hist_tags, stats.sampleCount()));
-  output.append(fmt::format("{0}_sum{{{1}}} {2:.32g}\n", prefixed_tag_extracted_name, tags,
-                            stats.sampleSum()));
-  output.append(fmt::format("{0}_count{{{1}}} {2}\n", prefixed_tag_extracted_name, tags,
-                            stats.sampleCount()));
-
-  return output;
-};
+  fmt::format_to(out, "{0}_bucket{{{1}le=\"+Inf\"}} {2}\n", prefixed_tag_extracted_name, hist_tags,
+                 stats.sampleCount());
+  fmt::format_to(out, "{0}_sum{{{1}}} {2:.32g}\n", prefixed_tag_extracted_name, tags,
+                 stats.sampleSum());
+  fmt::format_to(out, "{0}_count{{{1}}} {2}\n", prefixed_tag_extracted_name, tags,
+                 stats.sampleCount());
+}
 
 absl::flat_hash_set<std::string>& prometheusNamespaces() {
   MUTABLE_CONSTRUCT_ON_FIRST_USE(absl::flat_hash_set<std::string>);
@@ -68,6 +68,46 @@ Http::Code StatsHandler::handlerStatsRecentLookupsEnable(absl::string_view,
   return Http::Code::OK;
 }
 
+Http::Code StatsHandler::handlerStatsCacheProfile(absl::string_view, Http::ResponseHeaderMap&,
+                                                  Buffer::Instance& response, AdminStream&) {
+  const Stats::CacheProfile profile = server_.stats().cacheProfile();
+  if (profile.enabled_) {
+    const auto to_us = [](std::chrono::nanoseconds duration) {
+      return std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+    };
+    response.add(fmt::format("Central cache lock: {} acquisitions, held {}us in total and {}us at "
+                             "most\n",
+                             profile.central_lock_acquisitions_,
+                             to_us(profile.central_lock_hold_time_),
+                             to_us(profile.max_central_lock_hold_time_)));
+  } else {
+    response.add("Central cache lock profiling is not enabled. Use /stats/cacheprofile/enable to "
+                 "enable.\n");
+  }
+  response.add("\n  Misses   Warmed Thread\n");
+  for (const Stats::CacheProfile::ThreadCache& thread_cache : profile.thread_caches_) {
+    response.add(fmt::format("{:8d} {:8d} {}\n", thread_cache.misses_, thread_cache.warmed_,
+                             thread_cache.thread_name_));
+  }
+  return Http::Code::OK;
+}
+
+Http::Code StatsHandler::handlerStatsCacheProfileDisable(absl::string_view,
+                                                         Http::ResponseHeaderMap&,
+                                                         Buffer::Instance& response, AdminStream&) {
+  server_.stats().setCacheProfiling(nullptr);
+  response.add("OK\n");
+  return Http::Code::OK;
+}
+
+Http::Code StatsHandler::handlerStatsCacheProfileEnable(absl::string_view,
+                                                        Http::ResponseHeaderMap&,
+                                                        Buffer::Instance& response, AdminStream&) {
+  server_.stats().setCacheProfiling(&server_.timeSource());
+  response.add("OK\n");
+  return Http::Code::OK;
+}
+
 Http::Code StatsHandler::handlerStats(absl::string_view url,
                                       Http::ResponseHeaderMap& response_headers,
                                       Buffer::Instance& response, AdminStream& admin_stream) {
@@ -38,6 +38,15 @@ public:
   Http::Code handlerStatsRecentLookupsEnable(absl::string_view path_and_query,
                                              Http::ResponseHeaderMap& response_headers,
                                              Buffer::Instance& response, AdminStream&);
+  Http::Code handlerStatsCacheProfile(absl::string_view path_and_query,
+                                      Http::ResponseHeaderMap& response_headers,
+                                      Buffer::Instance& response, AdminStream&);
+  Http::Code handlerStatsCacheProfileDisable(absl::string_view path_and_query,
+                                             Http::ResponseHeaderMap& response_headers,
+                                             Buffer::Instance& response, AdminStream&);
+  Http::Code handlerStatsCacheProfileEnable(absl::string_view path_and_query,
+                                            Http::ResponseHeaderMap& response_headers,
+                                            Buffer::Instance& response, AdminStream&);
   Http::Code handlerStats(absl::string_view path_and_query,
                           Http::ResponseHeaderMap& response_headers, Buffer::Instance& response,
                           AdminStream&);
@@ -117,6 +117,7 @@ protected:
         return parent_.parent_.address();
       }
       void setConnectionStats(const Network::Connection::ConnectionStats&) override {}
+      void setReadStats(const Network::Connection::ReadStats&) override {}
       Ssl::ConnectionInfoConstSharedPtr ssl() const override { return nullptr; }
       absl::string_view requestedServerName() const override { return EMPTY_STRING; }
       State state() const override { return Network::Connection::State::Open; }
@@ -132,6 +133,8 @@ protected:
       const StreamInfo::StreamInfo& streamInfo() const override { return stream_info_; }
       void setDelayedCloseTimeout(std::chrono::milliseconds) override {}
       absl::string_view transportFailureReason() const override { return EMPTY_STRING; }
+      Network::IoHandle* spliceableIoHandle() override { return nullptr; }
+      void recordSplicedBytes(uint64_t, uint64_t) override {}
 
       SyntheticReadCallbacks& parent_;
       StreamInfo::StreamInfoImpl stream_info_;
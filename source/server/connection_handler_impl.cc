@@ -516,6 +516,8 @@ ConnectionHandlerImpl::ActiveTcpConnection::ActiveTcpConnection(
   // to make this configurable.
   connection_->noDelay(true);
   auto& listener = active_connections_.listener_;
+  connection_->setReadStats({listener.stats_.downstream_cx_rx_reads_total_,
+                             listener.stats_.downstream_cx_rx_read_bytes_});
   listener.stats_.downstream_cx_total_.inc();
   listener.stats_.downstream_cx_active_.inc();
   listener.per_worker_stats_.downstream_cx_total_.inc();
@@ -156,6 +156,15 @@ OptionsImpl::OptionsImpl(std::vector<std::string> args,
                                               "Use fake symbol table implementation", false, false,
                                               "bool", cmd);
 
+  TCLAP::ValueArg<std::string> stats_shared_memory_path(
+      "", "stats-shared-memory-path",
+      "Path of a file in which to place the values of counters and gauges for export", false, "",
+      "string", cmd);
+  TCLAP::ValueArg<uint32_t> stats_shared_memory_max_stats(
+      "", "stats-shared-memory-max-stats",
+      "Number of stats the file given by --stats-shared-memory-path has room for", false,
+      DefaultStatsSharedMemoryMaxStats, "uint32_t", cmd);
+
   TCLAP::ValueArg<std::string> disable_extensions("", "disable-extensions",
                                                   "Comma-separated list of extensions to disable",
                                                   false, "", "string", cmd);
@@ -182,6 +191,8 @@ OptionsImpl::OptionsImpl(std::vector<std::string> args,
   mutex_tracing_enabled_ = enable_mutex_tracing.getValue();
   fake_symbol_table_enabled_ = use_fake_symbol_table.getValue();
   cpuset_threads_ = cpuset_threads.getValue();
+  stats_shared_memory_path_ = stats_shared_memory_path.getValue();
+  stats_shared_memory_max_stats_ = stats_shared_memory_max_stats.getValue();
 
   if (log_level.isSet()) {
     log_level_ = parseAndValidateLogLevel(log_level.getValue());
@@ -390,6 +401,8 @@ Server::CommandLineOptionsPtr OptionsImpl::toCommandLineOptions() const {
   command_line_options->set_enable_mutex_tracing(mutexTracingEnabled());
   command_line_options->set_cpuset_threads(cpusetThreadsEnabled());
   command_line_options->set_restart_epoch(restartEpoch());
+  command_line_options->set_stats_shared_memory_path(statsSharedMemoryPath());
+  command_line_options->set_stats_shared_memory_max_stats(statsSharedMemoryMaxStats());
   for (const auto& e : disabledExtensions()) {
     command_line_options->add_disabled_extensions(e);
   }
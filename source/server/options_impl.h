@@ -103,6 +103,12 @@ public:
   void setFakeSymbolTableEnabled(bool fake_symbol_table_enabled) {
     fake_symbol_table_enabled_ = fake_symbol_table_enabled;
   }
+  void setStatsSharedMemoryPath(const std::string& stats_shared_memory_path) {
+    stats_shared_memory_path_ = stats_shared_memory_path;
+  }
+  void setStatsSharedMemoryMaxStats(uint32_t stats_shared_memory_max_stats) {
+    stats_shared_memory_max_stats_ = stats_shared_memory_max_stats;
+  }
 
   // Server::Options
   uint64_t baseId() const override { return base_id_; }
@@ -147,6 +153,8 @@ public:
   bool signalHandlingEnabled() const override { return signal_handling_enabled_; }
   bool mutexTracingEnabled() const override { return mutex_tracing_enabled_; }
   bool fakeSymbolTableEnabled() const override { return fake_symbol_table_enabled_; }
+  const std::string& statsSharedMemoryPath() const override { return stats_shared_memory_path_; }
+  uint32_t statsSharedMemoryMaxStats() const override { return stats_shared_memory_max_stats_; }
   Server::CommandLineOptionsPtr toCommandLineOptions() const override;
   void parseComponentLogLevels(const std::string& component_log_levels);
   bool cpusetThreadsEnabled() const override { return cpuset_threads_; }
@@ -161,6 +169,7 @@ public:
    * factories.
    */
   static void disableExtensions(const std::vector<std::string>&);
+  static constexpr uint32_t DefaultStatsSharedMemoryMaxStats = 65536;
   static std::string allowedLogLevels();
 
 private:
@@ -200,6 +209,8 @@ private:
   bool mutex_tracing_enabled_;
   bool cpuset_threads_;
   bool fake_symbol_table_enabled_;
+  std::string stats_shared_memory_path_;
+  uint32_t stats_shared_memory_max_stats_{DefaultStatsSharedMemoryMaxStats};
   std::vector<std::string> disabled_extensions_;
   uint32_t count_;
 
@@ -147,7 +147,12 @@ void InstanceImpl::failHealthcheck(bool fail) {
   server_stats_->live_.set(live_.load());
 }
 
-MetricSnapshotImpl::MetricSnapshotImpl(Stats::Store& store) {
+MetricSnapshotImpl::MetricSnapshotImpl(Stats::Store& store, bool changed_only) {
+  if (changed_only) {
+    snapChanged(store);
+    return;
+  }
+
   snapped_counters_ = store.counters();
   counters_.reserve(snapped_counters_.size());
   for (const auto& counter : snapped_counters_) {
@@ -174,13 +179,40 @@ MetricSnapshotImpl::MetricSnapshotImpl(Stats::Store& store) {
   }
 }
 
-void InstanceUtil::flushMetricsToSinks(const std::list<Stats::SinkPtr>& sinks,
-                                       Stats::Store& store) {
+void MetricSnapshotImpl::snapChanged(Stats::Store& store) {
+  // The references taken here keep the stats alive for the lifetime of the snapshot, as they do
+  // for a full snapshot. The store still latches every counter.
+  store.forEachChangedStat(
+      [this](Stats::Counter& counter, uint64_t delta) {
+        snapped_counters_.emplace_back(&counter);
+        counters_.push_back({delta, counter});
+      },
+      [this](Stats::Gauge& gauge) {
+        snapped_gauges_.emplace_back(&gauge);
+        gauges_.push_back(gauge);
+      },
+      [this](Stats::TextReadout& text_readout) {
+        snapped_text_readouts_.emplace_back(&text_readout);
+        text_readouts_.push_back(text_readout);
+      });
+
+  // Histograms have no write marker, but the interval statistics computed by the merge preceding
+  // the flush tell whether any values were recorded since the previous one.
+  for (auto& histogram : store.histograms()) {
+    if (histogram->intervalStatistics().sampleCount() > 0) {
+      histograms_.push_back(*histogram);
+      snapped_histograms_.push_back(std::move(histogram));
+    }
+  }
+}
+
+void InstanceUtil::flushMetricsToSinks(const std::list<Stats::SinkPtr>& sinks, Stats::Store& store,
+                                       bool changed_only) {
   // Create a snapshot and flush to all sinks.
   // NOTE: Even if there are no sinks, creating the snapshot has the important property that it
   //       latches all counters on a periodic basis. The hot restart code assumes this is being
   //       done so this should not be removed.
-  MetricSnapshotImpl snapshot(store);
+  MetricSnapshotImpl snapshot(store, changed_only);
   for (const auto& sink : sinks) {
     sink->flush(snapshot);
   }
@@ -211,6 +243,12 @@ void InstanceImpl::updateServerStats() {
                                        parent_stats.parent_memory_allocated_);
   server_stats_->memory_heap_size_.set(Memory::Stats::totalCurrentlyReserved());
   server_stats_->memory_physical_size_.set(Memory::Stats::totalPhysicalBytes());
+  const Buffer::SliceCacheStats slice_cache_stats = Buffer::OwnedSlice::cacheStats();
+  server_stats_->memory_slice_cache_hits_.add(slice_cache_stats.hits_ - slice_cache_stats_.hits_);
+  server_stats_->memory_slice_cache_misses_.add(slice_cache_stats.misses_ -
+                                                slice_cache_stats_.misses_);
+  server_stats_->memory_slice_cache_bytes_.set(slice_cache_stats.bytes_cached_);
+  slice_cache_stats_ = slice_cache_stats;
   server_stats_->parent_connections_.set(parent_stats.parent_connections_);
   server_stats_->total_connections_.set(listener_manager_->numConnections() +
                                         parent_stats.parent_connections_);
@@ -224,7 +262,8 @@ void InstanceImpl::updateServerStats() {
 
 void InstanceImpl::flushStatsInternal() {
   updateServerStats();
-  InstanceUtil::flushMetricsToSinks(config_.statsSinks(), stats_store_);
+  InstanceUtil::flushMetricsToSinks(config_.statsSinks(), stats_store_,
+                                    config_.statsFlushChangedOnly());
   // TODO(ramaraochavali): consider adding different flush interval for histograms.
   if (stat_flush_timer_ != nullptr) {
     stat_flush_timer_->enableTimer(config_.statsFlushInterval());
@@ -324,6 +363,7 @@ void InstanceImpl::initialize(const Options& options,
   stats_store_.setTagProducer(Config::Utility::createTagProducer(bootstrap_));
   stats_store_.setStatsMatcher(Config::Utility::createStatsMatcher(bootstrap_));
   stats_store_.setHistogramSettings(Config::Utility::createHistogramSettings(bootstrap_));
+  stats_store_.setThreadLocalCacheWarmup(bootstrap_.stats_config().warm_thread_local_caches());
 
   const std::string server_stats_prefix = "server.";
   server_stats_ = std::make_unique<ServerStats>(
@@ -14,6 +14,11 @@
 namespace Envoy {
 namespace Server {
 
+namespace {
+// How often buffer consumers are reset while the reset_largest_buffer_consumers action is active.
+constexpr std::chrono::milliseconds ResetBufferConsumersInterval{1000};
+} // namespace
+
 WorkerPtr ProdWorkerFactory::createWorker(OverloadManager& overload_manager,
                                           const std::string& worker_name) {
   Event::DispatcherPtr dispatcher(api_.allocateDispatcher(worker_name));
@@ -32,6 +37,9 @@ WorkerImpl::WorkerImpl(ThreadLocal::Instance& tls, ListenerHooks& hooks,
   overload_manager.registerForAction(
       OverloadActionNames::get().StopAcceptingConnections, *dispatcher_,
       [this](OverloadActionState state) { stopAcceptingConnectionsCb(state); });
+  overload_manager.registerForAction(
+      OverloadActionNames::get().ResetLargestBufferConsumers, *dispatcher_,
+      [this](OverloadActionState state) { resetLargestBufferConsumersCb(state); });
 }
 
 void WorkerImpl::addListener(absl::optional<uint64_t> overridden_listener,
@@ -138,6 +146,7 @@ void WorkerImpl::threadRoutine(GuardDog& guard_dog) {
   // destructors from running on the main thread which might reference thread locals. Destroying
   // the handler does this which additionally purges the dispatcher delayed deletion list.
   handler_.reset();
+  reset_buffer_consumers_timer_.reset();
   tls_.shutdownThread();
   watch_dog_.reset();
 }
@@ -150,5 +159,34 @@ void WorkerImpl::stopAcceptingConnectionsCb(OverloadActionState state) {
   }
 }
 
+void WorkerImpl::resetLargestBufferConsumersCb(OverloadActionState state) {
+  // The action only calls back when its state changes, so while it stays active buffer consumers
+  // are reset again periodically, in case memory is still tight once the first ones are reset.
+  reset_buffer_consumers_state_ = state;
+  if (state.value() == 0) {
+    if (reset_buffer_consumers_timer_ != nullptr) {
+      reset_buffer_consumers_timer_->disableTimer();
+    }
+    return;
+  }
+  if (reset_buffer_consumers_timer_ == nullptr) {
+    reset_buffer_consumers_timer_ =
+        dispatcher_->createTimer([this]() { resetLargestBufferConsumers(); });
+  }
+  resetLargestBufferConsumers();
+}
+
+void WorkerImpl::resetLargestBufferConsumers() {
+  // Free up to half of the memory buffered by the worker once the action is saturated, starting
+  // with the connections and streams which buffer the most.
+  Buffer::WatermarkFactory& factory = dispatcher_->getWatermarkFactory();
+  const uint64_t bytes_to_free =
+      factory.bytesCharged() * reset_buffer_consumers_state_.value() / 2;
+  const uint64_t bytes_freed = factory.resetAccounts(bytes_to_free);
+  ENVOY_LOG(debug, "reset buffer consumers of {} bytes to free {} bytes", bytes_freed,
+            bytes_to_free);
+  reset_buffer_consumers_timer_->enableTimer(ResetBufferConsumersInterval);
+}
+
 } // namespace Server
 } // namespace Envoy
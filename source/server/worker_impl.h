@@ -4,9 +4,11 @@
 #include <memory>
 
 #include "envoy/api/api.h"
+#include "envoy/event/timer.h"
 #include "envoy/network/connection_handler.h"
 #include "envoy/server/guarddog.h"
 #include "envoy/server/listener_manager.h"
+#include "envoy/server/overload_manager.h"
 #include "envoy/server/worker.h"
 #include "envoy/thread_local/thread_local.h"
 
@@ -58,6 +60,8 @@ public:
 private:
   void threadRoutine(GuardDog& guard_dog);
   void stopAcceptingConnectionsCb(OverloadActionState state);
+  void resetLargestBufferConsumersCb(OverloadActionState state);
+  void resetLargestBufferConsumers();
 
   ThreadLocal::Instance& tls_;
   ListenerHooks& hooks_;
@@ -66,6 +70,10 @@ private:
   Api::Api& api_;
   Thread::ThreadPtr thread_;
   WatchDogSharedPtr watch_dog_;
+  // The state of the reset_largest_buffer_consumers action, and a timer to reset buffer consumers
+  // again for as long as it is active.
+  OverloadActionState reset_buffer_consumers_state_{OverloadActionState::inactive()};
+  Event::TimerPtr reset_buffer_consumers_timer_;
 };
 
 } // namespace Server
@@ -1,4 +1,6 @@
 #include <memory>
+#include <string>
+#include <vector>
 
 #include "common/access_log/access_log_manager_impl.h"
 #include "common/filesystem/file_shared_impl.h"
@@ -11,6 +13,10 @@
 #include "test/test_common/test_time.h"
 #include "test/test_common/utility.h"
 
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_split.h"
+#include "absl/synchronization/notification.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 
@@ -306,6 +312,68 @@ TEST_F(AccessLogManagerImplTest, ReopenFile) {
   }
 }
 
+// Headers are written straight away, once per id, and again at the start of the file after a
+// reopen, ahead of the data staged before it.
+TEST_F(AccessLogManagerImplTest, HeadersWrittenOnReopen) {
+  NiceMock<Event::MockTimer>* timer = new NiceMock<Event::MockTimer>(&dispatcher_);
+
+  Sequence sq;
+  EXPECT_CALL(*file_, open_(_))
+      .InSequence(sq)
+      .WillOnce(Return(ByMove(Filesystem::resultSuccess<bool>(true))));
+  AccessLogFileSharedPtr log_file = access_log_manager_.createAccessLog("foo");
+
+  EXPECT_CALL(*file_, write_(_))
+      .InSequence(sq)
+      .WillOnce(Invoke([](absl::string_view data) -> Api::IoCallSizeResult {
+        EXPECT_EQ(0, data.compare("header1"));
+        return Filesystem::resultSuccess<ssize_t>(static_cast<ssize_t>(data.length()));
+      }));
+  EXPECT_CALL(*file_, write_(_))
+      .InSequence(sq)
+      .WillOnce(Invoke([](absl::string_view data) -> Api::IoCallSizeResult {
+        EXPECT_EQ(0, data.compare("header2"));
+        return Filesystem::resultSuccess<ssize_t>(static_cast<ssize_t>(data.length()));
+      }));
+  log_file->addHeader(1, "header1");
+  log_file->addHeader(2, "header2");
+  // Adding a header again, as a replacement logger does, doesn't write it again.
+  log_file->addHeader(1, "header1");
+
+  EXPECT_CALL(*file_, close_())
+      .InSequence(sq)
+      .WillOnce(Return(ByMove(Filesystem::resultSuccess<bool>(true))));
+  EXPECT_CALL(*file_, open_(_))
+      .InSequence(sq)
+      .WillOnce(Return(ByMove(Filesystem::resultSuccess<bool>(true))));
+  EXPECT_CALL(*file_, write_(_))
+      .InSequence(sq)
+      .WillOnce(Invoke([](absl::string_view data) -> Api::IoCallSizeResult {
+        EXPECT_EQ(0, data.compare("header1header2"));
+        return Filesystem::resultSuccess<ssize_t>(static_cast<ssize_t>(data.length()));
+      }));
+  EXPECT_CALL(*file_, write_(_))
+      .InSequence(sq)
+      .WillOnce(Invoke([](absl::string_view data) -> Api::IoCallSizeResult {
+        EXPECT_EQ(0, data.compare("reopened"));
+        return Filesystem::resultSuccess<ssize_t>(static_cast<ssize_t>(data.length()));
+      }));
+  EXPECT_CALL(*file_, close_())
+      .InSequence(sq)
+      .WillOnce(Return(ByMove(Filesystem::resultSuccess<bool>(true))));
+
+  log_file->reopen();
+  log_file->write("reopened");
+  timer->invokeCallback();
+
+  {
+    Thread::LockGuard lock(file_->write_mutex_);
+    while (file_->num_writes_ != 4) {
+      file_->write_event_.wait(file_->write_mutex_);
+    }
+  }
+}
+
 // Test that the flush timer will trigger file reopen even if no data is waiting.
 TEST_F(AccessLogManagerImplTest, ReopenFileOnTimerOnly) {
   NiceMock<Event::MockTimer>* timer = new NiceMock<Event::MockTimer>(&dispatcher_);
@@ -443,6 +511,72 @@ TEST_F(AccessLogManagerImplTest, BigDataChunkShouldBeFlushedWithoutTimer) {
   EXPECT_CALL(*file_, close_()).WillOnce(Return(ByMove(Filesystem::resultSuccess<bool>(true))));
 }
 
+// Each thread buffers into its own staging buffer. A flush writes all of them at once, keeping the
+// writes of each thread in order.
+TEST_F(AccessLogManagerImplTest, WritesFromManyThreads) {
+  NiceMock<Event::MockTimer>* timer = new NiceMock<Event::MockTimer>(&dispatcher_);
+  EXPECT_CALL(*timer, enableTimer(timeout_40ms_, _));
+
+  EXPECT_CALL(*file_, open_(_)).WillOnce(Return(ByMove(Filesystem::resultSuccess<bool>(true))));
+  AccessLogFileSharedPtr log_file = access_log_manager_.createAccessLog("foo");
+
+  std::string written;
+  EXPECT_CALL(*file_, write_(_))
+      .WillRepeatedly(Invoke([&written](absl::string_view data) -> Api::IoCallSizeResult {
+        written.append(data.data(), data.size());
+        return Filesystem::resultSuccess<ssize_t>(static_cast<ssize_t>(data.length()));
+      }));
+
+  // Get the flush of the first write out of the way.
+  log_file->write("prime-it\n");
+  {
+    Thread::LockGuard lock(file_->write_mutex_);
+    while (file_->num_writes_ != 1) {
+      file_->write_event_.wait(file_->write_mutex_);
+    }
+  }
+
+  const uint32_t num_threads = 4;
+  const uint32_t num_lines = 100;
+  std::vector<Thread::ThreadPtr> threads;
+  for (uint32_t t = 0; t < num_threads; t++) {
+    threads.push_back(thread_factory_.createThread([&log_file, t]() {
+      for (uint32_t i = 0; i < num_lines; i++) {
+        log_file->write(absl::StrCat(t, ":", i, "\n"));
+      }
+    }));
+  }
+  for (auto& thread : threads) {
+    thread->join();
+  }
+  log_file->flush();
+
+  {
+    Thread::LockGuard lock(file_->write_mutex_);
+    EXPECT_EQ(2UL, file_->num_writes_);
+  }
+  std::vector<uint32_t> next_line(num_threads, 0);
+  for (absl::string_view line : absl::StrSplit(written, '\n', absl::SkipEmpty())) {
+    if (line == "prime-it") {
+      continue;
+    }
+    const std::vector<absl::string_view> parts = absl::StrSplit(line, ':');
+    ASSERT_EQ(2, parts.size());
+    uint32_t t;
+    uint32_t i;
+    ASSERT_TRUE(absl::SimpleAtoi(parts[0], &t));
+    ASSERT_TRUE(absl::SimpleAtoi(parts[1], &i));
+    EXPECT_EQ(next_line[t]++, i);
+  }
+  EXPECT_EQ(std::vector<uint32_t>(num_threads, num_lines), next_line);
+  EXPECT_EQ(2UL, store_.counter("filesystem.write_completed").value());
+  EXPECT_EQ(0UL,
+            store_.gauge("filesystem.write_total_buffered", Stats::Gauge::ImportMode::Accumulate)
+                .value());
+
+  EXPECT_CALL(*file_, close_()).WillOnce(Return(ByMove(Filesystem::resultSuccess<bool>(true))));
+}
+
 TEST_F(AccessLogManagerImplTest, ReopenAllFiles) {
   EXPECT_CALL(dispatcher_, createTimer_(_)).WillRepeatedly(ReturnNew<NiceMock<Event::MockTimer>>());
 
@@ -518,6 +652,73 @@ TEST_F(AccessLogManagerImplTest, ReopenAllFiles) {
       .WillOnce(Return(ByMove(Filesystem::resultSuccess<bool>(true))));
 }
 
+// A file whose flush is stuck, here reopening it on an unresponsive filesystem, only holds up the
+// flush thread it is on. Other files are flushed by another thread meanwhile.
+TEST_F(AccessLogManagerImplTest, StalledFileDoesNotBlockOtherFiles) {
+  EXPECT_CALL(dispatcher_, createTimer_(_)).WillRepeatedly(ReturnNew<NiceMock<Event::MockTimer>>());
+
+  Sequence sq;
+  EXPECT_CALL(*file_, open_(_))
+      .InSequence(sq)
+      .WillOnce(Return(ByMove(Filesystem::resultSuccess<bool>(true))));
+  AccessLogFileSharedPtr stalled_log = access_log_manager_.createAccessLog("foo");
+
+  NiceMock<Filesystem::MockFile>* file2 = new NiceMock<Filesystem::MockFile>;
+  EXPECT_CALL(file_system_, createFile("bar"))
+      .WillOnce(Return(ByMove(std::unique_ptr<NiceMock<Filesystem::MockFile>>(file2))));
+  EXPECT_CALL(*file2, open_(_)).WillOnce(Return(ByMove(Filesystem::resultSuccess<bool>(true))));
+  AccessLogFileSharedPtr log = access_log_manager_.createAccessLog("bar");
+
+  absl::Notification reopening;
+  absl::Notification unstall;
+  EXPECT_CALL(*file_, close_())
+      .InSequence(sq)
+      .WillOnce(Return(ByMove(Filesystem::resultSuccess<bool>(true))));
+  EXPECT_CALL(*file_, open_(_))
+      .InSequence(sq)
+      .WillOnce(Invoke([&](Filesystem::FlagSet) -> Api::IoCallBoolResult {
+        reopening.Notify();
+        unstall.WaitForNotification();
+        return Filesystem::resultSuccess<bool>(true);
+      }));
+  EXPECT_CALL(*file_, write_(_))
+      .InSequence(sq)
+      .WillOnce(Invoke([](absl::string_view data) -> Api::IoCallSizeResult {
+        EXPECT_EQ("stalled", data);
+        return Filesystem::resultSuccess<ssize_t>(static_cast<ssize_t>(data.length()));
+      }));
+  EXPECT_CALL(*file2, write_(_))
+      .WillOnce(Invoke([](absl::string_view data) -> Api::IoCallSizeResult {
+        EXPECT_EQ("not stalled", data);
+        return Filesystem::resultSuccess<ssize_t>(static_cast<ssize_t>(data.length()));
+      }));
+
+  stalled_log->reopen();
+  stalled_log->write("stalled");
+  reopening.WaitForNotification();
+
+  log->write("not stalled");
+  {
+    Thread::LockGuard lock(file2->write_mutex_);
+    while (file2->num_writes_ != 1) {
+      file2->write_event_.wait(file2->write_mutex_);
+    }
+  }
+
+  unstall.Notify();
+  {
+    Thread::LockGuard lock(file_->write_mutex_);
+    while (file_->num_writes_ != 1) {
+      file_->write_event_.wait(file_->write_mutex_);
+    }
+  }
+
+  EXPECT_CALL(*file_, close_())
+      .InSequence(sq)
+      .WillOnce(Return(ByMove(Filesystem::resultSuccess<bool>(true))));
+  EXPECT_CALL(*file2, close_()).WillOnce(Return(ByMove(Filesystem::resultSuccess<bool>(true))));
+}
+
 } // namespace
 } // namespace AccessLog
 } // namespace Envoy
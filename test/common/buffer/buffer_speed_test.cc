@@ -12,6 +12,17 @@ static constexpr uint64_t MaxBufferLength = 1024 * 1024;
 // loop in the benchmarks below. Do not attempt to release the actual contents of the buffer.
 void deleteFragment(const void*, size_t, const Buffer::BufferFragmentImpl* self) { delete self; }
 
+// Reports how often the slices allocated since start were taken from the slice caches, and how
+// many bytes the caches hold at the end of the benchmark.
+void reportSliceCacheStats(benchmark::State& state, const Buffer::SliceCacheStats& start) {
+  const Buffer::SliceCacheStats end = Buffer::OwnedSlice::cacheStats();
+  const uint64_t hits = end.hits_ - start.hits_;
+  const uint64_t allocations = hits + end.misses_ - start.misses_;
+  state.counters["slice_cache_hit_rate"] =
+      allocations == 0 ? 0 : static_cast<double>(hits) / allocations;
+  state.counters["slice_cache_bytes"] = end.bytes_cached_;
+}
+
 // Test the creation of an empty OwnedImpl.
 static void bufferCreateEmpty(benchmark::State& state) {
   uint64_t length = 0;
@@ -61,12 +72,14 @@ static void bufferAddString(benchmark::State& state) {
   const std::string data(state.range(0), 'a');
   const absl::string_view input(data);
   Buffer::OwnedImpl buffer(input);
+  const Buffer::SliceCacheStats slice_cache_stats = Buffer::OwnedSlice::cacheStats();
   for (auto _ : state) {
     buffer.add(data);
     if (buffer.length() >= MaxBufferLength) {
       buffer.drain(buffer.length());
     }
   }
+  reportSliceCacheStats(state, slice_cache_stats);
   benchmark::DoNotOptimize(buffer.length());
 }
 BENCHMARK(bufferAddString)->Arg(1)->Arg(4096)->Arg(16384)->Arg(65536);
@@ -78,12 +91,14 @@ static void bufferAddBuffer(benchmark::State& state) {
   const absl::string_view input(data);
   const Buffer::OwnedImpl to_add(data);
   Buffer::OwnedImpl buffer(input);
+  const Buffer::SliceCacheStats slice_cache_stats = Buffer::OwnedSlice::cacheStats();
   for (auto _ : state) {
     buffer.add(to_add);
     if (buffer.length() >= MaxBufferLength) {
       buffer.drain(buffer.length());
     }
   }
+  reportSliceCacheStats(state, slice_cache_stats);
   benchmark::DoNotOptimize(buffer.length());
 }
 BENCHMARK(bufferAddBuffer)->Arg(1)->Arg(4096)->Arg(16384)->Arg(65536);
@@ -143,12 +158,14 @@ static void bufferDrain(benchmark::State& state) {
   }
 
   size_t drain_cycle = 0;
+  const Buffer::SliceCacheStats slice_cache_stats = Buffer::OwnedSlice::cacheStats();
   for (auto _ : state) {
     buffer.add(to_add);
     buffer.drain(drain_size[drain_cycle]);
     drain_cycle++;
     drain_cycle %= DrainCycleSize;
   }
+  reportSliceCacheStats(state, slice_cache_stats);
   benchmark::DoNotOptimize(buffer.length());
 }
 BENCHMARK(bufferDrain)->Arg(1)->Arg(4096)->Arg(16384)->Arg(65536);
@@ -158,12 +175,14 @@ static void bufferDrainSmallIncrement(benchmark::State& state) {
   const std::string data(1024 * 1024, 'a');
   const absl::string_view input(data);
   Buffer::OwnedImpl buffer(input);
+  const Buffer::SliceCacheStats slice_cache_stats = Buffer::OwnedSlice::cacheStats();
   for (auto _ : state) {
     buffer.drain(state.range(0));
     if (buffer.length() == 0) {
       buffer.add(input);
     }
   }
+  reportSliceCacheStats(state, slice_cache_stats);
   benchmark::DoNotOptimize(buffer.length());
 }
 BENCHMARK(bufferDrainSmallIncrement)->Arg(1)->Arg(2)->Arg(3)->Arg(4)->Arg(5);
@@ -174,10 +193,12 @@ static void bufferMove(benchmark::State& state) {
   const absl::string_view input(data);
   Buffer::OwnedImpl buffer1(input);
   Buffer::OwnedImpl buffer2(input);
+  const Buffer::SliceCacheStats slice_cache_stats = Buffer::OwnedSlice::cacheStats();
   for (auto _ : state) {
     buffer1.move(buffer2); // now buffer1 has 2 copies of the input, and buffer2 is empty.
     buffer2.move(buffer1, input.size()); // now buffer1 and buffer2 are the same size.
   }
+  reportSliceCacheStats(state, slice_cache_stats);
   uint64_t length = buffer1.length();
   benchmark::DoNotOptimize(length);
 }
@@ -6,6 +6,7 @@
 
 #include "test/common/buffer/utility.h"
 #include "test/test_common/printers.h"
+#include "test/test_common/thread_factory_for_test.h"
 #include "test/test_common/utility.h"
 
 #include "gtest/gtest.h"
@@ -69,6 +70,106 @@ TEST_F(OwnedSliceTest, Create) {
   }
 }
 
+// Freed slices are reused by the next slices of the same size created on the thread.
+TEST_F(OwnedSliceTest, ReusesFreedSlices) {
+  auto slice = OwnedSlice::create(16384);
+  const void* data = slice->data();
+  slice.reset();
+  auto small_slice = OwnedSlice::create(100);
+  EXPECT_NE(data, small_slice->data());
+  slice = OwnedSlice::create(16384);
+  EXPECT_EQ(data, slice->data());
+
+  slice = OwnedSlice::create("hello", 5);
+  EXPECT_TRUE(sliceMatches(slice, "hello"));
+  data = slice->data();
+  slice.reset();
+  slice = OwnedSlice::create(5);
+  EXPECT_EQ(data, slice->data());
+}
+
+// Slices are sized in whole pages, so that each slice is in the smallest size class which holds it.
+TEST_F(OwnedSliceTest, SizeClasses) {
+  const uint64_t page_size = OwnedSlice::PageSize;
+  EXPECT_EQ(page_size - sizeof(OwnedSlice), OwnedSlice::create(1)->reservableSize());
+  EXPECT_EQ(2 * page_size - sizeof(OwnedSlice), OwnedSlice::create(page_size)->reservableSize());
+  EXPECT_EQ(3 * page_size - sizeof(OwnedSlice),
+            OwnedSlice::create(2 * page_size)->reservableSize());
+  EXPECT_EQ(5 * page_size - sizeof(OwnedSlice), OwnedSlice::create(16384)->reservableSize());
+  EXPECT_EQ(OwnedSlice::MaxCachedPages * page_size - sizeof(OwnedSlice),
+            OwnedSlice::create((OwnedSlice::MaxCachedPages - 1) * page_size)->reservableSize());
+  EXPECT_EQ((OwnedSlice::MaxCachedPages + 2) * page_size - sizeof(OwnedSlice),
+            OwnedSlice::create((OwnedSlice::MaxCachedPages + 1) * page_size)->reservableSize());
+}
+
+TEST_F(OwnedSliceTest, CacheStats) {
+  // Empty the free list of the size class, so that the next slice misses.
+  const uint64_t size = 8 * OwnedSlice::PageSize - sizeof(OwnedSlice);
+  std::vector<SlicePtr> slices;
+  SliceCacheStats stats = OwnedSlice::cacheStats();
+  do {
+    slices.push_back(OwnedSlice::create(size));
+  } while (OwnedSlice::cacheStats().misses_ == stats.misses_);
+  slices.clear();
+
+  stats = OwnedSlice::cacheStats();
+  EXPECT_LE(8 * OwnedSlice::PageSize, stats.bytes_cached_);
+  auto slice = OwnedSlice::create(size);
+  EXPECT_EQ(stats.hits_ + 1, OwnedSlice::cacheStats().hits_);
+  EXPECT_EQ(stats.misses_, OwnedSlice::cacheStats().misses_);
+  EXPECT_EQ(stats.bytes_cached_ - 8 * OwnedSlice::PageSize, OwnedSlice::cacheStats().bytes_cached_);
+}
+
+// A thread caches up to MaxCachedBytes of slices across all of its size classes.
+TEST_F(OwnedSliceTest, CacheBytesLimit) {
+  std::vector<SlicePtr> slices;
+  for (uint64_t pages = 1; pages <= OwnedSlice::MaxCachedPages; pages++) {
+    for (uint64_t bytes = 0; bytes < OwnedSlice::MaxCachedBytesPerSizeClass;
+         bytes += pages * OwnedSlice::PageSize) {
+      slices.push_back(OwnedSlice::create(pages * OwnedSlice::PageSize - sizeof(OwnedSlice)));
+    }
+  }
+  slices.clear();
+  EXPECT_GE(OwnedSlice::MaxCachedBytes, OwnedSlice::cacheStats().bytes_cached_);
+}
+
+// Slices freed on another thread return to the cache of the thread which created them.
+TEST_F(OwnedSliceTest, ReturnsSlicesFreedOnOtherThreads) {
+  const uint64_t size = 16 * OwnedSlice::PageSize - sizeof(OwnedSlice);
+  std::vector<SlicePtr> slices;
+  const SliceCacheStats stats = OwnedSlice::cacheStats();
+  do {
+    slices.push_back(OwnedSlice::create(size));
+  } while (OwnedSlice::cacheStats().misses_ == stats.misses_);
+  SlicePtr slice = std::move(slices.back());
+  slices.pop_back();
+  const void* data = slice->data();
+
+  Thread::threadFactoryForTest().createThread([&slice]() { slice.reset(); })->join();
+  slice = OwnedSlice::create(size);
+  EXPECT_EQ(data, slice->data());
+}
+
+// Slices may outlive the thread which created them, and be created while a thread exits.
+TEST_F(OwnedSliceTest, SlicesOutliveTheirThread) {
+  struct ThreadExitSlice {
+    ~ThreadExitSlice() { OwnedSlice::create(100).reset(); }
+  };
+  SlicePtr slice;
+  Thread::threadFactoryForTest()
+      .createThread([&slice]() {
+        static thread_local ThreadExitSlice exit_slice;
+        slice = OwnedSlice::create(100);
+        OwnedSlice::create(100).reset();
+      })
+      ->join();
+  EXPECT_EQ(0, slice->dataSize());
+  slice.reset();
+
+  // The cache of the exited thread is reused by the next one.
+  Thread::threadFactoryForTest().createThread([]() { OwnedSlice::create(100).reset(); })->join();
+}
+
 TEST_F(OwnedSliceTest, ReserveCommit) {
   auto slice = OwnedSlice::create(100);
   const uint64_t initial_capacity = slice->reservableSize();
@@ -4,10 +4,13 @@
 #include "common/buffer/buffer_impl.h"
 #include "common/buffer/watermark_buffer.h"
 #include "common/network/io_socket_handle_impl.h"
+#include "common/stats/isolated_store_impl.h"
 
 #include "test/common/buffer/utility.h"
 #include "test/test_common/test_runtime.h"
 
+#include "absl/strings/str_cat.h"
+
 #include "gtest/gtest.h"
 
 namespace Envoy {
@@ -553,6 +556,186 @@ TEST_F(WatermarkBufferTest, MoveWatermarksOverflow) {
   EXPECT_EQ(1, overflow_watermark_buffer1);
 }
 
+class BufferMemoryAccountTest : public testing::Test {
+public:
+  WatermarkBufferFactory factory_;
+};
+
+TEST_F(BufferMemoryAccountTest, ChargesBufferedSlices) {
+  BufferMemoryAccountSharedPtr account = factory_.createAccount(nullptr);
+  {
+    OwnedImpl buffer;
+    buffer.bindAccount(account);
+    buffer.add(std::string(100, 'a'));
+    // The whole slice is charged, not only its data.
+    EXPECT_GT(account->balance(), 100);
+    EXPECT_EQ(account->balance(), factory_.bytesCharged());
+
+    buffer.drain(buffer.length());
+    EXPECT_EQ(0, account->balance());
+
+    buffer.add(std::string(100, 'a'));
+    EXPECT_GT(account->balance(), 0);
+  }
+  // Slices are credited when the buffer is destroyed.
+  EXPECT_EQ(0, account->balance());
+  EXPECT_EQ(0, factory_.bytesCharged());
+}
+
+TEST_F(BufferMemoryAccountTest, BindRechargesSlices) {
+  BufferMemoryAccountSharedPtr account1 = factory_.createAccount(nullptr);
+  BufferMemoryAccountSharedPtr account2 = factory_.createAccount(nullptr);
+  OwnedImpl buffer;
+  buffer.add(std::string(5000, 'a'));
+
+  buffer.bindAccount(account1);
+  const uint64_t charged = account1->balance();
+  EXPECT_GT(charged, 5000);
+
+  buffer.bindAccount(account2);
+  EXPECT_EQ(0, account1->balance());
+  EXPECT_EQ(charged, account2->balance());
+
+  buffer.bindAccount(nullptr);
+  EXPECT_EQ(0, account2->balance());
+  EXPECT_EQ(0, factory_.bytesCharged());
+}
+
+TEST_F(BufferMemoryAccountTest, MovedSlicesAreChargedToDestination) {
+  BufferMemoryAccountSharedPtr account1 = factory_.createAccount(nullptr);
+  BufferMemoryAccountSharedPtr account2 = factory_.createAccount(nullptr);
+  OwnedImpl buffer1;
+  OwnedImpl buffer2;
+  buffer1.bindAccount(account1);
+  buffer2.bindAccount(account2);
+
+  buffer1.add(std::string(20000, 'a'));
+  const uint64_t charged = account1->balance();
+  buffer2.move(buffer1);
+  EXPECT_EQ(0, account1->balance());
+  EXPECT_EQ(charged, account2->balance());
+  EXPECT_EQ(charged, factory_.bytesCharged());
+
+  // Slices moved to a buffer without an account are no longer charged.
+  OwnedImpl buffer3;
+  buffer3.move(buffer2);
+  EXPECT_EQ(0, account2->balance());
+  EXPECT_EQ(0, factory_.bytesCharged());
+}
+
+TEST_F(BufferMemoryAccountTest, ResetLargestAccountsFirst) {
+  std::vector<int> resets;
+  BufferMemoryAccountSharedPtr small = factory_.createAccount([&]() { resets.push_back(100); });
+  BufferMemoryAccountSharedPtr large = factory_.createAccount([&]() { resets.push_back(300); });
+  BufferMemoryAccountSharedPtr medium = factory_.createAccount([&]() { resets.push_back(200); });
+  BufferMemoryAccountSharedPtr closed = factory_.createAccount([&]() { resets.push_back(400); });
+  small->charge(100);
+  large->charge(300);
+  medium->charge(200);
+  closed->charge(400);
+  closed->clearResetCallback();
+
+  EXPECT_EQ(500, factory_.resetAccounts(350));
+  EXPECT_EQ((std::vector<int>{300, 200}), resets);
+
+  // Accounts are only reset once.
+  EXPECT_EQ(100, factory_.resetAccounts(1000));
+  EXPECT_EQ((std::vector<int>{300, 200, 100}), resets);
+  EXPECT_EQ(0, factory_.resetAccounts(1000));
+
+  small->credit(100);
+  large->credit(300);
+  medium->credit(200);
+  closed->credit(400);
+}
+
+TEST_F(BufferMemoryAccountTest, ResetMayDestroyOtherAccounts) {
+  BufferMemoryAccountSharedPtr other = factory_.createAccount(nullptr);
+  BufferMemoryAccountSharedPtr account = factory_.createAccount([&]() {
+    other->credit(100);
+    other.reset();
+  });
+  other->charge(100);
+  account->charge(200);
+
+  EXPECT_EQ(200, factory_.resetAccounts(1000));
+  EXPECT_EQ(nullptr, other);
+  account->credit(200);
+}
+
+// Closing a connection destroys its streams, whose accounts may be reset in the same pass.
+TEST_F(BufferMemoryAccountTest, ResetConnectionAndItsStreams) {
+  std::vector<std::string> resets;
+  std::vector<BufferMemoryAccountSharedPtr> streams;
+  auto destroy_stream = [&streams](size_t index) {
+    if (streams[index] != nullptr) {
+      streams[index]->clearResetCallback();
+      streams[index]->credit(streams[index]->balance());
+      streams[index].reset();
+    }
+  };
+  BufferMemoryAccountSharedPtr connection = factory_.createAccount([&]() {
+    resets.push_back("connection");
+    for (size_t i = 0; i < streams.size(); i++) {
+      destroy_stream(i);
+    }
+  });
+  for (size_t i = 0; i < 2; i++) {
+    streams.push_back(factory_.createAccount([&resets, &destroy_stream, i]() {
+      resets.push_back(absl::StrCat("stream", i));
+      destroy_stream(i);
+    }));
+  }
+  streams[0]->charge(400);
+  connection->charge(300);
+  streams[1]->charge(200);
+
+  // The second stream is destroyed with the connection before its turn comes.
+  EXPECT_EQ(700, factory_.resetAccounts(1000));
+  EXPECT_EQ((std::vector<std::string>{"stream0", "connection"}), resets);
+  EXPECT_EQ(300, factory_.bytesCharged());
+  connection->credit(300);
+}
+
+TEST_F(BufferMemoryAccountTest, Stats) {
+  Stats::IsolatedStoreImpl store;
+  auto gauge_value = [&store](const std::string& name) {
+    return store.gaugeFromString(name, Stats::Gauge::ImportMode::NeverImport).value();
+  };
+  BufferMemoryAccountSharedPtr account1 = factory_.createAccount([]() {});
+  account1->charge(100);
+  factory_.initializeStats(store, "buffer_memory");
+  EXPECT_EQ(1, gauge_value("buffer_memory.accounts_active"));
+  EXPECT_EQ(100, gauge_value("buffer_memory.bytes_charged"));
+
+  BufferMemoryAccountSharedPtr account2 = factory_.createAccount([]() {});
+  account2->charge(50);
+  EXPECT_EQ(2, gauge_value("buffer_memory.accounts_active"));
+  EXPECT_EQ(150, gauge_value("buffer_memory.bytes_charged"));
+
+  factory_.resetAccounts(1);
+  EXPECT_EQ(1, store.counterFromString("buffer_memory.accounts_reset").value());
+
+  account1->credit(100);
+  account1.reset();
+  EXPECT_EQ(1, gauge_value("buffer_memory.accounts_active"));
+  EXPECT_EQ(50, gauge_value("buffer_memory.bytes_charged"));
+  account2->credit(50);
+}
+
+TEST_F(BufferMemoryAccountTest, TotalBytesCharged) {
+  WatermarkBufferFactory other_factory;
+  const uint64_t baseline = WatermarkBufferFactory::totalBytesCharged();
+  BufferMemoryAccountSharedPtr account1 = factory_.createAccount(nullptr);
+  BufferMemoryAccountSharedPtr account2 = other_factory.createAccount(nullptr);
+  account1->charge(100);
+  account2->charge(200);
+  EXPECT_EQ(baseline + 300, WatermarkBufferFactory::totalBytesCharged());
+  account1->credit(100);
+  account2->credit(200);
+  EXPECT_EQ(baseline, WatermarkBufferFactory::totalBytesCharged());
+}
+
 } // namespace
 } // namespace Buffer
 } // namespace Envoy
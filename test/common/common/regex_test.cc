@@ -157,6 +157,47 @@ TEST(Utility, ParseRegex) {
   }
 }
 
+envoy::type::matcher::v3::RegexMatcher googleReMatcher(const std::string& regex) {
+  envoy::type::matcher::v3::RegexMatcher matcher;
+  matcher.mutable_google_re2();
+  matcher.set_regex(regex);
+  return matcher;
+}
+
+TEST(Utility, ParseRegexSet) {
+  {
+    const auto invalid = googleReMatcher("(+invalid)");
+    EXPECT_THROW_WITH_MESSAGE(Utility::parseRegexSet({&invalid}), EnvoyException,
+                              "no argument for repetition operator: +");
+  }
+
+  {
+    const auto users = googleReMatcher("/api/[^/]+/users");
+    const auto any = googleReMatcher("/api/.*");
+    const auto v1 = googleReMatcher("/api/v1/.*");
+    const auto teams = googleReMatcher("/api/[^/]+/teams");
+    const auto set = Utility::parseRegexSet({&users, &any, &v1, &teams});
+    std::vector<uint32_t> matches{42};
+
+    EXPECT_TRUE(set->match("/api/v1/users", matches));
+    EXPECT_EQ((std::vector<uint32_t>{0, 1, 2}), matches);
+    EXPECT_TRUE(set->match("/api/v2/teams", matches));
+    EXPECT_EQ((std::vector<uint32_t>{1, 3}), matches);
+    // Patterns must match the whole value, like CompiledMatcher::match().
+    EXPECT_TRUE(set->match("/x/api/v2/teams", matches));
+    EXPECT_TRUE(matches.empty());
+    EXPECT_TRUE(set->match("/api/v2/teams/1", matches));
+    EXPECT_EQ((std::vector<uint32_t>{1}), matches);
+  }
+
+  {
+    const auto set = Utility::parseRegexSet({});
+    std::vector<uint32_t> matches;
+    EXPECT_TRUE(set->match("/", matches));
+    EXPECT_TRUE(matches.empty());
+  }
+}
+
 } // namespace
 } // namespace Regex
 } // namespace Envoy
@@ -1,5 +1,6 @@
 #include <chrono>
 #include <string>
+#include <vector>
 
 #include "common/common/assert.h"
 #include "common/common/utility.h"
@@ -294,6 +295,37 @@ TEST_F(FileSystemImplTest, NonExistingFile) {
   EXPECT_EQ(" new data", contents);
 }
 
+TEST_F(FileSystemImplTest, Writev) {
+  const std::string new_file_path = TestEnvironment::temporaryPath("envoy_this_not_exist");
+  ::unlink(new_file_path.c_str());
+
+  {
+    FilePtr file = file_system_.createFile(new_file_path);
+    const Api::IoCallBoolResult open_result = file->open(DefaultFlags);
+    EXPECT_TRUE(open_result.rc_);
+    const std::vector<absl::string_view> buffers{"first ", "", "second ", "third"};
+    const Api::IoCallSizeResult result = file->writev(buffers);
+    EXPECT_EQ(18, result.rc_);
+    EXPECT_EQ(0, file->writev({}).rc_);
+  }
+
+  auto contents = TestEnvironment::readFileToStringForTest(new_file_path);
+  EXPECT_EQ("first second third", contents);
+}
+
+TEST_F(FileSystemImplTest, WritevAfterClose) {
+  const std::string new_file_path = TestEnvironment::temporaryPath("envoy_this_not_exist");
+  ::unlink(new_file_path.c_str());
+
+  FilePtr file = file_system_.createFile(new_file_path);
+  EXPECT_TRUE(file->open(DefaultFlags).rc_);
+  EXPECT_TRUE(file->close().rc_);
+  const std::vector<absl::string_view> buffers{"new ", "data"};
+  const Api::IoCallSizeResult size_result = file->writev(buffers);
+  EXPECT_EQ(-1, size_result.rc_);
+  EXPECT_EQ("Bad file descriptor", size_result.err_->getErrorDetails());
+}
+
 TEST_F(FileSystemImplTest, Close) {
   const std::string new_file_path = TestEnvironment::temporaryPath("envoy_this_not_exist");
   ::unlink(new_file_path.c_str());
@@ -2056,6 +2056,51 @@ TEST(SubstitutionFormatterTest, CompositeFormatterSuccess) {
   }
 }
 
+// Appending a provider's value must produce exactly what format() returns, for every kind of
+// provider and for values that are missing or truncated.
+TEST(SubstitutionFormatterTest, FormatToMatchesFormat) {
+  NiceMock<StreamInfo::MockStreamInfo> stream_info;
+  Http::TestRequestHeaderMapImpl request_header{{"first", "GET"}, {":path", "/"}};
+  Http::TestResponseHeaderMapImpl response_header{{"second", "PUT"}, {"grpc-status", "14"}};
+  Http::TestResponseTrailerMapImpl response_trailer{{"third", "POST"}};
+  const std::string body = "local reply";
+
+  absl::optional<Http::Protocol> protocol = Http::Protocol::Http11;
+  ON_CALL(stream_info, protocol()).WillByDefault(Return(protocol));
+  absl::optional<uint32_t> response_code{200};
+  ON_CALL(stream_info, responseCode()).WillByDefault(Return(response_code));
+  ON_CALL(stream_info, bytesSent()).WillByDefault(Return(1234));
+  ON_CALL(stream_info, requestComplete())
+      .WillByDefault(Return(std::chrono::nanoseconds(5000000)));
+  ON_CALL(stream_info, lastDownstreamRxByteReceived()).WillByDefault(Return(absl::nullopt));
+
+  const std::string format =
+      "%PROTOCOL% %RESPONSE_CODE% %BYTES_SENT% %DURATION% %REQUEST_DURATION% %RESPONSE_FLAGS% "
+      "%UPSTREAM_HOST% %DOWNSTREAM_REMOTE_ADDRESS% %DOWNSTREAM_REMOTE_ADDRESS_WITHOUT_PORT% "
+      "%DOWNSTREAM_LOCAL_PORT% %REQUESTED_SERVER_NAME% %DOWNSTREAM_PEER_SUBJECT% "
+      "%REQ(first):2% %REQ(missing)% %RESP(first?second)% %TRAILER(third):10% %GRPC_STATUS% "
+      "%DYNAMIC_METADATA(com.test)% %FILTER_STATE(key)% %START_TIME(%Y)% %LOCAL_REPLY_BODY%";
+  const std::vector<FormatterProviderPtr> providers = SubstitutionFormatParser::parse(format);
+
+  std::string expected;
+  for (const FormatterProviderPtr& provider : providers) {
+    const std::string value =
+        provider->format(request_header, response_header, response_trailer, stream_info, body);
+    std::string output = "prefix:";
+    provider->formatTo(request_header, response_header, response_trailer, stream_info, body,
+                       output);
+    EXPECT_EQ("prefix:" + value, output);
+    expected += value;
+  }
+
+  FormatterImpl formatter(format);
+  EXPECT_EQ(expected,
+            formatter.format(request_header, response_header, response_trailer, stream_info, body));
+  EXPECT_THAT(expected, testing::StartsWith("HTTP/1.1 200 1234 5 - "));
+  EXPECT_THAT(expected, testing::HasSubstr(" GE - PUT POST Unavailable - - "));
+  EXPECT_THAT(expected, testing::EndsWith(" local reply"));
+}
+
 TEST(SubstitutionFormatterTest, ParserFailures) {
   SubstitutionFormatParser parser;
 
@@ -4,6 +4,7 @@
 #include "envoy/http/codec.h"
 #include "envoy/stats/scope.h"
 
+#include "common/buffer/watermark_buffer.h"
 #include "common/http/exception.h"
 #include "common/http/header_map_impl.h"
 #include "common/http/http2/codec_impl.h"
@@ -234,6 +235,8 @@ public:
 
   absl::optional<const Http2SettingsTuple> client_settings_;
   absl::optional<const Http2SettingsTuple> server_settings_;
+  // Outlives the client streams, for tests which charge them to real accounts.
+  Buffer::WatermarkBufferFactory client_account_factory_;
   bool allow_metadata_ = false;
   bool stream_error_on_invalid_http_messaging_ = false;
   Stats::TestUtil::TestStore client_stats_store_;
@@ -1123,6 +1126,70 @@ TEST_P(Http2CodecImplFlowControlTest, EarlyResetRestoresWindow) {
   EXPECT_EQ(initial_connection_window, nghttp2_session_get_remote_window_size(client_->session()));
 }
 
+// Back up the pending_send_data_ buffer in the client stream and make sure it is charged to the
+// account of the stream.
+TEST_P(Http2CodecImplFlowControlTest, PendingSendDataChargedToAccount) {
+  ON_CALL(client_connection_.dispatcher_.buffer_factory_, createAccount(_))
+      .WillByDefault(Invoke([this](std::function<void()> reset_cb) {
+        return client_account_factory_.createAccount(reset_cb);
+      }));
+  initialize();
+
+  TestRequestHeaderMapImpl request_headers;
+  HttpTestUtility::addDefaultHeaders(request_headers);
+  EXPECT_CALL(request_decoder_, decodeHeaders_(_, false));
+  request_encoder_->encodeHeaders(request_headers, false);
+
+  // Fill the flow control window of the stream, so that the client buffers further data.
+  server_->getStream(1)->readDisable(true);
+  EXPECT_CALL(request_decoder_, decodeData(_, false)).Times(AnyNumber());
+  Buffer::OwnedImpl long_data(std::string(65535, 'a'));
+  request_encoder_->encodeData(long_data, false);
+  EXPECT_EQ(0, client_account_factory_.bytesCharged());
+
+  Buffer::OwnedImpl more_data(std::string(1024, 'a'));
+  request_encoder_->encodeData(more_data, false);
+  EXPECT_EQ(1024, client_->getStreamPendingSendDataLength(1));
+  EXPECT_LE(1024, client_account_factory_.bytesCharged());
+
+  // Once the data is sent, the account is credited.
+  server_->getStream(1)->readDisable(false);
+  EXPECT_EQ(0, client_->getStreamPendingSendDataLength(1));
+  EXPECT_EQ(0, client_account_factory_.bytesCharged());
+}
+
+// Make sure that resetting the account of a stream which buffers data resets the stream.
+TEST_P(Http2CodecImplFlowControlTest, ResetAccountResetsStream) {
+  ON_CALL(client_connection_.dispatcher_.buffer_factory_, createAccount(_))
+      .WillByDefault(Invoke([this](std::function<void()> reset_cb) {
+        return client_account_factory_.createAccount(reset_cb);
+      }));
+  initialize();
+
+  TestRequestHeaderMapImpl request_headers;
+  HttpTestUtility::addDefaultHeaders(request_headers);
+  EXPECT_CALL(request_decoder_, decodeHeaders_(_, false));
+  request_encoder_->encodeHeaders(request_headers, false);
+
+  server_->getStream(1)->readDisable(true);
+  EXPECT_CALL(request_decoder_, decodeData(_, false)).Times(AnyNumber());
+  Buffer::OwnedImpl long_data(std::string(65535 + 1024, 'a'));
+  request_encoder_->encodeData(long_data, false);
+  const uint64_t bytes_charged = client_account_factory_.bytesCharged();
+  EXPECT_LT(0, bytes_charged);
+
+  MockStreamCallbacks callbacks;
+  request_encoder_->getStream().addCallbacks(callbacks);
+  EXPECT_CALL(callbacks, onResetStream(StreamResetReason::Overflow, _));
+  EXPECT_CALL(server_stream_callbacks_, onResetStream(StreamResetReason::RemoteReset, _));
+  EXPECT_EQ(bytes_charged, client_account_factory_.resetAccounts(1));
+
+  // The account is credited once the stream is destroyed, and isn't reset again.
+  EXPECT_EQ(0, client_account_factory_.resetAccounts(1));
+  client_connection_.dispatcher_.clearDeferredDeleteList();
+  EXPECT_EQ(0, client_account_factory_.bytesCharged());
+}
+
 // Test the HTTP2 pending_recv_data_ buffer going over and under watermark limits.
 TEST_P(Http2CodecImplFlowControlTest, FlowControlPendingRecvData) {
   initialize();
@@ -6,6 +6,7 @@
 #include "envoy/config/core/v3/base.pb.h"
 
 #include "common/buffer/buffer_impl.h"
+#include "common/buffer/watermark_buffer.h"
 #include "common/common/empty_string.h"
 #include "common/common/fmt.h"
 #include "common/event/dispatcher_impl.h"
@@ -13,11 +14,14 @@
 #include "common/network/connection_impl.h"
 #include "common/network/io_socket_handle_impl.h"
 #include "common/network/listen_socket_impl.h"
+#include "common/network/raw_buffer_socket.h"
 #include "common/network/utility.h"
 #include "common/runtime/runtime_impl.h"
+#include "common/stats/isolated_store_impl.h"
 
 #include "test/mocks/buffer/mocks.h"
 #include "test/mocks/event/mocks.h"
+#include "test/mocks/network/io_handle.h"
 #include "test/mocks/network/mocks.h"
 #include "test/mocks/stats/mocks.h"
 #include "test/test_common/environment.h"
@@ -37,6 +41,7 @@ using testing::InSequence;
 using testing::Invoke;
 using testing::InvokeWithoutArgs;
 using testing::Return;
+using testing::ReturnRef;
 using testing::SaveArg;
 using testing::Sequence;
 using testing::StrictMock;
@@ -52,6 +57,81 @@ TEST(RawBufferSocket, TestBasics) {
   EXPECT_EQ("", raw_buffer_socket->protocol());
 }
 
+class RawBufferSocketReadTest : public testing::Test {
+protected:
+  RawBufferSocketReadTest() {
+    ON_CALL(callbacks_, ioHandle()).WillByDefault(ReturnRef(io_handle_));
+    raw_buffer_socket_.setTransportSocketCallbacks(callbacks_);
+  }
+
+  // Has the socket read once, returning up to bytes, and then find no more data. Returns the size
+  // of the read.
+  uint64_t doRead(uint64_t bytes) {
+    uint64_t read_size = 0;
+    EXPECT_CALL(io_handle_, readv(_, _, _))
+        .WillOnce(Invoke([&read_size, bytes](uint64_t max_length, Buffer::RawSlice*, uint64_t) {
+          read_size = max_length;
+          return Api::IoCallUint64Result(std::min(bytes, max_length),
+                                         Api::IoErrorPtr(nullptr, [](Api::IoError*) {}));
+        }))
+        .WillOnce(Invoke([](uint64_t, Buffer::RawSlice*, uint64_t) {
+          return Api::IoCallUint64Result(
+              0, Api::IoErrorPtr(IoSocketError::getIoSocketEagainInstance(),
+                                 IoSocketError::deleteIoError));
+        }));
+    Buffer::OwnedImpl buffer;
+    IoResult result = raw_buffer_socket_.doRead(buffer);
+    EXPECT_EQ(PostIoAction::KeepOpen, result.action_);
+    EXPECT_EQ(std::min(bytes, read_size), result.bytes_processed_);
+    return read_size;
+  }
+
+  testing::NiceMock<MockTransportSocketCallbacks> callbacks_;
+  testing::NiceMock<MockIoHandle> io_handle_;
+  RawBufferSocket raw_buffer_socket_;
+};
+
+TEST_F(RawBufferSocketReadTest, ReportsReads) {
+  InSequence s;
+  EXPECT_CALL(callbacks_, onSocketRead(100));
+  EXPECT_CALL(callbacks_, onSocketRead(0));
+  doRead(100);
+}
+
+TEST_F(RawBufferSocketReadTest, GrowsForBulkReads) {
+  EXPECT_EQ(RawBufferSocket::DefaultReadSize, doRead(1024 * 1024));
+  EXPECT_EQ(2 * RawBufferSocket::DefaultReadSize, doRead(1024 * 1024));
+  EXPECT_EQ(RawBufferSocket::MaxReadSize, doRead(1024 * 1024));
+  EXPECT_EQ(RawBufferSocket::MaxReadSize, doRead(1024 * 1024));
+}
+
+TEST_F(RawBufferSocketReadTest, GrowsUpToBufferLimit) {
+  ON_CALL(callbacks_.connection_, bufferLimit()).WillByDefault(Return(20000));
+  EXPECT_EQ(RawBufferSocket::DefaultReadSize, doRead(1024 * 1024));
+  EXPECT_EQ(20000, doRead(1024 * 1024));
+  EXPECT_EQ(20000, doRead(1024 * 1024));
+}
+
+TEST_F(RawBufferSocketReadTest, ShrinksForSmallReads) {
+  uint64_t read_size = RawBufferSocket::DefaultReadSize;
+  while (read_size > RawBufferSocket::MinReadSize) {
+    EXPECT_EQ(read_size, doRead(100));
+    EXPECT_EQ(read_size, doRead(100));
+    read_size /= 2;
+  }
+  EXPECT_EQ(RawBufferSocket::MinReadSize, doRead(100));
+  EXPECT_EQ(RawBufferSocket::MinReadSize, doRead(100));
+  EXPECT_EQ(RawBufferSocket::MinReadSize, raw_buffer_socket_.readSize());
+
+  // Reads of more than a quarter of the read size break a run of small reads.
+  EXPECT_EQ(RawBufferSocket::MinReadSize, doRead(2 * RawBufferSocket::MinReadSize));
+  EXPECT_EQ(2 * RawBufferSocket::MinReadSize, doRead(2 * RawBufferSocket::MinReadSize));
+  EXPECT_EQ(4 * RawBufferSocket::MinReadSize, doRead(100));
+  EXPECT_EQ(4 * RawBufferSocket::MinReadSize, doRead(2 * RawBufferSocket::MinReadSize));
+  EXPECT_EQ(4 * RawBufferSocket::MinReadSize, doRead(100));
+  EXPECT_EQ(4 * RawBufferSocket::MinReadSize, raw_buffer_socket_.readSize());
+}
+
 TEST(ConnectionImplUtility, updateBufferStats) {
   StrictMock<Stats::MockCounter> counter;
   StrictMock<Stats::MockGauge> gauge;
@@ -102,7 +182,8 @@ class ConnectionImplTest : public testing::TestWithParam<Address::IpVersion> {
 protected:
   ConnectionImplTest() : api_(Api::createApiForTest(time_system_)), stream_info_(time_system_) {}
 
-  void setUpBasicConnection() {
+  void setUpBasicConnection(
+      Network::TransportSocketPtr transport_socket = Network::Test::createRawBufferSocket()) {
     if (dispatcher_.get() == nullptr) {
       dispatcher_ = api_->allocateDispatcher("test_thread");
     }
@@ -111,8 +192,8 @@ protected:
     listener_ =
         dispatcher_->createListener(socket_, listener_callbacks_, true, ENVOY_TCP_BACKLOG_SIZE);
     client_connection_ = std::make_unique<Network::TestClientConnectionImpl>(
-        *dispatcher_, socket_->localAddress(), source_address_,
-        Network::Test::createRawBufferSocket(), socket_options_);
+        *dispatcher_, socket_->localAddress(), source_address_, std::move(transport_socket),
+        socket_options_);
     client_connection_->addConnectionCallbacks(client_callbacks_);
     EXPECT_EQ(nullptr, client_connection_->ssl());
     const Network::ClientConnection& const_connection = *client_connection_;
@@ -491,6 +572,103 @@ TEST_P(ConnectionImplTest, ConnectionStats) {
   dispatcher_->run(Event::Dispatcher::RunType::Block);
 }
 
+TEST_P(ConnectionImplTest, ReadStats) {
+  setUpBasicConnection();
+  connect();
+
+  StrictMock<Stats::MockCounter> reads_total;
+  StrictMock<Stats::MockHistogram> read_size;
+  server_connection_->setReadStats({reads_total, read_size});
+
+  // The data is read by one read, which is followed by one finding no more.
+  EXPECT_CALL(reads_total, inc()).Times(2);
+  EXPECT_CALL(read_size, recordValue(4));
+  EXPECT_CALL(*read_filter_, onData(_, false))
+      .WillOnce(Invoke([&](Buffer::Instance& data, bool) -> FilterStatus {
+        EXPECT_EQ("1234", data.toString());
+        data.drain(data.length());
+        dispatcher_->exit();
+        return FilterStatus::StopIteration;
+      }));
+  Buffer::OwnedImpl data("1234");
+  client_connection_->write(data, false);
+  dispatcher_->run(Event::Dispatcher::RunType::Block);
+
+  // Reading the close is counted as well.
+  EXPECT_CALL(reads_total, inc());
+  disconnect(true);
+}
+
+TEST_P(ConnectionImplTest, SpliceableIoHandle) {
+  setUpBasicConnection();
+  connect();
+
+  EXPECT_EQ(&testClientConnection()->ioHandle(), client_connection_->spliceableIoHandle());
+
+  // Connections which have read their end of stream, or written theirs, aren't spliced.
+  EXPECT_CALL(*read_filter_, onData(_, true))
+      .WillOnce(Invoke([&](Buffer::Instance&, bool) -> FilterStatus {
+        dispatcher_->exit();
+        return FilterStatus::StopIteration;
+      }));
+  server_connection_->enableHalfClose(true);
+  client_connection_->enableHalfClose(true);
+  Buffer::OwnedImpl data;
+  client_connection_->write(data, true);
+  dispatcher_->run(Event::Dispatcher::RunType::Block);
+  EXPECT_EQ(nullptr, client_connection_->spliceableIoHandle());
+  EXPECT_EQ(nullptr, server_connection_->spliceableIoHandle());
+
+  disconnect(true);
+}
+
+TEST_P(ConnectionImplTest, RecordSplicedBytes) {
+  setUpBasicConnection();
+  connect();
+
+  MockConnectionStats connection_stats;
+  client_connection_->setConnectionStats(connection_stats.toBufferStats());
+  EXPECT_CALL(connection_stats.rx_total_, add(4));
+  EXPECT_CALL(connection_stats.tx_total_, add(6));
+  client_connection_->recordSplicedBytes(4, 6);
+  EXPECT_EQ(4U, client_connection_->streamInfo().bytesReceived());
+  EXPECT_EQ(6U, client_connection_->streamInfo().bytesSent());
+
+  disconnect(true);
+}
+
+TEST_P(ConnectionImplTest, ZeroCopyWrite) {
+  Stats::IsolatedStoreImpl stats_store;
+  auto zero_copy_config = std::make_shared<RawBufferZeroCopyConfig>(16384, stats_store);
+  setUpBasicConnection(std::make_unique<RawBufferSocket>(zero_copy_config));
+  connect();
+
+  // Large enough for some of the writes to be sent without copying.
+  std::string data_to_write(1024 * 1024, 'a');
+  for (size_t i = 0; i < data_to_write.size(); i++) {
+    data_to_write[i] += i % 26;
+  }
+  std::string data_read;
+  EXPECT_CALL(*read_filter_, onData(_, false))
+      .WillRepeatedly(Invoke([&](Buffer::Instance& data, bool) -> FilterStatus {
+        data_read += data.toString();
+        data.drain(data.length());
+        if (data_read.size() == data_to_write.size()) {
+          dispatcher_->exit();
+        }
+        return FilterStatus::StopIteration;
+      }));
+  Buffer::OwnedImpl buffer(data_to_write);
+  client_connection_->write(buffer, false);
+  dispatcher_->run(Event::Dispatcher::RunType::Block);
+  EXPECT_EQ(data_to_write, data_read);
+#if defined(__linux__)
+  EXPECT_GE(zero_copy_config->stats_.zero_copy_sends_.value(), 1);
+#endif
+
+  disconnect(true);
+}
+
 // Ensure the new counter logic in ReadDisable avoids tripping asserts in ReadDisable guarding
 // against actual enabling twice in a row.
 TEST_P(ConnectionImplTest, ReadDisable) {
@@ -1705,6 +1883,10 @@ public:
                                   std::function<void()> above_overflow) -> Buffer::Instance* {
           return new Buffer::WatermarkBuffer(below_low, above_high, above_overflow);
         }));
+    ON_CALL(dispatcher_.buffer_factory_, createAccount(_))
+        .WillByDefault(Invoke([this](std::function<void()> reset_cb) {
+          return account_factory_.createAccount(reset_cb);
+        }));
 
     file_event_ = new Event::MockFileEvent;
     EXPECT_CALL(dispatcher_, createFileEvent_(0, _, _, _))
@@ -1731,6 +1913,8 @@ public:
     return {PostIoAction::KeepOpen, size, false};
   }
 
+  // Outlives the account of connection_.
+  Buffer::WatermarkBufferFactory account_factory_;
   std::unique_ptr<ConnectionImpl> connection_;
   Event::MockDispatcher dispatcher_;
   NiceMock<MockConnectionCallbacks> callbacks_;
@@ -1837,6 +2021,42 @@ TEST_F(MockTransportConnectionImplTest, BytesSentCloseInCallback) {
   EXPECT_EQ(connection_->state(), Connection::State::Closed);
 }
 
+// Test that the data buffered by the connection is charged to its account.
+TEST_F(MockTransportConnectionImplTest, BufferMemoryAccount) {
+  EXPECT_CALL(*file_event_, activate(Event::FileReadyType::Write));
+  Buffer::OwnedImpl buffer("some data");
+  connection_->write(buffer, false);
+  EXPECT_LT(0, account_factory_.bytesCharged());
+
+  EXPECT_CALL(*transport_socket_, doWrite(BufferStringEqual("some data"), false))
+      .WillOnce(Invoke(SimulateSuccessfulWrite));
+  file_ready_cb_(Event::FileReadyType::Write);
+  EXPECT_EQ(0, account_factory_.bytesCharged());
+
+  EXPECT_CALL(*transport_socket_, doRead(_))
+      .WillOnce(Invoke([](Buffer::Instance& buffer) -> IoResult {
+        buffer.add("some data");
+        return {PostIoAction::KeepOpen, 9, false};
+      }));
+  file_ready_cb_(Event::FileReadyType::Read);
+  EXPECT_LT(0, account_factory_.bytesCharged());
+}
+
+// Test that resetting the account of the connection closes it.
+TEST_F(MockTransportConnectionImplTest, ResetBufferMemoryAccount) {
+  EXPECT_CALL(*file_event_, activate(Event::FileReadyType::Write));
+  Buffer::OwnedImpl buffer("some data");
+  connection_->write(buffer, false);
+  const uint64_t bytes_charged = account_factory_.bytesCharged();
+
+  EXPECT_CALL(callbacks_, onEvent(ConnectionEvent::LocalClose));
+  EXPECT_EQ(bytes_charged, account_factory_.resetAccounts(1));
+  EXPECT_EQ(Connection::State::Closed, connection_->state());
+
+  // A closed connection is not reset again.
+  EXPECT_EQ(0, account_factory_.resetAccounts(1));
+}
+
 // Test that onWrite does not have end_stream set, with half-close disabled
 TEST_F(MockTransportConnectionImplTest, FullCloseWrite) {
   const std::string val("some data");
@@ -1216,6 +1216,109 @@ virtual_hosts:
             config.route(genHeaders("example.com", "/", "GET"), 0)->routeEntry()->clusterName());
 }
 
+// Routes are looked up through an index over their paths; the first matching route in config
+// order must still win, whatever kind of path match each route uses.
+TEST_F(RouteMatcherTest, IndexedRoutesKeepFirstMatch) {
+  const std::string yaml = R"EOF(
+virtual_hosts:
+  - name: local_service
+    domains: ["*"]
+    routes:
+      - match:
+          prefix: "/api/v1"
+          headers:
+            - name: x-version
+              exact_match: "2"
+        route: { cluster: "v1_header" }
+      - match:
+          safe_regex:
+            google_re2: {}
+            regex: "/api/[^/]+/users"
+        route: { cluster: "regex_users" }
+      - match: { path: "/api/v1/users" }
+        route: { cluster: "exact_users" }
+      - match: { path: "/api/v1/teams" }
+        route: { cluster: "exact_teams" }
+      - match: { prefix: "/API/V1", case_sensitive: false }
+        route: { cluster: "ci_prefix" }
+      - match: { prefix: "/api" }
+        route: { cluster: "api" }
+      - match: { path: "/Other", case_sensitive: false }
+        route: { cluster: "ci_exact" }
+      - match: { prefix: "/" }
+        route: { cluster: "default" }
+  )EOF";
+
+  const auto proto_config = parseRouteConfigurationFromYaml(yaml);
+  TestConfigImpl config(proto_config, factory_context_, true);
+
+  EXPECT_EQ("regex_users",
+            config.route(genHeaders("www.lyft.com", "/api/v1/users", "GET"), 0)
+                ->routeEntry()
+                ->clusterName());
+  EXPECT_EQ("exact_teams",
+            config.route(genHeaders("www.lyft.com", "/api/v1/teams?limit=10", "GET"), 0)
+                ->routeEntry()
+                ->clusterName());
+  EXPECT_EQ("ci_prefix",
+            config.route(genHeaders("www.lyft.com", "/Api/v1/groups", "GET"), 0)
+                ->routeEntry()
+                ->clusterName());
+  EXPECT_EQ(
+      "api",
+      config.route(genHeaders("www.lyft.com", "/api/v2", "GET"), 0)->routeEntry()->clusterName());
+  EXPECT_EQ("ci_exact", config.route(genHeaders("www.lyft.com", "/OTHER#top", "GET"), 0)
+                            ->routeEntry()
+                            ->clusterName());
+  EXPECT_EQ("default", config.route(genHeaders("www.lyft.com", "/other/page", "GET"), 0)
+                           ->routeEntry()
+                           ->clusterName());
+
+  Http::TestRequestHeaderMapImpl headers = genHeaders("www.lyft.com", "/api/v1/users", "GET");
+  headers.addCopy("x-version", "2");
+  EXPECT_EQ("v1_header", config.route(headers, 0)->routeEntry()->clusterName());
+}
+
+// Regex routes are matched together in one pass; each still applies its other criteria, in order.
+TEST_F(RouteMatcherTest, RegexRoutesKeepFirstMatch) {
+  const std::string yaml = R"EOF(
+virtual_hosts:
+  - name: local_service
+    domains: ["*"]
+    routes:
+      - match:
+          safe_regex: { google_re2: {}, regex: "/users/[0-9]+" }
+          headers:
+            - name: x-admin
+              present_match: true
+        route: { cluster: "admin_user" }
+      - match:
+          safe_regex: { google_re2: {}, regex: "/users/.*" }
+        route: { cluster: "any_user" }
+      - match:
+          safe_regex: { google_re2: {}, regex: "/users/[0-9]+" }
+        route: { cluster: "numeric_user" }
+      - match:
+          safe_regex: { google_re2: {}, regex: "/teams/[^/]+" }
+        route: { cluster: "team" }
+  )EOF";
+
+  TestConfigImpl config(parseRouteConfigurationFromYaml(yaml), factory_context_, true);
+
+  EXPECT_EQ("any_user", config.route(genHeaders("www.lyft.com", "/users/12?q", "GET"), 0)
+                            ->routeEntry()
+                            ->clusterName());
+  EXPECT_EQ("team", config.route(genHeaders("www.lyft.com", "/teams/core", "GET"), 0)
+                        ->routeEntry()
+                        ->clusterName());
+  EXPECT_EQ(nullptr, config.route(genHeaders("www.lyft.com", "/teams/core/x", "GET"), 0));
+  EXPECT_EQ(nullptr, config.route(genHeaders("www.lyft.com", "/x/users/12", "GET"), 0));
+
+  Http::TestRequestHeaderMapImpl headers = genHeaders("www.lyft.com", "/users/12", "GET");
+  headers.addCopy("x-admin", "1");
+  EXPECT_EQ("admin_user", config.route(headers, 0)->routeEntry()->clusterName());
+}
+
 // When deprecating regex: this test can be removed.
 TEST_F(RouteMatcherTest, DEPRECATED_FEATURE_TEST(TestRoutesWithInvalidRegexLegacy)) {
   std::string invalid_route = R"EOF(
@@ -0,0 +1,100 @@
+// Usage: bazel run //test/common/router:route_matcher_speed_test
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "envoy/config/route/v3/route.pb.h"
+
+#include "common/protobuf/message_validator_impl.h"
+#include "common/router/config_impl.h"
+
+#include "test/mocks/server/instance.h"
+#include "test/mocks/stream_info/mocks.h"
+#include "test/test_common/utility.h"
+
+#include "benchmark/benchmark.h"
+
+namespace Envoy {
+namespace Router {
+namespace {
+
+// Builds a single virtual host with num_routes routes, alternating between path and prefix
+// matches, followed by a catch-all prefix route.
+envoy::config::route::v3::RouteConfiguration makeRouteConfig(uint64_t num_routes) {
+  envoy::config::route::v3::RouteConfiguration config;
+  auto* vhost = config.add_virtual_hosts();
+  vhost->set_name("default");
+  vhost->add_domains("*");
+  for (uint64_t i = 0; i < num_routes; i++) {
+    auto* route = vhost->add_routes();
+    if (i % 2 == 0) {
+      route->mutable_match()->set_path(fmt::format("/service{}/method", i));
+    } else {
+      route->mutable_match()->set_prefix(fmt::format("/service{}/", i));
+    }
+    route->mutable_route()->set_cluster(fmt::format("cluster{}", i));
+  }
+  auto* route = vhost->add_routes();
+  route->mutable_match()->set_prefix("/");
+  route->mutable_route()->set_cluster("default");
+  return config;
+}
+
+class RouteMatcherTester {
+public:
+  explicit RouteMatcherTester(uint64_t num_routes)
+      : config_(makeRouteConfig(num_routes), factory_context_,
+                ProtobufMessage::getNullValidationVisitor(), false) {
+    // Hit routes spread over the table, plus the catch-all at its end.
+    for (uint64_t i = 0; i < num_routes; i += std::max<uint64_t>(num_routes / 8, 1)) {
+      paths_.push_back(i % 2 == 0 ? fmt::format("/service{}/method", i)
+                                  : fmt::format("/service{}/method?x=y", i));
+    }
+    paths_.push_back("/unknown");
+  }
+
+  testing::NiceMock<Server::Configuration::MockServerFactoryContext> factory_context_;
+  const ConfigImpl config_;
+  testing::NiceMock<StreamInfo::MockStreamInfo> stream_info_;
+  std::vector<std::string> paths_;
+};
+
+// Selects routes with the path index.
+void bmIndexedRouteMatch(benchmark::State& state) {
+  RouteMatcherTester tester(state.range(0));
+  std::vector<Http::TestRequestHeaderMapImpl> headers;
+  for (const std::string& path : tester.paths_) {
+    headers.push_back({{":authority", "example.com"}, {":path", path}, {":method", "GET"}});
+  }
+  size_t i = 0;
+  for (auto _ : state) {
+    RouteConstSharedPtr route =
+        tester.config_.route(headers[i++ % headers.size()], tester.stream_info_, 0);
+    benchmark::DoNotOptimize(route);
+  }
+}
+BENCHMARK(bmIndexedRouteMatch)->Arg(10)->Arg(100)->Arg(1000)->Arg(10000);
+
+// Selects routes by walking every route in order, as is still done when a route callback is given.
+void bmLinearRouteMatch(benchmark::State& state) {
+  RouteMatcherTester tester(state.range(0));
+  std::vector<Http::TestRequestHeaderMapImpl> headers;
+  for (const std::string& path : tester.paths_) {
+    headers.push_back({{":authority", "example.com"}, {":path", path}, {":method", "GET"}});
+  }
+  const RouteCallback accept = [](RouteConstSharedPtr, RouteEvalStatus) {
+    return RouteMatchStatus::Accept;
+  };
+  size_t i = 0;
+  for (auto _ : state) {
+    RouteConstSharedPtr route =
+        tester.config_.route(accept, headers[i++ % headers.size()], tester.stream_info_, 0);
+    benchmark::DoNotOptimize(route);
+  }
+}
+BENCHMARK(bmLinearRouteMatch)->Arg(10)->Arg(100)->Arg(1000)->Arg(10000);
+
+} // namespace
+} // namespace Router
+} // namespace Envoy
@@ -0,0 +1,128 @@
+#include "envoy/type/matcher/v3/regex.pb.h"
+
+#include "common/router/route_path_index.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Router {
+namespace {
+
+using testing::ElementsAre;
+using testing::IsEmpty;
+
+class RoutePathIndexTest : public testing::Test {
+protected:
+  RoutePathIndex::Candidates candidates(absl::string_view path) {
+    RoutePathIndex::Candidates result;
+    index_.candidates(path, result);
+    return result;
+  }
+
+  RoutePathIndex index_;
+};
+
+TEST_F(RoutePathIndexTest, Empty) { EXPECT_THAT(candidates("/foo"), IsEmpty()); }
+
+TEST_F(RoutePathIndexTest, Exact) {
+  index_.addExact(0, "/foo", true);
+  index_.addExact(1, "/foo/bar", true);
+  index_.addExact(2, "/foo", true);
+
+  EXPECT_THAT(candidates("/foo"), ElementsAre(0, 2));
+  EXPECT_THAT(candidates("/foo/bar"), ElementsAre(1));
+  EXPECT_THAT(candidates("/Foo"), IsEmpty());
+  EXPECT_THAT(candidates("/foo/"), IsEmpty());
+}
+
+TEST_F(RoutePathIndexTest, Prefix) {
+  index_.addPrefix(0, "/foo/bar", true);
+  index_.addPrefix(1, "/", true);
+  index_.addPrefix(2, "/foo", true);
+  index_.addPrefix(3, "/fob", true);
+
+  EXPECT_THAT(candidates("/foo/bar/baz"), ElementsAre(0, 1, 2));
+  EXPECT_THAT(candidates("/foo"), ElementsAre(1, 2));
+  EXPECT_THAT(candidates("/fo"), ElementsAre(1));
+  EXPECT_THAT(candidates("/FOO"), ElementsAre(1));
+  EXPECT_THAT(candidates(""), IsEmpty());
+}
+
+TEST_F(RoutePathIndexTest, EmptyPrefix) {
+  index_.addPrefix(0, "", true);
+  EXPECT_THAT(candidates(""), ElementsAre(0));
+  EXPECT_THAT(candidates("/foo"), ElementsAre(0));
+}
+
+TEST_F(RoutePathIndexTest, IgnoreCase) {
+  index_.addExact(0, "/Foo", false);
+  index_.addPrefix(1, "/BAR", false);
+  index_.addPrefix(2, "/bar", true);
+
+  EXPECT_THAT(candidates("/fOO"), ElementsAre(0));
+  EXPECT_THAT(candidates("/foo/"), IsEmpty());
+  EXPECT_THAT(candidates("/bar/baz"), ElementsAre(1, 2));
+  EXPECT_THAT(candidates("/Bar/baz"), ElementsAre(1));
+}
+
+TEST_F(RoutePathIndexTest, Regex) {
+  envoy::type::matcher::v3::RegexMatcher regex;
+  regex.mutable_google_re2();
+  regex.set_regex("/api/[^/]+/users");
+  index_.addRegex(0, regex);
+  index_.addPrefix(1, "/api", true);
+  regex.set_regex("/api/.*");
+  index_.addRegex(2, regex);
+  index_.compile();
+
+  EXPECT_THAT(candidates("/api/v1/users"), ElementsAre(0, 1, 2));
+  EXPECT_THAT(candidates("/api/v1/teams"), ElementsAre(1, 2));
+  EXPECT_THAT(candidates("/apiv1"), ElementsAre(1));
+  EXPECT_THAT(candidates("/other"), IsEmpty());
+}
+
+TEST_F(RoutePathIndexTest, InvalidRegex) {
+  envoy::type::matcher::v3::RegexMatcher regex;
+  regex.mutable_google_re2();
+  regex.set_regex("(+invalid)");
+  index_.addRegex(0, regex);
+  index_.addPrefix(1, "/", true);
+  index_.compile();
+
+  // Without a compiled set, regex routes are candidates for every path.
+  EXPECT_THAT(candidates("/foo"), ElementsAre(0, 1));
+}
+
+// Candidates of every kind come back in the order the routes were added.
+TEST_F(RoutePathIndexTest, RouteOrder) {
+  index_.addPrefix(0, "/api/v1", true);
+  index_.addUnindexed(1);
+  index_.addExact(2, "/api/v1/users", true);
+  index_.addPrefix(3, "/API", false);
+  index_.addUnindexed(4);
+  index_.addExact(5, "/API/V1/USERS", false);
+  index_.addPrefix(6, "/", true);
+  envoy::type::matcher::v3::RegexMatcher regex;
+  regex.mutable_google_re2();
+  regex.set_regex("/api/v1/.*");
+  index_.addRegex(7, regex);
+  index_.compile();
+
+  EXPECT_THAT(candidates("/api/v1/users"), ElementsAre(0, 1, 2, 3, 4, 5, 6, 7));
+  EXPECT_THAT(candidates("/api/v2"), ElementsAre(1, 3, 4, 6));
+  EXPECT_THAT(candidates("/other"), ElementsAre(1, 4, 6));
+}
+
+// Reusing a candidates vector doesn't leak results from an earlier lookup.
+TEST_F(RoutePathIndexTest, CandidatesReset) {
+  index_.addExact(0, "/foo", true);
+  RoutePathIndex::Candidates result;
+  index_.candidates("/foo", result);
+  index_.candidates("/bar", result);
+  EXPECT_THAT(result, IsEmpty());
+}
+
+} // namespace
+} // namespace Router
+} // namespace Envoy
@@ -57,6 +57,7 @@ using testing::Matcher;
 using testing::MockFunction;
 using testing::NiceMock;
 using testing::Property;
+using testing::Ref;
 using testing::Return;
 using testing::ReturnRef;
 using testing::StartsWith;
@@ -5092,6 +5093,85 @@ TEST_F(RouterTest, UpstreamTimingSingleRequest) {
             std::chrono::milliseconds(32));
 }
 
+// Verify that latency aware load balancers are told how long the host took to respond.
+TEST_F(RouterTest, UpstreamTimingReportedToLoadBalancer) {
+  cm_.thread_local_cluster_.cluster_.info_->lb_type_ = Upstream::LoadBalancerType::PeakEwma;
+  NiceMock<Http::MockRequestEncoder> encoder;
+  Http::ResponseDecoder* response_decoder = nullptr;
+  EXPECT_CALL(cm_.conn_pool_, newStream(_, _))
+      .WillOnce(Invoke(
+          [&](Http::ResponseDecoder& decoder,
+              Http::ConnectionPool::Callbacks& callbacks) -> Http::ConnectionPool::Cancellable* {
+            response_decoder = &decoder;
+            callbacks.onPoolReady(encoder, cm_.conn_pool_.host_, upstream_stream_info_);
+            return nullptr;
+          }));
+  expectResponseTimerCreate();
+
+  Http::TestRequestHeaderMapImpl headers{};
+  HttpTestUtility::addDefaultHeaders(headers);
+  router_.decodeHeaders(headers, true);
+
+  test_time_.advanceTimeWait(std::chrono::milliseconds(43));
+  EXPECT_CALL(cm_.thread_local_cluster_.lb_,
+              onHostResponseTime(Ref(*cm_.conn_pool_.host_),
+                                 std::chrono::nanoseconds(std::chrono::milliseconds(43))));
+  Http::ResponseHeaderMapPtr response_headers(
+      new Http::TestResponseHeaderMapImpl{{":status", "200"}});
+  response_decoder->decodeHeaders(std::move(response_headers), true);
+}
+
+// Verify that latency aware load balancers are told how long a host took before its request timed
+// out.
+TEST_F(RouterTest, UpstreamTimeoutReportedToLoadBalancer) {
+  cm_.thread_local_cluster_.cluster_.info_->lb_type_ = Upstream::LoadBalancerType::PeakEwma;
+  NiceMock<Http::MockRequestEncoder> encoder;
+  EXPECT_CALL(cm_.conn_pool_, newStream(_, _))
+      .WillOnce(Invoke(
+          [&](Http::ResponseDecoder&,
+              Http::ConnectionPool::Callbacks& callbacks) -> Http::ConnectionPool::Cancellable* {
+            callbacks.onPoolReady(encoder, cm_.conn_pool_.host_, upstream_stream_info_);
+            return nullptr;
+          }));
+  expectResponseTimerCreate();
+
+  Http::TestRequestHeaderMapImpl headers{};
+  HttpTestUtility::addDefaultHeaders(headers);
+  router_.decodeHeaders(headers, true);
+
+  test_time_.advanceTimeWait(std::chrono::milliseconds(50));
+  EXPECT_CALL(cm_.thread_local_cluster_.lb_,
+              onHostResponseTime(Ref(*cm_.conn_pool_.host_),
+                                 std::chrono::nanoseconds(std::chrono::milliseconds(50))));
+  EXPECT_CALL(encoder.stream_, resetStream(Http::StreamResetReason::LocalReset));
+  response_timeout_->invokeCallback();
+}
+
+// Verify that latency aware load balancers are told how long a host took before it reset its
+// stream.
+TEST_F(RouterTest, UpstreamResetReportedToLoadBalancer) {
+  cm_.thread_local_cluster_.cluster_.info_->lb_type_ = Upstream::LoadBalancerType::PeakEwma;
+  NiceMock<Http::MockRequestEncoder> encoder;
+  EXPECT_CALL(cm_.conn_pool_, newStream(_, _))
+      .WillOnce(Invoke(
+          [&](Http::ResponseDecoder&,
+              Http::ConnectionPool::Callbacks& callbacks) -> Http::ConnectionPool::Cancellable* {
+            callbacks.onPoolReady(encoder, cm_.conn_pool_.host_, upstream_stream_info_);
+            return nullptr;
+          }));
+  expectResponseTimerCreate();
+
+  Http::TestRequestHeaderMapImpl headers{};
+  HttpTestUtility::addDefaultHeaders(headers);
+  router_.decodeHeaders(headers, true);
+
+  test_time_.advanceTimeWait(std::chrono::milliseconds(20));
+  EXPECT_CALL(cm_.thread_local_cluster_.lb_,
+              onHostResponseTime(Ref(*cm_.conn_pool_.host_),
+                                 std::chrono::nanoseconds(std::chrono::milliseconds(20))));
+  encoder.stream_.resetStream(Http::StreamResetReason::RemoteReset);
+}
+
 // Verify that upstream timing information is set into the StreamInfo when a
 // retry occurs (and not before).
 TEST_F(RouterTest, UpstreamTimingRetry) {
@@ -75,6 +75,59 @@ TEST_F(AllocatorImplTest, GaugesWithSameName) {
   EXPECT_EQ(0, g2->value());
 }
 
+// Only the stats written since the previous call are reported, and every counter is latched.
+TEST_F(AllocatorImplTest, ForEachChangedStat) {
+  CounterSharedPtr c1 = alloc_.makeCounter(makeStat("c1"), StatName(), {});
+  CounterSharedPtr c2 = alloc_.makeCounter(makeStat("c2"), StatName(), {});
+  GaugeSharedPtr g1 =
+      alloc_.makeGauge(makeStat("g1"), StatName(), {}, Gauge::ImportMode::Accumulate);
+  GaugeSharedPtr g2 =
+      alloc_.makeGauge(makeStat("g2"), StatName(), {}, Gauge::ImportMode::Accumulate);
+  GaugeSharedPtr g3 =
+      alloc_.makeGauge(makeStat("g3"), StatName(), {}, Gauge::ImportMode::Uninitialized);
+  TextReadoutSharedPtr t1 = alloc_.makeTextReadout(makeStat("t1"), StatName(), {});
+  TextReadoutSharedPtr t2 = alloc_.makeTextReadout(makeStat("t2"), StatName(), {});
+
+  std::vector<std::pair<std::string, uint64_t>> counters;
+  std::vector<std::string> gauges;
+  std::vector<std::string> text_readouts;
+  auto collect = [&]() {
+    counters.clear();
+    gauges.clear();
+    text_readouts.clear();
+    alloc_.forEachChangedStat(
+        [&](Counter& counter, uint64_t delta) { counters.emplace_back(counter.name(), delta); },
+        [&](Gauge& gauge) { gauges.push_back(gauge.name()); },
+        [&](TextReadout& text_readout) { text_readouts.push_back(text_readout.name()); });
+  };
+
+  c1->add(5);
+  g1->set(3);
+  g3->set(1);
+  t2->set("hello");
+  collect();
+  EXPECT_EQ((std::vector<std::pair<std::string, uint64_t>>{{"c1", 5}}), counters);
+  EXPECT_EQ(std::vector<std::string>{"g1"}, gauges);
+  EXPECT_EQ(std::vector<std::string>{"t2"}, text_readouts);
+  EXPECT_EQ(0, c1->latch());
+
+  collect();
+  EXPECT_TRUE(counters.empty());
+  EXPECT_TRUE(gauges.empty());
+  EXPECT_TRUE(text_readouts.empty());
+
+  // A gauge set to its current value is still reported, as is a decrement.
+  c2->inc();
+  g1->set(3);
+  g2->inc();
+  collect();
+  EXPECT_EQ((std::vector<std::pair<std::string, uint64_t>>{{"c2", 1}}), counters);
+  EXPECT_EQ(2, gauges.size());
+  g2->dec();
+  collect();
+  EXPECT_EQ(std::vector<std::string>{"g2"}, gauges);
+}
+
 // Test for a race-condition where we may decrement the ref-count of a stat to
 // zero at the same time as we are allocating another instance of that
 // stat. This test reproduces that race organically by having a 12 threads each
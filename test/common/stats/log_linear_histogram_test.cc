@@ -0,0 +1,138 @@
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <thread>
+
+#include "common/stats/log_linear_histogram.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Stats {
+namespace {
+
+TEST(LogLinearHistogramTest, Buckets) {
+  // Small values are exact.
+  for (uint64_t value = 0; value < 32; ++value) {
+    EXPECT_EQ(value, LogLinearHistogram::bucketLowerBound(value));
+    EXPECT_EQ(1, LogLinearHistogram::bucketWidth(value));
+  }
+  EXPECT_EQ(32, LogLinearHistogram::bucketLowerBound(33));
+  EXPECT_EQ(2, LogLinearHistogram::bucketWidth(33));
+  EXPECT_EQ(992, LogLinearHistogram::bucketLowerBound(1000));
+  EXPECT_EQ(960, LogLinearHistogram::bucketLowerBound(991));
+  EXPECT_EQ(32, LogLinearHistogram::bucketWidth(1000));
+  EXPECT_EQ(uint64_t(31) << 59, LogLinearHistogram::bucketLowerBound(UINT64_MAX));
+  EXPECT_EQ(uint64_t(1) << 59, LogLinearHistogram::bucketWidth(UINT64_MAX));
+
+  // Buckets are at most 1/16 of their values wide.
+  for (uint64_t value = 1; value < (uint64_t(1) << 62); value = value * 3 + 1) {
+    const uint64_t lower_bound = LogLinearHistogram::bucketLowerBound(value);
+    EXPECT_LE(lower_bound, value);
+    EXPECT_LT(value - lower_bound, LogLinearHistogram::bucketWidth(value));
+    EXPECT_LE(LogLinearHistogram::bucketWidth(value) * LogLinearHistogram::SubBuckets,
+              std::max<uint64_t>(value, LogLinearHistogram::SubBuckets));
+  }
+}
+
+TEST(LogLinearHistogramTest, Empty) {
+  LogLinearHistogram histogram;
+  EXPECT_EQ(0, histogram.sampleCount());
+  EXPECT_EQ(0, histogram.sampleSum());
+  EXPECT_EQ(0, histogram.approxCountBelow(100));
+  EXPECT_EQ(0, histogram.allocatedBytes());
+
+  std::vector<double> computed;
+  histogram.computeQuantiles({0, 0.5, 1}, computed);
+  ASSERT_EQ(3, computed.size());
+  for (const double quantile : computed) {
+    EXPECT_TRUE(std::isnan(quantile));
+  }
+}
+
+TEST(LogLinearHistogramTest, Quantiles) {
+  LogLinearHistogram histogram;
+  for (uint64_t value = 1; value <= 100; ++value) {
+    histogram.recordValue(value);
+  }
+  EXPECT_EQ(100, histogram.sampleCount());
+  EXPECT_EQ(5050, histogram.sampleSum());
+
+  std::vector<double> computed;
+  histogram.computeQuantiles({0, 0.25, 0.5, 0.9, 1}, computed);
+  EXPECT_DOUBLE_EQ(1, computed[0]);
+  EXPECT_NEAR(25, computed[1], 1);
+  EXPECT_NEAR(50, computed[2], 2);
+  EXPECT_NEAR(90, computed[3], 4);
+  // The upper bound of the bucket of 100, which is [96, 104).
+  EXPECT_DOUBLE_EQ(104, computed[4]);
+
+  EXPECT_EQ(0, histogram.approxCountBelow(1));
+  EXPECT_EQ(9, histogram.approxCountBelow(10));
+  EXPECT_NEAR(50, histogram.approxCountBelow(51), 1);
+  EXPECT_EQ(100, histogram.approxCountBelow(1000));
+}
+
+TEST(LogLinearHistogramTest, SparsePages) {
+  LogLinearHistogram histogram;
+  histogram.recordValue(5);
+  histogram.recordValue(100000);
+  histogram.recordValue(100001);
+  EXPECT_EQ(2 * LogLinearHistogram::SubBuckets * sizeof(uint64_t), histogram.allocatedBytes());
+  EXPECT_EQ(1, histogram.approxCountBelow(1000));
+  EXPECT_EQ(3, histogram.sampleCount());
+
+  histogram.clear();
+  EXPECT_EQ(0, histogram.sampleCount());
+  EXPECT_EQ(0, histogram.sampleSum());
+  EXPECT_EQ(2 * LogLinearHistogram::SubBuckets * sizeof(uint64_t), histogram.allocatedBytes());
+}
+
+TEST(LogLinearHistogramTest, MoveAndAdd) {
+  LogLinearHistogram source;
+  LogLinearHistogram interval;
+  LogLinearHistogram cumulative;
+  source.recordValue(10);
+  source.recordValue(20);
+  source.moveTo(interval);
+  EXPECT_EQ(0, source.sampleCount());
+  EXPECT_EQ(0, source.sampleSum());
+  EXPECT_EQ(2, interval.sampleCount());
+  EXPECT_EQ(30, interval.sampleSum());
+  cumulative.add(interval);
+
+  interval.clear();
+  source.recordValue(30);
+  source.moveTo(interval);
+  cumulative.add(interval);
+  EXPECT_EQ(1, interval.sampleCount());
+  EXPECT_EQ(3, cumulative.sampleCount());
+  EXPECT_EQ(60, cumulative.sampleSum());
+  EXPECT_EQ(2, cumulative.approxCountBelow(25));
+}
+
+// Values recorded while another thread moves the counts out are never lost.
+TEST(LogLinearHistogramTest, ConcurrentMove) {
+  constexpr uint64_t num_values = 1000000;
+  LogLinearHistogram source;
+  LogLinearHistogram target;
+  std::atomic<bool> done{false};
+  std::thread recorder([&source, &done]() {
+    for (uint64_t i = 0; i < num_values; ++i) {
+      source.recordValue(i % 5000);
+    }
+    done = true;
+  });
+  while (!done) {
+    source.moveTo(target);
+  }
+  recorder.join();
+  source.moveTo(target);
+
+  EXPECT_EQ(num_values, target.sampleCount());
+  EXPECT_EQ(0, source.sampleCount());
+}
+
+} // namespace
+} // namespace Stats
+} // namespace Envoy
@@ -0,0 +1,112 @@
+// Note: this should be run with --compilation_mode=opt, and would benefit from a
+// quiescent system with disabled cstate power management.
+//
+// BM_Increment compares the cost of incrementing counters kept in process memory and counters
+// placed in a shared memory stats file. BM_IncrementWhileScraping increments counters placed in
+// the file while another thread scrapes it continuously, as an external exporter would: the
+// increments take no lock and wait for nothing, so they should cost the same as in BM_Increment.
+// BM_Scrape is the cost of one scrape, which is paid by the exporter rather than by Envoy.
+
+#include <atomic>
+
+#include "common/stats/allocator_impl.h"
+#include "common/stats/shared_memory_stats.h"
+#include "common/stats/symbol_table_creator.h"
+
+#include "test/test_common/environment.h"
+#include "test/test_common/thread_factory_for_test.h"
+
+#include "absl/strings/str_cat.h"
+#include "benchmark/benchmark.h"
+
+namespace Envoy {
+namespace Stats {
+
+class SharedMemoryStatsSpeedTest {
+public:
+  static constexpr uint32_t NumStats = 10000;
+
+  explicit SharedMemoryStatsSpeedTest(bool shared_memory)
+      : symbol_table_(SymbolTableCreator::makeSymbolTable()), pool_(*symbol_table_),
+        path_(TestEnvironment::temporaryPath("shared_memory_stats_speed_test")),
+        region_(shared_memory ? std::make_unique<SharedMemoryStatsRegion>(path_, NumStats)
+                              : nullptr),
+        alloc_(*symbol_table_, region_.get()) {
+    for (uint32_t i = 0; i < NumStats; ++i) {
+      counters_.push_back(alloc_.makeCounter(
+          pool_.add(absl::StrCat("cluster.cluster_", i / 100, ".upstream_rq_", i % 100)),
+          StatName(), {}));
+    }
+  }
+
+  void incrementAll() {
+    for (const CounterSharedPtr& counter : counters_) {
+      counter->inc();
+    }
+  }
+
+  // Reads every stat of the file once, returning the sum of their values.
+  uint64_t scrape(const SharedMemoryStatsReader& reader) {
+    uint64_t sum = 0;
+    reader.forEachStat([&sum](absl::string_view, SharedMemoryStatsEntry::Type, uint64_t value) {
+      sum += value;
+    });
+    return sum;
+  }
+
+  const std::string& path() const { return path_; }
+
+private:
+  SymbolTablePtr symbol_table_;
+  StatNamePool pool_;
+  const std::string path_;
+  SharedMemoryStatsRegionPtr region_;
+  AllocatorImpl alloc_;
+  std::vector<CounterSharedPtr> counters_;
+};
+
+// Increments NumStats counters, in process memory if state.range(0) is 0 and in a shared memory
+// stats file otherwise.
+static void BM_Increment(benchmark::State& state) {
+  SharedMemoryStatsSpeedTest context(state.range(0) != 0);
+  for (auto _ : state) {
+    context.incrementAll();
+  }
+  state.SetItemsProcessed(state.iterations() * SharedMemoryStatsSpeedTest::NumStats);
+}
+BENCHMARK(BM_Increment)->Arg(0)->Arg(1);
+
+static void BM_IncrementWhileScraping(benchmark::State& state) {
+  SharedMemoryStatsSpeedTest context(true);
+  SharedMemoryStatsReader reader(context.path());
+  std::atomic<bool> done{false};
+  std::atomic<uint64_t> num_scrapes{0};
+  Thread::ThreadPtr scraper = Thread::threadFactoryForTest().createThread([&]() {
+    while (!done) {
+      benchmark::DoNotOptimize(context.scrape(reader));
+      ++num_scrapes;
+    }
+  });
+
+  for (auto _ : state) {
+    context.incrementAll();
+  }
+  done = true;
+  scraper->join();
+  state.SetItemsProcessed(state.iterations() * SharedMemoryStatsSpeedTest::NumStats);
+  state.counters["scrapes"] = num_scrapes.load();
+}
+BENCHMARK(BM_IncrementWhileScraping);
+
+static void BM_Scrape(benchmark::State& state) {
+  SharedMemoryStatsSpeedTest context(true);
+  SharedMemoryStatsReader reader(context.path());
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(context.scrape(reader));
+  }
+  state.SetItemsProcessed(state.iterations() * SharedMemoryStatsSpeedTest::NumStats);
+}
+BENCHMARK(BM_Scrape);
+
+} // namespace Stats
+} // namespace Envoy
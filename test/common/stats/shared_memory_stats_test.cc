@@ -0,0 +1,209 @@
+#include <map>
+#include <string>
+
+#include "common/stats/allocator_impl.h"
+#include "common/stats/shared_memory_stats.h"
+#include "common/stats/symbol_table_creator.h"
+
+#include "test/test_common/environment.h"
+#include "test/test_common/utility.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Stats {
+namespace {
+
+using Type = SharedMemoryStatsEntry::Type;
+
+class SharedMemoryStatsTest : public testing::Test {
+protected:
+  SharedMemoryStatsTest() : path_(TestEnvironment::temporaryPath("shared_memory_stats")) {}
+
+  // Reads all the stats of the file at path_, by name.
+  std::map<std::string, std::pair<Type, uint64_t>> readStats() {
+    SharedMemoryStatsReader reader(path_);
+    std::map<std::string, std::pair<Type, uint64_t>> stats;
+    reader.forEachStat([&stats](absl::string_view name, Type type, uint64_t value) {
+      EXPECT_TRUE(stats.emplace(std::string(name), std::make_pair(type, value)).second);
+    });
+    return stats;
+  }
+
+  const std::string path_;
+};
+
+TEST_F(SharedMemoryStatsTest, AllocateAndRead) {
+  SharedMemoryStatsRegion region(path_, 4);
+  const absl::optional<uint32_t> counter =
+      region.allocate("cluster.foo.upstream_rq", Type::Counter);
+  const absl::optional<uint32_t> gauge = region.allocate("server.live", Type::Gauge);
+  ASSERT_TRUE(counter.has_value());
+  ASSERT_TRUE(gauge.has_value());
+  region.value(*counter) += 5;
+  region.value(*gauge) = 1;
+
+  const std::map<std::string, std::pair<Type, uint64_t>> expected = {
+      {"cluster.foo.upstream_rq", {Type::Counter, 5}}, {"server.live", {Type::Gauge, 1}}};
+  EXPECT_EQ(expected, readStats());
+
+  SharedMemoryStatsReader reader(path_);
+  EXPECT_NE(0, reader.pid());
+  EXPECT_EQ(0, reader.numOverflowed());
+  EXPECT_EQ(SharedMemoryStatsRegion::fileSize(4),
+            TestEnvironment::readFileToStringForTest(path_).size());
+}
+
+// Slots of freed stats are reused, and the stats which don't fit are counted.
+TEST_F(SharedMemoryStatsTest, FreeAndOverflow) {
+  SharedMemoryStatsRegion region(path_, 2);
+  const absl::optional<uint32_t> a = region.allocate("a", Type::Counter);
+  const absl::optional<uint32_t> b = region.allocate("b", Type::Counter);
+  ASSERT_TRUE(a.has_value());
+  ASSERT_TRUE(b.has_value());
+  region.value(*a) = 1;
+  EXPECT_FALSE(region.allocate("c", Type::Counter).has_value());
+  EXPECT_FALSE(
+      region.allocate(std::string(SharedMemoryStatsEntry::MaxNameLength + 1, 'x'), Type::Gauge)
+          .has_value());
+
+  region.free(*a);
+  const absl::optional<uint32_t> c = region.allocate("c", Type::Gauge);
+  EXPECT_EQ(a, c);
+  EXPECT_EQ(0, region.value(*c));
+  const absl::optional<uint32_t> long_name =
+      region.allocate(std::string(SharedMemoryStatsEntry::MaxNameLength, 'x'), Type::Gauge);
+  EXPECT_FALSE(long_name.has_value());
+  region.free(*b);
+  EXPECT_TRUE(
+      region.allocate(std::string(SharedMemoryStatsEntry::MaxNameLength, 'x'), Type::Gauge)
+          .has_value());
+
+  const std::map<std::string, std::pair<Type, uint64_t>> expected = {
+      {"c", {Type::Gauge, 0}},
+      {std::string(SharedMemoryStatsEntry::MaxNameLength, 'x'), {Type::Gauge, 0}}};
+  EXPECT_EQ(expected, readStats());
+  EXPECT_EQ(3, SharedMemoryStatsReader(path_).numOverflowed());
+}
+
+TEST_F(SharedMemoryStatsTest, RemovedOnDestruction) {
+  { SharedMemoryStatsRegion region(path_, 1); }
+  EXPECT_THROW_WITH_REGEX(SharedMemoryStatsReader reader(path_), EnvoyException,
+                          "unable to open shared memory stats file");
+}
+
+// The file of a hot restart child replaces the one of its parent, which keeps updating its own
+// mapping and doesn't remove the file of the child when it exits.
+TEST_F(SharedMemoryStatsTest, ReplacedByAnotherRegion) {
+  auto parent = std::make_unique<SharedMemoryStatsRegion>(path_, 2);
+  const absl::optional<uint32_t> parent_slot = parent->allocate("parent", Type::Counter);
+  ASSERT_TRUE(parent_slot.has_value());
+  SharedMemoryStatsReader parent_reader(path_);
+
+  SharedMemoryStatsRegion child(path_, 4);
+  const absl::optional<uint32_t> child_slot = child.allocate("child", Type::Gauge);
+  ASSERT_TRUE(child_slot.has_value());
+  child.value(*child_slot) = 2;
+
+  // The parent's mapping was not truncated, and can still be updated and read.
+  parent->value(*parent_slot) += 3;
+  std::map<std::string, uint64_t> parent_stats;
+  parent_reader.forEachStat([&parent_stats](absl::string_view name, Type, uint64_t value) {
+    parent_stats.emplace(std::string(name), value);
+  });
+  EXPECT_EQ((std::map<std::string, uint64_t>{{"parent", 3}}), parent_stats);
+
+  parent.reset();
+  const std::map<std::string, std::pair<Type, uint64_t>> expected = {{"child", {Type::Gauge, 2}}};
+  EXPECT_EQ(expected, readStats());
+  EXPECT_EQ(SharedMemoryStatsRegion::fileSize(4),
+            TestEnvironment::readFileToStringForTest(path_).size());
+}
+
+TEST_F(SharedMemoryStatsTest, NotAStatsFile) {
+  TestEnvironment::writeStringToFileForTest(path_, "short", true);
+  EXPECT_THROW_WITH_REGEX(SharedMemoryStatsReader reader(path_), EnvoyException,
+                          "is not a shared memory stats file");
+  TestEnvironment::writeStringToFileForTest(path_, std::string(1024, 'x'), true);
+  EXPECT_THROW_WITH_REGEX(SharedMemoryStatsReader reader(path_), EnvoyException,
+                          "is not a version 1 shared memory stats file");
+}
+
+TEST_F(SharedMemoryStatsTest, Allocator) {
+  SymbolTablePtr symbol_table = SymbolTableCreator::makeSymbolTable();
+  StatNamePool pool(*symbol_table);
+  SharedMemoryStatsRegion region(path_, 3);
+  AllocatorImpl alloc(*symbol_table, &region);
+
+  CounterSharedPtr counter = alloc.makeCounter(pool.add("counter"), StatName(), {});
+  GaugeSharedPtr gauge =
+      alloc.makeGauge(pool.add("gauge"), StatName(), {}, Gauge::ImportMode::Accumulate);
+  CounterSharedPtr temporary = alloc.makeCounter(pool.add("temporary"), StatName(), {});
+  // There is no room left, so this counter is only kept in process memory.
+  CounterSharedPtr unexported = alloc.makeCounter(pool.add("unexported"), StatName(), {});
+  counter->add(3);
+  temporary->inc();
+  unexported->add(7);
+  EXPECT_EQ(7, unexported->value());
+  gauge->add(10);
+  gauge->sub(4);
+  gauge->setParentValue(5);
+  EXPECT_EQ(11, gauge->value());
+  std::map<std::string, std::pair<Type, uint64_t>> expected = {{"counter", {Type::Counter, 3}},
+                                                               {"gauge", {Type::Gauge, 11}},
+                                                               {"temporary", {Type::Counter, 1}}};
+  EXPECT_EQ(expected, readStats());
+
+  // Lowering the parent value lowers the exported sum, and set() leaves the parent value in it.
+  gauge->setParentValue(2);
+  EXPECT_EQ(8, gauge->value());
+  gauge->set(1);
+  EXPECT_EQ(3, gauge->value());
+  gauge->mergeImportMode(Gauge::ImportMode::Accumulate);
+  EXPECT_EQ(3, gauge->value());
+
+  uint64_t num_changed_gauges = 0;
+  alloc.forEachChangedStat([](Counter&, uint64_t) {}, [&](Gauge&) { ++num_changed_gauges; },
+                           [](TextReadout&) {});
+  EXPECT_EQ(1, num_changed_gauges);
+
+  // The slot of a destroyed stat is released.
+  temporary.reset();
+  counter->reset();
+  expected = {{"counter", {Type::Counter, 0}}, {"gauge", {Type::Gauge, 3}}};
+  EXPECT_EQ(expected, readStats());
+  CounterSharedPtr another = alloc.makeCounter(pool.add("another"), StatName(), {});
+  another->inc();
+  expected.emplace("another", std::make_pair(Type::Counter, 1));
+  EXPECT_EQ(expected, readStats());
+  EXPECT_EQ(1, SharedMemoryStatsReader(path_).numOverflowed());
+
+  counter.reset();
+  gauge.reset();
+  unexported.reset();
+  another.reset();
+  EXPECT_TRUE(readStats().empty());
+}
+
+// A gauge which turns out to never be imported drops the value of the hot restart parent.
+TEST_F(SharedMemoryStatsTest, GaugeNeverImport) {
+  SymbolTablePtr symbol_table = SymbolTableCreator::makeSymbolTable();
+  StatNamePool pool(*symbol_table);
+  SharedMemoryStatsRegion region(path_, 1);
+  AllocatorImpl alloc(*symbol_table, &region);
+
+  GaugeSharedPtr gauge =
+      alloc.makeGauge(pool.add("gauge"), StatName(), {}, Gauge::ImportMode::Uninitialized);
+  gauge->setParentValue(5);
+  gauge->add(1);
+  EXPECT_EQ(6, gauge->value());
+  gauge->mergeImportMode(Gauge::ImportMode::NeverImport);
+  EXPECT_EQ(1, gauge->value());
+  EXPECT_EQ(Gauge::ImportMode::NeverImport, gauge->importMode());
+  const std::map<std::string, std::pair<Type, uint64_t>> expected = {{"gauge", {Type::Gauge, 1}}};
+  EXPECT_EQ(expected, readStats());
+}
+
+} // namespace
+} // namespace Stats
+} // namespace Envoy
@@ -1,3 +1,4 @@
+#include <atomic>
 #include <string>
 
 #include "common/common/macros.h"
@@ -266,7 +267,7 @@ TEST_P(StatNameTest, TestSuccessfulDecode) {
 class StatNameDeathTest : public StatNameTest {
 public:
   void decodeSymbolVec(const SymbolVec& symbol_vec) {
-    Thread::LockGuard lock(real_symbol_table_->lock_);
+    absl::ReaderMutexLock lock(&real_symbol_table_->decode_lock_);
     for (Symbol symbol : symbol_vec) {
       real_symbol_table_->fromSymbol(symbol);
     }
@@ -669,6 +670,70 @@ TEST_P(StatNameTest, MutexContentionOnExistingSymbols) {
   }
 }
 
+// Validates that symbols stay consistent when many threads concurrently encode and free names
+// with overlapping tokens, so that references are added to and dropped from the same symbols
+// under shared shard locks while other threads erase and recycle them.
+TEST_P(StatNameTest, RacingSymbolEncodeAndFree) {
+  if (GetParam() == SymbolTableType::Fake) {
+    return;
+  }
+
+  Thread::ThreadFactory& thread_factory = Thread::threadFactoryForTest();
+  constexpr int num_threads = 16;
+  constexpr int num_iterations = 1000;
+  constexpr int num_tokens = 10;
+  std::vector<Thread::ThreadPtr> threads;
+  threads.reserve(num_threads);
+  ConditionalInitializer start, finish;
+  absl::BlockingCounter encodes(num_threads);
+  std::atomic<uint32_t> mismatches{0};
+  for (int i = 0; i < num_threads; ++i) {
+    threads.push_back(
+        thread_factory.createThread([this, i, &start, &finish, &encodes, &mismatches]() {
+          // Each thread holds a name throughout, whose symbols must survive the other threads
+          // dropping their references to the same tokens.
+          const std::string held_name = absl::StrCat("shared.held", i % 2);
+          StatNameManagedStorage held(held_name, *table_);
+
+          start.wait();
+          for (int j = 0; j < num_iterations; ++j) {
+            // The shared tokens are referenced by many threads at once, while the last token is
+            // only used by this thread, so its symbol is erased and recycled on every iteration.
+            const std::string name =
+                absl::StrCat("shared.token", (i + j) % num_tokens, ".thread", i, "_", j % 4);
+            StatNameManagedStorage storage(name, *table_);
+            if (table_->toString(storage.statName()) != name) {
+              ++mismatches;
+            }
+          }
+          if (table_->toString(held.statName()) != held_name) {
+            ++mismatches;
+          }
+          encodes.DecrementCount();
+
+          finish.wait();
+        }));
+  }
+  start.setReady();
+  encodes.Wait();
+
+  EXPECT_EQ(0, mismatches.load());
+  // Only the symbols of the held names remain: "shared", "held0" and "held1".
+  EXPECT_EQ(3, table_->numSymbols());
+
+  finish.setReady();
+  for (auto& thread : threads) {
+    thread->join();
+  }
+  EXPECT_EQ(0, table_->numSymbols());
+
+  // Erased symbols are reused, so the number of symbols ever allocated is bounded by the number
+  // that can coexist: the 3 held symbols, the shared tokens and one token per thread, plus the
+  // staged next symbol and up to one symbol per thread that is erased but not yet in the pool.
+  const Symbol max_symbols = 3 + num_tokens + 2 * num_threads + 1;
+  EXPECT_LE(monotonicCounter(), max_symbols);
+}
+
 TEST_P(StatNameTest, SharedStatNameStorageSetInsertAndFind) {
   StatNameStorageSet set;
   const int iters = 10;
@@ -12,6 +12,7 @@
 #include "test/common/stats/make_elements_helper.h"
 #include "test/test_common/utility.h"
 
+#include "absl/strings/str_cat.h"
 #include "absl/synchronization/blocking_counter.h"
 #include "benchmark/benchmark.h"
 
@@ -58,6 +59,40 @@ static void BM_CreateRace(benchmark::State& state) {
 }
 BENCHMARK(BM_CreateRace);
 
+// Measures the contention between threads encoding names whose tokens already have symbols, as
+// stats created from dynamic names at request time do. The names are spread over state.range(0)
+// distinct tokens, sharing a common prefix.
+static Envoy::Stats::SymbolTableImpl* contention_table;
+static Envoy::Stats::StatNamePool* contention_pool;
+
+// NOLINTNEXTLINE(readability-identifier-naming)
+static void BM_EncodeContention(benchmark::State& state) {
+  std::vector<std::string> names;
+  for (int64_t i = 0; i < state.range(0); ++i) {
+    names.push_back(absl::StrCat("cluster.grpc.service_", i, ".method_", i, ".success"));
+  }
+  if (state.thread_index == 0) {
+    contention_table = new Envoy::Stats::SymbolTableImpl;
+    contention_pool = new Envoy::Stats::StatNamePool(*contention_table);
+    for (const std::string& name : names) {
+      contention_pool->add(name);
+    }
+  }
+
+  uint64_t index = state.thread_index;
+  for (auto _ : state) {
+    Envoy::Stats::StatNameStorage storage(names[index++ % names.size()], *contention_table);
+    storage.free(*contention_table);
+  }
+  state.SetItemsProcessed(state.iterations());
+
+  if (state.thread_index == 0) {
+    delete contention_pool;
+    delete contention_table;
+  }
+}
+BENCHMARK(BM_EncodeContention)->Arg(1)->Arg(100)->ThreadRange(1, 16)->UseRealTime();
+
 // NOLINTNEXTLINE(readability-identifier-naming)
 static void BM_JoinStatNames(benchmark::State& state) {
   Envoy::Stats::SymbolTableImpl symbol_table;
@@ -8,6 +8,7 @@
 #include "common/event/dispatcher_impl.h"
 #include "common/stats/allocator_impl.h"
 #include "common/stats/fake_symbol_table_impl.h"
+#include "common/stats/histogram_impl.h"
 #include "common/stats/tag_producer_impl.h"
 #include "common/stats/thread_local_store.h"
 #include "common/thread_local/thread_local_impl.h"
@@ -53,6 +54,55 @@ public:
     }
   }
 
+  std::vector<Stats::Counter*> accessCountersAndGauges(std::vector<Stats::Gauge*>& gauges) {
+    std::vector<Stats::Counter*> counters;
+    for (auto& stat_name_storage : stat_names_) {
+      counters.push_back(&store_.counterFromStatName(stat_name_storage->statName()));
+      gauges.push_back(&store_.gaugeFromStatName(stat_name_storage->statName(),
+                                                 Stats::Gauge::ImportMode::Accumulate));
+    }
+    return counters;
+  }
+
+  // Collects the stats the way a stats flush does, returning the number of stats collected.
+  uint64_t collectStats(bool changed_only) {
+    uint64_t num_stats = 0;
+    if (changed_only) {
+      store_.forEachChangedStat([&num_stats](Stats::Counter&, uint64_t) { ++num_stats; },
+                                [&num_stats](Stats::Gauge&) { ++num_stats; },
+                                [&num_stats](Stats::TextReadout&) { ++num_stats; });
+      return num_stats;
+    }
+    for (const Stats::CounterSharedPtr& counter : store_.counters()) {
+      num_stats += counter->latch() != 0 ? 1 : 0;
+    }
+    num_stats += store_.gauges().size();
+    num_stats += store_.textReadouts().size();
+    return num_stats;
+  }
+
+  void setHistogramEngine(envoy::config::metrics::v3::StatsConfig::HistogramEngine engine) {
+    stats_config_.set_histogram_engine(engine);
+    store_.setHistogramSettings(std::make_unique<Stats::HistogramSettingsImpl>(stats_config_));
+  }
+
+  std::vector<Stats::Histogram*> accessHistograms(uint32_t num_histograms) {
+    std::vector<Stats::Histogram*> histograms;
+    for (uint32_t i = 0; i < num_histograms && i < stat_names_.size(); ++i) {
+      histograms.push_back(&store_.histogramFromStatName(stat_names_[i]->statName(),
+                                                         Stats::Histogram::Unit::Milliseconds));
+    }
+    return histograms;
+  }
+
+  void mergeHistograms() {
+    bool merged = false;
+    store_.mergeHistograms([&merged]() { merged = true; });
+    while (!merged) {
+      dispatcher_->run(Event::Dispatcher::RunType::NonBlock);
+    }
+  }
+
   void initThreading() {
     if (!Envoy::Event::Libevent::Global::initialized()) {
       Envoy::Event::Libevent::Global::initialize();
@@ -101,5 +151,80 @@ static void BM_StatsWithTls(benchmark::State& state) {
 }
 BENCHMARK(BM_StatsWithTls);
 
+// Tests the cost of collecting the stats for a flush, either all of them or only those written
+// since the previous flush, when 1 in state.range(1) of the counters and gauges is written between
+// flushes.
+static void BM_StatsFlushCollect(benchmark::State& state) {
+  Envoy::ThreadLocalStorePerf context;
+  context.initThreading();
+  std::vector<Envoy::Stats::Gauge*> gauges;
+  std::vector<Envoy::Stats::Counter*> counters = context.accessCountersAndGauges(gauges);
+  const bool changed_only = state.range(0) != 0;
+  context.collectStats(changed_only);
+
+  uint64_t num_stats = 0;
+  for (auto _ : state) {
+    state.PauseTiming();
+    for (size_t i = 0; i < counters.size(); i += state.range(1)) {
+      counters[i]->inc();
+      gauges[i]->inc();
+    }
+    state.ResumeTiming();
+    num_stats += context.collectStats(changed_only);
+  }
+  state.counters["stats_per_flush"] = static_cast<double>(num_stats) / state.iterations();
+}
+BENCHMARK(BM_StatsFlushCollect)->Args({0, 20})->Args({1, 20})->Args({0, 1})->Args({1, 1});
+
+// Tests the cost of recording a value into a histogram with each histogram engine.
+static void BM_HistogramRecord(benchmark::State& state) {
+  Envoy::ThreadLocalStorePerf context;
+  context.initThreading();
+  context.setHistogramEngine(
+      static_cast<envoy::config::metrics::v3::StatsConfig::HistogramEngine>(state.range(0)));
+  std::vector<Envoy::Stats::Histogram*> histograms = context.accessHistograms(1000);
+
+  uint64_t value = 0;
+  for (auto _ : state) {
+    for (Envoy::Stats::Histogram* histogram : histograms) {
+      // Spread the values over a typical range of latencies in milliseconds.
+      histogram->recordValue(value++ % 5000);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * histograms.size());
+}
+BENCHMARK(BM_HistogramRecord)
+    ->Arg(envoy::config::metrics::v3::StatsConfig::CIRCLLHIST)
+    ->Arg(envoy::config::metrics::v3::StatsConfig::LOG_LINEAR);
+
+// Tests the cost of merging histograms at a stats flush with each histogram engine, after
+// recording state.range(1) values into each histogram.
+static void BM_HistogramMerge(benchmark::State& state) {
+  Envoy::ThreadLocalStorePerf context;
+  context.initThreading();
+  context.setHistogramEngine(
+      static_cast<envoy::config::metrics::v3::StatsConfig::HistogramEngine>(state.range(0)));
+  std::vector<Envoy::Stats::Histogram*> histograms = context.accessHistograms(10000);
+
+  uint64_t value = 0;
+  for (auto _ : state) {
+    state.PauseTiming();
+    for (Envoy::Stats::Histogram* histogram : histograms) {
+      for (int64_t i = 0; i < state.range(1); ++i) {
+        histogram->recordValue(value++ % 5000);
+      }
+    }
+    state.ResumeTiming();
+    context.mergeHistograms();
+  }
+  state.SetItemsProcessed(state.iterations() * histograms.size());
+}
+BENCHMARK(BM_HistogramMerge)
+    ->Args({envoy::config::metrics::v3::StatsConfig::CIRCLLHIST, 1})
+    ->Args({envoy::config::metrics::v3::StatsConfig::CIRCLLHIST, 100})
+    ->Args({envoy::config::metrics::v3::StatsConfig::LOG_LINEAR, 1})
+    ->Args({envoy::config::metrics::v3::StatsConfig::LOG_LINEAR, 100})
+    ->Unit(benchmark::kMillisecond);
+
 // TODO(jmarantz): add multi-threaded variant of this test, that aggressively
 // looks up stats in multiple threads to try to trigger contention issues.
@@ -15,6 +15,7 @@
 #include "common/thread_local/thread_local_impl.h"
 
 #include "test/common/stats/stat_test_utility.h"
+#include "test/mocks/common.h"
 #include "test/mocks/event/mocks.h"
 #include "test/mocks/server/instance.h"
 #include "test/mocks/stats/mocks.h"
@@ -335,6 +336,51 @@ TEST_F(StatsThreadLocalStoreTest, Tls) {
   EXPECT_EQ(2L, store_->textReadouts().front().use_count());
 }
 
+TEST_F(StatsThreadLocalStoreTest, CacheProfile) {
+  store_->initializeThreading(main_thread_dispatcher_, tls_);
+
+  // Lookups which miss the TLS cache are counted even while profiling is disabled.
+  store_->counterFromString("c1");
+  store_->counterFromString("c1");
+  CacheProfile profile = store_->cacheProfile();
+  EXPECT_FALSE(profile.enabled_);
+  EXPECT_EQ(0, profile.central_lock_acquisitions_);
+  ASSERT_EQ(1, profile.thread_caches_.size());
+  EXPECT_EQ("test_thread", profile.thread_caches_[0].thread_name_);
+  EXPECT_EQ(1, profile.thread_caches_[0].misses_);
+  EXPECT_EQ(0, profile.thread_caches_[0].warmed_);
+
+  // Enabling profiling resets the profile, and measures how long each miss holds the central
+  // cache lock.
+  NiceMock<MockTimeSystem> time_system;
+  store_->setCacheProfiling(&time_system);
+  EXPECT_CALL(time_system, monotonicTime())
+      .WillOnce(Return(MonotonicTime(std::chrono::microseconds(10))))
+      .WillOnce(Return(MonotonicTime(std::chrono::microseconds(13))))
+      .WillOnce(Return(MonotonicTime(std::chrono::microseconds(20))))
+      .WillOnce(Return(MonotonicTime(std::chrono::microseconds(21))));
+  store_->gaugeFromString("g1", Gauge::ImportMode::Accumulate);
+  store_->histogramFromString("h1", Stats::Histogram::Unit::Unspecified);
+  store_->gaugeFromString("g1", Gauge::ImportMode::Accumulate);
+  profile = store_->cacheProfile();
+  EXPECT_TRUE(profile.enabled_);
+  EXPECT_EQ(2, profile.central_lock_acquisitions_);
+  EXPECT_EQ(std::chrono::microseconds(4), profile.central_lock_hold_time_);
+  EXPECT_EQ(std::chrono::microseconds(3), profile.max_central_lock_hold_time_);
+  EXPECT_EQ(2, profile.thread_caches_[0].misses_);
+
+  store_->setCacheProfiling(nullptr);
+  store_->textReadoutFromString("t1");
+  profile = store_->cacheProfile();
+  EXPECT_FALSE(profile.enabled_);
+  EXPECT_EQ(0, profile.central_lock_acquisitions_);
+  EXPECT_EQ(std::chrono::nanoseconds::zero(), profile.central_lock_hold_time_);
+  EXPECT_EQ(1, profile.thread_caches_[0].misses_);
+
+  store_->shutdownThreading();
+  tls_.shutdownThread();
+}
+
 TEST_F(StatsThreadLocalStoreTest, BasicScope) {
   InSequence s;
   store_->initializeThreading(main_thread_dispatcher_, tls_);
@@ -1464,6 +1510,56 @@ TEST_F(HistogramTest, ParentHistogramBucketSummary) {
             parent_histogram->bucketSummary());
 }
 
+// With the log-linear engine, merges don't wait for the workers to swap their histograms, and the
+// statistics match those of a log-linear histogram of the same values.
+TEST_F(HistogramTest, LogLinearEngineMerge) {
+  envoy::config::metrics::v3::StatsConfig stats_config;
+  stats_config.set_histogram_engine(envoy::config::metrics::v3::StatsConfig::LOG_LINEAR);
+  store_->setHistogramSettings(std::make_unique<HistogramSettingsImpl>(stats_config));
+  Histogram& h1 = store_->histogramFromString("h1", Stats::Histogram::Unit::Unspecified);
+
+  LogLinearHistogram interval;
+  LogLinearHistogram cumulative;
+  for (const uint64_t value : {0, 43, 41, 415, 2201}) {
+    EXPECT_CALL(sink_, onHistogramComplete(Ref(h1), value));
+    h1.recordValue(value);
+    interval.recordValue(value);
+  }
+  cumulative.add(interval);
+  bool merge_called = false;
+  store_->mergeHistograms([&merge_called]() -> void { merge_called = true; });
+  EXPECT_TRUE(merge_called);
+
+  ASSERT_EQ(1, store_->histograms().size());
+  ParentHistogramSharedPtr parent_histogram = store_->histograms()[0];
+  HistogramStatisticsImpl interval_statistics(interval, HistogramSettingsImpl::defaultBuckets());
+  EXPECT_EQ(interval_statistics.quantileSummary(),
+            parent_histogram->intervalStatistics().quantileSummary());
+  EXPECT_EQ(interval_statistics.bucketSummary(),
+            parent_histogram->intervalStatistics().bucketSummary());
+  EXPECT_EQ(5, parent_histogram->intervalStatistics().sampleCount());
+  EXPECT_EQ(2700, parent_histogram->intervalStatistics().sampleSum());
+
+  interval.clear();
+  for (const uint64_t value : {3201, 125}) {
+    EXPECT_CALL(sink_, onHistogramComplete(Ref(h1), value));
+    h1.recordValue(value);
+    interval.recordValue(value);
+  }
+  cumulative.add(interval);
+  store_->mergeHistograms([]() -> void {});
+
+  HistogramStatisticsImpl cumulative_statistics(cumulative,
+                                                HistogramSettingsImpl::defaultBuckets());
+  EXPECT_EQ(cumulative_statistics.quantileSummary(),
+            parent_histogram->cumulativeStatistics().quantileSummary());
+  EXPECT_EQ(cumulative_statistics.bucketSummary(),
+            parent_histogram->cumulativeStatistics().bucketSummary());
+  EXPECT_EQ(2, parent_histogram->intervalStatistics().sampleCount());
+  EXPECT_EQ(7, parent_histogram->cumulativeStatistics().sampleCount());
+  EXPECT_EQ(6026, parent_histogram->cumulativeStatistics().sampleSum());
+}
+
 class ThreadLocalRealThreadsTestBase : public ThreadLocalStoreNoMocksTestBase {
 protected:
   static constexpr uint32_t NumScopes = 1000;
@@ -1682,6 +1778,89 @@ TEST_F(ClusterShutdownCleanupStarvationTest, TwelveThreadsWithoutBlockade) {
   store_->sync().signal(ThreadLocalStoreImpl::MainDispatcherCleanupSync);
 }
 
+class CacheWarmupThreadTest : public ThreadLocalRealThreadsTestBase {
+protected:
+  static constexpr uint32_t NumThreads = 2;
+  static constexpr uint64_t NumStats = 4;
+
+  CacheWarmupThreadTest() : ThreadLocalRealThreadsTestBase(NumThreads) {}
+
+  void makeStats() {
+    scope_->counterFromString("upstream_rq_total");
+    scope_->gaugeFromString("membership_total", Gauge::ImportMode::Accumulate);
+    scope_->histogramFromString("upstream_rq_time", Histogram::Unit::Milliseconds);
+    scope_->textReadoutFromString("version");
+  }
+
+  // Creates a scope and its stats on the main thread, as for a cluster added by CDS, and waits for
+  // any warm-up it posts to complete.
+  void createScope() {
+    {
+      BlockingBarrier blocking_barrier(1);
+      main_dispatcher_->post(blocking_barrier.run([this]() {
+        scope_ = store_->createScope("cluster.");
+        makeStats();
+      }));
+    }
+    mainDispatchBlock();
+    tlsBlock();
+  }
+
+  void makeStatsOnWorkers() {
+    BlockingBarrier blocking_barrier(NumThreads);
+    for (Event::DispatcherPtr& thread_dispatcher : thread_dispatchers_) {
+      thread_dispatcher->post(blocking_barrier.run([this]() { makeStats(); }));
+    }
+  }
+
+  // Destroys the scope on the main thread, and waits for it to be flushed from all caches.
+  void destroyScope() {
+    {
+      BlockingBarrier blocking_barrier(1);
+      main_dispatcher_->post(blocking_barrier.run([this]() { scope_.reset(); }));
+    }
+    mainDispatchBlock();
+    tlsBlock();
+    mainDispatchBlock();
+  }
+
+  ScopePtr scope_;
+};
+
+TEST_F(CacheWarmupThreadTest, ColdCaches) {
+  createScope();
+  makeStatsOnWorkers();
+
+  // Every thread misses its cache for each stat once.
+  const CacheProfile profile = store_->cacheProfile();
+  ASSERT_EQ(NumThreads + 1, profile.thread_caches_.size());
+  for (const CacheProfile::ThreadCache& thread_cache : profile.thread_caches_) {
+    EXPECT_EQ(NumStats, thread_cache.misses_) << thread_cache.thread_name_;
+    EXPECT_EQ(0, thread_cache.warmed_) << thread_cache.thread_name_;
+  }
+  destroyScope();
+}
+
+TEST_F(CacheWarmupThreadTest, WarmCaches) {
+  store_->setThreadLocalCacheWarmup(true);
+  createScope();
+  makeStatsOnWorkers();
+
+  // The workers find the stats made on the main thread in their warmed up caches.
+  const CacheProfile profile = store_->cacheProfile();
+  ASSERT_EQ(NumThreads + 1, profile.thread_caches_.size());
+  for (const CacheProfile::ThreadCache& thread_cache : profile.thread_caches_) {
+    if (thread_cache.thread_name_ == "test_main_thread") {
+      EXPECT_EQ(NumStats, thread_cache.misses_);
+      EXPECT_EQ(0, thread_cache.warmed_);
+    } else {
+      EXPECT_EQ(0, thread_cache.misses_) << thread_cache.thread_name_;
+      EXPECT_EQ(NumStats, thread_cache.warmed_) << thread_cache.thread_name_;
+    }
+  }
+  destroyScope();
+}
+
 class HistogramThreadTest : public ThreadLocalRealThreadsTestBase {
 protected:
   static constexpr uint32_t NumThreads = 10;
@@ -0,0 +1,194 @@
+#include <sys/socket.h>
+
+#include <memory>
+#include <string>
+
+#include "common/network/io_socket_handle_impl.h"
+#include "common/stats/isolated_store_impl.h"
+#include "common/tcp_proxy/splicer.h"
+#include "common/tcp_proxy/tcp_proxy.h"
+
+#include "test/mocks/network/mocks.h"
+#include "test/test_common/utility.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::_;
+using testing::Invoke;
+using testing::NiceMock;
+using testing::Return;
+using testing::ReturnRef;
+
+namespace Envoy {
+namespace TcpProxy {
+namespace {
+
+class SplicerTest : public testing::Test {
+public:
+  SplicerTest()
+      : api_(Api::createApiForTest()), dispatcher_(api_->allocateDispatcher("test_thread")),
+        stats_{ALL_TCP_PROXY_STATS(POOL_COUNTER(store_), POOL_GAUGE(store_))} {
+    os_fd_t fds[2];
+    RELEASE_ASSERT(::socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, fds) == 0, "");
+    client_fd_ = fds[0];
+    from_handle_ = std::make_unique<Network::IoSocketHandleImpl>(fds[1]);
+    RELEASE_ASSERT(::socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, fds) == 0, "");
+    server_fd_ = fds[0];
+    to_handle_ = std::make_unique<Network::IoSocketHandleImpl>(fds[1]);
+
+    setupConnection(from_, from_handle_.get());
+    setupConnection(to_, to_handle_.get());
+    splicer_ = std::make_unique<Splicer>(from_, to_, stats_,
+                                         [this](uint64_t bytes) { spliced_bytes_ += bytes; });
+  }
+
+  ~SplicerTest() override {
+    splicer_.reset();
+    from_handle_->close();
+    to_handle_->close();
+    ::close(client_fd_);
+    ::close(server_fd_);
+  }
+
+  void setupConnection(NiceMock<Network::MockConnection>& connection, Network::IoHandle* handle) {
+    ON_CALL(connection, dispatcher()).WillByDefault(ReturnRef(*dispatcher_));
+    ON_CALL(connection, spliceableIoHandle()).WillByDefault(Return(handle));
+    ON_CALL(connection, readDisable(_)).WillByDefault(Invoke([&connection](bool disable) {
+      connection.read_enabled_ = !disable;
+    }));
+  }
+
+  void runUntil(std::function<bool()> done) {
+    for (int i = 0; i < 10000 && !done(); i++) {
+      dispatcher_->run(Event::Dispatcher::RunType::NonBlock);
+    }
+    ASSERT_TRUE(done());
+  }
+
+  // Reads what is readable on the server fd.
+  std::string readServer() {
+    std::string data;
+    char buffer[16384];
+    ssize_t rc;
+    while ((rc = ::read(server_fd_, buffer, sizeof(buffer))) > 0) {
+      data.append(buffer, rc);
+    }
+    return data;
+  }
+
+  Stats::IsolatedStoreImpl store_;
+  Api::ApiPtr api_;
+  Event::DispatcherPtr dispatcher_;
+  TcpProxyStats stats_;
+  os_fd_t client_fd_;
+  os_fd_t server_fd_;
+  Network::IoHandlePtr from_handle_;
+  Network::IoHandlePtr to_handle_;
+  NiceMock<Network::MockConnection> from_;
+  NiceMock<Network::MockConnection> to_;
+  std::unique_ptr<Splicer> splicer_;
+  uint64_t spliced_bytes_{};
+};
+
+// Data is spliced until the end of stream, after which the source connection is read enabled
+// again to read it.
+TEST_F(SplicerTest, SpliceUntilEndOfStream) {
+  const std::string data = "hello world";
+  ASSERT_EQ(static_cast<ssize_t>(data.size()), ::write(client_fd_, data.data(), data.size()));
+
+  EXPECT_CALL(from_, readDisable(true));
+  EXPECT_TRUE(splicer_->maybeSplice());
+  EXPECT_TRUE(splicer_->active());
+  EXPECT_EQ(1U, stats_.splice_total_.value());
+  EXPECT_EQ(1U, stats_.splice_active_.value());
+
+  EXPECT_CALL(from_, recordSplicedBytes(data.size(), 0));
+  EXPECT_CALL(to_, recordSplicedBytes(0, data.size()));
+  std::string received;
+  runUntil([&]() {
+    received += readServer();
+    return received.size() == data.size();
+  });
+  EXPECT_EQ(data, received);
+  EXPECT_EQ(data.size(), spliced_bytes_);
+  EXPECT_EQ(data.size(), stats_.splice_bytes_total_.value());
+
+  EXPECT_CALL(from_, readDisable(false));
+  ::shutdown(client_fd_, SHUT_WR);
+  runUntil([&]() { return !splicer_->active(); });
+  EXPECT_EQ(0U, stats_.splice_active_.value());
+  EXPECT_TRUE(from_.read_enabled_);
+
+  // Splicing doesn't start again.
+  EXPECT_FALSE(splicer_->maybeSplice());
+  EXPECT_EQ(1U, stats_.splice_total_.value());
+}
+
+// Splicing a lot of data is spread over several events, and waits on the destination socket when
+// it is full.
+TEST_F(SplicerTest, SpliceLargeTransfer) {
+  ON_CALL(from_, bufferLimit()).WillByDefault(Return(16384));
+  EXPECT_TRUE(splicer_->maybeSplice());
+
+  std::string data(4 * 1024 * 1024, 'a');
+  for (size_t i = 0; i < data.size(); i++) {
+    data[i] += i % 26;
+  }
+  size_t written = 0;
+  std::string received;
+  runUntil([&]() {
+    if (written < data.size()) {
+      const ssize_t rc = ::write(client_fd_, data.data() + written, data.size() - written);
+      if (rc > 0) {
+        written += rc;
+      }
+    }
+    received += readServer();
+    return received.size() == data.size();
+  });
+  EXPECT_EQ(data, received);
+  EXPECT_EQ(data.size(), stats_.splice_bytes_total_.value());
+  EXPECT_TRUE(splicer_->active());
+}
+
+TEST_F(SplicerTest, NotSpliceable) {
+  // The source connection is only read disabled once splicing starts.
+  EXPECT_CALL(from_, readDisable(true));
+  EXPECT_CALL(to_, spliceableIoHandle())
+      .WillOnce(Return(nullptr))
+      .WillRepeatedly(Return(to_handle_.get()));
+  EXPECT_FALSE(splicer_->maybeSplice());
+  EXPECT_FALSE(splicer_->active());
+  EXPECT_EQ(0U, stats_.splice_total_.value());
+
+  // Read disabled connections are left alone, but may be spliced later.
+  from_.read_enabled_ = false;
+  EXPECT_FALSE(splicer_->maybeSplice());
+  from_.read_enabled_ = true;
+  EXPECT_TRUE(splicer_->maybeSplice());
+  EXPECT_EQ(1U, stats_.splice_total_.value());
+  EXPECT_CALL(from_, readDisable(false));
+}
+
+TEST_F(SplicerTest, DestroyWhileActive) {
+  EXPECT_CALL(from_, readDisable(true));
+  EXPECT_TRUE(splicer_->maybeSplice());
+
+  EXPECT_CALL(from_, readDisable(false));
+  splicer_.reset();
+  EXPECT_EQ(0U, stats_.splice_active_.value());
+}
+
+TEST_F(SplicerTest, DestroyWhileActiveAndClosing) {
+  EXPECT_TRUE(splicer_->maybeSplice());
+
+  from_.state_ = Network::Connection::State::Closing;
+  EXPECT_CALL(from_, readDisable(_)).Times(0);
+  splicer_.reset();
+  EXPECT_EQ(0U, stats_.splice_active_.value());
+}
+
+} // namespace
+} // namespace TcpProxy
+} // namespace Envoy
@@ -106,6 +106,18 @@ idle_timeout: 1s
   EXPECT_EQ(std::chrono::seconds(1), config_obj.sharedConfig()->idleTimeout().value());
 }
 
+TEST(ConfigTest, SpliceThreshold) {
+  const std::string yaml = R"EOF(
+stat_prefix: name
+cluster: foo
+splice_threshold: 65536
+)EOF";
+
+  NiceMock<Server::Configuration::MockFactoryContext> factory_context;
+  Config config_obj(constructConfigFromV3Yaml(yaml, factory_context));
+  EXPECT_EQ(65536, config_obj.spliceThreshold().value());
+}
+
 TEST(ConfigTest, NoRouteConfig) {
   const std::string yaml = R"EOF(
   stat_prefix: name
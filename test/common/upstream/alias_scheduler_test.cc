@@ -0,0 +1,100 @@
+#include <cmath>
+#include <random>
+
+#include "common/upstream/alias_scheduler.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Upstream {
+namespace {
+
+// Random number whose high bits select a column and whose low bits flip its coin.
+uint64_t randomFor(uint32_t column_bits, uint32_t coin) {
+  return (static_cast<uint64_t>(column_bits) << 32) | coin;
+}
+
+std::vector<std::pair<double, std::shared_ptr<uint32_t>>> makeEntries(std::vector<double> weights) {
+  std::vector<std::pair<double, std::shared_ptr<uint32_t>>> entries;
+  for (uint32_t i = 0; i < weights.size(); ++i) {
+    entries.emplace_back(weights[i], std::make_shared<uint32_t>(i));
+  }
+  return entries;
+}
+
+TEST(AliasSchedulerTest, Empty) {
+  AliasScheduler<uint32_t> sched(makeEntries({}));
+  EXPECT_TRUE(sched.empty());
+}
+
+TEST(AliasSchedulerTest, SingleEntry) {
+  AliasScheduler<uint32_t> sched(makeEntries({0.5}));
+  EXPECT_FALSE(sched.empty());
+  EXPECT_EQ(0, *sched.pick(0));
+  EXPECT_EQ(0, *sched.pick(UINT64_MAX));
+}
+
+// Validate that equal weights leave every column full, so the column alone decides the pick.
+TEST(AliasSchedulerTest, Unweighted) {
+  AliasScheduler<uint32_t> sched(makeEntries({1, 1, 1, 1}));
+  for (const uint32_t coin : {0U, 0x80000000U, UINT32_MAX}) {
+    EXPECT_EQ(0, *sched.pick(randomFor(0, coin)));
+    EXPECT_EQ(1, *sched.pick(randomFor(0x40000000, coin)));
+    EXPECT_EQ(2, *sched.pick(randomFor(0x80000000, coin)));
+    EXPECT_EQ(3, *sched.pick(randomFor(UINT32_MAX, coin)));
+  }
+}
+
+// With weights 1 and 3, the first column is half entry 0 and half entry 1, and the second column is
+// all entry 1.
+TEST(AliasSchedulerTest, Alias) {
+  AliasScheduler<uint32_t> sched(makeEntries({1, 3}));
+  EXPECT_EQ(0, *sched.pick(randomFor(0, 0)));
+  EXPECT_EQ(0, *sched.pick(randomFor(0x7fffffff, 0x7fffffff)));
+  EXPECT_EQ(1, *sched.pick(randomFor(0, 0x80000000)));
+  EXPECT_EQ(1, *sched.pick(randomFor(0x7fffffff, UINT32_MAX)));
+  EXPECT_EQ(1, *sched.pick(randomFor(0x80000000, 0)));
+  EXPECT_EQ(1, *sched.pick(randomFor(UINT32_MAX, UINT32_MAX)));
+}
+
+// Validate that picks follow the weights.
+TEST(AliasSchedulerTest, Weighted) {
+  constexpr uint32_t num_entries = 128;
+  constexpr uint32_t num_picks = 1000000;
+  std::vector<double> weights;
+  for (uint32_t i = 0; i < num_entries; ++i) {
+    weights.push_back(i + 1);
+  }
+  AliasScheduler<uint32_t> sched(makeEntries(weights));
+
+  std::mt19937_64 random(42);
+  uint32_t pick_count[num_entries] = {};
+  for (uint32_t i = 0; i < num_picks; ++i) {
+    ++pick_count[*sched.pick(random())];
+  }
+
+  const double total_weight = (num_entries * (1 + num_entries)) / 2;
+  for (uint32_t i = 0; i < num_entries; ++i) {
+    const double expected = num_picks * weights[i] / total_weight;
+    // Within 5 standard deviations.
+    EXPECT_NEAR(expected, pick_count[i], 5 * std::sqrt(expected)) << "entry " << i;
+  }
+}
+
+// Validate that a very light entry is still picked, and not more often than its weight says.
+TEST(AliasSchedulerTest, SkewedWeights) {
+  AliasScheduler<uint32_t> sched(makeEntries({1000, 1, 1000}));
+
+  std::mt19937_64 random(42);
+  uint32_t pick_count[3] = {};
+  for (uint32_t i = 0; i < 2001000; ++i) {
+    ++pick_count[*sched.pick(random())];
+  }
+
+  EXPECT_NEAR(1000, pick_count[1], 5 * std::sqrt(1000));
+  EXPECT_NEAR(1000000, pick_count[0], 5 * std::sqrt(1000000));
+}
+
+} // namespace
+} // namespace Upstream
+} // namespace Envoy
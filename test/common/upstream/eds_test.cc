@@ -400,6 +400,60 @@ TEST_F(EdsTest, EndpointMetadata) {
             "v2");
 }
 
+// Validate that a weight-only update rebuilds the hosts when the load balancer builds alias tables
+// from the host weights, and updates the weight in place otherwise.
+TEST_F(EdsTest, EndpointWeightChange) {
+  envoy::config::endpoint::v3::ClusterLoadAssignment cluster_load_assignment;
+  cluster_load_assignment.set_cluster_name("fare");
+  auto* endpoint = cluster_load_assignment.add_endpoints()->add_lb_endpoints();
+  endpoint->mutable_endpoint()->mutable_address()->mutable_socket_address()->set_address("1.2.3.4");
+  endpoint->mutable_endpoint()->mutable_address()->mutable_socket_address()->set_port_value(80);
+  endpoint->mutable_load_balancing_weight()->set_value(1);
+
+  initialize();
+  doOnConfigUpdateVerifyNoThrow(cluster_load_assignment);
+  EXPECT_TRUE(initialized_);
+
+  endpoint->mutable_load_balancing_weight()->set_value(2);
+  doOnConfigUpdateVerifyNoThrow(cluster_load_assignment);
+  EXPECT_EQ(1UL, stats_.counter("cluster.name.update_no_rebuild").value());
+  EXPECT_EQ(2, cluster_->prioritySet().hostSetsPerPriority()[0]->hosts()[0]->weight());
+
+  resetCluster(R"EOF(
+      name: name
+      connect_timeout: 0.25s
+      type: EDS
+      lb_policy: ROUND_ROBIN
+      common_lb_config:
+        weighted_host_scheduler: ALIAS
+      eds_cluster_config:
+        service_name: fare
+        eds_config:
+          api_config_source:
+            api_type: REST
+            cluster_names:
+            - eds
+            refresh_delay: 1s
+    )EOF",
+               Cluster::InitializePhase::Secondary);
+  initialize();
+  doOnConfigUpdateVerifyNoThrow(cluster_load_assignment);
+  uint32_t priority_updates = 0;
+  cluster_->prioritySet().addPriorityUpdateCb(
+      [&priority_updates](uint32_t, const HostVector&, const HostVector&) { ++priority_updates; });
+
+  // The same weight doesn't rebuild.
+  doOnConfigUpdateVerifyNoThrow(cluster_load_assignment);
+  EXPECT_EQ(2UL, stats_.counter("cluster.name.update_no_rebuild").value());
+  EXPECT_EQ(0, priority_updates);
+
+  endpoint->mutable_load_balancing_weight()->set_value(3);
+  doOnConfigUpdateVerifyNoThrow(cluster_load_assignment);
+  EXPECT_EQ(2UL, stats_.counter("cluster.name.update_no_rebuild").value());
+  EXPECT_EQ(1, priority_updates);
+  EXPECT_EQ(3, cluster_->prioritySet().hostSetsPerPriority()[0]->hosts()[0]->weight());
+}
+
 // Validate that onConfigUpdate() updates endpoint health status.
 TEST_F(EdsTest, EndpointHealthStatus) {
   envoy::config::endpoint::v3::ClusterLoadAssignment cluster_load_assignment;
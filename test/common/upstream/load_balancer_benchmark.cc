@@ -1,5 +1,6 @@
 // Usage: bazel run //test/common/upstream:load_balancer_benchmark
 
+#include <deque>
 #include <memory>
 
 #include "envoy/config/cluster/v3/cluster.pb.h"
@@ -12,6 +13,7 @@
 
 #include "test/common/upstream/utility.h"
 #include "test/mocks/upstream/mocks.h"
+#include "test/test_common/test_time.h"
 
 #include "benchmark/benchmark.h"
 
@@ -52,6 +54,7 @@ public:
   ClusterStats stats_{ClusterInfoImpl::generateStats(stats_store_)};
   NiceMock<Runtime::MockLoader> runtime_;
   Random::RandomGeneratorImpl random_;
+  Event::TestRealTimeSystem time_system_;
   envoy::config::cluster::v3::Cluster::CommonLbConfig common_config_;
   std::shared_ptr<MockClusterInfo> info_{new NiceMock<MockClusterInfo>()};
 };
@@ -71,7 +74,12 @@ public:
 
 class LeastRequestTester : public BaseTester {
 public:
-  LeastRequestTester(uint64_t num_hosts, uint32_t choice_count) : BaseTester(num_hosts) {
+  LeastRequestTester(uint64_t num_hosts, uint32_t choice_count,
+                     uint32_t weighted_subset_percent = 0, uint32_t weight = 0,
+                     envoy::config::cluster::v3::Cluster::CommonLbConfig::WeightedHostScheduler
+                         scheduler = envoy::config::cluster::v3::Cluster::CommonLbConfig::EDF)
+      : BaseTester(num_hosts, weighted_subset_percent, weight) {
+    common_config_.set_weighted_host_scheduler(scheduler);
     envoy::config::cluster::v3::Cluster::LeastRequestLbConfig lr_lb_config;
     lr_lb_config.mutable_choice_count()->set_value(choice_count);
     lb_ =
@@ -126,11 +134,18 @@ BENCHMARK(BM_RoundRobinLoadBalancerBuild)
 
 class RingHashTester : public BaseTester {
 public:
-  RingHashTester(uint64_t num_hosts, uint64_t min_ring_size) : BaseTester(num_hosts) {
+  RingHashTester(uint64_t num_hosts, uint64_t min_ring_size, uint32_t hash_balance_factor = 0)
+      : BaseTester(num_hosts) {
+    if (hash_balance_factor != 0) {
+      common_config_.mutable_consistent_hashing_lb_config()
+          ->mutable_hash_balance_factor()
+          ->set_value(hash_balance_factor);
+    }
     config_ = envoy::config::cluster::v3::Cluster::RingHashLbConfig();
     config_.value().mutable_minimum_ring_size()->set_value(min_ring_size);
     ring_hash_lb_ = std::make_unique<RingHashLoadBalancer>(
-        priority_set_, stats_, stats_store_, runtime_, random_, config_, common_config_);
+        priority_set_, stats_, stats_store_, runtime_, random_, time_system_, config_,
+        common_config_);
   }
 
   absl::optional<envoy::config::cluster::v3::Cluster::RingHashLbConfig> config_;
@@ -139,10 +154,16 @@ public:
 
 class MaglevTester : public BaseTester {
 public:
-  MaglevTester(uint64_t num_hosts, uint32_t weighted_subset_percent = 0, uint32_t weight = 0)
+  MaglevTester(uint64_t num_hosts, uint32_t weighted_subset_percent = 0, uint32_t weight = 0,
+               uint32_t hash_balance_factor = 0)
       : BaseTester(num_hosts, weighted_subset_percent, weight) {
+    if (hash_balance_factor != 0) {
+      common_config_.mutable_consistent_hashing_lb_config()
+          ->mutable_hash_balance_factor()
+          ->set_value(hash_balance_factor);
+    }
     maglev_lb_ = std::make_unique<MaglevLoadBalancer>(priority_set_, stats_, stats_store_, runtime_,
-                                                      random_, common_config_);
+                                                      random_, time_system_, common_config_);
   }
 
   std::unique_ptr<MaglevLoadBalancer> maglev_lb_;
@@ -205,6 +226,52 @@ BENCHMARK(BM_MaglevLoadBalancerBuildTable)
     ->Arg(500)
     ->Unit(benchmark::kMillisecond);
 
+// Replaces one host of the tester's cluster with a new one, as an EDS update would. This rebuilds
+// the ring or table of a thread aware load balancer.
+void replaceHost(BaseTester& tester, uint64_t i) {
+  HostVector hosts = tester.priority_set_.hostSetsPerPriority()[0]->hosts();
+  const uint64_t index = i % hosts.size();
+  const HostVector removed{hosts[index]};
+  const HostVector added{makeTestHost(
+      tester.info_, fmt::format("tcp://10.1.{}.{}:6379", (i / 256) % 256, i % 256))};
+  hosts[index] = added[0];
+  HostVectorConstSharedPtr updated_hosts = std::make_shared<HostVector>(hosts);
+  tester.priority_set_.updateHosts(
+      0, HostSetImpl::partitionHosts(updated_hosts, makeHostsPerLocality({hosts})), {}, added,
+      removed, absl::nullopt);
+}
+
+void BM_RingHashLoadBalancerHostChurn(benchmark::State& state) {
+  const uint64_t num_hosts = state.range(0);
+  const uint64_t min_ring_size = state.range(1);
+  RingHashTester tester(num_hosts, min_ring_size);
+  tester.ring_hash_lb_->initialize();
+  uint64_t i = 0;
+  for (auto _ : state) {
+    replaceHost(tester, i++);
+  }
+}
+BENCHMARK(BM_RingHashLoadBalancerHostChurn)
+    ->Args({500, 65536})
+    ->Args({2000, 65536})
+    ->Args({500, 256000})
+    ->Args({2000, 256000})
+    ->Unit(benchmark::kMillisecond);
+
+void BM_MaglevLoadBalancerHostChurn(benchmark::State& state) {
+  const uint64_t num_hosts = state.range(0);
+  MaglevTester tester(num_hosts);
+  tester.maglev_lb_->initialize();
+  uint64_t i = 0;
+  for (auto _ : state) {
+    replaceHost(tester, i++);
+  }
+}
+BENCHMARK(BM_MaglevLoadBalancerHostChurn)
+    ->Arg(500)
+    ->Arg(2000)
+    ->Unit(benchmark::kMillisecond);
+
 class TestLoadBalancerContext : public LoadBalancerContextBase {
 public:
   // Upstream::LoadBalancerContext
@@ -263,6 +330,49 @@ BENCHMARK(BM_LeastRequestLoadBalancerChooseHost)
     ->Args({100, 100, 1000000})
     ->Unit(benchmark::kMillisecond);
 
+// Compares the pick cost of the EDF and alias weighted host schedulers, with half of the hosts
+// weighted 5 and the rest weighted 1.
+void BM_RoundRobinLoadBalancerWeightedChooseHost(benchmark::State& state) {
+  const uint64_t num_hosts = state.range(0);
+  RoundRobinTester tester(num_hosts, 50, 5);
+  tester.common_config_.set_weighted_host_scheduler(
+      static_cast<envoy::config::cluster::v3::Cluster::CommonLbConfig::WeightedHostScheduler>(
+          state.range(1)));
+  tester.initialize();
+  TestLoadBalancerContext context;
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(tester.lb_->chooseHost(&context));
+  }
+}
+BENCHMARK(BM_RoundRobinLoadBalancerWeightedChooseHost)
+    ->Args({100, envoy::config::cluster::v3::Cluster::CommonLbConfig::EDF})
+    ->Args({100, envoy::config::cluster::v3::Cluster::CommonLbConfig::ALIAS})
+    ->Args({5000, envoy::config::cluster::v3::Cluster::CommonLbConfig::EDF})
+    ->Args({5000, envoy::config::cluster::v3::Cluster::CommonLbConfig::ALIAS})
+    ->Args({50000, envoy::config::cluster::v3::Cluster::CommonLbConfig::EDF})
+    ->Args({50000, envoy::config::cluster::v3::Cluster::CommonLbConfig::ALIAS});
+
+void BM_LeastRequestLoadBalancerWeightedChooseHost(benchmark::State& state) {
+  const uint64_t num_hosts = state.range(0);
+  LeastRequestTester tester(
+      num_hosts, 2, 50, 5,
+      static_cast<envoy::config::cluster::v3::Cluster::CommonLbConfig::WeightedHostScheduler>(
+          state.range(1)));
+  TestLoadBalancerContext context;
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(tester.lb_->chooseHost(&context));
+  }
+}
+BENCHMARK(BM_LeastRequestLoadBalancerWeightedChooseHost)
+    ->Args({100, envoy::config::cluster::v3::Cluster::CommonLbConfig::EDF})
+    ->Args({100, envoy::config::cluster::v3::Cluster::CommonLbConfig::ALIAS})
+    ->Args({5000, envoy::config::cluster::v3::Cluster::CommonLbConfig::EDF})
+    ->Args({5000, envoy::config::cluster::v3::Cluster::CommonLbConfig::ALIAS})
+    ->Args({50000, envoy::config::cluster::v3::Cluster::CommonLbConfig::EDF})
+    ->Args({50000, envoy::config::cluster::v3::Cluster::CommonLbConfig::ALIAS});
+
 void BM_RingHashLoadBalancerChooseHost(benchmark::State& state) {
   for (auto _ : state) {
     // Do not time the creation of the ring.
@@ -335,6 +445,132 @@ BENCHMARK(BM_MaglevLoadBalancerChooseHost)
     ->Args({500, 100000})
     ->Unit(benchmark::kMillisecond);
 
+// Keys for a skewed workload, in which 4 hot keys make up 20% of the requests.
+std::vector<uint64_t> skewedKeys(uint64_t keys_to_simulate) {
+  std::vector<uint64_t> keys;
+  keys.reserve(keys_to_simulate);
+  for (uint64_t i = 0; i < keys_to_simulate; i++) {
+    keys.push_back(hashInt(i % 100 < 20 ? i % 4 : i));
+  }
+  return keys;
+}
+
+// Sends the keys to lb while keeping 8 requests per host active, completing the oldest request as
+// each new one starts, so that host loads are what bounded loads act on. home_hosts holds the host
+// each key maps to without bounds.
+void simulateSkewedLoad(benchmark::State& state, LoadBalancer& lb, BaseTester& tester,
+                        const std::vector<uint64_t>& keys,
+                        const std::vector<std::string>& home_hosts) {
+  const uint64_t num_hosts = tester.priority_set_.hostSetsPerPriority()[0]->hosts().size();
+  const uint64_t window = num_hosts * 8;
+  std::deque<const Host*> active;
+  std::vector<const Host*> chosen;
+  chosen.reserve(keys.size());
+  auto& cluster_active = tester.info_->stats().upstream_rq_active_;
+  TestLoadBalancerContext context;
+  uint64_t max_host_active = 0;
+
+  for (const uint64_t key : keys) {
+    context.hash_key_ = key;
+    const Host* host = lb.chooseHost(&context).get();
+    host->stats().rq_active_.inc();
+    cluster_active.inc();
+    max_host_active = std::max(max_host_active, host->stats().rq_active_.value());
+    active.push_back(host);
+    chosen.push_back(host);
+    if (active.size() > window) {
+      active.front()->stats().rq_active_.dec();
+      cluster_active.dec();
+      active.pop_front();
+    }
+  }
+
+  // Do not time computation of the load statistics.
+  state.PauseTiming();
+  for (const Host* host : active) {
+    host->stats().rq_active_.dec();
+    cluster_active.dec();
+  }
+  absl::node_hash_map<std::string, uint64_t> hit_counter;
+  uint64_t moved = 0;
+  for (uint64_t i = 0; i < chosen.size(); i++) {
+    const std::string& address = chosen[i]->address()->asString();
+    hit_counter[address] += 1;
+    moved += address != home_hosts[i];
+  }
+  computeHitStats(state, hit_counter);
+  state.counters["max_active_over_mean"] = static_cast<double>(max_host_active) / 8;
+  state.counters["percent_moved"] = (static_cast<double>(moved) / keys.size()) * 100;
+  state.ResumeTiming();
+}
+
+std::vector<std::string> homeHosts(LoadBalancer& lb, const std::vector<uint64_t>& keys) {
+  std::vector<std::string> hosts;
+  hosts.reserve(keys.size());
+  TestLoadBalancerContext context;
+  for (const uint64_t key : keys) {
+    context.hash_key_ = key;
+    hosts.push_back(lb.chooseHost(&context)->address()->asString());
+  }
+  return hosts;
+}
+
+// Measures lookup cost and the spread of a skewed load with bounded loads, for a hash balance
+// factor of 0 (unbounded), 125 and 150.
+void BM_RingHashLoadBalancerBoundedLoad(benchmark::State& state) {
+  for (auto _ : state) {
+    state.PauseTiming();
+    const uint64_t num_hosts = state.range(0);
+    const uint64_t hash_balance_factor = state.range(1);
+    const std::vector<uint64_t> keys = skewedKeys(state.range(2));
+    RingHashTester unbounded(num_hosts, 65536);
+    unbounded.ring_hash_lb_->initialize();
+    const std::vector<std::string> home_hosts =
+        homeHosts(*unbounded.ring_hash_lb_->factory()->create(), keys);
+    RingHashTester tester(num_hosts, 65536, hash_balance_factor);
+    tester.ring_hash_lb_->initialize();
+    LoadBalancerPtr lb = tester.ring_hash_lb_->factory()->create();
+    state.ResumeTiming();
+
+    simulateSkewedLoad(state, *lb, tester, keys, home_hosts);
+  }
+}
+BENCHMARK(BM_RingHashLoadBalancerBoundedLoad)
+    ->Args({100, 0, 100000})
+    ->Args({100, 125, 100000})
+    ->Args({100, 150, 100000})
+    ->Args({500, 0, 100000})
+    ->Args({500, 125, 100000})
+    ->Args({500, 150, 100000})
+    ->Unit(benchmark::kMillisecond);
+
+void BM_MaglevLoadBalancerBoundedLoad(benchmark::State& state) {
+  for (auto _ : state) {
+    state.PauseTiming();
+    const uint64_t num_hosts = state.range(0);
+    const uint64_t hash_balance_factor = state.range(1);
+    const std::vector<uint64_t> keys = skewedKeys(state.range(2));
+    MaglevTester unbounded(num_hosts);
+    unbounded.maglev_lb_->initialize();
+    const std::vector<std::string> home_hosts =
+        homeHosts(*unbounded.maglev_lb_->factory()->create(), keys);
+    MaglevTester tester(num_hosts, 0, 0, hash_balance_factor);
+    tester.maglev_lb_->initialize();
+    LoadBalancerPtr lb = tester.maglev_lb_->factory()->create();
+    state.ResumeTiming();
+
+    simulateSkewedLoad(state, *lb, tester, keys, home_hosts);
+  }
+}
+BENCHMARK(BM_MaglevLoadBalancerBoundedLoad)
+    ->Args({100, 0, 100000})
+    ->Args({100, 125, 100000})
+    ->Args({100, 150, 100000})
+    ->Args({500, 0, 100000})
+    ->Args({500, 125, 100000})
+    ->Args({500, 150, 100000})
+    ->Unit(benchmark::kMillisecond);
+
 void BM_RingHashLoadBalancerHostLoss(benchmark::State& state) {
   for (auto _ : state) {
     const uint64_t num_hosts = state.range(0);
@@ -14,6 +14,7 @@
 #include "test/mocks/runtime/mocks.h"
 #include "test/mocks/upstream/mocks.h"
 #include "test/test_common/logging.h"
+#include "test/test_common/simulated_time_system.h"
 #include "test/test_common/test_runtime.h"
 
 #include "gmock/gmock.h"
@@ -917,6 +918,36 @@ TEST_P(RoundRobinLoadBalancerTest, WeightedSeed) {
   EXPECT_EQ(hostSet().healthy_hosts_[1], lb_->chooseHost(nullptr));
 }
 
+// Validate that the alias scheduler picks hosts in proportion to their weights.
+TEST_P(RoundRobinLoadBalancerTest, WeightedAlias) {
+  common_config_.set_weighted_host_scheduler(
+      envoy::config::cluster::v3::Cluster::CommonLbConfig::ALIAS);
+  hostSet().healthy_hosts_ = {makeTestHost(info_, "tcp://127.0.0.1:80", 1),
+                              makeTestHost(info_, "tcp://127.0.0.1:81", 3)};
+  hostSet().hosts_ = hostSet().healthy_hosts_;
+  init(false);
+  // The high bits of the random number pick a column of the alias table, and the low bits pick
+  // between the column's host and its alias. The first column is split evenly between hosts[0]
+  // and hosts[1], and the second is all hosts[1].
+  EXPECT_CALL(random_, random()).WillOnce(Return(0)).WillOnce(Return(0));
+  EXPECT_EQ(hostSet().healthy_hosts_[0], lb_->chooseHost(nullptr));
+  EXPECT_CALL(random_, random()).WillOnce(Return(0)).WillOnce(Return(0x80000000));
+  EXPECT_EQ(hostSet().healthy_hosts_[1], lb_->chooseHost(nullptr));
+  EXPECT_CALL(random_, random()).WillOnce(Return(0)).WillOnce(Return(0x8000000000000000));
+  EXPECT_EQ(hostSet().healthy_hosts_[1], lb_->chooseHost(nullptr));
+
+  // Weight changes take effect once the table is rebuilt, which swaps the roles of the columns.
+  hostSet().healthy_hosts_[0]->weight(3);
+  hostSet().healthy_hosts_[1]->weight(1);
+  hostSet().runCallbacks({}, {});
+  EXPECT_CALL(random_, random()).WillOnce(Return(0)).WillOnce(Return(0x80000000));
+  EXPECT_EQ(hostSet().healthy_hosts_[0], lb_->chooseHost(nullptr));
+  EXPECT_CALL(random_, random()).WillOnce(Return(0)).WillOnce(Return(0x8000000000000000));
+  EXPECT_EQ(hostSet().healthy_hosts_[1], lb_->chooseHost(nullptr));
+  EXPECT_CALL(random_, random()).WillOnce(Return(0)).WillOnce(Return(0x8000000080000000));
+  EXPECT_EQ(hostSet().healthy_hosts_[0], lb_->chooseHost(nullptr));
+}
+
 TEST_P(RoundRobinLoadBalancerTest, MaxUnhealthyPanic) {
   hostSet().healthy_hosts_ = {makeTestHost(info_, "tcp://127.0.0.1:80"),
                               makeTestHost(info_, "tcp://127.0.0.1:81")};
@@ -1617,6 +1648,47 @@ TEST_P(LeastRequestLoadBalancerTest, WeightImbalanceWithCustomActiveRequestBias)
   EXPECT_EQ(hostSet().healthy_hosts_[1], lb_2.chooseHost(nullptr));
 }
 
+// Validate that with the alias scheduler, the host with the fewest active requests among
+// choice_count weighted picks is chosen.
+TEST_P(LeastRequestLoadBalancerTest, WeightImbalanceAlias) {
+  common_config_.set_weighted_host_scheduler(
+      envoy::config::cluster::v3::Cluster::CommonLbConfig::ALIAS);
+  LeastRequestLoadBalancer lb_2(priority_set_, nullptr, stats_, runtime_, random_, common_config_,
+                                least_request_lb_config_);
+
+  // The first column of the alias table is split evenly between hosts[0] and hosts[1], and the
+  // second is all hosts[1].
+  hostSet().healthy_hosts_ = {makeTestHost(info_, "tcp://127.0.0.1:80", 1),
+                              makeTestHost(info_, "tcp://127.0.0.1:81", 3)};
+  hostSet().hosts_ = hostSet().healthy_hosts_;
+  hostSet().runCallbacks({}, {}); // Trigger callbacks. The added/removed lists are not relevant.
+
+  hostSet().healthy_hosts_[1]->stats().rq_active_.set(2);
+  EXPECT_CALL(random_, random())
+      .WillOnce(Return(0))
+      .WillOnce(Return(0x8000000000000000))
+      .WillOnce(Return(0));
+  EXPECT_EQ(hostSet().healthy_hosts_[0], lb_2.chooseHost(nullptr));
+
+  hostSet().healthy_hosts_[0]->stats().rq_active_.set(3);
+  EXPECT_CALL(random_, random())
+      .WillOnce(Return(0))
+      .WillOnce(Return(0x8000000000000000))
+      .WillOnce(Return(0));
+  EXPECT_EQ(hostSet().healthy_hosts_[1], lb_2.chooseHost(nullptr));
+
+  // Without an active request bias, a single weighted pick is made.
+  envoy::config::cluster::v3::Cluster::LeastRequestLbConfig lr_lb_config;
+  lr_lb_config.mutable_active_request_bias()->set_runtime_key("ar_bias");
+  lr_lb_config.mutable_active_request_bias()->set_default_value(1.0);
+  LeastRequestLoadBalancer lb_3{priority_set_, nullptr,        stats_,      runtime_,
+                                random_,       common_config_, lr_lb_config};
+  EXPECT_CALL(runtime_.snapshot_, getDouble("ar_bias", 1.0)).WillRepeatedly(Return(0.0));
+  hostSet().runCallbacks({}, {});
+  EXPECT_CALL(random_, random()).WillOnce(Return(0)).WillOnce(Return(0x8000000000000000));
+  EXPECT_EQ(hostSet().healthy_hosts_[1], lb_3.chooseHost(nullptr));
+}
+
 TEST_P(LeastRequestLoadBalancerTest, WeightImbalanceCallbacks) {
   hostSet().healthy_hosts_ = {makeTestHost(info_, "tcp://127.0.0.1:80", 1),
                               makeTestHost(info_, "tcp://127.0.0.1:81", 2)};
@@ -1643,6 +1715,111 @@ TEST_P(LeastRequestLoadBalancerTest, WeightImbalanceCallbacks) {
 INSTANTIATE_TEST_SUITE_P(PrimaryOrFailover, LeastRequestLoadBalancerTest,
                          ::testing::Values(true, false));
 
+class PeakEwmaLoadBalancerTest : public LoadBalancerTestBase {
+public:
+  PeakEwmaLoadBalancerTest() {
+    hostSet().healthy_hosts_ = {makeTestHost(info_, "tcp://127.0.0.1:80"),
+                                makeTestHost(info_, "tcp://127.0.0.1:81")};
+    hostSet().hosts_ = hostSet().healthy_hosts_;
+    hostSet().runCallbacks({}, {}); // Trigger callbacks. The added/removed lists are not relevant.
+  }
+
+  // Picks between the hosts at the given indices, in that order.
+  HostConstSharedPtr pick(uint64_t first, uint64_t second) {
+    EXPECT_CALL(random_, random())
+        .WillOnce(Return(0))
+        .WillOnce(Return(first))
+        .WillOnce(Return(second));
+    return lb_.chooseHost(nullptr);
+  }
+
+  void respond(uint32_t host_index, std::chrono::milliseconds response_time) {
+    lb_.onHostResponseTime(*hostSet().healthy_hosts_[host_index], response_time);
+  }
+
+  Event::SimulatedTimeSystem time_system_;
+  PeakEwmaLoadBalancer lb_{priority_set_, nullptr,        stats_,        runtime_,
+                           random_,       time_system_,   common_config_, absl::nullopt};
+};
+
+TEST_P(PeakEwmaLoadBalancerTest, NoHosts) {
+  hostSet().healthy_hosts_.clear();
+  hostSet().hosts_.clear();
+  hostSet().runCallbacks({}, {});
+  EXPECT_EQ(nullptr, lb_.chooseHost(nullptr));
+}
+
+// Validate that the host with the lowest latency times active requests is picked.
+TEST_P(PeakEwmaLoadBalancerTest, LatencyAndActiveRequests) {
+  // Without any latency yet, the first sampled host is picked.
+  EXPECT_EQ(hostSet().healthy_hosts_[0], pick(0, 1));
+  respond(0, std::chrono::milliseconds(100));
+  EXPECT_EQ(hostSet().healthy_hosts_[1], pick(0, 1));
+  respond(1, std::chrono::milliseconds(10));
+
+  EXPECT_EQ(hostSet().healthy_hosts_[1], pick(0, 1));
+  EXPECT_EQ(hostSet().healthy_hosts_[1], pick(1, 0));
+
+  // 10ms times 11 active requests is more than 100ms times 1.
+  hostSet().healthy_hosts_[1]->stats().rq_active_.set(10);
+  EXPECT_EQ(hostSet().healthy_hosts_[0], pick(0, 1));
+  EXPECT_EQ(hostSet().healthy_hosts_[0], pick(1, 0));
+
+  // Higher weights lower the cost of a host.
+  hostSet().healthy_hosts_[1]->weight(2);
+  EXPECT_EQ(hostSet().healthy_hosts_[1], pick(0, 1));
+}
+
+// Validate that a host without any response yet but with active requests is avoided.
+TEST_P(PeakEwmaLoadBalancerTest, UnknownLatency) {
+  EXPECT_EQ(hostSet().healthy_hosts_[0], pick(0, 1));
+  respond(0, std::chrono::seconds(1));
+
+  hostSet().healthy_hosts_[1]->stats().rq_active_.set(1);
+  EXPECT_EQ(hostSet().healthy_hosts_[0], pick(1, 0));
+}
+
+// Validate that a slower response replaces the average, and that averages decay with time.
+TEST_P(PeakEwmaLoadBalancerTest, PeakAndDecay) {
+  EXPECT_EQ(hostSet().healthy_hosts_[0], pick(0, 1));
+  EXPECT_EQ(hostSet().healthy_hosts_[1], pick(1, 0));
+  respond(0, std::chrono::milliseconds(20));
+  respond(1, std::chrono::milliseconds(10));
+  EXPECT_EQ(hostSet().healthy_hosts_[1], pick(0, 1));
+
+  respond(1, std::chrono::milliseconds(30));
+  EXPECT_EQ(hostSet().healthy_hosts_[0], pick(1, 0));
+
+  // Without responses for 8s, host 1's 30ms decays to 13.5ms, while a faster response moves host
+  // 0's average from 20ms to 17.2ms only.
+  time_system_.advanceTimeWait(std::chrono::seconds(8));
+  respond(0, std::chrono::milliseconds(15));
+  EXPECT_EQ(hostSet().healthy_hosts_[1], pick(0, 1));
+}
+
+// Validate that the latency of a removed host is forgotten.
+TEST_P(PeakEwmaLoadBalancerTest, RemovedHost) {
+  EXPECT_EQ(hostSet().healthy_hosts_[0], pick(0, 1));
+  EXPECT_EQ(hostSet().healthy_hosts_[1], pick(1, 0));
+  respond(0, std::chrono::milliseconds(100));
+  respond(1, std::chrono::milliseconds(10));
+
+  HostSharedPtr removed = hostSet().healthy_hosts_[0];
+  hostSet().healthy_hosts_ = {hostSet().healthy_hosts_[1]};
+  hostSet().hosts_ = hostSet().healthy_hosts_;
+  hostSet().runCallbacks({}, {removed});
+  // Responses to requests sent before the removal are ignored.
+  lb_.onHostResponseTime(*removed, std::chrono::milliseconds(100));
+
+  hostSet().healthy_hosts_.push_back(removed);
+  hostSet().hosts_ = hostSet().healthy_hosts_;
+  hostSet().runCallbacks({removed}, {});
+  EXPECT_EQ(hostSet().healthy_hosts_[1], pick(0, 1));
+}
+
+INSTANTIATE_TEST_SUITE_P(PrimaryOrFailover, PeakEwmaLoadBalancerTest,
+                         ::testing::Values(true, false));
+
 class RandomLoadBalancerTest : public LoadBalancerTestBase {
 public:
   void init() {
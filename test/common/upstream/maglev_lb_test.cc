@@ -6,6 +6,7 @@
 
 #include "test/common/upstream/utility.h"
 #include "test/mocks/upstream/mocks.h"
+#include "test/test_common/simulated_time_system.h"
 
 namespace Envoy {
 namespace Upstream {
@@ -42,7 +43,7 @@ public:
 
   void init(uint32_t table_size) {
     lb_ = std::make_unique<MaglevLoadBalancer>(priority_set_, stats_, stats_store_, runtime_,
-                                               random_, common_config_, table_size);
+                                               random_, time_system_, common_config_, table_size);
     lb_->initialize();
   }
 
@@ -54,6 +55,7 @@ public:
   envoy::config::cluster::v3::Cluster::CommonLbConfig common_config_;
   NiceMock<Runtime::MockLoader> runtime_;
   NiceMock<Random::MockRandomGenerator> random_;
+  Event::SimulatedTimeSystem time_system_;
   std::unique_ptr<MaglevLoadBalancer> lb_;
 };
 
@@ -178,6 +180,35 @@ TEST_F(MaglevLoadBalancerTest, BasicWithRetryHostPredicate) {
   }
 }
 
+// With a hash balance factor, a host at its bound passes requests on to another host. Bounds are
+// shared out by host weight.
+TEST_F(MaglevLoadBalancerTest, BoundedLoadWeighted) {
+  host_set_.hosts_ = {makeTestHost(info_, "tcp://127.0.0.1:90", 1),
+                      makeTestHost(info_, "tcp://127.0.0.1:91", 3)};
+  host_set_.healthy_hosts_ = host_set_.hosts_;
+  host_set_.runCallbacks({}, {});
+  common_config_.mutable_consistent_hashing_lb_config()->mutable_hash_balance_factor()->set_value(
+      150);
+  init(17);
+
+  LoadBalancerPtr lb = lb_->factory()->create();
+  // With 7 active requests, the bounds are 3 and 9 requests.
+  info_->stats().upstream_rq_active_.set(7);
+  host_set_.hosts_[0]->stats().rq_active_.set(3);
+  host_set_.hosts_[1]->stats().rq_active_.set(4);
+  for (uint64_t i = 0; i < 17; ++i) {
+    TestLoadBalancerContext context(i);
+    EXPECT_EQ(host_set_.hosts_[1], lb->chooseHost(&context));
+  }
+
+  host_set_.hosts_[0]->stats().rq_active_.set(0);
+  host_set_.hosts_[1]->stats().rq_active_.set(9);
+  for (uint64_t i = 0; i < 17; ++i) {
+    TestLoadBalancerContext context(i);
+    EXPECT_EQ(host_set_.hosts_[0], lb->chooseHost(&context));
+  }
+}
+
 // Weighted sanity test.
 TEST_F(MaglevLoadBalancerTest, Weighted) {
   host_set_.hosts_ = {makeTestHost(info_, "tcp://127.0.0.1:90", 1),
@@ -13,6 +13,7 @@
 #include "test/common/upstream/utility.h"
 #include "test/mocks/runtime/mocks.h"
 #include "test/mocks/upstream/mocks.h"
+#include "test/test_common/simulated_time_system.h"
 
 #include "absl/container/node_hash_map.h"
 #include "gmock/gmock.h"
@@ -54,7 +55,7 @@ public:
 
   void init() {
     lb_ = std::make_unique<RingHashLoadBalancer>(priority_set_, stats_, stats_store_, runtime_,
-                                                 random_, config_, common_config_);
+                                                 random_, time_system_, config_, common_config_);
     lb_->initialize();
   }
 
@@ -72,6 +73,7 @@ public:
   envoy::config::cluster::v3::Cluster::CommonLbConfig common_config_;
   NiceMock<Runtime::MockLoader> runtime_;
   NiceMock<Random::MockRandomGenerator> random_;
+  Event::SimulatedTimeSystem time_system_;
   std::unique_ptr<RingHashLoadBalancer> lb_;
 };
 
@@ -400,6 +402,87 @@ TEST_P(RingHashLoadBalancerTest, BasicWithRetryHostPredicate) {
   }
 }
 
+// With a hash balance factor, a host at its bound passes requests on to another host.
+TEST_P(RingHashLoadBalancerTest, BoundedLoad) {
+  hostSet().hosts_ = {
+      makeTestHost(info_, "tcp://127.0.0.1:90"), makeTestHost(info_, "tcp://127.0.0.1:91"),
+      makeTestHost(info_, "tcp://127.0.0.1:92"), makeTestHost(info_, "tcp://127.0.0.1:93")};
+  hostSet().healthy_hosts_ = hostSet().hosts_;
+  hostSet().runCallbacks({}, {});
+  common_config_.mutable_consistent_hashing_lb_config()->mutable_hash_balance_factor()->set_value(
+      150);
+  init();
+
+  LoadBalancerPtr lb = lb_->factory()->create();
+  TestLoadBalancerContext context(1234);
+  const HostConstSharedPtr host = lb->chooseHost(&context);
+  ASSERT_NE(nullptr, host);
+
+  // With 3 of the cluster's 4 active requests, the host is above 1.5 times its share of 5.
+  host->stats().rq_active_.set(3);
+  info_->stats().upstream_rq_active_.set(4);
+  const HostConstSharedPtr other = lb->chooseHost(&context);
+  EXPECT_NE(host, other);
+  // The same key keeps going to the same other host.
+  EXPECT_EQ(other, lb->chooseHost(&context));
+
+  // Once the host is back below its bound, the key returns to it.
+  host->stats().rq_active_.set(1);
+  EXPECT_EQ(host, lb->chooseHost(&context));
+
+  // When every host is at its bound of 2, the least loaded one is chosen.
+  for (const auto& h : hostSet().hosts_) {
+    h->stats().rq_active_.set(3);
+  }
+  other->stats().rq_active_.set(2);
+  EXPECT_EQ(other, lb->chooseHost(&context));
+
+  // Bounds follow the load of the whole cluster.
+  info_->stats().upstream_rq_active_.set(11);
+  EXPECT_EQ(host, lb->chooseHost(&context));
+}
+
+// Rings rebuilt from cached hashes, as hosts come and go, match rings built from scratch.
+TEST_P(RingHashLoadBalancerTest, RebuildMatchesFreshBuild) {
+  config_ = envoy::config::cluster::v3::Cluster::RingHashLbConfig();
+  config_.value().mutable_minimum_ring_size()->set_value(64);
+  hostSet().hosts_ = {makeTestHost(info_, "tcp://127.0.0.1:90"),
+                      makeTestHost(info_, "tcp://127.0.0.1:91"),
+                      makeTestHost(info_, "tcp://127.0.0.1:92")};
+  hostSet().healthy_hosts_ = hostSet().hosts_;
+  hostSet().runCallbacks({}, {});
+  init();
+
+  auto expect_fresh_ring = [this]() {
+    LoadBalancerPtr rebuilt = lb_->factory()->create();
+    RingHashLoadBalancer fresh(priority_set_, stats_, stats_store_, runtime_, random_,
+                               time_system_, config_, common_config_);
+    fresh.initialize();
+    LoadBalancerPtr fresh_lb = fresh.factory()->create();
+    for (uint64_t i = 0; i < 1000; ++i) {
+      TestLoadBalancerContext context(i * 0x9e3779b97f4a7c15);
+      EXPECT_EQ(fresh_lb->chooseHost(&context), rebuilt->chooseHost(&context));
+    }
+  };
+
+  // Replace a host and add more, which leaves 13 hashes per host rather than 22.
+  hostSet().hosts_ = {hostSet().hosts_[0], hostSet().hosts_[2],
+                      makeTestHost(info_, "tcp://127.0.0.1:93"),
+                      makeTestHost(info_, "tcp://127.0.0.1:94"),
+                      makeTestHost(info_, "tcp://127.0.0.1:95")};
+  hostSet().healthy_hosts_ = hostSet().hosts_;
+  hostSet().runCallbacks({}, {});
+  EXPECT_EQ(65, lb_->stats().size_.value());
+  expect_fresh_ring();
+
+  // Remove hosts, which leaves 32 hashes per host, more than were cached for either of them.
+  hostSet().hosts_ = {hostSet().hosts_[0], hostSet().hosts_[3]};
+  hostSet().healthy_hosts_ = hostSet().hosts_;
+  hostSet().runCallbacks({}, {});
+  EXPECT_EQ(64, lb_->stats().size_.value());
+  expect_fresh_ring();
+}
+
 // Given 2 hosts and a minimum ring size of 3, expect 2 hashes per host and a ring size of 4.
 TEST_P(RingHashLoadBalancerTest, UnevenHosts) {
   hostSet().hosts_ = {makeTestHost(info_, "tcp://127.0.0.1:80"),
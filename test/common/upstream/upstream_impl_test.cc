@@ -2314,6 +2314,52 @@ TEST_F(ClusterInfoImplTest, EdsServiceNamePopulation) {
                             "eds_cluster_config set in a non-EDS cluster");
 }
 
+// The peak EWMA load balancer is configured, but can't be combined with subsets.
+TEST_F(ClusterInfoImplTest, PeakEwmaLbPolicy) {
+  const std::string yaml = R"EOF(
+    name: name
+    connect_timeout: 0.25s
+    type: STRICT_DNS
+    lb_policy: PEAK_EWMA
+    peak_ewma_lb_config:
+      choice_count: 3
+      decay_time: 5s
+    load_assignment:
+        endpoints:
+          - lb_endpoints:
+            - endpoint:
+                address:
+                  socket_address:
+                    address: foo.bar.com
+                    port_value: 443
+  )EOF";
+  auto cluster = makeCluster(yaml);
+  EXPECT_EQ(LoadBalancerType::PeakEwma, cluster->info()->lbType());
+  ASSERT_TRUE(cluster->info()->lbPeakEwmaConfig().has_value());
+  EXPECT_EQ(3, cluster->info()->lbPeakEwmaConfig()->choice_count().value());
+
+  const std::string subset_yaml = yaml + R"EOF(
+    lb_subset_config:
+      subset_selectors:
+        - keys: [ "version" ]
+  )EOF";
+  EXPECT_THROW_WITH_MESSAGE(
+      makeCluster(subset_yaml), EnvoyException,
+      "cluster: LB policy PEAK_EWMA cannot be combined with lb_subset_config");
+
+  // The decay time is used in whole milliseconds, so shorter ones are rejected.
+  const std::string short_decay_yaml = R"EOF(
+    name: name
+    connect_timeout: 0.25s
+    type: STATIC
+    lb_policy: PEAK_EWMA
+    peak_ewma_lb_config:
+      decay_time: 0.0005s
+  )EOF";
+  EXPECT_THROW_WITH_REGEX(TestUtility::validate(parseClusterFromV3Yaml(short_decay_yaml)),
+                          EnvoyException, "Proto constraint validation failed.*DecayTime.*");
+}
+
 // Typed metadata loading throws exception.
 TEST_F(ClusterInfoImplTest, BrokenTypedMetadata) {
   const std::string yaml = R"EOF(
@@ -0,0 +1,216 @@
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "common/network/address_impl.h"
+
+#include "extensions/access_loggers/binary/binary_log_format.h"
+
+#include "test/mocks/stream_info/mocks.h"
+#include "test/test_common/utility.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::NiceMock;
+using testing::Return;
+
+namespace Envoy {
+namespace Extensions {
+namespace AccessLoggers {
+namespace Binary {
+namespace {
+
+class BinaryLogFormatTest : public testing::Test {
+protected:
+  BinaryLogFormatTest() {
+    ON_CALL(stream_info_, upstreamHost()).WillByDefault(Return(nullptr));
+  }
+
+  std::string encodeEntry(const RecordEncoder& encoder) {
+    RecordEncoder::Buffer buffer;
+    encoder.encodeEntry(request_headers_, response_headers_, stream_info_, buffer);
+    return std::string(buffer.data(), buffer.size());
+  }
+
+  std::vector<ProtobufWkt::Struct> decode(absl::string_view& data) {
+    std::vector<ProtobufWkt::Struct> entries;
+    decoder_.decode(data, [&entries](ProtobufWkt::Struct&& entry) {
+      entries.push_back(std::move(entry));
+    });
+    return entries;
+  }
+
+  ProtobufWkt::Struct fromJson(const std::string& json) {
+    ProtobufWkt::Struct entry;
+    TestUtility::loadFromJson(json, entry);
+    return entry;
+  }
+
+  NiceMock<StreamInfo::MockStreamInfo> stream_info_;
+  Http::TestRequestHeaderMapImpl request_headers_{{":method", "GET"}, {":path", "/foo"}};
+  Http::TestResponseHeaderMapImpl response_headers_{{"server", "envoy"}};
+  RecordDecoder decoder_;
+};
+
+TEST_F(BinaryLogFormatTest, AllFields) {
+  RecordEncoder encoder({{FieldType::StartTime},
+                         {FieldType::Duration},
+                         {FieldType::ResponseDuration},
+                         {FieldType::ResponseCode},
+                         {FieldType::ResponseFlags},
+                         {FieldType::BytesReceived},
+                         {FieldType::BytesSent},
+                         {FieldType::Protocol},
+                         {FieldType::DownstreamRemoteAddress},
+                         {FieldType::DownstreamLocalAddress},
+                         {FieldType::UpstreamHost},
+                         {FieldType::UpstreamCluster},
+                         {FieldType::RouteName},
+                         {FieldType::RequestHeader, Http::LowerCaseString(":path")},
+                         {FieldType::RequestHeader, Http::LowerCaseString("missing")},
+                         {FieldType::ResponseHeader, Http::LowerCaseString("Server")}});
+
+  stream_info_.start_time_ = SystemTime(std::chrono::microseconds(1522796769123456));
+  stream_info_.end_time_ = std::chrono::microseconds(5007);
+  EXPECT_CALL(stream_info_, firstUpstreamRxByteReceived()).WillRepeatedly(Return(absl::nullopt));
+  stream_info_.response_code_ = 503;
+  EXPECT_CALL(stream_info_, responseFlags()).WillRepeatedly(Return(0x21));
+  stream_info_.bytes_received_ = 10;
+  stream_info_.bytes_sent_ = 300000;
+  stream_info_.protocol_ = Http::Protocol::Http2;
+  stream_info_.downstream_remote_address_ =
+      std::make_shared<Network::Address::Ipv6Instance>("2001:db8::1", 8443);
+  stream_info_.downstream_local_address_ =
+      std::make_shared<Network::Address::Ipv4Instance>("10.0.0.2", 80);
+  stream_info_.route_name_ = "route";
+
+  std::string data(encoder.schemaRecord());
+  data += encodeEntry(encoder);
+  absl::string_view remaining = data;
+  const std::vector<ProtobufWkt::Struct> entries = decode(remaining);
+  EXPECT_TRUE(remaining.empty());
+
+  ASSERT_EQ(1, entries.size());
+  EXPECT_TRUE(TestUtility::protoEqual(fromJson(R"EOF({
+    "start_time": 1522796769123456,
+    "duration": 5007,
+    "response_duration": null,
+    "response_code": 503,
+    "response_flags": 33,
+    "bytes_received": 10,
+    "bytes_sent": 300000,
+    "protocol": "HTTP/2",
+    "downstream_remote_address": "[2001:db8::1]:8443",
+    "downstream_local_address": "10.0.0.2:80",
+    "upstream_host": null,
+    "upstream_cluster": null,
+    "route_name": "route",
+    "request_header.:path": "/foo",
+    "request_header.missing": null,
+    "response_header.server": "envoy"
+  })EOF"),
+                                      entries[0]))
+      << entries[0].DebugString();
+}
+
+TEST_F(BinaryLogFormatTest, PipeAddress) {
+  RecordEncoder encoder({{FieldType::DownstreamRemoteAddress}});
+  stream_info_.downstream_remote_address_ =
+      std::make_shared<Network::Address::PipeInstance>("/tmp/envoy.sock");
+
+  std::string data(encoder.schemaRecord());
+  data += encodeEntry(encoder);
+  absl::string_view remaining = data;
+  const std::vector<ProtobufWkt::Struct> entries = decode(remaining);
+  ASSERT_EQ(1, entries.size());
+  EXPECT_EQ("/tmp/envoy.sock",
+            entries[0].fields().at("downstream_remote_address").string_value());
+}
+
+// Loggers with different schemas may share a file, and their entries are told apart by schema.
+TEST_F(BinaryLogFormatTest, SharedFile) {
+  RecordEncoder codes({{FieldType::ResponseCode}});
+  RecordEncoder paths({{FieldType::RequestHeader, Http::LowerCaseString(":path")}});
+  EXPECT_NE(codes.schemaId(), paths.schemaId());
+  stream_info_.response_code_ = 200;
+
+  std::string data(codes.schemaRecord());
+  data += paths.schemaRecord();
+  data += encodeEntry(paths);
+  data += encodeEntry(codes);
+  absl::string_view remaining = data;
+  const std::vector<ProtobufWkt::Struct> entries = decode(remaining);
+
+  ASSERT_EQ(2, entries.size());
+  EXPECT_TRUE(TestUtility::protoEqual(fromJson(R"EOF({"request_header.:path": "/foo"})EOF"),
+                                      entries[0]));
+  EXPECT_TRUE(TestUtility::protoEqual(fromJson(R"EOF({"response_code": 200})EOF"), entries[1]));
+}
+
+// A trailing partial record is left for the next call, once the rest of it has been read.
+TEST_F(BinaryLogFormatTest, PartialRecord) {
+  RecordEncoder encoder({{FieldType::BytesSent}});
+  const std::string data = absl::StrCat(encoder.schemaRecord(), encodeEntry(encoder));
+
+  absl::string_view remaining = absl::string_view(data).substr(0, data.size() - 1);
+  EXPECT_TRUE(decode(remaining).empty());
+  EXPECT_EQ(encodeEntry(encoder).size() - 1, remaining.size());
+
+  remaining = absl::string_view(data).substr(data.size() - encodeEntry(encoder).size());
+  EXPECT_EQ(1, decode(remaining).size());
+}
+
+// Entries whose schema record isn't in the decoded data, as in a rotated file, are counted and
+// skipped, until their schema is seen.
+TEST_F(BinaryLogFormatTest, UnknownSchema) {
+  RecordEncoder encoder({{FieldType::BytesSent}});
+  const std::string entry = encodeEntry(encoder);
+
+  absl::string_view remaining = entry;
+  EXPECT_TRUE(decode(remaining).empty());
+  EXPECT_EQ(1, decoder_.unknownSchemaEntries());
+
+  const std::string schema(encoder.schemaRecord());
+  remaining = schema;
+  decode(remaining);
+  remaining = entry;
+  EXPECT_EQ(1, decode(remaining).size());
+  EXPECT_EQ(1, decoder_.unknownSchemaEntries());
+}
+
+TEST_F(BinaryLogFormatTest, Malformed) {
+  RecordEncoder encoder({{FieldType::RouteName}});
+  stream_info_.route_name_ = "route";
+  const std::string schema(encoder.schemaRecord());
+  std::string entry = encodeEntry(encoder);
+
+  {
+    // The record length covers a value that claims to be longer than the record.
+    entry[entry.size() - 6] = 100;
+    std::string data = schema + entry;
+    absl::string_view remaining = data;
+    EXPECT_THROW_WITH_MESSAGE(decode(remaining), EnvoyException,
+                              "malformed binary access log record: truncated");
+  }
+
+  {
+    const std::string data("\x01\x00\x00\x00\x07", 5);
+    absl::string_view remaining = data;
+    EXPECT_THROW_WITH_MESSAGE(decode(remaining), EnvoyException,
+                              "unknown binary access log record type 7");
+  }
+
+  {
+    const std::string data("\x04\x00\x00\x00\x01\x00\x01\x30", 8);
+    absl::string_view remaining = data;
+    EXPECT_THROW_WITH_MESSAGE(decode(remaining), EnvoyException,
+                              "unknown binary access log field type 48");
+  }
+}
+
+} // namespace
+} // namespace Binary
+} // namespace AccessLoggers
+} // namespace Extensions
+} // namespace Envoy
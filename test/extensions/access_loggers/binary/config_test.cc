@@ -0,0 +1,108 @@
+#include "envoy/config/accesslog/v3/accesslog.pb.h"
+#include "envoy/extensions/access_loggers/binary/v3/binary.pb.h"
+#include "envoy/registry/registry.h"
+
+#include "common/access_log/access_log_impl.h"
+
+#include "extensions/access_loggers/binary/binary_log_format.h"
+#include "extensions/access_loggers/binary/config.h"
+#include "extensions/access_loggers/well_known_names.h"
+
+#include "test/mocks/access_log/mocks.h"
+#include "test/mocks/server/factory_context.h"
+#include "test/mocks/stream_info/mocks.h"
+#include "test/test_common/utility.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::_;
+using testing::Invoke;
+using testing::NiceMock;
+using testing::Return;
+
+namespace Envoy {
+namespace Extensions {
+namespace AccessLoggers {
+namespace Binary {
+namespace {
+
+TEST(BinaryAccessLogConfigTest, ValidateFail) {
+  NiceMock<Server::Configuration::MockFactoryContext> context;
+
+  EXPECT_THROW(
+      BinaryAccessLogFactory().createAccessLogInstance(
+          envoy::extensions::access_loggers::binary::v3::BinaryAccessLog(), nullptr, context),
+      ProtoValidationException);
+}
+
+TEST(BinaryAccessLogConfigTest, RegisteredName) {
+  EXPECT_NE(nullptr, Registry::FactoryRegistry<Server::Configuration::AccessLogInstanceFactory>::
+                         getFactory(AccessLogNames::get().Binary));
+}
+
+// The logger adds its schema as a file header and then writes one record per entry, which decode
+// back to the logged values.
+TEST(BinaryAccessLogConfigTest, WritesDecodableRecords) {
+  const std::string yaml = R"EOF(
+path: /dev/null
+fields: [RESPONSE_CODE, BYTES_SENT, DOWNSTREAM_REMOTE_ADDRESS]
+request_headers: [":path"]
+response_headers: ["server"]
+)EOF";
+  envoy::extensions::access_loggers::binary::v3::BinaryAccessLog bal_config;
+  TestUtility::loadFromYaml(yaml, bal_config);
+  envoy::config::accesslog::v3::AccessLog config;
+  config.set_name(AccessLogNames::get().Binary);
+  config.mutable_typed_config()->PackFrom(bal_config);
+
+  NiceMock<Server::Configuration::MockFactoryContext> context;
+  auto file = std::make_shared<AccessLog::MockAccessLogFile>();
+  EXPECT_CALL(context.access_log_manager_, createAccessLog("/dev/null")).WillOnce(Return(file));
+  std::string written;
+  EXPECT_CALL(*file, addHeader(_, _))
+      .WillOnce(Invoke(
+          [&written](uint64_t, absl::string_view data) { written += std::string(data); }));
+  EXPECT_CALL(*file, write(_)).Times(2).WillRepeatedly(Invoke([&written](absl::string_view data) {
+    written += std::string(data);
+  }));
+
+  AccessLog::InstanceSharedPtr logger = AccessLog::AccessLogFactory::fromProto(config, context);
+
+  NiceMock<StreamInfo::MockStreamInfo> stream_info;
+  stream_info.response_code_ = 200;
+  stream_info.bytes_sent_ = 42;
+  Http::TestRequestHeaderMapImpl request_headers{{":path", "/foo"}};
+  Http::TestResponseHeaderMapImpl response_headers{{"server", "envoy"}};
+  Http::TestResponseTrailerMapImpl response_trailers;
+  logger->log(&request_headers, &response_headers, &response_trailers, stream_info);
+  logger->log(&request_headers, nullptr, nullptr, stream_info);
+
+  RecordDecoder decoder;
+  std::vector<ProtobufWkt::Struct> entries;
+  absl::string_view remaining = written;
+  decoder.decode(remaining, [&entries](ProtobufWkt::Struct&& entry) {
+    entries.push_back(std::move(entry));
+  });
+  EXPECT_TRUE(remaining.empty());
+
+  ASSERT_EQ(2, entries.size());
+  ProtobufWkt::Struct expected;
+  TestUtility::loadFromJson(R"EOF({
+    "response_code": 200,
+    "bytes_sent": 42,
+    "downstream_remote_address": "127.0.0.1:0",
+    "request_header.:path": "/foo",
+    "response_header.server": "envoy"
+  })EOF",
+                            expected);
+  EXPECT_TRUE(TestUtility::protoEqual(expected, entries[0])) << entries[0].DebugString();
+  EXPECT_EQ(ProtobufWkt::Value::kNullValue,
+            entries[1].fields().at("response_header.server").kind_case());
+}
+
+} // namespace
+} // namespace Binary
+} // namespace AccessLoggers
+} // namespace Extensions
+} // namespace Envoy
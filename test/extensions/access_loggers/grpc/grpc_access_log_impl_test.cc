@@ -40,12 +40,21 @@ public:
       Grpc::AsyncStreamCallbacks<envoy::service::accesslog::v3::StreamAccessLogsResponse>;
 
   void initLogger(std::chrono::milliseconds buffer_flush_interval_msec, size_t buffer_size_bytes) {
+    initLogger(buffer_flush_interval_msec, buffer_size_bytes, buffer_size_bytes, 1);
+  }
+
+  void initLogger(std::chrono::milliseconds buffer_flush_interval_msec, size_t buffer_size_bytes,
+                  size_t max_buffered_bytes, uint32_t backpressure_sample_rate) {
     timer_ = new Event::MockTimer(&dispatcher_);
     EXPECT_CALL(*timer_, enableTimer(buffer_flush_interval_msec, _));
     logger_ = std::make_unique<GrpcAccessLoggerImpl>(
         Grpc::RawAsyncClientPtr{async_client_}, log_name_, buffer_flush_interval_msec,
-        buffer_size_bytes, dispatcher_, local_info_, stats_store_,
-        envoy::config::core::v3::ApiVersion::AUTO);
+        buffer_size_bytes, max_buffered_bytes, backpressure_sample_rate, dispatcher_, local_info_,
+        stats_store_, envoy::config::core::v3::ApiVersion::AUTO);
+  }
+
+  uint64_t counterValue(const std::string& name) {
+    return TestUtility::findCounter(stats_store_, "access_logs.grpc_access_log." + name)->value();
   }
 
   void expectStreamStart(MockAccessLogStream& stream, AccessLogCallbacks** callbacks_to_set) {
@@ -242,6 +251,69 @@ TEST_F(GrpcAccessLoggerImplTest, WatermarksLegacy) {
       0,
       TestUtility::findCounter(stats_store_, "access_logs.grpc_access_log.logs_dropped")->value());
 }
+
+// Test that entries are held up to max_buffered_bytes while the stream is backed up.
+TEST_F(GrpcAccessLoggerImplTest, WatermarksMaxBuffered) {
+  InSequence s;
+  initLogger(FlushInterval, 1, 100, 1);
+
+  MockAccessLogStream stream;
+  AccessLogCallbacks* callbacks;
+  expectStreamStart(stream, &callbacks);
+  EXPECT_CALL(local_info_, node());
+  EXPECT_CALL(stream, isAboveWriteBufferHighWatermark())
+      .Times(AnyNumber())
+      .WillRepeatedly(Return(true));
+  EXPECT_CALL(stream, sendMessageRaw_(_, _)).Times(0);
+
+  // Each entry is 22 bytes, so four fit below the limit and the fifth pushes it over.
+  envoy::data::accesslog::v3::HTTPAccessLogEntry entry;
+  entry.mutable_request()->set_path(std::string(18, 'a'));
+  ASSERT_EQ(22, entry.ByteSizeLong());
+  for (int i = 0; i < 7; ++i) {
+    logger_->log(envoy::data::accesslog::v3::HTTPAccessLogEntry(entry));
+  }
+  EXPECT_EQ(5, counterValue("logs_written"));
+  EXPECT_EQ(2, counterValue("logs_dropped"));
+  EXPECT_EQ(0, counterValue("batches_sent"));
+}
+
+// Test that only one in backpressure_sample_rate entries is held while the stream is backed up.
+TEST_F(GrpcAccessLoggerImplTest, WatermarksSampling) {
+  InSequence s;
+  initLogger(FlushInterval, 1, 1000, 3);
+
+  MockAccessLogStream stream;
+  AccessLogCallbacks* callbacks;
+  expectStreamStart(stream, &callbacks);
+  EXPECT_CALL(local_info_, node());
+
+  // The first entry fills the batch, which can't be sent. Every entry then tries to flush it again,
+  // as do the entries which are kept.
+  EXPECT_CALL(stream, isAboveWriteBufferHighWatermark()).Times(9).WillRepeatedly(Return(true));
+  envoy::data::accesslog::v3::TCPAccessLogEntry entry;
+  entry.mutable_common_properties()->set_route_name("route");
+  for (int i = 0; i < 7; ++i) {
+    logger_->log(envoy::data::accesslog::v3::TCPAccessLogEntry(entry));
+  }
+  EXPECT_EQ(3, counterValue("logs_written"));
+  EXPECT_EQ(4, counterValue("logs_sampled_out"));
+  EXPECT_EQ(0, counterValue("logs_dropped"));
+
+  // Once the stream drains, all the held entries go out in one batch.
+  EXPECT_CALL(stream, isAboveWriteBufferHighWatermark()).WillOnce(Return(false));
+  EXPECT_CALL(stream, sendMessageRaw_(_, false))
+      .WillOnce(Invoke([](Buffer::InstancePtr& request, bool) {
+        envoy::service::accesslog::v3::StreamAccessLogsMessage message;
+        Buffer::ZeroCopyInputStreamImpl request_stream(std::move(request));
+        EXPECT_TRUE(message.ParseFromZeroCopyStream(&request_stream));
+        EXPECT_EQ(3, message.tcp_logs().log_entry_size());
+      }));
+  EXPECT_CALL(*timer_, enableTimer(FlushInterval, _));
+  timer_->invokeCallback();
+  EXPECT_EQ(1, counterValue("batches_sent"));
+}
+
 // Test that stream failure is handled correctly.
 TEST_F(GrpcAccessLoggerImplTest, StreamFailure) {
   InSequence s;
@@ -307,6 +379,7 @@ http_logs:
                                           path4));
   entry.mutable_request()->set_path(path4);
   logger_->log(envoy::data::accesslog::v3::HTTPAccessLogEntry(entry));
+  EXPECT_EQ(2, counterValue("batches_sent"));
 }
 
 // Test that log entries are flushed periodically.
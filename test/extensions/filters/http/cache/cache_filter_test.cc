@@ -1,12 +1,16 @@
 #include "envoy/http/header_map.h"
 
 #include "common/http/headers.h"
+#include "common/http/message_impl.h"
+#include "common/stats/isolated_store_impl.h"
 
 #include "extensions/filters/http/cache/cache_filter.h"
 #include "extensions/filters/http/cache/simple_http_cache/simple_http_cache.h"
 
 #include "test/extensions/filters/http/cache/common.h"
+#include "test/mocks/event/mocks.h"
 #include "test/mocks/server/factory_context.h"
+#include "test/mocks/upstream/cluster_manager.h"
 #include "test/test_common/simulated_time_system.h"
 #include "test/test_common/utility.h"
 
@@ -22,7 +26,7 @@ class CacheFilterTest : public ::testing::Test {
 protected:
   CacheFilter makeFilter(HttpCache& cache) {
     CacheFilter filter(config_, /*stats_prefix=*/"", context_.scope(), context_.timeSource(),
-                       cache);
+                       cache, /*request_collapser=*/nullptr, /*revalidator=*/nullptr);
     filter.setDecoderFilterCallbacks(decoder_callbacks_);
     filter.setEncoderFilterCallbacks(encoder_callbacks_);
     return filter;
@@ -821,6 +825,391 @@ TEST_F(ValidationHeadersTest, InvalidLastModified) {
   }
 }
 
+// SimpleHttpCache whose insertions complete only when complete() is called, like those of a cache
+// that commits its entries asynchronously.
+class DeferredCompletionCache : public SimpleHttpCache {
+public:
+  // HttpCache
+  InsertContextPtr makeInsertContext(LookupContextPtr&& lookup_context,
+                                     Event::Dispatcher& dispatcher) override {
+    return std::make_unique<DeferredCompletionInsertContext>(
+        SimpleHttpCache::makeInsertContext(std::move(lookup_context), dispatcher), *this);
+  }
+
+  void complete() {
+    for (InsertCompleteCallback& on_complete : pending_) {
+      on_complete();
+    }
+    pending_.clear();
+  }
+
+private:
+  class DeferredCompletionInsertContext : public InsertContext {
+  public:
+    DeferredCompletionInsertContext(InsertContextPtr&& context, DeferredCompletionCache& cache)
+        : context_(std::move(context)), cache_(cache) {}
+    void insertHeaders(const Http::ResponseHeaderMap& response_headers, bool end_stream) override {
+      context_->insertHeaders(response_headers, end_stream);
+    }
+    void insertBody(const Buffer::Instance& chunk, InsertCallback ready_for_next_chunk,
+                    bool end_stream) override {
+      context_->insertBody(chunk, std::move(ready_for_next_chunk), end_stream);
+    }
+    void insertTrailers(const Http::ResponseTrailerMap& trailers) override {
+      context_->insertTrailers(trailers);
+    }
+    void onInsertComplete(InsertCompleteCallback on_complete) override {
+      cache_.pending_.push_back(std::move(on_complete));
+    }
+
+  private:
+    const InsertContextPtr context_;
+    DeferredCompletionCache& cache_;
+  };
+
+  std::vector<InsertCompleteCallback> pending_;
+};
+
+class RequestCollapsingTest : public CacheFilterTest {
+protected:
+  RequestCollapsingTest()
+      : collapser_(std::make_shared<RequestCollapser>(
+            envoy::extensions::filters::http::cache::v3alpha::CacheConfig::RequestCollapsing(),
+            /*stats_prefix=*/"", stats_store_)) {
+    request_headers_.setHost("RequestCollapsing");
+  }
+
+  std::unique_ptr<CacheFilter>
+  makeCollapsingFilter(Http::MockStreamDecoderFilterCallbacks& callbacks,
+                       HttpCache* cache = nullptr) {
+    auto filter = std::make_unique<CacheFilter>(
+        config_, /*stats_prefix=*/"", context_.scope(), context_.timeSource(),
+        cache ? *cache : simple_cache_, collapser_, nullptr);
+    filter->setDecoderFilterCallbacks(callbacks);
+    filter->setEncoderFilterCallbacks(encoder_callbacks_);
+    return filter;
+  }
+
+  uint64_t counter(absl::string_view name) {
+    return stats_store_.counterFromString(absl::StrCat("cache.request_collapsing.", name)).value();
+  }
+
+  Stats::IsolatedStoreImpl stats_store_;
+  RequestCollapserSharedPtr collapser_;
+  NiceMock<Http::MockStreamDecoderFilterCallbacks> follower_callbacks_;
+};
+
+TEST_F(RequestCollapsingTest, FollowerServedFromFill) {
+  auto leader = makeCollapsingFilter(decoder_callbacks_);
+  EXPECT_EQ(leader->decodeHeaders(request_headers_, true), Http::FilterHeadersStatus::Continue);
+
+  // A concurrent miss for the same key waits for the leader instead of going upstream.
+  auto follower = makeCollapsingFilter(follower_callbacks_);
+  auto* timer = new Event::MockTimer(&follower_callbacks_.dispatcher_);
+  EXPECT_CALL(*timer, enableTimer(std::chrono::milliseconds(5000), _));
+  EXPECT_CALL(follower_callbacks_, continueDecoding).Times(0);
+  EXPECT_EQ(follower->decodeHeaders(request_headers_, true),
+            Http::FilterHeadersStatus::StopAllIterationAndWatermark);
+
+  // Once the leader's response is inserted, the follower is served from the cache.
+  EXPECT_CALL(follower_callbacks_, encodeHeaders_(HeaderHasValueRef(":status", "200"), true));
+  EXPECT_EQ(leader->encodeHeaders(response_headers_, true), Http::FilterHeadersStatus::Continue);
+  EXPECT_EQ(1, counter("collapsed"));
+  EXPECT_EQ(0, counter("forwarded"));
+
+  leader->onDestroy();
+  follower->onDestroy();
+}
+
+// Followers are woken once the cache has committed the leader's response, which may be after the
+// leader is done with it.
+TEST_F(RequestCollapsingTest, FollowerWokenOnceInsertCompletes) {
+  DeferredCompletionCache cache;
+  auto leader = makeCollapsingFilter(decoder_callbacks_, &cache);
+  EXPECT_EQ(leader->decodeHeaders(request_headers_, true), Http::FilterHeadersStatus::Continue);
+
+  auto follower = makeCollapsingFilter(follower_callbacks_, &cache);
+  new NiceMock<Event::MockTimer>(&follower_callbacks_.dispatcher_);
+  EXPECT_EQ(follower->decodeHeaders(request_headers_, true),
+            Http::FilterHeadersStatus::StopAllIterationAndWatermark);
+
+  EXPECT_CALL(follower_callbacks_, encodeHeaders_).Times(0);
+  EXPECT_CALL(follower_callbacks_, continueDecoding).Times(0);
+  Buffer::OwnedImpl body("abc");
+  response_headers_.setContentLength(body.length());
+  EXPECT_EQ(leader->encodeHeaders(response_headers_, false), Http::FilterHeadersStatus::Continue);
+  EXPECT_EQ(leader->encodeData(body, true), Http::FilterDataStatus::Continue);
+  leader->onDestroy();
+  leader.reset();
+  testing::Mock::VerifyAndClearExpectations(&follower_callbacks_);
+
+  EXPECT_CALL(follower_callbacks_, encodeHeaders_(HeaderHasValueRef(":status", "200"), false));
+  cache.complete();
+  EXPECT_EQ(1, counter("collapsed"));
+  EXPECT_EQ(0, counter("forwarded"));
+  follower->onDestroy();
+}
+
+TEST_F(RequestCollapsingTest, FollowerForwardedWhenResponseUncacheable) {
+  response_headers_.setReferenceKey(Http::CustomHeaders::get().CacheControl, "no-store");
+  auto leader = makeCollapsingFilter(decoder_callbacks_);
+  EXPECT_EQ(leader->decodeHeaders(request_headers_, true), Http::FilterHeadersStatus::Continue);
+
+  auto follower = makeCollapsingFilter(follower_callbacks_);
+  new NiceMock<Event::MockTimer>(&follower_callbacks_.dispatcher_);
+  EXPECT_EQ(follower->decodeHeaders(request_headers_, true),
+            Http::FilterHeadersStatus::StopAllIterationAndWatermark);
+
+  EXPECT_CALL(follower_callbacks_, continueDecoding);
+  EXPECT_EQ(leader->encodeHeaders(response_headers_, true), Http::FilterHeadersStatus::Continue);
+  EXPECT_EQ(0, counter("collapsed"));
+  EXPECT_EQ(1, counter("forwarded"));
+
+  leader->onDestroy();
+  follower->onDestroy();
+}
+
+TEST_F(RequestCollapsingTest, FollowerForwardedOnTimeout) {
+  auto leader = makeCollapsingFilter(decoder_callbacks_);
+  EXPECT_EQ(leader->decodeHeaders(request_headers_, true), Http::FilterHeadersStatus::Continue);
+
+  auto follower = makeCollapsingFilter(follower_callbacks_);
+  auto* timer = new NiceMock<Event::MockTimer>(&follower_callbacks_.dispatcher_);
+  EXPECT_EQ(follower->decodeHeaders(request_headers_, true),
+            Http::FilterHeadersStatus::StopAllIterationAndWatermark);
+
+  EXPECT_CALL(follower_callbacks_, continueDecoding);
+  timer->invokeCallback();
+  EXPECT_EQ(1, counter("wait_timeout"));
+  EXPECT_EQ(1, counter("forwarded"));
+
+  // The follower no longer reacts to the fill completing.
+  EXPECT_CALL(follower_callbacks_, encodeHeaders_).Times(0);
+  EXPECT_EQ(leader->encodeHeaders(response_headers_, true), Http::FilterHeadersStatus::Continue);
+  EXPECT_EQ(0, counter("collapsed"));
+
+  leader->onDestroy();
+  follower->onDestroy();
+}
+
+// A leader that goes away without a response releases its followers.
+TEST_F(RequestCollapsingTest, LeaderDestroyed) {
+  auto leader = makeCollapsingFilter(decoder_callbacks_);
+  EXPECT_EQ(leader->decodeHeaders(request_headers_, true), Http::FilterHeadersStatus::Continue);
+
+  auto follower = makeCollapsingFilter(follower_callbacks_);
+  new NiceMock<Event::MockTimer>(&follower_callbacks_.dispatcher_);
+  EXPECT_EQ(follower->decodeHeaders(request_headers_, true),
+            Http::FilterHeadersStatus::StopAllIterationAndWatermark);
+
+  EXPECT_CALL(follower_callbacks_, continueDecoding);
+  leader->onDestroy();
+  EXPECT_EQ(1, counter("forwarded"));
+  follower->onDestroy();
+}
+
+class StaleResponseTest : public CacheFilterTest {
+protected:
+  StaleResponseTest()
+      : revalidator_(std::make_shared<BackgroundRevalidator>(
+            cm_, simple_cache_, context_.timeSource(), /*stats_prefix=*/"", stats_store_)) {
+    response_headers_.setReferenceKey(Http::CustomHeaders::get().Etag, "abc123");
+  }
+
+  std::unique_ptr<CacheFilter> makeStaleFilter() {
+    auto filter = std::make_unique<CacheFilter>(config_, /*stats_prefix=*/"", context_.scope(),
+                                                context_.timeSource(), simple_cache_,
+                                                /*request_collapser=*/nullptr, revalidator_);
+    filter->setDecoderFilterCallbacks(decoder_callbacks_);
+    filter->setEncoderFilterCallbacks(encoder_callbacks_);
+    return filter;
+  }
+
+  // Caches response_headers_ with body, then lets it go stale.
+  void insertStaleResponse(const std::string& cache_control, const std::string& body) {
+    response_headers_.setReferenceKey(Http::CustomHeaders::get().CacheControl, cache_control);
+    response_headers_.setContentLength(body.size());
+    auto filter = makeStaleFilter();
+    EXPECT_EQ(filter->decodeHeaders(request_headers_, true), Http::FilterHeadersStatus::Continue);
+    Buffer::OwnedImpl buffer(body);
+    EXPECT_EQ(filter->encodeHeaders(response_headers_, false), Http::FilterHeadersStatus::Continue);
+    EXPECT_EQ(filter->encodeData(buffer, true), Http::FilterDataStatus::Continue);
+    filter->onDestroy();
+    time_source_.advanceTimeWait(std::chrono::seconds(20));
+  }
+
+  uint64_t counter(absl::string_view name) {
+    return stats_store_.counterFromString(absl::StrCat("cache.revalidation.", name)).value();
+  }
+
+  Stats::IsolatedStoreImpl stats_store_;
+  NiceMock<Upstream::MockClusterManager> cm_;
+  BackgroundRevalidatorSharedPtr revalidator_;
+};
+
+TEST_F(StaleResponseTest, ServedWhileRevalidating) {
+  request_headers_.setHost("ServedWhileRevalidating");
+  insertStaleResponse("public, max-age=10, stale-while-revalidate=60", "");
+
+  // The stale response is served right away, and a single conditional request is sent in the
+  // background however many requests are served before it completes.
+  Http::RequestMessagePtr revalidation_request;
+  Http::AsyncClient::Callbacks* revalidation_callbacks = nullptr;
+  Http::MockAsyncClientRequest async_request(&cm_.async_client_);
+  EXPECT_CALL(cm_.async_client_, send_(_, _, _))
+      .WillOnce(testing::Invoke([&](Http::RequestMessagePtr& message,
+                                    Http::AsyncClient::Callbacks& callbacks,
+                                    const Http::AsyncClient::RequestOptions&)
+                                    -> Http::AsyncClient::Request* {
+        revalidation_request = std::move(message);
+        revalidation_callbacks = &callbacks;
+        return &async_request;
+      }));
+  EXPECT_CALL(decoder_callbacks_, encodeHeaders_(HeaderHasValueRef(":status", "200"), true))
+      .Times(2);
+  for (int i = 0; i < 2; i++) {
+    auto filter = makeStaleFilter();
+    EXPECT_EQ(filter->decodeHeaders(request_headers_, true),
+              Http::FilterHeadersStatus::StopAllIterationAndWatermark);
+    filter->onDestroy();
+  }
+  EXPECT_EQ(1, counter("started"));
+
+  ASSERT_NE(revalidation_request, nullptr);
+  EXPECT_THAT(revalidation_request->headers(), HeaderHasValueRef("if-none-match", "abc123"));
+  revalidation_callbacks->onSuccess(
+      async_request,
+      std::make_unique<Http::ResponseMessageImpl>(Http::ResponseHeaderMapPtr{
+          new Http::TestResponseHeaderMapImpl{{":status", "304"}, {"etag", "abc123"}}}));
+  EXPECT_EQ(1, counter("not_modified"));
+}
+
+// The conditional request is rewritten by the route, as the router would rewrite the request, so
+// that the origin is asked for the resource that was cached.
+TEST_F(StaleResponseTest, RevalidationAppliesRouteRewrites) {
+  request_headers_.setHost("RevalidationAppliesRouteRewrites");
+  insertStaleResponse("public, max-age=10, stale-while-revalidate=60", "");
+
+  EXPECT_CALL(decoder_callbacks_.route_->route_entry_, finalizeRequestHeaders(_, _, false))
+      .WillOnce(testing::Invoke(
+          [](Http::RequestHeaderMap& headers, const StreamInfo::StreamInfo&, bool) {
+            headers.setHost("origin.example.com");
+            headers.setPath("/rewritten");
+          }));
+  Http::RequestMessagePtr revalidation_request;
+  Http::MockAsyncClientRequest async_request(&cm_.async_client_);
+  EXPECT_CALL(cm_.async_client_, send_(_, _, _))
+      .WillOnce(testing::Invoke([&](Http::RequestMessagePtr& message,
+                                    Http::AsyncClient::Callbacks& callbacks,
+                                    const Http::AsyncClient::RequestOptions&)
+                                    -> Http::AsyncClient::Request* {
+        revalidation_request = std::move(message);
+        callbacks.onSuccess(
+            async_request,
+            std::make_unique<Http::ResponseMessageImpl>(Http::ResponseHeaderMapPtr{
+                new Http::TestResponseHeaderMapImpl{{":status", "304"}, {"etag", "abc123"}}}));
+        return nullptr;
+      }));
+  auto filter = makeStaleFilter();
+  EXPECT_EQ(filter->decodeHeaders(request_headers_, true),
+            Http::FilterHeadersStatus::StopAllIterationAndWatermark);
+  filter->onDestroy();
+
+  ASSERT_NE(revalidation_request, nullptr);
+  EXPECT_THAT(revalidation_request->headers(),
+              testing::AllOf(HeaderHasValueRef(":authority", "origin.example.com"),
+                             HeaderHasValueRef(":path", "/rewritten"),
+                             HeaderHasValueRef("if-none-match", "abc123")));
+  EXPECT_EQ(1, counter("not_modified"));
+}
+
+// Routes that rewrite the host to that of the upstream host can't be revalidated in the background,
+// so the stale entry is validated on the request path.
+TEST_F(StaleResponseTest, AutoHostRewriteValidatesOnRequestPath) {
+  request_headers_.setHost("AutoHostRewriteValidatesOnRequestPath");
+  insertStaleResponse("public, max-age=10, stale-while-revalidate=60", "");
+
+  ON_CALL(decoder_callbacks_.route_->route_entry_, autoHostRewrite())
+      .WillByDefault(testing::Return(true));
+  EXPECT_CALL(cm_.async_client_, send_(_, _, _)).Times(0);
+  auto filter = makeStaleFilter();
+  EXPECT_EQ(filter->decodeHeaders(request_headers_, true), Http::FilterHeadersStatus::Continue);
+  EXPECT_THAT(request_headers_, HeaderHasValueRef("if-none-match", "abc123"));
+  filter->onDestroy();
+  EXPECT_EQ(0, counter("started"));
+}
+
+TEST_F(StaleResponseTest, RevalidationFailure) {
+  request_headers_.setHost("RevalidationFailure");
+  insertStaleResponse("public, max-age=10, stale-while-revalidate=60", "");
+
+  Http::MockAsyncClientRequest async_request(&cm_.async_client_);
+  EXPECT_CALL(cm_.async_client_, send_(_, _, _))
+      .Times(2)
+      .WillRepeatedly(testing::Invoke([&](Http::RequestMessagePtr&,
+                                          Http::AsyncClient::Callbacks& callbacks,
+                                          const Http::AsyncClient::RequestOptions&)
+                                          -> Http::AsyncClient::Request* {
+        callbacks.onFailure(async_request, Http::AsyncClient::FailureReason::Reset);
+        return nullptr;
+      }));
+  // A failed revalidation doesn't prevent the next stale hit from trying again.
+  for (int i = 0; i < 2; i++) {
+    auto filter = makeStaleFilter();
+    EXPECT_EQ(filter->decodeHeaders(request_headers_, true),
+              Http::FilterHeadersStatus::StopAllIterationAndWatermark);
+    filter->onDestroy();
+  }
+  EXPECT_EQ(2, counter("started"));
+  EXPECT_EQ(2, counter("failed"));
+}
+
+TEST_F(StaleResponseTest, ServedOnError) {
+  request_headers_.setHost("ServedOnError");
+  const std::string body = "abc";
+  insertStaleResponse("public, max-age=10, stale-if-error=60", body);
+
+  // Without stale-while-revalidate, the stale response is validated on the request path.
+  auto filter = makeStaleFilter();
+  EXPECT_CALL(cm_.async_client_, send_(_, _, _)).Times(0);
+  EXPECT_EQ(filter->decodeHeaders(request_headers_, true), Http::FilterHeadersStatus::Continue);
+
+  // The validation fails, so the cached response is served in place of the error.
+  Http::TestResponseHeaderMapImpl error_response_headers{{":status", "503"},
+                                                         {"content-length", "5"}};
+  EXPECT_CALL(
+      encoder_callbacks_,
+      addEncodedData(testing::Property(&Buffer::Instance::toString, testing::Eq(body)), true));
+  EXPECT_EQ(filter->encodeHeaders(error_response_headers, false),
+            Http::FilterHeadersStatus::Continue);
+  EXPECT_THAT(error_response_headers,
+              testing::AllOf(HeaderHasValueRef(":status", "200"),
+                             HeaderHasValueRef("etag", "abc123"),
+                             HeaderHasValueRef("content-length", "3")));
+
+  Buffer::OwnedImpl error_body("error");
+  EXPECT_EQ(filter->encodeData(error_body, true), Http::FilterDataStatus::Continue);
+  EXPECT_EQ(0, error_body.length());
+  EXPECT_EQ(1, counter("served_stale_on_error"));
+  filter->onDestroy();
+}
+
+TEST_F(StaleResponseTest, ErrorServedPastStaleIfError) {
+  request_headers_.setHost("ErrorServedPastStaleIfError");
+  insertStaleResponse("public, max-age=10, stale-if-error=5", "abc");
+
+  auto filter = makeStaleFilter();
+  EXPECT_EQ(filter->decodeHeaders(request_headers_, true), Http::FilterHeadersStatus::Continue);
+
+  Http::TestResponseHeaderMapImpl error_response_headers{{":status", "503"}};
+  EXPECT_CALL(encoder_callbacks_, addEncodedData).Times(0);
+  EXPECT_EQ(filter->encodeHeaders(error_response_headers, true),
+            Http::FilterHeadersStatus::Continue);
+  EXPECT_THAT(error_response_headers, HeaderHasValueRef(":status", "503"));
+  EXPECT_EQ(0, counter("served_stale_on_error"));
+  filter->onDestroy();
+}
+
 } // namespace
 } // namespace Cache
 } // namespace HttpFilters
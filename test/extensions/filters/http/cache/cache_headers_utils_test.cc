@@ -36,13 +36,17 @@ struct TestRequestCacheControl : public RequestCacheControl {
 
 struct TestResponseCacheControl : public ResponseCacheControl {
   TestResponseCacheControl(bool must_validate, bool no_store, bool no_transform, bool no_stale,
-                           bool is_public, OptionalDuration max_age) {
+                           bool is_public, OptionalDuration max_age,
+                           OptionalDuration stale_while_revalidate = absl::nullopt,
+                           OptionalDuration stale_if_error = absl::nullopt) {
     must_validate_ = must_validate;
     no_store_ = no_store;
     no_transform_ = no_transform;
     no_stale_ = no_stale;
     is_public_ = is_public;
     max_age_ = max_age;
+    stale_while_revalidate_ = stale_while_revalidate;
+    stale_if_error_ = stale_if_error;
   }
 };
 
@@ -264,6 +268,28 @@ public:
           // {must_validate_, no_store_, no_transform_, no_stale_, is_public_, max_age_}
           {true, true, false, false, false, std::chrono::seconds(10)}
         },
+        // RFC 5861 extensions
+        {
+          "max-age=600, stale-while-revalidate=30, stale-if-error=86400",
+          // {must_validate_, no_store_, no_transform_, no_stale_, is_public_, max_age_,
+          //  stale_while_revalidate_, stale_if_error_}
+          {false, false, false, false, false, std::chrono::seconds(600), std::chrono::seconds(30),
+           std::chrono::seconds(86400)}
+        },
+        {
+          "public, max-age=60, stale-while-revalidate=\"10\"",
+          // {must_validate_, no_store_, no_transform_, no_stale_, is_public_, max_age_,
+          //  stale_while_revalidate_, stale_if_error_}
+          {false, false, false, false, true, std::chrono::seconds(60), std::chrono::seconds(10),
+           absl::nullopt}
+        },
+        {
+          "max-age=60, stale-while-revalidate, stale-if-error=ten",
+          // {must_validate_, no_store_, no_transform_, no_stale_, is_public_, max_age_,
+          //  stale_while_revalidate_, stale_if_error_}
+          {false, false, false, false, false, std::chrono::seconds(60), absl::nullopt,
+           absl::nullopt}
+        },
     );
     // clang-format on
   }
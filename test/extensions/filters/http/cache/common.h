@@ -21,9 +21,10 @@ public:
         SimpleHttpCache::makeLookupContext(std::move(request)),
         DelayedCallbacks{delayed_headers_cb_, delayed_body_cb_, delayed_trailers_cb_});
   }
-  InsertContextPtr makeInsertContext(LookupContextPtr&& lookup_context) override {
+  InsertContextPtr makeInsertContext(LookupContextPtr&& lookup_context,
+                                     Event::Dispatcher& dispatcher) override {
     return SimpleHttpCache::makeInsertContext(
-        std::move(dynamic_cast<DelayedLookupContext&>(*lookup_context).context_));
+        std::move(dynamic_cast<DelayedLookupContext&>(*lookup_context).context_), dispatcher);
   }
 
   std::function<void()> delayed_headers_cb_, delayed_body_cb_, delayed_trailers_cb_;
@@ -114,6 +115,8 @@ std::ostream& operator<<(std::ostream& os, CacheEntryStatus status) {
     return os << "Unusable";
   case CacheEntryStatus::RequiresValidation:
     return os << "RequiresValidation";
+  case CacheEntryStatus::StaleWhileRevalidate:
+    return os << "StaleWhileRevalidate";
   case CacheEntryStatus::FoundNotModified:
     return os << "FoundNotModified";
   case CacheEntryStatus::SatisfiableRange:
@@ -0,0 +1,305 @@
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <fstream>
+
+#include "envoy/http/header_map.h"
+#include "envoy/registry/registry.h"
+
+#include "common/buffer/buffer_impl.h"
+#include "common/filesystem/directory.h"
+
+#include "source/extensions/filters/http/cache/disk_http_cache/config.pb.h"
+
+#include "extensions/filters/http/cache/cache_headers_utils.h"
+#include "extensions/filters/http/cache/disk_http_cache/disk_http_cache.h"
+
+#include "test/extensions/filters/http/cache/common.h"
+#include "test/mocks/server/factory_context.h"
+#include "test/test_common/environment.h"
+#include "test/test_common/simulated_time_system.h"
+#include "test/test_common/thread_factory_for_test.h"
+#include "test/test_common/utility.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Cache {
+namespace {
+
+class DiskHttpCacheTest : public testing::Test {
+protected:
+  DiskHttpCacheTest()
+      : api_(Api::createApiForTest()), dispatcher_(api_->allocateDispatcher("test_thread")),
+        cache_path_(TestEnvironment::temporaryPath("disk_http_cache_test")) {
+    TestEnvironment::removePath(cache_path_);
+    TestEnvironment::createPath(cache_path_);
+    cache_ = makeCache(1024 * 1024);
+    request_headers_.setMethod("GET");
+    request_headers_.setHost("example.com");
+    request_headers_.setForwardedProto("https");
+    request_headers_.setCopy(Http::CustomHeaders::get().CacheControl, "max-age=3600");
+  }
+
+  ~DiskHttpCacheTest() override {
+    cache_.reset();
+    TestEnvironment::removePath(cache_path_);
+  }
+
+  std::unique_ptr<DiskHttpCache> makeCache(uint64_t max_size_bytes) {
+    return std::make_unique<DiskHttpCache>(cache_path_, max_size_bytes, 2, api_->threadFactory());
+  }
+
+  // Waits for the cache to finish writing, and runs the callbacks it posted.
+  void waitForIo() {
+    cache_->ioThreads().drain();
+    dispatcher_->run(Event::Dispatcher::RunType::NonBlock);
+  }
+
+  // Returns the names of the files in the cache directory.
+  std::vector<std::string> cacheFiles() {
+    std::vector<std::string> files;
+    for (const Filesystem::DirectoryEntry& entry : Filesystem::Directory(cache_path_)) {
+      if (entry.type_ == Filesystem::FileType::Regular) {
+        files.push_back(entry.name_);
+      }
+    }
+    return files;
+  }
+
+  // Returns the inode of the only entry file in the cache directory.
+  uint64_t entryInode() {
+    const std::vector<std::string> files = cacheFiles();
+    EXPECT_EQ(1, files.size());
+    struct stat file_stat;
+    EXPECT_EQ(0, ::stat(absl::StrCat(cache_path_, "/", files[0]).c_str(), &file_stat));
+    return file_stat.st_ino;
+  }
+
+  // Performs a cache lookup.
+  LookupContextPtr lookup(absl::string_view request_path) {
+    request_headers_.setPath(request_path);
+    LookupContextPtr context =
+        cache_->makeLookupContext(LookupRequest(request_headers_, current_time_));
+    context->getHeaders([this](LookupResult&& result) { lookup_result_ = std::move(result); });
+    return context;
+  }
+
+  // Inserts a value into the cache.
+  void insert(absl::string_view request_path, const absl::string_view response_body) {
+    InsertContextPtr inserter = cache_->makeInsertContext(lookup(request_path), *dispatcher_);
+    inserter->insertHeaders(response_headers_, false);
+    inserter->insertBody(Buffer::OwnedImpl(response_body), nullptr, true);
+    waitForIo();
+  }
+
+  std::string getBody(LookupContext& context, uint64_t start, uint64_t end) {
+    AdjustedByteRange range(start, end);
+    std::string body;
+    context.getBody(range, [&body](Buffer::InstancePtr&& data) {
+      EXPECT_NE(data, nullptr);
+      if (data) {
+        body = data->toString();
+      }
+    });
+    return body;
+  }
+
+  Api::ApiPtr api_;
+  Event::DispatcherPtr dispatcher_;
+  const std::string cache_path_;
+  std::unique_ptr<DiskHttpCache> cache_;
+  Event::SimulatedTimeSystem time_source_;
+  SystemTime current_time_ = time_source_.systemTime();
+  DateFormatter formatter_{"%a, %d %b %Y %H:%M:%S GMT"};
+  const Http::TestResponseHeaderMapImpl response_headers_{
+      {"date", formatter_.fromTime(current_time_)}, {"cache-control", "public,max-age=3600"}};
+  LookupResult lookup_result_;
+  Http::TestRequestHeaderMapImpl request_headers_;
+};
+
+TEST_F(DiskHttpCacheTest, PutGet) {
+  lookup("/name");
+  EXPECT_EQ(CacheEntryStatus::Unusable, lookup_result_.cache_entry_status_);
+
+  insert("/name", "Value");
+  LookupContextPtr context = lookup("/name");
+  EXPECT_EQ(CacheEntryStatus::Ok, lookup_result_.cache_entry_status_);
+  ASSERT_NE(nullptr, lookup_result_.headers_);
+  EXPECT_EQ("public,max-age=3600", lookup_result_.headers_
+                                       ->get(Http::CustomHeaders::get().CacheControl)
+                                       ->value()
+                                       .getStringView());
+  ASSERT_EQ(5, lookup_result_.content_length_);
+  EXPECT_EQ("Value", getBody(*context, 0, 5));
+
+  insert("/name", "NewValue");
+  context = lookup("/name");
+  EXPECT_EQ("NewValue", getBody(*context, 0, 8));
+  EXPECT_EQ(1, cache_->entryCount());
+}
+
+TEST_F(DiskHttpCacheTest, StreamingPutAndRangeRead) {
+  InsertContextPtr inserter = cache_->makeInsertContext(lookup("/path"), *dispatcher_);
+  inserter->insertHeaders(response_headers_, false);
+  bool ready_for_next_chunk = false;
+  inserter->insertBody(
+      Buffer::OwnedImpl("Hello, "),
+      [&ready_for_next_chunk](bool ready) { ready_for_next_chunk = ready; }, false);
+  // Readiness is signalled from the dispatcher once the chunk has been written.
+  EXPECT_FALSE(ready_for_next_chunk);
+  waitForIo();
+  EXPECT_TRUE(ready_for_next_chunk);
+  // Nothing is visible until the insertion completes.
+  lookup("/path");
+  EXPECT_EQ(CacheEntryStatus::Unusable, lookup_result_.cache_entry_status_);
+  inserter->insertBody(Buffer::OwnedImpl("World!"), nullptr, true);
+  waitForIo();
+
+  LookupContextPtr context = lookup("/path");
+  EXPECT_EQ(CacheEntryStatus::Ok, lookup_result_.cache_entry_status_);
+  ASSERT_EQ(13, lookup_result_.content_length_);
+  EXPECT_EQ("World", getBody(*context, 7, 12));
+}
+
+TEST_F(DiskHttpCacheTest, InsertCompleteOnceCommitted) {
+  InsertContextPtr inserter = cache_->makeInsertContext(lookup("/path"), *dispatcher_);
+  inserter->insertHeaders(response_headers_, false);
+  inserter->insertBody(Buffer::OwnedImpl("Value"), nullptr, true);
+  bool complete = false;
+  uint64_t entry_count = 0;
+  inserter->onInsertComplete([this, &complete, &entry_count]() {
+    complete = true;
+    entry_count = cache_->entryCount();
+  });
+  // The commit doesn't depend on the insertion being kept around.
+  inserter.reset();
+  waitForIo();
+  EXPECT_TRUE(complete);
+  EXPECT_EQ(1, entry_count);
+}
+
+TEST_F(DiskHttpCacheTest, AbandonedInsertLeavesNoEntry) {
+  InsertContextPtr inserter = cache_->makeInsertContext(lookup("/path"), *dispatcher_);
+  inserter->insertHeaders(response_headers_, false);
+  inserter->insertBody(
+      Buffer::OwnedImpl("partial"),
+      [](bool) { FAIL() << "Called after the insertion was dropped"; }, false);
+  inserter.reset();
+  waitForIo();
+  lookup("/path");
+  EXPECT_EQ(CacheEntryStatus::Unusable, lookup_result_.cache_entry_status_);
+  EXPECT_EQ(0, cache_->entryCount());
+  EXPECT_TRUE(cacheFiles().empty());
+}
+
+// Temporary files are only removed at startup if the process writing them is gone, so that a
+// hot restarted Envoy doesn't remove the files its parent is still writing.
+TEST_F(DiskHttpCacheTest, RemovesOnlyOrphanedTempFiles) {
+  const std::string live_parent =
+      absl::StrCat("0000000000000001.cache.tmp.", ::getppid(), ".0");
+  // Larger than any pid.
+  const std::string orphaned = "0000000000000002.cache.tmp.2147483647.0";
+  const std::string own_pid = absl::StrCat("0000000000000003.cache.tmp.", ::getpid(), ".0");
+  for (const std::string& name : {live_parent, orphaned, own_pid}) {
+    std::ofstream(absl::StrCat(cache_path_, "/", name)) << "partial";
+  }
+  cache_ = makeCache(1024 * 1024);
+  EXPECT_EQ(std::vector<std::string>{live_parent}, cacheFiles());
+  EXPECT_EQ(0, cache_->entryCount());
+}
+
+// Entries written by one instance are found by a later instance using the same directory.
+TEST_F(DiskHttpCacheTest, SurvivesRestart) {
+  insert("/name", "Value");
+  cache_ = makeCache(1024 * 1024);
+  EXPECT_EQ(1, cache_->entryCount());
+  LookupContextPtr context = lookup("/name");
+  EXPECT_EQ(CacheEntryStatus::Ok, lookup_result_.cache_entry_status_);
+  EXPECT_EQ("Value", getBody(*context, 0, 5));
+}
+
+TEST_F(DiskHttpCacheTest, EvictsLeastRecentlyUsed) {
+  cache_ = makeCache(16 * 1024);
+  const std::string body(1000, 'x');
+  insert("/a", body);
+  insert("/b", body);
+  insert("/c", body);
+  lookup("/a");
+  insert("/d", body);
+  EXPECT_LE(cache_->sizeBytes(), 16 * 1024);
+  lookup("/b");
+  EXPECT_EQ(CacheEntryStatus::Unusable, lookup_result_.cache_entry_status_);
+  lookup("/a");
+  EXPECT_EQ(CacheEntryStatus::Ok, lookup_result_.cache_entry_status_);
+}
+
+TEST_F(DiskHttpCacheTest, UpdateHeaders) {
+  insert("/", "Value");
+  LookupContextPtr context = lookup("/");
+  Http::TestResponseHeaderMapImpl new_headers{{"date", formatter_.fromTime(current_time_)},
+                                              {"cache-control", "public,max-age=7200"},
+                                              {"etag", "abc"}};
+  const uint64_t inode = entryInode();
+  cache_->updateHeaders(*context, new_headers);
+  waitForIo();
+  // The body already handed to this lookup is unaffected.
+  EXPECT_EQ("Value", getBody(*context, 0, 5));
+
+  context = lookup("/");
+  ASSERT_NE(nullptr, lookup_result_.headers_);
+  EXPECT_EQ("abc", lookup_result_.headers_->get(Http::LowerCaseString("etag"))
+                       ->value()
+                       .getStringView());
+  EXPECT_EQ("Value", getBody(*context, 0, 5));
+  // The headers were replaced within the existing file.
+  EXPECT_EQ(inode, entryInode());
+}
+
+TEST_F(DiskHttpCacheTest, UpdateHeadersLargerThanHeadersRegion) {
+  insert("/", "Value");
+  LookupContextPtr context = lookup("/");
+  const std::string large_value(8192, 'a');
+  Http::TestResponseHeaderMapImpl new_headers{{"date", formatter_.fromTime(current_time_)},
+                                              {"cache-control", "public,max-age=7200"},
+                                              {"etag", large_value}};
+  const uint64_t inode = entryInode();
+  cache_->updateHeaders(*context, new_headers);
+  waitForIo();
+
+  context = lookup("/");
+  ASSERT_NE(nullptr, lookup_result_.headers_);
+  EXPECT_EQ(large_value, lookup_result_.headers_->get(Http::LowerCaseString("etag"))
+                             ->value()
+                             .getStringView());
+  EXPECT_EQ("Value", getBody(*context, 0, 5));
+  // The entry had to be rewritten.
+  EXPECT_NE(inode, entryInode());
+  EXPECT_EQ(1, cache_->entryCount());
+}
+
+TEST(Registration, GetFactory) {
+  HttpCacheFactory* factory = Registry::FactoryRegistry<HttpCacheFactory>::getFactoryByType(
+      "envoy.source.extensions.filters.http.cache.DiskHttpCacheConfig");
+  ASSERT_NE(factory, nullptr);
+  testing::NiceMock<Server::Configuration::MockFactoryContext> factory_context;
+  ON_CALL(factory_context.api_, threadFactory())
+      .WillByDefault(testing::ReturnRef(Thread::threadFactoryForTest()));
+  envoy::extensions::filters::http::cache::v3alpha::CacheConfig config;
+  envoy::source::extensions::filters::http::cache::DiskHttpCacheConfig disk_config;
+  config.mutable_typed_config()->PackFrom(disk_config);
+  EXPECT_THROW(factory->getCache(config, factory_context), EnvoyException);
+
+  disk_config.set_cache_path(TestEnvironment::temporaryDirectory());
+  config.mutable_typed_config()->PackFrom(disk_config);
+  EXPECT_EQ(factory->getCache(config, factory_context).cacheInfo().name_,
+            "envoy.extensions.http.cache.disk");
+}
+
+} // namespace
+} // namespace Cache
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -144,6 +144,43 @@ public:
                             /*request_time=*/currentTime() + Seconds(999),
                             /*response_time=*/currentTime(),
                             /*expected_result=*/CacheEntryStatus::Ok},
+                           {"fresh_with_stale_while_revalidate",
+                            /*request_cache_control=*/"",
+                            /*response_cache_control=*/"max-age=1000, stale-while-revalidate=100",
+                            /*request_time=*/currentTime() + Seconds(999),
+                            /*response_time=*/currentTime(),
+                            /*expected_result=*/CacheEntryStatus::Ok},
+                           {"expired_stale_while_revalidate_satisfied",
+                            /*request_cache_control=*/"",
+                            /*response_cache_control=*/"max-age=1000, stale-while-revalidate=100",
+                            /*request_time=*/currentTime() + Seconds(1099),
+                            /*response_time=*/currentTime(),
+                            /*expected_result=*/CacheEntryStatus::StaleWhileRevalidate},
+                           {"expired_stale_while_revalidate_unsatisfied",
+                            /*request_cache_control=*/"",
+                            /*response_cache_control=*/"max-age=1000, stale-while-revalidate=100",
+                            /*request_time=*/currentTime() + Seconds(1101),
+                            /*response_time=*/currentTime(),
+                            /*expected_result=*/CacheEntryStatus::RequiresValidation},
+                           {"expired_stale_while_revalidate_satisfied_but_response_must_revalidate",
+                            /*request_cache_control=*/"",
+                            /*response_cache_control=*/
+                            "max-age=1000, stale-while-revalidate=100, must-revalidate",
+                            /*request_time=*/currentTime() + Seconds(1099),
+                            /*response_time=*/currentTime(),
+                            /*expected_result=*/CacheEntryStatus::RequiresValidation},
+                           {"expired_stale_while_revalidate_satisfied_but_request_no_cache",
+                            /*request_cache_control=*/"no-cache",
+                            /*response_cache_control=*/"max-age=1000, stale-while-revalidate=100",
+                            /*request_time=*/currentTime() + Seconds(1099),
+                            /*response_time=*/currentTime(),
+                            /*expected_result=*/CacheEntryStatus::RequiresValidation},
+                           {"expired_max_stale_satisfied_with_stale_while_revalidate",
+                            /*request_cache_control=*/"max-stale=500",
+                            /*response_cache_control=*/"max-age=1000, stale-while-revalidate=100",
+                            /*request_time=*/currentTime() + Seconds(1099),
+                            /*response_time=*/currentTime(),
+                            /*expected_result=*/CacheEntryStatus::Ok},
 
     );
   }
@@ -198,6 +235,36 @@ TEST_P(LookupRequestTest, ResultWithBodyMatchesExpectation) {
   EXPECT_FALSE(lookup_response.has_trailers_);
 }
 
+TEST_F(LookupRequestTest, StaleIfErrorSatisfied) {
+  const LookupRequest lookup_request(request_headers_, currentTime() + Seconds(15));
+  const Http::TestResponseHeaderMapImpl response_headers(
+      {{"date", formatter_.fromTime(currentTime())},
+       {"cache-control", "public, max-age=10, stale-if-error=10"}});
+  const LookupResult lookup_response = makeLookupResult(lookup_request, response_headers);
+  EXPECT_EQ(CacheEntryStatus::RequiresValidation, lookup_response.cache_entry_status_);
+  EXPECT_TRUE(lookup_response.serve_stale_on_error_);
+}
+
+TEST_F(LookupRequestTest, StaleIfErrorUnsatisfied) {
+  const LookupRequest lookup_request(request_headers_, currentTime() + Seconds(25));
+  const Http::TestResponseHeaderMapImpl response_headers(
+      {{"date", formatter_.fromTime(currentTime())},
+       {"cache-control", "public, max-age=10, stale-if-error=10"}});
+  const LookupResult lookup_response = makeLookupResult(lookup_request, response_headers);
+  EXPECT_EQ(CacheEntryStatus::RequiresValidation, lookup_response.cache_entry_status_);
+  EXPECT_FALSE(lookup_response.serve_stale_on_error_);
+}
+
+TEST_F(LookupRequestTest, StaleIfErrorWithMustRevalidate) {
+  const LookupRequest lookup_request(request_headers_, currentTime() + Seconds(15));
+  const Http::TestResponseHeaderMapImpl response_headers(
+      {{"date", formatter_.fromTime(currentTime())},
+       {"cache-control", "public, max-age=10, stale-if-error=10, must-revalidate"}});
+  const LookupResult lookup_response = makeLookupResult(lookup_request, response_headers);
+  EXPECT_EQ(CacheEntryStatus::RequiresValidation, lookup_response.cache_entry_status_);
+  EXPECT_FALSE(lookup_response.serve_stale_on_error_);
+}
+
 TEST_F(LookupRequestTest, ExpiredViaFallbackheader) {
   const LookupRequest lookup_request(request_headers_, currentTime());
   const Http::TestResponseHeaderMapImpl response_headers(
@@ -0,0 +1,229 @@
+#include "envoy/http/header_map.h"
+#include "envoy/registry/registry.h"
+
+#include "common/buffer/buffer_impl.h"
+
+#include "source/extensions/filters/http/cache/lru_http_cache/config.pb.h"
+
+#include "extensions/filters/http/cache/cache_headers_utils.h"
+#include "extensions/filters/http/cache/lru_http_cache/lru_http_cache.h"
+
+#include "test/extensions/filters/http/cache/common.h"
+#include "test/mocks/event/mocks.h"
+#include "test/mocks/server/factory_context.h"
+#include "test/test_common/simulated_time_system.h"
+#include "test/test_common/utility.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Cache {
+namespace {
+
+class LruHttpCacheTest : public testing::Test {
+protected:
+  LruHttpCacheTest() : LruHttpCacheTest(1024 * 1024, 4) {}
+  LruHttpCacheTest(uint64_t max_size_bytes, uint32_t shard_count)
+      : cache_(max_size_bytes, shard_count) {
+    request_headers_.setMethod("GET");
+    request_headers_.setHost("example.com");
+    request_headers_.setForwardedProto("https");
+    request_headers_.setCopy(Http::CustomHeaders::get().CacheControl, "max-age=3600");
+  }
+
+  // Performs a cache lookup.
+  LookupContextPtr lookup(absl::string_view request_path) {
+    LookupRequest request = makeLookupRequest(request_path);
+    LookupContextPtr context = cache_.makeLookupContext(std::move(request));
+    context->getHeaders([this](LookupResult&& result) { lookup_result_ = std::move(result); });
+    return context;
+  }
+
+  // Inserts a value into the cache.
+  void insert(LookupContextPtr lookup, const Http::TestResponseHeaderMapImpl& response_headers,
+              const absl::string_view response_body) {
+    InsertContextPtr inserter = cache_.makeInsertContext(move(lookup), dispatcher_);
+    inserter->insertHeaders(response_headers, false);
+    inserter->insertBody(Buffer::OwnedImpl(response_body), nullptr, true);
+  }
+
+  void insert(absl::string_view request_path, const absl::string_view response_body) {
+    insert(lookup(request_path), response_headers_, response_body);
+  }
+
+  std::string getBody(LookupContext& context, uint64_t start, uint64_t end) {
+    AdjustedByteRange range(start, end);
+    std::string body;
+    context.getBody(range, [&body](Buffer::InstancePtr&& data) {
+      EXPECT_NE(data, nullptr);
+      if (data) {
+        body = data->toString();
+      }
+    });
+    return body;
+  }
+
+  LookupRequest makeLookupRequest(absl::string_view request_path) {
+    request_headers_.setPath(request_path);
+    return LookupRequest(request_headers_, current_time_);
+  }
+
+  bool isCached(absl::string_view request_path) {
+    lookup(request_path);
+    return lookup_result_.cache_entry_status_ != CacheEntryStatus::Unusable;
+  }
+
+  Event::SimulatedTimeSystem time_source_;
+  testing::NiceMock<Event::MockDispatcher> dispatcher_;
+  SystemTime current_time_ = time_source_.systemTime();
+  DateFormatter formatter_{"%a, %d %b %Y %H:%M:%S GMT"};
+  const Http::TestResponseHeaderMapImpl response_headers_{
+      {"date", formatter_.fromTime(current_time_)}, {"cache-control", "public,max-age=3600"}};
+  LruHttpCache cache_;
+  LookupResult lookup_result_;
+  Http::TestRequestHeaderMapImpl request_headers_;
+};
+
+TEST_F(LruHttpCacheTest, PutGet) {
+  const std::string request_path("Name");
+  LookupContextPtr name_lookup_context = lookup(request_path);
+  EXPECT_EQ(CacheEntryStatus::Unusable, lookup_result_.cache_entry_status_);
+
+  insert(move(name_lookup_context), response_headers_, "Value");
+  name_lookup_context = lookup(request_path);
+  EXPECT_EQ(CacheEntryStatus::Ok, lookup_result_.cache_entry_status_);
+  ASSERT_EQ(5, lookup_result_.content_length_);
+  EXPECT_EQ("Value", getBody(*name_lookup_context, 0, 5));
+
+  insert(move(name_lookup_context), response_headers_, "NewValue");
+  name_lookup_context = lookup(request_path);
+  EXPECT_EQ("NewValue", getBody(*name_lookup_context, 0, 8));
+  EXPECT_EQ(1, cache_.entryCount());
+}
+
+TEST_F(LruHttpCacheTest, Miss) {
+  lookup("Name");
+  EXPECT_EQ(CacheEntryStatus::Unusable, lookup_result_.cache_entry_status_);
+  EXPECT_EQ(0, cache_.entryCount());
+  EXPECT_EQ(0, cache_.sizeBytes());
+}
+
+TEST_F(LruHttpCacheTest, StreamingPutAndRangeRead) {
+  InsertContextPtr inserter = cache_.makeInsertContext(lookup("request_path"), dispatcher_);
+  inserter->insertHeaders(response_headers_, false);
+  inserter->insertBody(
+      Buffer::OwnedImpl("Hello, "), [](bool ready) { EXPECT_TRUE(ready); }, false);
+  inserter->insertBody(Buffer::OwnedImpl("World!"), nullptr, true);
+  LookupContextPtr name_lookup_context = lookup("request_path");
+  EXPECT_EQ(CacheEntryStatus::Ok, lookup_result_.cache_entry_status_);
+  ASSERT_EQ(13, lookup_result_.content_length_);
+  EXPECT_EQ("Hello, World!", getBody(*name_lookup_context, 0, 13));
+  EXPECT_EQ("World", getBody(*name_lookup_context, 7, 12));
+}
+
+// Bodies made of several slices can be read in ranges that span slice boundaries.
+TEST_F(LruHttpCacheTest, MultiSliceRangeRead) {
+  const std::string first(20000, 'a');
+  const std::string second(20000, 'b');
+  InsertContextPtr inserter = cache_.makeInsertContext(lookup("request_path"), dispatcher_);
+  inserter->insertHeaders(response_headers_, false);
+  inserter->insertBody(
+      Buffer::OwnedImpl(first), [](bool ready) { EXPECT_TRUE(ready); }, false);
+  inserter->insertBody(Buffer::OwnedImpl(second), nullptr, true);
+  LookupContextPtr name_lookup_context = lookup("request_path");
+  ASSERT_EQ(40000, lookup_result_.content_length_);
+  EXPECT_EQ(first + second, getBody(*name_lookup_context, 0, 40000));
+  EXPECT_EQ("aaabbb", getBody(*name_lookup_context, 19997, 20003));
+  EXPECT_EQ("bbb", getBody(*name_lookup_context, 20000, 20003));
+  EXPECT_EQ("aaa", getBody(*name_lookup_context, 10000, 10003));
+}
+
+// A body handed out by getBody must outlive eviction of its entry.
+TEST_F(LruHttpCacheTest, BodyOutlivesEntry) {
+  insert("/a", "Value");
+  LookupContextPtr context = lookup("/a");
+  Buffer::InstancePtr body;
+  context->getBody(AdjustedByteRange(0, 5),
+                   [&body](Buffer::InstancePtr&& data) { body = std::move(data); });
+  insert("/a", "Replaced");
+  context.reset();
+  EXPECT_EQ("Value", body->toString());
+}
+
+TEST_F(LruHttpCacheTest, UpdateHeaders) {
+  insert("/", "Value");
+  LookupContextPtr context = lookup("/");
+  Http::TestResponseHeaderMapImpl new_headers{{"date", formatter_.fromTime(current_time_)},
+                                              {"cache-control", "public,max-age=7200"},
+                                              {"etag", "abc"}};
+  cache_.updateHeaders(*context, new_headers);
+  lookup("/");
+  ASSERT_NE(nullptr, lookup_result_.headers_);
+  EXPECT_EQ("abc", lookup_result_.headers_->get(Http::LowerCaseString("etag"))->value()
+                       .getStringView());
+}
+
+class LruHttpCacheEvictionTest : public LruHttpCacheTest {
+protected:
+  // A single shard with room for a handful of entries, so that eviction order is deterministic.
+  LruHttpCacheEvictionTest() : LruHttpCacheTest(4096, 1) {}
+};
+
+TEST_F(LruHttpCacheEvictionTest, StaysWithinBudget) {
+  const std::string body(300, 'x');
+  for (int i = 0; i < 100; ++i) {
+    insert(absl::StrCat("/", i), body);
+    EXPECT_LE(cache_.sizeBytes(), 4096);
+  }
+  EXPECT_GT(cache_.entryCount(), 0);
+  EXPECT_LT(cache_.entryCount(), 100);
+  // The most recent insert is still present; the earliest was evicted.
+  EXPECT_TRUE(isCached("/99"));
+  EXPECT_FALSE(isCached("/0"));
+}
+
+TEST_F(LruHttpCacheEvictionTest, OversizedEntryNotAdmitted) {
+  insert("/big", std::string(8192, 'x'));
+  EXPECT_FALSE(isCached("/big"));
+  EXPECT_EQ(0, cache_.sizeBytes());
+}
+
+// Entries that have been hit are protected from a scan of one-hit wonders.
+TEST_F(LruHttpCacheEvictionTest, HitEntriesSurviveScan) {
+  const std::string body(300, 'x');
+  insert("/hot", body);
+  EXPECT_TRUE(isCached("/hot"));
+  for (int i = 0; i < 100; ++i) {
+    insert(absl::StrCat("/scan", i), body);
+  }
+  EXPECT_TRUE(isCached("/hot"));
+}
+
+TEST(Registration, GetFactory) {
+  testing::NiceMock<Server::Configuration::MockFactoryContext> factory_context;
+  HttpCacheFactory* factory = Registry::FactoryRegistry<HttpCacheFactory>::getFactoryByType(
+      "envoy.source.extensions.filters.http.cache.LruHttpCacheConfig");
+  ASSERT_NE(factory, nullptr);
+  envoy::source::extensions::filters::http::cache::LruHttpCacheConfig lru_config;
+  lru_config.set_max_size_bytes(1024);
+  lru_config.set_shard_count(2);
+  envoy::extensions::filters::http::cache::v3alpha::CacheConfig config;
+  config.mutable_typed_config()->PackFrom(lru_config);
+  HttpCache& cache = factory->getCache(config, factory_context);
+  EXPECT_EQ(cache.cacheInfo().name_, "envoy.extensions.http.cache.lru");
+  EXPECT_TRUE(cache.cacheInfo().supports_range_requests_);
+  EXPECT_EQ(&cache, &factory->getCache(config, factory_context));
+
+  // A filter configured with different limits gets a cache of its own.
+  lru_config.set_max_size_bytes(2048);
+  config.mutable_typed_config()->PackFrom(lru_config);
+  EXPECT_NE(&cache, &factory->getCache(config, factory_context));
+}
+
+} // namespace
+} // namespace Cache
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
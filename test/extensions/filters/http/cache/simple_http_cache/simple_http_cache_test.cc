@@ -7,6 +7,8 @@
 #include "extensions/filters/http/cache/simple_http_cache/simple_http_cache.h"
 
 #include "test/extensions/filters/http/cache/common.h"
+#include "test/mocks/event/mocks.h"
+#include "test/mocks/server/factory_context.h"
 #include "test/test_common/simulated_time_system.h"
 #include "test/test_common/utility.h"
 
@@ -40,7 +42,7 @@ protected:
   // Inserts a value into the cache.
   void insert(LookupContextPtr lookup, const Http::TestResponseHeaderMapImpl& response_headers,
               const absl::string_view response_body) {
-    InsertContextPtr inserter = cache_.makeInsertContext(move(lookup));
+    InsertContextPtr inserter = cache_.makeInsertContext(move(lookup), dispatcher_);
     inserter->insertHeaders(response_headers, false);
     inserter->insertBody(Buffer::OwnedImpl(response_body), nullptr, true);
   }
@@ -92,6 +94,7 @@ protected:
   LookupResult lookup_result_;
   Http::TestRequestHeaderMapImpl request_headers_;
   Event::SimulatedTimeSystem time_source_;
+  testing::NiceMock<Event::MockDispatcher> dispatcher_;
   SystemTime current_time_ = time_source_.systemTime();
   DateFormatter formatter_{"%a, %d %b %Y %H:%M:%S GMT"};
 };
@@ -195,7 +198,7 @@ TEST_F(SimpleHttpCacheTest, StreamingPut) {
   Http::TestResponseHeaderMapImpl response_headers{{"date", formatter_.fromTime(current_time_)},
                                                    {"age", "2"},
                                                    {"cache-control", "public, max-age=3600"}};
-  InsertContextPtr inserter = cache_.makeInsertContext(lookup("request_path"));
+  InsertContextPtr inserter = cache_.makeInsertContext(lookup("request_path"), dispatcher_);
   inserter->insertHeaders(response_headers, false);
   inserter->insertBody(
       Buffer::OwnedImpl("Hello, "), [](bool ready) { EXPECT_TRUE(ready); }, false);
@@ -208,12 +211,14 @@ TEST_F(SimpleHttpCacheTest, StreamingPut) {
 }
 
 TEST(Registration, GetFactory) {
+  testing::NiceMock<Server::Configuration::MockFactoryContext> factory_context;
   HttpCacheFactory* factory = Registry::FactoryRegistry<HttpCacheFactory>::getFactoryByType(
       "envoy.source.extensions.filters.http.cache.SimpleHttpCacheConfig");
   ASSERT_NE(factory, nullptr);
   envoy::extensions::filters::http::cache::v3alpha::CacheConfig config;
   config.mutable_typed_config()->PackFrom(*factory->createEmptyConfigProto());
-  EXPECT_EQ(factory->getCache(config).cacheInfo().name_, "envoy.extensions.http.cache.simple");
+  EXPECT_EQ(factory->getCache(config, factory_context).cacheInfo().name_,
+            "envoy.extensions.http.cache.simple");
 }
 
 } // namespace
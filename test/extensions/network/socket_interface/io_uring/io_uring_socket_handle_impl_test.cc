@@ -0,0 +1,387 @@
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+
+#include <string>
+
+#include "envoy/extensions/network/socket_interface/io_uring/v3/io_uring_socket_interface.pb.h"
+
+#include "common/api/os_sys_calls_impl.h"
+#include "common/config/utility.h"
+#include "common/network/address_impl.h"
+#include "common/thread_local/thread_local_impl.h"
+
+#include "extensions/network/socket_interface/io_uring/io_uring_socket_handle_impl.h"
+#include "extensions/network/socket_interface/io_uring/io_uring_socket_interface.h"
+#include "extensions/network/socket_interface/io_uring/ring.h"
+
+#include "test/mocks/server/instance.h"
+#include "test/mocks/server/server_lifecycle_notifier.h"
+#include "test/test_common/threadsafe_singleton_injector.h"
+#include "test/test_common/utility.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::_;
+using testing::An;
+using testing::DoAll;
+using testing::NiceMock;
+using testing::Return;
+using testing::ReturnRef;
+using testing::SaveArg;
+
+namespace Envoy {
+namespace Extensions {
+namespace SocketInterfaces {
+namespace IoUring {
+namespace {
+
+class CountingOsSysCalls : public Api::OsSysCallsImpl {
+public:
+  Api::SysCallSizeResult readv(os_fd_t fd, const iovec* iov, int num_iov) override {
+    num_readv_++;
+    return Api::OsSysCallsImpl::readv(fd, iov, num_iov);
+  }
+
+  uint64_t num_readv_{};
+};
+
+class IoUringSocketHandleImplTest : public testing::Test {
+protected:
+  IoUringSocketHandleImplTest()
+      : api_(Api::createApiForTest()), dispatcher_(api_->allocateDispatcher("test_thread")) {
+    tls_.registerThread(*dispatcher_, true);
+  }
+
+  ~IoUringSocketHandleImplTest() override {
+    tls_.shutdownGlobalThreading();
+    extension_.reset();
+    tls_.shutdownThread();
+  }
+
+  void SetUp() override {
+    // io_uring requires Linux 5.6, which the host running the test may lack.
+    try {
+      Ring ring(8);
+    } catch (const EnvoyException& e) {
+      GTEST_SKIP() << e.what();
+    }
+
+    ON_CALL(context_, threadLocal()).WillByDefault(ReturnRef(tls_));
+    ON_CALL(context_, lifecycleNotifier()).WillByDefault(ReturnRef(lifecycle_notifier_));
+    Server::ServerLifecycleNotifier::StageCallback startup_cb;
+    EXPECT_CALL(lifecycle_notifier_,
+                registerCallback(Server::ServerLifecycleNotifier::Stage::Startup,
+                                 An<Server::ServerLifecycleNotifier::StageCallback>()))
+        .WillOnce(DoAll(SaveArg<1>(&startup_cb), Return(nullptr)));
+
+    auto& factory = Config::Utility::getAndCheckFactoryByName<
+        Server::Configuration::BootstrapExtensionFactory>(
+        "envoy.extensions.network.socket_interface.io_uring");
+    socket_interface_ = dynamic_cast<IoUringSocketInterface*>(&factory);
+    ASSERT_NE(nullptr, socket_interface_);
+    envoy::extensions::network::socket_interface::io_uring::v3::IoUringSocketInterface config;
+    config.mutable_read_buffer_size()->set_value(4096);
+    config.mutable_read_buffer_count()->set_value(NumReadBuffers);
+    extension_ = factory.createBootstrapExtension(config, context_);
+
+    // The workers are set up once the server starts.
+    EXPECT_EQ(nullptr, socket_interface_->workerForDispatcher(*dispatcher_));
+    startup_cb();
+    ASSERT_NE(nullptr, socket_interface_->workerForDispatcher(*dispatcher_));
+  }
+
+  // Connects a blocking client fd to a non blocking server fd over loopback.
+  void connectedPair(os_fd_t& client_fd, os_fd_t& server_fd) {
+    const os_fd_t listen_fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t addr_len = sizeof(addr);
+    ASSERT_EQ(0, ::bind(listen_fd, reinterpret_cast<sockaddr*>(&addr), addr_len));
+    ASSERT_EQ(0, ::getsockname(listen_fd, reinterpret_cast<sockaddr*>(&addr), &addr_len));
+    ASSERT_EQ(0, ::listen(listen_fd, 1));
+    client_fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    ASSERT_EQ(0, ::connect(client_fd, reinterpret_cast<sockaddr*>(&addr), addr_len));
+    server_fd = ::accept4(listen_fd, nullptr, nullptr, SOCK_NONBLOCK);
+    ASSERT_NE(-1, server_fd);
+    ::close(listen_fd);
+  }
+
+  void runUntil(const std::function<bool()>& done) {
+    while (!done()) {
+      dispatcher_->run(Event::Dispatcher::RunType::NonBlock);
+    }
+  }
+
+  // Reads until the handle would block, marking the end of the stream with <eof>.
+  static std::string readAll(Network::IoHandle& handle) {
+    std::string data;
+    while (true) {
+      char buffer[100];
+      Buffer::RawSlice slice{buffer, sizeof(buffer)};
+      Api::IoCallUint64Result result = handle.readv(sizeof(buffer), &slice, 1);
+      if (!result.ok()) {
+        EXPECT_EQ(Api::IoError::IoErrorCode::Again, result.err_->getErrorCode());
+        return data;
+      }
+      if (result.rc_ == 0) {
+        return data + "<eof>";
+      }
+      data.append(buffer, result.rc_);
+    }
+  }
+
+  static constexpr uint32_t NumReadBuffers = 4;
+
+  Api::ApiPtr api_;
+  Event::DispatcherPtr dispatcher_;
+  ThreadLocal::InstanceImpl tls_;
+  NiceMock<Server::Configuration::MockServerFactoryContext> context_;
+  NiceMock<Server::MockServerLifecycleNotifier> lifecycle_notifier_;
+  IoUringSocketInterface* socket_interface_{};
+  Server::BootstrapExtensionPtr extension_;
+  CountingOsSysCalls os_sys_calls_;
+  TestThreadsafeSingletonInjector<Api::OsSysCallsImpl> os_calls_{&os_sys_calls_};
+};
+
+// After the first read, data is read ahead and readv() makes no system call.
+TEST_F(IoUringSocketHandleImplTest, ReadsAhead) {
+  os_fd_t client_fd, server_fd;
+  connectedPair(client_fd, server_fd);
+  Network::IoHandlePtr handle = socket_interface_->socket(server_fd);
+  std::string data;
+  Event::FileEventPtr file_event = handle->createFileEvent(
+      *dispatcher_,
+      [&](uint32_t events) {
+        if (events & Event::FileReadyType::Read) {
+          data += readAll(*handle);
+        }
+      },
+      Event::FileTriggerType::Edge, Event::FileReadyType::Read | Event::FileReadyType::Write);
+  ASSERT_NE(nullptr, dynamic_cast<IoUringFileEvent*>(file_event.get()));
+
+  ASSERT_EQ(5, ::write(client_fd, "hello", 5));
+  runUntil([&data]() { return data == "hello"; });
+  EXPECT_EQ(1, os_sys_calls_.num_readv_);
+
+  ASSERT_EQ(6, ::write(client_fd, "world!", 6));
+  runUntil([&data]() { return data == "helloworld!"; });
+  ::shutdown(client_fd, SHUT_WR);
+  runUntil([&data]() { return data == "helloworld!<eof>"; });
+  EXPECT_EQ(1, os_sys_calls_.num_readv_);
+
+  file_event.reset();
+  handle->close();
+  ::close(client_fd);
+}
+
+// Data larger than the read buffers is read through all of them, and closing a handle with a read
+// in flight returns its buffer once the read is cancelled.
+TEST_F(IoUringSocketHandleImplTest, ReadsAcrossBuffers) {
+  os_fd_t client_fd, server_fd;
+  connectedPair(client_fd, server_fd);
+  Network::IoHandlePtr handle = socket_interface_->socket(server_fd);
+  std::string data;
+  Event::FileEventPtr file_event = handle->createFileEvent(
+      *dispatcher_,
+      [&](uint32_t events) {
+        if (events & Event::FileReadyType::Read) {
+          data += readAll(*handle);
+        }
+      },
+      Event::FileTriggerType::Edge, Event::FileReadyType::Read | Event::FileReadyType::Write);
+
+  std::string sent(100000, 'a');
+  for (size_t i = 0; i < sent.size(); i++) {
+    sent[i] += i % 26;
+  }
+  ASSERT_EQ(0, ::fcntl(client_fd, F_SETFL, O_NONBLOCK));
+  size_t num_sent = 0;
+  runUntil([&]() {
+    if (num_sent < sent.size()) {
+      const ssize_t rc = ::write(client_fd, sent.data() + num_sent, sent.size() - num_sent);
+      num_sent += std::max<ssize_t>(rc, 0);
+    }
+    return data.size() == sent.size();
+  });
+  EXPECT_EQ(sent, data);
+
+  handle->close();
+  file_event.reset();
+  handle.reset();
+  IoUringWorkerSharedPtr worker = socket_interface_->workerForDispatcher(*dispatcher_);
+  std::vector<uint32_t> buffers;
+  runUntil([&]() {
+    while (absl::optional<uint32_t> buffer = worker->acquireReadBuffer()) {
+      buffers.push_back(*buffer);
+    }
+    return buffers.size() == NumReadBuffers;
+  });
+  for (const uint32_t buffer : buffers) {
+    worker->releaseReadBuffer(buffer);
+  }
+  ::close(client_fd);
+}
+
+// A read queued for a handle which is closed before the read is submitted doesn't run against the
+// socket which reuses its fd number, as an accept() in the same loop iteration may.
+TEST_F(IoUringSocketHandleImplTest, CloseThenAcceptInSameIteration) {
+  os_fd_t client_fd, server_fd;
+  connectedPair(client_fd, server_fd);
+  Network::IoHandlePtr handle = socket_interface_->socket(server_fd);
+
+  // The next connection is waiting in the backlog of a listener, to be accepted once the handle
+  // is closed.
+  const os_fd_t listen_fd = ::socket(AF_INET, SOCK_STREAM, 0);
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  socklen_t addr_len = sizeof(addr);
+  ASSERT_EQ(0, ::bind(listen_fd, reinterpret_cast<sockaddr*>(&addr), addr_len));
+  ASSERT_EQ(0, ::getsockname(listen_fd, reinterpret_cast<sockaddr*>(&addr), &addr_len));
+  ASSERT_EQ(0, ::listen(listen_fd, 1));
+  const os_fd_t next_client_fd = ::socket(AF_INET, SOCK_STREAM, 0);
+  ASSERT_EQ(0, ::connect(next_client_fd, reinterpret_cast<sockaddr*>(&addr), addr_len));
+  ASSERT_EQ(5, ::write(next_client_fd, "world", 5));
+
+  std::string data;
+  os_fd_t next_server_fd = INVALID_SOCKET;
+  Event::FileEventPtr file_event = handle->createFileEvent(
+      *dispatcher_,
+      [&](uint32_t events) {
+        if (!(events & Event::FileReadyType::Read)) {
+          return;
+        }
+        // Reading until the handle would block queues a read ahead.
+        data += readAll(*handle);
+        handle->close();
+        next_server_fd = ::accept4(listen_fd, nullptr, nullptr, SOCK_NONBLOCK);
+      },
+      Event::FileTriggerType::Edge, Event::FileReadyType::Read);
+
+  ASSERT_EQ(5, ::write(client_fd, "hello", 5));
+  runUntil([&]() { return next_server_fd != INVALID_SOCKET; });
+  EXPECT_EQ("hello", data);
+  EXPECT_EQ(server_fd, next_server_fd);
+
+  // Let the queued requests be submitted and complete.
+  for (int i = 0; i < 10; i++) {
+    dispatcher_->run(Event::Dispatcher::RunType::NonBlock);
+  }
+  char buffer[16];
+  pollfd next_server{next_server_fd, POLLIN, 0};
+  ASSERT_EQ(1, ::poll(&next_server, 1, 1000));
+  EXPECT_EQ(5, ::read(next_server_fd, buffer, sizeof(buffer)));
+  EXPECT_EQ("world", std::string(buffer, 5));
+
+  file_event.reset();
+  ::close(next_server_fd);
+  ::close(next_client_fd);
+  ::close(listen_fd);
+  ::close(client_fd);
+}
+
+TEST_F(IoUringSocketHandleImplTest, ReportsPeerCloseWhileReadDisabled) {
+  os_fd_t client_fd, server_fd;
+  connectedPair(client_fd, server_fd);
+  Network::IoHandlePtr handle = socket_interface_->socket(server_fd);
+  uint32_t ready_events = 0;
+  std::string data;
+  Event::FileEventPtr file_event = handle->createFileEvent(
+      *dispatcher_,
+      [&](uint32_t events) {
+        ready_events |= events;
+        if (events & Event::FileReadyType::Read) {
+          data += readAll(*handle);
+        }
+      },
+      Event::FileTriggerType::Edge, Event::FileReadyType::Write | Event::FileReadyType::Closed);
+  runUntil([&ready_events]() { return ready_events == Event::FileReadyType::Write; });
+
+  ASSERT_EQ(5, ::write(client_fd, "hello", 5));
+  ::close(client_fd);
+  runUntil([&ready_events]() { return (ready_events & Event::FileReadyType::Closed) != 0; });
+  EXPECT_EQ("", data);
+
+  file_event->setEnabled(Event::FileReadyType::Read | Event::FileReadyType::Write);
+  runUntil([&data]() { return data == "hello<eof>"; });
+}
+
+// Consumers which read the fd directly, as TLS does, are told of readability by polls.
+TEST_F(IoUringSocketHandleImplTest, PollsForConsumersReadingTheFd) {
+  os_fd_t client_fd, server_fd;
+  connectedPair(client_fd, server_fd);
+  Network::IoHandlePtr handle = socket_interface_->socket(server_fd);
+  uint32_t num_read_events = 0;
+  Event::FileEventPtr file_event = handle->createFileEvent(
+      *dispatcher_,
+      [&](uint32_t events) {
+        if (events & Event::FileReadyType::Read) {
+          num_read_events++;
+          char buffer[100];
+          while (::read(server_fd, buffer, sizeof(buffer)) > 0) {
+          }
+        }
+      },
+      Event::FileTriggerType::Edge, Event::FileReadyType::Read | Event::FileReadyType::Write);
+
+  ASSERT_EQ(5, ::write(client_fd, "hello", 5));
+  runUntil([&num_read_events]() { return num_read_events == 1; });
+  ASSERT_EQ(5, ::write(client_fd, "hello", 5));
+  runUntil([&num_read_events]() { return num_read_events == 2; });
+  ::close(client_fd);
+  runUntil([&num_read_events]() { return num_read_events == 3; });
+  // The closed peer is only reported once.
+  dispatcher_->run(Event::Dispatcher::RunType::NonBlock);
+  EXPECT_EQ(3, num_read_events);
+  EXPECT_EQ(0, os_sys_calls_.num_readv_);
+}
+
+TEST_F(IoUringSocketHandleImplTest, FallsBackWithoutWorker) {
+  os_fd_t client_fd, server_fd;
+  connectedPair(client_fd, server_fd);
+  Network::IoHandlePtr handle = socket_interface_->socket(server_fd);
+
+  // Completions can't report readiness repeatedly.
+  Event::FileEventPtr file_event = handle->createFileEvent(
+      *dispatcher_, [](uint32_t) {}, Event::FileTriggerType::Level, Event::FileReadyType::Read);
+  EXPECT_EQ(nullptr, dynamic_cast<IoUringFileEvent*>(file_event.get()));
+  file_event.reset();
+
+  // Only the dispatcher of the thread has its worker.
+  Event::DispatcherPtr other_dispatcher = api_->allocateDispatcher("other_thread");
+  file_event = handle->createFileEvent(
+      *other_dispatcher, [](uint32_t) {}, Event::FileTriggerType::Edge,
+      Event::FileReadyType::Read);
+  EXPECT_EQ(nullptr, dynamic_cast<IoUringFileEvent*>(file_event.get()));
+  file_event.reset();
+
+  ASSERT_EQ(5, ::write(client_fd, "hello", 5));
+  runUntil([&]() { return readAll(*handle) == "hello"; });
+  ::close(client_fd);
+}
+
+TEST_F(IoUringSocketHandleImplTest, AcceptsIoUringHandles) {
+  Network::Address::InstanceConstSharedPtr address =
+      std::make_shared<Network::Address::Ipv4Instance>("127.0.0.1", 0);
+  Network::IoHandlePtr listen_handle =
+      socket_interface_->socket(Network::Socket::Type::Stream, address);
+  ASSERT_NE(nullptr, dynamic_cast<IoUringSocketHandleImpl*>(listen_handle.get()));
+  ASSERT_EQ(0, listen_handle->bind(address).rc_);
+  ASSERT_EQ(0, listen_handle->listen(1).rc_);
+
+  const os_fd_t client_fd = ::socket(AF_INET, SOCK_STREAM, 0);
+  Network::Address::InstanceConstSharedPtr local_address = listen_handle->localAddress();
+  ASSERT_EQ(0, ::connect(client_fd, local_address->sockAddr(), local_address->sockAddrLen()));
+  Network::IoHandlePtr handle = listen_handle->accept(nullptr, nullptr);
+  EXPECT_NE(nullptr, dynamic_cast<IoUringSocketHandleImpl*>(handle.get()));
+  ::close(client_fd);
+}
+
+} // namespace
+} // namespace IoUring
+} // namespace SocketInterfaces
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,263 @@
+// Compares the default socket handles with io_uring ones when proxying HTTP/1 requests over
+// loopback TCP connections, counting the system calls made per request.
+
+#include <netinet/in.h>
+
+#include <string>
+#include <vector>
+
+#include "envoy/extensions/network/socket_interface/io_uring/v3/io_uring_socket_interface.pb.h"
+
+#include "common/api/os_sys_calls_impl.h"
+#include "common/common/assert.h"
+#include "common/config/utility.h"
+#include "common/network/io_socket_handle_impl.h"
+#include "common/thread_local/thread_local_impl.h"
+
+#include "extensions/network/socket_interface/io_uring/io_uring_socket_interface.h"
+#include "extensions/network/socket_interface/io_uring/ring.h"
+
+#include "test/mocks/server/instance.h"
+#include "test/mocks/server/server_lifecycle_notifier.h"
+#include "test/test_common/threadsafe_singleton_injector.h"
+#include "test/test_common/utility.h"
+
+#include "benchmark/benchmark.h"
+
+using testing::An;
+using testing::DoAll;
+using testing::NiceMock;
+using testing::Return;
+using testing::ReturnRef;
+using testing::SaveArg;
+
+namespace Envoy {
+namespace Extensions {
+namespace SocketInterfaces {
+namespace IoUring {
+
+constexpr uint32_t NumConnections = 16;
+
+const std::string& request() {
+  CONSTRUCT_ON_FIRST_USE(std::string, "GET /speed/test HTTP/1.1\r\n"
+                                      "host: example.com\r\n"
+                                      "user-agent: speed-test\r\n"
+                                      "accept: */*\r\n"
+                                      "\r\n");
+}
+
+const std::string& response() {
+  CONSTRUCT_ON_FIRST_USE(std::string, "HTTP/1.1 200 OK\r\n"
+                                      "content-length: 1024\r\n"
+                                      "\r\n" +
+                                          std::string(1024, 'a'));
+}
+
+class CountingOsSysCalls : public Api::OsSysCallsImpl {
+public:
+  Api::SysCallSizeResult readv(os_fd_t fd, const iovec* iov, int num_iov) override {
+    num_readv_++;
+    return Api::OsSysCallsImpl::readv(fd, iov, num_iov);
+  }
+  Api::SysCallSizeResult writev(os_fd_t fd, const iovec* iov, int num_iov) override {
+    num_writev_++;
+    return Api::OsSysCallsImpl::writev(fd, iov, num_iov);
+  }
+
+  uint64_t num_readv_{};
+  uint64_t num_writev_{};
+};
+
+// Connects two non blocking fds over loopback.
+void connectedPair(os_fd_t& client_fd, os_fd_t& server_fd) {
+  const os_fd_t listen_fd = ::socket(AF_INET, SOCK_STREAM, 0);
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  socklen_t addr_len = sizeof(addr);
+  RELEASE_ASSERT(::bind(listen_fd, reinterpret_cast<sockaddr*>(&addr), addr_len) == 0, "");
+  RELEASE_ASSERT(::getsockname(listen_fd, reinterpret_cast<sockaddr*>(&addr), &addr_len) == 0, "");
+  RELEASE_ASSERT(::listen(listen_fd, 1) == 0, "");
+  client_fd = ::socket(AF_INET, SOCK_STREAM, 0);
+  RELEASE_ASSERT(::connect(client_fd, reinterpret_cast<sockaddr*>(&addr), addr_len) == 0, "");
+  RELEASE_ASSERT(::fcntl(client_fd, F_SETFL, O_NONBLOCK) == 0, "");
+  server_fd = ::accept4(listen_fd, nullptr, nullptr, SOCK_NONBLOCK);
+  RELEASE_ASSERT(server_fd != -1, "");
+  ::close(listen_fd);
+}
+
+// A client and an upstream, both driven directly through their fds, and the two handles of the
+// proxy in between.
+struct ProxiedConnection {
+  ~ProxiedConnection() {
+    downstream_event_.reset();
+    upstream_event_.reset();
+    downstream_->close();
+    upstream_->close();
+    ::close(client_fd_);
+    ::close(upstream_fd_);
+  }
+
+  os_fd_t client_fd_;
+  os_fd_t upstream_fd_;
+  Network::IoHandlePtr downstream_;
+  Network::IoHandlePtr upstream_;
+  Event::FileEventPtr downstream_event_;
+  Event::FileEventPtr upstream_event_;
+  size_t request_bytes_received_{};
+  size_t response_bytes_received_{};
+};
+
+// Forwards whatever is readable on from to to.
+void forward(Network::IoHandle& from, Network::IoHandle& to) {
+  while (true) {
+    char buffer[16384];
+    Buffer::RawSlice slice{buffer, sizeof(buffer)};
+    Api::IoCallUint64Result result = from.readv(sizeof(buffer), &slice, 1);
+    if (!result.ok() || result.rc_ == 0) {
+      return;
+    }
+    slice.len_ = result.rc_;
+    RELEASE_ASSERT(to.writev(&slice, 1).rc_ == result.rc_, "");
+  }
+}
+
+// Reads what is readable on fd, returning how much was read.
+size_t drain(os_fd_t fd) {
+  size_t num_bytes = 0;
+  char buffer[16384];
+  ssize_t rc;
+  while ((rc = ::read(fd, buffer, sizeof(buffer))) > 0) {
+    num_bytes += rc;
+  }
+  return num_bytes;
+}
+
+static void BM_Http1Proxy(benchmark::State& state) {
+  const bool use_io_uring = state.range(0) != 0;
+  state.SetLabel(use_io_uring ? "io_uring" : "default");
+  if (use_io_uring) {
+    try {
+      Ring ring(8);
+    } catch (const EnvoyException& e) {
+      state.SkipWithError(e.what());
+      return;
+    }
+  }
+
+  Api::ApiPtr api = Api::createApiForTest();
+  Event::DispatcherPtr dispatcher = api->allocateDispatcher("test_thread");
+  ThreadLocal::InstanceImpl tls;
+  tls.registerThread(*dispatcher, true);
+  CountingOsSysCalls os_sys_calls;
+  TestThreadsafeSingletonInjector<Api::OsSysCallsImpl> os_calls(&os_sys_calls);
+
+  IoUringSocketInterface* socket_interface = nullptr;
+  Server::BootstrapExtensionPtr extension;
+  if (use_io_uring) {
+    NiceMock<Server::Configuration::MockServerFactoryContext> context;
+    NiceMock<Server::MockServerLifecycleNotifier> lifecycle_notifier;
+    ON_CALL(context, threadLocal()).WillByDefault(ReturnRef(tls));
+    ON_CALL(context, lifecycleNotifier()).WillByDefault(ReturnRef(lifecycle_notifier));
+    Server::ServerLifecycleNotifier::StageCallback startup_cb;
+    ON_CALL(lifecycle_notifier,
+            registerCallback(testing::_, An<Server::ServerLifecycleNotifier::StageCallback>()))
+        .WillByDefault(DoAll(SaveArg<1>(&startup_cb), Return(nullptr)));
+    auto& factory = Config::Utility::getAndCheckFactoryByName<
+        Server::Configuration::BootstrapExtensionFactory>(
+        "envoy.extensions.network.socket_interface.io_uring");
+    socket_interface = dynamic_cast<IoUringSocketInterface*>(&factory);
+    extension = factory.createBootstrapExtension(
+        envoy::extensions::network::socket_interface::io_uring::v3::IoUringSocketInterface(),
+        context);
+    startup_cb();
+  }
+
+  std::vector<std::unique_ptr<ProxiedConnection>> connections;
+  for (uint32_t i = 0; i < NumConnections; i++) {
+    auto connection = std::make_unique<ProxiedConnection>();
+    os_fd_t downstream_fd, upstream_fd;
+    connectedPair(connection->client_fd_, downstream_fd);
+    connectedPair(upstream_fd, connection->upstream_fd_);
+    if (use_io_uring) {
+      connection->downstream_ = socket_interface->socket(downstream_fd);
+      connection->upstream_ = socket_interface->socket(upstream_fd);
+    } else {
+      connection->downstream_ = std::make_unique<Network::IoSocketHandleImpl>(downstream_fd);
+      connection->upstream_ = std::make_unique<Network::IoSocketHandleImpl>(upstream_fd);
+    }
+    ProxiedConnection& c = *connection;
+    c.downstream_event_ = c.downstream_->createFileEvent(
+        *dispatcher,
+        [&c](uint32_t events) {
+          if (events & Event::FileReadyType::Read) {
+            forward(*c.downstream_, *c.upstream_);
+          }
+        },
+        Event::FileTriggerType::Edge, Event::FileReadyType::Read | Event::FileReadyType::Write);
+    c.upstream_event_ = c.upstream_->createFileEvent(
+        *dispatcher,
+        [&c](uint32_t events) {
+          if (events & Event::FileReadyType::Read) {
+            forward(*c.upstream_, *c.downstream_);
+          }
+        },
+        Event::FileTriggerType::Edge, Event::FileReadyType::Read | Event::FileReadyType::Write);
+    connections.push_back(std::move(connection));
+  }
+  dispatcher->run(Event::Dispatcher::RunType::NonBlock);
+
+  const uint64_t start_readv = os_sys_calls.num_readv_;
+  const uint64_t start_writev = os_sys_calls.num_writev_;
+  const uint64_t start_submits =
+      use_io_uring ? socket_interface->workerForDispatcher(*dispatcher)->ring().numSubmitCalls()
+                   : 0;
+  for (auto _ : state) {
+    for (auto& connection : connections) {
+      RELEASE_ASSERT(::write(connection->client_fd_, request().data(), request().size()) ==
+                         static_cast<ssize_t>(request().size()),
+                     "");
+    }
+    uint32_t num_pending = NumConnections;
+    while (num_pending > 0) {
+      dispatcher->run(Event::Dispatcher::RunType::NonBlock);
+      for (auto& connection : connections) {
+        connection->request_bytes_received_ += drain(connection->upstream_fd_);
+        if (connection->request_bytes_received_ == request().size()) {
+          connection->request_bytes_received_ = 0;
+          RELEASE_ASSERT(::write(connection->upstream_fd_, response().data(),
+                                 response().size()) == static_cast<ssize_t>(response().size()),
+                         "");
+        }
+        connection->response_bytes_received_ += drain(connection->client_fd_);
+        if (connection->response_bytes_received_ == response().size()) {
+          connection->response_bytes_received_ = 0;
+          num_pending--;
+        }
+      }
+    }
+  }
+
+  const double num_requests = static_cast<double>(state.iterations()) * NumConnections;
+  state.counters["readv_per_request"] = (os_sys_calls.num_readv_ - start_readv) / num_requests;
+  state.counters["writev_per_request"] = (os_sys_calls.num_writev_ - start_writev) / num_requests;
+  if (use_io_uring) {
+    state.counters["io_uring_enter_per_request"] =
+        (socket_interface->workerForDispatcher(*dispatcher)->ring().numSubmitCalls() -
+         start_submits) /
+        num_requests;
+  }
+  state.SetItemsProcessed(state.iterations() * NumConnections);
+
+  connections.clear();
+  dispatcher->run(Event::Dispatcher::RunType::NonBlock);
+  tls.shutdownGlobalThreading();
+  extension.reset();
+  tls.shutdownThread();
+}
+BENCHMARK(BM_Http1Proxy)->Arg(0)->Arg(1)->Unit(benchmark::kMicrosecond);
+
+} // namespace IoUring
+} // namespace SocketInterfaces
+} // namespace Extensions
+} // namespace Envoy
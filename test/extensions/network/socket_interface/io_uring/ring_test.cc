@@ -0,0 +1,133 @@
+#include <poll.h>
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "envoy/common/exception.h"
+
+#include "extensions/network/socket_interface/io_uring/ring.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace SocketInterfaces {
+namespace IoUring {
+namespace {
+
+class RingTest : public testing::Test {
+protected:
+  void SetUp() override {
+    try {
+      ring_ = std::make_unique<Ring>(8);
+    } catch (const EnvoyException& e) {
+      GTEST_SKIP() << e.what();
+    }
+    ASSERT_EQ(0, ::socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, fds_));
+  }
+
+  void TearDown() override {
+    if (ring_ != nullptr) {
+      ::close(fds_[0]);
+      ::close(fds_[1]);
+    }
+  }
+
+  // Waits for count completions, sorted by user data.
+  std::vector<std::pair<uint64_t, int32_t>> waitForCompletions(size_t count) {
+    std::vector<std::pair<uint64_t, int32_t>> completions;
+    while (completions.size() < count) {
+      pollfd ring_fd{ring_->fd(), POLLIN, 0};
+      EXPECT_EQ(1, ::poll(&ring_fd, 1, -1));
+      ring_->forEachCompletion([&completions](uint64_t user_data, int32_t result) {
+        completions.emplace_back(user_data, result);
+      });
+    }
+    std::sort(completions.begin(), completions.end());
+    return completions;
+  }
+
+  std::unique_ptr<Ring> ring_;
+  int fds_[2];
+};
+
+TEST_F(RingTest, RecvAndPoll) {
+  uint8_t buffer[16];
+  ASSERT_TRUE(ring_->preparePoll(fds_[0], POLLIN, 1));
+  ASSERT_TRUE(ring_->prepareRecv(fds_[0], buffer, sizeof(buffer), 2));
+  EXPECT_EQ(2, ring_->numPrepared());
+  EXPECT_EQ(2, ring_->submit());
+  EXPECT_EQ(0, ring_->numPrepared());
+  EXPECT_EQ(1, ring_->numSubmitCalls());
+
+  ASSERT_EQ(5, ::write(fds_[1], "hello", 5));
+  const auto completions = waitForCompletions(2);
+  EXPECT_EQ(1, completions[0].first);
+  EXPECT_TRUE(completions[0].second & POLLIN);
+  EXPECT_EQ(2, completions[1].first);
+  EXPECT_EQ(5, completions[1].second);
+  EXPECT_EQ("hello", std::string(reinterpret_cast<char*>(buffer), 5));
+}
+
+TEST_F(RingTest, ReadFixed) {
+  uint8_t buffer[16];
+  ASSERT_EQ(0, ring_->registerBuffers({{buffer, sizeof(buffer)}}));
+  ASSERT_TRUE(ring_->prepareReadFixed(fds_[0], buffer, sizeof(buffer), 0, 1));
+  EXPECT_EQ(1, ring_->submit());
+
+  ASSERT_EQ(5, ::write(fds_[1], "hello", 5));
+  EXPECT_EQ(5, waitForCompletions(1)[0].second);
+  EXPECT_EQ("hello", std::string(reinterpret_cast<char*>(buffer), 5));
+}
+
+TEST_F(RingTest, Cancel) {
+  ASSERT_TRUE(ring_->preparePoll(fds_[0], POLLIN, 1));
+  ASSERT_TRUE(ring_->prepareCancel(1, 2));
+  EXPECT_EQ(2, ring_->submit());
+
+  const auto completions = waitForCompletions(2);
+  EXPECT_EQ(-ECANCELED, completions[0].second);
+  EXPECT_EQ(0, completions[1].second);
+}
+
+// A request discarded before it is submitted never touches its fd.
+TEST_F(RingTest, DiscardUnsubmitted) {
+  uint8_t buffer[16];
+  ASSERT_TRUE(ring_->prepareRecv(fds_[0], buffer, sizeof(buffer), 1));
+  ASSERT_TRUE(ring_->preparePoll(fds_[0], POLLIN, 2));
+  EXPECT_TRUE(ring_->discardUnsubmitted(1));
+  EXPECT_FALSE(ring_->discardUnsubmitted(3));
+  EXPECT_EQ(2, ring_->submit());
+  EXPECT_FALSE(ring_->discardUnsubmitted(2));
+
+  ASSERT_EQ(5, ::write(fds_[1], "hello", 5));
+  const auto completions = waitForCompletions(2);
+  EXPECT_EQ(1, completions[0].first);
+  EXPECT_EQ(0, completions[0].second);
+  EXPECT_EQ(2, completions[1].first);
+  EXPECT_TRUE(completions[1].second & POLLIN);
+  EXPECT_EQ(5, ::read(fds_[0], buffer, sizeof(buffer)));
+}
+
+// Preparing into a full submission queue submits the prepared requests first.
+TEST_F(RingTest, SubmitsWhenFull) {
+  for (uint64_t i = 0; i < 8; i++) {
+    ASSERT_TRUE(ring_->preparePoll(fds_[0], POLLIN, i));
+  }
+  EXPECT_EQ(0, ring_->numSubmitCalls());
+  ASSERT_TRUE(ring_->preparePoll(fds_[0], POLLIN, 8));
+  EXPECT_EQ(1, ring_->numSubmitCalls());
+  EXPECT_EQ(1, ring_->numPrepared());
+  EXPECT_EQ(1, ring_->submit());
+
+  ASSERT_EQ(1, ::write(fds_[1], "a", 1));
+  EXPECT_EQ(9, waitForCompletions(9).size());
+}
+
+} // namespace
+} // namespace IoUring
+} // namespace SocketInterfaces
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,96 @@
+#include "envoy/extensions/resource_monitors/buffer_memory/v3/buffer_memory.pb.h"
+
+#include "common/buffer/buffer_impl.h"
+#include "common/buffer/watermark_buffer.h"
+
+#include "extensions/resource_monitors/buffer_memory/buffer_memory_monitor.h"
+
+#include "absl/types/optional.h"
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace ResourceMonitors {
+namespace BufferMemoryMonitor {
+namespace {
+
+class ResourcePressure : public Server::ResourceMonitor::Callbacks {
+public:
+  void onSuccess(const Server::ResourceUsage& usage) override {
+    pressure_ = usage.resource_pressure_;
+  }
+
+  void onFailure(const EnvoyException& error) override { error_ = error; }
+
+  bool hasPressure() const { return pressure_.has_value(); }
+  bool hasError() const { return error_.has_value(); }
+
+  double pressure() const { return *pressure_; }
+
+private:
+  absl::optional<double> pressure_;
+  absl::optional<EnvoyException> error_;
+};
+
+TEST(BufferMemoryMonitorTest, ComputesUsageOfAllFactories) {
+  envoy::extensions::resource_monitors::buffer_memory::v3::BufferMemoryConfig config;
+  config.set_max_buffer_memory_bytes(1000);
+  BufferMemoryMonitor monitor(config);
+
+  // Accounts may be charged by other factories of the test binary, so usage is compared against a
+  // baseline.
+  ResourcePressure baseline;
+  monitor.updateResourceUsage(baseline);
+  ASSERT_TRUE(baseline.hasPressure());
+
+  Buffer::WatermarkBufferFactory factory1;
+  Buffer::WatermarkBufferFactory factory2;
+  Buffer::BufferMemoryAccountSharedPtr account1 = factory1.createAccount(nullptr);
+  Buffer::BufferMemoryAccountSharedPtr account2 = factory2.createAccount(nullptr);
+  account1->charge(300);
+  account2->charge(200);
+
+  ResourcePressure resource;
+  monitor.updateResourceUsage(resource);
+  EXPECT_TRUE(resource.hasPressure());
+  EXPECT_FALSE(resource.hasError());
+  EXPECT_DOUBLE_EQ(baseline.pressure() + 0.5, resource.pressure());
+
+  account1->credit(300);
+  account2->credit(200);
+  ResourcePressure released;
+  monitor.updateResourceUsage(released);
+  EXPECT_DOUBLE_EQ(baseline.pressure(), released.pressure());
+}
+
+TEST(BufferMemoryMonitorTest, CountsBufferedSlices) {
+  envoy::extensions::resource_monitors::buffer_memory::v3::BufferMemoryConfig config;
+  config.set_max_buffer_memory_bytes(1024 * 1024);
+  BufferMemoryMonitor monitor(config);
+
+  ResourcePressure baseline;
+  monitor.updateResourceUsage(baseline);
+
+  Buffer::WatermarkBufferFactory factory;
+  Buffer::BufferMemoryAccountSharedPtr account = factory.createAccount(nullptr);
+  {
+    Buffer::OwnedImpl buffer;
+    buffer.bindAccount(account);
+    buffer.add(std::string(256 * 1024, 'a'));
+
+    ResourcePressure resource;
+    monitor.updateResourceUsage(resource);
+    EXPECT_GE(resource.pressure(), baseline.pressure() + 0.25);
+  }
+
+  ResourcePressure released;
+  monitor.updateResourceUsage(released);
+  EXPECT_DOUBLE_EQ(baseline.pressure(), released.pressure());
+  EXPECT_EQ(0, account->balance());
+}
+
+} // namespace
+} // namespace BufferMemoryMonitor
+} // namespace ResourceMonitors
+} // namespace Extensions
+} // namespace Envoy
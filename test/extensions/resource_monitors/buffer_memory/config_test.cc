@@ -0,0 +1,54 @@
+#include "envoy/extensions/resource_monitors/buffer_memory/v3/buffer_memory.pb.h"
+#include "envoy/extensions/resource_monitors/buffer_memory/v3/buffer_memory.pb.validate.h"
+#include "envoy/registry/registry.h"
+
+#include "server/resource_monitor_config_impl.h"
+
+#include "extensions/resource_monitors/buffer_memory/config.h"
+
+#include "test/mocks/event/mocks.h"
+#include "test/test_common/utility.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace ResourceMonitors {
+namespace BufferMemoryMonitor {
+namespace {
+
+TEST(BufferMemoryMonitorFactoryTest, CreateMonitor) {
+  auto factory =
+      Registry::FactoryRegistry<Server::Configuration::ResourceMonitorFactory>::getFactory(
+          "envoy.resource_monitors.buffer_memory");
+  EXPECT_NE(factory, nullptr);
+
+  envoy::extensions::resource_monitors::buffer_memory::v3::BufferMemoryConfig config;
+  config.set_max_buffer_memory_bytes(1024 * 1024);
+  Event::MockDispatcher dispatcher;
+  Api::ApiPtr api = Api::createApiForTest();
+  Server::Configuration::ResourceMonitorFactoryContextImpl context(
+      dispatcher, *api, ProtobufMessage::getStrictValidationVisitor());
+  auto monitor = factory->createResourceMonitor(config, context);
+  EXPECT_NE(monitor, nullptr);
+}
+
+TEST(BufferMemoryMonitorFactoryTest, RejectsZeroMaximum) {
+  auto factory =
+      Registry::FactoryRegistry<Server::Configuration::ResourceMonitorFactory>::getFactory(
+          "envoy.resource_monitors.buffer_memory");
+  ASSERT_NE(factory, nullptr);
+
+  envoy::extensions::resource_monitors::buffer_memory::v3::BufferMemoryConfig config;
+  Event::MockDispatcher dispatcher;
+  Api::ApiPtr api = Api::createApiForTest();
+  Server::Configuration::ResourceMonitorFactoryContextImpl context(
+      dispatcher, *api, ProtobufMessage::getStrictValidationVisitor());
+  EXPECT_THROW(factory->createResourceMonitor(config, context), ProtoValidationException);
+}
+
+} // namespace
+} // namespace BufferMemoryMonitor
+} // namespace ResourceMonitors
+} // namespace Extensions
+} // namespace Envoy
@@ -25,17 +25,20 @@ public:
   Network::Connection& connection() override { return connection_; }
   bool shouldDrainReadBuffer() override { return false; }
   void setReadBufferReady() override { set_read_buffer_ready_ = true; }
+  void onSocketRead(uint64_t bytes_read) override { bytes_read_ += bytes_read; }
   void raiseEvent(Network::ConnectionEvent) override { event_raised_ = true; }
   void flushWriteBuffer() override { write_buffer_flushed_ = true; }
 
   bool event_raised() const { return event_raised_; }
   bool set_read_buffer_ready() const { return set_read_buffer_ready_; }
   bool write_buffer_flushed() const { return write_buffer_flushed_; }
+  uint64_t bytes_read() const { return bytes_read_; }
 
 private:
   bool event_raised_{false};
   bool set_read_buffer_ready_{false};
   bool write_buffer_flushed_{false};
+  uint64_t bytes_read_{0};
   Network::IoHandlePtr io_handle_;
   Network::Connection& connection_;
 };
@@ -61,6 +64,9 @@ TEST_F(NoOpTransportSocketCallbacksTest, TestAllCallbacks) {
   EXPECT_FALSE(wrapper_callbacks_.event_raised());
   wrapped_callbacks_.flushWriteBuffer();
   EXPECT_FALSE(wrapper_callbacks_.write_buffer_flushed());
+  // Reads are still reported, for the read stats of the connection.
+  wrapped_callbacks_.onSocketRead(10);
+  EXPECT_EQ(10, wrapper_callbacks_.bytes_read());
 }
 
 } // namespace
@@ -165,6 +165,20 @@ TEST_P(IntegrationAdminTest, Admin) {
   EXPECT_EQ("text/plain; charset=UTF-8", ContentType(response));
   EXPECT_THAT(response->body(), testing::HasSubstr("Lookup tracking is not enabled"));
 
+  // Central cache lock profiling is off by default, though thread cache misses are always counted.
+  EXPECT_EQ("200", request("admin", "GET", "/stats/cacheprofile", response));
+  EXPECT_EQ("text/plain; charset=UTF-8", ContentType(response));
+  EXPECT_THAT(response->body(), testing::HasSubstr("Central cache lock profiling is not enabled"));
+  EXPECT_THAT(response->body(), testing::HasSubstr("  Misses   Warmed Thread\n"));
+
+  EXPECT_EQ("200", request("admin", "POST", "/stats/cacheprofile/enable", response));
+  EXPECT_EQ("200", request("admin", "GET", "/stats/cacheprofile", response));
+  EXPECT_TRUE(absl::StartsWith(response->body(), "Central cache lock: ")) << response->body();
+
+  EXPECT_EQ("200", request("admin", "POST", "/stats/cacheprofile/disable", response));
+  EXPECT_EQ("200", request("admin", "GET", "/stats/cacheprofile", response));
+  EXPECT_THAT(response->body(), testing::HasSubstr("Central cache lock profiling is not enabled"));
+
   EXPECT_EQ("200", request("admin", "GET", "/stats?usedonly", response));
   EXPECT_EQ("text/plain; charset=UTF-8", ContentType(response));
 
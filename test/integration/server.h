@@ -350,6 +350,20 @@ public:
     Thread::LockGuard lock(lock_);
     return store_.textReadouts();
   }
+  void forEachChangedStat(const std::function<void(Counter&, uint64_t)>& counter_fn,
+                          const std::function<void(Gauge&)>& gauge_fn,
+                          const std::function<void(TextReadout&)>& text_readout_fn) override {
+    Thread::LockGuard lock(lock_);
+    store_.forEachChangedStat(counter_fn, gauge_fn, text_readout_fn);
+  }
+  void setCacheProfiling(TimeSource* time_source) override {
+    Thread::LockGuard lock(lock_);
+    store_.setCacheProfiling(time_source);
+  }
+  CacheProfile cacheProfile() const override {
+    Thread::LockGuard lock(lock_);
+    return store_.cacheProfile();
+  }
 
   bool iterate(const IterateFn<Counter>& fn) const override { return store_.iterate(fn); }
   bool iterate(const IterateFn<Gauge>& fn) const override { return store_.iterate(fn); }
@@ -361,6 +375,7 @@ public:
   void setTagProducer(TagProducerPtr&&) override {}
   void setStatsMatcher(StatsMatcherPtr&&) override {}
   void setHistogramSettings(HistogramSettingsConstPtr&&) override {}
+  void setThreadLocalCacheWarmup(bool) override {}
   void initializeThreading(Event::Dispatcher&, ThreadLocal::Instance&) override {}
   void shutdownThreading() override {}
   void mergeHistograms(PostMergeCb) override {}
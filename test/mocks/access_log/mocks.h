@@ -17,6 +17,7 @@ public:
 
   // AccessLog::AccessLogFile
   MOCK_METHOD(void, write, (absl::string_view data));
+  MOCK_METHOD(void, addHeader, (uint64_t id, absl::string_view data));
   MOCK_METHOD(void, reopen, ());
   MOCK_METHOD(void, flush, ());
 };
@@ -104,6 +104,11 @@ public:
   MOCK_METHOD(Buffer::Instance*, create_,
               (std::function<void()> below_low, std::function<void()> above_high,
                std::function<void()> above_overflow));
+  MOCK_METHOD(Buffer::BufferMemoryAccountSharedPtr, createAccount,
+              (std::function<void()> reset_cb));
+  MOCK_METHOD(uint64_t, bytesCharged, (), (const));
+  MOCK_METHOD(uint64_t, resetAccounts, (uint64_t bytes_to_free));
+  MOCK_METHOD(void, initializeStats, (Stats::Scope & scope, const std::string& prefix));
 };
 
 MATCHER_P(BufferEqual, rhs, testing::PrintToString(*rhs)) {
@@ -72,6 +72,7 @@ public:
               unixSocketPeerCredentials, (), (const));
   MOCK_METHOD(const Address::InstanceConstSharedPtr&, localAddress, (), (const));
   MOCK_METHOD(void, setConnectionStats, (const ConnectionStats& stats));
+  MOCK_METHOD(void, setReadStats, (const ReadStats& stats));
   MOCK_METHOD(Ssl::ConnectionInfoConstSharedPtr, ssl, (), (const));
   MOCK_METHOD(absl::string_view, requestedServerName, (), (const));
   MOCK_METHOD(State, state, (), (const));
@@ -85,6 +86,8 @@ public:
   MOCK_METHOD(const StreamInfo::StreamInfo&, streamInfo, (), (const));
   MOCK_METHOD(void, setDelayedCloseTimeout, (std::chrono::milliseconds));
   MOCK_METHOD(absl::string_view, transportFailureReason, (), (const));
+  MOCK_METHOD(IoHandle*, spliceableIoHandle, ());
+  MOCK_METHOD(void, recordSplicedBytes, (uint64_t bytes_read, uint64_t bytes_written));
 };
 
 /**
@@ -118,6 +121,7 @@ public:
               unixSocketPeerCredentials, (), (const));
   MOCK_METHOD(const Address::InstanceConstSharedPtr&, localAddress, (), (const));
   MOCK_METHOD(void, setConnectionStats, (const ConnectionStats& stats));
+  MOCK_METHOD(void, setReadStats, (const ReadStats& stats));
   MOCK_METHOD(Ssl::ConnectionInfoConstSharedPtr, ssl, (), (const));
   MOCK_METHOD(absl::string_view, requestedServerName, (), (const));
   MOCK_METHOD(State, state, (), (const));
@@ -131,6 +135,8 @@ public:
   MOCK_METHOD(const StreamInfo::StreamInfo&, streamInfo, (), (const));
   MOCK_METHOD(void, setDelayedCloseTimeout, (std::chrono::milliseconds));
   MOCK_METHOD(absl::string_view, transportFailureReason, (), (const));
+  MOCK_METHOD(IoHandle*, spliceableIoHandle, ());
+  MOCK_METHOD(void, recordSplicedBytes, (uint64_t bytes_read, uint64_t bytes_written));
 
   // Network::ClientConnection
   MOCK_METHOD(void, connect, ());
@@ -167,6 +173,7 @@ public:
               unixSocketPeerCredentials, (), (const));
   MOCK_METHOD(const Address::InstanceConstSharedPtr&, localAddress, (), (const));
   MOCK_METHOD(void, setConnectionStats, (const ConnectionStats& stats));
+  MOCK_METHOD(void, setReadStats, (const ReadStats& stats));
   MOCK_METHOD(Ssl::ConnectionInfoConstSharedPtr, ssl, (), (const));
   MOCK_METHOD(absl::string_view, requestedServerName, (), (const));
   MOCK_METHOD(State, state, (), (const));
@@ -180,6 +187,8 @@ public:
   MOCK_METHOD(const StreamInfo::StreamInfo&, streamInfo, (), (const));
   MOCK_METHOD(void, setDelayedCloseTimeout, (std::chrono::milliseconds));
   MOCK_METHOD(absl::string_view, transportFailureReason, (), (const));
+  MOCK_METHOD(IoHandle*, spliceableIoHandle, ());
+  MOCK_METHOD(void, recordSplicedBytes, (uint64_t bytes_read, uint64_t bytes_written));
 
   // Network::FilterManagerConnection
   MOCK_METHOD(StreamBuffer, getReadBuffer, ());
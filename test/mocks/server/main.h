@@ -23,6 +23,7 @@ public:
   MOCK_METHOD(Upstream::ClusterManager*, clusterManager, ());
   MOCK_METHOD(std::list<Stats::SinkPtr>&, statsSinks, ());
   MOCK_METHOD(std::chrono::milliseconds, statsFlushInterval, (), (const));
+  MOCK_METHOD(bool, statsFlushChangedOnly, (), (const));
   MOCK_METHOD(std::chrono::milliseconds, wdMissTimeout, (), (const));
   MOCK_METHOD(std::chrono::milliseconds, wdMegaMissTimeout, (), (const));
   MOCK_METHOD(std::chrono::milliseconds, wdKillTimeout, (), (const));
@@ -48,6 +48,8 @@ public:
   MOCK_METHOD(bool, signalHandlingEnabled, (), (const));
   MOCK_METHOD(bool, mutexTracingEnabled, (), (const));
   MOCK_METHOD(bool, fakeSymbolTableEnabled, (), (const));
+  MOCK_METHOD(const std::string&, statsSharedMemoryPath, (), (const));
+  MOCK_METHOD(uint32_t, statsSharedMemoryMaxStats, (), (const));
   MOCK_METHOD(bool, cpusetThreadsEnabled, (), (const));
   MOCK_METHOD(const std::vector<std::string>&, disabledExtensions, (), (const));
   MOCK_METHOD(Server::CommandLineOptionsPtr, toCommandLineOptions, (), (const));
@@ -71,6 +73,7 @@ public:
   bool signal_handling_enabled_{true};
   bool mutex_tracing_enabled_{};
   bool cpuset_threads_enabled_{};
+  std::string stats_shared_memory_path_;
   std::vector<std::string> disabled_extensions_;
 };
 } // namespace Server
@@ -16,6 +16,8 @@ public:
 
   // Upstream::LoadBalancer
   MOCK_METHOD(HostConstSharedPtr, chooseHost, (LoadBalancerContext * context));
+  MOCK_METHOD(void, onHostResponseTime,
+              (const HostDescription& host, std::chrono::nanoseconds response_time));
 
   std::shared_ptr<MockHost> host_{new MockHost()};
 };
@@ -0,0 +1,78 @@
+// Note: this should be run with --compilation_mode=opt, and would benefit from a
+// quiescent system with disabled cstate power management.
+
+#include "common/buffer/buffer_impl.h"
+#include "common/stats/allocator_impl.h"
+#include "common/stats/symbol_table_creator.h"
+
+#include "server/admin/prometheus_stats.h"
+
+#include "absl/strings/str_cat.h"
+#include "benchmark/benchmark.h"
+
+namespace Envoy {
+namespace Server {
+
+// Creates the counters and gauges of a number of clusters, each with the same set of names, as
+// a host with many clusters would have.
+class PrometheusStatsPerf {
+public:
+  PrometheusStatsPerf(uint32_t num_clusters, uint32_t stats_per_cluster)
+      : symbol_table_(Stats::SymbolTableCreator::makeSymbolTable()), alloc_(*symbol_table_),
+        pool_(*symbol_table_) {
+    const Stats::StatName tag_name = pool_.add("envoy.cluster_name");
+    for (uint32_t i = 0; i < stats_per_cluster; ++i) {
+      const std::string counter_name = absl::StrCat("cluster.upstream_rq_", i);
+      const std::string gauge_name = absl::StrCat("cluster.upstream_cx_active_", i);
+      for (uint32_t j = 0; j < num_clusters; ++j) {
+        const std::string cluster_name = absl::StrCat("cluster_", j);
+        const Stats::StatNameTagVector tags{{tag_name, pool_.add(cluster_name)}};
+        counters_.push_back(alloc_.makeCounter(
+            pool_.add(absl::StrCat("cluster.", cluster_name, ".upstream_rq_", i)),
+            pool_.add(counter_name), tags));
+        counters_.back()->add(j);
+        gauges_.push_back(alloc_.makeGauge(
+            pool_.add(absl::StrCat("cluster.", cluster_name, ".upstream_cx_active_", i)),
+            pool_.add(gauge_name), tags, Stats::Gauge::ImportMode::Accumulate));
+        gauges_.back()->set(j);
+      }
+    }
+  }
+
+  ~PrometheusStatsPerf() {
+    counters_.clear();
+    gauges_.clear();
+    pool_.clear();
+  }
+
+  uint64_t render() {
+    Buffer::OwnedImpl response;
+    PrometheusStatsFormatter::statsAsPrometheus(counters_, gauges_, {}, response, false,
+                                                absl::nullopt);
+    return response.length();
+  }
+
+private:
+  Stats::SymbolTablePtr symbol_table_;
+  Stats::AllocatorImpl alloc_;
+  Stats::StatNamePool pool_;
+  std::vector<Stats::CounterSharedPtr> counters_;
+  std::vector<Stats::GaugeSharedPtr> gauges_;
+};
+
+} // namespace Server
+} // namespace Envoy
+
+// Tests the cost of rendering the counters and gauges of state.range(0) clusters, each with 50
+// counters and 50 gauges.
+static void BM_PrometheusStats(benchmark::State& state) {
+  Envoy::Server::PrometheusStatsPerf context(state.range(0), 50);
+
+  uint64_t bytes = 0;
+  for (auto _ : state) {
+    bytes += context.render();
+  }
+  state.SetBytesProcessed(bytes);
+  state.SetItemsProcessed(state.iterations() * state.range(0) * 100);
+}
+BENCHMARK(BM_PrometheusStats)->Arg(10)->Arg(1000)->Unit(benchmark::kMillisecond);
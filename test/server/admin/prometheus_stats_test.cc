@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <regex>
 
 #include "server/admin/prometheus_stats.h"
@@ -5,6 +6,8 @@
 #include "test/mocks/stats/mocks.h"
 #include "test/test_common/utility.h"
 
+#include "absl/strings/str_split.h"
+
 using testing::NiceMock;
 using testing::ReturnRef;
 
@@ -189,6 +192,64 @@ TEST_F(PrometheusStatsFormatterTest, UniqueMetricName) {
   EXPECT_EQ(4UL, size);
 }
 
+// Validate that output larger than a chunk keeps each metric family grouped and sorted.
+TEST_F(PrometheusStatsFormatterTest, OutputSpansChunks) {
+  constexpr uint32_t num_clusters = 2000;
+  for (uint32_t i = num_clusters; i > 0; --i) {
+    const Stats::StatName cluster = makeStat(fmt::format("cluster_{:04}", i - 1));
+    addCounter("cluster.upstream_rq_total", {{makeStat("cluster"), cluster}});
+    addCounter("cluster.upstream_cx_total", {{makeStat("cluster"), cluster}});
+  }
+
+  Buffer::OwnedImpl response;
+  auto size = PrometheusStatsFormatter::statsAsPrometheus(counters_, gauges_, histograms_, response,
+                                                          false, absl::nullopt);
+  EXPECT_EQ(2UL, size);
+
+  const std::string output = response.toString();
+  EXPECT_GT(output.size(), 64 * 1024);
+  const std::vector<absl::string_view> lines = absl::StrSplit(output, '\n');
+  ASSERT_EQ(2 * (num_clusters + 2) + 1, lines.size());
+  EXPECT_EQ("# TYPE envoy_cluster_upstream_cx_total counter", lines[0]);
+  EXPECT_EQ("envoy_cluster_upstream_cx_total{cluster=\"cluster_0000\"} 0", lines[1]);
+  EXPECT_EQ("envoy_cluster_upstream_cx_total{cluster=\"cluster_1999\"} 0", lines[num_clusters]);
+  EXPECT_EQ("", lines[num_clusters + 1]);
+  EXPECT_EQ("# TYPE envoy_cluster_upstream_rq_total counter", lines[num_clusters + 2]);
+  EXPECT_TRUE(std::is_sorted(lines.begin() + num_clusters + 3, lines.end() - 2));
+}
+
+// Adjacent tag-extracted names which render to the same family name, such as names encoded
+// differently or differing only in characters that are sanitized, get a single TYPE line.
+TEST_F(PrometheusStatsFormatterTest, EquivalentTagExtractedNames) {
+  const Stats::StatName cluster_tag = makeStat("cluster");
+  addCounter("cluster.upstream-cx_total", {{cluster_tag, makeStat("c1")}});
+  addCounter("cluster.upstream_cx_total", {{cluster_tag, makeStat("c2")}});
+
+  const Stats::StatNameTagVector dynamic_tags{{cluster_tag, makeStat("c3")}};
+  Stats::StatNameManagedStorage name_storage(baseName("cluster.upstream_cx_total", dynamic_tags),
+                                             *symbol_table_);
+  Stats::StatNameDynamicStorage tag_extracted_name_storage("cluster.upstream_cx_total",
+                                                           *symbol_table_);
+  counters_.push_back(alloc_.makeCounter(name_storage.statName(),
+                                         tag_extracted_name_storage.statName(), dynamic_tags));
+  addCounter("cluster.upstream_cx_total", {{cluster_tag, makeStat("c4")}});
+
+  Buffer::OwnedImpl response;
+  auto size = PrometheusStatsFormatter::statsAsPrometheus(counters_, gauges_, histograms_, response,
+                                                          false, absl::nullopt);
+  EXPECT_EQ(1UL, size);
+
+  const std::string expected_output = R"EOF(# TYPE envoy_cluster_upstream_cx_total counter
+envoy_cluster_upstream_cx_total{cluster="c1"} 0
+envoy_cluster_upstream_cx_total{cluster="c2"} 0
+envoy_cluster_upstream_cx_total{cluster="c4"} 0
+envoy_cluster_upstream_cx_total{cluster="c3"} 0
+
+)EOF";
+
+  EXPECT_EQ(expected_output, response.toString());
+}
+
 TEST_F(PrometheusStatsFormatterTest, HistogramWithNoValuesAndNoTags) {
   HistogramWrapper h1_cumulative;
   h1_cumulative.setHistogramValues(std::vector<uint64_t>(0));
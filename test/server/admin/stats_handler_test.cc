@@ -569,5 +569,25 @@ TEST_P(AdminInstanceTest, RecentLookups) {
   // fake symbol table. However we cover this solidly in integration tests.
 }
 
+TEST_P(AdminInstanceTest, CacheProfile) {
+  Http::TestResponseHeaderMapImpl response_headers;
+  std::string body;
+
+  // The isolated store of the mock server has no caches to profile, so only the table header of the
+  // thread caches is shown. The profile of a thread local store is covered in integration tests.
+  EXPECT_EQ(Http::Code::OK, admin_.request("/stats/cacheprofile", "GET", response_headers, body));
+  EXPECT_EQ("Central cache lock profiling is not enabled. Use /stats/cacheprofile/enable to "
+            "enable.\n\n  Misses   Warmed Thread\n",
+            body);
+  EXPECT_THAT(std::string(response_headers.getContentTypeValue()), HasSubstr("text/plain"));
+
+  EXPECT_EQ(Http::Code::OK,
+            admin_.request("/stats/cacheprofile/enable", "POST", response_headers, body));
+  EXPECT_EQ("OK\n", body);
+  EXPECT_EQ(Http::Code::OK,
+            admin_.request("/stats/cacheprofile/disable", "POST", response_headers, body));
+  EXPECT_EQ("OK\n", body);
+}
+
 } // namespace Server
 } // namespace Envoy
@@ -89,7 +89,8 @@ TEST_F(OptionsImplTest, All) {
       "/foo/bar "
       "--disable-hot-restart --cpuset-threads --allow-unknown-static-fields "
       "--reject-unknown-dynamic-fields --use-fake-symbol-table 0 --base-id 5 "
-      "--use-dynamic-base-id --base-id-path /foo/baz");
+      "--use-dynamic-base-id --base-id-path /foo/baz --stats-shared-memory-path /foo/stats "
+      "--stats-shared-memory-max-stats 1000");
   EXPECT_EQ(Server::Mode::Validate, options->mode());
   EXPECT_EQ(2U, options->concurrency());
   EXPECT_EQ("hello", options->configPath());
@@ -115,6 +116,8 @@ TEST_F(OptionsImplTest, All) {
   EXPECT_EQ(5U, options->baseId());
   EXPECT_TRUE(options->useDynamicBaseId());
   EXPECT_EQ("/foo/baz", options->baseIdPath());
+  EXPECT_EQ("/foo/stats", options->statsSharedMemoryPath());
+  EXPECT_EQ(1000U, options->statsSharedMemoryMaxStats());
 
   options = createOptionsImpl("envoy --mode init_only");
   EXPECT_EQ(Server::Mode::InitOnly, options->mode());
@@ -174,6 +177,8 @@ TEST_F(OptionsImplTest, SetAll) {
   options->setAllowUnkownFields(true);
   options->setRejectUnknownFieldsDynamic(true);
   options->setFakeSymbolTableEnabled(!options->fakeSymbolTableEnabled());
+  options->setStatsSharedMemoryPath("/foo/stats");
+  options->setStatsSharedMemoryMaxStats(46);
 
   EXPECT_EQ(109876, options->baseId());
   EXPECT_EQ(42U, options->concurrency());
@@ -202,6 +207,8 @@ TEST_F(OptionsImplTest, SetAll) {
   EXPECT_TRUE(options->allowUnknownStaticFields());
   EXPECT_TRUE(options->rejectUnknownDynamicFields());
   EXPECT_EQ(!fake_symbol_table_enabled, options->fakeSymbolTableEnabled());
+  EXPECT_EQ("/foo/stats", options->statsSharedMemoryPath());
+  EXPECT_EQ(46U, options->statsSharedMemoryMaxStats());
 
   // Validate that CommandLineOptions is constructed correctly.
   Server::CommandLineOptionsPtr command_line_options = options->toCommandLineOptions();
@@ -231,6 +238,9 @@ TEST_F(OptionsImplTest, SetAll) {
   EXPECT_EQ(options->hotRestartDisabled(), command_line_options->disable_hot_restart());
   EXPECT_EQ(options->mutexTracingEnabled(), command_line_options->enable_mutex_tracing());
   EXPECT_EQ(options->cpusetThreadsEnabled(), command_line_options->cpuset_threads());
+  EXPECT_EQ(options->statsSharedMemoryPath(), command_line_options->stats_shared_memory_path());
+  EXPECT_EQ(options->statsSharedMemoryMaxStats(),
+            command_line_options->stats_shared_memory_max_stats());
 }
 
 TEST_F(OptionsImplTest, DefaultParams) {
@@ -244,6 +254,8 @@ TEST_F(OptionsImplTest, DefaultParams) {
   EXPECT_EQ(spdlog::level::warn, options->logLevel());
   EXPECT_FALSE(options->hotRestartDisabled());
   EXPECT_FALSE(options->cpusetThreadsEnabled());
+  EXPECT_EQ("", options->statsSharedMemoryPath());
+  EXPECT_EQ(65536U, options->statsSharedMemoryMaxStats());
 
   // Validate that CommandLineOptions is constructed correctly with default params.
   Server::CommandLineOptionsPtr command_line_options = options->toCommandLineOptions();
@@ -9,6 +9,8 @@
 #include "common/network/listen_socket_impl.h"
 #include "common/network/socket_option_impl.h"
 #include "common/protobuf/protobuf.h"
+#include "common/stats/histogram_impl.h"
+#include "common/stats/log_linear_histogram.h"
 #include "common/thread_local/thread_local_impl.h"
 #include "common/version/version.h"
 
@@ -40,6 +42,7 @@ using testing::InSequence;
 using testing::Invoke;
 using testing::InvokeWithoutArgs;
 using testing::Return;
+using testing::ReturnRef;
 using testing::SaveArg;
 using testing::StrictMock;
 
@@ -58,7 +61,7 @@ TEST(ServerInstanceUtil, flushHelper) {
   store.textReadout("text").set("is important");
 
   std::list<Stats::SinkPtr> sinks;
-  InstanceUtil::flushMetricsToSinks(sinks, store);
+  InstanceUtil::flushMetricsToSinks(sinks, store, false);
   // Make sure that counters have been latched even if there are no sinks.
   EXPECT_EQ(1UL, c.value());
   EXPECT_EQ(0, c.latch());
@@ -79,7 +82,7 @@ TEST(ServerInstanceUtil, flushHelper) {
     EXPECT_EQ(snapshot.textReadouts()[0].get().value(), "is important");
   }));
   c.inc();
-  InstanceUtil::flushMetricsToSinks(sinks, store);
+  InstanceUtil::flushMetricsToSinks(sinks, store, false);
 
   // Histograms don't currently work with the isolated store so test those with a mock store.
   NiceMock<Stats::MockStore> mock_store;
@@ -92,7 +95,64 @@ TEST(ServerInstanceUtil, flushHelper) {
     EXPECT_EQ(snapshot.histograms().size(), 1);
     EXPECT_TRUE(snapshot.textReadouts().empty());
   }));
-  InstanceUtil::flushMetricsToSinks(sinks, mock_store);
+  InstanceUtil::flushMetricsToSinks(sinks, mock_store, false);
+}
+
+TEST(ServerInstanceUtil, flushChangedOnly) {
+  Stats::TestUtil::TestStore store;
+  Stats::Counter& c = store.counter("hello");
+  Stats::Gauge& g = store.gauge("world", Stats::Gauge::ImportMode::Accumulate);
+  store.counter("idle");
+  store.gauge("idle_gauge", Stats::Gauge::ImportMode::Accumulate);
+  store.textReadout("text").set("is important");
+  c.inc();
+  g.set(5);
+
+  std::list<Stats::SinkPtr> sinks;
+  Stats::MockSink* sink = new StrictMock<Stats::MockSink>();
+  sinks.emplace_back(sink);
+  EXPECT_CALL(*sink, flush(_)).WillOnce(Invoke([](Stats::MetricSnapshot& snapshot) {
+    ASSERT_EQ(snapshot.counters().size(), 1);
+    EXPECT_EQ(snapshot.counters()[0].counter_.get().name(), "hello");
+    EXPECT_EQ(snapshot.counters()[0].delta_, 1);
+
+    ASSERT_EQ(snapshot.gauges().size(), 1);
+    EXPECT_EQ(snapshot.gauges()[0].get().name(), "world");
+    EXPECT_EQ(snapshot.gauges()[0].get().value(), 5);
+
+    ASSERT_EQ(snapshot.textReadouts().size(), 1);
+    EXPECT_EQ(snapshot.textReadouts()[0].get().name(), "text");
+  }));
+  InstanceUtil::flushMetricsToSinks(sinks, store, true);
+  EXPECT_EQ(0, c.latch());
+
+  // Nothing changed since the previous flush.
+  EXPECT_CALL(*sink, flush(_)).WillOnce(Invoke([](Stats::MetricSnapshot& snapshot) {
+    EXPECT_TRUE(snapshot.counters().empty());
+    EXPECT_TRUE(snapshot.gauges().empty());
+    EXPECT_TRUE(snapshot.histograms().empty());
+    EXPECT_TRUE(snapshot.textReadouts().empty());
+  }));
+  InstanceUtil::flushMetricsToSinks(sinks, store, true);
+
+  // Histograms without values in the last interval are skipped.
+  NiceMock<Stats::MockStore> mock_store;
+  auto* idle_histogram = new NiceMock<Stats::MockParentHistogram>();
+  auto* busy_histogram = new NiceMock<Stats::MockParentHistogram>();
+  Stats::LogLinearHistogram interval;
+  interval.recordValue(10);
+  busy_histogram->histogram_stats_ = std::make_shared<Stats::HistogramStatisticsImpl>(
+      interval, Stats::HistogramSettingsImpl::defaultBuckets());
+  ON_CALL(*busy_histogram, intervalStatistics())
+      .WillByDefault(ReturnRef(*busy_histogram->histogram_stats_));
+  std::vector<Stats::ParentHistogramSharedPtr> parent_histograms = {idle_histogram,
+                                                                    busy_histogram};
+  ON_CALL(mock_store, histograms).WillByDefault(Return(parent_histograms));
+  EXPECT_CALL(*sink, flush(_)).WillOnce(Invoke([busy_histogram](Stats::MetricSnapshot& snapshot) {
+    ASSERT_EQ(snapshot.histograms().size(), 1);
+    EXPECT_EQ(&snapshot.histograms()[0].get(), busy_histogram);
+  }));
+  InstanceUtil::flushMetricsToSinks(sinks, mock_store, true);
 }
 
 class RunHelperTest : public testing::Test {
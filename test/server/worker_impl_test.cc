@@ -10,6 +10,7 @@
 #include "test/mocks/server/instance.h"
 #include "test/mocks/server/overload_manager.h"
 #include "test/mocks/thread_local/mocks.h"
+#include "test/test_common/simulated_time_system.h"
 #include "test/test_common/utility.h"
 
 #include "gtest/gtest.h"
@@ -29,10 +30,11 @@ namespace {
 class WorkerImplTest : public testing::Test {
 public:
   WorkerImplTest()
-      : api_(Api::createApiForTest()), dispatcher_(api_->allocateDispatcher("worker_test")),
+      : api_(Api::createApiForTest(time_system_)),
+        dispatcher_(api_->allocateDispatcher("worker_test")),
         no_exit_timer_(dispatcher_->createTimer([]() -> void {})),
         worker_(tls_, hooks_, std::move(dispatcher_), Network::ConnectionHandlerPtr{handler_},
-                overload_manager_, *api_) {
+                overloadManager(), *api_) {
     // In the real worker the watchdog has timers that prevent exit. Here we need to prevent event
     // loop exit since we use mock timers.
     no_exit_timer_->enableTimer(std::chrono::hours(1));
@@ -45,6 +47,30 @@ public:
     no_exit_timer_.reset();
   }
 
+  // Captures the callback and dispatcher of the worker's reset_largest_buffer_consumers action.
+  OverloadManager& overloadManager() {
+    ON_CALL(overload_manager_,
+            registerForAction(OverloadActionNames::get().ResetLargestBufferConsumers, _, _))
+        .WillByDefault(Invoke([this](const std::string&, Event::Dispatcher& dispatcher,
+                                     OverloadActionCb callback) -> bool {
+          worker_dispatcher_ = &dispatcher;
+          reset_buffer_consumers_cb_ = callback;
+          return true;
+        }));
+    return overload_manager_;
+  }
+
+  // Runs a function on the worker thread and waits for it to complete.
+  void runOnWorker(std::function<void()> fn) {
+    ConditionalInitializer ci;
+    worker_dispatcher_->post([&fn, &ci]() {
+      fn();
+      ci.setReady();
+    });
+    ci.waitReady();
+  }
+
+  Event::SimulatedTimeSystem time_system_;
   NiceMock<ThreadLocal::MockInstance> tls_;
   Network::MockConnectionHandler* handler_ = new Network::MockConnectionHandler();
   NiceMock<MockGuardDog> guard_dog_;
@@ -53,6 +79,8 @@ public:
   Event::DispatcherPtr dispatcher_;
   DefaultListenerHooks hooks_;
   Event::TimerPtr no_exit_timer_;
+  Event::Dispatcher* worker_dispatcher_{};
+  OverloadActionCb reset_buffer_consumers_cb_;
   WorkerImpl worker_;
 };
 
@@ -160,6 +188,51 @@ TEST_F(WorkerImplTest, ListenerException) {
   worker_.stop();
 }
 
+// The worker resets the connections and streams which buffer the most while the
+// reset_largest_buffer_consumers action is active.
+TEST_F(WorkerImplTest, ResetLargestBufferConsumers) {
+  ASSERT_NE(nullptr, reset_buffer_consumers_cb_);
+  worker_.start(guard_dog_);
+
+  std::vector<std::string> resets;
+  Buffer::BufferMemoryAccountSharedPtr small;
+  Buffer::BufferMemoryAccountSharedPtr large;
+  runOnWorker([&]() {
+    Buffer::WatermarkFactory& factory = worker_dispatcher_->getWatermarkFactory();
+    small = factory.createAccount([&resets]() { resets.push_back("small"); });
+    large = factory.createAccount([&resets]() { resets.push_back("large"); });
+    small->charge(100);
+    large->charge(300);
+
+    // Half of the 400 bytes buffered are freed by resetting the largest account.
+    reset_buffer_consumers_cb_(OverloadActionState::saturated());
+  });
+  EXPECT_EQ(std::vector<std::string>{"large"}, resets);
+
+  // The accounts are reset again while the action stays active.
+  time_system_.advanceTimeWait(std::chrono::seconds(1));
+  EXPECT_EQ((std::vector<std::string>{"large", "small"}), resets);
+
+  // Until it becomes inactive.
+  runOnWorker([&]() {
+    small->credit(100);
+    large->credit(300);
+    small = worker_dispatcher_->getWatermarkFactory().createAccount(
+        [&resets]() { resets.push_back("new"); });
+    small->charge(100);
+    reset_buffer_consumers_cb_(OverloadActionState::inactive());
+  });
+  time_system_.advanceTimeWait(std::chrono::seconds(1));
+  EXPECT_EQ((std::vector<std::string>{"large", "small"}), resets);
+
+  runOnWorker([&]() {
+    small->credit(100);
+    small.reset();
+    large.reset();
+  });
+  worker_.stop();
+}
+
 } // namespace
 } // namespace Server
 } // namespace Envoy
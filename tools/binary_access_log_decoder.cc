@@ -0,0 +1,61 @@
+/**
+ * Utility to print the entries of binary access log files as JSON, one entry per line.
+ *
+ * Usage:
+ *
+ * binary_access_log_decoder <binary access log path>...
+ *
+ * Schemas carry over from one file to the next, so the files of a rotated log can be decoded by
+ * passing the oldest file first.
+ */
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include "envoy/common/exception.h"
+
+#include "common/protobuf/utility.h"
+
+#include "extensions/access_loggers/binary/binary_log_format.h"
+
+// NOLINT(namespace-envoy)
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    std::cerr << "Usage: " << argv[0] << " <binary access log path>..." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  Envoy::Extensions::AccessLoggers::Binary::RecordDecoder decoder;
+  for (int i = 1; i < argc; i++) {
+    std::ifstream file(argv[i], std::ios::binary);
+    if (!file) {
+      std::cerr << "Unable to open " << argv[i] << std::endl;
+      return EXIT_FAILURE;
+    }
+    std::stringstream contents;
+    contents << file.rdbuf();
+    const std::string data = contents.str();
+
+    absl::string_view remaining = data;
+    try {
+      decoder.decode(remaining, [](Envoy::ProtobufWkt::Struct&& entry) {
+        std::cout << Envoy::MessageUtil::getJsonStringFromMessage(entry, false, true) << "\n";
+      });
+    } catch (const Envoy::EnvoyException& e) {
+      std::cerr << argv[i] << ": " << e.what() << std::endl;
+      return EXIT_FAILURE;
+    }
+    if (!remaining.empty()) {
+      std::cerr << argv[i] << ": ignoring " << remaining.size() << " bytes of a partial record"
+                << std::endl;
+    }
+  }
+
+  if (decoder.unknownSchemaEntries() > 0) {
+    std::cerr << "skipped " << decoder.unknownSchemaEntries()
+              << " entries without a schema; pass the file holding their schema first"
+              << std::endl;
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,45 @@
+/**
+ * Utility to print the counters and gauges of a running Envoy from the file it places them in
+ * with --stats-shared-memory-path, in the text format of the /stats admin endpoint.
+ *
+ * Usage:
+ *
+ * shared_memory_stats_reader <shared memory stats path>
+ *
+ * Reading the file never blocks Envoy, so this can be run as often as needed.
+ */
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <string>
+
+#include "envoy/common/exception.h"
+
+#include "common/stats/shared_memory_stats.h"
+
+// NOLINT(namespace-envoy)
+int main(int argc, char** argv) {
+  if (argc != 2) {
+    std::cerr << "Usage: " << argv[0] << " <shared memory stats path>" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  try {
+    Envoy::Stats::SharedMemoryStatsReader reader(argv[1]);
+    // Slots are reused as stats come and go, so sort by name as /stats does.
+    std::map<std::string, uint64_t> stats;
+    reader.forEachStat([&stats](absl::string_view name, Envoy::Stats::SharedMemoryStatsEntry::Type,
+                                uint64_t value) { stats[std::string(name)] = value; });
+    for (const auto& stat : stats) {
+      std::cout << stat.first << ": " << stat.second << "\n";
+    }
+    if (reader.numOverflowed() > 0) {
+      std::cerr << "pid " << reader.pid() << " could not place " << reader.numOverflowed()
+                << " stats in " << argv[1] << std::endl;
+    }
+  } catch (const Envoy::EnvoyException& e) {
+    std::cerr << e.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}